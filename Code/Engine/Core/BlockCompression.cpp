@@ -0,0 +1,719 @@
+#include "Engine/Core/BlockCompression.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Math/SIMDUtils.hpp"
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+	constexpr int BLOCK_TEXEL_COUNT = BLOCK_COMPRESSION_BLOCK_SIZE * BLOCK_COMPRESSION_BLOCK_SIZE;
+	constexpr int BLOCK_CHANNEL_COUNT = 4;
+	constexpr int MAX_PALETTE_SIZE = 16;
+	constexpr int PRINCIPAL_AXIS_ITERATIONS = 8;
+	constexpr int REFINE_ITERATIONS = 2;
+	constexpr int BC1_BLOCK_BYTES = 8;
+	constexpr int BC3_BLOCK_BYTES = 16;
+	constexpr int BC7_BLOCK_BYTES = 16;
+	constexpr unsigned char BC1_PUNCH_THROUGH_ALPHA = 128;
+	constexpr int BC7_MODE6_WEIGHTS[MAX_PALETTE_SIZE] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// Texels of a block as one array per channel, so 4 texels load into one SimdFloat4. Texels with a weight of 0 are left
+	// out of the fit and the error, BC1 uses that for punch through texels
+	struct BlockChannels {
+		float m_channels[BLOCK_CHANNEL_COUNT][BLOCK_TEXEL_COUNT];
+		float m_weights[BLOCK_TEXEL_COUNT];
+	};
+
+	struct BlockPalette {
+		float m_colors[MAX_PALETTE_SIZE][BLOCK_CHANNEL_COUNT] = {};
+		int m_count = 0;
+	};
+
+	int ClampInt(int value, int minValue, int maxValue)
+	{
+		return (value < minValue) ? minValue : ((value > maxValue) ? maxValue : value);
+	}
+
+	void LoadBlockChannels(Rgba8 const* blockTexels, BlockChannels& outChannels)
+	{
+		for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; texelIndex++) {
+			outChannels.m_channels[0][texelIndex] = (float)blockTexels[texelIndex].r;
+			outChannels.m_channels[1][texelIndex] = (float)blockTexels[texelIndex].g;
+			outChannels.m_channels[2][texelIndex] = (float)blockTexels[texelIndex].b;
+			outChannels.m_channels[3][texelIndex] = (float)blockTexels[texelIndex].a;
+			outChannels.m_weights[texelIndex] = 1.0f;
+		}
+	}
+
+	// Endpoints at both ends of the texels projected on the axis of most variance, found by power iteration on the
+	// covariance. Starting from the bounding box diagonal converges in a few steps and keeps its sign
+	void FitPrincipalAxis(BlockChannels const& texels, int channelCount, float* outStart, float* outEnd)
+	{
+		float mean[BLOCK_CHANNEL_COUNT] = {};
+		float minValues[BLOCK_CHANNEL_COUNT] = { 255.0f, 255.0f, 255.0f, 255.0f };
+		float maxValues[BLOCK_CHANNEL_COUNT] = {};
+		float weightSum = 0.0f;
+		for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; texelIndex++) {
+			float weight = texels.m_weights[texelIndex];
+			if (weight == 0.0f) continue;
+			weightSum += weight;
+			for (int channel = 0; channel < channelCount; channel++) {
+				float value = texels.m_channels[channel][texelIndex];
+				mean[channel] += weight * value;
+				minValues[channel] = (value < minValues[channel]) ? value : minValues[channel];
+				maxValues[channel] = (value > maxValues[channel]) ? value : maxValues[channel];
+			}
+		}
+		if (weightSum == 0.0f) {
+			for (int channel = 0; channel < channelCount; channel++) {
+				outStart[channel] = 0.0f;
+				outEnd[channel] = 0.0f;
+			}
+			return;
+		}
+
+		float covariance[BLOCK_CHANNEL_COUNT][BLOCK_CHANNEL_COUNT] = {};
+		for (int channel = 0; channel < channelCount; channel++) {
+			mean[channel] /= weightSum;
+		}
+		for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; texelIndex++) {
+			float weight = texels.m_weights[texelIndex];
+			if (weight == 0.0f) continue;
+			for (int row = 0; row < channelCount; row++) {
+				float rowOffset = texels.m_channels[row][texelIndex] - mean[row];
+				for (int column = row; column < channelCount; column++) {
+					covariance[row][column] += weight * rowOffset * (texels.m_channels[column][texelIndex] - mean[column]);
+				}
+			}
+		}
+
+		float axis[BLOCK_CHANNEL_COUNT] = {};
+		for (int channel = 0; channel < channelCount; channel++) {
+			axis[channel] = maxValues[channel] - minValues[channel];
+		}
+		for (int iteration = 0; iteration < PRINCIPAL_AXIS_ITERATIONS; iteration++) {
+			float nextAxis[BLOCK_CHANNEL_COUNT] = {};
+			float largest = 0.0f;
+			for (int row = 0; row < channelCount; row++) {
+				for (int column = 0; column < channelCount; column++) {
+					float element = (column >= row) ? covariance[row][column] : covariance[column][row];
+					nextAxis[row] += element * axis[column];
+				}
+				largest = (fabsf(nextAxis[row]) > largest) ? fabsf(nextAxis[row]) : largest;
+			}
+			if (largest < FLT_EPSILON) break; // Every texel is the same color, or the covariance killed the start axis
+			for (int channel = 0; channel < channelCount; channel++) {
+				axis[channel] = nextAxis[channel] / largest;
+			}
+		}
+
+		float axisLengthSquared = 0.0f;
+		for (int channel = 0; channel < channelCount; channel++) {
+			axisLengthSquared += axis[channel] * axis[channel];
+		}
+		float minProjection = 0.0f;
+		float maxProjection = 0.0f;
+		if (axisLengthSquared > FLT_EPSILON) {
+			minProjection = FLT_MAX;
+			maxProjection = -FLT_MAX;
+			for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; texelIndex++) {
+				if (texels.m_weights[texelIndex] == 0.0f) continue;
+				float projection = 0.0f;
+				for (int channel = 0; channel < channelCount; channel++) {
+					projection += (texels.m_channels[channel][texelIndex] - mean[channel]) * axis[channel];
+				}
+				minProjection = (projection < minProjection) ? projection : minProjection;
+				maxProjection = (projection > maxProjection) ? projection : maxProjection;
+			}
+			minProjection /= axisLengthSquared;
+			maxProjection /= axisLengthSquared;
+		}
+
+		for (int channel = 0; channel < channelCount; channel++) {
+			outStart[channel] = Clamp(mean[channel] + minProjection * axis[channel], 0.0f, 255.0f);
+			outEnd[channel] = Clamp(mean[channel] + maxProjection * axis[channel], 0.0f, 255.0f);
+		}
+	}
+
+	// Nearest palette entry for every texel, 4 texels per SimdFloat4. Returns the weighted squared error of the block
+	float MatchTexelsToPalette(BlockChannels const& texels, int channelCount, BlockPalette const& palette, int* outIndexes)
+	{
+		SimdFloat4 totalError = SimdFloat4::Zero();
+		for (int firstTexel = 0; firstTexel < BLOCK_TEXEL_COUNT; firstTexel += SimdFloat4::LANES) {
+			SimdFloat4 channelValues[BLOCK_CHANNEL_COUNT];
+			for (int channel = 0; channel < channelCount; channel++) {
+				channelValues[channel] = SimdFloat4::Load(&texels.m_channels[channel][firstTexel]);
+			}
+
+			SimdFloat4 bestError = SimdFloat4::Broadcast(FLT_MAX);
+			SimdFloat4 bestIndex = SimdFloat4::Zero();
+			for (int paletteIndex = 0; paletteIndex < palette.m_count; paletteIndex++) {
+				SimdFloat4 error = SimdFloat4::Zero();
+				for (int channel = 0; channel < channelCount; channel++) {
+					SimdFloat4 difference = channelValues[channel] - SimdFloat4::Broadcast(palette.m_colors[paletteIndex][channel]);
+					error = error + difference * difference;
+				}
+				SimdFloat4 isBetter = error < bestError;
+				bestError = SimdSelect(isBetter, error, bestError);
+				bestIndex = SimdSelect(isBetter, SimdFloat4::Broadcast((float)paletteIndex), bestIndex);
+			}
+			totalError = totalError + bestError * SimdFloat4::Load(&texels.m_weights[firstTexel]);
+
+			float laneIndexes[SimdFloat4::LANES];
+			bestIndex.Store(laneIndexes);
+			for (int lane = 0; lane < SimdFloat4::LANES; lane++) {
+				outIndexes[firstTexel + lane] = (int)laneIndexes[lane];
+			}
+		}
+
+		float laneErrors[SimdFloat4::LANES];
+		totalError.Store(laneErrors);
+		return laneErrors[0] + laneErrors[1] + laneErrors[2] + laneErrors[3];
+	}
+
+	// Endpoints that minimize the squared error for fixed indexes, where index i blends start and end by
+	// indexFractions[i]. False when every texel sits on the same fraction and the endpoints can't be separated
+	bool SolveEndpointsLeastSquares(BlockChannels const& texels, int channelCount, int const* indexes, float const* indexFractions, float* outStart, float* outEnd)
+	{
+		float startStart = 0.0f;
+		float startEnd = 0.0f;
+		float endEnd = 0.0f;
+		float startColor[BLOCK_CHANNEL_COUNT] = {};
+		float endColor[BLOCK_CHANNEL_COUNT] = {};
+		for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; texelIndex++) {
+			float weight = texels.m_weights[texelIndex];
+			if (weight == 0.0f) continue;
+			float endFraction = indexFractions[indexes[texelIndex]];
+			float startFraction = 1.0f - endFraction;
+			startStart += weight * startFraction * startFraction;
+			startEnd += weight * startFraction * endFraction;
+			endEnd += weight * endFraction * endFraction;
+			for (int channel = 0; channel < channelCount; channel++) {
+				startColor[channel] += weight * startFraction * texels.m_channels[channel][texelIndex];
+				endColor[channel] += weight * endFraction * texels.m_channels[channel][texelIndex];
+			}
+		}
+
+		float determinant = startStart * endEnd - startEnd * startEnd;
+		if (fabsf(determinant) < FLT_EPSILON) return false;
+
+		float inverseDeterminant = 1.0f / determinant;
+		for (int channel = 0; channel < channelCount; channel++) {
+			outStart[channel] = Clamp((startColor[channel] * endEnd - endColor[channel] * startEnd) * inverseDeterminant, 0.0f, 255.0f);
+			outEnd[channel] = Clamp((endColor[channel] * startStart - startColor[channel] * startEnd) * inverseDeterminant, 0.0f, 255.0f);
+		}
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------------------------------------------
+	// BC1 and BC3
+	uint16_t QuantizeRGB565(float const* color)
+	{
+		int red = ClampInt(RoundDownToInt(color[0] * (31.0f / 255.0f) + 0.5f), 0, 31);
+		int green = ClampInt(RoundDownToInt(color[1] * (63.0f / 255.0f) + 0.5f), 0, 63);
+		int blue = ClampInt(RoundDownToInt(color[2] * (31.0f / 255.0f) + 0.5f), 0, 31);
+		return (uint16_t)((red << 11) | (green << 5) | blue);
+	}
+
+	void ExpandRGB565(uint16_t packedColor, int* outColor)
+	{
+		int red = (packedColor >> 11) & 31;
+		int green = (packedColor >> 5) & 63;
+		int blue = packedColor & 31;
+		outColor[0] = (red << 3) | (red >> 2);
+		outColor[1] = (green << 2) | (green >> 4);
+		outColor[2] = (blue << 3) | (blue >> 2);
+	}
+
+	// Same integer math as DecodeBC1Block, so the encoder measures what the decoder will produce
+	void BuildBC1Palette(uint16_t startColor, uint16_t endColor, bool isThreeColor, int outColors[4][3])
+	{
+		ExpandRGB565(startColor, outColors[0]);
+		ExpandRGB565(endColor, outColors[1]);
+		for (int channel = 0; channel < 3; channel++) {
+			int start = outColors[0][channel];
+			int end = outColors[1][channel];
+			if (isThreeColor) {
+				outColors[2][channel] = (start + end + 1) / 2;
+				outColors[3][channel] = 0;
+			}
+			else {
+				outColors[2][channel] = (2 * start + end + 1) / 3;
+				outColors[3][channel] = (start + 2 * end + 1) / 3;
+			}
+		}
+	}
+
+	// The order of the endpoints picks the mode: start > end is 4 colors, start <= end is 3 colors plus transparent black
+	float TryBC1Endpoints(BlockChannels const& texels, uint16_t& inOutStart, uint16_t& inOutEnd, bool isThreeColor, int* outIndexes)
+	{
+		if ((isThreeColor && (inOutStart > inOutEnd)) || (!isThreeColor && (inOutStart < inOutEnd))) {
+			uint16_t swapped = inOutStart;
+			inOutStart = inOutEnd;
+			inOutEnd = swapped;
+		}
+
+		int paletteColors[4][3];
+		BuildBC1Palette(inOutStart, inOutEnd, isThreeColor, paletteColors);
+		BlockPalette palette;
+		palette.m_count = (isThreeColor || (inOutStart == inOutEnd)) ? 3 : 4;
+		for (int paletteIndex = 0; paletteIndex < palette.m_count; paletteIndex++) {
+			for (int channel = 0; channel < 3; channel++) {
+				palette.m_colors[paletteIndex][channel] = (float)paletteColors[paletteIndex][channel];
+			}
+		}
+		return MatchTexelsToPalette(texels, 3, palette, outIndexes);
+	}
+
+	void EncodeBC1Color(BlockChannels& texels, bool allowPunchThrough, unsigned char* outBlock)
+	{
+		bool isThreeColor = false;
+		bool isFullyTransparent = allowPunchThrough;
+		if (allowPunchThrough) {
+			for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; texelIndex++) {
+				bool isTransparent = texels.m_channels[3][texelIndex] < (float)BC1_PUNCH_THROUGH_ALPHA;
+				texels.m_weights[texelIndex] = isTransparent ? 0.0f : 1.0f;
+				isThreeColor |= isTransparent;
+				isFullyTransparent &= isTransparent;
+			}
+		}
+
+		uint16_t bestStart = 0;
+		uint16_t bestEnd = 0;
+		int bestIndexes[BLOCK_TEXEL_COUNT] = {};
+		if (!isFullyTransparent) {
+			float start[BLOCK_CHANNEL_COUNT];
+			float end[BLOCK_CHANNEL_COUNT];
+			FitPrincipalAxis(texels, 3, start, end);
+
+			float const fourColorFractions[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+			float const threeColorFractions[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+			float const* indexFractions = isThreeColor ? threeColorFractions : fourColorFractions;
+
+			float bestError = FLT_MAX;
+			for (int iteration = 0; iteration <= REFINE_ITERATIONS; iteration++) {
+				uint16_t quantizedStart = QuantizeRGB565(start);
+				uint16_t quantizedEnd = QuantizeRGB565(end);
+				int indexes[BLOCK_TEXEL_COUNT];
+				float error = TryBC1Endpoints(texels, quantizedStart, quantizedEnd, isThreeColor, indexes);
+				if (error < bestError) {
+					bestError = error;
+					bestStart = quantizedStart;
+					bestEnd = quantizedEnd;
+					memcpy(bestIndexes, indexes, sizeof(indexes));
+				}
+				if ((error == 0.0f) || (iteration == REFINE_ITERATIONS)) break;
+				// Indexes are relative to the endpoints in the order TryBC1Endpoints left them, which is all the solve needs
+				if (!SolveEndpointsLeastSquares(texels, 3, indexes, indexFractions, start, end)) break;
+			}
+		}
+
+		uint32_t packedIndexes = 0;
+		for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; texelIndex++) {
+			int index = (texels.m_weights[texelIndex] == 0.0f) ? 3 : bestIndexes[texelIndex];
+			packedIndexes |= (uint32_t)index << (2 * texelIndex);
+		}
+		outBlock[0] = (unsigned char)(bestStart & 0xFF);
+		outBlock[1] = (unsigned char)(bestStart >> 8);
+		outBlock[2] = (unsigned char)(bestEnd & 0xFF);
+		outBlock[3] = (unsigned char)(bestEnd >> 8);
+		for (int byteIndex = 0; byteIndex < 4; byteIndex++) {
+			outBlock[4 + byteIndex] = (unsigned char)(packedIndexes >> (8 * byteIndex));
+		}
+	}
+
+	void DecodeBC1Color(unsigned char const* block, bool allowThreeColor, Rgba8* outBlockTexels)
+	{
+		uint16_t startColor = (uint16_t)(block[0] | (block[1] << 8));
+		uint16_t endColor = (uint16_t)(block[2] | (block[3] << 8));
+		bool isThreeColor = allowThreeColor && (startColor <= endColor);
+
+		int paletteColors[4][3];
+		BuildBC1Palette(startColor, endColor, isThreeColor, paletteColors);
+		uint32_t packedIndexes = (uint32_t)block[4] | ((uint32_t)block[5] << 8) | ((uint32_t)block[6] << 16) | ((uint32_t)block[7] << 24);
+		for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; texelIndex++) {
+			int index = (packedIndexes >> (2 * texelIndex)) & 3;
+			int const* color = paletteColors[index];
+			unsigned char alpha = (isThreeColor && (index == 3)) ? 0 : 255;
+			outBlockTexels[texelIndex] = Rgba8((unsigned char)color[0], (unsigned char)color[1], (unsigned char)color[2], alpha);
+		}
+	}
+
+	// 8 alpha values from max down to min, with the 3 bit indexes packed after the two endpoint bytes. The steps are even,
+	// so the nearest one is a rounding instead of a search
+	void EncodeBC3Alpha(Rgba8 const* blockTexels, unsigned char* outBlock)
+	{
+		int minAlpha = 255;
+		int maxAlpha = 0;
+		for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; texelIndex++) {
+			int alpha = blockTexels[texelIndex].a;
+			minAlpha = (alpha < minAlpha) ? alpha : minAlpha;
+			maxAlpha = (alpha > maxAlpha) ? alpha : maxAlpha;
+		}
+
+		uint64_t packedIndexes = 0;
+		if (maxAlpha > minAlpha) {
+			float stepsPerAlpha = 7.0f / (float)(maxAlpha - minAlpha);
+			for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; texelIndex++) {
+				int step = RoundDownToInt((float)(maxAlpha - blockTexels[texelIndex].a) * stepsPerAlpha + 0.5f);
+				uint64_t index = (step == 0) ? 0 : ((step == 7) ? 1 : (uint64_t)(step + 1));
+				packedIndexes |= index << (3 * texelIndex);
+			}
+		}
+
+		outBlock[0] = (unsigned char)maxAlpha;
+		outBlock[1] = (unsigned char)minAlpha;
+		for (int byteIndex = 0; byteIndex < 6; byteIndex++) {
+			outBlock[2 + byteIndex] = (unsigned char)(packedIndexes >> (8 * byteIndex));
+		}
+	}
+
+	void DecodeBC3Alpha(unsigned char const* block, Rgba8* outBlockTexels)
+	{
+		int startAlpha = block[0];
+		int endAlpha = block[1];
+		int alphas[8] = { startAlpha, endAlpha };
+		if (startAlpha > endAlpha) {
+			for (int step = 1; step < 7; step++) {
+				alphas[step + 1] = ((7 - step) * startAlpha + step * endAlpha + 3) / 7;
+			}
+		}
+		else {
+			for (int step = 1; step < 5; step++) {
+				alphas[step + 1] = ((5 - step) * startAlpha + step * endAlpha + 2) / 5;
+			}
+			alphas[6] = 0;
+			alphas[7] = 255;
+		}
+
+		uint64_t packedIndexes = 0;
+		for (int byteIndex = 0; byteIndex < 6; byteIndex++) {
+			packedIndexes |= (uint64_t)block[2 + byteIndex] << (8 * byteIndex);
+		}
+		for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; texelIndex++) {
+			outBlockTexels[texelIndex].a = (unsigned char)alphas[(packedIndexes >> (3 * texelIndex)) & 7];
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------------------------
+	// BC7, bits are packed from the lowest bit of the first byte
+	struct BlockBitWriter {
+		unsigned char* m_bytes = nullptr;
+		int m_bitPosition = 0;
+
+		void Write(uint32_t value, int bitCount)
+		{
+			for (int bit = 0; bit < bitCount; bit++, m_bitPosition++) {
+				if ((value >> bit) & 1) {
+					m_bytes[m_bitPosition >> 3] |= (unsigned char)(1 << (m_bitPosition & 7));
+				}
+			}
+		}
+	};
+
+	struct BlockBitReader {
+		unsigned char const* m_bytes = nullptr;
+		int m_bitPosition = 0;
+
+		uint32_t Read(int bitCount)
+		{
+			uint32_t value = 0;
+			for (int bit = 0; bit < bitCount; bit++, m_bitPosition++) {
+				value |= (uint32_t)((m_bytes[m_bitPosition >> 3] >> (m_bitPosition & 7)) & 1) << bit;
+			}
+			return value;
+		}
+	};
+
+	struct BC7Mode6Endpoint {
+		int m_quantized[BLOCK_CHANNEL_COUNT] = {}; // 7 bits per channel
+		int m_pBit = 0; // Lowest bit shared by every channel
+	};
+
+	int GetBC7Mode6EndpointValue(BC7Mode6Endpoint const& endpoint, int channel)
+	{
+		return (endpoint.m_quantized[channel] << 1) | endpoint.m_pBit;
+	}
+
+	// Tries both p bits and keeps the one closer over all 4 channels
+	BC7Mode6Endpoint const QuantizeBC7Mode6Endpoint(float const* color)
+	{
+		BC7Mode6Endpoint bestEndpoint;
+		float bestError = FLT_MAX;
+		for (int pBit = 0; pBit < 2; pBit++) {
+			BC7Mode6Endpoint endpoint;
+			endpoint.m_pBit = pBit;
+			float error = 0.0f;
+			for (int channel = 0; channel < BLOCK_CHANNEL_COUNT; channel++) {
+				endpoint.m_quantized[channel] = ClampInt(RoundDownToInt((color[channel] - (float)pBit) * 0.5f + 0.5f), 0, 127);
+				float difference = (float)GetBC7Mode6EndpointValue(endpoint, channel) - color[channel];
+				error += difference * difference;
+			}
+			if (error < bestError) {
+				bestError = error;
+				bestEndpoint = endpoint;
+			}
+		}
+		return bestEndpoint;
+	}
+
+	int InterpolateBC7Value(int start, int end, int weight)
+	{
+		return ((64 - weight) * start + weight * end + 32) >> 6;
+	}
+
+	void EncodeBC7Mode6(Rgba8 const* blockTexels, unsigned char* outBlock)
+	{
+		BlockChannels texels;
+		LoadBlockChannels(blockTexels, texels);
+
+		float start[BLOCK_CHANNEL_COUNT];
+		float end[BLOCK_CHANNEL_COUNT];
+		FitPrincipalAxis(texels, BLOCK_CHANNEL_COUNT, start, end);
+
+		float indexFractions[MAX_PALETTE_SIZE];
+		for (int paletteIndex = 0; paletteIndex < MAX_PALETTE_SIZE; paletteIndex++) {
+			indexFractions[paletteIndex] = (float)BC7_MODE6_WEIGHTS[paletteIndex] / 64.0f;
+		}
+
+		BC7Mode6Endpoint bestStart;
+		BC7Mode6Endpoint bestEnd;
+		int bestIndexes[BLOCK_TEXEL_COUNT] = {};
+		float bestError = FLT_MAX;
+		for (int iteration = 0; iteration <= REFINE_ITERATIONS; iteration++) {
+			BC7Mode6Endpoint quantizedStart = QuantizeBC7Mode6Endpoint(start);
+			BC7Mode6Endpoint quantizedEnd = QuantizeBC7Mode6Endpoint(end);
+
+			BlockPalette palette;
+			palette.m_count = MAX_PALETTE_SIZE;
+			for (int paletteIndex = 0; paletteIndex < MAX_PALETTE_SIZE; paletteIndex++) {
+				for (int channel = 0; channel < BLOCK_CHANNEL_COUNT; channel++) {
+					int startValue = GetBC7Mode6EndpointValue(quantizedStart, channel);
+					int endValue = GetBC7Mode6EndpointValue(quantizedEnd, channel);
+					palette.m_colors[paletteIndex][channel] = (float)InterpolateBC7Value(startValue, endValue, BC7_MODE6_WEIGHTS[paletteIndex]);
+				}
+			}
+
+			int indexes[BLOCK_TEXEL_COUNT];
+			float error = MatchTexelsToPalette(texels, BLOCK_CHANNEL_COUNT, palette, indexes);
+			if (error < bestError) {
+				bestError = error;
+				bestStart = quantizedStart;
+				bestEnd = quantizedEnd;
+				memcpy(bestIndexes, indexes, sizeof(indexes));
+			}
+			if ((error == 0.0f) || (iteration == REFINE_ITERATIONS)) break;
+			if (!SolveEndpointsLeastSquares(texels, BLOCK_CHANNEL_COUNT, indexes, indexFractions, start, end)) break;
+		}
+
+		// The top index bit of the first texel is implied 0, swapping the endpoints flips every index into that range
+		if (bestIndexes[0] >= MAX_PALETTE_SIZE / 2) {
+			BC7Mode6Endpoint swapped = bestStart;
+			bestStart = bestEnd;
+			bestEnd = swapped;
+			for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; texelIndex++) {
+				bestIndexes[texelIndex] = (MAX_PALETTE_SIZE - 1) - bestIndexes[texelIndex];
+			}
+		}
+
+		memset(outBlock, 0, BC7_BLOCK_BYTES);
+		BlockBitWriter writer{ outBlock };
+		writer.Write(1 << 6, 7);
+		for (int channel = 0; channel < BLOCK_CHANNEL_COUNT; channel++) {
+			writer.Write((uint32_t)bestStart.m_quantized[channel], 7);
+			writer.Write((uint32_t)bestEnd.m_quantized[channel], 7);
+		}
+		writer.Write((uint32_t)bestStart.m_pBit, 1);
+		writer.Write((uint32_t)bestEnd.m_pBit, 1);
+		writer.Write((uint32_t)bestIndexes[0], 3);
+		for (int texelIndex = 1; texelIndex < BLOCK_TEXEL_COUNT; texelIndex++) {
+			writer.Write((uint32_t)bestIndexes[texelIndex], 4);
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------------------------
+	using BlockCodecFunction = void (*)(Rgba8 const*, unsigned char*);
+	using BlockDecodeFunction = void (*)(unsigned char const*, Rgba8*);
+
+	BlockCodecFunction GetBlockEncodeFunction(BlockCompressionFormat format)
+	{
+		switch (format) {
+		case BlockCompressionFormat::BC1: return &EncodeBC1Block;
+		case BlockCompressionFormat::BC3: return &EncodeBC3Block;
+		case BlockCompressionFormat::BC7: return &EncodeBC7Block;
+		default: return nullptr;
+		}
+	}
+
+	BlockDecodeFunction GetBlockDecodeFunction(BlockCompressionFormat format)
+	{
+		switch (format) {
+		case BlockCompressionFormat::BC1: return &DecodeBC1Block;
+		case BlockCompressionFormat::BC3: return &DecodeBC3Block;
+		case BlockCompressionFormat::BC7: return &DecodeBC7Block;
+		default: return nullptr;
+		}
+	}
+}
+
+int GetBlockCompressionBlockBytes(BlockCompressionFormat format)
+{
+	switch (format) {
+	case BlockCompressionFormat::BC1: return BC1_BLOCK_BYTES;
+	case BlockCompressionFormat::BC3: return BC3_BLOCK_BYTES;
+	case BlockCompressionFormat::BC7: return BC7_BLOCK_BYTES;
+	default: return 0;
+	}
+}
+
+IntVec2 GetBlockCompressionBlockCount(IntVec2 const& dimensions)
+{
+	return IntVec2((dimensions.x + BLOCK_COMPRESSION_BLOCK_SIZE - 1) / BLOCK_COMPRESSION_BLOCK_SIZE, (dimensions.y + BLOCK_COMPRESSION_BLOCK_SIZE - 1) / BLOCK_COMPRESSION_BLOCK_SIZE);
+}
+
+void EncodeBC1Block(Rgba8 const* blockTexels, unsigned char* outBlock)
+{
+	BlockChannels texels;
+	LoadBlockChannels(blockTexels, texels);
+	EncodeBC1Color(texels, true, outBlock);
+}
+
+void EncodeBC3Block(Rgba8 const* blockTexels, unsigned char* outBlock)
+{
+	EncodeBC3Alpha(blockTexels, outBlock);
+
+	BlockChannels texels;
+	LoadBlockChannels(blockTexels, texels);
+	EncodeBC1Color(texels, false, outBlock + 8);
+}
+
+void EncodeBC7Block(Rgba8 const* blockTexels, unsigned char* outBlock)
+{
+	EncodeBC7Mode6(blockTexels, outBlock);
+}
+
+void DecodeBC1Block(unsigned char const* block, Rgba8* outBlockTexels)
+{
+	DecodeBC1Color(block, true, outBlockTexels);
+}
+
+void DecodeBC3Block(unsigned char const* block, Rgba8* outBlockTexels)
+{
+	DecodeBC1Color(block + 8, false, outBlockTexels);
+	DecodeBC3Alpha(block, outBlockTexels);
+}
+
+void DecodeBC7Block(unsigned char const* block, Rgba8* outBlockTexels)
+{
+	if ((block[0] & 0x7F) != (1 << 6)) {
+		for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; texelIndex++) {
+			outBlockTexels[texelIndex] = Rgba8(255, 0, 255, 255);
+		}
+		return;
+	}
+
+	BlockBitReader reader{ block, 7 };
+	BC7Mode6Endpoint start;
+	BC7Mode6Endpoint end;
+	for (int channel = 0; channel < BLOCK_CHANNEL_COUNT; channel++) {
+		start.m_quantized[channel] = (int)reader.Read(7);
+		end.m_quantized[channel] = (int)reader.Read(7);
+	}
+	start.m_pBit = (int)reader.Read(1);
+	end.m_pBit = (int)reader.Read(1);
+
+	for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; texelIndex++) {
+		int weight = BC7_MODE6_WEIGHTS[reader.Read((texelIndex == 0) ? 3 : 4)];
+		unsigned char channels[BLOCK_CHANNEL_COUNT];
+		for (int channel = 0; channel < BLOCK_CHANNEL_COUNT; channel++) {
+			channels[channel] = (unsigned char)InterpolateBC7Value(GetBC7Mode6EndpointValue(start, channel), GetBC7Mode6EndpointValue(end, channel), weight);
+		}
+		outBlockTexels[texelIndex] = Rgba8(channels[0], channels[1], channels[2], channels[3]);
+	}
+}
+
+void EncodeBlockCompressedSurface(Rgba8 const* texels, IntVec2 const& dimensions, BlockCompressionFormat format, unsigned char* outBlocks)
+{
+	BlockCodecFunction encodeBlock = GetBlockEncodeFunction(format);
+	if ((encodeBlock == nullptr) || (dimensions.x <= 0) || (dimensions.y <= 0)) return;
+
+	IntVec2 blockCount = GetBlockCompressionBlockCount(dimensions);
+	int blockBytes = GetBlockCompressionBlockBytes(format);
+	auto encodeBlockRows = [&](int beginRow, int endRow) {
+		Rgba8 blockTexels[BLOCK_TEXEL_COUNT];
+		for (int blockY = beginRow; blockY < endRow; blockY++) {
+			for (int blockX = 0; blockX < blockCount.x; blockX++) {
+				for (int texelY = 0; texelY < BLOCK_COMPRESSION_BLOCK_SIZE; texelY++) {
+					int sourceY = ClampInt(blockY * BLOCK_COMPRESSION_BLOCK_SIZE + texelY, 0, dimensions.y - 1);
+					for (int texelX = 0; texelX < BLOCK_COMPRESSION_BLOCK_SIZE; texelX++) {
+						int sourceX = ClampInt(blockX * BLOCK_COMPRESSION_BLOCK_SIZE + texelX, 0, dimensions.x - 1);
+						blockTexels[texelY * BLOCK_COMPRESSION_BLOCK_SIZE + texelX] = texels[(size_t)sourceY * dimensions.x + sourceX];
+					}
+				}
+				encodeBlock(blockTexels, outBlocks + ((size_t)blockY * blockCount.x + blockX) * blockBytes);
+			}
+		}
+	};
+
+	if (g_theJobSystem) {
+		g_theJobSystem->ParallelFor(blockCount.y, BLOCK_COMPRESSION_MIN_BLOCK_ROWS_PER_JOB, encodeBlockRows);
+	}
+	else {
+		encodeBlockRows(0, blockCount.y);
+	}
+}
+
+void DecodeBlockCompressedSurface(unsigned char const* blocks, IntVec2 const& dimensions, BlockCompressionFormat format, Rgba8* outTexels)
+{
+	BlockDecodeFunction decodeBlock = GetBlockDecodeFunction(format);
+	if ((decodeBlock == nullptr) || (dimensions.x <= 0) || (dimensions.y <= 0)) return;
+
+	IntVec2 blockCount = GetBlockCompressionBlockCount(dimensions);
+	int blockBytes = GetBlockCompressionBlockBytes(format);
+	auto decodeBlockRows = [&](int beginRow, int endRow) {
+		Rgba8 blockTexels[BLOCK_TEXEL_COUNT];
+		for (int blockY = beginRow; blockY < endRow; blockY++) {
+			for (int blockX = 0; blockX < blockCount.x; blockX++) {
+				decodeBlock(blocks + ((size_t)blockY * blockCount.x + blockX) * blockBytes, blockTexels);
+				for (int texelY = 0; texelY < BLOCK_COMPRESSION_BLOCK_SIZE; texelY++) {
+					int targetY = blockY * BLOCK_COMPRESSION_BLOCK_SIZE + texelY;
+					if (targetY >= dimensions.y) break;
+					for (int texelX = 0; texelX < BLOCK_COMPRESSION_BLOCK_SIZE; texelX++) {
+						int targetX = blockX * BLOCK_COMPRESSION_BLOCK_SIZE + texelX;
+						if (targetX >= dimensions.x) break;
+						outTexels[(size_t)targetY * dimensions.x + targetX] = blockTexels[texelY * BLOCK_COMPRESSION_BLOCK_SIZE + texelX];
+					}
+				}
+			}
+		}
+	};
+
+	if (g_theJobSystem) {
+		g_theJobSystem->ParallelFor(blockCount.y, BLOCK_COMPRESSION_MIN_BLOCK_ROWS_PER_JOB, decodeBlockRows);
+	}
+	else {
+		decodeBlockRows(0, blockCount.y);
+	}
+}
+
+float ComputeTexelsPSNR(Rgba8 const* texelsA, Rgba8 const* texelsB, size_t texelCount, bool includeAlpha)
+{
+	if (texelCount == 0) return 999.0f;
+
+	uint64_t squaredErrorSum = 0;
+	for (size_t texelIndex = 0; texelIndex < texelCount; texelIndex++) {
+		int redDifference = (int)texelsA[texelIndex].r - (int)texelsB[texelIndex].r;
+		int greenDifference = (int)texelsA[texelIndex].g - (int)texelsB[texelIndex].g;
+		int blueDifference = (int)texelsA[texelIndex].b - (int)texelsB[texelIndex].b;
+		int alphaDifference = includeAlpha ? ((int)texelsA[texelIndex].a - (int)texelsB[texelIndex].a) : 0;
+		squaredErrorSum += (uint64_t)(redDifference * redDifference + greenDifference * greenDifference + blueDifference * blueDifference + alphaDifference * alphaDifference);
+	}
+	if (squaredErrorSum == 0) return 999.0f;
+
+	double meanSquaredError = (double)squaredErrorSum / ((double)texelCount * (includeAlpha ? 4.0 : 3.0));
+	return (float)(10.0 * log10((255.0 * 255.0) / meanSquaredError));
+}
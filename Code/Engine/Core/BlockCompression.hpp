@@ -0,0 +1,37 @@
+#pragma once
+#include "Engine/Math/IntVec2.hpp"
+#include <cstddef>
+
+struct Rgba8;
+
+enum class BlockCompressionFormat : unsigned char {
+	BC1, // RGB 5:6:5 endpoints, 4 bits per texel. Alpha below 128 turns into punch through transparency
+	BC3, // BC1 color plus interpolated alpha, 8 bits per texel
+	BC7, // RGBA, 8 bits per texel. Only mode 6 (one subset, 7.7.7.7 endpoints with p bits) is written
+	COUNT
+};
+
+constexpr int BLOCK_COMPRESSION_BLOCK_SIZE = 4;
+constexpr int BLOCK_COMPRESSION_MIN_BLOCK_ROWS_PER_JOB = 4;
+
+int GetBlockCompressionBlockBytes(BlockCompressionFormat format);
+IntVec2 GetBlockCompressionBlockCount(IntVec2 const& dimensions);
+
+// One 4x4 block, 16 texels row by row. Colors are fitted along their principal axis in RGB (RGBA for BC7), the texels are
+// matched to the palette 4 at a time with SIMD, then the endpoints are refined once by least squares
+void EncodeBC1Block(Rgba8 const* blockTexels, unsigned char* outBlock);
+void EncodeBC3Block(Rgba8 const* blockTexels, unsigned char* outBlock);
+void EncodeBC7Block(Rgba8 const* blockTexels, unsigned char* outBlock);
+
+void DecodeBC1Block(unsigned char const* block, Rgba8* outBlockTexels);
+void DecodeBC3Block(unsigned char const* block, Rgba8* outBlockTexels);
+// Mode 6 only, the one the encoder writes. Blocks in any other mode decode to opaque magenta
+void DecodeBC7Block(unsigned char const* block, Rgba8* outBlockTexels);
+
+// Whole surfaces, blocks row by row. Sizes that are not multiples of 4 repeat the edge texels into the last blocks.
+// Block rows are split across the JobSystem
+void EncodeBlockCompressedSurface(Rgba8 const* texels, IntVec2 const& dimensions, BlockCompressionFormat format, unsigned char* outBlocks);
+void DecodeBlockCompressedSurface(unsigned char const* blocks, IntVec2 const& dimensions, BlockCompressionFormat format, Rgba8* outTexels);
+
+// Peak signal to noise ratio in dB over 8 bit channels, for measuring encoders. Identical texels give 999
+float ComputeTexelsPSNR(Rgba8 const* texelsA, Rgba8 const* texelsB, size_t texelCount, bool includeAlpha = true);
@@ -2,6 +2,7 @@
 #include "Engine/Core/Time.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Metrics.hpp"
 
 static Clock g_systemClock;
 
@@ -75,6 +76,12 @@ Clock::~Clock()
 
 void Clock::SystemBeginFrame()
 {
+	// Unclamped wall time between frames, Tick clamps the delta it feeds to the clocks
+	static double s_lastFrameTime = GetCurrentTimeSeconds();
+	double currentFrameTime = GetCurrentTimeSeconds();
+	METRIC_HISTOGRAM_RECORD("frame.time_us", (uint64_t)((currentFrameTime - s_lastFrameTime) * 1'000'000.0));
+	s_lastFrameTime = currentFrameTime;
+
 	g_systemClock.Tick();
 }
 
@@ -0,0 +1,289 @@
+#include "Engine/Core/CompressedImage.hpp"
+#include "Engine/Core/Image.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/VirtualFileSystem.hpp"
+#include "ThirdParty/stb/stb_image.h"
+#include <cstring>
+#include <climits>
+
+namespace {
+	constexpr uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+	constexpr uint32_t DDS_FOURCC_DX10 = 0x30315844; // "DX10"
+	constexpr uint32_t DDS_HEADER_FLAGS_TEXTURE = 0x1 | 0x2 | 0x4 | 0x1000; // Caps, height, width, pixel format
+	constexpr uint32_t DDS_HEADER_FLAGS_MIPMAP = 0x20000;
+	constexpr uint32_t DDS_HEADER_FLAGS_LINEAR_SIZE = 0x80000;
+	constexpr uint32_t DDS_PIXEL_FORMAT_FOURCC = 0x4;
+	constexpr uint32_t DDS_CAPS_TEXTURE = 0x1000;
+	constexpr uint32_t DDS_CAPS_MIPMAP = 0x8 | 0x400000; // Complex and mipmap
+	constexpr uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+	constexpr uint32_t DXGI_FORMAT_BC1_UNORM = 71;
+	constexpr uint32_t DXGI_FORMAT_BC3_UNORM = 77;
+	constexpr uint32_t DXGI_FORMAT_BC7_UNORM = 98;
+	constexpr uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325ull;
+	constexpr uint64_t FNV_PRIME = 0x100000001B3ull;
+
+	struct DDSPixelFormat {
+		uint32_t m_size = sizeof(DDSPixelFormat);
+		uint32_t m_flags = DDS_PIXEL_FORMAT_FOURCC;
+		uint32_t m_fourCC = DDS_FOURCC_DX10;
+		uint32_t m_rgbBitCount = 0;
+		uint32_t m_bitMasks[4] = {};
+	};
+
+	struct DDSHeader {
+		uint32_t m_size = sizeof(DDSHeader);
+		uint32_t m_flags = DDS_HEADER_FLAGS_TEXTURE | DDS_HEADER_FLAGS_LINEAR_SIZE;
+		uint32_t m_height = 0;
+		uint32_t m_width = 0;
+		uint32_t m_pitchOrLinearSize = 0;
+		uint32_t m_depth = 0;
+		uint32_t m_mipMapCount = 0;
+		uint32_t m_reserved1[11] = {};
+		DDSPixelFormat m_pixelFormat;
+		uint32_t m_caps = DDS_CAPS_TEXTURE;
+		uint32_t m_caps2 = 0;
+		uint32_t m_caps3 = 0;
+		uint32_t m_caps4 = 0;
+		uint32_t m_reserved2 = 0;
+	};
+
+	struct DDSHeaderDX10 {
+		uint32_t m_dxgiFormat = 0;
+		uint32_t m_resourceDimension = DDS_DIMENSION_TEXTURE2D;
+		uint32_t m_miscFlag = 0;
+		uint32_t m_arraySize = 1;
+		uint32_t m_miscFlags2 = 0;
+	};
+
+	static_assert(sizeof(DDSHeader) == 124, "DDS header size is fixed by the file format");
+	static_assert(sizeof(DDSHeaderDX10) == 20, "DX10 header size is fixed by the file format");
+	constexpr size_t DDS_BLOCKS_OFFSET = sizeof(uint32_t) + sizeof(DDSHeader) + sizeof(DDSHeaderDX10);
+
+	uint32_t GetDXGIFormat(BlockCompressionFormat format)
+	{
+		switch (format) {
+		case BlockCompressionFormat::BC1: return DXGI_FORMAT_BC1_UNORM;
+		case BlockCompressionFormat::BC3: return DXGI_FORMAT_BC3_UNORM;
+		case BlockCompressionFormat::BC7: return DXGI_FORMAT_BC7_UNORM;
+		default: return 0;
+		}
+	}
+
+	bool GetFormatFromDXGI(uint32_t dxgiFormat, BlockCompressionFormat& outFormat)
+	{
+		switch (dxgiFormat) {
+		case DXGI_FORMAT_BC1_UNORM: outFormat = BlockCompressionFormat::BC1; return true;
+		case DXGI_FORMAT_BC3_UNORM: outFormat = BlockCompressionFormat::BC3; return true;
+		case DXGI_FORMAT_BC7_UNORM: outFormat = BlockCompressionFormat::BC7; return true;
+		default: return false;
+		}
+	}
+
+	uint64_t HashBytes(uint64_t hash, void const* bytes, size_t byteCount)
+	{
+		uint8_t const* byteValues = static_cast<uint8_t const*>(bytes);
+		for (size_t byteIndex = 0; byteIndex < byteCount; byteIndex++) {
+			hash = (hash ^ byteValues[byteIndex]) * FNV_PRIME;
+		}
+		return hash;
+	}
+
+	// Levels from the top down to 1x1
+	uint32_t GetFullMipChainLength(uint32_t width, uint32_t height)
+	{
+		uint32_t largestDimension = (width > height) ? width : height;
+		uint32_t mipCount = 1;
+		while (largestDimension > 1) {
+			largestDimension >>= 1;
+			mipCount++;
+		}
+		return mipCount;
+	}
+}
+
+CompressedImage::CompressedImage(Image const& image, BlockCompressionFormat format):
+	m_format(format),
+	m_dimensions(image.GetDimensions())
+{
+	ComputeMipOffsets(image.GetMipCount());
+	m_cookedBlocks.resize(m_blocksSize);
+	m_blocks = m_cookedBlocks.data();
+
+	for (int mipLevel = 0; mipLevel < GetMipCount(); mipLevel++) {
+		EncodeBlockCompressedSurface(image.GetMipTexels(mipLevel), image.GetMipDimensions(mipLevel), format, m_cookedBlocks.data() + m_mipOffsets[mipLevel]);
+	}
+}
+
+bool CompressedImage::CreateOrLoadCached(char const* imageFilePath, BlockCompressionFormat format, bool generateMipChain, std::string const& cacheDirectory, CompressedImage& outImage)
+{
+	VirtualFile sourceFile;
+	if (!OpenVirtualFile(sourceFile, imageFilePath)) {
+		ERROR_RECOVERABLE(Stringf("Failed to open image \"%s\" to cook", imageFilePath));
+		return false;
+	}
+
+	uint64_t sourceHash = HashCookSource(sourceFile.GetSpan(), format, generateMipChain);
+	std::string cachePath = Stringf("%s/%016llx.dds", cacheDirectory.c_str(), (unsigned long long)sourceHash);
+	if (outImage.LoadFromFile(cachePath) && (outImage.GetSourceHash() == sourceHash) && (outImage.GetFormat() == format)) {
+		return true;
+	}
+
+	Image sourceImage(imageFilePath);
+	if (generateMipChain) {
+		sourceImage.GenerateMipChain();
+	}
+	outImage = CompressedImage(sourceImage, format);
+	outImage.m_sourceHash = sourceHash;
+
+	std::error_code directoryError;
+	std::filesystem::create_directories(cacheDirectory, directoryError);
+	if (!outImage.WriteToFile(cachePath)) {
+		DebuggerPrintf(Stringf("Failed to write texture cache \"%s\", it will be cooked again next run\n", cachePath.c_str()).c_str());
+	}
+	return true;
+}
+
+bool CompressedImage::ReadSourceDimensions(char const* imageFilePath, IntVec2& outDimensions)
+{
+	VirtualFile sourceFile;
+	int componentCount = 0;
+	if (!OpenVirtualFile(sourceFile, imageFilePath) || !stbi_info_from_memory(sourceFile.GetData(), (int)sourceFile.GetSize(), &outDimensions.x, &outDimensions.y, &componentCount)) {
+		ERROR_RECOVERABLE(Stringf("Failed to read the size of image \"%s\"", imageFilePath));
+		return false;
+	}
+	return true;
+}
+
+uint64_t CompressedImage::HashCookSource(ByteSpan sourceBytes, BlockCompressionFormat format, bool generateMipChain)
+{
+	uint8_t const settings[3] = { (uint8_t)format, (uint8_t)generateMipChain, (uint8_t)COMPRESSED_IMAGE_CACHE_VERSION };
+	uint64_t hash = HashBytes(FNV_OFFSET_BASIS, sourceBytes.m_data, sourceBytes.m_size);
+	return HashBytes(hash, settings, sizeof(settings));
+}
+
+bool CompressedImage::WriteToFile(std::string const& filePath) const
+{
+	if (!IsValid()) return false;
+
+	DDSHeader header;
+	header.m_width = (uint32_t)m_dimensions.x;
+	header.m_height = (uint32_t)m_dimensions.y;
+	header.m_pitchOrLinearSize = (uint32_t)GetMipSizeBytes(0);
+	header.m_mipMapCount = (uint32_t)GetMipCount();
+	if (GetMipCount() > 1) {
+		header.m_flags |= DDS_HEADER_FLAGS_MIPMAP;
+		header.m_caps |= DDS_CAPS_MIPMAP;
+	}
+	header.m_reserved1[0] = COMPRESSED_IMAGE_CACHE_MAGIC;
+	header.m_reserved1[1] = COMPRESSED_IMAGE_CACHE_VERSION;
+	header.m_reserved1[2] = (uint32_t)(m_sourceHash & 0xFFFFFFFF);
+	header.m_reserved1[3] = (uint32_t)(m_sourceHash >> 32);
+
+	DDSHeaderDX10 headerDX10;
+	headerDX10.m_dxgiFormat = GetDXGIFormat(m_format);
+
+	std::vector<uint8_t> fileBuffer(DDS_BLOCKS_OFFSET + m_blocksSize);
+	uint8_t* writePtr = fileBuffer.data();
+	memcpy(writePtr, &DDS_MAGIC, sizeof(DDS_MAGIC));
+	writePtr += sizeof(DDS_MAGIC);
+	memcpy(writePtr, &header, sizeof(header));
+	writePtr += sizeof(header);
+	memcpy(writePtr, &headerDX10, sizeof(headerDX10));
+	writePtr += sizeof(headerDX10);
+	memcpy(writePtr, m_blocks, m_blocksSize);
+
+	return FileWriteFromBuffer(fileBuffer, filePath) == 0;
+}
+
+bool CompressedImage::LoadFromFile(std::string const& filePath)
+{
+	Clear();
+	if (!m_mappedFile.Open(filePath)) return false;
+
+	uint32_t magic = 0;
+	DDSHeader header;
+	DDSHeaderDX10 headerDX10;
+	uint8_t const* readPtr = m_mappedFile.GetData();
+	bool isHeaderValid = m_mappedFile.GetSize() >= DDS_BLOCKS_OFFSET;
+	if (isHeaderValid) {
+		memcpy(&magic, readPtr, sizeof(magic));
+		memcpy(&header, readPtr + sizeof(magic), sizeof(header));
+		memcpy(&headerDX10, readPtr + sizeof(magic) + sizeof(header), sizeof(headerDX10));
+		isHeaderValid = (magic == DDS_MAGIC) && (header.m_size == sizeof(DDSHeader)) && (header.m_pixelFormat.m_fourCC == DDS_FOURCC_DX10)
+			&& (header.m_reserved1[0] == COMPRESSED_IMAGE_CACHE_MAGIC) && (header.m_reserved1[1] == COMPRESSED_IMAGE_CACHE_VERSION)
+			&& GetFormatFromDXGI(headerDX10.m_dxgiFormat, m_format) && (header.m_width > 0) && (header.m_height > 0)
+			&& (header.m_width <= (uint32_t)INT_MAX) && (header.m_height <= (uint32_t)INT_MAX)
+			&& (header.m_mipMapCount > 0) && (header.m_mipMapCount <= GetFullMipChainLength(header.m_width, header.m_height));
+	}
+	if (!isHeaderValid) {
+		Clear();
+		return false;
+	}
+
+	m_dimensions = IntVec2((int)header.m_width, (int)header.m_height);
+	m_sourceHash = (uint64_t)header.m_reserved1[2] | ((uint64_t)header.m_reserved1[3] << 32);
+	ComputeMipOffsets((int)header.m_mipMapCount);
+	// Our caches hold exactly the blocks of every level, anything else is cut short or not ours
+	if ((m_mappedFile.GetSize() - DDS_BLOCKS_OFFSET) != m_blocksSize) {
+		Clear();
+		return false;
+	}
+
+	m_blocks = readPtr + DDS_BLOCKS_OFFSET;
+	return true;
+}
+
+IntVec2 CompressedImage::GetMipDimensions(int mipLevel) const
+{
+	int width = m_dimensions.x >> mipLevel;
+	int height = m_dimensions.y >> mipLevel;
+	return IntVec2((width > 1) ? width : 1, (height > 1) ? height : 1);
+}
+
+unsigned char const* CompressedImage::GetMipBlocks(int mipLevel) const
+{
+	return m_blocks + m_mipOffsets[mipLevel];
+}
+
+size_t CompressedImage::GetMipSizeBytes(int mipLevel) const
+{
+	size_t mipEnd = (mipLevel + 1 < GetMipCount()) ? m_mipOffsets[mipLevel + 1] : m_blocksSize;
+	return mipEnd - m_mipOffsets[mipLevel];
+}
+
+size_t CompressedImage::GetMipRowPitch(int mipLevel) const
+{
+	return (size_t)GetBlockCompressionBlockCount(GetMipDimensions(mipLevel)).x * GetBlockCompressionBlockBytes(m_format);
+}
+
+void CompressedImage::DecodeMip(int mipLevel, std::vector<Rgba8>& outTexels) const
+{
+	IntVec2 mipDimensions = GetMipDimensions(mipLevel);
+	outTexels.resize((size_t)mipDimensions.x * mipDimensions.y);
+	DecodeBlockCompressedSurface(GetMipBlocks(mipLevel), mipDimensions, m_format, outTexels.data());
+}
+
+void CompressedImage::Clear()
+{
+	m_dimensions = IntVec2::ZERO;
+	m_sourceHash = 0;
+	m_mipOffsets.clear();
+	m_blocks = nullptr;
+	m_blocksSize = 0;
+	m_cookedBlocks.clear();
+	m_mappedFile.Close();
+}
+
+void CompressedImage::ComputeMipOffsets(int mipCount)
+{
+	m_mipOffsets.resize(mipCount);
+	m_blocksSize = 0;
+	size_t blockBytes = (size_t)GetBlockCompressionBlockBytes(m_format);
+	for (int mipLevel = 0; mipLevel < mipCount; mipLevel++) {
+		m_mipOffsets[mipLevel] = m_blocksSize;
+		IntVec2 blockCount = GetBlockCompressionBlockCount(GetMipDimensions(mipLevel));
+		m_blocksSize += (size_t)blockCount.x * blockCount.y * blockBytes;
+	}
+}
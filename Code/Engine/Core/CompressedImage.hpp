@@ -0,0 +1,73 @@
+#pragma once
+#include "Engine/Core/BlockCompression.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class Image;
+struct Rgba8;
+
+/*
+	COOKED TEXTURE CACHE LAYOUT (.dds)
+	["DDS " magic]
+	[DDS header]			-> m_reserved1 holds COMPRESSED_IMAGE_CACHE_MAGIC, COMPRESSED_IMAGE_CACHE_VERSION and the 64 bit source hash
+	[DX10 header]			-> DXGI BC1/BC3/BC7 UNORM, so the files also open in regular DDS tools
+	[Mip 0 blocks][Mip 1 blocks]...
+*/
+
+constexpr uint32_t COMPRESSED_IMAGE_CACHE_MAGIC = 0x43474E45; // "ENGC"
+constexpr uint32_t COMPRESSED_IMAGE_CACHE_VERSION = 1; // Bump when the encoders change, so old caches are cooked again
+
+/// <summary>
+/// Block compressed texels of an image and its mip levels, ready to upload. Cooked from an Image, or read back from a cache
+/// file which is memory mapped and used in place
+/// </summary>
+class CompressedImage {
+public:
+	CompressedImage() = default;
+	// Encodes every mip level the image has
+	CompressedImage(Image const& image, BlockCompressionFormat format);
+
+	// Hashes the source file and loads <cacheDirectory>/<hash>.dds when its header matches. Otherwise the image is decoded,
+	// cooked and written there for the next run. False when the source file can't be opened
+	static bool CreateOrLoadCached(char const* imageFilePath, BlockCompressionFormat format, bool generateMipChain, std::string const& cacheDirectory, CompressedImage& outImage);
+	// Width and height from the source file's header, without decoding it
+	static bool ReadSourceDimensions(char const* imageFilePath, IntVec2& outDimensions);
+	// FNV-1a over the source file bytes and the cook settings
+	static uint64_t HashCookSource(ByteSpan sourceBytes, BlockCompressionFormat format, bool generateMipChain);
+
+	bool WriteToFile(std::string const& filePath) const;
+	// False and an empty image when the file is missing, is not one of our caches, has more mip levels than its size allows, or is not exactly the size of its levels
+	bool LoadFromFile(std::string const& filePath);
+
+	bool IsValid() const { return m_blocks != nullptr; }
+	bool IsMemoryMapped() const { return m_mappedFile.IsValid(); }
+	BlockCompressionFormat GetFormat() const { return m_format; }
+	IntVec2 GetDimensions() const { return m_dimensions; }
+	uint64_t GetSourceHash() const { return m_sourceHash; }
+	int GetMipCount() const { return (int)m_mipOffsets.size(); }
+	IntVec2 GetMipDimensions(int mipLevel) const;
+	unsigned char const* GetMipBlocks(int mipLevel) const;
+	size_t GetMipSizeBytes(int mipLevel) const;
+	size_t GetMipRowPitch(int mipLevel) const; // Bytes of one row of blocks
+	size_t GetSizeBytes() const { return m_blocksSize; } // Every level
+
+	// Back to texels, for checking the encoders against the source
+	void DecodeMip(int mipLevel, std::vector<Rgba8>& outTexels) const;
+
+private:
+	void Clear();
+	void ComputeMipOffsets(int mipCount);
+
+private:
+	BlockCompressionFormat m_format = BlockCompressionFormat::BC1;
+	IntVec2 m_dimensions = IntVec2::ZERO;
+	uint64_t m_sourceHash = 0;
+	std::vector<size_t> m_mipOffsets; // First byte of each mip level, from m_blocks
+	unsigned char const* m_blocks = nullptr; // Into m_cookedBlocks or m_mappedFile
+	size_t m_blocksSize = 0;
+	std::vector<unsigned char> m_cookedBlocks;
+	MappedFile m_mappedFile;
+};
@@ -2,6 +2,7 @@
 #include "Engine/Core/VertexUtils.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Renderer/BitmapFont.hpp"
+#include "Engine/Renderer/TextLayoutCache.hpp"
 #include "Engine/Network/RemoteConsole.hpp"
 #include "Engine/Core/XmlUtils.hpp"
 #include "Engine/Core/FileUtils.hpp"
@@ -18,6 +19,7 @@ DevConsole* g_theConsole = nullptr;
 DevConsole::DevConsole(DevConsoleConfig const& config) :
 	m_config(config),
 	m_mode(config.m_mode),
+	m_lines(config.m_maxLines, config.m_lineOverflowArenaBytes),
 	m_maxCommandHistory(config.m_maxCommandHistory)
 {
 	SubscribeEventCallbackFunction("HandleKeyPressedDev", Event_KeyPressed);
@@ -42,12 +44,13 @@ DevConsole::~DevConsole()
 
 void DevConsole::Startup()
 {
-	
-	m_linesMutex.lock();
-	m_lines.clear();
-	m_lines.reserve(600);
-	m_linesMutex.unlock();
+	m_lines.Clear();
 
+	if (!m_config.m_logFilePath.empty()) {
+		m_lines.StartDiskSink(m_config.m_logFilePath, m_config.m_logFlushIntervalMs);
+	}
+
+	m_textLayoutCache = new TextLayoutCache();
 	AddLine(INFO_MINOR_COLOR, "Type help for a list of commands");
 
 #if defined(ENGINE_USE_NETWORK)
@@ -64,6 +67,11 @@ void DevConsole::Shutdown()
 #if defined(ENGINE_USE_NETWORK)
 	m_remoteConsole->Shutdown();
 #endif
+
+	m_lines.StopDiskSink();
+
+	delete m_textLayoutCache;
+	m_textLayoutCache = nullptr;
 }
 
 void DevConsole::BeginFrame()
@@ -77,6 +85,9 @@ void DevConsole::BeginFrame()
 void DevConsole::EndFrame()
 {
 	m_frameNumber++;
+	if (m_textLayoutCache) {
+		m_textLayoutCache->AdvanceFrame();
+	}
 #if defined(ENGINE_USE_NETWORK)
 	m_remoteConsole->Update();
 #endif
@@ -161,7 +172,7 @@ bool DevConsole::ExecuteXmlCommandScriptFile(std::filesystem::path const& filePa
 {
 	tinyxml2::XMLDocument xmlDoc;
 	std::string fileString = filePath.string().c_str();
-	XMLError loadConfigStatus = xmlDoc.LoadFile(filePath.string().c_str());
+	XMLError loadConfigStatus = LoadXmlDocumentFromFile(xmlDoc, fileString);
 	GUARANTEE_OR_DIE(loadConfigStatus == XMLError::XML_SUCCESS, "XML COMMAND FILE DOES NOT EXIST OR CANNOT BE FOUND");
 
 	XMLElement const* currentElement = xmlDoc.FirstChildElement("CommandScript")->FirstChildElement();
@@ -178,9 +189,12 @@ bool DevConsole::ExecuteXmlCommandScriptFile(std::filesystem::path const& filePa
 
 void DevConsole::AddLine(Rgba8 const& color, std::string const& text)
 {
-	m_linesMutex.lock();
-	m_lines.emplace_back(color, text, m_frameNumber);
-	m_linesMutex.unlock();
+	m_lines.AddLine(color, text.data(), text.size(), m_frameNumber.load(std::memory_order_relaxed));
+}
+
+void DevConsole::AddLine(Rgba8 const& color, char const* text)
+{
+	m_lines.AddLine(color, text, strlen(text), m_frameNumber.load(std::memory_order_relaxed));
 }
 
 void DevConsole::Render(AABB2 const& bounds, Renderer* rendererOverride) const
@@ -240,9 +254,7 @@ void DevConsole::SetRenderer(Renderer* newRenderer)
 
 void DevConsole::Clear()
 {
-	m_linesMutex.lock();
-	m_lines.clear();
-	m_linesMutex.unlock();
+	m_lines.Clear();
 }
 
 void DevConsole::Render_OpenFull(AABB2 const& bounds, Renderer& renderer, BitmapFont& font, float fontAspect) const
@@ -263,26 +275,30 @@ void DevConsole::Render_OpenFull(AABB2 const& bounds, Renderer& renderer, Bitmap
 	AddVertsForAABB2D(blackOverlayVerts, bounds, Rgba8::TRANSPARENT_BLACK);
 	AddVertsForAABB2D(whiteInputOverlayVerts, inputBounds, Rgba8::TRANSPARENT_WHITE);
 
+	// Only the lines that fit on screen are read out of the ring, newest first
+	int roundedUpMaxLinesShown = RoundDownToInt(m_config.m_maxLinesShown) + 2;
+	int visibleLineCount = m_lines.GetLatestLines(m_visibleLines, roundedUpMaxLinesShown);
+
 	std::vector<Vertex_PCU> textVerts;
-	textVerts.reserve(m_lines.size() * 40);
+	textVerts.reserve(visibleLineCount * 40);
 
-	int roundedUpMaxLinesShown = RoundDownToInt(m_config.m_maxLinesShown) + 2;
 	float lineWidth = 0;
-
-	m_linesMutex.lock();
-	for (int lineIndex = (int)m_lines.size() - 1; lineIndex >= 0; lineIndex-- && roundedUpMaxLinesShown >= 0, roundedUpMaxLinesShown--) {
-		DevConsoleLine const& line = m_lines[lineIndex];
+	for (int visibleIndex = 0; visibleIndex < visibleLineCount; visibleIndex++) {
+		DevConsoleLine const& line = m_visibleLines[visibleIndex];
 		lineWidth = font.GetTextWidth(cellHeight, line.m_text);
 
 		AABB2 lineAABB2(Vec2::ZERO, Vec2(lineWidth, cellHeight));
 		bounds.AlignABB2WithinBounds(lineAABB2, Vec2(0.0f, 1.0f));
 
-		lineAABB2.m_mins.y = minGroupTextHeight + (((int)m_lines.size() - 1 - lineIndex) * cellHeight);
+		lineAABB2.m_mins.y = minGroupTextHeight + (visibleIndex * cellHeight);
 
-		font.AddVertsForTextInBox2D(textVerts, lineAABB2, cellHeight, line.m_text, line.m_color, fontAspect, Vec2::ZERO, TextBoxMode::OVERRUN);
+		if (m_textLayoutCache) {
+			m_textLayoutCache->AddVertsForTextInBox2D(textVerts, font, lineAABB2, cellHeight, line.m_text, line.m_color, fontAspect, Vec2::ZERO, TextBoxMode::OVERRUN);
+		}
+		else {
+			font.AddVertsForTextInBox2D(textVerts, lineAABB2, cellHeight, line.m_text, line.m_color, fontAspect, Vec2::ZERO, TextBoxMode::OVERRUN);
+		}
 	}
-
-	m_linesMutex.unlock();
 	//#TODO DX12 FIXTHIS
 
 	//renderer.BindTexture(nullptr);
@@ -328,7 +344,12 @@ void DevConsole::Render_UserInput(Renderer& renderer, BitmapFont& font, float fo
 
 	float lineWidth = font.GetTextWidth(cellHeight, m_inputText);
 	AABB2 inputLineAABB2(Vec2::ZERO, Vec2(lineWidth, cellHeight));
-	font.AddVertsForTextInBox2D(userInputTextVerts, inputLineAABB2, cellHeight, m_inputText, Rgba8::CYAN, fontAspect, Vec2::ZERO, TextBoxMode::OVERRUN);
+	if (m_textLayoutCache) {
+		m_textLayoutCache->AddVertsForTextInBox2D(userInputTextVerts, font, inputLineAABB2, cellHeight, m_inputText, Rgba8::CYAN, fontAspect, Vec2::ZERO, TextBoxMode::OVERRUN);
+	}
+	else {
+		font.AddVertsForTextInBox2D(userInputTextVerts, inputLineAABB2, cellHeight, m_inputText, Rgba8::CYAN, fontAspect, Vec2::ZERO, TextBoxMode::OVERRUN);
+	}
 	//#TODO DX12 FIXTHIS
 
 	renderer.DrawVertexArray(userInputTextVerts);
@@ -418,13 +439,6 @@ Strings DevConsole::ProcessCommandLine(std::string const& commandLine) const
 	return processedCmd;
 }
 
-DevConsoleLine::DevConsoleLine(Rgba8 const& color, std::string const& text, int frameNumber) :
-	m_color(color),
-	m_text(text),
-	m_frameNumber(frameNumber)
-{
-}
-
 bool DevConsole::Command_Test(EventArgs& args)
 {
 	UNUSED(args);
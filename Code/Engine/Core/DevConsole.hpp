@@ -5,23 +5,15 @@
 #include "Engine/Core/EventSystem.hpp"
 #include "Engine/Core/Clock.hpp"
 #include "Engine/Core/Stopwatch.hpp"
+#include "Engine/Core/DevConsoleLineBuffer.hpp"
 
 #include <string>
 #include <vector>
-#include <mutex>
 
 class Renderer;
 class BitmapFont;
 class RemoteConsole;
-
-struct DevConsoleLine {
-
-	DevConsoleLine(Rgba8 const& color, std::string const& text, int frameNumber);
-
-	Rgba8 m_color = Rgba8::WHITE;
-	std::string m_text = "";
-	int m_frameNumber = 0;
-};
+class TextLayoutCache;
 
 enum class DevConsoleMode {
 	HIDDEN,
@@ -35,6 +27,10 @@ struct DevConsoleConfig {
 	float m_fontAspect = 0.6f;
 	float m_maxLinesShown = 20.5f;
 	int m_maxCommandHistory = 128;
+	int m_maxLines = 4096; // Rounded up to a power of two, oldest lines are overwritten
+	size_t m_lineOverflowArenaBytes = 256 * 1024;
+	std::string m_logFilePath = ""; // When set, the log is appended to this file in batches from a background thread
+	int m_logFlushIntervalMs = 100;
 };
 
 namespace tinyxml2 {
@@ -60,6 +56,7 @@ public:
 	bool ExecuteXmlCommandScriptNode(XMLElement const& cmdScriptXmlElement);
 	bool ExecuteXmlCommandScriptFile(std::filesystem::path const& filePath);
 	void AddLine(Rgba8 const& color, std::string const& text);
+	void AddLine(Rgba8 const& color, char const* text);
 	void Render(AABB2 const& bounds, Renderer* rendererOverride = nullptr) const;
 
 	DevConsoleMode GetMode() const;
@@ -84,6 +81,7 @@ public:
 
 	Clock m_clock;
 	RemoteConsole* m_remoteConsole = nullptr;
+	TextLayoutCache* m_textLayoutCache = nullptr; // Console lines only move when a new one comes in, their quads are reused until then. Null outside Startup/Shutdown, text is laid out uncached then
 
 protected:
 	void Render_OpenFull(AABB2 const& bounds, Renderer& renderer, BitmapFont& font, float fontAspect = 1.0f) const;
@@ -95,9 +93,9 @@ protected:
 	DevConsoleConfig m_config;
 	DevConsoleMode m_mode = DevConsoleMode::HIDDEN;
 
-	mutable std::mutex m_linesMutex;
-	std::vector<DevConsoleLine> m_lines;
-	int m_frameNumber = 0;
+	DevConsoleLineBuffer m_lines;
+	mutable std::vector<DevConsoleLine> m_visibleLines;
+	std::atomic<int> m_frameNumber = 0;
 
 	Stopwatch m_caretStopwatch;
 	std::string m_inputText;
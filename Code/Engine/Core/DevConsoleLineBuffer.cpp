@@ -0,0 +1,238 @@
+#include "Engine/Core/DevConsoleLineBuffer.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+namespace {
+	uint64_t RoundUpToPowerOfTwo(uint64_t value)
+	{
+		uint64_t result = 1;
+		while (result < value) {
+			result <<= 1;
+		}
+		return result;
+	}
+}
+
+DevConsoleLine::DevConsoleLine(Rgba8 const& color, std::string const& text, int frameNumber) :
+	m_color(color),
+	m_text(text),
+	m_frameNumber(frameNumber)
+{
+}
+
+DevConsoleLineBuffer::DevConsoleLineBuffer(int lineCapacity, size_t overflowArenaBytes)
+{
+	uint64_t capacity = RoundUpToPowerOfTwo((lineCapacity > 0) ? (uint64_t)lineCapacity : 1);
+	m_records = new LineRecord[capacity];
+	m_capacityMask = capacity - 1;
+
+	m_overflowArenaSize = overflowArenaBytes;
+	if (m_overflowArenaSize > 0) {
+		m_overflowArena = new char[m_overflowArenaSize];
+	}
+}
+
+DevConsoleLineBuffer::~DevConsoleLineBuffer()
+{
+	StopDiskSink();
+
+	delete[] m_records;
+	m_records = nullptr;
+
+	delete[] m_overflowArena;
+	m_overflowArena = nullptr;
+}
+
+void DevConsoleLineBuffer::AddLine(Rgba8 const& color, char const* text, size_t textLength, int frameNumber)
+{
+	uint64_t ticket = m_writeTicket.fetch_add(1, std::memory_order_relaxed);
+	LineRecord& record = m_records[ticket & m_capacityMask];
+	uint64_t writingSequence = (ticket * 2) + 1;
+
+	// Claim the slot. It can only be busy if a producer a whole lap behind is still writing to it;
+	// if a newer lap already owns it, this line is the older one and gets dropped
+	uint64_t currentSequence = record.m_sequence.load(std::memory_order_acquire);
+	for (;;) {
+		if (currentSequence >= writingSequence) {
+			m_droppedLines.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		if ((currentSequence & 1) != 0) {
+			std::this_thread::yield();
+			currentSequence = record.m_sequence.load(std::memory_order_acquire);
+			continue;
+		}
+
+		if (record.m_sequence.compare_exchange_weak(currentSequence, writingSequence, std::memory_order_acquire)) break;
+	}
+
+	size_t inlineLength = (std::min)(textLength, (size_t)DEV_CONSOLE_LINE_INLINE_TEXT);
+	size_t overflowLength = (m_overflowArena) ? (std::min)(textLength - inlineLength, (size_t)(m_overflowArenaSize / 4)) : 0;
+
+	record.m_color = color;
+	record.m_frameNumber = frameNumber;
+	record.m_textLength = (uint32_t)(inlineLength + overflowLength);
+	memcpy(record.m_inlineText, text, inlineLength);
+
+	if (overflowLength > 0) {
+		uint64_t arenaOffset = m_arenaHead.fetch_add(overflowLength, std::memory_order_relaxed);
+		record.m_arenaOffset = arenaOffset;
+
+		size_t arenaStart = (size_t)(arenaOffset % m_overflowArenaSize);
+		size_t firstCopyLength = (std::min)(overflowLength, (size_t)(m_overflowArenaSize - arenaStart));
+		memcpy(m_overflowArena + arenaStart, text + inlineLength, firstCopyLength);
+		memcpy(m_overflowArena, text + inlineLength + firstCopyLength, overflowLength - firstCopyLength);
+	}
+
+	record.m_sequence.store(writingSequence + 1, std::memory_order_release);
+}
+
+void DevConsoleLineBuffer::Clear()
+{
+	m_clearedTicket.store(m_writeTicket.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+bool DevConsoleLineBuffer::ReadLine(uint64_t ticket, DevConsoleLine& outLine) const
+{
+	LineRecord const& record = m_records[ticket & m_capacityMask];
+	uint64_t committedSequence = (ticket + 1) * 2;
+
+	if (record.m_sequence.load(std::memory_order_acquire) != committedSequence) return false;
+
+	outLine.m_color = record.m_color;
+	outLine.m_frameNumber = record.m_frameNumber;
+
+	size_t textLength = record.m_textLength;
+	size_t inlineLength = (std::min)(textLength, (size_t)DEV_CONSOLE_LINE_INLINE_TEXT);
+	uint64_t arenaOffset = record.m_arenaOffset;
+	outLine.m_text.assign(record.m_inlineText, inlineLength);
+
+	// The record may have been overwritten while it was copied
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (record.m_sequence.load(std::memory_order_relaxed) != committedSequence) return false;
+
+	size_t overflowLength = textLength - inlineLength;
+	if (overflowLength > 0) {
+		size_t arenaStart = (size_t)(arenaOffset % m_overflowArenaSize);
+		size_t firstCopyLength = (std::min)(overflowLength, (size_t)(m_overflowArenaSize - arenaStart));
+		outLine.m_text.append(m_overflowArena + arenaStart, firstCopyLength);
+		outLine.m_text.append(m_overflowArena, overflowLength - firstCopyLength);
+
+		// Once the arena head has moved a whole arena past this text, it may have been overwritten. Keep the inline part only
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if ((m_arenaHead.load(std::memory_order_relaxed) - arenaOffset) > m_overflowArenaSize) {
+			outLine.m_text.resize(inlineLength);
+			outLine.m_text += "...";
+		}
+	}
+
+	return true;
+}
+
+int DevConsoleLineBuffer::GetLatestLines(std::vector<DevConsoleLine>& outLines, int maxLines) const
+{
+	if ((int)outLines.size() < maxLines) {
+		outLines.resize(maxLines);
+	}
+
+	uint64_t endTicket = m_writeTicket.load(std::memory_order_acquire);
+	uint64_t capacity = m_capacityMask + 1;
+	uint64_t oldestTicket = (endTicket > capacity) ? endTicket - capacity : 0;
+	oldestTicket = (std::max)(oldestTicket, m_clearedTicket.load(std::memory_order_acquire));
+
+	// Only the visible window is read. Lines still being written are skipped this frame
+	int lineCount = 0;
+	for (uint64_t ticket = endTicket; (ticket > oldestTicket) && (lineCount < maxLines); ticket--) {
+		if (ReadLine(ticket - 1, outLines[lineCount])) {
+			lineCount++;
+		}
+	}
+
+	return lineCount;
+}
+
+bool DevConsoleLineBuffer::StartDiskSink(std::string const& logFilePath, int flushIntervalMs)
+{
+	if (m_diskSinkThread) return false;
+
+	std::filesystem::path directoryPath = std::filesystem::path(logFilePath).parent_path();
+	if (!directoryPath.empty() && !std::filesystem::exists(directoryPath)) {
+		std::filesystem::create_directories(directoryPath);
+	}
+
+	// Truncate once, the sink appends from then on
+	FILE* logFile = nullptr;
+	if (fopen_s(&logFile, logFilePath.c_str(), "wb") != 0 || !logFile) return false;
+	fclose(logFile);
+
+	m_logFilePath = logFilePath;
+	m_flushIntervalMs = (flushIntervalMs > 0) ? flushIntervalMs : 1;
+	m_diskSinkTicket = m_writeTicket.load(std::memory_order_acquire);
+	m_isDiskSinkQuitting = false;
+	m_diskSinkThread = new std::thread(&DevConsoleLineBuffer::DiskSinkMain, this);
+	return true;
+}
+
+void DevConsoleLineBuffer::StopDiskSink()
+{
+	if (!m_diskSinkThread) return;
+
+	m_isDiskSinkQuitting = true;
+	m_diskSinkThread->join();
+	delete m_diskSinkThread;
+	m_diskSinkThread = nullptr;
+}
+
+void DevConsoleLineBuffer::DiskSinkMain()
+{
+	std::string batchText;
+	batchText.reserve(64 * 1024);
+
+	FILE* logFile = nullptr;
+	if (fopen_s(&logFile, m_logFilePath.c_str(), "ab") != 0 || !logFile) return;
+
+	while (!m_isDiskSinkQuitting) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(m_flushIntervalMs));
+		FlushToDisk(batchText, logFile);
+	}
+
+	// Whatever was logged up to shutdown
+	FlushToDisk(batchText, logFile);
+	fclose(logFile);
+}
+
+void DevConsoleLineBuffer::FlushToDisk(std::string& batchText, FILE* logFile)
+{
+	uint64_t endTicket = m_writeTicket.load(std::memory_order_acquire);
+	uint64_t capacity = m_capacityMask + 1;
+
+	batchText.clear();
+	if ((endTicket - m_diskSinkTicket) > capacity) {
+		uint64_t lappedTicket = endTicket - capacity;
+		batchText += Stringf("[%llu lines dropped]\n", lappedTicket - m_diskSinkTicket);
+		m_diskSinkTicket = lappedTicket;
+	}
+
+	DevConsoleLine line;
+	for (; m_diskSinkTicket < endTicket; m_diskSinkTicket++) {
+		// A line still being written is picked up on the next flush, one already overwritten is skipped
+		LineRecord const& record = m_records[m_diskSinkTicket & m_capacityMask];
+		if (record.m_sequence.load(std::memory_order_acquire) < ((m_diskSinkTicket + 1) * 2)) break;
+
+		if (ReadLine(m_diskSinkTicket, line)) {
+			batchText += Stringf("[%d] ", line.m_frameNumber);
+			batchText += line.m_text;
+			batchText += '\n';
+		}
+	}
+
+	if (!batchText.empty()) {
+		fwrite(batchText.data(), 1, batchText.size(), logFile);
+		fflush(logFile);
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "Engine/Core/Rgba8.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr int DEV_CONSOLE_LINE_INLINE_TEXT = 96; // Longer lines spill the rest of their text into the overflow arena
+
+struct DevConsoleLine {
+	DevConsoleLine() = default;
+	DevConsoleLine(Rgba8 const& color, std::string const& text, int frameNumber);
+
+	Rgba8 m_color = Rgba8::WHITE;
+	std::string m_text = "";
+	int m_frameNumber = 0;
+};
+
+/// <summary>
+/// Bounded multi producer / single consumer ring of console lines. AddLine never allocates nor locks:
+/// a producer claims a ticket, then writes a fixed size record in place. Old lines are overwritten once the ring wraps.
+/// Records are validated with a sequence number (seqlock), so readers never see a half written line
+/// </summary>
+class DevConsoleLineBuffer {
+public:
+	DevConsoleLineBuffer(int lineCapacity, size_t overflowArenaBytes);
+	~DevConsoleLineBuffer();
+
+	void AddLine(Rgba8 const& color, char const* text, size_t textLength, int frameNumber);
+	void Clear();
+
+	// Newest first. outLines is only grown, so its strings keep their capacity from frame to frame
+	int GetLatestLines(std::vector<DevConsoleLine>& outLines, int maxLines) const;
+	bool ReadLine(uint64_t ticket, DevConsoleLine& outLine) const;
+
+	uint64_t GetWriteTicket() const { return m_writeTicket.load(std::memory_order_acquire); }
+	uint64_t GetDroppedLines() const { return m_droppedLines.load(std::memory_order_relaxed); }
+	int GetCapacity() const { return (int)(m_capacityMask + 1); }
+
+	// Background thread appending the log to disk in batches. Lines lapped by the ring before the sink gets to them are reported as dropped
+	bool StartDiskSink(std::string const& logFilePath, int flushIntervalMs);
+	void StopDiskSink();
+
+private:
+	struct alignas(64) LineRecord {
+		std::atomic<uint64_t> m_sequence = 0; // Odd while being written, (ticket + 1) * 2 once committed
+		Rgba8 m_color;
+		int m_frameNumber = 0;
+		uint32_t m_textLength = 0;
+		uint64_t m_arenaOffset = 0;
+		char m_inlineText[DEV_CONSOLE_LINE_INLINE_TEXT] = {};
+	};
+
+	void DiskSinkMain();
+	void FlushToDisk(std::string& batchText, FILE* logFile);
+
+private:
+	LineRecord* m_records = nullptr;
+	uint64_t m_capacityMask = 0;
+
+	char* m_overflowArena = nullptr;
+	uint64_t m_overflowArenaSize = 0;
+
+	alignas(64) std::atomic<uint64_t> m_writeTicket = 0;
+	alignas(64) std::atomic<uint64_t> m_arenaHead = 0;
+	std::atomic<uint64_t> m_clearedTicket = 0;
+	std::atomic<uint64_t> m_droppedLines = 0;
+
+	std::string m_logFilePath;
+	std::thread* m_diskSinkThread = nullptr;
+	std::atomic<bool> m_isDiskSinkQuitting = false;
+	uint64_t m_diskSinkTicket = 0;
+	int m_flushIntervalMs = 100;
+};
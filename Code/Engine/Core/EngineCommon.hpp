@@ -16,6 +16,9 @@
 class NamedProperties;
 class EventSystem;
 class DevConsole;
+class VirtualFileSystem;
+class Profiler;
+class MetricsRegistry;
 
 extern NamedStrings g_gameConfigBlackboard;
 
@@ -25,6 +28,9 @@ extern DevConsole* g_theConsole;
 extern EventSystem* g_theEventSystem;
 extern JobSystem* g_theJobSystem;
 extern NetworkSystem* g_theNetwork;
+extern VirtualFileSystem* g_theVFS;
+extern Profiler* g_theProfiler;
+extern MetricsRegistry* g_theMetrics;
 
 
 enum class MemoryUsage {
@@ -1,6 +1,7 @@
 #include "Engine/Core/EventSystem.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/NamedProperties.hpp"
+#include "Engine/Core/Metrics.hpp"
 
 EventSystem* g_theEventSystem = nullptr;
 
@@ -121,6 +122,8 @@ void EventSystem::UnsubscribeEventCallbackFunction(std::string const& eventName,
 
 bool EventSystem::FireEvent(std::string const& eventName, EventArgs& args)
 {
+	METRIC_COUNTER_ADD("events.fired", 1);
+
 	SubscriptionList const* eventSubList = nullptr;
 
 	m_subsListMutex.lock();
@@ -150,6 +153,8 @@ bool EventSystem::FireEvent(std::string const& eventName, EventArgs& args)
 
 bool EventSystem::FireEvent(std::string const& eventName)
 {
+	METRIC_COUNTER_ADD("events.fired", 1);
+
 	SubscriptionList const* eventSubList = nullptr;
 
 	m_subsListMutex.lock();
@@ -1,11 +1,53 @@
 #include "Engine/Core/FileUtils.hpp"
 #include "Engine/Core/StringUtils.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/JobSystem.hpp"
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <iostream>
 #include <fstream>
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
 
+extern JobSystem* g_theJobSystem;
+
+class FileReadJob : public Job {
+public:
+	FileReadJob(std::string const& filename, FileReadCallback const& onRead) :
+		Job(DEFAULT_JOB_ID, true),
+		m_onRead(onRead)
+	{
+		m_result.m_filename = filename;
+	}
+
+	std::future<FileReadResult> GetFuture() { return m_promise.get_future(); }
+
+	virtual void Execute() override
+	{
+		m_result.m_errorCode = FileReadToBuffer(m_result.m_buffer, m_result.m_filename);
+	}
+
+	virtual void OnFinished() override
+	{
+		if (m_onRead) {
+			m_onRead(m_result);
+		}
+		m_promise.set_value(std::move(m_result));
+	}
+
+	virtual void OnCancelled() override
+	{
+		// Never read, waiting futures get the read failure code instead of a broken promise
+		m_result.m_errorCode = -1;
+		m_result.m_buffer.clear();
+		OnFinished();
+	}
+
+private:
+	FileReadResult m_result;
+	FileReadCallback m_onRead;
+	std::promise<FileReadResult> m_promise;
+};
 
 bool FileExists(const std::string& filename)
 {
@@ -37,27 +79,48 @@ int FileWriteFromBuffer(std::vector<uint8_t>& inBuffer, const std::string& filen
 
 int FileReadToBuffer(std::vector<uint8_t>& outBuffer, const std::string& filename)
 {
-	std::ifstream inFile(filename, std::ifstream::in | std::ifstream::binary);
-	size_t fileSize = static_cast<size_t>(inFile.tellg());
+	std::ifstream inFile(filename, std::ifstream::in | std::ifstream::binary | std::ifstream::ate);
 
-	inFile.seekg(0, std::ios::end);
+	if (!inFile.is_open()) {
+		ERROR_RECOVERABLE(Stringf("ERROR TRYING TO OPEN THE FILE, MAY NOT EXIST %s", filename.c_str()));
+		return -1;
+	}
 
-	fileSize = static_cast<size_t>(inFile.tellg()) - fileSize;
+	size_t fileSize = static_cast<size_t>(inFile.tellg());
 	outBuffer.resize(fileSize);
 
 	inFile.seekg(0, std::ios::beg);
+	inFile.read(reinterpret_cast<char*>(outBuffer.data()), fileSize);
 
-	if (!inFile.is_open()) {
+	if (inFile.bad()) {
 		inFile.close();
-		ERROR_RECOVERABLE(Stringf("ERROR TRYING TO OPEN THE FILE, MAY NOT EXIST %s", filename.c_str()));
+		ERROR_RECOVERABLE(Stringf("ERROR TRYING TO READ TO  BUFFER TO FILE: %s", filename.c_str()));
+		return -1;
 	}
-	else {
-		inFile.read(reinterpret_cast<char*>(outBuffer.data()), fileSize);
+
+	inFile.close();
+	return 0;
+}
+
+int FileReadToString(std::string& outString, const std::string& filename)
+{
+	// Read straight into the string, no intermediate byte buffer
+	std::ifstream inFile(filename, std::ifstream::in | std::ifstream::binary | std::ifstream::ate);
+
+	if (!inFile.is_open()) {
+		ERROR_RECOVERABLE(Stringf("ERROR TRYING TO OPEN THE FILE, MAY NOT EXIST %s", filename.c_str()));
+		return -1;
 	}
 
+	size_t fileSize = static_cast<size_t>(inFile.tellg());
+	outString.resize(fileSize);
+
+	inFile.seekg(0, std::ios::beg);
+	inFile.read(outString.data(), fileSize);
+
 	if (inFile.bad()) {
 		inFile.close();
-		ERROR_RECOVERABLE(Stringf("ERROR TRYING TO READ TO  BUFFER TO FILE: %s", filename.c_str()));
+		ERROR_RECOVERABLE(Stringf("ERROR TRYING TO READ TO STRING FROM FILE: %s", filename.c_str()));
 		return -1;
 	}
 
@@ -65,18 +128,172 @@ int FileReadToBuffer(std::vector<uint8_t>& outBuffer, const std::string& filenam
 	return 0;
 }
 
-int FileReadToString(std::string& outString, const std::string& filename)
+int FileReadToStringView(std::string_view& outView, MappedFile& outMappedFile, const std::string& filename)
 {
-	std::vector<uint8_t> fileBuffer;
-	int result = FileReadToBuffer(fileBuffer, filename);
-	if (result != 0) {
+	if (!outMappedFile.Open(filename)) {
+		outView = std::string_view();
 		return -1;
 	}
 
-	fileBuffer.push_back('\0');
+	outView = outMappedFile.GetStringView();
+	return 0;
+}
 
-	outString = std::string((char*)fileBuffer.data());
+MappedFile::MappedFile(std::string const& filename)
+{
+	Open(filename);
+}
 
-	return 0;
+MappedFile::MappedFile(MappedFile&& moveFrom) noexcept
+{
+	*this = std::move(moveFrom);
 }
 
+MappedFile& MappedFile::operator=(MappedFile&& moveFrom) noexcept
+{
+	if (this == &moveFrom) return *this;
+	Close();
+
+	m_filename = std::move(moveFrom.m_filename);
+	m_fileHandle = moveFrom.m_fileHandle;
+	m_mappingHandle = moveFrom.m_mappingHandle;
+	m_data = moveFrom.m_data;
+	m_size = moveFrom.m_size;
+	m_isValid = moveFrom.m_isValid;
+
+	moveFrom.m_fileHandle = nullptr;
+	moveFrom.m_mappingHandle = nullptr;
+	moveFrom.m_data = nullptr;
+	moveFrom.m_size = 0;
+	moveFrom.m_isValid = false;
+
+	return *this;
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(std::string const& filename)
+{
+	Close();
+	m_filename = filename;
+
+	HANDLE fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE) {
+		// Missing files are expected by callers probing for caches or overrides, they report errors themselves
+		DebuggerPrintf("COULD NOT OPEN THE FILE, MAY NOT EXIST %s\n", filename.c_str());
+		return false;
+	}
+
+	LARGE_INTEGER fileSize = {};
+	if (!GetFileSizeEx(fileHandle, &fileSize)) {
+		CloseHandle(fileHandle);
+		DebuggerPrintf("COULD NOT GET THE SIZE OF FILE %s\n", filename.c_str());
+		return false;
+	}
+
+	m_fileHandle = fileHandle;
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+
+	// Empty files cannot be mapped, but they are still valid files
+	if (m_size == 0) {
+		m_isValid = true;
+		return true;
+	}
+
+	HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mappingHandle) {
+		Close();
+		DebuggerPrintf("COULD NOT MAP FILE %s\n", filename.c_str());
+		return false;
+	}
+	m_mappingHandle = mappingHandle;
+
+	m_data = reinterpret_cast<uint8_t const*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (!m_data) {
+		Close();
+		DebuggerPrintf("COULD NOT MAP VIEW OF FILE %s\n", filename.c_str());
+		return false;
+	}
+
+	m_isValid = true;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data) {
+		UnmapViewOfFile(m_data);
+		m_data = nullptr;
+	}
+
+	if (m_mappingHandle) {
+		CloseHandle(m_mappingHandle);
+		m_mappingHandle = nullptr;
+	}
+
+	if (m_fileHandle) {
+		CloseHandle(m_fileHandle);
+		m_fileHandle = nullptr;
+	}
+
+	m_size = 0;
+	m_isValid = false;
+}
+
+std::string_view MappedFile::GetStringView() const
+{
+	if (!m_data) return std::string_view();
+	return std::string_view(reinterpret_cast<char const*>(m_data), m_size);
+}
+
+std::future<FileReadResult> FileReadAsync(std::string const& filename, FileReadCallback const& onRead)
+{
+	FileReadJob* readJob = new FileReadJob(filename, onRead);
+	std::future<FileReadResult> readFuture = readJob->GetFuture();
+
+	if (g_theJobSystem && (g_theJobSystem->GetNumThreads() > 0)) {
+		g_theJobSystem->QueueJob(readJob);
+	}
+	else {
+		readJob->Execute();
+		readJob->OnFinished();
+		delete readJob;
+	}
+
+	return readFuture;
+}
+
+std::vector<std::future<FileReadResult>> FileReadBatchAsync(Strings const& filenames, FileReadCallback const& onEachRead)
+{
+	std::vector<std::future<FileReadResult>> readFutures;
+	readFutures.reserve(filenames.size());
+
+	bool useJobSystem = g_theJobSystem && (g_theJobSystem->GetNumThreads() > 0);
+
+	std::vector<Job*> readJobs;
+	readJobs.reserve(filenames.size());
+
+	for (std::string const& filename : filenames) {
+		FileReadJob* readJob = new FileReadJob(filename, onEachRead);
+		readFutures.push_back(readJob->GetFuture());
+
+		if (useJobSystem) {
+			readJobs.push_back(readJob);
+		}
+		else {
+			readJob->Execute();
+			readJob->OnFinished();
+			delete readJob;
+		}
+	}
+
+	// Single lock on the queue for the whole batch
+	if (!readJobs.empty()) {
+		g_theJobSystem->QueueJobs(readJobs);
+	}
+
+	return readFutures;
+}
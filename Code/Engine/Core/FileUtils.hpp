@@ -1,7 +1,11 @@
 #pragma once
+#include "Engine/Core/StringUtils.hpp"
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <future>
+#include <functional>
 #include <filesystem>
 
 bool FileExists(const std::string& filename);
@@ -9,3 +13,65 @@ int FileWriteFromBuffer(std::vector<uint8_t>& inBuffer, const std::string& filen
 int FileReadToBuffer(std::vector<uint8_t>& outBuffer, const std::string& filename);
 int FileReadToString(std::string& outString, const std::string& filename);
 
+// ---------------------------------------------------------------------------------------------------------------------
+// Memory mapped files
+struct ByteSpan {
+	uint8_t const* m_data = nullptr;
+	size_t m_size = 0;
+
+	uint8_t const* begin() const { return m_data; }
+	uint8_t const* end() const { return m_data + m_size; }
+	bool IsEmpty() const { return m_size == 0; }
+};
+
+/// <summary>
+/// Read only view of a whole file mapped into the address space. The OS pages the contents in on demand,
+/// nothing is copied. The mapping (and any span/string view taken from it) lives as long as this object
+/// </summary>
+class MappedFile {
+public:
+	MappedFile() = default;
+	explicit MappedFile(std::string const& filename);
+	MappedFile(MappedFile&& moveFrom) noexcept;
+	MappedFile& operator=(MappedFile&& moveFrom) noexcept;
+	MappedFile(MappedFile const& copyFrom) = delete;
+	MappedFile& operator=(MappedFile const& copyFrom) = delete;
+	~MappedFile();
+
+	// False when the file cannot be opened or mapped, only printed to the debugger: callers decide whether that is an error
+	bool Open(std::string const& filename);
+	void Close();
+
+	bool IsValid() const { return m_isValid; }
+	uint8_t const* GetData() const { return m_data; }
+	size_t GetSize() const { return m_size; }
+	ByteSpan GetSpan() const { return ByteSpan{ m_data, m_size }; }
+	std::string_view GetStringView() const;
+	std::string const& GetFilename() const { return m_filename; }
+
+private:
+	std::string m_filename;
+	void* m_fileHandle = nullptr;
+	void* m_mappingHandle = nullptr;
+	uint8_t const* m_data = nullptr;
+	size_t m_size = 0;
+	bool m_isValid = false;
+};
+
+// Zero copy read. The view is only valid while outMappedFile is alive
+int FileReadToStringView(std::string_view& outView, MappedFile& outMappedFile, const std::string& filename);
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Async reads (executed on the JobSystem, or inline if there are no worker threads)
+struct FileReadResult {
+	std::string m_filename;
+	std::vector<uint8_t> m_buffer;
+	int m_errorCode = -1; // Same convention as FileReadToBuffer: 0 on success
+};
+
+typedef std::function<void(FileReadResult const& result)> FileReadCallback;
+
+// The callback runs on the worker thread that read the file, right before the future becomes ready.
+// If the read is cleared from the JobSystem queue, it runs on the clearing thread with m_errorCode -1
+std::future<FileReadResult> FileReadAsync(std::string const& filename, FileReadCallback const& onRead = nullptr);
+std::vector<std::future<FileReadResult>> FileReadBatchAsync(Strings const& filenames, FileReadCallback const& onEachRead = nullptr);
@@ -1,5 +1,159 @@
 #include "Engine/Core/HeatMaps.hpp"
 #include "Engine/Math/RandomNumberGenerator.hpp"
+#include "Engine/Math/SIMDUtils.hpp"
+#include <algorithm>
+#include <intrin.h>
+
+namespace {
+	// Scalar twins of the SIMD helpers, so each per tile operation is written once as a generic lambda used for packs and tails
+	float SimdMin(float a, float b) { return (a < b) ? a : b; }
+	float SimdMax(float a, float b) { return (a > b) ? a : b; }
+
+	template <typename T_Value>
+	T_Value SplatValue(float value);
+	template <>
+	float SplatValue<float>(float value) { return value; }
+	template <>
+	SimdFloatN SplatValue<SimdFloatN>(float value) { return SimdFloatN::Broadcast(value); }
+
+	template <typename T_Operation>
+	void ForEachValue(float* values, int valueCount, T_Operation const& operation)
+	{
+		int valueIndex = 0;
+		for (; valueIndex + SIMD_WIDTH <= valueCount; valueIndex += SIMD_WIDTH) {
+			operation(SimdFloatN::Load(values + valueIndex)).Store(values + valueIndex);
+		}
+		for (; valueIndex < valueCount; valueIndex++) {
+			values[valueIndex] = operation(values[valueIndex]);
+		}
+	}
+
+	template <typename T_Operation>
+	void ForEachValuePair(float* values, float const* otherValues, int valueCount, T_Operation const& operation)
+	{
+		int valueIndex = 0;
+		for (; valueIndex + SIMD_WIDTH <= valueCount; valueIndex += SIMD_WIDTH) {
+			operation(SimdFloatN::Load(values + valueIndex), SimdFloatN::Load(otherValues + valueIndex)).Store(values + valueIndex);
+		}
+		for (; valueIndex < valueCount; valueIndex++) {
+			values[valueIndex] = operation(values[valueIndex], otherValues[valueIndex]);
+		}
+	}
+
+	template <typename T_Compare>
+	int BuildMask(float const* values, int valueCount, IntVec2 const& dimensions, T_Compare const& compare, TileHeatMapMask& outMask)
+	{
+		int wordCount = (valueCount + 63) / 64;
+		outMask.m_dimensions = dimensions;
+		outMask.m_bits.resize(wordCount);
+		outMask.m_setCount = 0;
+
+		for (int wordIndex = 0; wordIndex < wordCount; wordIndex++) {
+			int firstIndex = wordIndex * 64;
+			uint64_t word = 0;
+
+			if (firstIndex + 64 <= valueCount) {
+				for (int laneOffset = 0; laneOffset < 64; laneOffset += SIMD_WIDTH) {
+					word |= (uint64_t)GetMaskBits(compare(SimdFloatN::Load(values + firstIndex + laneOffset))) << laneOffset;
+				}
+			}
+			else {
+				for (int valueIndex = firstIndex; valueIndex < valueCount; valueIndex++) {
+					if (compare(values[valueIndex])) {
+						word |= 1ull << (valueIndex - firstIndex);
+					}
+				}
+			}
+
+			outMask.m_bits[wordIndex] = word;
+			outMask.m_setCount += (int)__popcnt64(word);
+		}
+
+		return outMask.m_setCount;
+	}
+
+	// Lane wise running minimum and where it was seen. Indexes ride along as floats, exact up to 2^24 tiles
+	template <typename T_IsBetter>
+	int GetIndexOfBestValue(float const* values, int valueCount, T_IsBetter const& isBetter)
+	{
+		if (valueCount <= 0) return -1;
+
+		int bestIndex = 0;
+		int valueIndex = 0;
+		if (valueCount >= SIMD_WIDTH) {
+			float laneIndexes[SIMD_WIDTH];
+			for (int lane = 0; lane < SIMD_WIDTH; lane++) {
+				laneIndexes[lane] = (float)lane;
+			}
+
+			SimdFloatN bestValues = SimdFloatN::Load(values);
+			SimdFloatN bestIndexes = SimdFloatN::Load(laneIndexes);
+			SimdFloatN currentIndexes = bestIndexes;
+			SimdFloatN const indexStep = SimdFloatN::Broadcast((float)SIMD_WIDTH);
+
+			for (valueIndex = SIMD_WIDTH; valueIndex + SIMD_WIDTH <= valueCount; valueIndex += SIMD_WIDTH) {
+				currentIndexes = currentIndexes + indexStep;
+				SimdFloatN currentValues = SimdFloatN::Load(values + valueIndex);
+				SimdFloatN betterMask = isBetter(currentValues, bestValues);
+				bestValues = SimdSelect(betterMask, currentValues, bestValues);
+				bestIndexes = SimdSelect(betterMask, currentIndexes, bestIndexes);
+			}
+
+			float laneValues[SIMD_WIDTH];
+			bestValues.Store(laneValues);
+			bestIndexes.Store(laneIndexes);
+			bestIndex = (int)laneIndexes[0];
+			for (int lane = 1; lane < SIMD_WIDTH; lane++) {
+				int laneIndex = (int)laneIndexes[lane];
+				bool isLaneBetter = isBetter(laneValues[lane], values[bestIndex]);
+				bool isLaneTiedEarlier = !isBetter(values[bestIndex], laneValues[lane]) && (laneIndex < bestIndex);
+				if (isLaneBetter || isLaneTiedEarlier) {
+					bestIndex = laneIndex;
+				}
+			}
+		}
+
+		for (; valueIndex < valueCount; valueIndex++) {
+			if (isBetter(values[valueIndex], values[bestIndex])) {
+				bestIndex = valueIndex;
+			}
+		}
+		return bestIndex;
+	}
+}
+
+bool TileHeatMapMask::IsSet(IntVec2 const& coords) const
+{
+	if ((coords.x < 0) || (coords.y < 0) || (coords.x >= m_dimensions.x) || (coords.y >= m_dimensions.y)) return false;
+	return IsSet((coords.y * m_dimensions.x) + coords.x);
+}
+
+IntVec2 TileHeatMapMask::GetRandomSetCoords(RandomNumberGenerator& rng) const
+{
+	if (m_setCount <= 0) return IntVec2(-1, -1);
+
+	// Draw which set tile once, then find it by counting bits a word at a time
+	int remaining = rng.GetRandomIntLessThan(m_setCount);
+	for (int wordIndex = 0; wordIndex < (int)m_bits.size(); wordIndex++) {
+		uint64_t word = m_bits[wordIndex];
+		int wordSetCount = (int)__popcnt64(word);
+		if (remaining >= wordSetCount) {
+			remaining -= wordSetCount;
+			continue;
+		}
+
+		for (; remaining > 0; remaining--) {
+			word &= word - 1; // Drop the lowest set bit
+		}
+
+		unsigned long bitIndex = 0;
+		_BitScanForward64(&bitIndex, word);
+		int tileIndex = (wordIndex * 64) + (int)bitIndex;
+		return IntVec2(tileIndex % m_dimensions.x, tileIndex / m_dimensions.x);
+	}
+
+	return IntVec2(-1, -1);
+}
 
 
 TileHeatMap::TileHeatMap(IntVec2 const& dimensions):
@@ -10,23 +164,163 @@ TileHeatMap::TileHeatMap(IntVec2 const& dimensions):
 	m_values.resize(vecSize);
 }
 
+void TileHeatMap::SetDimensions(IntVec2 const& dimensions)
+{
+	m_dimensions = dimensions;
+	m_values.resize((size_t)dimensions.x * (size_t)dimensions.y);
+}
+
 void TileHeatMap::SetAllValues(float newValue)
 {
-	for (int valuesIndex = 0; valuesIndex < m_values.capacity(); valuesIndex++) {
-		m_values[valuesIndex] = newValue;
+	ForEachValue(m_values.data(), (int)m_values.size(), [&](auto value) {
+		return SplatValue<decltype(value)>(newValue);
+	});
+}
+
+void TileHeatMap::AddToAllValues(float valueToAdd)
+{
+	ForEachValue(m_values.data(), (int)m_values.size(), [&](auto value) {
+		return value + SplatValue<decltype(value)>(valueToAdd);
+	});
+}
+
+void TileHeatMap::ScaleAllValues(float scale)
+{
+	ForEachValue(m_values.data(), (int)m_values.size(), [&](auto value) {
+		return value * SplatValue<decltype(value)>(scale);
+	});
+}
+
+void TileHeatMap::ClampAllValues(float minValue, float maxValue)
+{
+	ForEachValue(m_values.data(), (int)m_values.size(), [&](auto value) {
+		using T_Value = decltype(value);
+		return SimdMin(SimdMax(value, SplatValue<T_Value>(minValue)), SplatValue<T_Value>(maxValue));
+	});
+}
+
+void TileHeatMap::AddMap(TileHeatMap const& otherMap, float scale)
+{
+	GUARANTEE_OR_DIE(otherMap.m_values.size() == m_values.size(), "TileHeatMap::AddMap -> MAPS HAVE DIFFERENT SIZES");
+	ForEachValuePair(m_values.data(), otherMap.m_values.data(), (int)m_values.size(), [&](auto value, auto otherValue) {
+		return value + (otherValue * SplatValue<decltype(value)>(scale));
+	});
+}
+
+void TileHeatMap::MultiplyByMap(TileHeatMap const& otherMap)
+{
+	GUARANTEE_OR_DIE(otherMap.m_values.size() == m_values.size(), "TileHeatMap::MultiplyByMap -> MAPS HAVE DIFFERENT SIZES");
+	ForEachValuePair(m_values.data(), otherMap.m_values.data(), (int)m_values.size(), [](auto value, auto otherValue) {
+		return value * otherValue;
+	});
+}
+
+void TileHeatMap::MinWithMap(TileHeatMap const& otherMap)
+{
+	GUARANTEE_OR_DIE(otherMap.m_values.size() == m_values.size(), "TileHeatMap::MinWithMap -> MAPS HAVE DIFFERENT SIZES");
+	ForEachValuePair(m_values.data(), otherMap.m_values.data(), (int)m_values.size(), [](auto value, auto otherValue) {
+		return SimdMin(value, otherValue);
+	});
+}
+
+void TileHeatMap::MaxWithMap(TileHeatMap const& otherMap)
+{
+	GUARANTEE_OR_DIE(otherMap.m_values.size() == m_values.size(), "TileHeatMap::MaxWithMap -> MAPS HAVE DIFFERENT SIZES");
+	ForEachValuePair(m_values.data(), otherMap.m_values.data(), (int)m_values.size(), [](auto value, auto otherValue) {
+		return SimdMax(value, otherValue);
+	});
+}
+
+template <typename T_Kernel>
+void TileHeatMap::ApplySeparableKernel(int radius, T_Kernel const& combine, float finalScale)
+{
+	int width = m_dimensions.x;
+	int height = m_dimensions.y;
+	if ((radius <= 0) || (width <= 0) || (height <= 0)) return;
+
+	m_scratchValues.resize((size_t)width * (size_t)height);
+
+	// Horizontal pass into scratch. Columns whose window reaches past an edge clamp each tap, the rest load shifted packs
+	for (int rowY = 0; rowY < height; rowY++) {
+		float const* row = &m_values[(size_t)rowY * width];
+		float* outRow = &m_scratchValues[(size_t)rowY * width];
+
+		auto combineClamped = [&](int columnX) {
+			float result = row[(std::max)(columnX - radius, 0)];
+			for (int tapX = columnX - radius + 1; tapX <= columnX + radius; tapX++) {
+				result = combine(result, row[(std::min)((std::max)(tapX, 0), width - 1)]);
+			}
+			outRow[columnX] = result;
+		};
+
+		int columnX = 0;
+		for (; (columnX < radius) && (columnX < width); columnX++) {
+			combineClamped(columnX);
+		}
+		for (; columnX + radius + SIMD_WIDTH <= width; columnX += SIMD_WIDTH) {
+			SimdFloatN result = SimdFloatN::Load(row + columnX - radius);
+			for (int tapOffset = -radius + 1; tapOffset <= radius; tapOffset++) {
+				result = combine(result, SimdFloatN::Load(row + columnX + tapOffset));
+			}
+			result.Store(outRow + columnX);
+		}
+		for (; columnX < width; columnX++) {
+			combineClamped(columnX);
+		}
 	}
+
+	// Vertical pass back into the values, whole rows at a time so every load is contiguous
+	SimdFloatN const finalScales = SimdFloatN::Broadcast(finalScale);
+	for (int rowY = 0; rowY < height; rowY++) {
+		float* outRow = &m_values[(size_t)rowY * width];
+		auto getTapRow = [&](int tapY) {
+			return &m_scratchValues[(size_t)(std::min)((std::max)(tapY, 0), height - 1) * width];
+		};
+
+		int columnX = 0;
+		for (; columnX + SIMD_WIDTH <= width; columnX += SIMD_WIDTH) {
+			SimdFloatN result = SimdFloatN::Load(getTapRow(rowY - radius) + columnX);
+			for (int tapY = rowY - radius + 1; tapY <= rowY + radius; tapY++) {
+				result = combine(result, SimdFloatN::Load(getTapRow(tapY) + columnX));
+			}
+			(result * finalScales).Store(outRow + columnX);
+		}
+		for (; columnX < width; columnX++) {
+			float result = getTapRow(rowY - radius)[columnX];
+			for (int tapY = rowY - radius + 1; tapY <= rowY + radius; tapY++) {
+				result = combine(result, getTapRow(tapY)[columnX]);
+			}
+			outRow[columnX] = result * finalScale;
+		}
+	}
+}
+
+void TileHeatMap::Blur(int radius)
+{
+	float tapCount = (float)((2 * radius) + 1);
+	ApplySeparableKernel(radius, [](auto a, auto b) { return a + b; }, 1.0f / (tapCount * tapCount));
+}
+
+void TileHeatMap::Dilate(int radius)
+{
+	ApplySeparableKernel(radius, [](auto a, auto b) { return SimdMax(a, b); }, 1.0f);
+}
+
+void TileHeatMap::Erode(int radius)
+{
+	ApplySeparableKernel(radius, [](auto a, auto b) { return SimdMin(a, b); }, 1.0f);
 }
 
 float TileHeatMap::GetValue(int index) const
 {
-	if (index >= m_values.size() || index < 0) return 99999999.0f;
+	if (index < 0 || index >= (int)m_values.size()) return TILE_HEAT_MAP_OUT_OF_BOUNDS_VALUE;
 	return m_values[index];
 }
 float TileHeatMap::GetValue(IntVec2 const& coords) const
 {
-	int index = coords.y * m_dimensions.x + coords.x;
-	if (index >= m_values.size() || index < 0) return 99999999.0f;
-	return m_values[index];
+	// Checked per axis, a flat index check lets x run off one row into the next
+	if (!IsInBounds(coords)) return TILE_HEAT_MAP_OUT_OF_BOUNDS_VALUE;
+	return m_values[coords.y * m_dimensions.x + coords.x];
 }
 
 void TileHeatMap::SetValue(int index, float newValue)
@@ -66,7 +360,10 @@ IntVec2 TileHeatMap::GetCoordsForNextLowestValue(IntVec2 const& coords) const
 	if(valueEast < lowestValue) lowestValue = valueEast;
 	if(valueWest < lowestValue) lowestValue = valueWest;
 	
-	
+	// Stepping onto an equal neighbour would bounce back and forth forever on plateaus
+	if (lowestValue >= currValue) {
+		return coords;
+	}
 
 	if (valueNorth == lowestValue) {
 		return stepNorth;
@@ -116,8 +413,26 @@ IntVec2 TileHeatMap::GetCoordsForNextHighestValue(IntVec2 const& coords) const
 
 float TileHeatMap::GetMaxValue(float maxValueToLookUnder) const
 {
+	// Values at or above the limit count as -1, which is also the result when nothing is under it
+	SimdFloatN const limits = SimdFloatN::Broadcast(maxValueToLookUnder);
+	SimdFloatN const fallbacks = SimdFloatN::Broadcast(-1.0f);
+	SimdFloatN maxValues = fallbacks;
+
+	int valueCount = (int)m_values.size();
+	int valueIndex = 0;
+	for (; valueIndex + SIMD_WIDTH <= valueCount; valueIndex += SIMD_WIDTH) {
+		SimdFloatN values = SimdFloatN::Load(&m_values[valueIndex]);
+		maxValues = SimdMax(maxValues, SimdSelect(values < limits, values, fallbacks));
+	}
+
+	float laneMaxValues[SIMD_WIDTH];
+	maxValues.Store(laneMaxValues);
 	float maxValue = -1.0f;
-	for (int valueIndex = 0; valueIndex < m_values.size(); valueIndex++) {
+	for (int lane = 0; lane < SIMD_WIDTH; lane++) {
+		maxValue = SimdMax(maxValue, laneMaxValues[lane]);
+	}
+
+	for (; valueIndex < valueCount; valueIndex++) {
 		if (m_values[valueIndex] > maxValue && m_values[valueIndex] < maxValueToLookUnder) {
 			maxValue = m_values[valueIndex];
 		}
@@ -125,29 +440,54 @@ float TileHeatMap::GetMaxValue(float maxValueToLookUnder) const
 	return maxValue;
 }
 
+float TileHeatMap::GetMinValue() const
+{
+	int minIndex = GetIndexOfBestValue(m_values.data(), (int)m_values.size(), [](auto a, auto b) { return a < b; });
+	return (minIndex >= 0) ? m_values[minIndex] : 0.0f;
+}
+
+IntVec2 TileHeatMap::GetCoordsForMaxValue() const
+{
+	int maxIndex = GetIndexOfBestValue(m_values.data(), (int)m_values.size(), [](auto a, auto b) { return a > b; });
+	if (maxIndex < 0) return IntVec2(-1, -1);
+	return IntVec2(maxIndex % m_dimensions.x, maxIndex / m_dimensions.x);
+}
+
+IntVec2 TileHeatMap::GetCoordsForMinValue() const
+{
+	int minIndex = GetIndexOfBestValue(m_values.data(), (int)m_values.size(), [](auto a, auto b) { return a < b; });
+	if (minIndex < 0) return IntVec2(-1, -1);
+	return IntVec2(minIndex % m_dimensions.x, minIndex / m_dimensions.x);
+}
+
+int TileHeatMap::GetMaskBelow(float threshold, TileHeatMapMask& outMask) const
+{
+	return BuildMask(m_values.data(), (int)m_values.size(), m_dimensions, [&](auto value) {
+		return value < SplatValue<decltype(value)>(threshold);
+	}, outMask);
+}
+
+int TileHeatMap::GetMaskAbove(float threshold, TileHeatMapMask& outMask) const
+{
+	return BuildMask(m_values.data(), (int)m_values.size(), m_dimensions, [&](auto value) {
+		return value > SplatValue<decltype(value)>(threshold);
+	}, outMask);
+}
+
 IntVec2 TileHeatMap::GetRandomValue(float valueLowerThanExclusive) const
 {
 	RandomNumberGenerator randNumGen;
-	int possibleCandidates = 0;
-	float chanceToSwitch = 0.0f;
-	IntVec2 chosenCandidate = IntVec2(-1, -1);
-
-
-	for (int valueIndex = 0; valueIndex < m_values.size(); valueIndex++) {
-		if (m_values[valueIndex] < valueLowerThanExclusive) {
-			possibleCandidates++;
-			chanceToSwitch = 1.0f / static_cast<float>(possibleCandidates);
-			float randNum = randNumGen.GetRandomFloatInRange(0.0f, 1.0f);
-			if (randNum < chanceToSwitch) {
-				chosenCandidate = IntVec2(valueIndex % m_dimensions.x, valueIndex / m_dimensions.x);
-			}
-		}
-	}
-	return chosenCandidate;
+	TileHeatMapMask candidates;
+	GetMaskBelow(valueLowerThanExclusive, candidates);
+	return candidates.GetRandomSetCoords(randNumGen);
 }
 
 std::vector<IntVec2> TileHeatMap::GeneratePathToCoords(IntVec2 const& currentCoords, IntVec2 const& goalCoords)
 {
+	// Already there: just the goal, so an empty path only ever means the walk got stuck
+	if (currentCoords == goalCoords) {
+		return std::vector<IntVec2>{ goalCoords };
+	}
 
 	std::vector<IntVec2> pathToGoal;
 	pathToGoal.reserve(m_dimensions.x + m_dimensions.y);
@@ -161,13 +501,16 @@ std::vector<IntVec2> TileHeatMap::GeneratePathToCoords(IntVec2 const& currentCoo
 
 	IntVec2 nextLowerCoords = currentCoords;
 
+	// Every step is strictly downhill, so this ends at the goal or at a local minimum
 	while (nextLowerCoords != goalCoords) {
-		nextLowerCoords = GetCoordsForNextLowestValue(nextLowerCoords);
+		IntVec2 stepCoords = GetCoordsForNextLowestValue(nextLowerCoords);
+		if (stepCoords == nextLowerCoords) {
+			return std::vector<IntVec2>();
+		}
+		nextLowerCoords = stepCoords;
 		pathToGoal.push_back(nextLowerCoords);
 	}
 
-	pathToGoal.push_back(goalCoords);
-
 	std::vector<IntVec2> reversePathToGoal;
 	reversePathToGoal.reserve(pathToGoal.size());
 
@@ -1,11 +1,29 @@
 #pragma once
+#include <cstdint>
 #include <vector>
 #include "Engine/Math/IntVec2.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 
+constexpr float TILE_HEAT_MAP_OUT_OF_BOUNDS_VALUE = 99999999.0f;
+
+class RandomNumberGenerator;
+
+// One bit per tile, built by the TileHeatMap threshold queries
+struct TileHeatMapMask {
+	IntVec2 m_dimensions = IntVec2::ZERO;
+	std::vector<uint64_t> m_bits; // Bit b of word w is tile (w * 64) + b
+	int m_setCount = 0;
+
+	bool IsSet(int index) const { return (m_bits[index >> 6] >> (index & 63)) & 1; }
+	bool IsSet(IntVec2 const& coords) const;
+	// Uniform over the set tiles with a single RNG draw, (-1, -1) when none is set
+	IntVec2 GetRandomSetCoords(RandomNumberGenerator& rng) const;
+};
+
 class TileHeatMap {
 public:
 	TileHeatMap(IntVec2 const& dimensions);
+	void SetDimensions(IntVec2 const& dimensions); // Keeps values by index, new tiles start at 0
 	void SetAllValues(float newValue);
 	float GetValue(int index) const;
 	float GetValue(IntVec2 const& coords) const;
@@ -13,16 +31,50 @@ public:
 	void SetValue(IntVec2 const& coords, float newValue);
 	void AddValue(float newValue);
 	IntVec2 GetDimensions() const { return m_dimensions; }
+	int GetTileCount() const { return (int)m_values.size(); }
+	bool IsInBounds(IntVec2 const& coords) const { return (coords.x >= 0) && (coords.y >= 0) && (coords.x < m_dimensions.x) && (coords.y < m_dimensions.y); }
+	float* GetValues() { return m_values.data(); }
+	float const* GetValues() const { return m_values.data(); }
 
+	// Neighbour with a strictly lower value, coords itself at a local minimum or on a plateau
 	IntVec2 GetCoordsForNextLowestValue(IntVec2 const& coords) const;
 	IntVec2 GetCoordsForNextHighestValue(IntVec2 const& coords) const;
 
+	// Whole map operations, SIMD_WIDTH tiles at a time. Maps combined with another map must have the same dimensions
+	void AddToAllValues(float valueToAdd);
+	void ScaleAllValues(float scale);
+	void ClampAllValues(float minValue, float maxValue);
+	void AddMap(TileHeatMap const& otherMap, float scale = 1.0f);
+	void MultiplyByMap(TileHeatMap const& otherMap);
+	void MinWithMap(TileHeatMap const& otherMap);
+	void MaxWithMap(TileHeatMap const& otherMap);
+
+	// Separable square kernels of (2 * radius + 1) tiles a side, tiles past the edges repeat the border
+	void Blur(int radius = 1);
+	void Dilate(int radius = 1);
+	void Erode(int radius = 1);
+
 	float GetMaxValue(float maxValueToLookUnder = ARBITRARILY_LARGE_VALUE) const;
+	float GetMinValue() const;
+	IntVec2 GetCoordsForMaxValue() const; // First tile holding the value, in index order
+	IntVec2 GetCoordsForMinValue() const;
+
+	// Tiles strictly below/above the threshold. Returns how many were set
+	int GetMaskBelow(float threshold, TileHeatMapMask& outMask) const;
+	int GetMaskAbove(float threshold, TileHeatMapMask& outMask) const;
+
 	IntVec2 GetRandomValue(float valueLowerThan) const;
 	
+	// Walks downhill from currentCoords, meant for distance fields like the ones TilePathfinder fills. The goal comes first, so callers
+	// pop the next step off the back. Just the goal when already there, empty only if the walk gets stuck before reaching it
 	std::vector<IntVec2> GeneratePathToCoords(IntVec2 const& currentCoords, IntVec2 const& goalCoords);
 
+private:
+	template <typename T_Kernel>
+	void ApplySeparableKernel(int radius, T_Kernel const& combine, float finalScale);
+
 private:
 	std::vector<float> m_values = { 0 };
+	std::vector<float> m_scratchValues; // Horizontal pass output of the kernels, kept to avoid allocating every tick
 	IntVec2 m_dimensions = IntVec2::ZERO;
-};
\ No newline at end of file
+};
@@ -4,53 +4,216 @@
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Core/StringUtils.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/VirtualFileSystem.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Math/SIMDUtils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 #define STB_IMAGE_IMPLEMENTATION // Exactly one .CPP (this Image.cpp) should #define this before #including stb_image.h
 #include "ThirdParty/stb/stb_image.h"
 
-Image::Image(char const* imageFilePath) :
-	m_imageFilePath(imageFilePath)
-{
-	int bytesPerTexel = 0; // This will be filled in for us to indicate how many color components the image had (e.g. 3=RGB=24bit, 4=RGBA=32bit)
-	int numComponentsRequested = 0; // don't care; we support 3 (24-bit RGB) or 4 (32-bit RGBA)
+namespace {
+	constexpr float MIP_PI = 3.14159265358979f;
+	constexpr float KAISER_FILTER_WIDTH = 3.0f; // In texels of the smaller mip
+	constexpr float KAISER_FILTER_ALPHA = 4.0f;
+	constexpr int IMAGE_LOAD_MIN_FILES_PER_JOB = 1;
+
+	struct SRGBTables {
+		SRGBTables()
+		{
+			for (int byteValue = 0; byteValue < 256; byteValue++) {
+				m_byteToLinear[byteValue] = SRGBToLinear((float)byteValue / 255.0f);
+			}
+			// Linear values halfway between two bytes in sRGB, encoding is a search in these so it rounds like the exact formula
+			for (int byteValue = 0; byteValue < 255; byteValue++) {
+				m_linearThresholds[byteValue] = SRGBToLinear(((float)byteValue + 0.5f) / 255.0f);
+			}
+			for (int bucket = 0; bucket < LINEAR_BUCKET_COUNT; bucket++) {
+				float bucketStart = (float)bucket / (float)LINEAR_BUCKET_COUNT;
+				m_bucketFirstBytes[bucket] = (unsigned char)(std::upper_bound(m_linearThresholds, m_linearThresholds + 255, bucketStart) - m_linearThresholds);
+			}
+		}
 
-									// Load (and decompress) the image RGB(A) bytes from a file on disk into a memory buffer (array of bytes)
-	stbi_set_flip_vertically_on_load(1); // We prefer uvTexCoords has origin (0,0) at BOTTOM LEFT
-	unsigned char* texelData = stbi_load(imageFilePath, &m_dimensions.x, &m_dimensions.y, &bytesPerTexel, numComponentsRequested);
+		static float SRGBToLinear(float srgb)
+		{
+			return (srgb <= 0.04045f) ? (srgb / 12.92f) : powf((srgb + 0.055f) / 1.055f, 2.4f);
+		}
 
-	// Check if the load was successful
-	GUARANTEE_OR_DIE(texelData, Stringf("Failed to load image \"%s\"", imageFilePath));
+		static constexpr int LINEAR_BUCKET_COUNT = 4096;
+		float m_byteToLinear[256] = {};
+		float m_linearThresholds[255] = {};
+		unsigned char m_bucketFirstBytes[LINEAR_BUCKET_COUNT] = {}; // Encoding of the start of each bucket, at most 2 bytes off
+	};
 
-	for (int y = 0, texelIndex = 0; y < m_dimensions.y; y++) {
-		for (int x = 0; x < m_dimensions.x; x++, texelIndex += bytesPerTexel) {
-			
-			unsigned char r = texelData[texelIndex];
-			unsigned char g = texelData[texelIndex + 1];
-			unsigned char b = texelData[texelIndex + 2];
-			unsigned char a = 255;
-			if (bytesPerTexel == 4) {
-				a = texelData[texelIndex + 3];
-			}
+	SRGBTables const& GetSRGBTables()
+	{
+		static SRGBTables const s_srgbTables;
+		return s_srgbTables;
+	}
+
+	unsigned char EncodeLinearToSRGB(float linear, SRGBTables const& tables)
+	{
+		if (!(linear > 0.0f)) return 0;
+		if (linear >= 1.0f) return 255;
 
-			m_rgbaTexels.emplace_back(r, g, b, a);
+		int byteValue = tables.m_bucketFirstBytes[(int)(linear * (float)SRGBTables::LINEAR_BUCKET_COUNT)];
+		while ((byteValue < 255) && (linear >= tables.m_linearThresholds[byteValue])) {
+			byteValue++;
 		}
+		return (unsigned char)byteValue;
 	}
 
-	stbi_image_free(texelData);
+	unsigned char EncodeUnorm(float value)
+	{
+		value = (value < 0.0f) ? 0.0f : ((value > 1.0f) ? 1.0f : value);
+		return (unsigned char)((value * 255.0f) + 0.5f);
+	}
+
+	float GetBesselI0(float x)
+	{
+		float sum = 1.0f;
+		float term = 1.0f;
+		float halfXSquared = x * x * 0.25f;
+		for (int k = 1; k < 32; k++) {
+			term *= halfXSquared / (float)(k * k);
+			sum += term;
+			if (term < (sum * 1e-7f)) break;
+		}
+		return sum;
+	}
+
+	// x in texels of the smaller mip, from the center of the texel being filtered
+	float GetKaiserWeight(float x)
+	{
+		float absX = fabsf(x);
+		if (absX >= KAISER_FILTER_WIDTH) return 0.0f;
+
+		float sinc = (absX < 1e-5f) ? 1.0f : (sinf(MIP_PI * absX) / (MIP_PI * absX));
+		float windowX = absX / KAISER_FILTER_WIDTH;
+		return sinc * GetBesselI0(KAISER_FILTER_ALPHA * sqrtf(1.0f - (windowX * windowX))) / GetBesselI0(KAISER_FILTER_ALPHA);
+	}
 
+	// Source texels and weights for every texel along one axis of the smaller mip, the same count for all of them.
+	// Taps past the edges are clamped to the edge texel
+	struct MipFilterTaps {
+		int m_tapCount = 0;
+		std::vector<int> m_sourceIndexes;
+		std::vector<float> m_weights;
+	};
+
+	void BuildMipFilterTaps(int sourceSize, int mipSize, MipFilter mipFilter, MipFilterTaps& outTaps)
+	{
+		float ratio = (float)sourceSize / (float)mipSize;
+		float support = (mipFilter == MipFilter::KAISER) ? (KAISER_FILTER_WIDTH * ratio) : (0.5f * ratio);
+		outTaps.m_tapCount = (int)ceilf(support * 2.0f) + 1;
+		outTaps.m_sourceIndexes.resize((size_t)mipSize * outTaps.m_tapCount);
+		outTaps.m_weights.resize((size_t)mipSize * outTaps.m_tapCount);
+
+		for (int mipIndex = 0; mipIndex < mipSize; mipIndex++) {
+			float center = ((float)mipIndex + 0.5f) * ratio;
+			int firstSource = (int)floorf(center - support);
+			int* sourceIndexes = &outTaps.m_sourceIndexes[(size_t)mipIndex * outTaps.m_tapCount];
+			float* weights = &outTaps.m_weights[(size_t)mipIndex * outTaps.m_tapCount];
+
+			float weightSum = 0.0f;
+			for (int tap = 0; tap < outTaps.m_tapCount; tap++) {
+				int sourceIndex = firstSource + tap;
+				float weight = 0.0f;
+				if (mipFilter == MipFilter::KAISER) {
+					weight = GetKaiserWeight((((float)sourceIndex + 0.5f) - center) / ratio);
+				}
+				else {
+					float overlapStart = ((float)sourceIndex > (center - support)) ? (float)sourceIndex : (center - support);
+					float overlapEnd = ((float)(sourceIndex + 1) < (center + support)) ? (float)(sourceIndex + 1) : (center + support);
+					weight = (overlapEnd > overlapStart) ? (overlapEnd - overlapStart) : 0.0f;
+				}
+				sourceIndexes[tap] = (sourceIndex < 0) ? 0 : ((sourceIndex >= sourceSize) ? (sourceSize - 1) : sourceIndex);
+				weights[tap] = weight;
+				weightSum += weight;
+			}
+			for (int tap = 0; tap < outTaps.m_tapCount; tap++) {
+				weights[tap] /= weightSum;
+			}
+		}
+	}
+
+	void RunMipRows(int rowCount, std::function<void(int beginIndex, int endIndex)> const& rowFunction)
+	{
+		if (g_theJobSystem) {
+			g_theJobSystem->ParallelFor(rowCount, IMAGE_MIP_MIN_ROWS_PER_JOB, rowFunction);
+		}
+		else {
+			rowFunction(0, rowCount);
+		}
+	}
+}
+
+Image::Image(char const* imageFilePath)
+{
+	LoadFromFile(imageFilePath);
 }
 
 Image::Image(IntVec2 const& size, Rgba8 color):
 	m_dimensions(size)
 {
 	size_t texelAmount = static_cast<size_t>(size.x) * static_cast<size_t>(size.y);
-	m_rgbaTexels.resize(texelAmount);
+	m_rgbaTexels.assign(texelAmount, color);
+}
 
-	for (int texelIndex = 0; texelIndex < texelAmount; texelIndex++) {
-		m_rgbaTexels.push_back(color);
+void Image::LoadImages(std::vector<std::string> const& imageFilePaths, std::vector<Image>& outImages, bool generateMipChain, MipFilter mipFilter)
+{
+	int imageCount = (int)imageFilePaths.size();
+	outImages.clear();
+	outImages.reserve(imageCount);
+	for (int imageIndex = 0; imageIndex < imageCount; imageIndex++) {
+		outImages.emplace_back(IntVec2::ZERO, Rgba8::WHITE);
+	}
+
+	auto loadImages = [&](int beginIndex, int endIndex) {
+		for (int imageIndex = beginIndex; imageIndex < endIndex; imageIndex++) {
+			Image& image = outImages[imageIndex];
+			image.LoadFromFile(imageFilePaths[imageIndex].c_str());
+			if (generateMipChain) {
+				image.GenerateMipChain(mipFilter);
+			}
+		}
+	};
+
+	if (g_theJobSystem) {
+		g_theJobSystem->ParallelFor(imageCount, IMAGE_LOAD_MIN_FILES_PER_JOB, loadImages);
+	}
+	else {
+		loadImages(0, imageCount);
 	}
 }
 
+void Image::LoadFromFile(char const* imageFilePath)
+{
+	m_imageFilePath = imageFilePath;
+	int bytesPerTexel = 0; // Components in the file (e.g. 3=RGB=24bit, 4=RGBA=32bit), stb expands to the 4 requested
+	int numComponentsRequested = 4; // stb fills alpha for RGB files, so its buffer is already laid out as Rgba8
+
+	// Load (and decompress) the image RGBA bytes from a file on disk into a memory buffer (array of bytes)
+	stbi_set_flip_vertically_on_load_thread(1); // We prefer uvTexCoords has origin (0,0) at BOTTOM LEFT. Per thread, images load on the JobSystem
+	VirtualFile imageFile;
+	OpenVirtualFile(imageFile, imageFilePath);
+	GUARANTEE_OR_DIE(imageFile.IsValid(), Stringf("Failed to open image \"%s\"", imageFilePath));
+	unsigned char* texelData = stbi_load_from_memory(imageFile.GetData(), (int)imageFile.GetSize(), &m_dimensions.x, &m_dimensions.y, &bytesPerTexel, numComponentsRequested);
+
+	// Check if the load was successful
+	GUARANTEE_OR_DIE(texelData, Stringf("Failed to load image \"%s\"", imageFilePath));
+
+	static_assert(sizeof(Rgba8) == 4, "Decoded texels are copied straight into Rgba8s");
+	m_rgbaTexels.resize(static_cast<size_t>(m_dimensions.x) * static_cast<size_t>(m_dimensions.y));
+	memcpy(m_rgbaTexels.data(), texelData, m_rgbaTexels.size() * sizeof(Rgba8));
+	m_mipOffsets.assign(1, 0);
+
+	stbi_image_free(texelData);
+}
+
 Image::~Image()
 {
 }
@@ -109,3 +272,122 @@ size_t Image::GetSizeBytes() const
 	int totalDim = m_dimensions.x * m_dimensions.y;
 	return (totalDim) * sizeof(Rgba8);
 }
+
+void Image::GenerateMipChain(MipFilter mipFilter, bool isSRGB)
+{
+	size_t baseTexelCount = static_cast<size_t>(m_dimensions.x) * static_cast<size_t>(m_dimensions.y);
+	m_mipOffsets.assign(1, 0);
+	if (baseTexelCount == 0) return;
+
+	// Every level is laid out up front, so the texels only grow once
+	IntVec2 mipDimensions = m_dimensions;
+	size_t totalTexelCount = baseTexelCount;
+	while ((mipDimensions.x > 1) || (mipDimensions.y > 1)) {
+		mipDimensions.x = (mipDimensions.x > 1) ? (mipDimensions.x / 2) : 1;
+		mipDimensions.y = (mipDimensions.y > 1) ? (mipDimensions.y / 2) : 1;
+		m_mipOffsets.push_back(totalTexelCount);
+		totalTexelCount += static_cast<size_t>(mipDimensions.x) * static_cast<size_t>(mipDimensions.y);
+	}
+	m_rgbaTexels.resize(totalTexelCount);
+
+	// Each level is filtered from the float texels of the one above it instead of its rounded bytes
+	SRGBTables const& srgbTables = GetSRGBTables();
+	std::vector<float> sourceTexels(baseTexelCount * 4);
+	for (size_t texelIndex = 0; texelIndex < baseTexelCount; texelIndex++) {
+		Rgba8 const& texel = m_rgbaTexels[texelIndex];
+		float* linearTexel = &sourceTexels[texelIndex * 4];
+		linearTexel[0] = isSRGB ? srgbTables.m_byteToLinear[texel.r] : ((float)texel.r / 255.0f);
+		linearTexel[1] = isSRGB ? srgbTables.m_byteToLinear[texel.g] : ((float)texel.g / 255.0f);
+		linearTexel[2] = isSRGB ? srgbTables.m_byteToLinear[texel.b] : ((float)texel.b / 255.0f);
+		linearTexel[3] = (float)texel.a / 255.0f;
+	}
+
+	std::vector<float> rowFilteredTexels;
+	std::vector<float> mipTexels;
+	MipFilterTaps horizontalTaps;
+	MipFilterTaps verticalTaps;
+	IntVec2 sourceDimensions = m_dimensions;
+	for (int mipLevel = 1; mipLevel < GetMipCount(); mipLevel++) {
+		IntVec2 levelDimensions = GetMipDimensions(mipLevel);
+		BuildMipFilterTaps(sourceDimensions.x, levelDimensions.x, mipFilter, horizontalTaps);
+		BuildMipFilterTaps(sourceDimensions.y, levelDimensions.y, mipFilter, verticalTaps);
+		rowFilteredTexels.resize(static_cast<size_t>(levelDimensions.x) * sourceDimensions.y * 4);
+		mipTexels.resize(static_cast<size_t>(levelDimensions.x) * levelDimensions.y * 4);
+
+		// Horizontal pass, one texel's 4 channels per SIMD register
+		auto filterRows = [&](int beginRow, int endRow) {
+			for (int row = beginRow; row < endRow; row++) {
+				float const* sourceRow = &sourceTexels[static_cast<size_t>(row) * sourceDimensions.x * 4];
+				float* outRow = &rowFilteredTexels[static_cast<size_t>(row) * levelDimensions.x * 4];
+				for (int column = 0; column < levelDimensions.x; column++) {
+					int const* sourceIndexes = &horizontalTaps.m_sourceIndexes[static_cast<size_t>(column) * horizontalTaps.m_tapCount];
+					float const* weights = &horizontalTaps.m_weights[static_cast<size_t>(column) * horizontalTaps.m_tapCount];
+					SimdFloat4 filtered = SimdFloat4::Zero();
+					for (int tap = 0; tap < horizontalTaps.m_tapCount; tap++) {
+						filtered = filtered + (SimdFloat4::Broadcast(weights[tap]) * SimdFloat4::Load(&sourceRow[sourceIndexes[tap] * 4]));
+					}
+					filtered.Store(&outRow[column * 4]);
+				}
+			}
+		};
+		RunMipRows(sourceDimensions.y, filterRows);
+
+		// Vertical pass, a weighted sum of whole rows, as wide as SimdFloatN goes
+		auto filterColumns = [&](int beginRow, int endRow) {
+			int rowFloatCount = levelDimensions.x * 4;
+			for (int row = beginRow; row < endRow; row++) {
+				int const* sourceIndexes = &verticalTaps.m_sourceIndexes[static_cast<size_t>(row) * verticalTaps.m_tapCount];
+				float const* weights = &verticalTaps.m_weights[static_cast<size_t>(row) * verticalTaps.m_tapCount];
+				float* outRow = &mipTexels[static_cast<size_t>(row) * rowFloatCount];
+
+				int floatIndex = 0;
+				for (; (floatIndex + SIMD_WIDTH) <= rowFloatCount; floatIndex += SIMD_WIDTH) {
+					SimdFloatN filtered = SimdFloatN::Zero();
+					for (int tap = 0; tap < verticalTaps.m_tapCount; tap++) {
+						float const* sourceRow = &rowFilteredTexels[static_cast<size_t>(sourceIndexes[tap]) * rowFloatCount];
+						filtered = filtered + (SimdFloatN::Broadcast(weights[tap]) * SimdFloatN::Load(&sourceRow[floatIndex]));
+					}
+					filtered.Store(&outRow[floatIndex]);
+				}
+				for (; floatIndex < rowFloatCount; floatIndex++) {
+					float filtered = 0.0f;
+					for (int tap = 0; tap < verticalTaps.m_tapCount; tap++) {
+						filtered += weights[tap] * rowFilteredTexels[(static_cast<size_t>(sourceIndexes[tap]) * rowFloatCount) + floatIndex];
+					}
+					outRow[floatIndex] = filtered;
+				}
+
+				Rgba8* outTexels = &m_rgbaTexels[m_mipOffsets[mipLevel] + (static_cast<size_t>(row) * levelDimensions.x)];
+				for (int column = 0; column < levelDimensions.x; column++) {
+					float const* linearTexel = &outRow[column * 4];
+					Rgba8& outTexel = outTexels[column];
+					outTexel.r = isSRGB ? EncodeLinearToSRGB(linearTexel[0], srgbTables) : EncodeUnorm(linearTexel[0]);
+					outTexel.g = isSRGB ? EncodeLinearToSRGB(linearTexel[1], srgbTables) : EncodeUnorm(linearTexel[1]);
+					outTexel.b = isSRGB ? EncodeLinearToSRGB(linearTexel[2], srgbTables) : EncodeUnorm(linearTexel[2]);
+					outTexel.a = EncodeUnorm(linearTexel[3]);
+				}
+			}
+		};
+		RunMipRows(levelDimensions.y, filterColumns);
+
+		sourceTexels.swap(mipTexels);
+		sourceDimensions = levelDimensions;
+	}
+}
+
+IntVec2 Image::GetMipDimensions(int mipLevel) const
+{
+	int width = m_dimensions.x >> mipLevel;
+	int height = m_dimensions.y >> mipLevel;
+	return IntVec2((width > 1) ? width : 1, (height > 1) ? height : 1);
+}
+
+Rgba8 const* Image::GetMipTexels(int mipLevel) const
+{
+	return m_rgbaTexels.data() + m_mipOffsets[mipLevel];
+}
+
+size_t Image::GetSizeBytesWithMips() const
+{
+	return m_rgbaTexels.size() * sizeof(Rgba8);
+}
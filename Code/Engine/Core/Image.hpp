@@ -6,6 +6,13 @@
 struct Rgba8;
 struct Vec2;
 
+enum class MipFilter : unsigned char {
+	BOX, // Average of the texels under the smaller texel, sharp and cheap
+	KAISER, // Kaiser windowed sinc 3 texels wide, keeps more detail in small mips at the cost of slight ringing
+};
+
+constexpr int IMAGE_MIP_MIN_ROWS_PER_JOB = 16;
+
 class Image {
 	friend class Renderer;
 public:
@@ -14,6 +21,9 @@ public:
 	Image(IntVec2 const& size, Rgba8 color);
 	~Image();
 
+	// Decodes every file on the JobSystem, one image per path in the same order. The mip chain is generated in the same job
+	static void LoadImages(std::vector<std::string> const& imageFilePaths, std::vector<Image>& outImages, bool generateMipChain = false, MipFilter mipFilter = MipFilter::BOX);
+
 	IntVec2 GetDimensions() const;
 	std::string const& GetImageFilePath() const;
 	Rgba8 GetTexelColor(Vec2 const& uv) const;
@@ -22,11 +32,24 @@ public:
 	Rgba8 GetTexelColor(float x, float y) const;
 	void SetTexelColor(IntVec2 const& texelCoords, Rgba8 const& newColor);
 	void* const GetRawData() const;
-	size_t GetSizeBytes() const;
+	size_t GetSizeBytes() const; // Mip 0 only
+
+	// Replaces the mip levels with a full chain down to 1x1, each level filtered from the one above it. Texels are filtered in
+	// linear space when isSRGB, data such as normal maps should pass false. Rows are split across the JobSystem.
+	// Mips are not updated by SetTexelColor, generate them again after editing
+	void GenerateMipChain(MipFilter mipFilter = MipFilter::BOX, bool isSRGB = true);
+	int GetMipCount() const { return (int)m_mipOffsets.size(); }
+	IntVec2 GetMipDimensions(int mipLevel) const;
+	Rgba8 const* GetMipTexels(int mipLevel) const;
+	size_t GetSizeBytesWithMips() const; // Every level, as laid out after GetRawData
+
+private:
+	void LoadFromFile(char const* imageFilePath);
 
 private:
 	std::string m_imageFilePath;
 	IntVec2 m_dimensions = IntVec2::ZERO;
-	std::vector<Rgba8> m_rgbaTexels;
+	std::vector<Rgba8> m_rgbaTexels; // Mip 0, then every other mip level one after the other
+	std::vector<size_t> m_mipOffsets = { 0 }; // First texel of each mip level
 
 };
\ No newline at end of file
@@ -1,7 +1,54 @@
 #include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/Profiler.hpp"
+#include "Engine/Core/Metrics.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include <memory>
 
 JobSystem* g_theJobSystem = nullptr;
 
+struct ParallelForState {
+	std::function<void(int, int)> const* m_chunkFunction = nullptr;
+	int m_count = 0;
+	int m_chunkSize = 0;
+	int m_chunkCount = 0;
+	std::atomic<int> m_nextChunk = 0;
+	std::atomic<int> m_remainingChunks = 0;
+
+	// Returns false once every chunk was claimed. Claiming nothing never touches the chunk function, so late workers are safe
+	bool RunNextChunk()
+	{
+		int chunkIndex = m_nextChunk.fetch_add(1, std::memory_order_relaxed);
+		if (chunkIndex >= m_chunkCount) return false;
+
+		int beginIndex = chunkIndex * m_chunkSize;
+		int endIndex = (beginIndex + m_chunkSize < m_count) ? beginIndex + m_chunkSize : m_count;
+		(*m_chunkFunction)(beginIndex, endIndex);
+
+		m_remainingChunks.fetch_sub(1, std::memory_order_acq_rel);
+		return true;
+	}
+};
+
+class ParallelForJob : public Job {
+public:
+	ParallelForJob(std::shared_ptr<ParallelForState> const& state) :
+		Job(DEFAULT_JOB_ID, true),
+		m_state(state)
+	{
+	}
+
+	virtual void Execute() override
+	{
+		PROFILE_SCOPE("ParallelFor");
+		while (m_state->RunNextChunk()) {}
+	}
+
+	virtual void OnFinished() override {}
+
+private:
+	std::shared_ptr<ParallelForState> m_state; // Shared, a worker may only pick this job after ParallelFor returned
+};
+
 JobWorkerThread::JobWorkerThread(JobSystem* jobSystem, int threadID) :
 	m_theJobSystem(jobSystem),
 	m_threadID(threadID)
@@ -11,11 +58,19 @@ JobWorkerThread::JobWorkerThread(JobSystem* jobSystem, int threadID) :
 
 void JobWorkerThread::WorkerThreadMain()
 {
+	ProfilerSetThreadName(Stringf("JobWorker %d", m_threadID));
+
 	while (!m_isQuitting) {
 		Job* pendingJob = m_theJobSystem->ClaimJobToExecute(m_threadJobType);
 		if (pendingJob != nullptr) {
-			pendingJob->Execute();
-			pendingJob->OnFinished();
+			{
+				PROFILE_SCOPE("Job Execute");
+				pendingJob->Execute();
+			}
+			{
+				PROFILE_SCOPE("Job OnFinished");
+				pendingJob->OnFinished();
+			}
 			m_theJobSystem->MarkJobAsCompleted(pendingJob);
 		}
 		else {
@@ -66,6 +121,9 @@ void JobSystem::Shutdown()
 			workerThread = nullptr;
 		}
 	}
+
+	// Jobs nobody will run anymore are cancelled, so whatever waits on them stops waiting
+	ClearQueuedJobs();
 }
 
 void JobSystem::BeginFrame()
@@ -106,6 +164,7 @@ Job* JobSystem::ClaimJobToExecute(int threadJobType)
 
 	if (queuedJob) {
 		m_amountOfQueuedJobs--;
+		METRIC_GAUGE_SET("jobs.queued", (double)m_amountOfQueuedJobs.load());
 		int executionId = -1;
 
 		m_jobsOnExecutionMutex.lock(); // lock
@@ -145,12 +204,25 @@ void JobSystem::QueueJob(Job* job)
 	m_queuedJobsMutex.unlock();
 
 	m_amountOfQueuedJobs++;
+	METRIC_GAUGE_SET("jobs.queued", (double)m_amountOfQueuedJobs.load());
 
 }
 
+void JobSystem::QueueJobs(std::vector<Job*> const& jobs)
+{
+	m_queuedJobsMutex.lock();
+	m_queuedJobs.insert(m_queuedJobs.end(), jobs.begin(), jobs.end());
+	m_queuedJobsMutex.unlock();
+
+	m_amountOfQueuedJobs += (int)jobs.size();
+	METRIC_GAUGE_SET("jobs.queued", (double)m_amountOfQueuedJobs.load());
+}
+
 void JobSystem::MarkJobAsCompleted(Job* job)
 {
 	if (job->m_executionId < 0) return;
+	METRIC_COUNTER_ADD("jobs.completed", 1);
+
 	m_jobsOnExecutionMutex.lock(); // lock
 
 	if (job->m_executionId < m_jobsOnExecution.size()) {
@@ -159,6 +231,11 @@ void JobSystem::MarkJobAsCompleted(Job* job)
 
 	m_jobsOnExecutionMutex.unlock(); // unlock
 
+	if (job->m_deleteOnCompletion) {
+		delete job;
+		m_amountOfExecutingJobs--;
+		return;
+	}
 
 	m_completedJobsMutex.lock(); // lock
 
@@ -185,11 +262,22 @@ Job* JobSystem::RetrieveCompletedJob()
 
 void JobSystem::ClearQueuedJobs()
 {
-	m_amountOfQueuedJobs = 0;
+	std::deque<Job*> clearedJobs;
 	m_queuedJobsMutex.lock();
-	m_queuedJobs.clear();
+	clearedJobs.swap(m_queuedJobs);
 	m_queuedJobsMutex.unlock();
 
+	m_amountOfQueuedJobs -= (int)clearedJobs.size();
+	METRIC_GAUGE_SET("jobs.queued", (double)m_amountOfQueuedJobs.load());
+
+	// Outside the lock, cancelling may queue new jobs. Self owned jobs would leak otherwise
+	for (Job* clearedJob : clearedJobs) {
+		if (!clearedJob) continue;
+		clearedJob->OnCancelled();
+		if (clearedJob->m_deleteOnCompletion) {
+			delete clearedJob;
+		}
+	}
 }
 
 void JobSystem::ClearCompletedJobs()
@@ -223,13 +311,52 @@ void JobSystem::WaitUntilCurrentJobsCompletion()
 	} // Do nothing while there are running jobs
 }
 
+void JobSystem::ParallelFor(int count, int minChunkSize, std::function<void(int beginIndex, int endIndex)> const& chunkFunction)
+{
+	if (count <= 0) return;
+
+	int workerCount = (int)m_workerThreads.size();
+	if (minChunkSize < 1) minChunkSize = 1;
+	if ((workerCount == 0) || (count <= minChunkSize)) {
+		chunkFunction(0, count);
+		return;
+	}
+
+	// A few chunks per thread so uneven chunks still balance out
+	int threadCount = workerCount + 1;
+	int chunkSize = (count + (threadCount * 4) - 1) / (threadCount * 4);
+	if (chunkSize < minChunkSize) chunkSize = minChunkSize;
+
+	std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+	state->m_chunkFunction = &chunkFunction;
+	state->m_count = count;
+	state->m_chunkSize = chunkSize;
+	state->m_chunkCount = (count + chunkSize - 1) / chunkSize;
+	state->m_remainingChunks = state->m_chunkCount;
+
+	int jobCount = (state->m_chunkCount - 1 < workerCount) ? state->m_chunkCount - 1 : workerCount;
+	std::vector<Job*> jobs;
+	jobs.reserve(jobCount);
+	for (int jobIndex = 0; jobIndex < jobCount; jobIndex++) {
+		jobs.push_back(new ParallelForJob(state));
+	}
+	QueueJobs(jobs);
+
+	while (state->RunNextChunk()) {}
+
+	while (state->m_remainingChunks.load(std::memory_order_acquire) > 0) {
+		std::this_thread::yield();
+	}
+}
+
 void JobSystem::SetThreadJobType(int threadId, int jobType)
 {
 	if (threadId < 0 || threadId > m_workerThreads.size()) return;
 	m_workerThreads[threadId]->m_threadJobType = jobType;
 }
 
-Job::Job(int jobType) :
-	m_jobType(jobType)
+Job::Job(int jobType, bool deleteOnCompletion) :
+	m_jobType(jobType),
+	m_deleteOnCompletion(deleteOnCompletion)
 {
 }
@@ -1,7 +1,10 @@
 #pragma once
 #include <deque>
+#include <functional>
 #include <mutex>
 #include <vector>
+#include <atomic>
+#include <thread>
 
 
 struct JobSystemConfig {
@@ -28,6 +31,7 @@ public:
 
 	Job* ClaimJobToExecute(int threadJobType);
 	void QueueJob(Job* job);
+	void QueueJobs(std::vector<Job*> const& jobs);
 	void MarkJobAsCompleted(Job* job);
 	Job* RetrieveCompletedJob();
 
@@ -38,6 +42,10 @@ public:
 
 	void SetThreadJobType(int threadId, int jobType);
 
+	// Splits [0, count) into chunks of at least minChunkSize, run on the workers and on the calling thread. Returns once every chunk ran.
+	// Runs inline when there are no workers or the range fits in one chunk
+	void ParallelFor(int count, int minChunkSize, std::function<void(int beginIndex, int endIndex)> const& chunkFunction);
+
 	int GetNumThreads() const { return m_config.m_amountOfThreads; }
 
 private:
@@ -61,7 +69,7 @@ private:
 class Job {
 
 public:
-	Job(int jobType);
+	Job(int jobType, bool deleteOnCompletion = false);
 	virtual ~Job() {};
 
 	friend class JobWorkerThread;
@@ -73,9 +81,12 @@ public:
 protected:
 	virtual void Execute() = 0;
 	virtual void OnFinished() = 0;
+	// Called instead of Execute/OnFinished when the job is cleared from the queue. Jobs handing out futures must fulfil them here
+	virtual void OnCancelled() {}
 
 protected:
 	int m_executionId = -1;
+	bool m_deleteOnCompletion = false; // Fire and forget jobs are deleted by the JobSystem instead of going into the completed queue
 
 
 };
@@ -0,0 +1,345 @@
+#include "Engine/Core/Metrics.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include <algorithm>
+
+MetricsRegistry* g_theMetrics = nullptr;
+
+namespace {
+	std::atomic<int> s_nextShardIndex = 0;
+	std::atomic<int> s_nextCallSite = 0;
+	thread_local int t_shardIndex = -1;
+
+	int GetHighestSetBit(uint64_t value)
+	{
+		int highestBit = 0;
+		if (value >= (1ull << 32)) { value >>= 32; highestBit += 32; }
+		if (value >= (1ull << 16)) { value >>= 16; highestBit += 16; }
+		if (value >= (1ull << 8)) { value >>= 8; highestBit += 8; }
+		if (value >= (1ull << 4)) { value >>= 4; highestBit += 4; }
+		if (value >= (1ull << 2)) { value >>= 2; highestBit += 2; }
+		if (value >= (1ull << 1)) { highestBit += 1; }
+		return highestBit;
+	}
+
+	void AtomicStoreMin(std::atomic<uint64_t>& target, uint64_t value)
+	{
+		uint64_t currentValue = target.load(std::memory_order_relaxed);
+		while ((value < currentValue) && !target.compare_exchange_weak(currentValue, value, std::memory_order_relaxed)) {}
+	}
+
+	void AtomicStoreMax(std::atomic<uint64_t>& target, uint64_t value)
+	{
+		uint64_t currentValue = target.load(std::memory_order_relaxed);
+		while ((value > currentValue) && !target.compare_exchange_weak(currentValue, value, std::memory_order_relaxed)) {}
+	}
+
+	// Threads racing on the first lookup all get the same metric from the locked lookup, so the last store wins harmlessly
+	template <typename MetricType, typename GetOrCreateFunction>
+	MetricType* GetCachedCallSiteMetric(std::atomic<void*>* callSiteMetrics, int callSite, GetOrCreateFunction const& getOrCreateMetric)
+	{
+		if ((callSite < 0) || (callSite >= METRIC_MAX_CALL_SITES)) return getOrCreateMetric();
+
+		void* metric = callSiteMetrics[callSite].load(std::memory_order_acquire);
+		if (!metric) {
+			metric = getOrCreateMetric();
+			callSiteMetrics[callSite].store(metric, std::memory_order_release);
+		}
+		return static_cast<MetricType*>(metric);
+	}
+}
+
+int GetMetricShardIndex()
+{
+	// Threads get shards round robin, the first time they record anything
+	if (t_shardIndex < 0) {
+		t_shardIndex = s_nextShardIndex.fetch_add(1, std::memory_order_relaxed) % METRIC_SHARD_COUNT;
+	}
+	return t_shardIndex;
+}
+
+int RegisterMetricCallSite()
+{
+	return s_nextCallSite.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t MetricCounter::GetValue() const
+{
+	uint64_t total = 0;
+	for (CounterShard const& shard : m_shards) {
+		total += shard.m_value.load(std::memory_order_relaxed);
+	}
+	return total;
+}
+
+void MetricCounter::Reset()
+{
+	for (CounterShard& shard : m_shards) {
+		shard.m_value.store(0, std::memory_order_relaxed);
+	}
+}
+
+void MetricGauge::Add(double amount)
+{
+	double currentValue = m_value.load(std::memory_order_relaxed);
+	while (!m_value.compare_exchange_weak(currentValue, currentValue + amount, std::memory_order_relaxed)) {}
+}
+
+int MetricHistogram::GetBucketIndex(uint64_t value)
+{
+	// Values below the sub bucket count are exact. Above, every power of two is split in SUB_BUCKET_COUNT linear buckets
+	if (value < METRIC_HISTOGRAM_SUB_BUCKET_COUNT) return (int)value;
+
+	int shift = GetHighestSetBit(value) - METRIC_HISTOGRAM_SUB_BUCKET_BITS;
+	int subBucket = (int)((value >> shift) & (METRIC_HISTOGRAM_SUB_BUCKET_COUNT - 1));
+	return ((shift + 1) * METRIC_HISTOGRAM_SUB_BUCKET_COUNT) + subBucket;
+}
+
+uint64_t MetricHistogram::GetBucketLowerBound(int bucketIndex)
+{
+	if (bucketIndex < METRIC_HISTOGRAM_SUB_BUCKET_COUNT) return (uint64_t)bucketIndex;
+
+	int shift = (bucketIndex / METRIC_HISTOGRAM_SUB_BUCKET_COUNT) - 1;
+	uint64_t subBucket = (uint64_t)(bucketIndex % METRIC_HISTOGRAM_SUB_BUCKET_COUNT);
+	return (METRIC_HISTOGRAM_SUB_BUCKET_COUNT + subBucket) << shift;
+}
+
+uint64_t MetricHistogram::GetBucketUpperBound(int bucketIndex)
+{
+	if (bucketIndex < METRIC_HISTOGRAM_SUB_BUCKET_COUNT) return (uint64_t)bucketIndex;
+
+	int shift = (bucketIndex / METRIC_HISTOGRAM_SUB_BUCKET_COUNT) - 1;
+	return GetBucketLowerBound(bucketIndex) + ((1ull << shift) - 1);
+}
+
+void MetricHistogram::Record(uint64_t value)
+{
+	HistogramShard& shard = m_shards[GetMetricShardIndex()];
+	shard.m_buckets[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+	shard.m_count.fetch_add(1, std::memory_order_relaxed);
+	shard.m_sum.fetch_add(value, std::memory_order_relaxed);
+	AtomicStoreMin(shard.m_min, value);
+	AtomicStoreMax(shard.m_max, value);
+}
+
+void MetricHistogram::MergeBuckets(std::vector<uint64_t>& outBuckets) const
+{
+	outBuckets.assign(METRIC_HISTOGRAM_BUCKET_COUNT, 0);
+	for (HistogramShard const& shard : m_shards) {
+		if (shard.m_count.load(std::memory_order_relaxed) == 0) continue;
+		for (int bucketIndex = 0; bucketIndex < METRIC_HISTOGRAM_BUCKET_COUNT; bucketIndex++) {
+			outBuckets[bucketIndex] += shard.m_buckets[bucketIndex].load(std::memory_order_relaxed);
+		}
+	}
+}
+
+uint64_t MetricHistogram::GetValueAtPercentile(double percentile) const
+{
+	std::vector<uint64_t> mergedBuckets;
+	MergeBuckets(mergedBuckets);
+
+	uint64_t totalCount = 0;
+	for (uint64_t bucketCount : mergedBuckets) {
+		totalCount += bucketCount;
+	}
+	if (totalCount == 0) return 0;
+
+	uint64_t targetRank = (uint64_t)((percentile / 100.0) * (double)totalCount + 0.5);
+	targetRank = std::clamp<uint64_t>(targetRank, 1, totalCount);
+
+	uint64_t accumulatedCount = 0;
+	for (int bucketIndex = 0; bucketIndex < METRIC_HISTOGRAM_BUCKET_COUNT; bucketIndex++) {
+		accumulatedCount += mergedBuckets[bucketIndex];
+		if (accumulatedCount >= targetRank) return GetBucketUpperBound(bucketIndex);
+	}
+
+	return GetBucketUpperBound(METRIC_HISTOGRAM_BUCKET_COUNT - 1);
+}
+
+MetricHistogramSnapshot MetricHistogram::GetSnapshot() const
+{
+	MetricHistogramSnapshot snapshot;
+
+	std::vector<uint64_t> mergedBuckets;
+	MergeBuckets(mergedBuckets);
+
+	uint64_t sum = 0;
+	snapshot.m_min = UINT64_MAX;
+	for (HistogramShard const& shard : m_shards) {
+		snapshot.m_count += shard.m_count.load(std::memory_order_relaxed);
+		sum += shard.m_sum.load(std::memory_order_relaxed);
+		snapshot.m_min = (std::min)(snapshot.m_min, shard.m_min.load(std::memory_order_relaxed));
+		snapshot.m_max = (std::max)(snapshot.m_max, shard.m_max.load(std::memory_order_relaxed));
+	}
+
+	if (snapshot.m_count == 0) return MetricHistogramSnapshot();
+	snapshot.m_mean = (double)sum / (double)snapshot.m_count;
+
+	// Walk the merged buckets once for every percentile. Reported values are clamped to the recorded max
+	double const percentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+	uint64_t* const outValues[] = { &snapshot.m_p50, &snapshot.m_p90, &snapshot.m_p99, &snapshot.m_p999 };
+
+	uint64_t bucketTotal = 0;
+	for (uint64_t bucketCount : mergedBuckets) {
+		bucketTotal += bucketCount;
+	}
+
+	int bucketIndex = 0;
+	uint64_t accumulatedCount = 0;
+	for (int percentileIndex = 0; percentileIndex < 4; percentileIndex++) {
+		uint64_t targetRank = (uint64_t)((percentiles[percentileIndex] / 100.0) * (double)bucketTotal + 0.5);
+		targetRank = std::clamp<uint64_t>(targetRank, 1, (bucketTotal > 0) ? bucketTotal : 1);
+
+		while ((bucketIndex < METRIC_HISTOGRAM_BUCKET_COUNT - 1) && ((accumulatedCount + mergedBuckets[bucketIndex]) < targetRank)) {
+			accumulatedCount += mergedBuckets[bucketIndex];
+			bucketIndex++;
+		}
+
+		*outValues[percentileIndex] = (std::min)(GetBucketUpperBound(bucketIndex), snapshot.m_max);
+	}
+
+	return snapshot;
+}
+
+void MetricHistogram::Reset()
+{
+	for (HistogramShard& shard : m_shards) {
+		for (std::atomic<uint64_t>& bucket : shard.m_buckets) {
+			bucket.store(0, std::memory_order_relaxed);
+		}
+		shard.m_count.store(0, std::memory_order_relaxed);
+		shard.m_sum.store(0, std::memory_order_relaxed);
+		shard.m_min.store(UINT64_MAX, std::memory_order_relaxed);
+		shard.m_max.store(0, std::memory_order_relaxed);
+	}
+}
+
+MetricsRegistry::MetricsRegistry()
+{
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+}
+
+void MetricsRegistry::Startup()
+{
+	SubscribeEventCallbackFunction("MetricsDump", Command_Dump);
+	SubscribeEventCallbackFunction("MetricsReset", Command_Reset);
+}
+
+void MetricsRegistry::Shutdown()
+{
+	UnsubscribeEventCallbackFunction("MetricsDump", Command_Dump);
+	UnsubscribeEventCallbackFunction("MetricsReset", Command_Reset);
+}
+
+MetricCounter* MetricsRegistry::GetOrCreateCounter(std::string const& name)
+{
+	std::lock_guard<std::mutex> metricsLock(m_metricsMutex);
+	for (std::unique_ptr<MetricCounter> const& counter : m_counters) {
+		if (counter->GetName() == name) return counter.get();
+	}
+
+	m_counters.push_back(std::make_unique<MetricCounter>(name));
+	return m_counters.back().get();
+}
+
+MetricGauge* MetricsRegistry::GetOrCreateGauge(std::string const& name)
+{
+	std::lock_guard<std::mutex> metricsLock(m_metricsMutex);
+	for (std::unique_ptr<MetricGauge> const& gauge : m_gauges) {
+		if (gauge->GetName() == name) return gauge.get();
+	}
+
+	m_gauges.push_back(std::make_unique<MetricGauge>(name));
+	return m_gauges.back().get();
+}
+
+MetricHistogram* MetricsRegistry::GetOrCreateHistogram(std::string const& name, std::string const& unit)
+{
+	std::lock_guard<std::mutex> metricsLock(m_metricsMutex);
+	for (std::unique_ptr<MetricHistogram> const& histogram : m_histograms) {
+		if (histogram->GetName() == name) return histogram.get();
+	}
+
+	m_histograms.push_back(std::make_unique<MetricHistogram>(name, unit));
+	return m_histograms.back().get();
+}
+
+MetricCounter* MetricsRegistry::GetCallSiteCounter(int callSite, char const* name)
+{
+	return GetCachedCallSiteMetric<MetricCounter>(m_callSiteMetrics, callSite, [&]() { return GetOrCreateCounter(name); });
+}
+
+MetricGauge* MetricsRegistry::GetCallSiteGauge(int callSite, char const* name)
+{
+	return GetCachedCallSiteMetric<MetricGauge>(m_callSiteMetrics, callSite, [&]() { return GetOrCreateGauge(name); });
+}
+
+MetricHistogram* MetricsRegistry::GetCallSiteHistogram(int callSite, char const* name)
+{
+	return GetCachedCallSiteMetric<MetricHistogram>(m_callSiteMetrics, callSite, [&]() { return GetOrCreateHistogram(name); });
+}
+
+void MetricsRegistry::ResetAll()
+{
+	std::lock_guard<std::mutex> metricsLock(m_metricsMutex);
+	for (std::unique_ptr<MetricCounter>& counter : m_counters) {
+		counter->Reset();
+	}
+	for (std::unique_ptr<MetricGauge>& gauge : m_gauges) {
+		gauge->Set(0.0);
+	}
+	for (std::unique_ptr<MetricHistogram>& histogram : m_histograms) {
+		histogram->Reset();
+	}
+}
+
+Strings MetricsRegistry::BuildSnapshotLines() const
+{
+	std::lock_guard<std::mutex> metricsLock(m_metricsMutex);
+
+	Strings snapshotLines;
+	snapshotLines.reserve(m_counters.size() + m_gauges.size() + m_histograms.size());
+
+	for (std::unique_ptr<MetricCounter> const& counter : m_counters) {
+		snapshotLines.push_back(Stringf("counter %s %llu", counter->GetName().c_str(), counter->GetValue()));
+	}
+
+	for (std::unique_ptr<MetricGauge> const& gauge : m_gauges) {
+		snapshotLines.push_back(Stringf("gauge %s %.3f", gauge->GetName().c_str(), gauge->GetValue()));
+	}
+
+	for (std::unique_ptr<MetricHistogram> const& histogram : m_histograms) {
+		MetricHistogramSnapshot snapshot = histogram->GetSnapshot();
+		char const* unit = histogram->GetUnit().c_str();
+		snapshotLines.push_back(Stringf("histogram %s count=%llu min=%llu%s mean=%.1f%s p50=%llu%s p90=%llu%s p99=%llu%s p99.9=%llu%s max=%llu%s",
+			histogram->GetName().c_str(), snapshot.m_count, snapshot.m_min, unit, snapshot.m_mean, unit, snapshot.m_p50, unit,
+			snapshot.m_p90, unit, snapshot.m_p99, unit, snapshot.m_p999, unit, snapshot.m_max, unit));
+	}
+
+	return snapshotLines;
+}
+
+bool MetricsRegistry::Command_Dump(EventArgs& args)
+{
+	UNUSED(args);
+	if (!g_theMetrics) return false;
+
+	Strings snapshotLines = g_theMetrics->BuildSnapshotLines();
+	g_theConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("# Metrics [%d] #", (int)snapshotLines.size()));
+	for (std::string const& snapshotLine : snapshotLines) {
+		g_theConsole->AddLine(DevConsole::INFO_MINOR_COLOR, snapshotLine);
+	}
+	return true;
+}
+
+bool MetricsRegistry::Command_Reset(EventArgs& args)
+{
+	UNUSED(args);
+	if (!g_theMetrics) return false;
+
+	g_theMetrics->ResetAll();
+	g_theConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, "Metrics reset");
+	return true;
+}
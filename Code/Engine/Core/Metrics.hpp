@@ -0,0 +1,145 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+	METRICS
+	Counters	-> Monotonic, sharded per thread so hot paths never contend on the same cache line
+	Gauges		-> Last value wins (queue depths, pool sizes...)
+	Histograms	-> HDR style log-linear buckets (16 sub-buckets per power of two, ~6% worst case relative error), sharded per thread
+	Metric pointers are stable for the lifetime of the registry. METRIC_* call sites get a process wide index, and each registry
+	caches the metric of every index, so a recreated registry never hands out pointers into the old one
+*/
+
+constexpr int METRIC_SHARD_COUNT = 8;
+constexpr int METRIC_HISTOGRAM_SUB_BUCKET_BITS = 4;
+constexpr int METRIC_HISTOGRAM_SUB_BUCKET_COUNT = 1 << METRIC_HISTOGRAM_SUB_BUCKET_BITS;
+constexpr int METRIC_HISTOGRAM_BUCKET_COUNT = (64 - METRIC_HISTOGRAM_SUB_BUCKET_BITS + 1) * METRIC_HISTOGRAM_SUB_BUCKET_COUNT;
+constexpr int METRIC_MAX_CALL_SITES = 1024; // Sites past this still work, through the locked lookup
+
+int GetMetricShardIndex();
+int RegisterMetricCallSite();
+
+class MetricCounter {
+public:
+	MetricCounter(std::string const& name) : m_name(name) {}
+
+	void Add(uint64_t amount = 1) { m_shards[GetMetricShardIndex()].m_value.fetch_add(amount, std::memory_order_relaxed); }
+	uint64_t GetValue() const;
+	void Reset();
+	std::string const& GetName() const { return m_name; }
+
+private:
+	struct alignas(64) CounterShard {
+		std::atomic<uint64_t> m_value = 0;
+	};
+
+	std::string m_name;
+	CounterShard m_shards[METRIC_SHARD_COUNT];
+};
+
+class MetricGauge {
+public:
+	MetricGauge(std::string const& name) : m_name(name) {}
+
+	void Set(double value) { m_value.store(value, std::memory_order_relaxed); }
+	void Add(double amount);
+	double GetValue() const { return m_value.load(std::memory_order_relaxed); }
+	std::string const& GetName() const { return m_name; }
+
+private:
+	std::string m_name;
+	std::atomic<double> m_value = 0.0;
+};
+
+struct MetricHistogramSnapshot {
+	uint64_t m_count = 0;
+	uint64_t m_min = 0;
+	uint64_t m_max = 0;
+	double m_mean = 0.0;
+	uint64_t m_p50 = 0;
+	uint64_t m_p90 = 0;
+	uint64_t m_p99 = 0;
+	uint64_t m_p999 = 0;
+};
+
+class MetricHistogram {
+public:
+	MetricHistogram(std::string const& name, std::string const& unit) : m_name(name), m_unit(unit) {}
+
+	void Record(uint64_t value);
+	MetricHistogramSnapshot GetSnapshot() const;
+	uint64_t GetValueAtPercentile(double percentile) const;
+	void Reset();
+
+	std::string const& GetName() const { return m_name; }
+	std::string const& GetUnit() const { return m_unit; }
+
+	static int GetBucketIndex(uint64_t value);
+	static uint64_t GetBucketLowerBound(int bucketIndex);
+	static uint64_t GetBucketUpperBound(int bucketIndex);
+
+private:
+	struct alignas(64) HistogramShard {
+		std::atomic<uint64_t> m_buckets[METRIC_HISTOGRAM_BUCKET_COUNT] = {};
+		std::atomic<uint64_t> m_count = 0;
+		std::atomic<uint64_t> m_sum = 0;
+		std::atomic<uint64_t> m_min = UINT64_MAX;
+		std::atomic<uint64_t> m_max = 0;
+	};
+
+	void MergeBuckets(std::vector<uint64_t>& outBuckets) const;
+
+	std::string m_name;
+	std::string m_unit;
+	HistogramShard m_shards[METRIC_SHARD_COUNT];
+};
+
+class MetricsRegistry {
+public:
+	MetricsRegistry();
+	~MetricsRegistry();
+
+	void Startup();
+	void Shutdown();
+
+	// Thread safe. Getting an existing metric is a locked lookup, cache the pointer on hot paths
+	MetricCounter* GetOrCreateCounter(std::string const& name);
+	MetricGauge* GetOrCreateGauge(std::string const& name);
+	MetricHistogram* GetOrCreateHistogram(std::string const& name, std::string const& unit = "us");
+
+	// Used by the METRIC_* macros, one acquire load once the site has looked its metric up in this registry
+	MetricCounter* GetCallSiteCounter(int callSite, char const* name);
+	MetricGauge* GetCallSiteGauge(int callSite, char const* name);
+	MetricHistogram* GetCallSiteHistogram(int callSite, char const* name);
+
+	void ResetAll();
+	// One metric per line, "<type> <name> <values...>". Used by the console dump and the remote console stream
+	Strings BuildSnapshotLines() const;
+
+	static bool Command_Dump(EventArgs& args);
+	static bool Command_Reset(EventArgs& args);
+
+private:
+	mutable std::mutex m_metricsMutex;
+	std::vector<std::unique_ptr<MetricCounter>> m_counters;
+	std::vector<std::unique_ptr<MetricGauge>> m_gauges;
+	std::vector<std::unique_ptr<MetricHistogram>> m_histograms;
+	std::atomic<void*> m_callSiteMetrics[METRIC_MAX_CALL_SITES] = {};
+};
+
+extern MetricsRegistry* g_theMetrics;
+
+// Resolve the metric once per call site and registry, then it is a sharded atomic add. No-ops while there is no registry
+#define METRIC_COUNTER_ADD(name, amount) \
+	do { if (g_theMetrics) { static int const __metric_site = RegisterMetricCallSite(); g_theMetrics->GetCallSiteCounter(__metric_site, name)->Add(amount); } } while (0)
+#define METRIC_GAUGE_SET(name, value) \
+	do { if (g_theMetrics) { static int const __metric_site = RegisterMetricCallSite(); g_theMetrics->GetCallSiteGauge(__metric_site, name)->Set(value); } } while (0)
+#define METRIC_HISTOGRAM_RECORD(name, value) \
+	do { if (g_theMetrics) { static int const __metric_site = RegisterMetricCallSite(); g_theMetrics->GetCallSiteHistogram(__metric_site, name)->Record(value); } } while (0)
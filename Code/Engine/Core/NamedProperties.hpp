@@ -2,6 +2,8 @@
 #include <map>
 #include <string>
 #include <typeinfo>
+#include <type_traits>
+#include <cstdlib>
 #include "Engine/Core/StringUtils.hpp"
 
 class NamedPropertyBase {
@@ -65,6 +67,24 @@ inline T_Value NamedProperties::GetValue(std::string const& name, T_Value const&
 			NamedProperty<T_Value> const* propertyAsCorrectType = reinterpret_cast<NamedProperty<T_Value> const*>(anyTypeProperty);
 			return propertyAsCorrectType->m_data;
 		}
+		else if constexpr (std::is_arithmetic_v<T_Value>) {
+			// Console and remote console arguments are stored as strings, parse them like NamedStrings does
+			if (anyTypeProperty->IsType(typeid(std::string))) {
+				std::string const& valueAsString = reinterpret_cast<NamedProperty<std::string> const*>(anyTypeProperty)->m_data;
+				if (valueAsString.empty()) return defaultValue;
+
+				if constexpr (std::is_same_v<T_Value, bool>) {
+					return AreStringsEqualCaseInsensitive(valueAsString, "true") || AreStringsEqualCaseInsensitive(valueAsString, "t") || (valueAsString == "1");
+				}
+				else if constexpr (std::is_floating_point_v<T_Value>) {
+					return static_cast<T_Value>(strtod(valueAsString.c_str(), nullptr));
+				}
+				else {
+					return static_cast<T_Value>(strtoll(valueAsString.c_str(), nullptr, 10));
+				}
+			}
+			return defaultValue;
+		}
 		else {
 			return defaultValue;
 		}
@@ -1,4 +1,5 @@
 #pragma once
+#include "Engine/Core/Profiler.hpp"
 #include <stdint.h>
 
 class ProfileLogScope {
@@ -14,4 +15,6 @@ private:
 	bool m_logToConsole = true;
 };
 
-#define PROFILE_LOG_SCOPE(tag) ProfileLogScope __log_scope_##tag(#tag);
\ No newline at end of file
+// Only records into the frame profiler ring, like PROFILE_SCOPE. The timings show up in ProfilerDump and captures instead of
+// formatting a console line on every exit. ProfileLogScope is still there for one off timings printed straight away
+#define PROFILE_LOG_SCOPE(tag) PROFILE_SCOPE(#tag)
\ No newline at end of file
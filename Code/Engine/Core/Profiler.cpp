@@ -0,0 +1,458 @@
+#include "Engine/Core/Profiler.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <mutex>
+#include <intrin.h>
+
+Profiler* g_theProfiler = nullptr;
+std::atomic<bool> g_isProfilerRecording = false;
+
+namespace {
+	constexpr int OVERHEAD_MEASURE_SCOPE_COUNT = 4096;
+	constexpr int OVERHEAD_MEASURE_REPEAT_COUNT = 8;
+
+	// Thread buffers are never freed: a thread that exits still has events to be drained, and the count of threads is small
+	std::mutex s_threadBuffersMutex;
+	std::vector<ProfilerThreadBuffer*> s_threadBuffers;
+	size_t s_eventsPerThread = 1 << 16;
+
+	thread_local ProfilerThreadBuffer* t_threadBuffer = nullptr;
+
+	size_t RoundUpToPowerOfTwo(size_t value)
+	{
+		size_t result = 1;
+		while (result < value) {
+			result <<= 1;
+		}
+		return result;
+	}
+
+	ProfilerThreadBuffer* GetOrCreateThreadBuffer()
+	{
+		if (t_threadBuffer) return t_threadBuffer;
+
+		std::lock_guard<std::mutex> bufferLock(s_threadBuffersMutex);
+		t_threadBuffer = new ProfilerThreadBuffer(s_eventsPerThread, (int)s_threadBuffers.size());
+		t_threadBuffer->m_threadName = (s_threadBuffers.empty()) ? "Main" : Stringf("Thread %d", (int)s_threadBuffers.size());
+		s_threadBuffers.push_back(t_threadBuffer);
+		return t_threadBuffer;
+	}
+
+	std::string EscapeJsonString(char const* text)
+	{
+		std::string escaped;
+		for (char const* character = text; *character != '\0'; character++) {
+			if ((*character == '"') || (*character == '\\')) {
+				escaped += '\\';
+			}
+			escaped += *character;
+		}
+		return escaped;
+	}
+}
+
+ProfileScopeInfo GetProfileScopeInfo(ProfileScopeId scopeId)
+{
+	if (!scopeId) return ProfileScopeInfo{ "Unknown", "", 0 };
+	return *scopeId;
+}
+
+uint64_t GetProfilerTimestamp()
+{
+	return __rdtsc();
+}
+
+void ProfilerSetThreadName(std::string const& threadName)
+{
+	ProfilerThreadBuffer* threadBuffer = GetOrCreateThreadBuffer();
+	std::lock_guard<std::mutex> bufferLock(s_threadBuffersMutex);
+	threadBuffer->m_threadName = threadName;
+}
+
+bool RecordProfilerEvent(ProfileScopeId scopeId, bool isEnd)
+{
+	ProfilerEvent newEvent;
+	newEvent.m_timestamp = __rdtsc();
+	newEvent.m_scopeId = scopeId;
+	newEvent.m_isEnd = isEnd;
+	return GetOrCreateThreadBuffer()->Push(newEvent);
+}
+
+ProfilerThreadBuffer::ProfilerThreadBuffer(size_t capacityPowerOfTwo, int threadIndex) :
+	m_threadIndex(threadIndex)
+{
+	size_t capacity = RoundUpToPowerOfTwo(capacityPowerOfTwo);
+	m_events = new ProfilerEvent[capacity];
+	m_capacityMask = capacity - 1;
+}
+
+ProfilerThreadBuffer::~ProfilerThreadBuffer()
+{
+	delete[] m_events;
+	m_events = nullptr;
+}
+
+bool ProfilerThreadBuffer::Push(ProfilerEvent const& newEvent)
+{
+	size_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+	size_t readIndex = m_readIndex.load(std::memory_order_acquire);
+
+	if ((writeIndex - readIndex) > m_capacityMask) {
+		m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	m_events[writeIndex & m_capacityMask] = newEvent;
+	m_writeIndex.store(writeIndex + 1, std::memory_order_release);
+	return true;
+}
+
+size_t ProfilerThreadBuffer::Drain(std::vector<ProfilerEvent>& outEvents)
+{
+	size_t readIndex = m_readIndex.load(std::memory_order_relaxed);
+	size_t writeIndex = m_writeIndex.load(std::memory_order_acquire);
+
+	for (size_t eventIndex = readIndex; eventIndex < writeIndex; eventIndex++) {
+		outEvents.push_back(m_events[eventIndex & m_capacityMask]);
+	}
+
+	m_readIndex.store(writeIndex, std::memory_order_release);
+	return writeIndex - readIndex;
+}
+
+Profiler::Profiler(ProfilerConfig const& config) :
+	m_config(config)
+{
+	s_eventsPerThread = RoundUpToPowerOfTwo(m_config.m_eventsPerThread);
+}
+
+Profiler::~Profiler()
+{
+}
+
+void Profiler::Startup()
+{
+	// The thread that starts the profiler owns the first buffer
+	ProfilerSetThreadName("Main");
+	CalibrateTicks();
+	MeasureScopeOverhead();
+
+	SubscribeEventCallbackFunction("ProfilerDump", Command_Dump);
+	SubscribeEventCallbackFunction("ProfilerCapture", Command_Capture);
+	SubscribeEventCallbackFunction("ProfilerToggle", Command_Toggle);
+
+	SetEnabled(m_config.m_startEnabled);
+}
+
+void Profiler::Shutdown()
+{
+	SetEnabled(false);
+
+	if (m_captureFramesLeft > 0) {
+		ExportChromeTrace(m_captureFilePath);
+		m_captureFramesLeft = 0;
+	}
+}
+
+void Profiler::BeginFrame()
+{
+}
+
+void Profiler::EndFrame()
+{
+	// Refine the tick rate continuously against the wall clock, the longer it runs the more precise it gets
+	uint64_t elapsedTicks = __rdtsc() - m_calibrationStartTicks;
+	double elapsedSeconds = GetCurrentTimeSeconds() - m_calibrationStartSeconds;
+	if ((elapsedTicks > 0) && (elapsedSeconds > 0.0)) {
+		m_secondsPerTick = elapsedSeconds / (double)elapsedTicks;
+	}
+
+	std::vector<ProfilerThreadBuffer*> threadBuffers;
+	{
+		std::lock_guard<std::mutex> bufferLock(s_threadBuffersMutex);
+		threadBuffers = s_threadBuffers;
+	}
+
+	if (m_threadTrees.size() < threadBuffers.size()) {
+		m_threadTrees.resize(threadBuffers.size());
+	}
+
+	for (ProfilerThreadBuffer* threadBuffer : threadBuffers) {
+		ProcessThreadEvents(*threadBuffer, m_threadTrees[threadBuffer->GetThreadIndex()]);
+	}
+
+	if (m_captureFramesLeft > 0) {
+		m_captureFramesLeft--;
+		if (m_captureFramesLeft == 0) {
+			bool wasExported = ExportChromeTrace(m_captureFilePath);
+			Rgba8 const& lineColor = (wasExported) ? DevConsole::INFO_MAJOR_COLOR : DevConsole::ERROR_COLOR;
+			g_theConsole->AddLine(lineColor, Stringf("Profiler capture %s %s", m_captureFilePath.c_str(), (wasExported) ? "written" : "could not be written"));
+			m_capturedSpans.clear();
+		}
+	}
+
+	m_frameNumber++;
+}
+
+void Profiler::ProcessThreadEvents(ProfilerThreadBuffer& threadBuffer, ProfilerThreadTree& threadTree)
+{
+	if (threadTree.m_nodes.empty()) {
+		threadTree.m_nodes.emplace_back();
+	}
+
+	for (ProfilerNode& node : threadTree.m_nodes) {
+		node.m_callCount = 0;
+		node.m_totalTicks = 0;
+		node.m_minTicks = UINT64_MAX;
+		node.m_maxTicks = 0;
+	}
+
+	m_drainedEvents.clear();
+	threadBuffer.Drain(m_drainedEvents);
+
+	for (ProfilerEvent const& scopeEvent : m_drainedEvents) {
+		if (!scopeEvent.m_isEnd) {
+			int parentIndex = (threadTree.m_openScopes.empty()) ? 0 : threadTree.m_openScopes.back().m_nodeIndex;
+			int nodeIndex = GetOrCreateChildNode(threadTree, parentIndex, scopeEvent.m_scopeId);
+			threadTree.m_openScopes.push_back(ProfilerOpenScope{ nodeIndex, scopeEvent.m_timestamp });
+			continue;
+		}
+
+		// Ends always match a begin of the same thread, unless the begin was dropped while the ring was full.
+		// Unwind to the matching scope so the tree recovers instead of drifting
+		auto openScopeIter = std::find_if(threadTree.m_openScopes.rbegin(), threadTree.m_openScopes.rend(), [&](ProfilerOpenScope const& openScope) {
+			return threadTree.m_nodes[openScope.m_nodeIndex].m_scopeId == scopeEvent.m_scopeId;
+			});
+		if (openScopeIter == threadTree.m_openScopes.rend()) continue;
+
+		ProfilerOpenScope closedScope = *openScopeIter;
+		threadTree.m_openScopes.erase(std::next(openScopeIter).base(), threadTree.m_openScopes.end());
+
+		uint64_t durationTicks = (scopeEvent.m_timestamp > closedScope.m_beginTimestamp) ? scopeEvent.m_timestamp - closedScope.m_beginTimestamp : 0;
+		ProfilerNode& node = threadTree.m_nodes[closedScope.m_nodeIndex];
+		node.m_callCount++;
+		node.m_totalTicks += durationTicks;
+		node.m_minTicks = (std::min)(node.m_minTicks, durationTicks);
+		node.m_maxTicks = (std::max)(node.m_maxTicks, durationTicks);
+
+		if (m_captureFramesLeft > 0) {
+			m_capturedSpans.push_back(ProfilerCapturedSpan{ scopeEvent.m_scopeId, threadBuffer.GetThreadIndex(), closedScope.m_beginTimestamp, durationTicks });
+		}
+	}
+
+	for (ProfilerNode& node : threadTree.m_nodes) {
+		if (node.m_callCount == 0) continue;
+		node.m_framesSeen++;
+		node.m_historyTotalTicks += node.m_totalTicks;
+		node.m_historyMinFrameTicks = (std::min)(node.m_historyMinFrameTicks, node.m_totalTicks);
+		node.m_historyMaxFrameTicks = (std::max)(node.m_historyMaxFrameTicks, node.m_totalTicks);
+	}
+}
+
+int Profiler::GetOrCreateChildNode(ProfilerThreadTree& threadTree, int parentIndex, ProfileScopeId scopeId)
+{
+	int lastChildIndex = -1;
+	for (int childIndex = threadTree.m_nodes[parentIndex].m_firstChildIndex; childIndex != -1; childIndex = threadTree.m_nodes[childIndex].m_nextSiblingIndex) {
+		if (threadTree.m_nodes[childIndex].m_scopeId == scopeId) return childIndex;
+		lastChildIndex = childIndex;
+	}
+
+	int newNodeIndex = (int)threadTree.m_nodes.size();
+	ProfilerNode newNode;
+	newNode.m_scopeId = scopeId;
+	newNode.m_parentIndex = parentIndex;
+	threadTree.m_nodes.push_back(newNode);
+
+	if (lastChildIndex == -1) {
+		threadTree.m_nodes[parentIndex].m_firstChildIndex = newNodeIndex;
+	}
+	else {
+		threadTree.m_nodes[lastChildIndex].m_nextSiblingIndex = newNodeIndex;
+	}
+
+	return newNodeIndex;
+}
+
+void Profiler::CalibrateTicks()
+{
+	// Rough initial estimate, EndFrame keeps refining it
+	m_calibrationStartTicks = __rdtsc();
+	m_calibrationStartSeconds = GetCurrentTimeSeconds();
+
+	double calibrationEndSeconds = m_calibrationStartSeconds + 0.01;
+	double currentSeconds = m_calibrationStartSeconds;
+	while (currentSeconds < calibrationEndSeconds) {
+		currentSeconds = GetCurrentTimeSeconds();
+	}
+
+	uint64_t elapsedTicks = __rdtsc() - m_calibrationStartTicks;
+	m_secondsPerTick = (currentSeconds - m_calibrationStartSeconds) / (double)((elapsedTicks > 0) ? elapsedTicks : 1);
+}
+
+void Profiler::MeasureScopeOverhead()
+{
+	// Empty scopes, timed as a batch so the cost of reading the counter is spread out. Best of a few repeats, like a benchmark.
+	// Recording is measured on the calling thread's real buffer, then the measurement events are drained and thrown away
+	static constexpr ProfileScopeInfo s_measureScopeInfo = { "Profiler Overhead", __FILE__, __LINE__ };
+	int scopeCount = (std::min)(OVERHEAD_MEASURE_SCOPE_COUNT, (int)(s_eventsPerThread / 2)); // Begin and end must fit in the ring
+	bool wasRecording = g_isProfilerRecording.load(std::memory_order_relaxed);
+	ProfilerThreadBuffer* threadBuffer = GetOrCreateThreadBuffer();
+
+	uint64_t bestRecordedTicks = UINT64_MAX;
+	uint64_t bestDisabledTicks = UINT64_MAX;
+	for (int repeatIndex = 0; repeatIndex < OVERHEAD_MEASURE_REPEAT_COUNT; repeatIndex++) {
+		g_isProfilerRecording.store(true, std::memory_order_relaxed);
+		uint64_t recordedStartTicks = __rdtsc();
+		for (int scopeIndex = 0; scopeIndex < scopeCount; scopeIndex++) {
+			ProfileScope measuredScope(&s_measureScopeInfo);
+		}
+		uint64_t recordedTicks = __rdtsc() - recordedStartTicks;
+		bestRecordedTicks = (std::min)(bestRecordedTicks, recordedTicks);
+
+		g_isProfilerRecording.store(false, std::memory_order_relaxed);
+		uint64_t disabledStartTicks = __rdtsc();
+		for (int scopeIndex = 0; scopeIndex < scopeCount; scopeIndex++) {
+			ProfileScope measuredScope(&s_measureScopeInfo);
+		}
+		uint64_t disabledTicks = __rdtsc() - disabledStartTicks;
+		bestDisabledTicks = (std::min)(bestDisabledTicks, disabledTicks);
+
+		m_drainedEvents.clear();
+		threadBuffer->Drain(m_drainedEvents);
+	}
+
+	m_drainedEvents.clear();
+	g_isProfilerRecording.store(wasRecording, std::memory_order_relaxed);
+	m_recordedScopeOverheadTicks = (double)bestRecordedTicks / (double)scopeCount;
+	m_disabledScopeOverheadTicks = (double)bestDisabledTicks / (double)scopeCount;
+}
+
+void Profiler::SetEnabled(bool isEnabled)
+{
+	g_isProfilerRecording.store(isEnabled, std::memory_order_relaxed);
+}
+
+bool Profiler::IsEnabled() const
+{
+	return g_isProfilerRecording.load(std::memory_order_relaxed);
+}
+
+void Profiler::StartCapture(int frameCount, std::string const& traceFilePath)
+{
+	m_capturedSpans.clear();
+	m_captureFilePath = traceFilePath;
+	m_captureFramesLeft = (frameCount > 0) ? frameCount : 1;
+	SetEnabled(true);
+}
+
+bool Profiler::ExportChromeTrace(std::string const& traceFilePath) const
+{
+	uint64_t firstTimestamp = UINT64_MAX;
+	for (ProfilerCapturedSpan const& span : m_capturedSpans) {
+		firstTimestamp = (std::min)(firstTimestamp, span.m_beginTimestamp);
+	}
+
+	double microsecondsPerTick = m_secondsPerTick * 1'000'000.0;
+
+	std::string traceJson = "{\"traceEvents\":[\n";
+	bool isFirstEvent = true;
+
+	{
+		std::lock_guard<std::mutex> bufferLock(s_threadBuffersMutex);
+		for (ProfilerThreadBuffer const* threadBuffer : s_threadBuffers) {
+			if (!isFirstEvent) traceJson += ",\n";
+			traceJson += Stringf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", threadBuffer->GetThreadIndex(), EscapeJsonString(threadBuffer->m_threadName.c_str()).c_str());
+			isFirstEvent = false;
+		}
+	}
+
+	for (ProfilerCapturedSpan const& span : m_capturedSpans) {
+		ProfileScopeInfo scopeInfo = GetProfileScopeInfo(span.m_scopeId);
+		double beginMicroseconds = (double)(span.m_beginTimestamp - firstTimestamp) * microsecondsPerTick;
+		double durationMicroseconds = (double)span.m_durationTicks * microsecondsPerTick;
+
+		if (!isFirstEvent) traceJson += ",\n";
+		traceJson += Stringf("{\"name\":\"%s\",\"cat\":\"engine\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%d}", EscapeJsonString(scopeInfo.m_name).c_str(), beginMicroseconds, durationMicroseconds, span.m_threadIndex);
+		isFirstEvent = false;
+	}
+
+	traceJson += "\n]}\n";
+
+	std::vector<uint8_t> traceBuffer(traceJson.begin(), traceJson.end());
+	return FileWriteFromBuffer(traceBuffer, traceFilePath) == 0;
+}
+
+void Profiler::DumpToConsole() const
+{
+	g_theConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("# Profiler frame %d (calls | frame total | min | max | avg per call | history avg per frame, in ms) #", m_frameNumber));
+	double nanosecondsPerTick = m_secondsPerTick * 1'000'000'000.0;
+	g_theConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("Scope overhead: %.1f ns recorded, %.2f ns disabled (included in the times below)",
+		m_recordedScopeOverheadTicks * nanosecondsPerTick, m_disabledScopeOverheadTicks * nanosecondsPerTick));
+
+	std::lock_guard<std::mutex> bufferLock(s_threadBuffersMutex);
+	for (ProfilerThreadBuffer const* threadBuffer : s_threadBuffers) {
+		int threadIndex = threadBuffer->GetThreadIndex();
+		if (threadIndex >= (int)m_threadTrees.size()) continue;
+
+		ProfilerThreadTree const& threadTree = m_threadTrees[threadIndex];
+		if (threadTree.m_nodes.empty() || (threadTree.m_nodes[0].m_firstChildIndex == -1)) continue;
+
+		g_theConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("[%s] dropped events: %llu", threadBuffer->m_threadName.c_str(), threadBuffer->GetDroppedEvents()));
+		for (int childIndex = threadTree.m_nodes[0].m_firstChildIndex; childIndex != -1; childIndex = threadTree.m_nodes[childIndex].m_nextSiblingIndex) {
+			DumpNode(threadTree, childIndex, 1);
+		}
+	}
+}
+
+void Profiler::DumpNode(ProfilerThreadTree const& threadTree, int nodeIndex, int depth) const
+{
+	ProfilerNode const& node = threadTree.m_nodes[nodeIndex];
+	ProfileScopeInfo scopeInfo = GetProfileScopeInfo(node.m_scopeId);
+
+	double millisecondsPerTick = m_secondsPerTick * 1000.0;
+	double frameTotalMs = (double)node.m_totalTicks * millisecondsPerTick;
+	double minMs = (node.m_callCount > 0) ? (double)node.m_minTicks * millisecondsPerTick : 0.0;
+	double maxMs = (double)node.m_maxTicks * millisecondsPerTick;
+	double avgMs = (node.m_callCount > 0) ? frameTotalMs / (double)node.m_callCount : 0.0;
+	double historyAvgMs = (node.m_framesSeen > 0) ? ((double)node.m_historyTotalTicks * millisecondsPerTick) / (double)node.m_framesSeen : 0.0;
+
+	std::string indentation(depth * 2, ' ');
+	g_theConsole->AddLine(DevConsole::INFO_MINOR_COLOR, Stringf("%s%s: %u | %.3f | %.3f | %.3f | %.3f | %.3f", indentation.c_str(), scopeInfo.m_name, node.m_callCount, frameTotalMs, minMs, maxMs, avgMs, historyAvgMs));
+
+	for (int childIndex = node.m_firstChildIndex; childIndex != -1; childIndex = threadTree.m_nodes[childIndex].m_nextSiblingIndex) {
+		DumpNode(threadTree, childIndex, depth + 1);
+	}
+}
+
+bool Profiler::Command_Dump(EventArgs& args)
+{
+	UNUSED(args);
+	if (!g_theProfiler) return false;
+
+	g_theProfiler->DumpToConsole();
+	return true;
+}
+
+bool Profiler::Command_Capture(EventArgs& args)
+{
+	if (!g_theProfiler) return false;
+
+	int frameCount = args.GetValue("frames", 1);
+	std::string traceFilePath = args.GetValue("file", "Data/Profiling/Trace.json");
+
+	g_theProfiler->StartCapture(frameCount, traceFilePath);
+	g_theConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("Capturing %d frame(s) to %s (open with chrome://tracing or ui.perfetto.dev)", frameCount, traceFilePath.c_str()));
+	return true;
+}
+
+bool Profiler::Command_Toggle(EventArgs& args)
+{
+	if (!g_theProfiler) return false;
+
+	bool isEnabled = args.GetValue("enabled", !g_theProfiler->IsEnabled());
+	g_theProfiler->SetEnabled(isEnabled);
+	g_theConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("Profiler recording %s", (isEnabled) ? "enabled" : "disabled"));
+	return true;
+}
@@ -0,0 +1,183 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+#include "Game/EngineBuildPreferences.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct ProfileScopeInfo {
+	char const* m_name = nullptr;
+	char const* m_file = nullptr;
+	int m_line = 0;
+};
+
+// A scope is identified by the address of the ProfileScopeInfo constant PROFILE_SCOPE defines at its call site, so nothing
+// is registered at runtime. Names are only read through it when the profiler reports
+typedef ProfileScopeInfo const* ProfileScopeId;
+
+struct ProfilerEvent {
+	uint64_t m_timestamp = 0;
+	ProfileScopeId m_scopeId = nullptr;
+	bool m_isEnd = false;
+};
+
+/// <summary>
+/// Single producer (owning thread) / single consumer (Profiler::EndFrame) ring of scope events.
+/// The owner never blocks: when the ring is full the event is dropped and counted
+/// </summary>
+class ProfilerThreadBuffer {
+public:
+	ProfilerThreadBuffer(size_t capacityPowerOfTwo, int threadIndex);
+	~ProfilerThreadBuffer();
+
+	bool Push(ProfilerEvent const& newEvent);
+	size_t Drain(std::vector<ProfilerEvent>& outEvents);
+
+	int GetThreadIndex() const { return m_threadIndex; }
+	uint64_t GetDroppedEvents() const { return m_droppedEvents.load(std::memory_order_relaxed); }
+
+	std::string m_threadName;
+
+private:
+	ProfilerEvent* m_events = nullptr;
+	size_t m_capacityMask = 0;
+	int m_threadIndex = -1;
+	alignas(64) std::atomic<size_t> m_writeIndex = 0;
+	alignas(64) std::atomic<size_t> m_readIndex = 0;
+	std::atomic<uint64_t> m_droppedEvents = 0;
+};
+
+struct ProfilerNode {
+	ProfileScopeId m_scopeId = nullptr;
+	int m_parentIndex = -1;
+	int m_firstChildIndex = -1;
+	int m_nextSiblingIndex = -1;
+
+	// Current frame, per call
+	uint32_t m_callCount = 0;
+	uint64_t m_totalTicks = 0;
+	uint64_t m_minTicks = UINT64_MAX;
+	uint64_t m_maxTicks = 0;
+
+	// History, per frame totals
+	uint64_t m_framesSeen = 0;
+	uint64_t m_historyTotalTicks = 0;
+	uint64_t m_historyMinFrameTicks = UINT64_MAX;
+	uint64_t m_historyMaxFrameTicks = 0;
+};
+
+struct ProfilerOpenScope {
+	int m_nodeIndex = -1;
+	uint64_t m_beginTimestamp = 0;
+};
+
+struct ProfilerThreadTree {
+	std::vector<ProfilerNode> m_nodes; // Node 0 is the thread root
+	std::vector<ProfilerOpenScope> m_openScopes;
+};
+
+struct ProfilerCapturedSpan {
+	ProfileScopeId m_scopeId = nullptr;
+	int m_threadIndex = 0;
+	uint64_t m_beginTimestamp = 0;
+	uint64_t m_durationTicks = 0;
+};
+
+struct ProfilerConfig {
+	size_t m_eventsPerThread = 1 << 16; // Rounded up to a power of two
+	bool m_startEnabled = true;
+};
+
+class Profiler {
+public:
+	Profiler(ProfilerConfig const& config);
+	~Profiler();
+
+	void Startup();
+	void Shutdown();
+	void BeginFrame();
+	void EndFrame();
+
+	void SetEnabled(bool isEnabled);
+	bool IsEnabled() const;
+
+	void StartCapture(int frameCount, std::string const& traceFilePath);
+	bool ExportChromeTrace(std::string const& traceFilePath) const;
+	void DumpToConsole() const;
+
+	double GetSecondsPerTick() const { return m_secondsPerTick; }
+	// Measured at startup: ticks a recorded scope adds to what it encloses, and what a scope costs while recording is off
+	double GetRecordedScopeOverheadTicks() const { return m_recordedScopeOverheadTicks; }
+	double GetDisabledScopeOverheadTicks() const { return m_disabledScopeOverheadTicks; }
+
+	static bool Command_Dump(EventArgs& args);
+	static bool Command_Capture(EventArgs& args);
+	static bool Command_Toggle(EventArgs& args);
+
+private:
+	void ProcessThreadEvents(ProfilerThreadBuffer& threadBuffer, ProfilerThreadTree& threadTree);
+	int GetOrCreateChildNode(ProfilerThreadTree& threadTree, int parentIndex, ProfileScopeId scopeId);
+	void DumpNode(ProfilerThreadTree const& threadTree, int nodeIndex, int depth) const;
+	void CalibrateTicks();
+	void MeasureScopeOverhead();
+
+private:
+	ProfilerConfig m_config;
+	std::vector<ProfilerThreadTree> m_threadTrees;
+	std::vector<ProfilerEvent> m_drainedEvents;
+
+	std::vector<ProfilerCapturedSpan> m_capturedSpans;
+	std::string m_captureFilePath;
+	int m_captureFramesLeft = 0;
+
+	double m_secondsPerTick = 0.0;
+	double m_recordedScopeOverheadTicks = 0.0;
+	double m_disabledScopeOverheadTicks = 0.0;
+	uint64_t m_calibrationStartTicks = 0;
+	double m_calibrationStartSeconds = 0.0;
+	int m_frameNumber = 0;
+};
+
+extern Profiler* g_theProfiler;
+extern std::atomic<bool> g_isProfilerRecording;
+
+ProfileScopeInfo GetProfileScopeInfo(ProfileScopeId scopeId);
+uint64_t GetProfilerTimestamp();
+void ProfilerSetThreadName(std::string const& threadName);
+bool RecordProfilerEvent(ProfileScopeId scopeId, bool isEnd);
+
+class ProfileScope {
+public:
+	ProfileScope(ProfileScopeId scopeId) :
+		m_scopeId(scopeId)
+	{
+		if (g_isProfilerRecording.load(std::memory_order_relaxed)) {
+			m_isRecording = RecordProfilerEvent(m_scopeId, false);
+		}
+	}
+
+	~ProfileScope()
+	{
+		// Only close what was opened, so dropped begins never produce orphan ends
+		if (m_isRecording) {
+			RecordProfilerEvent(m_scopeId, true);
+		}
+	}
+
+private:
+	ProfileScopeId m_scopeId = nullptr;
+	bool m_isRecording = false;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// The scope info is a compile time constant (no guard, no registration), recording costs two ring pushes
+#if defined(ENGINE_DISABLE_PROFILER)
+#define PROFILE_SCOPE(name)
+#else
+#define PROFILE_SCOPE(name) \
+	static constexpr ProfileScopeInfo PROFILE_CONCAT(__profile_scope_info_, __LINE__) = { name, __FILE__, __LINE__ }; \
+	ProfileScope PROFILE_CONCAT(__profile_scope_, __LINE__)(&PROFILE_CONCAT(__profile_scope_info_, __LINE__));
+#endif
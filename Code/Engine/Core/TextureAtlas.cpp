@@ -0,0 +1,171 @@
+#include "Engine/Core/TextureAtlas.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Math/RectanglePacker.hpp"
+#include <algorithm>
+
+namespace {
+	int RoundUpToMultiple(int value, int multiple)
+	{
+		return ((value + multiple - 1) / multiple) * multiple;
+	}
+
+	int ClampTexel(int value, int maxValue)
+	{
+		return (value < 0) ? 0 : ((value > maxValue) ? maxValue : value);
+	}
+}
+
+TextureAtlasBuilder::TextureAtlasBuilder(TextureAtlasConfig const& config):
+	m_config(config)
+{
+}
+
+int TextureAtlasBuilder::AddImage(Image const& image)
+{
+	return AddSpriteGrid(image, IntVec2(1, 1));
+}
+
+int TextureAtlasBuilder::AddSpriteGrid(Image const& image, IntVec2 const& simpleGridLayout)
+{
+	int sourceIndex = (int)m_sourceImages.size();
+	m_sourceImages.push_back(image);
+
+	AtlasSpriteGroup spriteGroup;
+	spriteGroup.m_firstSprite = (int)m_sprites.size();
+	spriteGroup.m_spriteCount = simpleGridLayout.x * simpleGridLayout.y;
+
+	// Image row 0 is the bottom of the picture, while grid sprite 0 is the top left cell
+	IntVec2 dimensions = image.GetDimensions();
+	IntVec2 cellSize(dimensions.x / simpleGridLayout.x, dimensions.y / simpleGridLayout.y);
+	for (int row = 0; row < simpleGridLayout.y; row++) {
+		for (int column = 0; column < simpleGridLayout.x; column++) {
+			AtlasSprite sprite;
+			sprite.m_sourceIndex = sourceIndex;
+			sprite.m_sourceMins = IntVec2(column * cellSize.x, (simpleGridLayout.y - 1 - row) * cellSize.y);
+			sprite.m_size = cellSize;
+			sprite.m_cellSize = GetCellSize(cellSize);
+			m_sprites.push_back(sprite);
+		}
+	}
+
+	m_spriteGroups.push_back(spriteGroup);
+	return (int)m_spriteGroups.size() - 1;
+}
+
+bool TextureAtlasBuilder::Build()
+{
+	m_pages.clear();
+	m_pageOccupancies.clear();
+	m_groups.assign(m_spriteGroups.size(), TextureAtlasGroup());
+
+	int alignment = 1 << ((m_config.m_mipSafeLevels > 1) ? (m_config.m_mipSafeLevels - 1) : 0);
+	IntVec2 binSize((m_config.m_pageSize.x / alignment) * alignment, (m_config.m_pageSize.y / alignment) * alignment);
+
+	// Biggest groups first leave the small ones to fill the gaps
+	std::vector<long long> groupAreas(m_spriteGroups.size(), 0);
+	std::vector<int> groupOrder(m_spriteGroups.size());
+	for (int groupIndex = 0; groupIndex < (int)m_spriteGroups.size(); groupIndex++) {
+		groupOrder[groupIndex] = groupIndex;
+		AtlasSpriteGroup const& spriteGroup = m_spriteGroups[groupIndex];
+		for (int spriteIndex = spriteGroup.m_firstSprite; spriteIndex < spriteGroup.m_firstSprite + spriteGroup.m_spriteCount; spriteIndex++) {
+			groupAreas[groupIndex] += (long long)m_sprites[spriteIndex].m_cellSize.x * m_sprites[spriteIndex].m_cellSize.y;
+		}
+	}
+	std::stable_sort(groupOrder.begin(), groupOrder.end(), [&](int groupA, int groupB) { return groupAreas[groupA] > groupAreas[groupB]; });
+
+	std::vector<RectanglePacker> pagePackers;
+	std::vector<int> placementOrder;
+	std::vector<IntVec2> placements;
+	for (int groupIndex : groupOrder) {
+		AtlasSpriteGroup const& spriteGroup = m_spriteGroups[groupIndex];
+		placementOrder.resize(spriteGroup.m_spriteCount);
+		for (int spriteOffset = 0; spriteOffset < spriteGroup.m_spriteCount; spriteOffset++) {
+			placementOrder[spriteOffset] = spriteGroup.m_firstSprite + spriteOffset;
+		}
+		std::stable_sort(placementOrder.begin(), placementOrder.end(), [&](int spriteA, int spriteB) { return m_sprites[spriteA].m_cellSize.y > m_sprites[spriteB].m_cellSize.y; });
+
+		// A group goes on the first page it fits on whole, trying it on a copy so a partial fit leaves the page untouched
+		bool isPlaced = false;
+		placements.resize(spriteGroup.m_spriteCount);
+		for (int pageIndex = 0; (pageIndex <= (int)pagePackers.size()) && !isPlaced; pageIndex++) {
+			bool isNewPage = pageIndex == (int)pagePackers.size();
+			RectanglePacker trialPacker = isNewPage ? RectanglePacker(binSize) : pagePackers[pageIndex];
+			isPlaced = true;
+			for (int placementIndex = 0; (placementIndex < spriteGroup.m_spriteCount) && isPlaced; placementIndex++) {
+				isPlaced = trialPacker.Insert(m_sprites[placementOrder[placementIndex]].m_cellSize, placements[placementIndex]);
+			}
+			if (!isPlaced) continue;
+
+			if (isNewPage) {
+				pagePackers.push_back(trialPacker);
+			}
+			else {
+				pagePackers[pageIndex] = trialPacker;
+			}
+			for (int placementIndex = 0; placementIndex < spriteGroup.m_spriteCount; placementIndex++) {
+				m_sprites[placementOrder[placementIndex]].m_cellMins = placements[placementIndex];
+			}
+			m_groups[groupIndex].m_pageIndex = pageIndex;
+		}
+
+		if (!isPlaced) {
+			ERROR_RECOVERABLE(Stringf("Atlas sprite group %d does not fit on a %dx%d page", groupIndex, binSize.x, binSize.y));
+			m_groups.clear();
+			return false;
+		}
+	}
+
+	for (int pageIndex = 0; pageIndex < (int)pagePackers.size(); pageIndex++) {
+		m_pages.emplace_back(m_config.m_pageSize, Rgba8(0, 0, 0, 0));
+		m_pageOccupancies.push_back(pagePackers[pageIndex].GetOccupancy());
+	}
+
+	Vec2 texelToUV(1.0f / (float)m_config.m_pageSize.x, 1.0f / (float)m_config.m_pageSize.y);
+	for (int groupIndex = 0; groupIndex < (int)m_spriteGroups.size(); groupIndex++) {
+		AtlasSpriteGroup const& spriteGroup = m_spriteGroups[groupIndex];
+		TextureAtlasGroup& group = m_groups[groupIndex];
+		group.m_spriteUVs.resize(spriteGroup.m_spriteCount);
+		for (int spriteOffset = 0; spriteOffset < spriteGroup.m_spriteCount; spriteOffset++) {
+			AtlasSprite const& sprite = m_sprites[spriteGroup.m_firstSprite + spriteOffset];
+			CopySpriteToPage(sprite, m_pages[group.m_pageIndex]);
+
+			Vec2 texelMins((float)(sprite.m_cellMins.x + m_config.m_padding), (float)(sprite.m_cellMins.y + m_config.m_padding));
+			Vec2 texelMaxs = texelMins + Vec2((float)sprite.m_size.x, (float)sprite.m_size.y);
+			group.m_spriteUVs[spriteOffset] = AABB2(Vec2(texelMins.x * texelToUV.x, texelMins.y * texelToUV.y), Vec2(texelMaxs.x * texelToUV.x, texelMaxs.y * texelToUV.y));
+		}
+	}
+
+	if (m_config.m_mipSafeLevels > 1) {
+		for (Image& page : m_pages) {
+			page.GenerateMipChain(m_config.m_mipFilter);
+		}
+	}
+	return true;
+}
+
+IntVec2 TextureAtlasBuilder::GetCellSize(IntVec2 const& spriteSize) const
+{
+	int alignment = 1 << ((m_config.m_mipSafeLevels > 1) ? (m_config.m_mipSafeLevels - 1) : 0);
+	return IntVec2(RoundUpToMultiple(spriteSize.x + 2 * m_config.m_padding, alignment), RoundUpToMultiple(spriteSize.y + 2 * m_config.m_padding, alignment));
+}
+
+// The sprite goes in at the padding offset, the rest of its cell repeats the nearest edge texel
+void TextureAtlasBuilder::CopySpriteToPage(AtlasSprite const& sprite, Image& page) const
+{
+	Image const& source = m_sourceImages[sprite.m_sourceIndex];
+	Rgba8 const* sourceTexels = source.GetMipTexels(0);
+	int sourceWidth = source.GetDimensions().x;
+	Rgba8* pageTexels = static_cast<Rgba8*>(page.GetRawData());
+	int pageWidth = page.GetDimensions().x;
+
+	for (int cellY = 0; cellY < sprite.m_cellSize.y; cellY++) {
+		int spriteY = ClampTexel(cellY - m_config.m_padding, sprite.m_size.y - 1);
+		Rgba8 const* sourceRow = sourceTexels + (size_t)(sprite.m_sourceMins.y + spriteY) * sourceWidth + sprite.m_sourceMins.x;
+		Rgba8* pageRow = pageTexels + (size_t)(sprite.m_cellMins.y + cellY) * pageWidth + sprite.m_cellMins.x;
+		for (int cellX = 0; cellX < sprite.m_cellSize.x; cellX++) {
+			pageRow[cellX] = sourceRow[ClampTexel(cellX - m_config.m_padding, sprite.m_size.x - 1)];
+		}
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "Engine/Core/Image.hpp"
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include <vector>
+
+struct TextureAtlasConfig {
+	IntVec2 m_pageSize = IntVec2(2048, 2048);
+	int m_padding = 2; // Texels around every sprite, filled by repeating its edge texels so filtering never reads a neighbour
+	// Mip levels (counting the full size one) that must not mix sprites: sprite cells start and end on multiples of
+	// 2^(m_mipSafeLevels - 1) texels, so every box filtered texel of those levels covers a single sprite. Pages get a mip
+	// chain when this is over 1, levels past it can bleed
+	int m_mipSafeLevels = 1;
+	MipFilter m_mipFilter = MipFilter::BOX;
+};
+
+struct TextureAtlasGroup {
+	int m_pageIndex = -1;
+	std::vector<AABB2> m_spriteUVs; // In the same order as the sprites were added
+};
+
+/// <summary>
+/// Packs many images into shared atlas pages, so sprites and fonts drawn together use the same texture. Images are added as
+/// groups: a single sprite, or a grid sheet cut into one sprite per cell. A group always lands on a single page with its
+/// sprites in order, so a SpriteSheet built from the group UVs has the same sprite indexes as the grid one it replaces and
+/// SpriteAnimDefinitions keep working. Groups are packed largest first with a RectanglePacker per page
+/// </summary>
+class TextureAtlasBuilder {
+public:
+	explicit TextureAtlasBuilder(TextureAtlasConfig const& config = TextureAtlasConfig());
+
+	// Both return the group index. The image is copied, it can go away before Build
+	int AddImage(Image const& image);
+	// Cells are numbered like SpriteSheet's simpleGridLayout: top left first, left to right, then down
+	int AddSpriteGrid(Image const& image, IntVec2 const& simpleGridLayout);
+
+	// False when a group can't fit on an empty page. Pages and groups from a previous Build are replaced
+	bool Build();
+
+	int GetPageCount() const { return (int)m_pages.size(); }
+	Image const& GetPage(int pageIndex) const { return m_pages[pageIndex]; }
+	int GetGroupCount() const { return (int)m_groups.size(); }
+	TextureAtlasGroup const& GetGroup(int groupIndex) const { return m_groups[groupIndex]; }
+	float GetPageOccupancy(int pageIndex) const { return m_pageOccupancies[pageIndex]; }
+
+private:
+	struct AtlasSprite {
+		int m_sourceIndex = 0;
+		IntVec2 m_sourceMins = IntVec2::ZERO;
+		IntVec2 m_size = IntVec2::ZERO;
+		IntVec2 m_cellMins = IntVec2::ZERO; // Placement of the padded, aligned cell on the page
+		IntVec2 m_cellSize = IntVec2::ZERO;
+	};
+
+	struct AtlasSpriteGroup {
+		int m_firstSprite = 0;
+		int m_spriteCount = 0;
+	};
+
+	IntVec2 GetCellSize(IntVec2 const& spriteSize) const;
+	void CopySpriteToPage(AtlasSprite const& sprite, Image& page) const;
+
+private:
+	TextureAtlasConfig m_config;
+	std::vector<Image> m_sourceImages;
+	std::vector<AtlasSprite> m_sprites;
+	std::vector<AtlasSpriteGroup> m_spriteGroups;
+
+	std::vector<Image> m_pages;
+	std::vector<float> m_pageOccupancies;
+	std::vector<TextureAtlasGroup> m_groups;
+};
@@ -0,0 +1,811 @@
+#include "Engine/Core/TilePathfinding.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include <algorithm>
+
+namespace {
+	constexpr int TILE_PATH_DIRECTION_COUNT = 4;
+	constexpr int TILE_PATH_BUCKET_COUNT = TILE_PATH_MAX_STEP_COST + 1;
+	constexpr int TILE_PATH_LONG_ENTRANCE_LENGTH = 6; // Entrances at least this wide get a transition at each end instead of one in the middle
+
+	IntVec2 const TILE_PATH_STEPS[TILE_PATH_DIRECTION_COUNT] = { IntVec2(1, 0), IntVec2(-1, 0), IntVec2(0, 1), IntVec2(0, -1) };
+
+	uint8_t GetStepCostForTileCost(float tileCost)
+	{
+		if ((tileCost < 0.0f) || (tileCost >= TILE_PATH_SOLID_COST)) return 0;
+
+		int stepCost = (int)(tileCost + 0.5f);
+		if (stepCost < 1) return 1;
+		if (stepCost > TILE_PATH_MAX_STEP_COST) return (uint8_t)TILE_PATH_MAX_STEP_COST;
+		return (uint8_t)stepCost;
+	}
+
+	uint64_t GetOpenKey(uint32_t estimatedTotalCost, uint32_t costSoFar)
+	{
+		return ((uint64_t)estimatedTotalCost << 32) | (uint64_t)(0xFFFFFFFFu - costSoFar);
+	}
+
+	template <typename T_OpenNode>
+	bool IsOpenNodeWorse(T_OpenNode const& nodeA, T_OpenNode const& nodeB)
+	{
+		return nodeA.m_key > nodeB.m_key;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------------------------
+// TilePathGrid
+TilePathGrid::TilePathGrid(TileHeatMap const& tileCosts)
+{
+	Build(tileCosts);
+}
+
+void TilePathGrid::Build(TileHeatMap const& tileCosts)
+{
+	m_dimensions = tileCosts.GetDimensions();
+	m_stepCosts.resize(tileCosts.GetTileCount());
+
+	float const* costs = tileCosts.GetValues();
+	for (int tileIndex = 0; tileIndex < (int)m_stepCosts.size(); tileIndex++) {
+		m_stepCosts[tileIndex] = GetStepCostForTileCost(costs[tileIndex]);
+	}
+
+	RefreshMinStepCost();
+}
+
+void TilePathGrid::SetTileCost(IntVec2 const& coords, float tileCost)
+{
+	if (!IsInBounds(coords)) return;
+
+	uint8_t stepCost = GetStepCostForTileCost(tileCost);
+	m_stepCosts[GetTileIndex(coords)] = stepCost;
+
+	// Only ever lowered here, a minimum that is too low keeps the A* heuristic admissible
+	if ((stepCost != 0) && (stepCost < m_minStepCost)) {
+		m_minStepCost = stepCost;
+	}
+}
+
+void TilePathGrid::RefreshMinStepCost()
+{
+	int minStepCost = TILE_PATH_MAX_STEP_COST;
+	for (uint8_t stepCost : m_stepCosts) {
+		if ((stepCost != 0) && (stepCost < minStepCost)) {
+			minStepCost = stepCost;
+		}
+	}
+	m_minStepCost = minStepCost;
+}
+
+//----------------------------------------------------------------------------------------------------------------------------------------
+// TilePathfinder
+TilePathfinder::TilePathfinder(TilePathGrid const& grid) :
+	m_grid(grid)
+{
+}
+
+void TilePathfinder::BeginSearch(IntVec2 const& minCoords, IntVec2 const& maxCoords)
+{
+	IntVec2 dimensions = m_grid.GetDimensions();
+	m_searchMin = IntVec2((std::max)(minCoords.x, 0), (std::max)(minCoords.y, 0));
+	m_searchMax = IntVec2((std::min)(maxCoords.x, dimensions.x - 1), (std::min)(maxCoords.y, dimensions.y - 1));
+	m_searchWidth = (std::max)(m_searchMax.x - m_searchMin.x + 1, 0);
+	m_searchHeight = (std::max)(m_searchMax.y - m_searchMin.y + 1, 0);
+
+	size_t searchArea = (size_t)m_searchWidth * (size_t)m_searchHeight;
+	if (m_visitedStamps.size() < searchArea) {
+		m_visitedStamps.resize(searchArea, 0);
+		m_closedStamps.resize(searchArea, 0);
+		m_costsSoFar.resize(searchArea);
+		m_parentDirections.resize(searchArea);
+	}
+
+	m_searchStamp++;
+	if (m_searchStamp == 0) {
+		// Wrapped around, stale stamps could match again
+		std::fill(m_visitedStamps.begin(), m_visitedStamps.end(), 0);
+		std::fill(m_closedStamps.begin(), m_closedStamps.end(), 0);
+		m_searchStamp = 1;
+	}
+}
+
+bool TilePathfinder::IsInSearchBounds(IntVec2 const& coords) const
+{
+	return (coords.x >= m_searchMin.x) && (coords.y >= m_searchMin.y) && (coords.x <= m_searchMax.x) && (coords.y <= m_searchMax.y);
+}
+
+int TilePathfinder::GetSearchNeighbors(int localIndex, int& outTileIndex, SearchNeighbor* outNeighbors) const
+{
+	// Works on indexes only, the inner loops of every search run through here
+	int localX = localIndex % m_searchWidth;
+	int localY = localIndex / m_searchWidth;
+	int gridWidth = m_grid.GetDimensions().x;
+	outTileIndex = ((localY + m_searchMin.y) * gridWidth) + localX + m_searchMin.x;
+
+	int neighborCount = 0;
+	auto addNeighbor = [&](bool isInBounds, int localOffset, int tileOffset, int direction) {
+		if (!isInBounds) return;
+		outNeighbors[neighborCount++] = SearchNeighbor{ localIndex + localOffset, outTileIndex + tileOffset, (uint8_t)direction };
+	};
+	addNeighbor(localX + 1 < m_searchWidth, 1, 1, 0);
+	addNeighbor(localX > 0, -1, -1, 1);
+	addNeighbor(localY + 1 < m_searchHeight, m_searchWidth, gridWidth, 2);
+	addNeighbor(localY > 0, -m_searchWidth, -gridWidth, 3);
+	return neighborCount;
+}
+
+void TilePathfinder::FillDistanceField(std::vector<IntVec2> const& goals, TileHeatMap& outDistances)
+{
+	FillDistanceField(goals.data(), (int)goals.size(), outDistances);
+}
+
+void TilePathfinder::FillDistanceField(IntVec2 const* goals, int goalCount, TileHeatMap& outDistances)
+{
+	IntVec2 dimensions = m_grid.GetDimensions();
+	BeginSearch(IntVec2(0, 0), dimensions - IntVec2(1, 1));
+
+	for (int goalIndex = 0; goalIndex < goalCount; goalIndex++) {
+		if (!m_grid.IsWalkable(goals[goalIndex])) continue;
+
+		int localIndex = GetLocalIndex(goals[goalIndex]);
+		if (IsVisited(localIndex)) continue;
+
+		m_visitedStamps[localIndex] = m_searchStamp;
+		m_costsSoFar[localIndex] = 0;
+		m_buckets[0].push_back(localIndex);
+	}
+
+	RunBucketDijkstra(true);
+
+	// Searching the whole grid makes local indexes tile indexes
+	if (outDistances.GetDimensions() != dimensions) {
+		outDistances.SetDimensions(dimensions);
+	}
+
+	float* distances = outDistances.GetValues();
+	for (int tileIndex = 0; tileIndex < m_grid.GetTileCount(); tileIndex++) {
+		distances[tileIndex] = IsVisited(tileIndex) ? (float)m_costsSoFar[tileIndex] : TILE_PATH_UNREACHABLE_DISTANCE;
+	}
+}
+
+void TilePathfinder::SearchCostsInBounds(IntVec2 const& source, IntVec2 const& minCoords, IntVec2 const& maxCoords, bool towardSource)
+{
+	BeginSearch(minCoords, maxCoords);
+	if (!IsInSearchBounds(source)) return;
+	if (towardSource && !m_grid.IsWalkable(source)) return;
+
+	int localIndex = GetLocalIndex(source);
+	m_visitedStamps[localIndex] = m_searchStamp;
+	m_costsSoFar[localIndex] = 0;
+	m_buckets[0].push_back(localIndex);
+
+	RunBucketDijkstra(towardSource);
+}
+
+int TilePathfinder::GetSearchedCost(IntVec2 const& coords) const
+{
+	if (!IsInSearchBounds(coords)) return -1;
+
+	int localIndex = GetLocalIndex(coords);
+	return IsVisited(localIndex) ? (int)m_costsSoFar[localIndex] : -1;
+}
+
+void TilePathfinder::RunBucketDijkstra(bool towardSources)
+{
+	// Dial's algorithm: every step costs at most TILE_PATH_MAX_STEP_COST, so the open costs never span more buckets than there are
+	// and a tile pushed while bucket c is being drained always lands in another bucket
+	int pendingCount = (int)m_buckets[0].size();
+	uint32_t currentCost = 0;
+
+	while (pendingCount > 0) {
+		std::vector<int>& bucket = m_buckets[currentCost % TILE_PATH_BUCKET_COUNT];
+
+		for (size_t bucketIndex = 0; bucketIndex < bucket.size(); bucketIndex++) {
+			int localIndex = bucket[bucketIndex];
+			pendingCount--;
+			if (m_costsSoFar[localIndex] != currentCost) continue; // Reached again for less after it was queued
+
+			int tileIndex = 0;
+			SearchNeighbor neighbors[TILE_PATH_DIRECTION_COUNT];
+			int neighborCount = GetSearchNeighbors(localIndex, tileIndex, neighbors);
+			int currentStepCost = m_grid.GetStepCost(tileIndex);
+
+			for (int neighborIndexInList = 0; neighborIndexInList < neighborCount; neighborIndexInList++) {
+				SearchNeighbor const& neighbor = neighbors[neighborIndexInList];
+				int neighborStepCost = m_grid.GetStepCost(neighbor.m_tileIndex);
+				if (neighborStepCost == 0) continue;
+
+				// Toward the sources the walk goes from the neighbour into this tile, so this tile's cost is paid
+				uint32_t neighborCost = currentCost + (uint32_t)(towardSources ? currentStepCost : neighborStepCost);
+				int neighborIndex = neighbor.m_localIndex;
+				if (IsVisited(neighborIndex) && (m_costsSoFar[neighborIndex] <= neighborCost)) continue;
+
+				m_visitedStamps[neighborIndex] = m_searchStamp;
+				m_costsSoFar[neighborIndex] = neighborCost;
+				m_parentDirections[neighborIndex] = neighbor.m_direction;
+				m_buckets[neighborCost % TILE_PATH_BUCKET_COUNT].push_back(neighborIndex);
+				pendingCount++;
+			}
+		}
+
+		bucket.clear();
+		currentCost++;
+	}
+}
+
+bool TilePathfinder::FindPath(IntVec2 const& start, IntVec2 const& goal, std::vector<IntVec2>& outPath, int* outPathCost)
+{
+	return FindPathInBounds(start, goal, IntVec2(0, 0), m_grid.GetDimensions() - IntVec2(1, 1), outPath, outPathCost);
+}
+
+bool TilePathfinder::FindPathInBounds(IntVec2 const& start, IntVec2 const& goal, IntVec2 const& minCoords, IntVec2 const& maxCoords, std::vector<IntVec2>& outPath, int* outPathCost)
+{
+	outPath.clear();
+	BeginSearch(minCoords, maxCoords);
+	if (!IsInSearchBounds(start) || !IsInSearchBounds(goal) || !m_grid.IsWalkable(goal)) return false;
+
+	if (start == goal) {
+		outPath.push_back(start);
+		if (outPathCost) {
+			*outPathCost = 0;
+		}
+		return true;
+	}
+
+	uint32_t minStepCost = (uint32_t)m_grid.GetMinStepCost();
+	auto getHeuristic = [&](IntVec2 const& coords) {
+		return (uint32_t)(abs(goal.x - coords.x) + abs(goal.y - coords.y)) * minStepCost;
+	};
+
+	m_openHeap.clear();
+	int startIndex = GetLocalIndex(start);
+	int goalIndex = GetLocalIndex(goal);
+	m_visitedStamps[startIndex] = m_searchStamp;
+	m_costsSoFar[startIndex] = 0;
+	m_openHeap.push_back(OpenNode{ GetOpenKey(getHeuristic(start), 0), startIndex });
+
+	bool isGoalReached = false;
+	while (!m_openHeap.empty()) {
+		std::pop_heap(m_openHeap.begin(), m_openHeap.end(), IsOpenNodeWorse<OpenNode>);
+		int localIndex = m_openHeap.back().m_localIndex;
+		m_openHeap.pop_back();
+
+		// Nodes are pushed again instead of decreasing their key, older copies are skipped here
+		if (m_closedStamps[localIndex] == m_searchStamp) continue;
+		m_closedStamps[localIndex] = m_searchStamp;
+
+		if (localIndex == goalIndex) {
+			isGoalReached = true;
+			break;
+		}
+
+		int tileIndex = 0;
+		SearchNeighbor neighbors[TILE_PATH_DIRECTION_COUNT];
+		int neighborCount = GetSearchNeighbors(localIndex, tileIndex, neighbors);
+		uint32_t costSoFar = m_costsSoFar[localIndex];
+
+		for (int neighborIndexInList = 0; neighborIndexInList < neighborCount; neighborIndexInList++) {
+			SearchNeighbor const& neighbor = neighbors[neighborIndexInList];
+			int neighborStepCost = m_grid.GetStepCost(neighbor.m_tileIndex);
+			if (neighborStepCost == 0) continue;
+
+			int neighborIndex = neighbor.m_localIndex;
+			if (m_closedStamps[neighborIndex] == m_searchStamp) continue;
+
+			uint32_t neighborCost = costSoFar + (uint32_t)neighborStepCost;
+			if (IsVisited(neighborIndex) && (m_costsSoFar[neighborIndex] <= neighborCost)) continue;
+
+			m_visitedStamps[neighborIndex] = m_searchStamp;
+			m_costsSoFar[neighborIndex] = neighborCost;
+			m_parentDirections[neighborIndex] = neighbor.m_direction;
+			IntVec2 neighborCoords = GetLocalCoords(neighborIndex);
+			m_openHeap.push_back(OpenNode{ GetOpenKey(neighborCost + getHeuristic(neighborCoords), neighborCost), neighborIndex });
+			std::push_heap(m_openHeap.begin(), m_openHeap.end(), IsOpenNodeWorse<OpenNode>);
+		}
+	}
+
+	if (!isGoalReached) return false;
+
+	for (IntVec2 coords = goal; coords != start; coords -= TILE_PATH_STEPS[m_parentDirections[GetLocalIndex(coords)]]) {
+		outPath.push_back(coords);
+	}
+	outPath.push_back(start);
+	std::reverse(outPath.begin(), outPath.end());
+
+	if (outPathCost) {
+		*outPathCost = (int)m_costsSoFar[goalIndex];
+	}
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------------------------
+// TileFlowField
+class TileFlowFieldJob : public Job {
+public:
+	TileFlowFieldJob(TileFlowField* flowField, TilePathGrid const& grid, std::vector<IntVec2> const& goals) :
+		Job(DEFAULT_JOB_ID, true),
+		m_flowField(flowField),
+		m_grid(grid),
+		m_goals(goals)
+	{
+	}
+
+	virtual void Execute() override
+	{
+		m_flowField->ComputeField(m_grid, m_goals, m_flowField->m_pending, false);
+	}
+
+	virtual void OnFinished() override
+	{
+		m_flowField->m_isPendingReady = true;
+		m_flowField->m_isRebuilding = false;
+	}
+
+	virtual void OnCancelled() override
+	{
+		// Never computed, the pending field stays unused but waiting rebuilds and the destructor have to stop waiting
+		m_flowField->m_isRebuilding = false;
+	}
+
+private:
+	TileFlowField* m_flowField = nullptr;
+	TilePathGrid const& m_grid;
+	std::vector<IntVec2> m_goals;
+};
+
+TileFlowField::~TileFlowField()
+{
+	while (m_isRebuilding) {
+		std::this_thread::yield();
+	}
+}
+
+void TileFlowField::ComputeField(TilePathGrid const& grid, std::vector<IntVec2> const& goals, Field& outField, bool useJobSystem)
+{
+	// Rebuilds never overlap, so they share one pathfinder and its scratch arrays
+	if (!m_pathfinder || (&m_pathfinder->GetGrid() != &grid)) {
+		m_pathfinder = std::make_unique<TilePathfinder>(grid);
+	}
+	m_pathfinder->FillDistanceField(goals, outField.m_distances);
+
+	IntVec2 dimensions = grid.GetDimensions();
+	outField.m_directions.resize(grid.GetTileCount());
+	float const* distances = outField.m_distances.GetValues();
+
+	uint8_t* directions = outField.m_directions.data();
+	auto computeRows = [&](int beginRow, int endRow) {
+		for (int tileY = beginRow; tileY < endRow; tileY++) {
+			for (int tileX = 0; tileX < dimensions.x; tileX++) {
+				int tileIndex = (tileY * dimensions.x) + tileX;
+				uint8_t lowestDirection = TILE_FLOW_NO_DIRECTION;
+
+				// The best step is the neighbour with the lowest distance plus the cost of entering it, the distance alone
+				// would walk over expensive tiles. Solid tiles have no distance of their own but still point out of the wall.
+				// Goals (distance 0) stay put
+				if (distances[tileIndex] != 0.0f) {
+					float lowestDistance = TILE_PATH_UNREACHABLE_DISTANCE;
+					auto testNeighbor = [&](bool isInBounds, int neighborTileIndex, uint8_t direction) {
+						if (!isInBounds || (distances[neighborTileIndex] >= TILE_PATH_UNREACHABLE_DISTANCE)) return;
+
+						float neighborDistance = distances[neighborTileIndex] + (float)grid.GetStepCost(neighborTileIndex);
+						if (neighborDistance < lowestDistance) {
+							lowestDistance = neighborDistance;
+							lowestDirection = direction;
+						}
+					};
+					testNeighbor(tileX + 1 < dimensions.x, tileIndex + 1, 0);
+					testNeighbor(tileX > 0, tileIndex - 1, 1);
+					testNeighbor(tileY + 1 < dimensions.y, tileIndex + dimensions.x, 2);
+					testNeighbor(tileY > 0, tileIndex - dimensions.x, 3);
+				}
+
+				directions[tileIndex] = lowestDirection;
+			}
+		}
+	};
+
+	if (useJobSystem && g_theJobSystem) {
+		g_theJobSystem->ParallelFor(dimensions.y, 16, computeRows);
+	}
+	else {
+		computeRows(0, dimensions.y);
+	}
+}
+
+void TileFlowField::Rebuild(TilePathGrid const& grid, std::vector<IntVec2> const& goals)
+{
+	// A synchronous rebuild wins over one still running
+	while (m_isRebuilding) {
+		std::this_thread::yield();
+	}
+	m_isPendingReady = false;
+
+	ComputeField(grid, goals, m_current, true);
+}
+
+bool TileFlowField::RebuildAsync(TilePathGrid const& grid, std::vector<IntVec2> const& goals)
+{
+	if (m_isRebuilding) return false;
+
+	if (!g_theJobSystem) {
+		Rebuild(grid, goals);
+		return true;
+	}
+
+	m_isPendingReady = false;
+	m_isRebuilding = true;
+	g_theJobSystem->QueueJob(new TileFlowFieldJob(this, grid, goals));
+	return true;
+}
+
+bool TileFlowField::Update()
+{
+	if (!m_isPendingReady) return false;
+
+	std::swap(m_current, m_pending);
+	m_isPendingReady = false;
+	return true;
+}
+
+float TileFlowField::GetDistance(IntVec2 const& coords) const
+{
+	if (!m_current.m_distances.IsInBounds(coords)) return TILE_PATH_UNREACHABLE_DISTANCE;
+	return m_current.m_distances.GetValue(coords);
+}
+
+IntVec2 TileFlowField::GetNextCoords(IntVec2 const& coords) const
+{
+	if (!m_current.m_distances.IsInBounds(coords)) return coords;
+
+	uint8_t direction = m_current.m_directions[(coords.y * m_current.m_distances.GetDimensions().x) + coords.x];
+	if (direction == TILE_FLOW_NO_DIRECTION) return coords;
+	return coords + TILE_PATH_STEPS[direction];
+}
+
+Vec2 TileFlowField::GetFlowDirection(IntVec2 const& coords) const
+{
+	IntVec2 step = GetNextCoords(coords) - coords;
+	return Vec2((float)step.x, (float)step.y);
+}
+
+//----------------------------------------------------------------------------------------------------------------------------------------
+// TileHierarchicalPathfinder
+TileHierarchicalPathfinder::TileHierarchicalPathfinder(TilePathGrid const& grid, int clusterSize) :
+	m_grid(grid),
+	m_pathfinder(grid),
+	m_clusterSize((clusterSize > 1) ? clusterSize : 2)
+{
+}
+
+void TileHierarchicalPathfinder::GetClusterBounds(int clusterIndex, IntVec2& outMin, IntVec2& outMax) const
+{
+	IntVec2 dimensions = m_grid.GetDimensions();
+	outMin = IntVec2((clusterIndex % m_clusterCounts.x) * m_clusterSize, (clusterIndex / m_clusterCounts.x) * m_clusterSize);
+	outMax = IntVec2((std::min)(outMin.x + m_clusterSize, dimensions.x) - 1, (std::min)(outMin.y + m_clusterSize, dimensions.y) - 1);
+}
+
+int TileHierarchicalPathfinder::GetOrAddNode(int tileIndex)
+{
+	if (m_tileNodes[tileIndex] < 0) {
+		AbstractNode node;
+		node.m_tileIndex = tileIndex;
+		node.m_clusterIndex = GetClusterIndex(m_grid.GetTileCoords(tileIndex));
+		m_tileNodes[tileIndex] = (int)m_nodes.size();
+		m_nodes.push_back(node);
+	}
+	return m_tileNodes[tileIndex];
+}
+
+void TileHierarchicalPathfinder::AddEntrances(IntVec2 const& firstTile, IntVec2 const& alongBorder, IntVec2 const& acrossBorder, int borderLength)
+{
+	auto addTransition = [&](int borderIndex) {
+		IntVec2 insideCoords = firstTile + (alongBorder * borderIndex);
+		IntVec2 outsideCoords = insideCoords + acrossBorder;
+		int insideTileIndex = m_grid.GetTileIndex(insideCoords);
+		int outsideTileIndex = m_grid.GetTileIndex(outsideCoords);
+		int insideNode = GetOrAddNode(insideTileIndex);
+		int outsideNode = GetOrAddNode(outsideTileIndex);
+
+		// Stepping across the border pays for the tile on the other side. Build() groups the edges per node afterwards
+		m_pendingEdges.push_back(PendingEdge{ insideNode, AbstractEdge{ outsideNode, m_grid.GetStepCost(outsideTileIndex) } });
+		m_pendingEdges.push_back(PendingEdge{ outsideNode, AbstractEdge{ insideNode, m_grid.GetStepCost(insideTileIndex) } });
+	};
+
+	int spanStart = -1;
+	for (int borderIndex = 0; borderIndex <= borderLength; borderIndex++) {
+		bool isOpen = false;
+		if (borderIndex < borderLength) {
+			IntVec2 insideCoords = firstTile + (alongBorder * borderIndex);
+			isOpen = m_grid.IsWalkable(insideCoords) && m_grid.IsWalkable(insideCoords + acrossBorder);
+		}
+
+		if (isOpen && (spanStart < 0)) {
+			spanStart = borderIndex;
+		}
+		else if (!isOpen && (spanStart >= 0)) {
+			int spanLength = borderIndex - spanStart;
+			if (spanLength >= TILE_PATH_LONG_ENTRANCE_LENGTH) {
+				addTransition(spanStart);
+				addTransition(borderIndex - 1);
+			}
+			else {
+				addTransition(spanStart + (spanLength / 2));
+			}
+			spanStart = -1;
+		}
+	}
+}
+
+void TileHierarchicalPathfinder::Build()
+{
+	IntVec2 dimensions = m_grid.GetDimensions();
+	m_clusterCounts = IntVec2((dimensions.x + m_clusterSize - 1) / m_clusterSize, (dimensions.y + m_clusterSize - 1) / m_clusterSize);
+	int clusterCount = m_clusterCounts.x * m_clusterCounts.y;
+
+	m_nodes.clear();
+	m_edges.clear();
+	m_pendingEdges.clear();
+	m_tileNodes.assign(m_grid.GetTileCount(), -1);
+
+	// Entrances along the east and north border of every cluster
+	for (int clusterY = 0; clusterY < m_clusterCounts.y; clusterY++) {
+		for (int clusterX = 0; clusterX < m_clusterCounts.x; clusterX++) {
+			IntVec2 clusterMin(clusterX * m_clusterSize, clusterY * m_clusterSize);
+
+			if (clusterX + 1 < m_clusterCounts.x) {
+				int borderLength = (std::min)(m_clusterSize, dimensions.y - clusterMin.y);
+				AddEntrances(IntVec2(clusterMin.x + m_clusterSize - 1, clusterMin.y), IntVec2(0, 1), IntVec2(1, 0), borderLength);
+			}
+			if (clusterY + 1 < m_clusterCounts.y) {
+				int borderLength = (std::min)(m_clusterSize, dimensions.x - clusterMin.x);
+				AddEntrances(IntVec2(clusterMin.x, clusterMin.y + m_clusterSize - 1), IntVec2(1, 0), IntVec2(0, 1), borderLength);
+			}
+		}
+	}
+
+	int nodeCount = (int)m_nodes.size();
+	m_clusterNodeStarts.assign(clusterCount + 1, 0);
+	for (AbstractNode const& node : m_nodes) {
+		m_clusterNodeStarts[node.m_clusterIndex + 1]++;
+	}
+	for (int clusterIndex = 0; clusterIndex < clusterCount; clusterIndex++) {
+		m_clusterNodeStarts[clusterIndex + 1] += m_clusterNodeStarts[clusterIndex];
+	}
+
+	m_clusterNodes.resize(nodeCount);
+	std::vector<int> clusterCursors(m_clusterNodeStarts.begin(), m_clusterNodeStarts.end() - 1);
+	for (int nodeIndex = 0; nodeIndex < nodeCount; nodeIndex++) {
+		m_clusterNodes[clusterCursors[m_nodes[nodeIndex].m_clusterIndex]++] = nodeIndex;
+	}
+
+	// Costs between the entrances of each cluster, one bounded Dijkstra per entrance. Every worker slot owns a pathfinder
+	// and pulls clusters until none are left
+	std::vector<std::vector<PendingEdge>> clusterEdges(clusterCount);
+	std::atomic<int> nextClusterIndex = 0;
+	int slotCount = (g_theJobSystem) ? g_theJobSystem->GetNumThreads() + 1 : 1;
+
+	auto connectClusters = [&](int beginSlot, int endSlot) {
+		for (int slotIndex = beginSlot; slotIndex < endSlot; slotIndex++) {
+			TilePathfinder pathfinder(m_grid);
+
+			for (int clusterIndex = nextClusterIndex++; clusterIndex < clusterCount; clusterIndex = nextClusterIndex++) {
+				IntVec2 clusterMin;
+				IntVec2 clusterMax;
+				GetClusterBounds(clusterIndex, clusterMin, clusterMax);
+
+				for (int fromIndex = m_clusterNodeStarts[clusterIndex]; fromIndex < m_clusterNodeStarts[clusterIndex + 1]; fromIndex++) {
+					int fromNode = m_clusterNodes[fromIndex];
+					pathfinder.SearchCostsInBounds(m_grid.GetTileCoords(m_nodes[fromNode].m_tileIndex), clusterMin, clusterMax, false);
+
+					for (int toIndex = m_clusterNodeStarts[clusterIndex]; toIndex < m_clusterNodeStarts[clusterIndex + 1]; toIndex++) {
+						int toNode = m_clusterNodes[toIndex];
+						if (toNode == fromNode) continue;
+
+						int cost = pathfinder.GetSearchedCost(m_grid.GetTileCoords(m_nodes[toNode].m_tileIndex));
+						if (cost >= 0) {
+							clusterEdges[clusterIndex].push_back(PendingEdge{ fromNode, AbstractEdge{ toNode, cost } });
+						}
+					}
+				}
+			}
+		}
+	};
+
+	if (g_theJobSystem) {
+		g_theJobSystem->ParallelFor(slotCount, 1, connectClusters);
+	}
+	else {
+		connectClusters(0, slotCount);
+	}
+
+	for (std::vector<PendingEdge> const& edges : clusterEdges) {
+		m_pendingEdges.insert(m_pendingEdges.end(), edges.begin(), edges.end());
+	}
+
+	// Group edges per node
+	for (PendingEdge const& pendingEdge : m_pendingEdges) {
+		m_nodes[pendingEdge.m_fromNode].m_edgeCount++;
+	}
+	int firstEdge = 0;
+	for (AbstractNode& node : m_nodes) {
+		node.m_firstEdge = firstEdge;
+		firstEdge += node.m_edgeCount;
+		node.m_edgeCount = 0;
+	}
+
+	m_edges.resize(m_pendingEdges.size());
+	for (PendingEdge const& pendingEdge : m_pendingEdges) {
+		AbstractNode& node = m_nodes[pendingEdge.m_fromNode];
+		m_edges[node.m_firstEdge + node.m_edgeCount++] = pendingEdge.m_edge;
+	}
+	m_pendingEdges.clear();
+
+	// Two extra slots for the start and goal of a query
+	m_queryStamp = 0;
+	m_nodeStamps.assign(nodeCount + 2, 0);
+	m_nodeClosedStamps.assign(nodeCount + 2, 0);
+	m_nodeCosts.resize(nodeCount + 2);
+	m_nodeParents.resize(nodeCount + 2);
+	m_goalEdgeStamps.assign(nodeCount, 0);
+	m_goalEdgeCosts.resize(nodeCount);
+}
+
+int TileHierarchicalPathfinder::GetHeuristic(int fromTileIndex, int toTileIndex) const
+{
+	IntVec2 fromCoords = m_grid.GetTileCoords(fromTileIndex);
+	IntVec2 toCoords = m_grid.GetTileCoords(toTileIndex);
+	return (abs(toCoords.x - fromCoords.x) + abs(toCoords.y - fromCoords.y)) * m_grid.GetMinStepCost();
+}
+
+bool TileHierarchicalPathfinder::FindPath(IntVec2 const& start, IntVec2 const& goal, std::vector<IntVec2>& outPath, int* outPathCost)
+{
+	outPath.clear();
+	if (!m_grid.IsInBounds(start) || !m_grid.IsWalkable(goal)) return false;
+
+	if (m_clusterNodeStarts.empty()) {
+		Build();
+	}
+
+	if (start == goal) {
+		outPath.push_back(start);
+		if (outPathCost) {
+			*outPathCost = 0;
+		}
+		return true;
+	}
+
+	m_queryStamp++;
+	if (m_queryStamp == 0) {
+		std::fill(m_nodeStamps.begin(), m_nodeStamps.end(), 0);
+		std::fill(m_nodeClosedStamps.begin(), m_nodeClosedStamps.end(), 0);
+		std::fill(m_goalEdgeStamps.begin(), m_goalEdgeStamps.end(), 0);
+		m_queryStamp = 1;
+	}
+
+	int nodeCount = (int)m_nodes.size();
+	int startNode = nodeCount;
+	int goalNode = nodeCount + 1;
+	int startTileIndex = m_grid.GetTileIndex(start);
+	int goalTileIndex = m_grid.GetTileIndex(goal);
+	int startCluster = GetClusterIndex(start);
+	int goalCluster = GetClusterIndex(goal);
+	IntVec2 clusterMin;
+	IntVec2 clusterMax;
+
+	// Hook the start and goal into the abstract graph through the entrances of their clusters
+	m_startEdges.clear();
+	GetClusterBounds(startCluster, clusterMin, clusterMax);
+	m_pathfinder.SearchCostsInBounds(start, clusterMin, clusterMax, false);
+	for (int clusterNodeIndex = m_clusterNodeStarts[startCluster]; clusterNodeIndex < m_clusterNodeStarts[startCluster + 1]; clusterNodeIndex++) {
+		int node = m_clusterNodes[clusterNodeIndex];
+		int cost = m_pathfinder.GetSearchedCost(m_grid.GetTileCoords(m_nodes[node].m_tileIndex));
+		if (cost >= 0) {
+			m_startEdges.push_back(AbstractEdge{ node, cost });
+		}
+	}
+	if (startCluster == goalCluster) {
+		int cost = m_pathfinder.GetSearchedCost(goal);
+		if (cost >= 0) {
+			m_startEdges.push_back(AbstractEdge{ goalNode, cost });
+		}
+	}
+
+	GetClusterBounds(goalCluster, clusterMin, clusterMax);
+	m_pathfinder.SearchCostsInBounds(goal, clusterMin, clusterMax, true);
+	for (int clusterNodeIndex = m_clusterNodeStarts[goalCluster]; clusterNodeIndex < m_clusterNodeStarts[goalCluster + 1]; clusterNodeIndex++) {
+		int node = m_clusterNodes[clusterNodeIndex];
+		int cost = m_pathfinder.GetSearchedCost(m_grid.GetTileCoords(m_nodes[node].m_tileIndex));
+		if (cost >= 0) {
+			m_goalEdgeStamps[node] = m_queryStamp;
+			m_goalEdgeCosts[node] = cost;
+		}
+	}
+
+	// A* over the abstract graph
+	auto getNodeTileIndex = [&](int node) {
+		if (node == startNode) return startTileIndex;
+		if (node == goalNode) return goalTileIndex;
+		return m_nodes[node].m_tileIndex;
+	};
+
+	m_openHeap.clear();
+	m_nodeStamps[startNode] = m_queryStamp;
+	m_nodeCosts[startNode] = 0;
+	m_nodeParents[startNode] = -1;
+	m_openHeap.push_back(AbstractOpenNode{ GetOpenKey(GetHeuristic(startTileIndex, goalTileIndex), 0), startNode });
+
+	auto relaxEdge = [&](int fromNode, int toNode, int edgeCost) {
+		if (m_nodeClosedStamps[toNode] == m_queryStamp) return;
+
+		int cost = m_nodeCosts[fromNode] + edgeCost;
+		if ((m_nodeStamps[toNode] == m_queryStamp) && (m_nodeCosts[toNode] <= cost)) return;
+
+		m_nodeStamps[toNode] = m_queryStamp;
+		m_nodeCosts[toNode] = cost;
+		m_nodeParents[toNode] = fromNode;
+		int estimate = cost + GetHeuristic(getNodeTileIndex(toNode), goalTileIndex);
+		m_openHeap.push_back(AbstractOpenNode{ GetOpenKey((uint32_t)estimate, (uint32_t)cost), toNode });
+		std::push_heap(m_openHeap.begin(), m_openHeap.end(), IsOpenNodeWorse<AbstractOpenNode>);
+	};
+
+	bool isGoalReached = false;
+	while (!m_openHeap.empty()) {
+		std::pop_heap(m_openHeap.begin(), m_openHeap.end(), IsOpenNodeWorse<AbstractOpenNode>);
+		int node = m_openHeap.back().m_node;
+		m_openHeap.pop_back();
+
+		if (m_nodeClosedStamps[node] == m_queryStamp) continue;
+		m_nodeClosedStamps[node] = m_queryStamp;
+
+		if (node == goalNode) {
+			isGoalReached = true;
+			break;
+		}
+
+		if (node == startNode) {
+			for (AbstractEdge const& edge : m_startEdges) {
+				relaxEdge(node, edge.m_toNode, edge.m_cost);
+			}
+			continue;
+		}
+
+		AbstractNode const& abstractNode = m_nodes[node];
+		for (int edgeIndex = abstractNode.m_firstEdge; edgeIndex < abstractNode.m_firstEdge + abstractNode.m_edgeCount; edgeIndex++) {
+			relaxEdge(node, m_edges[edgeIndex].m_toNode, m_edges[edgeIndex].m_cost);
+		}
+		if (m_goalEdgeStamps[node] == m_queryStamp) {
+			relaxEdge(node, goalNode, m_goalEdgeCosts[node]);
+		}
+	}
+
+	if (!isGoalReached) return false;
+
+	m_abstractPath.clear();
+	for (int node = goalNode; node >= 0; node = m_nodeParents[node]) {
+		m_abstractPath.push_back(node);
+	}
+	std::reverse(m_abstractPath.begin(), m_abstractPath.end());
+
+	// Refine: steps between clusters join two adjacent tiles, steps inside a cluster get a search bounded to it
+	outPath.push_back(start);
+	for (int pathIndex = 0; pathIndex + 1 < (int)m_abstractPath.size(); pathIndex++) {
+		IntVec2 fromCoords = m_grid.GetTileCoords(getNodeTileIndex(m_abstractPath[pathIndex]));
+		IntVec2 toCoords = m_grid.GetTileCoords(getNodeTileIndex(m_abstractPath[pathIndex + 1]));
+
+		int clusterIndex = GetClusterIndex(fromCoords);
+		if (clusterIndex != GetClusterIndex(toCoords)) {
+			outPath.push_back(toCoords);
+			continue;
+		}
+
+		GetClusterBounds(clusterIndex, clusterMin, clusterMax);
+		if (!m_pathfinder.FindPathInBounds(fromCoords, toCoords, clusterMin, clusterMax, m_segmentPath)) {
+			outPath.clear();
+			return false;
+		}
+		outPath.insert(outPath.end(), m_segmentPath.begin() + 1, m_segmentPath.end());
+	}
+
+	if (outPathCost) {
+		*outPathCost = m_nodeCosts[goalNode];
+	}
+	return true;
+}
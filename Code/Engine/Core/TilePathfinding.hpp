@@ -0,0 +1,217 @@
+#pragma once
+#include "Engine/Core/HeatMaps.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+constexpr int TILE_PATH_MAX_STEP_COST = 255; // Step costs are whole numbers in [1, 255] so Dijkstra can use a bucket queue
+constexpr float TILE_PATH_SOLID_COST = 10000.0f; // Tile costs at or above this (or negative) can not be entered
+constexpr float TILE_PATH_UNREACHABLE_DISTANCE = ARBITRARILY_LARGE_VALUE;
+constexpr int TILE_PATH_DEFAULT_CLUSTER_SIZE = 32;
+constexpr uint8_t TILE_FLOW_NO_DIRECTION = 0xFF;
+
+/// <summary>
+/// Snapshot of a cost TileHeatMap holding the cost of entering each tile, rounded into [1, TILE_PATH_MAX_STEP_COST].
+/// Movement is 4-connected, same as TileHeatMap's neighbour queries. Read only once built, so any number of
+/// pathfinders on any number of threads can share one. Rebuild it after the map changes
+/// </summary>
+class TilePathGrid {
+public:
+	TilePathGrid() = default;
+	explicit TilePathGrid(TileHeatMap const& tileCosts);
+
+	void Build(TileHeatMap const& tileCosts);
+	void SetTileCost(IntVec2 const& coords, float tileCost);
+
+	IntVec2 GetDimensions() const { return m_dimensions; }
+	int GetTileCount() const { return (int)m_stepCosts.size(); }
+	int GetMinStepCost() const { return m_minStepCost; }
+	bool IsInBounds(IntVec2 const& coords) const { return (coords.x >= 0) && (coords.y >= 0) && (coords.x < m_dimensions.x) && (coords.y < m_dimensions.y); }
+	bool IsWalkable(IntVec2 const& coords) const { return IsInBounds(coords) && (m_stepCosts[GetTileIndex(coords)] != 0); }
+	int GetStepCost(int tileIndex) const { return m_stepCosts[tileIndex]; } // 0 for solid tiles
+	int GetTileIndex(IntVec2 const& coords) const { return (coords.y * m_dimensions.x) + coords.x; }
+	IntVec2 GetTileCoords(int tileIndex) const { return IntVec2(tileIndex % m_dimensions.x, tileIndex / m_dimensions.x); }
+
+private:
+	void RefreshMinStepCost();
+
+private:
+	IntVec2 m_dimensions = IntVec2::ZERO;
+	std::vector<uint8_t> m_stepCosts;
+	int m_minStepCost = 1;
+};
+
+/// <summary>
+/// Searches over a TilePathGrid. Scratch state lives in flat arrays stamped per search, so nothing is cleared or allocated between
+/// searches once the arrays reached the size of the biggest search area. Not thread safe, use one pathfinder per thread.
+/// Searches can be restricted to a rectangle of tiles, which keeps the scratch arrays as small as the rectangle
+/// </summary>
+class TilePathfinder {
+public:
+	explicit TilePathfinder(TilePathGrid const& grid);
+
+	// Dijkstra with a bucket queue toward the closest goal. Each value is the cost of walking from that tile to a goal,
+	// TILE_PATH_UNREACHABLE_DISTANCE when there is no way. Solid goals are ignored. outDistances is resized to the grid
+	void FillDistanceField(IntVec2 const* goals, int goalCount, TileHeatMap& outDistances);
+	void FillDistanceField(std::vector<IntVec2> const& goals, TileHeatMap& outDistances);
+
+	// A* with a binary heap, outPath runs from start to goal inclusive. False (and an empty path) when the goal is unreachable
+	bool FindPath(IntVec2 const& start, IntVec2 const& goal, std::vector<IntVec2>& outPath, int* outPathCost = nullptr);
+	bool FindPathInBounds(IntVec2 const& start, IntVec2 const& goal, IntVec2 const& minCoords, IntVec2 const& maxCoords, std::vector<IntVec2>& outPath, int* outPathCost = nullptr);
+
+	// Dijkstra over the tiles in [minCoords, maxCoords] from (or toward, when towardSource) one tile. Read the results with GetSearchedCost
+	void SearchCostsInBounds(IntVec2 const& source, IntVec2 const& minCoords, IntVec2 const& maxCoords, bool towardSource);
+	int GetSearchedCost(IntVec2 const& coords) const; // -1 if the last search did not reach the tile
+
+	TilePathGrid const& GetGrid() const { return m_grid; }
+
+private:
+	struct SearchNeighbor {
+		int m_localIndex = -1;
+		int m_tileIndex = -1;
+		uint8_t m_direction = 0;
+	};
+
+	void BeginSearch(IntVec2 const& minCoords, IntVec2 const& maxCoords);
+	int GetSearchNeighbors(int localIndex, int& outTileIndex, SearchNeighbor* outNeighbors) const;
+	bool IsInSearchBounds(IntVec2 const& coords) const;
+	int GetLocalIndex(IntVec2 const& coords) const { return ((coords.y - m_searchMin.y) * m_searchWidth) + (coords.x - m_searchMin.x); }
+	IntVec2 GetLocalCoords(int localIndex) const { return IntVec2(m_searchMin.x + (localIndex % m_searchWidth), m_searchMin.y + (localIndex / m_searchWidth)); }
+	bool IsVisited(int localIndex) const { return m_visitedStamps[localIndex] == m_searchStamp; }
+	void RunBucketDijkstra(bool towardSources);
+
+private:
+	struct OpenNode {
+		uint64_t m_key = 0; // Estimated total cost high, inverted cost so far low, so ties go to the node further along
+		int m_localIndex = -1;
+	};
+
+	TilePathGrid const& m_grid;
+
+	IntVec2 m_searchMin = IntVec2::ZERO;
+	IntVec2 m_searchMax = IntVec2::ZERO;
+	int m_searchWidth = 0;
+	int m_searchHeight = 0;
+	uint32_t m_searchStamp = 0;
+
+	std::vector<uint32_t> m_visitedStamps; // Cost and parent of a tile are only valid when its stamp matches the current search
+	std::vector<uint32_t> m_closedStamps;
+	std::vector<uint32_t> m_costsSoFar;
+	std::vector<uint8_t> m_parentDirections;
+	std::vector<OpenNode> m_openHeap;
+	std::vector<int> m_buckets[TILE_PATH_MAX_STEP_COST + 1]; // Circular, a tile at cost c waits in bucket c % size
+};
+
+/// <summary>
+/// Distance field plus the step to take from every tile, shared by any number of units heading to the same goals.
+/// RebuildAsync computes the next field on the JobSystem while units keep reading the current one, Update swaps it in
+/// </summary>
+class TileFlowField {
+public:
+	TileFlowField() = default;
+	~TileFlowField();
+	TileFlowField(TileFlowField const& copyFrom) = delete;
+
+	void Rebuild(TilePathGrid const& grid, std::vector<IntVec2> const& goals);
+	// False if a rebuild is still running. The grid must stay alive and unchanged until Update swapped the result in
+	bool RebuildAsync(TilePathGrid const& grid, std::vector<IntVec2> const& goals);
+	bool Update(); // Call once a frame, returns true when a finished async rebuild was swapped in
+	bool IsRebuilding() const { return m_isRebuilding; }
+
+	TileHeatMap const& GetDistances() const { return m_current.m_distances; }
+	float GetDistance(IntVec2 const& coords) const;
+	IntVec2 GetNextCoords(IntVec2 const& coords) const; // coords itself at a goal or where no neighbour is closer to one
+	Vec2 GetFlowDirection(IntVec2 const& coords) const; // Unit step toward the goal, zero when there is none
+
+private:
+	struct Field {
+		TileHeatMap m_distances = TileHeatMap(IntVec2(0, 0));
+		std::vector<uint8_t> m_directions; // Index into the 4 neighbour steps, TILE_FLOW_NO_DIRECTION when there is none
+	};
+
+	void ComputeField(TilePathGrid const& grid, std::vector<IntVec2> const& goals, Field& outField, bool useJobSystem);
+
+private:
+	std::unique_ptr<TilePathfinder> m_pathfinder;
+	Field m_current;
+	Field m_pending;
+	std::atomic<bool> m_isRebuilding = false;
+	std::atomic<bool> m_isPendingReady = false;
+
+	friend class TileFlowFieldJob;
+};
+
+/// <summary>
+/// HPA*: the map is split into square clusters, entrances along cluster borders become nodes of an abstract graph, and the
+/// costs between entrances of the same cluster are precomputed. A query searches the small abstract graph, then refines each
+/// abstract step with a search bounded to one cluster. Paths are near optimal, within a few percent of A* on open maps.
+/// Build runs the per cluster searches on the JobSystem
+/// </summary>
+class TileHierarchicalPathfinder {
+public:
+	explicit TileHierarchicalPathfinder(TilePathGrid const& grid, int clusterSize = TILE_PATH_DEFAULT_CLUSTER_SIZE);
+
+	void Build();
+	bool FindPath(IntVec2 const& start, IntVec2 const& goal, std::vector<IntVec2>& outPath, int* outPathCost = nullptr);
+
+	int GetAbstractNodeCount() const { return (int)m_nodes.size(); }
+	int GetAbstractEdgeCount() const { return (int)m_edges.size(); }
+
+private:
+	struct AbstractNode {
+		int m_tileIndex = -1;
+		int m_clusterIndex = -1;
+		int m_firstEdge = 0;
+		int m_edgeCount = 0;
+	};
+
+	struct AbstractEdge {
+		int m_toNode = -1;
+		int m_cost = 0;
+	};
+
+	struct PendingEdge {
+		int m_fromNode = -1;
+		AbstractEdge m_edge;
+	};
+
+	struct AbstractOpenNode {
+		uint64_t m_key = 0;
+		int m_node = -1;
+	};
+
+	int GetClusterIndex(IntVec2 const& coords) const { return ((coords.y / m_clusterSize) * m_clusterCounts.x) + (coords.x / m_clusterSize); }
+	void GetClusterBounds(int clusterIndex, IntVec2& outMin, IntVec2& outMax) const;
+	int GetOrAddNode(int tileIndex);
+	void AddEntrances(IntVec2 const& firstTile, IntVec2 const& alongBorder, IntVec2 const& acrossBorder, int borderLength);
+	int GetHeuristic(int fromTileIndex, int toTileIndex) const;
+
+private:
+	TilePathGrid const& m_grid;
+	TilePathfinder m_pathfinder;
+	int m_clusterSize = TILE_PATH_DEFAULT_CLUSTER_SIZE;
+	IntVec2 m_clusterCounts = IntVec2::ZERO;
+
+	std::vector<AbstractNode> m_nodes;
+	std::vector<AbstractEdge> m_edges; // Grouped per node, node n owns [m_firstEdge, m_firstEdge + m_edgeCount)
+	std::vector<PendingEdge> m_pendingEdges;
+	std::vector<int> m_clusterNodeStarts; // Cluster c owns m_clusterNodes[m_clusterNodeStarts[c], m_clusterNodeStarts[c + 1])
+	std::vector<int> m_clusterNodes;
+	std::vector<int> m_tileNodes; // Tile index to abstract node, -1 for tiles that are no entrance
+
+	// Query scratch, stamped per query like TilePathfinder's
+	uint32_t m_queryStamp = 0;
+	std::vector<uint32_t> m_nodeStamps;
+	std::vector<uint32_t> m_nodeClosedStamps;
+	std::vector<int> m_nodeCosts;
+	std::vector<int> m_nodeParents;
+	std::vector<uint32_t> m_goalEdgeStamps;
+	std::vector<int> m_goalEdgeCosts;
+	std::vector<AbstractEdge> m_startEdges;
+	std::vector<AbstractOpenNode> m_openHeap;
+	std::vector<int> m_abstractPath;
+	std::vector<IntVec2> m_segmentPath;
+};
@@ -0,0 +1,693 @@
+#include "Engine/Core/VirtualFileSystem.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <unordered_set>
+
+VirtualFileSystem* g_theVFS = nullptr;
+
+namespace {
+	constexpr int LZ_MIN_MATCH = 4;
+	constexpr int LZ_HASH_BITS = 14;
+	constexpr size_t LZ_MAX_OFFSET = 0xFFFF;
+
+	uint32_t ReadUint32Unaligned(uint8_t const* source)
+	{
+		uint32_t value = 0;
+		memcpy(&value, source, sizeof(uint32_t));
+		return value;
+	}
+
+	void WriteLZLength(std::vector<uint8_t>& out, size_t length)
+	{
+		while (length >= 255) {
+			out.push_back(255);
+			length -= 255;
+		}
+		out.push_back((uint8_t)length);
+	}
+
+	void WriteLZSequence(std::vector<uint8_t>& out, uint8_t const* literals, size_t literalCount, size_t matchOffset, size_t matchLength)
+	{
+		size_t matchCode = (matchLength > 0) ? matchLength - LZ_MIN_MATCH : 0;
+		uint8_t token = (uint8_t)(((literalCount >= 15) ? 15 : literalCount) << 4);
+		token |= (uint8_t)((matchCode >= 15) ? 15 : matchCode);
+		out.push_back(token);
+
+		if (literalCount >= 15) WriteLZLength(out, literalCount - 15);
+		out.insert(out.end(), literals, literals + literalCount);
+
+		if (matchLength == 0) return;
+
+		out.push_back((uint8_t)(matchOffset & 0xFF));
+		out.push_back((uint8_t)((matchOffset >> 8) & 0xFF));
+		if (matchCode >= 15) WriteLZLength(out, matchCode - 15);
+	}
+
+	bool ReadLZLength(uint8_t const*& readPtr, uint8_t const* readEnd, size_t& length)
+	{
+		uint8_t extraByte = 255;
+		while (extraByte == 255) {
+			if (readPtr >= readEnd) return false;
+			extraByte = *readPtr++;
+			length += extraByte;
+		}
+		return true;
+	}
+
+	void AppendToBuffer(std::vector<uint8_t>& buffer, void const* data, size_t size)
+	{
+		uint8_t const* dataAsBytes = reinterpret_cast<uint8_t const*>(data);
+		buffer.insert(buffer.end(), dataAsBytes, dataAsBytes + size);
+	}
+
+	bool GetPathRelativeToMount(std::string const& normalizedPath, std::string const& mountPath, std::string& outRelativePath)
+	{
+		if (normalizedPath.compare(0, mountPath.size(), mountPath) != 0) return false;
+
+		// "data" must not match "database/file.png"
+		size_t relativeStart = mountPath.size();
+		if (!mountPath.empty() && (relativeStart < normalizedPath.size())) {
+			if (normalizedPath[relativeStart] != '/') return false;
+			relativeStart++;
+		}
+
+		outRelativePath = normalizedPath.substr(relativeStart);
+		return true;
+	}
+
+	size_t AlignUp(size_t value, size_t alignment)
+	{
+		if (alignment <= 1) return value;
+		return ((value + alignment - 1) / alignment) * alignment;
+	}
+}
+
+std::string NormalizeVirtualPath(std::string const& path)
+{
+	std::string normalizedPath;
+	normalizedPath.reserve(path.size());
+
+	size_t startIndex = 0;
+	while ((startIndex + 1 < path.size()) && (path[startIndex] == '.') && ((path[startIndex + 1] == '/') || (path[startIndex + 1] == '\\'))) {
+		startIndex += 2;
+	}
+
+	for (size_t charIndex = startIndex; charIndex < path.size(); charIndex++) {
+		char currentChar = path[charIndex];
+		if (currentChar == '\\') currentChar = '/';
+		if ((currentChar == '/') && !normalizedPath.empty() && (normalizedPath.back() == '/')) continue;
+		normalizedPath.push_back((char)tolower((unsigned char)currentChar));
+	}
+
+	return normalizedPath;
+}
+
+uint64_t HashVirtualPath(std::string const& normalizedPath)
+{
+	// FNV-1a 64
+	uint64_t hash = 14695981039346656037ull;
+	for (char pathChar : normalizedPath) {
+		hash ^= (uint64_t)(unsigned char)pathChar;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+size_t CompressLZ(std::vector<uint8_t>& outCompressed, uint8_t const* source, size_t sourceSize)
+{
+	outCompressed.clear();
+	outCompressed.reserve(sourceSize + (sourceSize / 255) + 16);
+
+	std::vector<int64_t> hashTable((size_t)1 << LZ_HASH_BITS, -1);
+
+	size_t anchor = 0;
+	size_t position = 0;
+
+	while (position + LZ_MIN_MATCH <= sourceSize) {
+		uint32_t sequence = ReadUint32Unaligned(source + position);
+		uint32_t hashIndex = (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+		int64_t candidate = hashTable[hashIndex];
+		hashTable[hashIndex] = (int64_t)position;
+
+		bool isMatch = (candidate >= 0) && ((position - (size_t)candidate) <= LZ_MAX_OFFSET) && (ReadUint32Unaligned(source + candidate) == sequence);
+		if (!isMatch) {
+			position++;
+			continue;
+		}
+
+		size_t matchLength = LZ_MIN_MATCH;
+		while ((position + matchLength < sourceSize) && (source[candidate + matchLength] == source[position + matchLength])) {
+			matchLength++;
+		}
+
+		WriteLZSequence(outCompressed, source + anchor, position - anchor, position - (size_t)candidate, matchLength);
+		position += matchLength;
+		anchor = position;
+	}
+
+	// Last sequence is literals only, the decoder knows it is done when it runs out of input
+	WriteLZSequence(outCompressed, source + anchor, sourceSize - anchor, 0, 0);
+
+	return outCompressed.size();
+}
+
+bool DecompressLZ(uint8_t* destination, size_t destinationSize, uint8_t const* compressed, size_t compressedSize)
+{
+	uint8_t const* readPtr = compressed;
+	uint8_t const* readEnd = compressed + compressedSize;
+	uint8_t* writePtr = destination;
+	uint8_t* writeEnd = destination + destinationSize;
+
+	while (readPtr < readEnd) {
+		uint8_t token = *readPtr++;
+
+		size_t literalCount = token >> 4;
+		if ((literalCount == 15) && !ReadLZLength(readPtr, readEnd, literalCount)) return false;
+		if ((size_t)(readEnd - readPtr) < literalCount || (size_t)(writeEnd - writePtr) < literalCount) return false;
+
+		memcpy(writePtr, readPtr, literalCount);
+		readPtr += literalCount;
+		writePtr += literalCount;
+
+		if (readPtr == readEnd) break;
+
+		if (readEnd - readPtr < 2) return false;
+		size_t matchOffset = (size_t)readPtr[0] | ((size_t)readPtr[1] << 8);
+		readPtr += 2;
+
+		size_t matchLength = token & 0x0F;
+		if ((matchLength == 15) && !ReadLZLength(readPtr, readEnd, matchLength)) return false;
+		matchLength += LZ_MIN_MATCH;
+
+		if ((matchOffset == 0) || (matchOffset > (size_t)(writePtr - destination)) || ((size_t)(writeEnd - writePtr) < matchLength)) return false;
+
+		// Byte by byte, matches are allowed to overlap what they are writing
+		uint8_t const* matchPtr = writePtr - matchOffset;
+		for (size_t byteIndex = 0; byteIndex < matchLength; byteIndex++) {
+			writePtr[byteIndex] = matchPtr[byteIndex];
+		}
+		writePtr += matchLength;
+	}
+
+	return writePtr == writeEnd;
+}
+
+bool VirtualFileArchive::Open(std::string const& archivePath)
+{
+	if (!m_archiveFile.Open(archivePath)) {
+		ERROR_RECOVERABLE(Stringf("VFS COULD NOT OPEN ARCHIVE: %s", archivePath.c_str()));
+		return false;
+	}
+
+	if (m_archiveFile.GetSize() < sizeof(VirtualArchiveHeader)) {
+		ERROR_RECOVERABLE(Stringf("VFS ARCHIVE IS TOO SMALL: %s", archivePath.c_str()));
+		m_archiveFile.Close();
+		return false;
+	}
+
+	VirtualArchiveHeader header;
+	memcpy(&header, m_archiveFile.GetData(), sizeof(VirtualArchiveHeader));
+
+	if ((header.m_magic != VIRTUAL_ARCHIVE_MAGIC) || (header.m_version != VIRTUAL_ARCHIVE_VERSION)) {
+		ERROR_RECOVERABLE(Stringf("VFS ARCHIVE HAS AN UNKNOWN FORMAT: %s", archivePath.c_str()));
+		m_archiveFile.Close();
+		return false;
+	}
+
+	// Everything below is checked once here, so lookups and reads can trust the tables. Sizes are compared before adding
+	// offsets so a corrupt value cannot wrap around
+	size_t archiveSize = m_archiveFile.GetSize();
+	bool isEntryTableValid = (header.m_entryTableOffset <= archiveSize) && ((header.m_entryTableOffset % alignof(VirtualArchiveEntry)) == 0) &&
+		((size_t)header.m_entryCount <= (archiveSize - header.m_entryTableOffset) / sizeof(VirtualArchiveEntry));
+	size_t entryTableEnd = (isEntryTableValid) ? header.m_entryTableOffset + (size_t)header.m_entryCount * sizeof(VirtualArchiveEntry) : 0;
+	if (!isEntryTableValid || (header.m_nameTableOffset < entryTableEnd) || (header.m_nameTableOffset > archiveSize)) {
+		ERROR_RECOVERABLE(Stringf("VFS ARCHIVE IS TRUNCATED: %s", archivePath.c_str()));
+		m_archiveFile.Close();
+		return false;
+	}
+
+	// The writer keeps the entry table 8 byte aligned, and the mapping starts on a page boundary
+	VirtualArchiveEntry const* entries = reinterpret_cast<VirtualArchiveEntry const*>(m_archiveFile.GetData() + header.m_entryTableOffset);
+
+	// The name table has no size of its own, it ends where the first entry data starts
+	size_t nameTableEnd = archiveSize;
+	for (uint32_t entryIndex = 0; entryIndex < header.m_entryCount; entryIndex++) {
+		VirtualArchiveEntry const& entry = entries[entryIndex];
+		bool isDataValid = (entry.m_dataOffset >= header.m_nameTableOffset) && (entry.m_dataOffset <= archiveSize) && (entry.m_storedSize <= archiveSize - entry.m_dataOffset);
+		if (!isDataValid) {
+			ERROR_RECOVERABLE(Stringf("VFS ARCHIVE ENTRY %u IS OUT OF ARCHIVE BOUNDS: %s", entryIndex, archivePath.c_str()));
+			m_archiveFile.Close();
+			return false;
+		}
+		nameTableEnd = (std::min)(nameTableEnd, (size_t)entry.m_dataOffset);
+	}
+
+	size_t nameTableSize = nameTableEnd - header.m_nameTableOffset;
+	for (uint32_t entryIndex = 0; entryIndex < header.m_entryCount; entryIndex++) {
+		VirtualArchiveEntry const& entry = entries[entryIndex];
+		if ((entry.m_nameOffset > nameTableSize) || (entry.m_nameLength > nameTableSize - entry.m_nameOffset)) {
+			ERROR_RECOVERABLE(Stringf("VFS ARCHIVE ENTRY %u HAS A NAME OUTSIDE THE NAME TABLE: %s", entryIndex, archivePath.c_str()));
+			m_archiveFile.Close();
+			return false;
+		}
+	}
+
+	m_entries = entries;
+	m_nameTable = reinterpret_cast<char const*>(m_archiveFile.GetData() + header.m_nameTableOffset);
+	m_entryCount = header.m_entryCount;
+
+	return true;
+}
+
+VirtualArchiveEntry const* VirtualFileArchive::FindEntry(std::string const& normalizedPath, uint64_t pathHash) const
+{
+	VirtualArchiveEntry const* entriesEnd = m_entries + m_entryCount;
+	VirtualArchiveEntry const* foundEntry = std::lower_bound(m_entries, entriesEnd, pathHash, [](VirtualArchiveEntry const& entry, uint64_t hash) {
+		return entry.m_pathHash < hash;
+		});
+
+	for (; (foundEntry != entriesEnd) && (foundEntry->m_pathHash == pathHash); foundEntry++) {
+		if (GetEntryName(*foundEntry) == normalizedPath) return foundEntry;
+	}
+
+	return nullptr;
+}
+
+bool VirtualFileArchive::ReadEntry(VirtualFile& outFile, VirtualArchiveEntry const& entry) const
+{
+	// Entry bounds were checked when the archive was opened
+	uint8_t const* storedData = m_archiveFile.GetData() + entry.m_dataOffset;
+
+	switch (entry.m_compression)
+	{
+	case VirtualFileCompression::NONE:
+		outFile.m_span = ByteSpan{ storedData, entry.m_storedSize };
+		break;
+	case VirtualFileCompression::LZ:
+		outFile.m_decompressedData.resize(entry.m_originalSize);
+		if (!DecompressLZ(outFile.m_decompressedData.data(), entry.m_originalSize, storedData, entry.m_storedSize)) {
+			ERROR_RECOVERABLE(Stringf("VFS ENTRY IS CORRUPTED: %s", std::string(GetEntryName(entry)).c_str()));
+			outFile.m_decompressedData.clear();
+			return false;
+		}
+		outFile.m_span = ByteSpan{ outFile.m_decompressedData.data(), outFile.m_decompressedData.size() };
+		break;
+	default:
+		ERROR_RECOVERABLE("VFS ENTRY USES AN UNKNOWN COMPRESSION");
+		return false;
+	}
+
+	outFile.m_isValid = true;
+	outFile.m_isFromArchive = true;
+	return true;
+}
+
+std::string_view VirtualFileArchive::GetEntryName(VirtualArchiveEntry const& entry) const
+{
+	// Name ranges were checked against the name table when the archive was opened
+	return std::string_view(m_nameTable + entry.m_nameOffset, entry.m_nameLength);
+}
+
+VirtualFileSystem::VirtualFileSystem(VirtualFileSystemConfig const& config) :
+	m_config(config)
+{
+}
+
+VirtualFileSystem::~VirtualFileSystem()
+{
+	UnmountAll();
+}
+
+void VirtualFileSystem::Startup()
+{
+	SubscribeEventCallbackFunction("VFSBuildArchive", this, &VirtualFileSystem::Event_BuildArchive);
+	SubscribeEventCallbackFunction("VFSListMounts", this, &VirtualFileSystem::Event_ListMounts);
+}
+
+void VirtualFileSystem::Shutdown()
+{
+	UnsubscribeAllEventCallbackFunctions(this);
+	UnmountAll();
+}
+
+bool VirtualFileSystem::MountDirectory(std::string const& mountPath, std::string const& physicalDirectory)
+{
+	if (!std::filesystem::is_directory(physicalDirectory)) {
+		ERROR_RECOVERABLE(Stringf("VFS COULD NOT MOUNT DIRECTORY %s", physicalDirectory.c_str()));
+		return false;
+	}
+
+	VirtualMountPoint newMount;
+	newMount.m_mountPath = NormalizeVirtualPath(mountPath);
+	while (!newMount.m_mountPath.empty() && (newMount.m_mountPath.back() == '/')) newMount.m_mountPath.pop_back();
+	newMount.m_physicalDirectory = physicalDirectory;
+	m_mountPoints.push_back(newMount);
+
+	return true;
+}
+
+bool VirtualFileSystem::MountArchive(std::string const& mountPath, std::string const& archivePath)
+{
+	VirtualFileArchive* archive = new VirtualFileArchive();
+	if (!archive->Open(archivePath)) {
+		delete archive;
+		return false;
+	}
+
+	VirtualMountPoint newMount;
+	newMount.m_mountPath = NormalizeVirtualPath(mountPath);
+	while (!newMount.m_mountPath.empty() && (newMount.m_mountPath.back() == '/')) newMount.m_mountPath.pop_back();
+	newMount.m_physicalDirectory = archivePath;
+	newMount.m_archive = archive;
+	m_mountPoints.push_back(newMount);
+
+	return true;
+}
+
+void VirtualFileSystem::UnmountAll()
+{
+	for (VirtualMountPoint& mountPoint : m_mountPoints) {
+		delete mountPoint.m_archive;
+		mountPoint.m_archive = nullptr;
+	}
+	m_mountPoints.clear();
+}
+
+bool VirtualFileSystem::OpenFile(VirtualFile& outFile, std::string const& virtualPath) const
+{
+	std::string normalizedPath = NormalizeVirtualPath(virtualPath);
+
+	std::string physicalPath;
+	if (FindLooseFile(physicalPath, normalizedPath, virtualPath)) {
+		return OpenPhysicalFile(outFile, physicalPath);
+	}
+
+	VirtualFileArchive const* archive = nullptr;
+	VirtualArchiveEntry const* entry = FindArchiveEntry(archive, normalizedPath);
+	if (entry) {
+		return archive->ReadEntry(outFile, *entry);
+	}
+
+	ERROR_RECOVERABLE(Stringf("VFS COULD NOT FIND FILE %s", virtualPath.c_str()));
+	return false;
+}
+
+bool VirtualFileSystem::DoesFileExist(std::string const& virtualPath) const
+{
+	std::string normalizedPath = NormalizeVirtualPath(virtualPath);
+
+	std::string physicalPath;
+	if (FindLooseFile(physicalPath, normalizedPath, virtualPath)) return true;
+
+	VirtualFileArchive const* archive = nullptr;
+	return FindArchiveEntry(archive, normalizedPath) != nullptr;
+}
+
+void VirtualFileSystem::ListFiles(Strings& outVirtualPaths, std::string const& virtualDirectory) const
+{
+	outVirtualPaths.clear();
+
+	std::string normalizedDirectory = NormalizeVirtualPath(virtualDirectory);
+	while (!normalizedDirectory.empty() && (normalizedDirectory.back() == '/')) normalizedDirectory.pop_back();
+
+	std::string directoryPrefix = virtualDirectory;
+	if (!directoryPrefix.empty() && (directoryPrefix.back() != '/') && (directoryPrefix.back() != '\\')) directoryPrefix += "/";
+
+	// Same priority as OpenFile, a name already listed is shadowed
+	std::unordered_set<std::string> listedPaths;
+	auto addFile = [&](std::string const& fileName) {
+		std::string virtualPath = directoryPrefix + fileName;
+		if (listedPaths.insert(NormalizeVirtualPath(virtualPath)).second) {
+			outVirtualPaths.push_back(virtualPath);
+		}
+	};
+
+	auto addPhysicalDirectory = [&](std::filesystem::path const& physicalDirectory) {
+		std::error_code directoryError;
+		if (!std::filesystem::is_directory(physicalDirectory, directoryError)) return;
+		for (auto const& dirEntry : std::filesystem::directory_iterator(physicalDirectory, directoryError)) {
+			if (dirEntry.is_regular_file()) addFile(dirEntry.path().filename().string());
+		}
+	};
+
+	std::string relativeDirectory;
+	if (m_config.m_allowLooseFileOverrides) {
+		for (int mountIndex = (int)m_mountPoints.size() - 1; mountIndex >= 0; mountIndex--) {
+			VirtualMountPoint const& mountPoint = m_mountPoints[mountIndex];
+			if (mountPoint.m_archive || !GetPathRelativeToMount(normalizedDirectory, mountPoint.m_mountPath, relativeDirectory)) continue;
+
+			std::filesystem::path physicalDirectory = mountPoint.m_physicalDirectory;
+			physicalDirectory /= relativeDirectory;
+			addPhysicalDirectory(physicalDirectory);
+		}
+		addPhysicalDirectory(virtualDirectory);
+	}
+
+	for (int mountIndex = (int)m_mountPoints.size() - 1; mountIndex >= 0; mountIndex--) {
+		VirtualMountPoint const& mountPoint = m_mountPoints[mountIndex];
+		if (!mountPoint.m_archive || !GetPathRelativeToMount(normalizedDirectory, mountPoint.m_mountPath, relativeDirectory)) continue;
+
+		std::string entryPrefix = (relativeDirectory.empty()) ? "" : relativeDirectory + "/";
+		VirtualFileArchive const* archive = mountPoint.m_archive;
+		for (int entryIndex = 0; entryIndex < archive->GetEntryCount(); entryIndex++) {
+			std::string_view entryName = archive->GetEntryName(archive->GetEntry(entryIndex));
+			if (entryName.compare(0, entryPrefix.size(), entryPrefix) != 0) continue;
+
+			std::string_view fileName = entryName.substr(entryPrefix.size());
+			if (fileName.empty() || (fileName.find('/') != std::string_view::npos)) continue;
+			addFile(std::string(fileName));
+		}
+	}
+}
+
+bool VirtualFileSystem::FindLooseFile(std::string& outPhysicalPath, std::string const& normalizedPath, std::string const& virtualPath) const
+{
+	if (!m_config.m_allowLooseFileOverrides) return false;
+
+	// Loose files win over every archive whatever the mount order, then the path is tried as is on disk
+	std::string relativePath;
+	for (int mountIndex = (int)m_mountPoints.size() - 1; mountIndex >= 0; mountIndex--) {
+		VirtualMountPoint const& mountPoint = m_mountPoints[mountIndex];
+		if (mountPoint.m_archive || !GetPathRelativeToMount(normalizedPath, mountPoint.m_mountPath, relativePath)) continue;
+
+		std::filesystem::path physicalPath = mountPoint.m_physicalDirectory;
+		physicalPath /= relativePath;
+		if (FileExists(physicalPath.string())) {
+			outPhysicalPath = physicalPath.string();
+			return true;
+		}
+	}
+
+	if (FileExists(virtualPath)) {
+		outPhysicalPath = virtualPath;
+		return true;
+	}
+	return false;
+}
+
+VirtualArchiveEntry const* VirtualFileSystem::FindArchiveEntry(VirtualFileArchive const*& outArchive, std::string const& normalizedPath) const
+{
+	std::string relativePath;
+	for (int mountIndex = (int)m_mountPoints.size() - 1; mountIndex >= 0; mountIndex--) {
+		VirtualMountPoint const& mountPoint = m_mountPoints[mountIndex];
+		if (!mountPoint.m_archive || !GetPathRelativeToMount(normalizedPath, mountPoint.m_mountPath, relativePath)) continue;
+
+		// Entries are stored relative to the archive root
+		VirtualArchiveEntry const* entry = mountPoint.m_archive->FindEntry(relativePath, HashVirtualPath(relativePath));
+		if (entry) {
+			outArchive = mountPoint.m_archive;
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+int VirtualFileSystem::ReadFileToBuffer(std::vector<uint8_t>& outBuffer, std::string const& virtualPath) const
+{
+	VirtualFile file;
+	if (!OpenFile(file, virtualPath)) return -1;
+
+	outBuffer.assign(file.GetSpan().begin(), file.GetSpan().end());
+	return 0;
+}
+
+int VirtualFileSystem::ReadFileToString(std::string& outString, std::string const& virtualPath) const
+{
+	VirtualFile file;
+	if (!OpenFile(file, virtualPath)) return -1;
+
+	outString.assign(file.GetStringView());
+	return 0;
+}
+
+bool VirtualFileSystem::OpenPhysicalFile(VirtualFile& outFile, std::string const& physicalPath)
+{
+	if (!outFile.m_looseFile.Open(physicalPath)) return false;
+
+	outFile.m_span = outFile.m_looseFile.GetSpan();
+	outFile.m_isValid = true;
+	outFile.m_isFromArchive = false;
+	return true;
+}
+
+bool VirtualFileSystem::Event_BuildArchive(EventArgs& args)
+{
+	std::string sourceDirectory = args.GetValue("source", "");
+	std::string archivePath = args.GetValue("archive", "");
+
+	if (sourceDirectory.empty() || archivePath.empty()) {
+		g_theConsole->AddLine(DevConsole::WARNING_COLOR, "Usage: VFSBuildArchive source=<directory> archive=<file.vpak> [compress=true] [prefix=<path>]");
+		return false;
+	}
+
+	VirtualArchiveWriteOptions writeOptions;
+	writeOptions.m_compress = args.GetValue("compress", writeOptions.m_compress);
+	writeOptions.m_pathPrefix = args.GetValue("prefix", writeOptions.m_pathPrefix);
+
+	bool wasWritten = WriteVirtualFileArchive(archivePath, sourceDirectory, writeOptions);
+	Rgba8 const& lineColor = (wasWritten) ? DevConsole::INFO_MAJOR_COLOR : DevConsole::ERROR_COLOR;
+	g_theConsole->AddLine(lineColor, Stringf("VFS archive %s %s", archivePath.c_str(), (wasWritten) ? "written" : "could not be written"));
+
+	return true;
+}
+
+bool VirtualFileSystem::Event_ListMounts(EventArgs& args)
+{
+	UNUSED(args);
+	g_theConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("# VFS Mounts [%d] (last mounted wins) #", (int)m_mountPoints.size()));
+	for (VirtualMountPoint const& mountPoint : m_mountPoints) {
+		std::string mountDescription = Stringf("'%s' -> %s", mountPoint.m_mountPath.c_str(), mountPoint.m_physicalDirectory.c_str());
+		if (mountPoint.m_archive) {
+			mountDescription += Stringf(" [%d entries]", mountPoint.m_archive->GetEntryCount());
+		}
+		g_theConsole->AddLine(DevConsole::INFO_MINOR_COLOR, mountDescription);
+	}
+	return true;
+}
+
+bool WriteVirtualFileArchive(std::string const& archivePath, std::string const& sourceDirectory, VirtualArchiveWriteOptions const& options)
+{
+	if (!std::filesystem::is_directory(sourceDirectory)) {
+		ERROR_RECOVERABLE(Stringf("VFS ARCHIVE SOURCE IS NOT A DIRECTORY: %s", sourceDirectory.c_str()));
+		return false;
+	}
+
+	struct PendingEntry {
+		VirtualArchiveEntry m_entry;
+		std::string m_name;
+		std::vector<uint8_t> m_storedData;
+	};
+
+	std::vector<PendingEntry> pendingEntries;
+	std::filesystem::path sourcePath(sourceDirectory);
+
+	for (auto const& dirEntry : std::filesystem::recursive_directory_iterator(sourcePath)) {
+		if (!dirEntry.is_regular_file()) continue;
+
+		PendingEntry pendingEntry;
+		std::string relativePath = std::filesystem::relative(dirEntry.path(), sourcePath).generic_string();
+		pendingEntry.m_name = NormalizeVirtualPath(options.m_pathPrefix.empty() ? relativePath : options.m_pathPrefix + "/" + relativePath);
+
+		std::vector<uint8_t> fileData;
+		if (FileReadToBuffer(fileData, dirEntry.path().string()) != 0) return false;
+
+		if (fileData.size() > UINT32_MAX) {
+			ERROR_RECOVERABLE(Stringf("VFS ARCHIVES DO NOT SUPPORT FILES OVER 4GB: %s", relativePath.c_str()));
+			return false;
+		}
+
+		if (pendingEntry.m_name.size() > UINT16_MAX) {
+			ERROR_RECOVERABLE(Stringf("VFS ARCHIVE ENTRY PATHS ARE LIMITED TO %d CHARACTERS: %s", (int)UINT16_MAX, relativePath.c_str()));
+			return false;
+		}
+
+		VirtualArchiveEntry& entry = pendingEntry.m_entry;
+		entry.m_pathHash = HashVirtualPath(pendingEntry.m_name);
+		entry.m_originalSize = (uint32_t)fileData.size();
+		entry.m_nameLength = (uint16_t)pendingEntry.m_name.size();
+
+		// Only keep the compressed version if it actually saves something
+		if (options.m_compress && !fileData.empty()) {
+			CompressLZ(pendingEntry.m_storedData, fileData.data(), fileData.size());
+			if (pendingEntry.m_storedData.size() < fileData.size()) {
+				entry.m_compression = VirtualFileCompression::LZ;
+			}
+		}
+
+		if (entry.m_compression == VirtualFileCompression::NONE) {
+			pendingEntry.m_storedData = std::move(fileData);
+		}
+
+		entry.m_storedSize = (uint32_t)pendingEntry.m_storedData.size();
+		pendingEntries.push_back(std::move(pendingEntry));
+	}
+
+	std::sort(pendingEntries.begin(), pendingEntries.end(), [](PendingEntry const& entryA, PendingEntry const& entryB) {
+		if (entryA.m_entry.m_pathHash != entryB.m_entry.m_pathHash) return entryA.m_entry.m_pathHash < entryB.m_entry.m_pathHash;
+		return entryA.m_name < entryB.m_name;
+		});
+
+	VirtualArchiveHeader header;
+	header.m_entryCount = (uint32_t)pendingEntries.size();
+	header.m_dataAlignment = (options.m_dataAlignment == 0) ? 1 : options.m_dataAlignment;
+	header.m_entryTableOffset = AlignUp(sizeof(VirtualArchiveHeader), alignof(VirtualArchiveEntry));
+	header.m_nameTableOffset = header.m_entryTableOffset + pendingEntries.size() * sizeof(VirtualArchiveEntry);
+
+	std::string nameTable;
+	for (PendingEntry& pendingEntry : pendingEntries) {
+		if (nameTable.size() > UINT32_MAX) {
+			ERROR_RECOVERABLE(Stringf("VFS ARCHIVE NAME TABLE IS OVER 4GB: %s", archivePath.c_str()));
+			return false;
+		}
+		pendingEntry.m_entry.m_nameOffset = (uint32_t)nameTable.size();
+		nameTable += pendingEntry.m_name;
+	}
+
+	size_t dataOffset = AlignUp(header.m_nameTableOffset + nameTable.size(), header.m_dataAlignment);
+	for (PendingEntry& pendingEntry : pendingEntries) {
+		pendingEntry.m_entry.m_dataOffset = dataOffset;
+		dataOffset = AlignUp(dataOffset + pendingEntry.m_storedData.size(), header.m_dataAlignment);
+	}
+
+	std::vector<uint8_t> archiveBuffer;
+	archiveBuffer.reserve(dataOffset);
+
+	AppendToBuffer(archiveBuffer, &header, sizeof(VirtualArchiveHeader));
+	archiveBuffer.resize(header.m_entryTableOffset, 0);
+	for (PendingEntry const& pendingEntry : pendingEntries) {
+		AppendToBuffer(archiveBuffer, &pendingEntry.m_entry, sizeof(VirtualArchiveEntry));
+	}
+	AppendToBuffer(archiveBuffer, nameTable.data(), nameTable.size());
+
+	for (PendingEntry const& pendingEntry : pendingEntries) {
+		archiveBuffer.resize(pendingEntry.m_entry.m_dataOffset, 0);
+		AppendToBuffer(archiveBuffer, pendingEntry.m_storedData.data(), pendingEntry.m_storedData.size());
+	}
+
+	return FileWriteFromBuffer(archiveBuffer, archivePath) == 0;
+}
+
+bool OpenVirtualFile(VirtualFile& outFile, std::string const& path)
+{
+	if (g_theVFS) {
+		return g_theVFS->OpenFile(outFile, path);
+	}
+
+	return VirtualFileSystem::OpenPhysicalFile(outFile, path);
+}
+
+void ListVirtualFiles(Strings& outPaths, std::string const& directory)
+{
+	if (g_theVFS) {
+		g_theVFS->ListFiles(outPaths, directory);
+		return;
+	}
+
+	outPaths.clear();
+	std::error_code directoryError;
+	if (!std::filesystem::is_directory(directory, directoryError)) return;
+	for (auto const& dirEntry : std::filesystem::directory_iterator(directory, directoryError)) {
+		if (dirEntry.is_regular_file()) outPaths.push_back(dirEntry.path().string());
+	}
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/EventSystem.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+	PACKED ARCHIVE LAYOUT (.vpak)
+	[VirtualArchiveHeader]
+	[VirtualArchiveEntry * entryCount]	-> Sorted by path hash, so lookups are a binary search
+	[Name table]						-> Normalized paths, used to resolve hash collisions and to list contents
+	[Entry data]						-> Every entry starts at a multiple of m_dataAlignment, so uncompressed entries can be used in place from the mapping
+*/
+
+constexpr uint32_t VIRTUAL_ARCHIVE_MAGIC = 0x4B415056; // "VPAK"
+constexpr uint32_t VIRTUAL_ARCHIVE_VERSION = 1;
+constexpr uint32_t VIRTUAL_ARCHIVE_DEFAULT_ALIGNMENT = 4096;
+
+enum class VirtualFileCompression : uint8_t {
+	NONE,
+	LZ,
+};
+
+struct VirtualArchiveHeader {
+	uint32_t m_magic = VIRTUAL_ARCHIVE_MAGIC;
+	uint32_t m_version = VIRTUAL_ARCHIVE_VERSION;
+	uint32_t m_entryCount = 0;
+	uint32_t m_dataAlignment = VIRTUAL_ARCHIVE_DEFAULT_ALIGNMENT;
+	uint64_t m_entryTableOffset = 0;
+	uint64_t m_nameTableOffset = 0;
+};
+
+struct VirtualArchiveEntry {
+	uint64_t m_pathHash = 0;
+	uint64_t m_dataOffset = 0;
+	uint32_t m_storedSize = 0;
+	uint32_t m_originalSize = 0;
+	uint32_t m_nameOffset = 0;
+	uint16_t m_nameLength = 0;
+	VirtualFileCompression m_compression = VirtualFileCompression::NONE;
+	uint8_t m_padding = 0;
+};
+
+struct VirtualArchiveWriteOptions {
+	bool m_compress = true;
+	uint32_t m_dataAlignment = VIRTUAL_ARCHIVE_DEFAULT_ALIGNMENT;
+	std::string m_pathPrefix = ""; // Prepended to every entry path, relative to the source directory
+};
+
+/// <summary>
+/// Contents of a file opened through the VFS. Points straight into an archive mapping when the entry is stored uncompressed,
+/// owns the data otherwise. Either way, the span is valid for as long as this object (and the VFS mounts) are alive
+/// </summary>
+class VirtualFile {
+	friend class VirtualFileSystem;
+	friend class VirtualFileArchive;
+public:
+	VirtualFile() = default;
+
+	bool IsValid() const { return m_isValid; }
+	ByteSpan GetSpan() const { return m_span; }
+	uint8_t const* GetData() const { return m_span.m_data; }
+	size_t GetSize() const { return m_span.m_size; }
+	std::string_view GetStringView() const { return std::string_view(reinterpret_cast<char const*>(m_span.m_data), m_span.m_size); }
+	bool IsFromArchive() const { return m_isFromArchive; }
+
+private:
+	MappedFile m_looseFile;
+	std::vector<uint8_t> m_decompressedData;
+	ByteSpan m_span;
+	bool m_isValid = false;
+	bool m_isFromArchive = false;
+};
+
+class VirtualFileArchive {
+public:
+	VirtualFileArchive() = default;
+	~VirtualFileArchive() = default;
+
+	bool Open(std::string const& archivePath);
+	VirtualArchiveEntry const* FindEntry(std::string const& normalizedPath, uint64_t pathHash) const;
+	bool ReadEntry(VirtualFile& outFile, VirtualArchiveEntry const& entry) const;
+	std::string_view GetEntryName(VirtualArchiveEntry const& entry) const;
+
+	int GetEntryCount() const { return (int)m_entryCount; }
+	VirtualArchiveEntry const& GetEntry(int entryIndex) const { return m_entries[entryIndex]; }
+	std::string const& GetArchivePath() const { return m_archiveFile.GetFilename(); }
+
+private:
+	MappedFile m_archiveFile;
+	VirtualArchiveEntry const* m_entries = nullptr;
+	char const* m_nameTable = nullptr;
+	uint32_t m_entryCount = 0;
+};
+
+struct VirtualFileSystemConfig {
+	// Development only, set it in development configs: loose files (mounted directories, then raw paths) shadow every archive
+	// entry. Off by default so shipping builds only look in archives, without a disk lookup per mount for every file
+	bool m_allowLooseFileOverrides = false;
+};
+
+struct VirtualMountPoint {
+	std::string m_mountPath;
+	std::string m_physicalDirectory;
+	VirtualFileArchive* m_archive = nullptr;
+};
+
+class VirtualFileSystem {
+public:
+	VirtualFileSystem(VirtualFileSystemConfig const& config);
+	~VirtualFileSystem();
+
+	void Startup();
+	void Shutdown();
+
+	// Mounts should be made at startup, before any loads are issued. Later mounts shadow earlier ones of the same kind,
+	// and when loose file overrides are allowed, directory mounts shadow every archive
+	bool MountDirectory(std::string const& mountPath, std::string const& physicalDirectory);
+	bool MountArchive(std::string const& mountPath, std::string const& archivePath);
+	void UnmountAll();
+
+	bool OpenFile(VirtualFile& outFile, std::string const& virtualPath) const;
+	bool DoesFileExist(std::string const& virtualPath) const;
+	// Files directly inside virtualDirectory across every mount, each name once. Returned paths can be passed to OpenFile
+	void ListFiles(Strings& outVirtualPaths, std::string const& virtualDirectory) const;
+	int ReadFileToBuffer(std::vector<uint8_t>& outBuffer, std::string const& virtualPath) const;
+	int ReadFileToString(std::string& outString, std::string const& virtualPath) const;
+
+	bool Event_BuildArchive(EventArgs& args);
+	bool Event_ListMounts(EventArgs& args);
+
+	static bool OpenPhysicalFile(VirtualFile& outFile, std::string const& physicalPath);
+
+private:
+	// Loose files are only looked up with m_allowLooseFileOverrides, and then take priority over every archive
+	bool FindLooseFile(std::string& outPhysicalPath, std::string const& normalizedPath, std::string const& virtualPath) const;
+	VirtualArchiveEntry const* FindArchiveEntry(VirtualFileArchive const*& outArchive, std::string const& normalizedPath) const;
+
+private:
+	VirtualFileSystemConfig m_config;
+	std::vector<VirtualMountPoint> m_mountPoints;
+};
+
+std::string NormalizeVirtualPath(std::string const& path);
+uint64_t HashVirtualPath(std::string const& normalizedPath);
+bool WriteVirtualFileArchive(std::string const& archivePath, std::string const& sourceDirectory, VirtualArchiveWriteOptions const& options = VirtualArchiveWriteOptions());
+
+// Goes through g_theVFS when there is one, straight to disk otherwise. Every engine loader opens its files through this
+bool OpenVirtualFile(VirtualFile& outFile, std::string const& path);
+void ListVirtualFiles(Strings& outPaths, std::string const& directory);
+
+size_t CompressLZ(std::vector<uint8_t>& outCompressed, uint8_t const* source, size_t sourceSize);
+bool DecompressLZ(uint8_t* destination, size_t destinationSize, uint8_t const* compressed, size_t compressedSize);
@@ -3,6 +3,7 @@
 #include "Engine/Math/EulerAngles.hpp"
 #include "Engine/Math/FloatRange.hpp"
 #include "Engine/Math/IntRange.hpp"
+#include "Engine/Core/VirtualFileSystem.hpp"
 
 int ParseXmlAttribute(XMLElement const& element, char const* attributeName, int defaultValue)
 {
@@ -160,3 +161,14 @@ IntRange ParseXmlAttribute(XMLElement const& element, char const* attributeName,
 
 	return defaultValue;
 }
+
+XMLError LoadXmlDocumentFromFile(XMLDoc& document, std::string const& filename)
+{
+	VirtualFile xmlFile;
+	if (!OpenVirtualFile(xmlFile, filename)) return tinyxml2::XML_ERROR_FILE_NOT_FOUND;
+
+	std::string_view xmlText = xmlFile.GetStringView();
+	if (xmlText.empty()) return tinyxml2::XML_ERROR_EMPTY_DOCUMENT;
+
+	return document.Parse(xmlText.data(), xmlText.size());
+}
@@ -30,3 +30,5 @@ std::string ParseXmlAttribute(XMLElement const& element, char const* attributeNa
 EulerAngles ParseXmlAttribute(XMLElement const& element, char const* attributeName, EulerAngles const& defaultValue);
 FloatRange ParseXmlAttribute(XMLElement const& element, char const* attributeName, FloatRange const& defaultValue);
 IntRange ParseXmlAttribute(XMLElement const& element, char const* attributeName, IntRange const& defaultValue);
+
+XMLError LoadXmlDocumentFromFile(XMLDoc& document, std::string const& filename);
@@ -0,0 +1,368 @@
+#include "Engine/Math/ConvexCollision2D.hpp"
+#include "Engine/Math/ConvexPoly2D.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <cfloat>
+
+namespace {
+	constexpr float CONVEX_COLLISION_DEGENERATE_EPSILON = 1e-10f;
+
+	std::vector<Vec2> const& GetPolyPoints(DelaunayConvexPoly2D const& poly) { return poly.m_vertexes; }
+	std::vector<Vec2> const& GetPolyPoints(ConvexPoly2D const& poly) { return poly.GetPoints(); }
+	std::vector<Plane2D> const& GetPolyPlanes(DelaunayConvexPoly2D const& poly) { return poly.GetEdgePlanes(); }
+	std::vector<Plane2D> const& GetPolyPlanes(ConvexPoly2D const& poly) { return poly.GetConvexHull().m_planes; }
+	Vec2 const& GetPolyDiscCenter(DelaunayConvexPoly2D const& poly) { return poly.m_middlePoint; }
+	Vec2 const& GetPolyDiscCenter(ConvexPoly2D const& poly) { return poly.GetBoundingDiscCenter(); }
+	float GetPolyDiscRadius(DelaunayConvexPoly2D const& poly) { return poly.GetBoundingRadius(); }
+	float GetPolyDiscRadius(ConvexPoly2D const& poly) { return poly.GetBoundingDiscRadius(); }
+
+	//-----------------------------------------------------------------------------------------------
+	// Separation of the other polygon from the plane it is least behind. Positive means that plane separates them
+	float GetMaxSeparation(std::vector<Plane2D> const& planes, std::vector<Vec2> const& otherPoints, int& outPlaneIndex)
+	{
+		float maxSeparation = -FLT_MAX;
+		for (int planeIndex = 0; planeIndex < (int)planes.size(); planeIndex++) {
+			Plane2D const& plane = planes[planeIndex];
+
+			float deepestDist = FLT_MAX;
+			for (Vec2 const& point : otherPoints) {
+				float distToPlane = DotProduct2D(plane.m_planeNormal, point) - plane.m_distToPlane;
+				if (distToPlane < deepestDist) {
+					deepestDist = distToPlane;
+				}
+			}
+
+			if (deepestDist > maxSeparation) {
+				maxSeparation = deepestDist;
+				outPlaneIndex = planeIndex;
+				if (maxSeparation > 0.0f) break;
+			}
+		}
+
+		return maxSeparation;
+	}
+
+	template <typename T_Poly>
+	bool GetSATContact(T_Poly const& polyA, T_Poly const& polyB, ConvexContact2D& outContact)
+	{
+		std::vector<Plane2D> const& planesA = GetPolyPlanes(polyA);
+		std::vector<Plane2D> const& planesB = GetPolyPlanes(polyB);
+		if (planesA.empty() || planesB.empty()) return false;
+
+		int planeIndexA = 0;
+		float separationA = GetMaxSeparation(planesA, GetPolyPoints(polyB), planeIndexA);
+		if (separationA > 0.0f) return false;
+
+		int planeIndexB = 0;
+		float separationB = GetMaxSeparation(planesB, GetPolyPoints(polyA), planeIndexB);
+		if (separationB > 0.0f) return false;
+
+		// Least penetration wins. B moves out along A's normal, or A out along B's normal
+		if (separationA >= separationB) {
+			outContact.m_normal = planesA[planeIndexA].m_planeNormal;
+			outContact.m_depth = -separationA;
+		}
+		else {
+			outContact.m_normal = -planesB[planeIndexB].m_planeNormal;
+			outContact.m_depth = -separationB;
+		}
+		return true;
+	}
+
+	//-----------------------------------------------------------------------------------------------
+	struct MinkowskiDifference2D {
+		Vec2 const* m_pointsA = nullptr;
+		int m_pointCountA = 0;
+		Vec2 const* m_pointsB = nullptr;
+		int m_pointCountB = 0;
+
+		static Vec2 const& GetFarthestPoint(Vec2 const* points, int pointCount, Vec2 const& direction)
+		{
+			int farthestIndex = 0;
+			float farthestDist = DotProduct2D(points[0], direction);
+			for (int pointIndex = 1; pointIndex < pointCount; pointIndex++) {
+				float dist = DotProduct2D(points[pointIndex], direction);
+				if (dist > farthestDist) {
+					farthestDist = dist;
+					farthestIndex = pointIndex;
+				}
+			}
+			return points[farthestIndex];
+		}
+
+		Vec2 GetSupport(Vec2 const& direction) const
+		{
+			return GetFarthestPoint(m_pointsA, m_pointCountA, direction) - GetFarthestPoint(m_pointsB, m_pointCountB, -direction);
+		}
+	};
+
+	float GetCross2D(Vec2 const& vectorA, Vec2 const& vectorB)
+	{
+		return (vectorA.x * vectorB.y) - (vectorA.y * vectorB.x);
+	}
+
+	// Perpendicular of edge on the side of towards
+	Vec2 GetPerpendicularTowards(Vec2 const& edge, Vec2 const& towards)
+	{
+		Vec2 perpendicular(-edge.y, edge.x);
+		return (DotProduct2D(perpendicular, towards) >= 0.0f) ? perpendicular : -perpendicular;
+	}
+
+	// Simplex is ordered oldest to newest. Returns true once it encloses (or touches) the origin
+	bool RunGJK(MinkowskiDifference2D const& shapes, Vec2 simplex[3], int& simplexCount)
+	{
+		Vec2 direction = shapes.m_pointsB[0] - shapes.m_pointsA[0];
+		if (direction.GetLengthSquared() < CONVEX_COLLISION_DEGENERATE_EPSILON) {
+			direction = Vec2(1.0f, 0.0f);
+		}
+
+		simplex[0] = shapes.GetSupport(direction);
+		simplexCount = 1;
+		direction = -simplex[0];
+
+		for (int iteration = 0; iteration < CONVEX_COLLISION_MAX_GJK_ITERATIONS; iteration++) {
+			if (direction.GetLengthSquared() < CONVEX_COLLISION_DEGENERATE_EPSILON) return true; // Origin is on the simplex
+
+			Vec2 newPoint = shapes.GetSupport(direction);
+			if (DotProduct2D(newPoint, direction) < 0.0f) return false; // Could not get past the origin
+
+			simplex[simplexCount++] = newPoint;
+
+			if (simplexCount == 2) {
+				Vec2 const& pointA = simplex[1];
+				Vec2 edgeAB = simplex[0] - pointA;
+				Vec2 dispToOrigin = -pointA;
+
+				if (DotProduct2D(edgeAB, dispToOrigin) > 0.0f) {
+					if (fabsf(GetCross2D(edgeAB, dispToOrigin)) < CONVEX_COLLISION_DEGENERATE_EPSILON) return true;
+					direction = GetPerpendicularTowards(edgeAB, dispToOrigin);
+				}
+				else {
+					simplex[0] = pointA;
+					simplexCount = 1;
+					direction = dispToOrigin;
+				}
+			}
+			else {
+				Vec2 const pointA = simplex[2];
+				Vec2 const pointB = simplex[1];
+				Vec2 const pointC = simplex[0];
+				Vec2 edgeAB = pointB - pointA;
+				Vec2 edgeAC = pointC - pointA;
+				Vec2 dispToOrigin = -pointA;
+
+				Vec2 normalAB = GetPerpendicularTowards(edgeAB, -edgeAC);
+				Vec2 normalAC = GetPerpendicularTowards(edgeAC, -edgeAB);
+
+				if (DotProduct2D(normalAB, dispToOrigin) > 0.0f) {
+					simplex[0] = pointB;
+					simplex[1] = pointA;
+					simplexCount = 2;
+					direction = normalAB;
+				}
+				else if (DotProduct2D(normalAC, dispToOrigin) > 0.0f) {
+					simplex[0] = pointC;
+					simplex[1] = pointA;
+					simplexCount = 2;
+					direction = normalAC;
+				}
+				else {
+					return true;
+				}
+			}
+		}
+
+		// Out of iterations means the simplex keeps circling the origin, that only happens on touching shapes
+		return true;
+	}
+
+	bool RunEPA(MinkowskiDifference2D const& shapes, Vec2 const simplex[3], int simplexCount, ConvexContact2D& outContact)
+	{
+		Vec2 polytope[CONVEX_COLLISION_MAX_EPA_VERTEXES];
+		int vertexCount = simplexCount;
+		for (int simplexIndex = 0; simplexIndex < simplexCount; simplexIndex++) {
+			polytope[simplexIndex] = simplex[simplexIndex];
+		}
+
+		// GJK may stop on a point or a segment through the origin, grow those into a triangle
+		Vec2 const expandDirections[4] = { Vec2(1.0f, 0.0f), Vec2(-1.0f, 0.0f), Vec2(0.0f, 1.0f), Vec2(0.0f, -1.0f) };
+		for (int directionIndex = 0; (directionIndex < 4) && (vertexCount < 3); directionIndex++) {
+			Vec2 direction = expandDirections[directionIndex];
+			if (vertexCount == 2) {
+				Vec2 edge = polytope[1] - polytope[0];
+				direction = (directionIndex % 2 == 0) ? Vec2(-edge.y, edge.x) : Vec2(edge.y, -edge.x);
+			}
+
+			Vec2 newPoint = shapes.GetSupport(direction);
+			bool isNewPoint = (vertexCount == 1) ? ((newPoint - polytope[0]).GetLengthSquared() > CONVEX_COLLISION_DEGENERATE_EPSILON) :
+				(fabsf(GetCross2D(polytope[1] - polytope[0], newPoint - polytope[0])) > CONVEX_COLLISION_DEGENERATE_EPSILON);
+			if (isNewPoint) {
+				polytope[vertexCount++] = newPoint;
+			}
+		}
+
+		if (vertexCount < 3) {
+			// Flat Minkowski difference, the shapes only touch
+			outContact.m_normal = Vec2(1.0f, 0.0f);
+			outContact.m_depth = 0.0f;
+			return true;
+		}
+
+		// Counter clockwise, so the outward normal of edge i -> j is (e.y, -e.x)
+		if (GetCross2D(polytope[1] - polytope[0], polytope[2] - polytope[0]) < 0.0f) {
+			Vec2 swapPoint = polytope[1];
+			polytope[1] = polytope[2];
+			polytope[2] = swapPoint;
+		}
+
+		for (;;) {
+			int closestEdgeIndex = 0;
+			float closestDist = FLT_MAX;
+			Vec2 closestNormal = Vec2::ZERO;
+
+			for (int vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++) {
+				Vec2 const& vertex = polytope[vertexIndex];
+				Vec2 edge = polytope[(vertexIndex + 1) % vertexCount] - vertex;
+				float edgeLengthSquared = edge.GetLengthSquared();
+				if (edgeLengthSquared < CONVEX_COLLISION_DEGENERATE_EPSILON) continue;
+
+				Vec2 normal = Vec2(edge.y, -edge.x) / sqrtf(edgeLengthSquared);
+				float distToOrigin = DotProduct2D(normal, vertex);
+				if (distToOrigin < closestDist) {
+					closestDist = distToOrigin;
+					closestNormal = normal;
+					closestEdgeIndex = vertexIndex;
+				}
+			}
+
+			Vec2 newPoint = shapes.GetSupport(closestNormal);
+			float newDist = DotProduct2D(newPoint, closestNormal);
+			if (((newDist - closestDist) < CONVEX_COLLISION_EPA_TOLERANCE) || (vertexCount == CONVEX_COLLISION_MAX_EPA_VERTEXES)) {
+				outContact.m_normal = closestNormal;
+				outContact.m_depth = (closestDist > 0.0f) ? closestDist : 0.0f;
+				return true;
+			}
+
+			// Split the closest edge with the new support point
+			for (int vertexIndex = vertexCount; vertexIndex > closestEdgeIndex + 1; vertexIndex--) {
+				polytope[vertexIndex] = polytope[vertexIndex - 1];
+			}
+			polytope[closestEdgeIndex + 1] = newPoint;
+			vertexCount++;
+		}
+	}
+
+	//-----------------------------------------------------------------------------------------------
+	template <typename T_Poly>
+	bool CanPolysOverlap(T_Poly const& polyA, T_Poly const& polyB)
+	{
+		float radiusSum = GetPolyDiscRadius(polyA) + GetPolyDiscRadius(polyB);
+		return GetDistanceSquared2D(GetPolyDiscCenter(polyA), GetPolyDiscCenter(polyB)) <= (radiusSum * radiusSum);
+	}
+
+	// The polygon itself is skipped when it is part of otherPolys
+	template <typename T_Poly>
+	int GetOverlappingPolys(T_Poly const& poly, std::vector<T_Poly> const& otherPolys, std::vector<int>& outOverlappingIndexes)
+	{
+		outOverlappingIndexes.clear();
+		ConvexContact2D contact;
+		for (int otherIndex = 0; otherIndex < (int)otherPolys.size(); otherIndex++) {
+			T_Poly const& otherPoly = otherPolys[otherIndex];
+			if ((&otherPoly == &poly) || !CanPolysOverlap(poly, otherPoly)) continue;
+
+			if (GetSATContact(poly, otherPoly, contact)) {
+				outOverlappingIndexes.push_back(otherIndex);
+			}
+		}
+		return (int)outOverlappingIndexes.size();
+	}
+
+	template <typename T_Poly>
+	int GetPolyContacts(T_Poly const& poly, std::vector<T_Poly> const& otherPolys, std::vector<ConvexContact2D>& outContacts)
+	{
+		outContacts.clear();
+		ConvexContact2D contact;
+		for (int otherIndex = 0; otherIndex < (int)otherPolys.size(); otherIndex++) {
+			T_Poly const& otherPoly = otherPolys[otherIndex];
+			if ((&otherPoly == &poly) || !CanPolysOverlap(poly, otherPoly)) continue;
+
+			if (GetSATContact(poly, otherPoly, contact)) {
+				contact.m_otherIndex = otherIndex;
+				outContacts.push_back(contact);
+			}
+		}
+		return (int)outContacts.size();
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+bool GetConvexPolygons2DContact(DelaunayConvexPoly2D const& polyA, DelaunayConvexPoly2D const& polyB, ConvexContact2D& outContact)
+{
+	return GetSATContact(polyA, polyB, outContact);
+}
+
+bool GetConvexPolygons2DContact(ConvexPoly2D const& polyA, ConvexPoly2D const& polyB, ConvexContact2D& outContact)
+{
+	return GetSATContact(polyA, polyB, outContact);
+}
+
+bool DoConvexShapes2DOverlapGJK(Vec2 const* pointsA, int pointCountA, Vec2 const* pointsB, int pointCountB)
+{
+	if ((pointCountA <= 0) || (pointCountB <= 0)) return false;
+
+	MinkowskiDifference2D shapes = { pointsA, pointCountA, pointsB, pointCountB };
+	Vec2 simplex[3];
+	int simplexCount = 0;
+	return RunGJK(shapes, simplex, simplexCount);
+}
+
+bool DoConvexShapes2DOverlapGJK(DelaunayConvexPoly2D const& polyA, DelaunayConvexPoly2D const& polyB)
+{
+	return DoConvexShapes2DOverlapGJK(polyA.m_vertexes.data(), (int)polyA.m_vertexes.size(), polyB.m_vertexes.data(), (int)polyB.m_vertexes.size());
+}
+
+bool DoConvexShapes2DOverlapGJK(ConvexPoly2D const& polyA, ConvexPoly2D const& polyB)
+{
+	return DoConvexShapes2DOverlapGJK(polyA.GetPoints().data(), (int)polyA.GetPoints().size(), polyB.GetPoints().data(), (int)polyB.GetPoints().size());
+}
+
+bool GetConvexShapes2DContactEPA(Vec2 const* pointsA, int pointCountA, Vec2 const* pointsB, int pointCountB, ConvexContact2D& outContact)
+{
+	if ((pointCountA <= 0) || (pointCountB <= 0)) return false;
+
+	MinkowskiDifference2D shapes = { pointsA, pointCountA, pointsB, pointCountB };
+	Vec2 simplex[3];
+	int simplexCount = 0;
+	if (!RunGJK(shapes, simplex, simplexCount)) return false;
+
+	return RunEPA(shapes, simplex, simplexCount, outContact);
+}
+
+bool GetConvexShapes2DContactEPA(DelaunayConvexPoly2D const& polyA, DelaunayConvexPoly2D const& polyB, ConvexContact2D& outContact)
+{
+	return GetConvexShapes2DContactEPA(polyA.m_vertexes.data(), (int)polyA.m_vertexes.size(), polyB.m_vertexes.data(), (int)polyB.m_vertexes.size(), outContact);
+}
+
+bool GetConvexShapes2DContactEPA(ConvexPoly2D const& polyA, ConvexPoly2D const& polyB, ConvexContact2D& outContact)
+{
+	return GetConvexShapes2DContactEPA(polyA.GetPoints().data(), (int)polyA.GetPoints().size(), polyB.GetPoints().data(), (int)polyB.GetPoints().size(), outContact);
+}
+
+int GetOverlappingConvexPolygons2D(DelaunayConvexPoly2D const& poly, std::vector<DelaunayConvexPoly2D> const& otherPolys, std::vector<int>& outOverlappingIndexes)
+{
+	return GetOverlappingPolys(poly, otherPolys, outOverlappingIndexes);
+}
+
+int GetOverlappingConvexPolygons2D(ConvexPoly2D const& poly, std::vector<ConvexPoly2D> const& otherPolys, std::vector<int>& outOverlappingIndexes)
+{
+	return GetOverlappingPolys(poly, otherPolys, outOverlappingIndexes);
+}
+
+int GetConvexPolygons2DContacts(DelaunayConvexPoly2D const& poly, std::vector<DelaunayConvexPoly2D> const& otherPolys, std::vector<ConvexContact2D>& outContacts)
+{
+	return GetPolyContacts(poly, otherPolys, outContacts);
+}
+
+int GetConvexPolygons2DContacts(ConvexPoly2D const& poly, std::vector<ConvexPoly2D> const& otherPolys, std::vector<ConvexContact2D>& outContacts)
+{
+	return GetPolyContacts(poly, otherPolys, outContacts);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include <vector>
+
+struct DelaunayConvexPoly2D;
+class ConvexPoly2D;
+
+constexpr int CONVEX_COLLISION_MAX_GJK_ITERATIONS = 32;
+constexpr int CONVEX_COLLISION_MAX_EPA_VERTEXES = 64; // EPA polytope lives on the stack, it stops refining once full
+constexpr float CONVEX_COLLISION_EPA_TOLERANCE = 0.0001f;
+
+struct ConvexContact2D {
+	Vec2 m_normal = Vec2::ZERO; // Moving B by m_normal * m_depth (or A by the opposite) separates the shapes
+	float m_depth = 0.0f;
+	int m_otherIndex = -1; // Index into the list of shapes, only set by the batch queries
+};
+
+// SAT over the cached edge planes, no allocations. The contact is the axis of least penetration
+bool GetConvexPolygons2DContact(DelaunayConvexPoly2D const& polyA, DelaunayConvexPoly2D const& polyB, ConvexContact2D& outContact);
+bool GetConvexPolygons2DContact(ConvexPoly2D const& polyA, ConvexPoly2D const& polyB, ConvexContact2D& outContact);
+
+// GJK on the Minkowski difference, works on any convex point cloud (vertex order does not matter). Touching counts as overlapping
+bool DoConvexShapes2DOverlapGJK(Vec2 const* pointsA, int pointCountA, Vec2 const* pointsB, int pointCountB);
+bool DoConvexShapes2DOverlapGJK(DelaunayConvexPoly2D const& polyA, DelaunayConvexPoly2D const& polyB);
+bool DoConvexShapes2DOverlapGJK(ConvexPoly2D const& polyA, ConvexPoly2D const& polyB);
+
+// GJK followed by EPA for the penetration normal and depth
+bool GetConvexShapes2DContactEPA(Vec2 const* pointsA, int pointCountA, Vec2 const* pointsB, int pointCountB, ConvexContact2D& outContact);
+bool GetConvexShapes2DContactEPA(DelaunayConvexPoly2D const& polyA, DelaunayConvexPoly2D const& polyB, ConvexContact2D& outContact);
+bool GetConvexShapes2DContactEPA(ConvexPoly2D const& polyA, ConvexPoly2D const& polyB, ConvexContact2D& outContact);
+
+// One polygon vs many. Bounding discs reject most pairs before SAT runs. The output vectors are cleared, not shrunk,
+// so reusing them across frames keeps these allocation free. Returns how many were found
+int GetOverlappingConvexPolygons2D(DelaunayConvexPoly2D const& poly, std::vector<DelaunayConvexPoly2D> const& otherPolys, std::vector<int>& outOverlappingIndexes);
+int GetOverlappingConvexPolygons2D(ConvexPoly2D const& poly, std::vector<ConvexPoly2D> const& otherPolys, std::vector<int>& outOverlappingIndexes);
+int GetConvexPolygons2DContacts(DelaunayConvexPoly2D const& poly, std::vector<DelaunayConvexPoly2D> const& otherPolys, std::vector<ConvexContact2D>& outContacts);
+int GetConvexPolygons2DContacts(ConvexPoly2D const& poly, std::vector<ConvexPoly2D> const& otherPolys, std::vector<ConvexContact2D>& outContacts);
@@ -0,0 +1,594 @@
+#include "Engine/Math/ConvexHull3D.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <cfloat>
+#include <cmath>
+#include <unordered_map>
+
+namespace {
+	constexpr unsigned char TRIANGLE_REMOVED = 0;
+	constexpr unsigned char TRIANGLE_ON_HULL = 1;
+	constexpr unsigned char TRIANGLE_VISIBLE = 2;
+
+	int GetNextHalfEdge(int halfEdge) { return ((halfEdge % 3) == 2) ? (halfEdge - 2) : (halfEdge + 1); }
+	int GetPrevHalfEdge(int halfEdge) { return ((halfEdge % 3) == 0) ? (halfEdge + 2) : (halfEdge - 1); }
+
+	// Slivers have normals that are mostly rounding in float, so planes are worked out in double. Newell's normal is the
+	// cross product for a triangle and averages the whole polygon otherwise
+	Plane3D const ComputePolygonPlane(Vec3 const* const* vertexes, int vertexCount)
+	{
+		double normalX = 0.0;
+		double normalY = 0.0;
+		double normalZ = 0.0;
+		double centerX = 0.0;
+		double centerY = 0.0;
+		double centerZ = 0.0;
+		for (int vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++) {
+			Vec3 const& vertex = *vertexes[vertexIndex];
+			Vec3 const& nextVertex = *vertexes[(vertexIndex + 1) % vertexCount];
+			normalX += ((double)vertex.y - (double)nextVertex.y) * ((double)vertex.z + (double)nextVertex.z);
+			normalY += ((double)vertex.z - (double)nextVertex.z) * ((double)vertex.x + (double)nextVertex.x);
+			normalZ += ((double)vertex.x - (double)nextVertex.x) * ((double)vertex.y + (double)nextVertex.y);
+			centerX += vertex.x;
+			centerY += vertex.y;
+			centerZ += vertex.z;
+		}
+
+		Plane3D plane;
+		double normalLength = sqrt((normalX * normalX) + (normalY * normalY) + (normalZ * normalZ));
+		if (normalLength == 0.0) return plane;
+
+		normalX /= normalLength;
+		normalY /= normalLength;
+		normalZ /= normalLength;
+		plane.m_planeNormal = Vec3((float)normalX, (float)normalY, (float)normalZ);
+		plane.m_distToPlane = (float)(((normalX * centerX) + (normalY * centerY) + (normalZ * centerZ)) / (double)vertexCount);
+		return plane;
+	}
+
+	unsigned long long GetEdgeKey(int startVertex, int endVertex)
+	{
+		return ((unsigned long long)(unsigned int)startVertex << 32) | (unsigned long long)(unsigned int)endVertex;
+	}
+}
+
+ConvexHull3D::ConvexHull3D(std::vector<Vec3> const& points)
+{
+	Build(points);
+}
+
+bool ConvexHull3D::Build(std::vector<Vec3> const& points)
+{
+	Clear();
+	m_points = points;
+	int pointCount = (int)m_points.size();
+	if (pointCount < 4) return false;
+
+	// Coordinates near the largest ones have about that much rounding in every dot product
+	Vec3 maxAbsCoords = Vec3::ZERO;
+	for (Vec3 const& point : m_points) {
+		maxAbsCoords.x = (fabsf(point.x) > maxAbsCoords.x) ? fabsf(point.x) : maxAbsCoords.x;
+		maxAbsCoords.y = (fabsf(point.y) > maxAbsCoords.y) ? fabsf(point.y) : maxAbsCoords.y;
+		maxAbsCoords.z = (fabsf(point.z) > maxAbsCoords.z) ? fabsf(point.z) : maxAbsCoords.z;
+	}
+	m_tolerance = 3.0f * FLT_EPSILON * (maxAbsCoords.x + maxAbsCoords.y + maxAbsCoords.z);
+
+	m_nextOutsidePoints.assign(pointCount, CONVEX_HULL_INVALID_INDEX);
+	m_horizonNextByVertex.assign(pointCount, CONVEX_HULL_INVALID_INDEX);
+	if (!BuildInitialTetrahedron()) {
+		Clear();
+		return false;
+	}
+
+	while (!m_pendingTriangles.empty()) {
+		int triangleIndex = m_pendingTriangles.back();
+		if ((m_triangleStates[triangleIndex] != TRIANGLE_ON_HULL) || (m_triangleOutsideHeads[triangleIndex] == CONVEX_HULL_INVALID_INDEX)) {
+			m_pendingTriangles.pop_back();
+			continue;
+		}
+		AddPointToHull(triangleIndex);
+	}
+
+	BuildOutput();
+	return IsValid();
+}
+
+void ConvexHull3D::GetFaceVertexes(int faceIndex, std::vector<Vec3>& outCCWVertexes) const
+{
+	outCCWVertexes.clear();
+	ConvexHull3DFace const& face = m_faces[faceIndex];
+	int halfEdge = face.m_firstHalfEdge;
+	for (int edgeIndex = 0; edgeIndex < face.m_halfEdgeCount; edgeIndex++) {
+		outCCWVertexes.push_back(m_vertexes[m_halfEdges[halfEdge].m_vertex]);
+		halfEdge = m_halfEdges[halfEdge].m_next;
+	}
+}
+
+void ConvexHull3D::GetTriangleIndexes(std::vector<int>& outIndexes) const
+{
+	outIndexes.clear();
+	for (ConvexHull3DFace const& face : m_faces) {
+		int firstVertex = m_halfEdges[face.m_firstHalfEdge].m_vertex;
+		int halfEdge = m_halfEdges[face.m_firstHalfEdge].m_next;
+		for (int triangleIndex = 0; triangleIndex < (face.m_halfEdgeCount - 2); triangleIndex++) {
+			int nextHalfEdge = m_halfEdges[halfEdge].m_next;
+			outIndexes.push_back(firstVertex);
+			outIndexes.push_back(m_halfEdges[halfEdge].m_vertex);
+			outIndexes.push_back(m_halfEdges[nextHalfEdge].m_vertex);
+			halfEdge = nextHalfEdge;
+		}
+	}
+}
+
+bool ConvexHull3D::IsPointInside(Vec3 const& point, float tolerance) const
+{
+	if (m_faces.empty()) return false;
+
+	for (ConvexHull3DFace const& face : m_faces) {
+		if ((DotProduct3D(face.m_plane.m_planeNormal, point) - face.m_plane.m_distToPlane) > tolerance) return false;
+	}
+	return true;
+}
+
+Vec3 const ConvexHull3D::GetSupportPoint(Vec3 const& direction) const
+{
+	if (m_vertexes.empty()) return Vec3::ZERO;
+
+	int supportIndex = 0;
+	float maxProjection = DotProduct3D(m_vertexes[0], direction);
+	for (int vertexIndex = 1; vertexIndex < (int)m_vertexes.size(); vertexIndex++) {
+		float projection = DotProduct3D(m_vertexes[vertexIndex], direction);
+		if (projection > maxProjection) {
+			maxProjection = projection;
+			supportIndex = vertexIndex;
+		}
+	}
+	return m_vertexes[supportIndex];
+}
+
+void ConvexHull3D::Clear()
+{
+	m_vertexes.clear();
+	m_faces.clear();
+	m_halfEdges.clear();
+	m_tolerance = 0.0f;
+
+	m_points.clear();
+	m_triangleVertexes.clear();
+	m_triangleTwins.clear();
+	m_trianglePlanes.clear();
+	m_triangleOutsideHeads.clear();
+	m_triangleCoplanarHeads.clear();
+	m_triangleStates.clear();
+	m_freeTriangles.clear();
+	m_pendingTriangles.clear();
+	m_visibleTriangles.clear();
+	m_horizonHalfEdges.clear();
+	m_newTriangles.clear();
+	m_orphanPoints.clear();
+}
+
+bool ConvexHull3D::BuildInitialTetrahedron()
+{
+	int pointCount = (int)m_points.size();
+
+	// The two farthest apart of the extreme points along each axis
+	int extremeIndexes[6] = { 0, 0, 0, 0, 0, 0 };
+	for (int pointIndex = 1; pointIndex < pointCount; pointIndex++) {
+		Vec3 const& point = m_points[pointIndex];
+		float coords[3] = { point.x, point.y, point.z };
+		for (int axis = 0; axis < 3; axis++) {
+			Vec3 const& minPoint = m_points[extremeIndexes[axis * 2]];
+			Vec3 const& maxPoint = m_points[extremeIndexes[(axis * 2) + 1]];
+			float minCoords[3] = { minPoint.x, minPoint.y, minPoint.z };
+			float maxCoords[3] = { maxPoint.x, maxPoint.y, maxPoint.z };
+			if (coords[axis] < minCoords[axis]) extremeIndexes[axis * 2] = pointIndex;
+			if (coords[axis] > maxCoords[axis]) extremeIndexes[(axis * 2) + 1] = pointIndex;
+		}
+	}
+
+	int pointA = 0;
+	int pointB = 0;
+	float maxDistanceSquared = 0.0f;
+	for (int axis = 0; axis < 3; axis++) {
+		float distanceSquared = (m_points[extremeIndexes[(axis * 2) + 1]] - m_points[extremeIndexes[axis * 2]]).GetLengthSquared();
+		if (distanceSquared > maxDistanceSquared) {
+			maxDistanceSquared = distanceSquared;
+			pointA = extremeIndexes[axis * 2];
+			pointB = extremeIndexes[(axis * 2) + 1];
+		}
+	}
+	if (sqrtf(maxDistanceSquared) <= m_tolerance) return false;
+
+	// Farthest from the line, then farthest from the plane
+	Vec3 lineDirection = (m_points[pointB] - m_points[pointA]).GetNormalized();
+	int pointC = 0;
+	maxDistanceSquared = 0.0f;
+	for (int pointIndex = 0; pointIndex < pointCount; pointIndex++) {
+		float distanceSquared = CrossProduct3D(m_points[pointIndex] - m_points[pointA], lineDirection).GetLengthSquared();
+		if (distanceSquared > maxDistanceSquared) {
+			maxDistanceSquared = distanceSquared;
+			pointC = pointIndex;
+		}
+	}
+	if (sqrtf(maxDistanceSquared) <= m_tolerance) return false;
+
+	Vec3 baseNormal = CrossProduct3D(m_points[pointB] - m_points[pointA], m_points[pointC] - m_points[pointA]).GetNormalized();
+	int pointD = 0;
+	float maxSignedDistance = 0.0f;
+	for (int pointIndex = 0; pointIndex < pointCount; pointIndex++) {
+		float signedDistance = DotProduct3D(m_points[pointIndex] - m_points[pointA], baseNormal);
+		if (fabsf(signedDistance) > fabsf(maxSignedDistance)) {
+			maxSignedDistance = signedDistance;
+			pointD = pointIndex;
+		}
+	}
+	if (fabsf(maxSignedDistance) <= m_tolerance) return false;
+
+	// The base has to face away from the apex
+	if (maxSignedDistance > 0.0f) {
+		int swapPoint = pointB;
+		pointB = pointC;
+		pointC = swapPoint;
+	}
+
+	int base = AddTriangle(pointA, pointB, pointC);
+	int sideAB = AddTriangle(pointB, pointA, pointD);
+	int sideBC = AddTriangle(pointC, pointB, pointD);
+	int sideCA = AddTriangle(pointA, pointC, pointD);
+	LinkHalfEdges(base * 3, sideAB * 3);
+	LinkHalfEdges((base * 3) + 1, sideBC * 3);
+	LinkHalfEdges((base * 3) + 2, sideCA * 3);
+	LinkHalfEdges((sideAB * 3) + 1, (sideCA * 3) + 2);
+	LinkHalfEdges((sideAB * 3) + 2, (sideBC * 3) + 1);
+	LinkHalfEdges((sideBC * 3) + 2, (sideCA * 3) + 1);
+
+	int tetrahedron[4] = { base, sideAB, sideBC, sideCA };
+	for (int pointIndex = 0; pointIndex < pointCount; pointIndex++) {
+		AssignOutsidePoint(pointIndex, tetrahedron, 4);
+	}
+	m_pendingTriangles.assign(tetrahedron, tetrahedron + 4);
+	return true;
+}
+
+int ConvexHull3D::AddTriangle(int pointA, int pointB, int pointC)
+{
+	int triangleIndex = 0;
+	if (!m_freeTriangles.empty()) {
+		triangleIndex = m_freeTriangles.back();
+		m_freeTriangles.pop_back();
+	}
+	else {
+		triangleIndex = (int)m_triangleStates.size();
+		m_triangleVertexes.resize(m_triangleVertexes.size() + 3);
+		m_triangleTwins.resize(m_triangleTwins.size() + 3);
+		m_trianglePlanes.emplace_back();
+		m_triangleOutsideHeads.push_back(CONVEX_HULL_INVALID_INDEX);
+		m_triangleCoplanarHeads.push_back(CONVEX_HULL_INVALID_INDEX);
+		m_triangleStates.push_back(TRIANGLE_REMOVED);
+	}
+
+	int firstHalfEdge = triangleIndex * 3;
+	m_triangleVertexes[firstHalfEdge] = pointA;
+	m_triangleVertexes[(size_t)firstHalfEdge + 1] = pointB;
+	m_triangleVertexes[(size_t)firstHalfEdge + 2] = pointC;
+	m_triangleTwins[firstHalfEdge] = CONVEX_HULL_INVALID_INDEX;
+	m_triangleTwins[(size_t)firstHalfEdge + 1] = CONVEX_HULL_INVALID_INDEX;
+	m_triangleTwins[(size_t)firstHalfEdge + 2] = CONVEX_HULL_INVALID_INDEX;
+
+	// Slivers against the horizon can have no area, their zero normal never has a point outside
+	Vec3 const* vertexes[3] = { &m_points[pointA], &m_points[pointB], &m_points[pointC] };
+	m_trianglePlanes[triangleIndex] = ComputePolygonPlane(vertexes, 3);
+
+	m_triangleOutsideHeads[triangleIndex] = CONVEX_HULL_INVALID_INDEX;
+	m_triangleCoplanarHeads[triangleIndex] = CONVEX_HULL_INVALID_INDEX;
+	m_triangleStates[triangleIndex] = TRIANGLE_ON_HULL;
+	return triangleIndex;
+}
+
+void ConvexHull3D::RemoveTriangle(int triangleIndex)
+{
+	m_triangleStates[triangleIndex] = TRIANGLE_REMOVED;
+	m_triangleOutsideHeads[triangleIndex] = CONVEX_HULL_INVALID_INDEX;
+	m_triangleCoplanarHeads[triangleIndex] = CONVEX_HULL_INVALID_INDEX;
+	m_freeTriangles.push_back(triangleIndex);
+}
+
+void ConvexHull3D::LinkHalfEdges(int halfEdgeA, int halfEdgeB)
+{
+	m_triangleTwins[halfEdgeA] = halfEdgeB;
+	m_triangleTwins[halfEdgeB] = halfEdgeA;
+}
+
+float ConvexHull3D::GetDistanceToTrianglePlane(int triangleIndex, int pointIndex) const
+{
+	Plane3D const& plane = m_trianglePlanes[triangleIndex];
+	return DotProduct3D(plane.m_planeNormal, m_points[pointIndex]) - plane.m_distToPlane;
+}
+
+void ConvexHull3D::AssignOutsidePoint(int pointIndex, int const* triangles, int triangleCount)
+{
+	// The triangle it is farthest outside of. Points within tolerance of a plane stay with that triangle: on a thin hull a
+	// point that close to the planes can still be far out past an edge, so it is checked again whenever the triangle goes.
+	// Only points deeper than tolerance under every plane are inside for good
+	int nearestTriangle = CONVEX_HULL_INVALID_INDEX;
+	float maxDistance = -m_tolerance;
+	for (int triangle = 0; triangle < triangleCount; triangle++) {
+		float distance = GetDistanceToTrianglePlane(triangles[triangle], pointIndex);
+		if (distance > maxDistance) {
+			maxDistance = distance;
+			nearestTriangle = triangles[triangle];
+		}
+	}
+	if (nearestTriangle == CONVEX_HULL_INVALID_INDEX) return;
+
+	int& listHead = (maxDistance > m_tolerance) ? m_triangleOutsideHeads[nearestTriangle] : m_triangleCoplanarHeads[nearestTriangle];
+	m_nextOutsidePoints[pointIndex] = listHead;
+	listHead = pointIndex;
+}
+
+bool ConvexHull3D::AddPointToHull(int triangleIndex)
+{
+	int eyePoint = m_triangleOutsideHeads[triangleIndex];
+	float maxDistance = GetDistanceToTrianglePlane(triangleIndex, eyePoint);
+	for (int pointIndex = m_nextOutsidePoints[eyePoint]; pointIndex != CONVEX_HULL_INVALID_INDEX; pointIndex = m_nextOutsidePoints[pointIndex]) {
+		float distance = GetDistanceToTrianglePlane(triangleIndex, pointIndex);
+		if (distance > maxDistance) {
+			maxDistance = distance;
+			eyePoint = pointIndex;
+		}
+	}
+
+	// Flood the triangles the eye sees, the half edges leading to ones it does not see are the horizon. Any triangle the eye
+	// is above goes, even within tolerance: keeping it would leave a sliver whose tilted plane cuts into the rest of the hull
+	m_visibleTriangles.clear();
+	m_horizonHalfEdges.clear();
+	m_visibleTriangles.push_back(triangleIndex);
+	m_triangleStates[triangleIndex] = TRIANGLE_VISIBLE;
+	for (int visibleIndex = 0; visibleIndex < (int)m_visibleTriangles.size(); visibleIndex++) {
+		int visibleTriangle = m_visibleTriangles[visibleIndex];
+		for (int halfEdge = visibleTriangle * 3; halfEdge < ((visibleTriangle * 3) + 3); halfEdge++) {
+			int neighbour = m_triangleTwins[halfEdge] / 3;
+			if (m_triangleStates[neighbour] == TRIANGLE_VISIBLE) continue;
+
+			if (GetDistanceToTrianglePlane(neighbour, eyePoint) > 0.0f) {
+				m_triangleStates[neighbour] = TRIANGLE_VISIBLE;
+				m_visibleTriangles.push_back(neighbour);
+			}
+			else {
+				m_horizonHalfEdges.push_back(halfEdge);
+			}
+		}
+	}
+
+	// The horizon has to be a single loop. Rounding can make the visible region pinch at a vertex, then the eye is within
+	// tolerance of the hull anyway, so it goes with the points within tolerance of the triangle instead
+	bool isHorizonLoop = !m_horizonHalfEdges.empty();
+	for (int halfEdge : m_horizonHalfEdges) {
+		int& nextByVertex = m_horizonNextByVertex[m_triangleVertexes[halfEdge]];
+		if (nextByVertex != CONVEX_HULL_INVALID_INDEX) isHorizonLoop = false;
+		nextByVertex = halfEdge;
+	}
+	int horizonCount = (int)m_horizonHalfEdges.size();
+	if (isHorizonLoop) {
+		int halfEdge = m_horizonHalfEdges[0];
+		for (int horizonIndex = 0; horizonIndex < horizonCount; horizonIndex++) {
+			m_horizonHalfEdges[horizonIndex] = halfEdge;
+			halfEdge = m_horizonNextByVertex[m_triangleVertexes[GetNextHalfEdge(halfEdge)]];
+			if (halfEdge == CONVEX_HULL_INVALID_INDEX) {
+				isHorizonLoop = false;
+				break;
+			}
+		}
+		isHorizonLoop = isHorizonLoop && (halfEdge == m_horizonHalfEdges[0]);
+	}
+	for (int visibleTriangle : m_visibleTriangles) {
+		for (int halfEdge = visibleTriangle * 3; halfEdge < ((visibleTriangle * 3) + 3); halfEdge++) {
+			m_horizonNextByVertex[m_triangleVertexes[halfEdge]] = CONVEX_HULL_INVALID_INDEX;
+		}
+	}
+
+	if (!isHorizonLoop) {
+		for (int visibleTriangle : m_visibleTriangles) {
+			m_triangleStates[visibleTriangle] = TRIANGLE_ON_HULL;
+		}
+		int* outsidePoint = &m_triangleOutsideHeads[triangleIndex];
+		while (*outsidePoint != eyePoint) {
+			outsidePoint = &m_nextOutsidePoints[*outsidePoint];
+		}
+		*outsidePoint = m_nextOutsidePoints[eyePoint];
+		m_nextOutsidePoints[eyePoint] = m_triangleCoplanarHeads[triangleIndex];
+		m_triangleCoplanarHeads[triangleIndex] = eyePoint;
+		return false;
+	}
+
+	// Points outside or within tolerance of the triangles about to go are handed to the new ones
+	m_orphanPoints.clear();
+	for (int visibleTriangle : m_visibleTriangles) {
+		for (int pointIndex = m_triangleOutsideHeads[visibleTriangle]; pointIndex != CONVEX_HULL_INVALID_INDEX; pointIndex = m_nextOutsidePoints[pointIndex]) {
+			if (pointIndex != eyePoint) {
+				m_orphanPoints.push_back(pointIndex);
+			}
+		}
+		for (int pointIndex = m_triangleCoplanarHeads[visibleTriangle]; pointIndex != CONVEX_HULL_INVALID_INDEX; pointIndex = m_nextOutsidePoints[pointIndex]) {
+			m_orphanPoints.push_back(pointIndex);
+		}
+	}
+
+	// A fan from the eye to the horizon. Visible triangles are still in the arena here, their slots are recycled after
+	m_newTriangles.clear();
+	for (int horizonHalfEdge : m_horizonHalfEdges) {
+		int startVertex = m_triangleVertexes[horizonHalfEdge];
+		int endVertex = m_triangleVertexes[GetNextHalfEdge(horizonHalfEdge)];
+		int outerHalfEdge = m_triangleTwins[horizonHalfEdge];
+		int newTriangle = AddTriangle(startVertex, endVertex, eyePoint);
+		LinkHalfEdges(newTriangle * 3, outerHalfEdge);
+		m_newTriangles.push_back(newTriangle);
+	}
+	for (int horizonIndex = 0; horizonIndex < horizonCount; horizonIndex++) {
+		int newTriangle = m_newTriangles[horizonIndex];
+		int nextNewTriangle = m_newTriangles[(horizonIndex + 1) % horizonCount];
+		LinkHalfEdges((newTriangle * 3) + 1, (nextNewTriangle * 3) + 2);
+	}
+
+	for (int visibleTriangle : m_visibleTriangles) {
+		RemoveTriangle(visibleTriangle);
+	}
+	for (int orphanPoint : m_orphanPoints) {
+		AssignOutsidePoint(orphanPoint, m_newTriangles.data(), horizonCount);
+	}
+
+	// A new triangle can lean in past the horizon by rounding, and on a thin hull that cuts off points within tolerance of
+	// the triangles around the horizon a long way out. Those points are checked again, turning around every horizon vertex
+	// from the triangle beyond its edge until the fan is reached
+	m_orphanPoints.clear();
+	for (int horizonIndex = 0; horizonIndex < horizonCount; horizonIndex++) {
+		int newTriangle = m_newTriangles[horizonIndex];
+		int previousNewTriangle = m_newTriangles[(horizonIndex + horizonCount - 1) % horizonCount];
+		int aroundHalfEdge = m_triangleTwins[newTriangle * 3];
+		while (m_triangleVertexes[((aroundHalfEdge / 3) * 3) + 2] != eyePoint) {
+			int* coplanarPoint = &m_triangleCoplanarHeads[aroundHalfEdge / 3];
+			while (*coplanarPoint != CONVEX_HULL_INVALID_INDEX) {
+				int pointIndex = *coplanarPoint;
+				if ((GetDistanceToTrianglePlane(newTriangle, pointIndex) > m_tolerance) || (GetDistanceToTrianglePlane(previousNewTriangle, pointIndex) > m_tolerance)) {
+					*coplanarPoint = m_nextOutsidePoints[pointIndex];
+					m_orphanPoints.push_back(pointIndex);
+				}
+				else {
+					coplanarPoint = &m_nextOutsidePoints[pointIndex];
+				}
+			}
+			aroundHalfEdge = m_triangleTwins[GetNextHalfEdge(aroundHalfEdge)];
+		}
+	}
+	for (int orphanPoint : m_orphanPoints) {
+		AssignOutsidePoint(orphanPoint, m_newTriangles.data(), horizonCount);
+	}
+	m_pendingTriangles.insert(m_pendingTriangles.end(), m_newTriangles.begin(), m_newTriangles.end());
+	return true;
+}
+
+void ConvexHull3D::BuildOutput()
+{
+	// Group triangles in the same plane as the first one of the group, flooding across edges
+	int triangleSlotCount = (int)m_triangleStates.size();
+	std::vector<int> triangleGroups(triangleSlotCount, CONVEX_HULL_INVALID_INDEX);
+	std::vector<int> groupTriangles;
+	std::vector<int> groupFirstTriangles;
+	for (int seedTriangle = 0; seedTriangle < triangleSlotCount; seedTriangle++) {
+		if ((m_triangleStates[seedTriangle] != TRIANGLE_ON_HULL) || (triangleGroups[seedTriangle] != CONVEX_HULL_INVALID_INDEX)) continue;
+
+		int groupIndex = (int)groupFirstTriangles.size();
+		groupFirstTriangles.push_back(seedTriangle);
+		Plane3D const& seedPlane = m_trianglePlanes[seedTriangle];
+		triangleGroups[seedTriangle] = groupIndex;
+		groupTriangles.clear();
+		groupTriangles.push_back(seedTriangle);
+		for (int groupIndexInList = 0; groupIndexInList < (int)groupTriangles.size(); groupIndexInList++) {
+			int triangle = groupTriangles[groupIndexInList];
+			for (int halfEdge = triangle * 3; halfEdge < ((triangle * 3) + 3); halfEdge++) {
+				int twin = m_triangleTwins[halfEdge];
+				int neighbour = twin / 3;
+				if (triangleGroups[neighbour] != CONVEX_HULL_INVALID_INDEX) continue;
+				if (DotProduct3D(m_trianglePlanes[neighbour].m_planeNormal, seedPlane.m_planeNormal) < 0.0f) continue;
+
+				Vec3 const& oppositePoint = m_points[m_triangleVertexes[GetPrevHalfEdge(twin)]];
+				if (fabsf(DotProduct3D(seedPlane.m_planeNormal, oppositePoint) - seedPlane.m_distToPlane) > m_tolerance) continue;
+
+				triangleGroups[neighbour] = groupIndex;
+				groupTriangles.push_back(neighbour);
+			}
+		}
+	}
+
+	// Walk the border of every group. A vertex between two border edges shared with the same neighbour face is in the
+	// middle of a straight edge of both faces, so it is left out of both
+	std::vector<int> pointToVertex(m_points.size(), CONVEX_HULL_INVALID_INDEX);
+	std::vector<int> borderHalfEdges;
+	std::vector<Vec3 const*> faceVertexes;
+	std::unordered_map<unsigned long long, int> halfEdgesByVertexes;
+	for (int groupIndex = 0; groupIndex < (int)groupFirstTriangles.size(); groupIndex++) {
+		int groupFirstTriangle = groupFirstTriangles[groupIndex];
+		int startHalfEdge = CONVEX_HULL_INVALID_INDEX;
+		for (int triangle = groupFirstTriangle; (triangle < triangleSlotCount) && (startHalfEdge == CONVEX_HULL_INVALID_INDEX); triangle++) {
+			if (triangleGroups[triangle] != groupIndex) continue;
+			for (int halfEdge = triangle * 3; halfEdge < ((triangle * 3) + 3); halfEdge++) {
+				if (triangleGroups[m_triangleTwins[halfEdge] / 3] != groupIndex) {
+					startHalfEdge = halfEdge;
+					break;
+				}
+			}
+		}
+		if (startHalfEdge == CONVEX_HULL_INVALID_INDEX) continue;
+
+		borderHalfEdges.clear();
+		int halfEdge = startHalfEdge;
+		do {
+			borderHalfEdges.push_back(halfEdge);
+			halfEdge = GetNextHalfEdge(halfEdge);
+			while (triangleGroups[m_triangleTwins[halfEdge] / 3] == groupIndex) {
+				halfEdge = GetNextHalfEdge(m_triangleTwins[halfEdge]);
+			}
+		} while ((halfEdge != startHalfEdge) && ((int)borderHalfEdges.size() <= (3 * triangleSlotCount)));
+
+		int borderCount = (int)borderHalfEdges.size();
+		int faceIndex = (int)m_faces.size();
+		int firstHalfEdge = (int)m_halfEdges.size();
+		for (int borderIndex = 0; borderIndex < borderCount; borderIndex++) {
+			int incomingHalfEdge = borderHalfEdges[(borderIndex + borderCount - 1) % borderCount];
+			int outgoingHalfEdge = borderHalfEdges[borderIndex];
+			int incomingNeighbourGroup = triangleGroups[m_triangleTwins[incomingHalfEdge] / 3];
+			int outgoingNeighbourGroup = triangleGroups[m_triangleTwins[outgoingHalfEdge] / 3];
+			if (incomingNeighbourGroup == outgoingNeighbourGroup) continue;
+
+			int pointIndex = m_triangleVertexes[outgoingHalfEdge];
+			if (pointToVertex[pointIndex] == CONVEX_HULL_INVALID_INDEX) {
+				pointToVertex[pointIndex] = (int)m_vertexes.size();
+				m_vertexes.push_back(m_points[pointIndex]);
+			}
+			ConvexHull3DHalfEdge faceHalfEdge;
+			faceHalfEdge.m_vertex = pointToVertex[pointIndex];
+			faceHalfEdge.m_next = (int)m_halfEdges.size() + 1;
+			faceHalfEdge.m_face = faceIndex;
+			m_halfEdges.push_back(faceHalfEdge);
+		}
+
+		int halfEdgeCount = (int)m_halfEdges.size() - firstHalfEdge;
+		if (halfEdgeCount < 3) {
+			m_halfEdges.resize(firstHalfEdge);
+			continue;
+		}
+		m_halfEdges.back().m_next = firstHalfEdge;
+
+		for (int faceHalfEdge = firstHalfEdge; faceHalfEdge < (int)m_halfEdges.size(); faceHalfEdge++) {
+			int vertexIndex = m_halfEdges[faceHalfEdge].m_vertex;
+			halfEdgesByVertexes[GetEdgeKey(vertexIndex, m_halfEdges[m_halfEdges[faceHalfEdge].m_next].m_vertex)] = faceHalfEdge;
+		}
+
+		// The plane is fit to the whole border, the vertexes left out in the middle of edges included. The corners alone can
+		// be a sliver whose normal tips over, and on a thin hull that puts points far across it outside the plane
+		faceVertexes.clear();
+		for (int borderHalfEdge : borderHalfEdges) {
+			faceVertexes.push_back(&m_points[m_triangleVertexes[borderHalfEdge]]);
+		}
+
+		ConvexHull3DFace face;
+		face.m_plane = ComputePolygonPlane(faceVertexes.data(), borderCount);
+		face.m_firstHalfEdge = firstHalfEdge;
+		face.m_halfEdgeCount = halfEdgeCount;
+		m_faces.push_back(face);
+	}
+
+	for (ConvexHull3DHalfEdge& halfEdge : m_halfEdges) {
+		std::unordered_map<unsigned long long, int>::const_iterator twin = halfEdgesByVertexes.find(GetEdgeKey(m_halfEdges[halfEdge.m_next].m_vertex, halfEdge.m_vertex));
+		halfEdge.m_twin = (twin != halfEdgesByVertexes.end()) ? twin->second : CONVEX_HULL_INVALID_INDEX;
+	}
+
+	m_points.clear();
+	m_triangleVertexes.clear();
+	m_triangleTwins.clear();
+	m_trianglePlanes.clear();
+	m_triangleOutsideHeads.clear();
+	m_triangleCoplanarHeads.clear();
+	m_triangleStates.clear();
+	m_freeTriangles.clear();
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "Engine/Math/Plane3D.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include <vector>
+
+constexpr int CONVEX_HULL_INVALID_INDEX = -1;
+
+struct ConvexHull3DHalfEdge {
+	int m_vertex = CONVEX_HULL_INVALID_INDEX; // Where the half edge starts
+	int m_twin = CONVEX_HULL_INVALID_INDEX; // Same edge going the other way, in the neighbour face
+	int m_next = CONVEX_HULL_INVALID_INDEX; // Counterclockwise around the face seen from outside
+	int m_face = CONVEX_HULL_INVALID_INDEX;
+};
+
+struct ConvexHull3DFace {
+	Plane3D m_plane; // Normal pointing out of the hull
+	int m_firstHalfEdge = CONVEX_HULL_INVALID_INDEX;
+	int m_halfEdgeCount = 0;
+};
+
+/// <summary>
+/// Convex hull of a point cloud, built with QuickHull. Faces start as the 4 triangles of a tetrahedron, then the point
+/// farthest outside a face is added at a time: faces it sees are removed and the hole is closed with a fan of triangles to
+/// the horizon. Points closer than the tolerance to a face count as on it, the tolerance grows with the coordinates
+/// so float rounding never makes a point flip between sides. Triangles in the same plane within tolerance are merged into
+/// convex polygon faces at the end, so a box has 6 faces and 8 vertexes.
+///
+/// Faces and half edges are the output: every face lists its half edges with m_next, every half edge has a twin, and
+/// vertexes are only the points on the hull, renumbered
+/// </summary>
+class ConvexHull3D {
+public:
+	ConvexHull3D() = default;
+	explicit ConvexHull3D(std::vector<Vec3> const& points);
+
+	// False and an empty hull when there are fewer than 4 points or they are all coplanar within tolerance
+	bool Build(std::vector<Vec3> const& points);
+
+	bool IsValid() const { return !m_faces.empty(); }
+	std::vector<Vec3> const& GetVertexes() const { return m_vertexes; }
+	std::vector<ConvexHull3DFace> const& GetFaces() const { return m_faces; }
+	std::vector<ConvexHull3DHalfEdge> const& GetHalfEdges() const { return m_halfEdges; }
+	int GetFaceCount() const { return (int)m_faces.size(); }
+	float GetTolerance() const { return m_tolerance; }
+
+	void GetFaceVertexes(int faceIndex, std::vector<Vec3>& outCCWVertexes) const;
+	// Fans every face into triangles, counterclockwise from outside, 3 vertex indexes each
+	void GetTriangleIndexes(std::vector<int>& outIndexes) const;
+
+	bool IsPointInside(Vec3 const& point, float tolerance = 0.0f) const;
+	Vec3 const GetSupportPoint(Vec3 const& direction) const;
+
+private:
+	void Clear();
+	bool BuildInitialTetrahedron();
+	int AddTriangle(int pointA, int pointB, int pointC);
+	void RemoveTriangle(int triangleIndex);
+	void LinkHalfEdges(int halfEdgeA, int halfEdgeB);
+	float GetDistanceToTrianglePlane(int triangleIndex, int pointIndex) const;
+	void AssignOutsidePoint(int pointIndex, int const* triangles, int triangleCount);
+	bool AddPointToHull(int triangleIndex);
+	void BuildOutput();
+
+private:
+	std::vector<Vec3> m_vertexes;
+	std::vector<ConvexHull3DFace> m_faces;
+	std::vector<ConvexHull3DHalfEdge> m_halfEdges;
+	float m_tolerance = 0.0f;
+
+	// Triangle arena, only used while building. Triangle t owns half edges 3t, 3t + 1 and 3t + 2, removed triangles are
+	// recycled from m_freeTriangles, and every scratch buffer keeps its memory between builds
+	std::vector<Vec3> m_points;
+	std::vector<int> m_triangleVertexes;
+	std::vector<int> m_triangleTwins;
+	std::vector<Plane3D> m_trianglePlanes;
+	std::vector<int> m_triangleOutsideHeads; // First point of the linked list of points outside each triangle
+	std::vector<int> m_triangleCoplanarHeads; // Same for points within tolerance of its plane
+	std::vector<unsigned char> m_triangleStates;
+	std::vector<int> m_freeTriangles;
+	std::vector<int> m_pendingTriangles;
+	std::vector<int> m_nextOutsidePoints; // Next point in the same outside or coplanar list
+	std::vector<int> m_visibleTriangles;
+	std::vector<int> m_horizonHalfEdges;
+	std::vector<int> m_horizonNextByVertex;
+	std::vector<int> m_newTriangles;
+	std::vector<int> m_orphanPoints;
+};
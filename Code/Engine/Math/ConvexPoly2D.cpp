@@ -4,6 +4,7 @@
 #include "Engine/Math/FloatRange.hpp"
 #include "Engine/Math/ConvexHull2D.hpp"
 #include "Engine/Math/Plane2D.hpp"
+#include "Engine/Math/GeometricPredicates.hpp"
 #include "Engine/Core/BufferUtils.hpp"
 #include <algorithm>
 
@@ -11,6 +12,7 @@ DelaunayConvexPoly2D::DelaunayConvexPoly2D(std::vector<Vec2> vertexes) :
 	m_vertexes(vertexes)
 {
 	CalculateMiddlePoint();
+	RefreshEdgePlanes();
 }
 
 void DelaunayConvexPoly2D::Translate(Vec2 const& translation)
@@ -21,6 +23,11 @@ void DelaunayConvexPoly2D::Translate(Vec2 const& translation)
 	}
 
 	m_middlePoint += translation;
+
+	// Normals don't change, only how far the planes are
+	for (Plane2D& edgePlane : m_edgePlanes) {
+		edgePlane.m_distToPlane += DotProduct2D(edgePlane.m_planeNormal, translation);
+	}
 }
 
 void DelaunayConvexPoly2D::Rotate(float degrees)
@@ -32,6 +39,8 @@ void DelaunayConvexPoly2D::Rotate(float degrees)
 		dispFromMiddle.RotateDegrees(degrees);
 		vertex = m_middlePoint + dispFromMiddle;
 	}
+
+	RefreshEdgePlanes();
 }
 
 DelaunayConvexPoly2D const DelaunayConvexPoly2D::GetRotated(float degrees)
@@ -117,7 +126,7 @@ bool DelaunayConvexPoly2D::operator==(DelaunayConvexPoly2D const& compareTo) con
 FloatRange const DelaunayConvexPoly2D::ProjectOntoAxis(Vec2 const& normalizedAxis, Vec2 const& origin) const
 {
 	float min = FLT_MAX;
-	float max = FLT_MIN;
+	float max = -FLT_MAX;
 
 	for (int vertexPointInd = 0; vertexPointInd < m_vertexes.size(); vertexPointInd++) {
 		Vec2 const& vertex = m_vertexes[vertexPointInd];
@@ -137,6 +146,37 @@ FloatRange const DelaunayConvexPoly2D::ProjectOntoAxis(Vec2 const& normalizedAxi
 	return FloatRange(min, max);
 }
 
+void DelaunayConvexPoly2D::RefreshEdgePlanes()
+{
+	int vertexCount = (int)m_vertexes.size();
+	m_edgePlanes.resize(vertexCount);
+	m_boundingRadius = 0.0f;
+	if (vertexCount < 2) return;
+
+	for (int vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++) {
+		Vec2 const& vertex = m_vertexes[vertexIndex];
+		Vec2 const& nextVertex = m_vertexes[(vertexIndex + 1) % vertexCount];
+
+		Plane2D& edgePlane = m_edgePlanes[vertexIndex];
+		edgePlane.m_planeNormal = (nextVertex - vertex).GetNormalized().GetRotated90Degrees();
+		edgePlane.m_distToPlane = DotProduct2D(edgePlane.m_planeNormal, vertex);
+
+		float distToMiddle = GetDistance2D(vertex, m_middlePoint);
+		if (distToMiddle > m_boundingRadius) {
+			m_boundingRadius = distToMiddle;
+		}
+	}
+
+	// Winding is not guaranteed for these polygons. Normals are flipped when they face the middle point, so they always point out
+	Plane2D const& firstPlane = m_edgePlanes[0];
+	if ((DotProduct2D(firstPlane.m_planeNormal, m_middlePoint) - firstPlane.m_distToPlane) > 0.0f) {
+		for (Plane2D& edgePlane : m_edgePlanes) {
+			edgePlane.m_planeNormal = -edgePlane.m_planeNormal;
+			edgePlane.m_distToPlane = -edgePlane.m_distToPlane;
+		}
+	}
+}
+
 std::vector<ConvexPoly2DEdge> const DelaunayConvexPoly2D::GetEdges() const
 {
 	std::vector<ConvexPoly2DEdge> edges;
@@ -176,6 +216,8 @@ void DelaunayConvexPoly2D::PurgeIdenticalVertexes(float distTolerance)
 			}
 		}
 	}
+
+	RefreshEdgePlanes();
 }
 
 /*
@@ -185,6 +227,7 @@ void DelaunayConvexPoly2D::PurgeIdenticalVertexes(float distTolerance)
 ConvexPoly2D::ConvexPoly2D(std::vector<Vec2> const& ccwPoints)
 {
 	m_ccwPoints.insert(m_ccwPoints.begin(),ccwPoints.begin(), ccwPoints.end());
+	RefreshConvexHull();
 }
 
 Vec2 const ConvexPoly2D::GetCenter() const
@@ -222,6 +265,7 @@ void ConvexPoly2D::RotateAroundPoint(Vec2 const& refPoint, float deltaAngle) {
 		point = refPoint + dispToPoint;
 	}
 
+	RefreshConvexHull();
 }
 
 void ConvexPoly2D::ScaleAroundPoint(Vec2 const& refPoint, float scale) {
@@ -232,6 +276,7 @@ void ConvexPoly2D::ScaleAroundPoint(Vec2 const& refPoint, float scale) {
 		point = refPoint + dispToPoint;
 	}
 
+	RefreshConvexHull();
 }
 
 void ConvexPoly2D::Translate(Vec2 const& displacement)
@@ -239,12 +284,17 @@ void ConvexPoly2D::Translate(Vec2 const& displacement)
 	for (Vec2& point : m_ccwPoints) {
 		point += displacement;
 	}
+
+	for (Plane2D& plane : m_convexHull.m_planes) {
+		plane.m_distToPlane += DotProduct2D(plane.m_planeNormal, displacement);
+	}
+	m_boundingDiscCenter += displacement;
 }
 
 AABB2 ConvexPoly2D::GetBoundingBox() const
 {
 	Vec2 mins = Vec2(FLT_MAX, FLT_MAX);
-	Vec2 maxs = Vec2(FLT_MIN, FLT_MIN);
+	Vec2 maxs = Vec2(-FLT_MAX, -FLT_MAX);
 
 	for (Vec2 const& point : m_ccwPoints) {
 		if (point.x < mins.x) {
@@ -277,37 +327,105 @@ void ConvexPoly2D::WritePolyToBuffer(std::vector<unsigned char>& buffer) const
 
 }
 
-ConvexHull2D ConvexPoly2D::GetConvexHull() const
+void ConvexPoly2D::RefreshConvexHull()
 {
-	ConvexHull2D asConvexHull;
+	int pointCount = (int)m_ccwPoints.size();
+	m_convexHull.m_planes.resize(pointCount);
 
-	for (int pointIndex = 0; pointIndex < (m_ccwPoints.size() - 1); pointIndex++) {
-		Vec2 pointOne = m_ccwPoints[pointIndex];
-		int nextPoint = pointIndex+1;
-		Vec2 pointTwo = m_ccwPoints[nextPoint];
+	for (int pointIndex = 0; pointIndex < pointCount; pointIndex++) {
+		Vec2 const& pointOne = m_ccwPoints[pointIndex];
+		Vec2 const& pointTwo = m_ccwPoints[(pointIndex + 1) % pointCount];
 
-		Vec2 dispBetPoints = pointTwo - pointOne;
-		Vec2 normal = dispBetPoints.GetRotatedMinus90Degrees().GetNormalized();
+		Plane2D& plane = m_convexHull.m_planes[pointIndex];
+		plane.m_planeNormal = (pointTwo - pointOne).GetRotatedMinus90Degrees().GetNormalized();
+		plane.m_distToPlane = DotProduct2D(pointOne, plane.m_planeNormal);
+	}
 
-		Plane2D newPlane;
-		newPlane.m_planeNormal = normal;
-		newPlane.m_distToPlane = DotProduct2D(pointOne, normal);
+	m_boundingDiscRadius = (pointCount > 0) ? GetBoudingDisc(m_boundingDiscCenter) : 0.0f;
+}
 
-		asConvexHull.m_planes.push_back(newPlane);
+namespace {
+	struct QuickHull2DTask {
+		int m_startIndex = 0; // Hull edge from this point...
+		int m_endIndex = 0; // ...to this one, with the candidates strictly to its right
+		int m_candidatesBegin = 0;
+		int m_candidatesEnd = 0; // m_candidatesBegin == m_candidatesEnd and m_endIndex < 0 emits m_startIndex instead
+	};
 
+	bool IsPointRightOfLine(std::vector<Vec2> const& points, int lineStart, int lineEnd, int pointIndex)
+	{
+		return Orient2D(points[lineStart], points[lineEnd], points[pointIndex]) < 0.0;
 	}
+}
 
-	Vec2 firstPoint = m_ccwPoints[0];
-	Vec2 lastPoint = m_ccwPoints[m_ccwPoints.size() - 1];
+ConvexPoly2D const ConvexPoly2D::CreateConvexHullOfPoints(std::vector<Vec2> const& points)
+{
+	int pointCount = (int)points.size();
+	if (pointCount < 3) return ConvexPoly2D();
+
+	// Lowest and highest in x then y are always on the hull, the line between them splits the rest in two chains
+	int minIndex = 0;
+	int maxIndex = 0;
+	for (int pointIndex = 1; pointIndex < pointCount; pointIndex++) {
+		Vec2 const& point = points[pointIndex];
+		if ((point.x < points[minIndex].x) || ((point.x == points[minIndex].x) && (point.y < points[minIndex].y))) minIndex = pointIndex;
+		if ((point.x > points[maxIndex].x) || ((point.x == points[maxIndex].x) && (point.y > points[maxIndex].y))) maxIndex = pointIndex;
+	}
+	if (points[minIndex] == points[maxIndex]) return ConvexPoly2D();
 
-	Vec2 dispBetPoints = firstPoint - lastPoint;
-	Vec2 normal = dispBetPoints.GetRotatedMinus90Degrees().GetNormalized();
-	Plane2D lastPlane;
+	std::vector<int> candidates;
+	candidates.reserve(pointCount);
+	for (int pointIndex = 0; pointIndex < pointCount; pointIndex++) {
+		candidates.push_back(pointIndex);
+	}
+	std::vector<int>::iterator lowerEnd = std::partition(candidates.begin(), candidates.end(), [&](int pointIndex) { return IsPointRightOfLine(points, minIndex, maxIndex, pointIndex); });
+	std::vector<int>::iterator upperEnd = std::partition(lowerEnd, candidates.end(), [&](int pointIndex) { return IsPointRightOfLine(points, maxIndex, minIndex, pointIndex); });
+	int lowerCount = (int)(lowerEnd - candidates.begin());
+	int upperCount = (int)(upperEnd - lowerEnd);
+	if ((lowerCount + upperCount) == 0) return ConvexPoly2D();
+
+	// Depth first with an explicit stack, recursing could go as deep as the hull has vertexes. Tasks are popped in
+	// counterclockwise order: lower chain from min to max, then upper chain back to min
+	std::vector<QuickHull2DTask> tasks;
+	tasks.push_back({ maxIndex, minIndex, lowerCount, lowerCount + upperCount });
+	tasks.push_back({ maxIndex, -1, 0, 0 });
+	tasks.push_back({ minIndex, maxIndex, 0, lowerCount });
+	tasks.push_back({ minIndex, -1, 0, 0 });
+
+	std::vector<Vec2> ccwPoints;
+	while (!tasks.empty()) {
+		QuickHull2DTask task = tasks.back();
+		tasks.pop_back();
+		if (task.m_endIndex < 0) {
+			ccwPoints.push_back(points[task.m_startIndex]);
+			continue;
+		}
+		if (task.m_candidatesBegin == task.m_candidatesEnd) continue;
+
+		// Farthest from the edge, the estimated magnitude is enough to pick it, signs are exact
+		int farthestIndex = candidates[task.m_candidatesBegin];
+		double farthestOrientation = 0.0;
+		for (int candidate = task.m_candidatesBegin; candidate < task.m_candidatesEnd; candidate++) {
+			int pointIndex = candidates[candidate];
+			double orientation = Orient2D(points[task.m_startIndex], points[task.m_endIndex], points[pointIndex]);
+			if (orientation < farthestOrientation) {
+				farthestOrientation = orientation;
+				farthestIndex = pointIndex;
+			}
+		}
 
-	lastPlane.m_planeNormal = normal;
-	lastPlane.m_distToPlane = DotProduct2D(firstPoint, normal);
-	asConvexHull.m_planes.push_back(lastPlane);
+		// Whatever is inside the triangle start, farthest, end is dropped
+		std::vector<int>::iterator rangeBegin = candidates.begin() + task.m_candidatesBegin;
+		std::vector<int>::iterator rangeEnd = candidates.begin() + task.m_candidatesEnd;
+		std::vector<int>::iterator firstEnd = std::partition(rangeBegin, rangeEnd, [&](int pointIndex) { return IsPointRightOfLine(points, task.m_startIndex, farthestIndex, pointIndex); });
+		std::vector<int>::iterator secondEnd = std::partition(firstEnd, rangeEnd, [&](int pointIndex) { return IsPointRightOfLine(points, farthestIndex, task.m_endIndex, pointIndex); });
+		int firstEndIndex = (int)(firstEnd - candidates.begin());
+		int secondEndIndex = (int)(secondEnd - candidates.begin());
+
+		tasks.push_back({ farthestIndex, task.m_endIndex, firstEndIndex, secondEndIndex });
+		tasks.push_back({ farthestIndex, -1, 0, 0 });
+		tasks.push_back({ task.m_startIndex, farthestIndex, task.m_candidatesBegin, firstEndIndex });
+	}
 
-	return asConvexHull;
+	return ConvexPoly2D(ccwPoints);
 }
-
@@ -1,5 +1,6 @@
 #pragma once
 #include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/ConvexHull2D.hpp"
 #include <vector>
 
 struct AABB2;
@@ -7,8 +8,6 @@ struct FloatRange;
 struct Vertex_PCU;
 struct Rgba8;
 
-class ConvexHull2D;
-
 struct ConvexPoly2DEdge {
 	ConvexPoly2DEdge(Vec2 const& pointOne, Vec2 const& pointTwo) : m_pointOne(pointOne), m_pointTwo(pointTwo) {}
 	Vec2 m_pointOne = Vec2::ZERO;
@@ -37,6 +36,12 @@ public:
 	FloatRange const ProjectOntoAxis(Vec2 const& normalizedAxis, Vec2 const& origin) const;
 
 	std::vector<ConvexPoly2DEdge> const GetEdges() const;
+
+	// Outward edge planes (edge i goes from vertex i to i + 1) and a disc around the middle point enclosing every vertex.
+	// Kept in sync by the member functions, call RefreshEdgePlanes after editing m_vertexes directly
+	std::vector<Plane2D> const& GetEdgePlanes() const { return m_edgePlanes; }
+	float GetBoundingRadius() const { return m_boundingRadius; }
+	void RefreshEdgePlanes();
 public:
 	std::vector<Vec2> m_vertexes;
 	Vec2 m_middlePoint = Vec2::ZERO;
@@ -44,6 +49,9 @@ public:
 private:
 	void CalculateMiddlePoint();
 
+	std::vector<Plane2D> m_edgePlanes;
+	float m_boundingRadius = 0.0f;
+
 };
 
 
@@ -51,10 +59,17 @@ class ConvexPoly2D {
 public:
 	ConvexPoly2D() = default;
 	ConvexPoly2D(std::vector<Vec2> const& ccwPoints);
+	// QuickHull of any point cloud. Orientation tests are exact, so points on an edge of the hull are never kept as vertexes.
+	// Empty when there are fewer than 3 points or they are all collinear
+	static ConvexPoly2D const CreateConvexHullOfPoints(std::vector<Vec2> const& points);
 	Vec2 const GetCenter() const;
 	float GetBoudingDisc(Vec2& discCenter);
 
-	ConvexHull2D GetConvexHull() const;
+	// Planes are kept in sync with the points, so this never rebuilds the hull
+	ConvexHull2D const& GetConvexHull() const { return m_convexHull; }
+	std::vector<Vec2> const& GetPoints() const { return m_ccwPoints; }
+	Vec2 const& GetBoundingDiscCenter() const { return m_boundingDiscCenter; }
+	float GetBoundingDiscRadius() const { return m_boundingDiscRadius; }
 	void RotateAroundPoint(Vec2 const& refPoint, float deltaAngle);
 	void ScaleAroundPoint(Vec2 const& refPoint, float scale);
 	void Translate(Vec2 const& displacement);
@@ -64,7 +79,13 @@ public:
 	AABB2 GetBoundingBox() const;
 
 	void WritePolyToBuffer(std::vector<unsigned char>& buffer) const;
+private:
+	void RefreshConvexHull();
+
 private:
 	std::vector<Vec2> m_ccwPoints;
+	ConvexHull2D m_convexHull;
+	Vec2 m_boundingDiscCenter = Vec2::ZERO;
+	float m_boundingDiscRadius = 0.0f;
 
 };
\ No newline at end of file
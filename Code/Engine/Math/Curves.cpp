@@ -2,48 +2,83 @@
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/Rgba8.hpp"
 #include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Math/SIMDUtils.hpp"
+#include <algorithm>
+
+namespace {
+	double GetBinomialCoefficient(int n, int k)
+	{
+		double coefficient = 1.0;
+		for (int index = 1; index <= k; index++) {
+			coefficient = (coefficient * (double)(n - k + index)) / (double)index;
+		}
+		return coefficient;
+	}
 
+	std::vector<Vec2> GetBezierPointsFromHermite(Vec2 const& startPoint, Vec2 const& startVelocity, Vec2 const& endPoint, Vec2 const& endVelocity)
+	{
+		float aThird = 1.0f / 3.0f;
+		return std::vector<Vec2>{ startPoint, startPoint + (startVelocity * aThird), endPoint - (endVelocity * aThird), endPoint };
+	}
 
-BezierCurve::BezierCurve(std::vector<Vec2> const& points) :
+	// Horner's rule, coefficients highest degree first. The pack version does the same operations in the same order, so both
+	// return the same bits
+	inline Vec2 const EvaluatePolynomial(Vec2 const* coefficients, int coefficientCount, float t)
+	{
+		float x = coefficients[0].x;
+		float y = coefficients[0].y;
+		for (int coefficientIndex = 1; coefficientIndex < coefficientCount; coefficientIndex++) {
+			x = (x * t) + coefficients[coefficientIndex].x;
+			y = (y * t) + coefficients[coefficientIndex].y;
+		}
+		return Vec2(x, y);
+	}
+
+	template <typename T_SimdFloat>
+	void EvaluatePolynomialPack(Vec2 const* coefficients, int coefficientCount, float const* parametrics, Vec2* outPositions)
+	{
+		T_SimdFloat t = T_SimdFloat::Load(parametrics);
+		T_SimdFloat x = T_SimdFloat::Broadcast(coefficients[0].x);
+		T_SimdFloat y = T_SimdFloat::Broadcast(coefficients[0].y);
+		for (int coefficientIndex = 1; coefficientIndex < coefficientCount; coefficientIndex++) {
+			x = (x * t) + T_SimdFloat::Broadcast(coefficients[coefficientIndex].x);
+			y = (y * t) + T_SimdFloat::Broadcast(coefficients[coefficientIndex].y);
+		}
+
+		float xs[T_SimdFloat::LANES];
+		float ys[T_SimdFloat::LANES];
+		x.Store(xs);
+		y.Store(ys);
+		for (int lane = 0; lane < T_SimdFloat::LANES; lane++) {
+			outPositions[lane] = Vec2(xs[lane], ys[lane]);
+		}
+	}
+}
+
+
+BezierCurve::BezierCurve(std::vector<Vec2> const& points, int arcLengthSubdivisions) :
 	m_points(points)
 {
+	BuildPolynomialCoefficients();
+	BuildArcLengthTable(arcLengthSubdivisions);
 }
 
-BezierCurve::BezierCurve(CubicHermitCurve const& hermitCurve)
+BezierCurve::BezierCurve(CubicHermitCurve const& hermitCurve, int arcLengthSubdivisions) :
+	BezierCurve(GetBezierPointsFromHermite(hermitCurve.m_points[0], hermitCurve.m_points[1], hermitCurve.m_points[2], hermitCurve.m_points[3]), arcLengthSubdivisions)
 {
-	m_points.resize(4);
-	float aThird = 1.0f / 3.0f;
-	m_points[0] = hermitCurve.m_points[0];
-	m_points[1] = hermitCurve.m_points[0] + (hermitCurve.m_points[1] * aThird);
-	m_points[2] = hermitCurve.m_points[2] - (hermitCurve.m_points[3] * aThird);
-	m_points[3] = hermitCurve.m_points[2];
 }
 
 Vec2 const BezierCurve::EvaluateAtParametric(float parametricZeroToOne) const
 {
-	if ((m_points.size() % 2) == 1) {
+	if (!IsValid()) {
 		ERROR_RECOVERABLE("BEZIER CURVES REQUIRE AN EVEN AMOUNT OF KEY POINTS");
 		return Vec2::ZERO;
 	}
 
-	std::vector<Vec2> currentPoints = m_points;
-	std::vector<Vec2> interpolatedPoints;
-	while (interpolatedPoints.size() != 1) {
-		interpolatedPoints.clear();
-		for (int pointIndex = 0; pointIndex < currentPoints.size(); pointIndex++) {
-			if (pointIndex != currentPoints.size() - 1) {
-				Vec2 const& pointA = currentPoints[pointIndex];
-				Vec2 const& pointB = currentPoints[(size_t)pointIndex + 1];
-
-
-				Vec2 interpolatedPoint = Interpolate(pointA, pointB, parametricZeroToOne);
-				interpolatedPoints.push_back(interpolatedPoint);
-			}
-		}
-		currentPoints = interpolatedPoints;
+	if (!m_coefficients.empty()) {
+		return EvaluatePolynomial(m_coefficients.data(), (int)m_coefficients.size(), parametricZeroToOne);
 	}
-
-	return interpolatedPoints[0];
+	return EvaluateWithDeCasteljau(parametricZeroToOne);
 }
 
 void BezierCurve::AddVertsForControlPoints(std::vector<Vertex_PCU>& verts, Rgba8 const& color, float radius, int sectionsAmount) const
@@ -63,6 +98,8 @@ void BezierCurve::AddVertsForControlPoints(std::vector<Vertex_PCU>& verts, Rgba8
 
 float BezierCurve::GetApproximateLength(int numSubdivisions) const
 {
+	if (numSubdivisions == GetArcLengthSubdivisions()) return GetLength();
+
 	float stepPerDivision = 1.0f / (float)numSubdivisions;
 	Vec2 prevLocation = EvaluateAtParametric(0.0f);
 	float distance = 0.0f;
@@ -78,6 +115,8 @@ float BezierCurve::GetApproximateLength(int numSubdivisions) const
 
 Vec2 const BezierCurve::EvaluateAtApproximateDistance(float distanceAlongCurve, int numSubdivisions) const
 {
+	if (numSubdivisions == GetArcLengthSubdivisions()) return EvaluateAtDistance(distanceAlongCurve);
+
 	float stepPerDivision = 1.0f / (float)numSubdivisions;
 	Vec2 prevLocation = m_points[0];
 	float distance = 0.0f;
@@ -98,6 +137,118 @@ Vec2 const BezierCurve::EvaluateAtApproximateDistance(float distanceAlongCurve,
 	return m_points[m_points.size() - 1];
 }
 
+float BezierCurve::GetParametricAtDistance(float distanceAlongCurve) const
+{
+	int subdivisions = GetArcLengthSubdivisions();
+	if (subdivisions < 1) return 0.0f;
+	if (distanceAlongCurve <= 0.0f) return 0.0f;
+	if (distanceAlongCurve >= m_arcLengths.back()) return 1.0f;
+
+	// First step whose cumulative length reaches the distance, the distance is then somewhere along that step
+	std::vector<float>::const_iterator stepEnd = std::lower_bound(m_arcLengths.begin() + 1, m_arcLengths.end(), distanceAlongCurve);
+	int step = (int)(stepEnd - m_arcLengths.begin());
+	float stepStartLength = m_arcLengths[(size_t)step - 1];
+	float stepLength = m_arcLengths[step] - stepStartLength;
+	float fractionOfStep = (stepLength > 0.0f) ? ((distanceAlongCurve - stepStartLength) / stepLength) : 0.0f;
+
+	return ((float)(step - 1) + fractionOfStep) / (float)subdivisions;
+}
+
+Vec2 const BezierCurve::EvaluateAtDistance(float distanceAlongCurve) const
+{
+	return EvaluateAtParametric(GetParametricAtDistance(distanceAlongCurve));
+}
+
+void BezierCurve::EvaluateAtParametrics(float const* parametricsZeroToOne, Vec2* outPositions, int count) const
+{
+	if (m_coefficients.empty()) {
+		for (int sampleIndex = 0; sampleIndex < count; sampleIndex++) {
+			outPositions[sampleIndex] = EvaluateAtParametric(parametricsZeroToOne[sampleIndex]);
+		}
+		return;
+	}
+
+	int coefficientCount = (int)m_coefficients.size();
+	int sampleIndex = 0;
+	for (; (sampleIndex + SIMD_WIDTH) <= count; sampleIndex += SIMD_WIDTH) {
+		EvaluatePolynomialPack<SimdFloatN>(m_coefficients.data(), coefficientCount, &parametricsZeroToOne[sampleIndex], &outPositions[sampleIndex]);
+	}
+	for (; sampleIndex < count; sampleIndex++) {
+		outPositions[sampleIndex] = EvaluatePolynomial(m_coefficients.data(), coefficientCount, parametricsZeroToOne[sampleIndex]);
+	}
+}
+
+void BezierCurve::EvaluateAtDistances(float const* distancesAlongCurve, Vec2* outPositions, int count) const
+{
+	float parametrics[SIMD_WIDTH];
+	for (int firstIndex = 0; firstIndex < count; firstIndex += SIMD_WIDTH) {
+		int packCount = (count - firstIndex < SIMD_WIDTH) ? (count - firstIndex) : SIMD_WIDTH;
+		for (int packIndex = 0; packIndex < packCount; packIndex++) {
+			parametrics[packIndex] = GetParametricAtDistance(distancesAlongCurve[firstIndex + packIndex]);
+		}
+		EvaluateAtParametrics(parametrics, &outPositions[firstIndex], packCount);
+	}
+}
+
+bool BezierCurve::IsValid() const
+{
+	return !m_points.empty() && ((m_points.size() % 2) == 0);
+}
+
+Vec2 const BezierCurve::EvaluateWithDeCasteljau(float parametricZeroToOne) const
+{
+	std::vector<Vec2> interpolatedPoints = m_points;
+	for (int pointCount = (int)interpolatedPoints.size() - 1; pointCount > 0; pointCount--) {
+		for (int pointIndex = 0; pointIndex < pointCount; pointIndex++) {
+			interpolatedPoints[pointIndex] = Interpolate(interpolatedPoints[pointIndex], interpolatedPoints[(size_t)pointIndex + 1], parametricZeroToOne);
+		}
+	}
+	return interpolatedPoints[0];
+}
+
+void BezierCurve::BuildArcLengthTable(int arcLengthSubdivisions)
+{
+	m_arcLengths.clear();
+	if (!IsValid() || (arcLengthSubdivisions < 1)) return;
+
+	// Same steps as GetApproximateLength, so the table's last entry is what it returns for the same subdivisions
+	float stepPerDivision = 1.0f / (float)arcLengthSubdivisions;
+	Vec2 prevLocation = EvaluateAtParametric(0.0f);
+	m_arcLengths.resize((size_t)arcLengthSubdivisions + 1);
+	m_arcLengths[0] = 0.0f;
+
+	for (int step = 1; step <= arcLengthSubdivisions; step++) {
+		Vec2 currentLocation = EvaluateAtParametric(step * stepPerDivision);
+		m_arcLengths[step] = m_arcLengths[(size_t)step - 1] + GetDistance2D(prevLocation, currentLocation);
+		prevLocation = currentLocation;
+	}
+}
+
+void BezierCurve::BuildPolynomialCoefficients()
+{
+	// Bernstein to power basis: coefficient of t^j is C(n, j) * sum over i <= j of (-1)^(j - i) * C(j, i) * P_i
+	m_coefficients.clear();
+	int degree = (int)m_points.size() - 1;
+	if (!IsValid() || (degree > BEZIER_MAX_POLYNOMIAL_DEGREE)) return;
+
+	m_coefficients.resize((size_t)degree + 1);
+	for (int power = 0; power <= degree; power++) {
+		double sumX = 0.0;
+		double sumY = 0.0;
+		for (int pointIndex = 0; pointIndex <= power; pointIndex++) {
+			double weight = GetBinomialCoefficient(power, pointIndex);
+			if (((power - pointIndex) % 2) == 1) {
+				weight = -weight;
+			}
+			sumX += weight * (double)m_points[pointIndex].x;
+			sumY += weight * (double)m_points[pointIndex].y;
+		}
+
+		double scale = GetBinomialCoefficient(degree, power);
+		m_coefficients[(size_t)degree - power] = Vec2((float)(sumX * scale), (float)(sumY * scale));
+	}
+}
+
 float ComputeCubicBezier1D(float a, float b, float c, float d, float t)
 {
 	float ab = Interpolate(a, b, t);
@@ -120,7 +271,7 @@ Vec2 const ComputeCubicBezier2D(Vec2 const& a, Vec2 const& b, Vec2 const& c, Vec
 	Vec2 abc = Interpolate(ab, bc, t);
 	Vec2 bcd = Interpolate(bc, cd, t);
 
-	Vec2 result = Interpolate(abc, abc, t);
+	Vec2 result = Interpolate(abc, bcd, t);
 	return result;
 }
 
@@ -176,36 +327,30 @@ Vec2 const ComputeQuinticBezier2D(Vec2 const& a, Vec2 const& b, Vec2 const& c, V
 	return result;
 }
 
-CubicHermitCurve::CubicHermitCurve(Vec2 const& startPoint, Vec2 const startingVelocity, Vec2 const& endPoint, Vec2 const& endVelocity)
+CubicHermitCurve::CubicHermitCurve(Vec2 const& startPoint, Vec2 const startingVelocity, Vec2 const& endPoint, Vec2 const& endVelocity) :
+	m_points{ startPoint, startingVelocity, endPoint, endVelocity },
+	m_bezierCurve(GetBezierPointsFromHermite(startPoint, startingVelocity, endPoint, endVelocity))
 {
-	m_points.push_back(startPoint);
-	m_points.push_back(startingVelocity);
-	m_points.push_back(endPoint);
-	m_points.push_back(endVelocity);
 }
 
 Vec2 const CubicHermitCurve::EvaluateAtParametric(float parametricZeroToOne) const
 {
-	BezierCurve sketchyCurve(*this);
-	return sketchyCurve.EvaluateAtParametric(parametricZeroToOne);
+	return m_bezierCurve.EvaluateAtParametric(parametricZeroToOne);
 }
 
 void CubicHermitCurve::AddVertsForControlPoints(std::vector<Vertex_PCU>& verts, Rgba8 const& color, float radius, int sectionsAmount) const
 {
-	BezierCurve sketchyCurve(*this);
-	sketchyCurve.AddVertsForControlPoints(verts, color, radius, sectionsAmount);
+	m_bezierCurve.AddVertsForControlPoints(verts, color, radius, sectionsAmount);
 }
 
 float CubicHermitCurve::GetApproximateLength(int numSubdivisions) const
 {
-	BezierCurve sketchyCurve(*this);
-	return sketchyCurve.GetApproximateLength(numSubdivisions);
+	return m_bezierCurve.GetApproximateLength(numSubdivisions);
 }
 
 Vec2 const CubicHermitCurve::EvaluateAtApproximateDistance(float distanceAlongCurve, int numSubdivisions) const
 {
-	BezierCurve sketchyCurve(*this);
-	return sketchyCurve.EvaluateAtApproximateDistance(distanceAlongCurve, numSubdivisions);
+	return m_bezierCurve.EvaluateAtApproximateDistance(distanceAlongCurve, numSubdivisions);
 }
 
 Spline2D::Spline2D(std::vector<Vec2> const& points)
@@ -227,6 +372,13 @@ Spline2D::Spline2D(std::vector<Vec2> const& points)
 		m_curves.emplace_back(points[pointIndexAsSizeT], startVelocity, points[pointIndexAsSizeT + 1], endVelocity);
 
 	}
+
+	m_curveEndDistances.reserve(m_curves.size());
+	float totalLength = 0.0f;
+	for (CubicHermitCurve const& curve : m_curves) {
+		totalLength += curve.GetLength();
+		m_curveEndDistances.push_back(totalLength);
+	}
 }
 
 Vec2 const Spline2D::EvaluateAtParametric(float parametricZeroToOne) const
@@ -261,6 +413,8 @@ void Spline2D::AddVertsForControlPoints(std::vector<Vertex_PCU>& verts, Rgba8 co
 
 float Spline2D::GetApproximateLength(int numSubdivisions) const
 {
+	if (numSubdivisions == CURVE_ARC_LENGTH_SUBDIVISIONS) return GetLength();
+
 	float totalLength = 0.0f;
 	for (int curveIndex = 0; curveIndex < m_curves.size(); curveIndex++) {
 		totalLength += m_curves[curveIndex].GetApproximateLength(numSubdivisions);
@@ -270,6 +424,8 @@ float Spline2D::GetApproximateLength(int numSubdivisions) const
 
 Vec2 const Spline2D::EvaluateAtApproximateDistance(float distanceAlongCurve, int numSubdivisions) const
 {
+	if (numSubdivisions == CURVE_ARC_LENGTH_SUBDIVISIONS) return EvaluateAtDistance(distanceAlongCurve);
+
 	float totalLength = 0.0f;
 	for (int curveIndex = 0; curveIndex < m_curves.size(); curveIndex++) {
 		float curveLength = m_curves[curveIndex].GetApproximateLength(numSubdivisions);
@@ -279,5 +435,175 @@ Vec2 const Spline2D::EvaluateAtApproximateDistance(float distanceAlongCurve, int
 		}
 		totalLength += curveLength;
 	}
-	return Vec2::ZERO;
+	return m_curves.empty() ? Vec2::ZERO : m_curves[m_curves.size() - 1].m_points[2];
+}
+
+Vec2 const Spline2D::EvaluateAtDistance(float distanceAlongSpline) const
+{
+	if (m_curves.empty()) return Vec2::ZERO;
+	if (distanceAlongSpline >= GetLength()) return m_curves[m_curves.size() - 1].m_points[2];
+
+	int curveIndex = GetCurveIndexAtDistance(distanceAlongSpline);
+	float curveStartDistance = (curveIndex > 0) ? m_curveEndDistances[(size_t)curveIndex - 1] : 0.0f;
+	return m_curves[curveIndex].EvaluateAtDistance(distanceAlongSpline - curveStartDistance);
+}
+
+void Spline2D::EvaluateAtDistances(float const* distancesAlongSpline, Vec2* outPositions, int count) const
+{
+	// Samples can land on different curves, each is a binary search and a Horner evaluation of its own
+	for (int sampleIndex = 0; sampleIndex < count; sampleIndex++) {
+		outPositions[sampleIndex] = EvaluateAtDistance(distancesAlongSpline[sampleIndex]);
+	}
+}
+
+int Spline2D::GetCurveIndexAtDistance(float distanceAlongSpline) const
+{
+	std::vector<float>::const_iterator curveEnd = std::lower_bound(m_curveEndDistances.begin(), m_curveEndDistances.end(), distanceAlongSpline);
+	int curveIndex = (int)(curveEnd - m_curveEndDistances.begin());
+	return (curveIndex < (int)m_curves.size()) ? curveIndex : ((int)m_curves.size() - 1);
+}
+
+Spline3D::Spline3D(std::vector<Vec3> const& points, Spline3DType type)
+{
+	int pointCount = (int)points.size();
+	if (type == Spline3DType::B_SPLINE) {
+		for (int pointIndex = 0; (pointIndex + 3) < pointCount; pointIndex++) {
+			AddBSplineSegment(points[pointIndex], points[(size_t)pointIndex + 1], points[(size_t)pointIndex + 2], points[(size_t)pointIndex + 3]);
+		}
+	}
+	else {
+		for (int pointIndex = 0; (pointIndex + 1) < pointCount; pointIndex++) {
+			Vec3 startVelocity = (pointIndex > 0) ? ((points[(size_t)pointIndex + 1] - points[(size_t)pointIndex - 1]) * 0.5f) : Vec3::ZERO;
+			Vec3 endVelocity = ((pointIndex + 2) < pointCount) ? ((points[(size_t)pointIndex + 2] - points[pointIndex]) * 0.5f) : Vec3::ZERO;
+			AddHermiteSegment(points[pointIndex], startVelocity, points[(size_t)pointIndex + 1], endVelocity);
+		}
+	}
+
+	BuildArcLengthTable();
+}
+
+Spline3D::Spline3D(std::vector<Vec3> const& points, std::vector<Vec3> const& velocities)
+{
+	if (points.size() != velocities.size()) {
+		ERROR_RECOVERABLE("HERMITE SPLINES REQUIRE ONE VELOCITY PER POINT");
+		return;
+	}
+
+	for (int pointIndex = 0; (pointIndex + 1) < (int)points.size(); pointIndex++) {
+		AddHermiteSegment(points[pointIndex], velocities[pointIndex], points[(size_t)pointIndex + 1], velocities[(size_t)pointIndex + 1]);
+	}
+
+	BuildArcLengthTable();
+}
+
+Vec3 const Spline3D::EvaluateAtParametric(float parametric) const
+{
+	if (m_coefficients.empty()) return Vec3::ZERO;
+
+	float t = 0.0f;
+	Vec3 const* coefficients = &m_coefficients[(size_t)GetSegmentAtParametric(parametric, t) * 4];
+	float x = (((((coefficients[0].x * t) + coefficients[1].x) * t) + coefficients[2].x) * t) + coefficients[3].x;
+	float y = (((((coefficients[0].y * t) + coefficients[1].y) * t) + coefficients[2].y) * t) + coefficients[3].y;
+	float z = (((((coefficients[0].z * t) + coefficients[1].z) * t) + coefficients[2].z) * t) + coefficients[3].z;
+	return Vec3(x, y, z);
+}
+
+Vec3 const Spline3D::EvaluateVelocityAtParametric(float parametric) const
+{
+	if (m_coefficients.empty()) return Vec3::ZERO;
+
+	float t = 0.0f;
+	Vec3 const* coefficients = &m_coefficients[(size_t)GetSegmentAtParametric(parametric, t) * 4];
+	float x = (((coefficients[0].x * 3.0f * t) + (coefficients[1].x * 2.0f)) * t) + coefficients[2].x;
+	float y = (((coefficients[0].y * 3.0f * t) + (coefficients[1].y * 2.0f)) * t) + coefficients[2].y;
+	float z = (((coefficients[0].z * 3.0f * t) + (coefficients[1].z * 2.0f)) * t) + coefficients[2].z;
+	return Vec3(x, y, z);
+}
+
+float Spline3D::GetParametricAtDistance(float distanceAlongSpline) const
+{
+	int stepCount = (int)m_arcLengths.size() - 1;
+	if (stepCount < 1) return 0.0f;
+	if (distanceAlongSpline <= 0.0f) return 0.0f;
+	if (distanceAlongSpline >= m_arcLengths.back()) return (float)GetSegmentCount();
+
+	std::vector<float>::const_iterator stepEnd = std::lower_bound(m_arcLengths.begin() + 1, m_arcLengths.end(), distanceAlongSpline);
+	int step = (int)(stepEnd - m_arcLengths.begin());
+	float stepStartLength = m_arcLengths[(size_t)step - 1];
+	float stepLength = m_arcLengths[step] - stepStartLength;
+	float fractionOfStep = (stepLength > 0.0f) ? ((distanceAlongSpline - stepStartLength) / stepLength) : 0.0f;
+
+	return ((float)(step - 1) + fractionOfStep) / (float)CURVE_ARC_LENGTH_SUBDIVISIONS;
+}
+
+Vec3 const Spline3D::EvaluateAtDistance(float distanceAlongSpline) const
+{
+	return EvaluateAtParametric(GetParametricAtDistance(distanceAlongSpline));
+}
+
+void Spline3D::EvaluateAtParametrics(float const* parametrics, Vec3* outPositions, int count) const
+{
+	for (int sampleIndex = 0; sampleIndex < count; sampleIndex++) {
+		outPositions[sampleIndex] = EvaluateAtParametric(parametrics[sampleIndex]);
+	}
+}
+
+void Spline3D::EvaluateAtDistances(float const* distancesAlongSpline, Vec3* outPositions, int count) const
+{
+	for (int sampleIndex = 0; sampleIndex < count; sampleIndex++) {
+		outPositions[sampleIndex] = EvaluateAtParametric(GetParametricAtDistance(distancesAlongSpline[sampleIndex]));
+	}
+}
+
+void Spline3D::AddHermiteSegment(Vec3 const& startPoint, Vec3 const& startVelocity, Vec3 const& endPoint, Vec3 const& endVelocity)
+{
+	m_coefficients.push_back((startPoint * 2.0f) - (endPoint * 2.0f) + startVelocity + endVelocity);
+	m_coefficients.push_back((endPoint * 3.0f) - (startPoint * 3.0f) - (startVelocity * 2.0f) - endVelocity);
+	m_coefficients.push_back(startVelocity);
+	m_coefficients.push_back(startPoint);
+}
+
+void Spline3D::AddBSplineSegment(Vec3 const& pointA, Vec3 const& pointB, Vec3 const& pointC, Vec3 const& pointD)
+{
+	float aSixth = 1.0f / 6.0f;
+	m_coefficients.push_back(((pointB * 3.0f) - pointA - (pointC * 3.0f) + pointD) * aSixth);
+	m_coefficients.push_back(((pointA * 3.0f) - (pointB * 6.0f) + (pointC * 3.0f)) * aSixth);
+	m_coefficients.push_back((pointC - pointA) * 0.5f);
+	m_coefficients.push_back((pointA + (pointB * 4.0f) + pointC) * aSixth);
+}
+
+void Spline3D::BuildArcLengthTable()
+{
+	m_arcLengths.clear();
+	int segmentCount = GetSegmentCount();
+	if (segmentCount == 0) return;
+
+	int stepCount = segmentCount * CURVE_ARC_LENGTH_SUBDIVISIONS;
+	float stepPerDivision = 1.0f / (float)CURVE_ARC_LENGTH_SUBDIVISIONS;
+	m_arcLengths.resize((size_t)stepCount + 1);
+	m_arcLengths[0] = 0.0f;
+
+	Vec3 prevLocation = EvaluateAtParametric(0.0f);
+	for (int step = 1; step <= stepCount; step++) {
+		Vec3 currentLocation = EvaluateAtParametric((float)step * stepPerDivision);
+		m_arcLengths[step] = m_arcLengths[(size_t)step - 1] + (currentLocation - prevLocation).GetLength();
+		prevLocation = currentLocation;
+	}
+}
+
+int Spline3D::GetSegmentAtParametric(float parametric, float& outSegmentParametric) const
+{
+	int segmentCount = GetSegmentCount();
+	if (parametric <= 0.0f) {
+		outSegmentParametric = 0.0f;
+		return 0;
+	}
+	if (parametric >= (float)segmentCount) {
+		outSegmentParametric = 1.0f;
+		return segmentCount - 1;
+	}
+
+	int segmentIndex = RoundDownToInt(parametric);
+	outSegmentParametric = parametric - (float)segmentIndex;
+	return segmentIndex;
 }
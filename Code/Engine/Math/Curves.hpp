@@ -1,5 +1,6 @@
 #pragma once
 #include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.hpp"
 #include  <vector>
 
 struct Vertex_PCU;
@@ -7,16 +8,45 @@ struct Rgba8;
 
 class CubicHermitCurve;
 
+constexpr int CURVE_ARC_LENGTH_SUBDIVISIONS = 64; // Default of EvaluateAtApproximateDistance too, so those calls use the table
+constexpr int BEZIER_MAX_POLYNOMIAL_DEGREE = 5; // Up to quintic, curves are evaluated with Horner's rule on precomputed coefficients
+
+/// <summary>
+/// Curves up to quintic are turned into polynomial coefficients once, and evaluating them is Horner's rule with no allocation.
+/// A table of cumulative chord lengths at arcLengthSubdivisions uniform steps of t is built with the curve, distance queries
+/// binary search it, then evaluate the curve at the t interpolated between the two steps around the distance
+/// </summary>
 class BezierCurve {
 public:
-	BezierCurve(std::vector<Vec2> const& points);
-	BezierCurve(CubicHermitCurve const& hermitCurve);
+	BezierCurve(std::vector<Vec2> const& points, int arcLengthSubdivisions = CURVE_ARC_LENGTH_SUBDIVISIONS);
+	BezierCurve(CubicHermitCurve const& hermitCurve, int arcLengthSubdivisions = CURVE_ARC_LENGTH_SUBDIVISIONS);
 	Vec2 const EvaluateAtParametric(float parametricZeroToOne) const;
 	void AddVertsForControlPoints(std::vector<Vertex_PCU>& verts, Rgba8 const& color, float radius = 0.6f, int sectionsAmount = 60) const;
+	// Uses the arc length table when numSubdivisions matches it, otherwise walks the curve numSubdivisions times
 	float GetApproximateLength(int numSubdivisions) const;
-	Vec2 const EvaluateAtApproximateDistance(float distanceAlongCurve, int numSubdivisions = 64) const;
+	Vec2 const EvaluateAtApproximateDistance(float distanceAlongCurve, int numSubdivisions = CURVE_ARC_LENGTH_SUBDIVISIONS) const;
+
+	float GetLength() const { return m_arcLengths.empty() ? 0.0f : m_arcLengths.back(); }
+	float GetParametricAtDistance(float distanceAlongCurve) const;
+	Vec2 const EvaluateAtDistance(float distanceAlongCurve) const;
+
+	// Many samples of the same curve at once, 8 at a time with AVX (4 with SSE) for curves up to quintic
+	void EvaluateAtParametrics(float const* parametricsZeroToOne, Vec2* outPositions, int count) const;
+	void EvaluateAtDistances(float const* distancesAlongCurve, Vec2* outPositions, int count) const;
+
+	std::vector<Vec2> const& GetPoints() const { return m_points; }
+	int GetArcLengthSubdivisions() const { return (int)m_arcLengths.size() - 1; }
+
+private:
+	bool IsValid() const;
+	Vec2 const EvaluateWithDeCasteljau(float parametricZeroToOne) const;
+	void BuildArcLengthTable(int arcLengthSubdivisions);
+	void BuildPolynomialCoefficients();
+
 private:
 	std::vector<Vec2> m_points;
+	std::vector<Vec2> m_coefficients; // Power basis, highest degree first. Empty above BEZIER_MAX_POLYNOMIAL_DEGREE
+	std::vector<float> m_arcLengths; // Cumulative chord length at t = index / subdivisions
 };
 
 class CubicHermitCurve {
@@ -27,9 +57,15 @@ public:
 	Vec2 const EvaluateAtParametric(float parametricZeroToOne) const;
 	void AddVertsForControlPoints(std::vector<Vertex_PCU>& verts, Rgba8 const& color, float radius = 0.6f, int sectionsAmount = 60) const;
 	float GetApproximateLength(int numSubdivisions) const;
-	Vec2 const EvaluateAtApproximateDistance(float distanceAlongCurve, int numSubdivisions = 64) const;
+	Vec2 const EvaluateAtApproximateDistance(float distanceAlongCurve, int numSubdivisions = CURVE_ARC_LENGTH_SUBDIVISIONS) const;
+
+	float GetLength() const { return m_bezierCurve.GetLength(); }
+	Vec2 const EvaluateAtDistance(float distanceAlongCurve) const { return m_bezierCurve.EvaluateAtDistance(distanceAlongCurve); }
+	BezierCurve const& GetBezierCurve() const { return m_bezierCurve; }
+
 private:
 	std::vector<Vec2> m_points;
+	BezierCurve m_bezierCurve; // Same curve, built once instead of on every call
 };
 
 
@@ -40,11 +76,60 @@ public:
 	Vec2 const EvaluateAtParametric(float parametricZeroToOne) const;
 	void AddVertsForControlPoints(std::vector<Vertex_PCU>& verts, Rgba8 const& color, float radius = 0.6f, int sectionsAmount = 60) const;
 	float GetApproximateLength(int numSubdivisions) const;
-	Vec2 const EvaluateAtApproximateDistance(float distanceAlongCurve, int numSubdivisions = 64) const;
+	Vec2 const EvaluateAtApproximateDistance(float distanceAlongCurve, int numSubdivisions = CURVE_ARC_LENGTH_SUBDIVISIONS) const;
 	int GetAmountOfCurves() const { return (int)m_curves.size(); }
 
+	// Binary search for the curve, then in the curve's arc length table. Past either end clamps to the end point
+	float GetLength() const { return m_curveEndDistances.empty() ? 0.0f : m_curveEndDistances.back(); }
+	Vec2 const EvaluateAtDistance(float distanceAlongSpline) const;
+	void EvaluateAtDistances(float const* distancesAlongSpline, Vec2* outPositions, int count) const;
+
+private:
+	int GetCurveIndexAtDistance(float distanceAlongSpline) const;
+
 private:
 	std::vector<CubicHermitCurve> m_curves;
+	std::vector<float> m_curveEndDistances; // Length of the spline up to the end of each curve
+};
+
+
+enum class Spline3DType {
+	CATMULL_ROM, // Through every point, velocities from the neighbours and zero at both ends, like Spline2D
+	B_SPLINE, // Uniform cubic B-spline, C2 smooth but only approaches its points. pointCount - 3 segments
+};
+
+/// <summary>
+/// Cubic 3D spline for camera rails and particle paths. Every segment is stored as its polynomial coefficients, whatever the
+/// spline type, so evaluating is the same Horner's rule for all of them. Parametric goes from 0 to the segment count as with
+/// Spline2D. One arc length table covers the whole spline, CURVE_ARC_LENGTH_SUBDIVISIONS steps per segment
+/// </summary>
+class Spline3D {
+public:
+	Spline3D() = default;
+	explicit Spline3D(std::vector<Vec3> const& points, Spline3DType type = Spline3DType::CATMULL_ROM);
+	// Hermite spline, one velocity per point
+	Spline3D(std::vector<Vec3> const& points, std::vector<Vec3> const& velocities);
+
+	int GetSegmentCount() const { return (int)m_coefficients.size() / 4; }
+	Vec3 const EvaluateAtParametric(float parametric) const;
+	Vec3 const EvaluateVelocityAtParametric(float parametric) const; // Derivative with respect to the parametric
+
+	float GetLength() const { return m_arcLengths.empty() ? 0.0f : m_arcLengths.back(); }
+	float GetParametricAtDistance(float distanceAlongSpline) const;
+	Vec3 const EvaluateAtDistance(float distanceAlongSpline) const;
+
+	void EvaluateAtParametrics(float const* parametrics, Vec3* outPositions, int count) const;
+	void EvaluateAtDistances(float const* distancesAlongSpline, Vec3* outPositions, int count) const;
+
+private:
+	void AddHermiteSegment(Vec3 const& startPoint, Vec3 const& startVelocity, Vec3 const& endPoint, Vec3 const& endVelocity);
+	void AddBSplineSegment(Vec3 const& pointA, Vec3 const& pointB, Vec3 const& pointC, Vec3 const& pointD);
+	void BuildArcLengthTable();
+	int GetSegmentAtParametric(float parametric, float& outSegmentParametric) const;
+
+private:
+	std::vector<Vec3> m_coefficients; // 4 per segment, highest degree first
+	std::vector<float> m_arcLengths; // Cumulative chord length at every step of every segment
 };
 
 
@@ -0,0 +1,641 @@
+#include "Engine/Math/DelaunayTriangulation2D.hpp"
+#include "Engine/Math/GeometricPredicates.hpp"
+#include "Engine/Math/ConvexPoly2D.hpp"
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+	struct VoronoiVertex {
+		double x = 0.0;
+		double y = 0.0;
+	};
+
+	// Reused by every cell built on the thread, a cell is only a handful of vertexes
+	thread_local std::vector<VoronoiVertex> t_cellPolygon;
+	thread_local std::vector<VoronoiVertex> t_clippedCellPolygon;
+
+	double GetCircumradiusSquared(double ax, double ay, double bx, double by, double cx, double cy)
+	{
+		double abx = bx - ax;
+		double aby = by - ay;
+		double acx = cx - ax;
+		double acy = cy - ay;
+		double abLengthSquared = (abx * abx) + (aby * aby);
+		double acLengthSquared = (acx * acx) + (acy * acy);
+		double scale = 0.5 / ((abx * acy) - (aby * acx));
+
+		double x = ((acy * abLengthSquared) - (aby * acLengthSquared)) * scale;
+		double y = ((abx * acLengthSquared) - (acx * abLengthSquared)) * scale;
+		return (x * x) + (y * y); // Infinite or NaN when collinear
+	}
+
+	VoronoiVertex ComputeCircumcenter(double ax, double ay, double bx, double by, double cx, double cy)
+	{
+		double abx = bx - ax;
+		double aby = by - ay;
+		double acx = cx - ax;
+		double acy = cy - ay;
+		double abLengthSquared = (abx * abx) + (aby * aby);
+		double acLengthSquared = (acx * acx) + (acy * acy);
+		double scale = 0.5 / ((abx * acy) - (aby * acx));
+
+		VoronoiVertex center;
+		center.x = ax + (((acy * abLengthSquared) - (aby * acLengthSquared)) * scale);
+		center.y = ay + (((abx * acLengthSquared) - (acx * abLengthSquared)) * scale);
+		return center;
+	}
+
+	// Sutherland-Hodgman against one side of the bounds: keeps coord >= bound, or coord <= bound when keepBelow
+	void ClipPolygonToBound(std::vector<VoronoiVertex> const& polygon, bool isAxisY, double bound, bool keepBelow, std::vector<VoronoiVertex>& clippedPolygon)
+	{
+		clippedPolygon.clear();
+		int vertexCount = (int)polygon.size();
+		for (int vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++) {
+			VoronoiVertex const& vertex = polygon[vertexIndex];
+			VoronoiVertex const& nextVertex = polygon[(vertexIndex + 1) % vertexCount];
+
+			double dist = (isAxisY ? vertex.y : vertex.x) - bound;
+			double nextDist = (isAxisY ? nextVertex.y : nextVertex.x) - bound;
+			if (keepBelow) {
+				dist = -dist;
+				nextDist = -nextDist;
+			}
+
+			if (dist >= 0.0) {
+				clippedPolygon.push_back(vertex);
+			}
+
+			if (((dist >= 0.0) && (nextDist < 0.0)) || ((dist < 0.0) && (nextDist >= 0.0))) {
+				double t = dist / (dist - nextDist);
+				VoronoiVertex crossing;
+				crossing.x = vertex.x + ((nextVertex.x - vertex.x) * t);
+				crossing.y = vertex.y + ((nextVertex.y - vertex.y) * t);
+				if (isAxisY) {
+					crossing.y = bound;
+				}
+				else {
+					crossing.x = bound;
+				}
+				clippedPolygon.push_back(crossing);
+			}
+		}
+	}
+}
+
+DelaunayTriangulation2D::DelaunayTriangulation2D(std::vector<Vec2> const& points)
+{
+	Triangulate(points);
+}
+
+void DelaunayTriangulation2D::Triangulate(std::vector<Vec2> const& points)
+{
+	Clear();
+	m_points = points;
+
+	int pointCount = (int)m_points.size();
+	m_coords.resize((size_t)pointCount * 2);
+	for (int pointIndex = 0; pointIndex < pointCount; pointIndex++) {
+		m_coords[(pointIndex * 2)] = m_points[pointIndex].x;
+		m_coords[(pointIndex * 2) + 1] = m_points[pointIndex].y;
+	}
+
+	int seedA = DELAUNAY_INVALID_INDEX;
+	int seedB = DELAUNAY_INVALID_INDEX;
+	int seedC = DELAUNAY_INVALID_INDEX;
+	if (!FindSeedTriangle(seedA, seedB, seedC)) {
+		TriangulateCollinear();
+		BuildIncomingHalfEdges();
+		return;
+	}
+
+	VoronoiVertex center = ComputeCircumcenter(m_coords[seedA * 2], m_coords[(seedA * 2) + 1], m_coords[seedB * 2], m_coords[(seedB * 2) + 1], m_coords[seedC * 2], m_coords[(seedC * 2) + 1]);
+	m_centerX = center.x;
+	m_centerY = center.y;
+
+	// Sweeping by distance from the seed circumcenter means a new point is never inside the current hull. Points are renumbered
+	// in sweep order while triangulating: a new point connects to points added shortly before it, so the coords and hull
+	// entries it touches stay in cache. Indexes are mapped back at the end
+	struct SweepPoint {
+		double m_distSquared = 0.0;
+		int m_pointIndex = 0;
+	};
+
+	std::vector<SweepPoint> sweepPoints(pointCount);
+	for (int pointIndex = 0; pointIndex < pointCount; pointIndex++) {
+		double dx = m_coords[pointIndex * 2] - m_centerX;
+		double dy = m_coords[(pointIndex * 2) + 1] - m_centerY;
+		sweepPoints[pointIndex].m_distSquared = (dx * dx) + (dy * dy);
+		sweepPoints[pointIndex].m_pointIndex = pointIndex;
+	}
+	std::sort(sweepPoints.begin(), sweepPoints.end(), [](SweepPoint const& pointA, SweepPoint const& pointB) { return pointA.m_distSquared < pointB.m_distSquared; });
+
+	int pointSeedA = seedA;
+	int pointSeedB = seedB;
+	int pointSeedC = seedC;
+	std::vector<int> sweepOrder(pointCount);
+	for (int sweepIndex = 0; sweepIndex < pointCount; sweepIndex++) {
+		int pointIndex = sweepPoints[sweepIndex].m_pointIndex;
+		sweepOrder[sweepIndex] = pointIndex;
+		m_coords[sweepIndex * 2] = m_points[pointIndex].x;
+		m_coords[(sweepIndex * 2) + 1] = m_points[pointIndex].y;
+
+		if (pointIndex == pointSeedA) {
+			seedA = sweepIndex;
+		}
+		else if (pointIndex == pointSeedB) {
+			seedB = sweepIndex;
+		}
+		else if (pointIndex == pointSeedC) {
+			seedC = sweepIndex;
+		}
+	}
+
+	int hashSize = (int)ceil(sqrt((double)pointCount));
+	m_hullPrev.assign(pointCount, DELAUNAY_INVALID_INDEX);
+	m_hullNext.assign(pointCount, DELAUNAY_INVALID_INDEX);
+	m_hullTriangles.assign(pointCount, DELAUNAY_INVALID_INDEX);
+	m_hullHash.assign(hashSize, DELAUNAY_INVALID_INDEX);
+
+	m_hullStart = seedA;
+	m_hullNext[seedA] = m_hullPrev[seedC] = seedB;
+	m_hullNext[seedB] = m_hullPrev[seedA] = seedC;
+	m_hullNext[seedC] = m_hullPrev[seedB] = seedA;
+	m_hullTriangles[seedA] = 0;
+	m_hullTriangles[seedB] = 1;
+	m_hullTriangles[seedC] = 2;
+	m_hullHash[GetHullHashKey(m_coords[seedA * 2], m_coords[(seedA * 2) + 1])] = seedA;
+	m_hullHash[GetHullHashKey(m_coords[seedB * 2], m_coords[(seedB * 2) + 1])] = seedB;
+	m_hullHash[GetHullHashKey(m_coords[seedC * 2], m_coords[(seedC * 2) + 1])] = seedC;
+
+	int maxTriangleCount = std::max((2 * pointCount) - 5, 1);
+	m_triangles.reserve((size_t)maxTriangleCount * 3);
+	m_halfEdges.reserve((size_t)maxTriangleCount * 3);
+	AddTriangle(seedA, seedB, seedC, DELAUNAY_INVALID_INDEX, DELAUNAY_INVALID_INDEX, DELAUNAY_INVALID_INDEX);
+
+	double prevX = 0.0;
+	double prevY = 0.0;
+	for (int pointIndex = 0; pointIndex < pointCount; pointIndex++) {
+		double x = m_coords[pointIndex * 2];
+		double y = m_coords[(pointIndex * 2) + 1];
+
+		// Exact duplicates are at the same distance, next to each other unless a tie in distance separates them. Those are
+		// caught below, a duplicate never sees a hull edge
+		if ((pointIndex > 0) && (x == prevX) && (y == prevY)) continue;
+		prevX = x;
+		prevY = y;
+		if ((pointIndex == seedA) || (pointIndex == seedB) || (pointIndex == seedC)) continue;
+
+		// Find a hull edge the point sees, starting from the hull point closest in angle around the center
+		int start = 0;
+		int hashKey = GetHullHashKey(x, y);
+		for (int hashOffset = 0; hashOffset < hashSize; hashOffset++) {
+			start = m_hullHash[(hashKey + hashOffset) % hashSize];
+			if ((start != DELAUNAY_INVALID_INDEX) && (start != m_hullNext[start])) break;
+		}
+
+		start = m_hullPrev[start];
+		int visibleEdge = start;
+		int nextPoint = m_hullNext[visibleEdge];
+		while (!IsOrientedClockwise(visibleEdge, nextPoint, pointIndex)) {
+			visibleEdge = nextPoint;
+			if (visibleEdge == start) {
+				visibleEdge = DELAUNAY_INVALID_INDEX;
+				break;
+			}
+			nextPoint = m_hullNext[visibleEdge];
+		}
+		if (visibleEdge == DELAUNAY_INVALID_INDEX) continue;
+
+		int triangle = AddTriangle(visibleEdge, pointIndex, m_hullNext[visibleEdge], DELAUNAY_INVALID_INDEX, DELAUNAY_INVALID_INDEX, m_hullTriangles[visibleEdge]);
+		m_hullTriangles[pointIndex] = Legalize(triangle + 2);
+		m_hullTriangles[visibleEdge] = triangle;
+
+		// Walk forward along the hull, adding a triangle for every other edge the point sees
+		int forwardPoint = m_hullNext[visibleEdge];
+		nextPoint = m_hullNext[forwardPoint];
+		while (IsOrientedClockwise(forwardPoint, nextPoint, pointIndex)) {
+			triangle = AddTriangle(forwardPoint, pointIndex, nextPoint, m_hullTriangles[pointIndex], DELAUNAY_INVALID_INDEX, m_hullTriangles[forwardPoint]);
+			m_hullTriangles[pointIndex] = Legalize(triangle + 2);
+			m_hullNext[forwardPoint] = forwardPoint; // Off the hull
+			forwardPoint = nextPoint;
+			nextPoint = m_hullNext[forwardPoint];
+		}
+
+		// Walk backward, only needed when the search did not already go past those edges
+		if (visibleEdge == start) {
+			int prevPoint = m_hullPrev[visibleEdge];
+			while (IsOrientedClockwise(prevPoint, visibleEdge, pointIndex)) {
+				triangle = AddTriangle(prevPoint, pointIndex, visibleEdge, DELAUNAY_INVALID_INDEX, m_hullTriangles[visibleEdge], m_hullTriangles[prevPoint]);
+				Legalize(triangle + 2);
+				m_hullTriangles[prevPoint] = triangle;
+				m_hullNext[visibleEdge] = visibleEdge;
+				visibleEdge = prevPoint;
+				prevPoint = m_hullPrev[visibleEdge];
+			}
+		}
+
+		m_hullStart = visibleEdge;
+		m_hullPrev[pointIndex] = visibleEdge;
+		m_hullNext[visibleEdge] = pointIndex;
+		m_hullPrev[forwardPoint] = pointIndex;
+		m_hullNext[pointIndex] = forwardPoint;
+
+		m_hullHash[hashKey] = pointIndex;
+		m_hullHash[GetHullHashKey(m_coords[visibleEdge * 2], m_coords[(visibleEdge * 2) + 1])] = visibleEdge;
+	}
+
+	int hullPoint = m_hullStart;
+	do {
+		m_hull.push_back(sweepOrder[hullPoint]);
+		hullPoint = m_hullNext[hullPoint];
+	} while (hullPoint != m_hullStart);
+
+	for (int& trianglePoint : m_triangles) {
+		trianglePoint = sweepOrder[trianglePoint];
+	}
+
+	BuildIncomingHalfEdges();
+}
+
+void DelaunayTriangulation2D::Clear()
+{
+	m_points.clear();
+	m_triangles.clear();
+	m_halfEdges.clear();
+	m_hull.clear();
+	m_incomingHalfEdges.clear();
+}
+
+bool DelaunayTriangulation2D::FindSeedTriangle(int& outSeedA, int& outSeedB, int& outSeedC) const
+{
+	int pointCount = (int)m_points.size();
+	if (pointCount < 3) return false;
+
+	double minX = std::numeric_limits<double>::infinity();
+	double minY = std::numeric_limits<double>::infinity();
+	double maxX = -std::numeric_limits<double>::infinity();
+	double maxY = -std::numeric_limits<double>::infinity();
+	for (int pointIndex = 0; pointIndex < pointCount; pointIndex++) {
+		double x = m_coords[pointIndex * 2];
+		double y = m_coords[(pointIndex * 2) + 1];
+		minX = std::min(minX, x);
+		minY = std::min(minY, y);
+		maxX = std::max(maxX, x);
+		maxY = std::max(maxY, y);
+	}
+	double boundsCenterX = (minX + maxX) * 0.5;
+	double boundsCenterY = (minY + maxY) * 0.5;
+
+	// Point closest to the middle, its nearest neighbour, then the point making the smallest circumcircle with both
+	double minDistSquared = std::numeric_limits<double>::infinity();
+	for (int pointIndex = 0; pointIndex < pointCount; pointIndex++) {
+		double dx = m_coords[pointIndex * 2] - boundsCenterX;
+		double dy = m_coords[(pointIndex * 2) + 1] - boundsCenterY;
+		double distSquared = (dx * dx) + (dy * dy);
+		if (distSquared < minDistSquared) {
+			minDistSquared = distSquared;
+			outSeedA = pointIndex;
+		}
+	}
+
+	double seedAX = m_coords[outSeedA * 2];
+	double seedAY = m_coords[(outSeedA * 2) + 1];
+	minDistSquared = std::numeric_limits<double>::infinity();
+	for (int pointIndex = 0; pointIndex < pointCount; pointIndex++) {
+		double dx = m_coords[pointIndex * 2] - seedAX;
+		double dy = m_coords[(pointIndex * 2) + 1] - seedAY;
+		double distSquared = (dx * dx) + (dy * dy);
+		if ((distSquared > 0.0) && (distSquared < minDistSquared)) {
+			minDistSquared = distSquared;
+			outSeedB = pointIndex;
+		}
+	}
+	if (outSeedB == DELAUNAY_INVALID_INDEX) return false;
+
+	double seedBX = m_coords[outSeedB * 2];
+	double seedBY = m_coords[(outSeedB * 2) + 1];
+	double minRadiusSquared = std::numeric_limits<double>::infinity();
+	for (int pointIndex = 0; pointIndex < pointCount; pointIndex++) {
+		if ((pointIndex == outSeedA) || (pointIndex == outSeedB)) continue;
+
+		double radiusSquared = GetCircumradiusSquared(seedAX, seedAY, seedBX, seedBY, m_coords[pointIndex * 2], m_coords[(pointIndex * 2) + 1]);
+		if ((radiusSquared < minRadiusSquared) && (Orient2D(seedAX, seedAY, seedBX, seedBY, m_coords[pointIndex * 2], m_coords[(pointIndex * 2) + 1]) != 0.0)) {
+			minRadiusSquared = radiusSquared;
+			outSeedC = pointIndex;
+		}
+	}
+	if (outSeedC == DELAUNAY_INVALID_INDEX) return false;
+
+	if (IsOrientedClockwise(outSeedA, outSeedB, outSeedC)) {
+		std::swap(outSeedB, outSeedC);
+	}
+	return true;
+}
+
+void DelaunayTriangulation2D::TriangulateCollinear()
+{
+	// No triangles, the hull is the points in order along their line
+	int pointCount = (int)m_points.size();
+	m_hull.resize(pointCount);
+	std::iota(m_hull.begin(), m_hull.end(), 0);
+	std::sort(m_hull.begin(), m_hull.end(), [&](int pointA, int pointB) {
+		Vec2 const& positionA = m_points[pointA];
+		Vec2 const& positionB = m_points[pointB];
+		return (positionA.x < positionB.x) || ((positionA.x == positionB.x) && (positionA.y < positionB.y));
+	});
+
+	std::vector<int>::iterator uniqueEnd = std::unique(m_hull.begin(), m_hull.end(), [&](int pointA, int pointB) {
+		return (m_points[pointA].x == m_points[pointB].x) && (m_points[pointA].y == m_points[pointB].y);
+	});
+	m_hull.erase(uniqueEnd, m_hull.end());
+}
+
+int DelaunayTriangulation2D::AddTriangle(int pointA, int pointB, int pointC, int halfEdgeA, int halfEdgeB, int halfEdgeC)
+{
+	int firstHalfEdge = (int)m_triangles.size();
+	m_triangles.push_back(pointA);
+	m_triangles.push_back(pointB);
+	m_triangles.push_back(pointC);
+	m_halfEdges.push_back(DELAUNAY_INVALID_INDEX);
+	m_halfEdges.push_back(DELAUNAY_INVALID_INDEX);
+	m_halfEdges.push_back(DELAUNAY_INVALID_INDEX);
+
+	LinkHalfEdges(firstHalfEdge, halfEdgeA);
+	LinkHalfEdges(firstHalfEdge + 1, halfEdgeB);
+	LinkHalfEdges(firstHalfEdge + 2, halfEdgeC);
+	return firstHalfEdge;
+}
+
+void DelaunayTriangulation2D::LinkHalfEdges(int halfEdgeA, int halfEdgeB)
+{
+	m_halfEdges[halfEdgeA] = halfEdgeB;
+	if (halfEdgeB != DELAUNAY_INVALID_INDEX) {
+		m_halfEdges[halfEdgeB] = halfEdgeA;
+	}
+}
+
+int DelaunayTriangulation2D::Legalize(int halfEdge)
+{
+	// Flips the edge shared by two triangles when the far point of one is inside the other's circumcircle, then checks the two
+	// edges of the second triangle the flip exposed. Returns the half edge before the last one checked, which is the new hull
+	// edge when legalizing the edge facing away from a newly added point
+	int prevHalfEdge = 0;
+	m_legalizeStack.clear();
+	while (true) {
+		int oppositeHalfEdge = m_halfEdges[halfEdge];
+		int firstHalfEdgeA = halfEdge - (halfEdge % 3);
+		prevHalfEdge = firstHalfEdgeA + ((halfEdge + 2) % 3);
+
+		if (oppositeHalfEdge == DELAUNAY_INVALID_INDEX) {
+			if (m_legalizeStack.empty()) break;
+			halfEdge = m_legalizeStack.back();
+			m_legalizeStack.pop_back();
+			continue;
+		}
+
+		int firstHalfEdgeB = oppositeHalfEdge - (oppositeHalfEdge % 3);
+		int nextHalfEdgeA = firstHalfEdgeA + ((halfEdge + 1) % 3);
+		int prevHalfEdgeB = firstHalfEdgeB + ((oppositeHalfEdge + 2) % 3);
+
+		int point0 = m_triangles[prevHalfEdge];
+		int pointRight = m_triangles[halfEdge];
+		int pointLeft = m_triangles[nextHalfEdgeA];
+		int point1 = m_triangles[prevHalfEdgeB];
+
+		bool isIllegal = InCircle2D(m_coords[point0 * 2], m_coords[(point0 * 2) + 1], m_coords[pointRight * 2], m_coords[(pointRight * 2) + 1],
+			m_coords[pointLeft * 2], m_coords[(pointLeft * 2) + 1], m_coords[point1 * 2], m_coords[(point1 * 2) + 1]) > 0.0;
+
+		if (isIllegal) {
+			m_triangles[halfEdge] = point1;
+			m_triangles[oppositeHalfEdge] = point0;
+
+			// The edge moving into triangle A was on the hull, the hull has to point at its new half edge
+			int outerHalfEdge = m_halfEdges[prevHalfEdgeB];
+			if (outerHalfEdge == DELAUNAY_INVALID_INDEX) {
+				int hullPoint = m_hullStart;
+				do {
+					if (m_hullTriangles[hullPoint] == prevHalfEdgeB) {
+						m_hullTriangles[hullPoint] = halfEdge;
+						break;
+					}
+					hullPoint = m_hullPrev[hullPoint];
+				} while (hullPoint != m_hullStart);
+			}
+
+			LinkHalfEdges(halfEdge, outerHalfEdge);
+			LinkHalfEdges(oppositeHalfEdge, m_halfEdges[prevHalfEdge]);
+			LinkHalfEdges(prevHalfEdge, prevHalfEdgeB);
+
+			m_legalizeStack.push_back(firstHalfEdgeB + ((oppositeHalfEdge + 1) % 3));
+		}
+		else {
+			if (m_legalizeStack.empty()) break;
+			halfEdge = m_legalizeStack.back();
+			m_legalizeStack.pop_back();
+		}
+	}
+
+	return prevHalfEdge;
+}
+
+int DelaunayTriangulation2D::GetHullHashKey(double x, double y) const
+{
+	// Pseudo angle around the center, monotonic with the real angle and in [0, 1]
+	double dx = x - m_centerX;
+	double dy = y - m_centerY;
+	double manhattanLength = fabs(dx) + fabs(dy);
+	if (manhattanLength == 0.0) return 0;
+
+	double slope = dx / manhattanLength;
+	double pseudoAngle = ((dy > 0.0) ? (3.0 - slope) : (1.0 + slope)) * 0.25;
+	int hashSize = (int)m_hullHash.size();
+	return (int)floor(pseudoAngle * (double)hashSize) % hashSize;
+}
+
+bool DelaunayTriangulation2D::IsOrientedClockwise(int pointA, int pointB, int pointC) const
+{
+	return Orient2D(m_coords[pointA * 2], m_coords[(pointA * 2) + 1], m_coords[pointB * 2], m_coords[(pointB * 2) + 1], m_coords[pointC * 2], m_coords[(pointC * 2) + 1]) < 0.0;
+}
+
+void DelaunayTriangulation2D::BuildIncomingHalfEdges()
+{
+	// Hull points keep their hull half edge, so walking around them from it visits every triangle before reaching the hull again
+	m_incomingHalfEdges.assign(m_points.size(), DELAUNAY_INVALID_INDEX);
+	for (int halfEdge = 0; halfEdge < (int)m_triangles.size(); halfEdge++) {
+		int endPoint = m_triangles[GetNextHalfEdge(halfEdge)];
+		if ((m_halfEdges[halfEdge] == DELAUNAY_INVALID_INDEX) || (m_incomingHalfEdges[endPoint] == DELAUNAY_INVALID_INDEX)) {
+			m_incomingHalfEdges[endPoint] = halfEdge;
+		}
+	}
+}
+
+Vec2 const DelaunayTriangulation2D::GetCircumcenter(int triangleIndex) const
+{
+	Vec2 const& pointA = m_points[m_triangles[(triangleIndex * 3)]];
+	Vec2 const& pointB = m_points[m_triangles[(triangleIndex * 3) + 1]];
+	Vec2 const& pointC = m_points[m_triangles[(triangleIndex * 3) + 2]];
+
+	VoronoiVertex center = ComputeCircumcenter(pointA.x, pointA.y, pointB.x, pointB.y, pointC.x, pointC.y);
+	return Vec2((float)center.x, (float)center.y);
+}
+
+void DelaunayTriangulation2D::GetTrianglePolys(std::vector<DelaunayConvexPoly2D>& trianglePolys) const
+{
+	int triangleCount = GetTriangleCount();
+	trianglePolys.reserve(trianglePolys.size() + triangleCount);
+	for (int triangleIndex = 0; triangleIndex < triangleCount; triangleIndex++) {
+		std::vector<Vec2> vertexes = {
+			m_points[m_triangles[(triangleIndex * 3)]],
+			m_points[m_triangles[(triangleIndex * 3) + 1]],
+			m_points[m_triangles[(triangleIndex * 3) + 2]]
+		};
+		trianglePolys.emplace_back(vertexes);
+	}
+}
+
+void DelaunayTriangulation2D::GetVoronoiCells(AABB2 const& bounds, std::vector<ConvexPoly2D>& voronoiCells) const
+{
+	int pointCount = (int)m_points.size();
+	int triangleCount = GetTriangleCount();
+	int halfEdgeCount = (int)m_triangles.size();
+	voronoiCells.clear();
+	voronoiCells.resize(pointCount);
+
+	// Every circumcenter is shared by three cells, compute them once in triangle order
+	std::vector<double> circumcenters((size_t)triangleCount * 2);
+	auto computeCircumcenters = [&](int beginIndex, int endIndex) {
+		for (int triangleIndex = beginIndex; triangleIndex < endIndex; triangleIndex++) {
+			Vec2 const& pointA = m_points[m_triangles[(triangleIndex * 3)]];
+			Vec2 const& pointB = m_points[m_triangles[(triangleIndex * 3) + 1]];
+			Vec2 const& pointC = m_points[m_triangles[(triangleIndex * 3) + 2]];
+			VoronoiVertex center = ComputeCircumcenter(pointA.x, pointA.y, pointB.x, pointB.y, pointC.x, pointC.y);
+			circumcenters[triangleIndex * 2] = center.x;
+			circumcenters[(triangleIndex * 2) + 1] = center.y;
+		}
+	};
+
+	// Cells are built from their point's incoming half edge, in half edge order rather than point order. Triangles around a point
+	// were created close together, so walking them stays in cache
+	auto buildCells = [&](int beginIndex, int endIndex) {
+		std::vector<Vec2> ccwPoints;
+		for (int halfEdge = beginIndex; halfEdge < endIndex; halfEdge++) {
+			int pointIndex = m_triangles[GetNextHalfEdge(halfEdge)];
+			if (m_incomingHalfEdges[pointIndex] != halfEdge) continue;
+
+			if (GetVoronoiCellPoints(pointIndex, bounds, circumcenters.data(), ccwPoints)) {
+				voronoiCells[pointIndex] = ConvexPoly2D(ccwPoints);
+			}
+		}
+	};
+
+	if (g_theJobSystem) {
+		g_theJobSystem->ParallelFor(triangleCount, VORONOI_MIN_HALF_EDGES_PER_JOB, computeCircumcenters);
+		g_theJobSystem->ParallelFor(halfEdgeCount, VORONOI_MIN_HALF_EDGES_PER_JOB, buildCells);
+	}
+	else {
+		computeCircumcenters(0, triangleCount);
+		buildCells(0, halfEdgeCount);
+	}
+}
+
+ConvexPoly2D const DelaunayTriangulation2D::GetVoronoiCell(int pointIndex, AABB2 const& bounds) const
+{
+	std::vector<Vec2> ccwPoints;
+	if (!GetVoronoiCellPoints(pointIndex, bounds, nullptr, ccwPoints)) return ConvexPoly2D();
+	return ConvexPoly2D(ccwPoints);
+}
+
+bool DelaunayTriangulation2D::GetVoronoiCellPoints(int pointIndex, AABB2 const& bounds, double const* circumcenters, std::vector<Vec2>& ccwPoints) const
+{
+	ccwPoints.clear();
+	int startHalfEdge = m_incomingHalfEdges[pointIndex];
+	if (startHalfEdge == DELAUNAY_INVALID_INDEX) return false;
+
+	// Circumcenters of the triangles around the point. Crossing the edge leaving the point goes clockwise around it
+	std::vector<VoronoiVertex>& cellPolygon = t_cellPolygon;
+	std::vector<VoronoiVertex>& clippedPolygon = t_clippedCellPolygon;
+	cellPolygon.clear();
+	int halfEdge = startHalfEdge;
+	int outgoingHalfEdge = DELAUNAY_INVALID_INDEX;
+	do {
+		int triangleIndex = GetTriangleOfHalfEdge(halfEdge);
+		if (circumcenters) {
+			cellPolygon.push_back({ circumcenters[triangleIndex * 2], circumcenters[(triangleIndex * 2) + 1] });
+		}
+		else {
+			Vec2 const& pointA = m_points[m_triangles[(triangleIndex * 3)]];
+			Vec2 const& pointB = m_points[m_triangles[(triangleIndex * 3) + 1]];
+			Vec2 const& pointC = m_points[m_triangles[(triangleIndex * 3) + 2]];
+			cellPolygon.push_back(ComputeCircumcenter(pointA.x, pointA.y, pointB.x, pointB.y, pointC.x, pointC.y));
+		}
+
+		outgoingHalfEdge = GetNextHalfEdge(halfEdge);
+		halfEdge = m_halfEdges[outgoingHalfEdge];
+	} while ((halfEdge != DELAUNAY_INVALID_INDEX) && (halfEdge != startHalfEdge));
+	std::reverse(cellPolygon.begin(), cellPolygon.end());
+
+	double siteX = m_points[pointIndex].x;
+	double siteY = m_points[pointIndex].y;
+	if (halfEdge == DELAUNAY_INVALID_INDEX) {
+		// Hull point: the cell is open between the outward normals of its two hull edges. It is closed with points far enough
+		// past the bounds that clipping never reaches the closing edges
+		Vec2 const& prevPoint = m_points[m_triangles[startHalfEdge]];
+		Vec2 const& nextPoint = m_points[m_triangles[GetNextHalfEdge(outgoingHalfEdge)]];
+
+		double prevNormalX = siteY - (double)prevPoint.y;
+		double prevNormalY = (double)prevPoint.x - siteX;
+		double prevNormalLength = sqrt((prevNormalX * prevNormalX) + (prevNormalY * prevNormalY));
+		prevNormalX /= prevNormalLength;
+		prevNormalY /= prevNormalLength;
+
+		double nextNormalX = (double)nextPoint.y - siteY;
+		double nextNormalY = siteX - (double)nextPoint.x;
+		double nextNormalLength = sqrt((nextNormalX * nextNormalX) + (nextNormalY * nextNormalY));
+		nextNormalX /= nextNormalLength;
+		nextNormalY /= nextNormalLength;
+
+		double middleNormalX = prevNormalX + nextNormalX;
+		double middleNormalY = prevNormalY + nextNormalY;
+		double middleNormalLength = sqrt((middleNormalX * middleNormalX) + (middleNormalY * middleNormalY));
+		middleNormalX /= middleNormalLength;
+		middleNormalY /= middleNormalLength;
+
+		double boundsSizeX = (double)bounds.m_maxs.x - (double)bounds.m_mins.x;
+		double boundsSizeY = (double)bounds.m_maxs.y - (double)bounds.m_mins.y;
+		double siteToBoundsX = fabs(siteX - ((double)bounds.m_mins.x + (boundsSizeX * 0.5)));
+		double siteToBoundsY = fabs(siteY - ((double)bounds.m_mins.y + (boundsSizeY * 0.5)));
+		double farDistance = boundsSizeX + boundsSizeY + siteToBoundsX + siteToBoundsY;
+		for (VoronoiVertex const& vertex : cellPolygon) {
+			farDistance = std::max(farDistance, fabs(vertex.x - siteX) + fabs(vertex.y - siteY));
+		}
+		farDistance = (farDistance * 4.0) + 1.0;
+
+		VoronoiVertex firstVertex = cellPolygon.front();
+		VoronoiVertex lastVertex = cellPolygon.back();
+		cellPolygon.push_back({ lastVertex.x + (prevNormalX * farDistance), lastVertex.y + (prevNormalY * farDistance) });
+		cellPolygon.push_back({ siteX + (middleNormalX * farDistance), siteY + (middleNormalY * farDistance) });
+		cellPolygon.push_back({ firstVertex.x + (nextNormalX * farDistance), firstVertex.y + (nextNormalY * farDistance) });
+	}
+
+	ClipPolygonToBound(cellPolygon, false, bounds.m_mins.x, false, clippedPolygon);
+	ClipPolygonToBound(clippedPolygon, false, bounds.m_maxs.x, true, cellPolygon);
+	ClipPolygonToBound(cellPolygon, true, bounds.m_mins.y, false, clippedPolygon);
+	ClipPolygonToBound(clippedPolygon, true, bounds.m_maxs.y, true, cellPolygon);
+
+	for (VoronoiVertex const& vertex : cellPolygon) {
+		Vec2 point((float)vertex.x, (float)vertex.y);
+		if (ccwPoints.empty() || (ccwPoints.back() != point)) {
+			ccwPoints.push_back(point);
+		}
+	}
+	while ((ccwPoints.size() > 1) && (ccwPoints.back() == ccwPoints.front())) {
+		ccwPoints.pop_back();
+	}
+
+	return ccwPoints.size() >= 3;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include <vector>
+
+struct AABB2;
+struct DelaunayConvexPoly2D;
+class ConvexPoly2D;
+
+constexpr int DELAUNAY_INVALID_INDEX = -1;
+constexpr int VORONOI_MIN_HALF_EDGES_PER_JOB = 2048;
+
+/// <summary>
+/// Delaunay triangulation of a point set, built with a sweep hull: points are added in order of distance from a seed triangle,
+/// each one connected to the part of the convex hull it sees, then edges are flipped until every triangle is locally Delaunay.
+/// Orientation and in circle tests use exact adaptive predicates, so cocircular and collinear input (grids) is handled.
+///
+/// The result is a half edge structure. Triangle t owns half edges 3t, 3t + 1 and 3t + 2, half edge e starts at point
+/// m_triangles[e] and goes to the start of GetNextHalfEdge(e), triangles wind counterclockwise.
+/// m_halfEdges[e] is the opposite half edge in the neighbour triangle, DELAUNAY_INVALID_INDEX on the convex hull.
+/// Exact duplicate points are kept out of the triangulation, and so are all the points when they are collinear
+/// </summary>
+class DelaunayTriangulation2D {
+public:
+	DelaunayTriangulation2D() = default;
+	explicit DelaunayTriangulation2D(std::vector<Vec2> const& points);
+
+	void Triangulate(std::vector<Vec2> const& points);
+
+	std::vector<Vec2> const& GetPoints() const { return m_points; }
+	std::vector<int> const& GetTriangles() const { return m_triangles; }
+	std::vector<int> const& GetHalfEdges() const { return m_halfEdges; }
+	std::vector<int> const& GetHull() const { return m_hull; } // Counterclockwise
+	int GetTriangleCount() const { return (int)m_triangles.size() / 3; }
+	// A half edge ending at the point, on the hull for hull points. DELAUNAY_INVALID_INDEX for points left out
+	int GetIncomingHalfEdge(int pointIndex) const { return m_incomingHalfEdges[pointIndex]; }
+
+	static int GetTriangleOfHalfEdge(int halfEdge) { return halfEdge / 3; }
+	static int GetNextHalfEdge(int halfEdge) { return ((halfEdge % 3) == 2) ? (halfEdge - 2) : (halfEdge + 1); }
+	static int GetPrevHalfEdge(int halfEdge) { return ((halfEdge % 3) == 0) ? (halfEdge + 2) : (halfEdge - 1); }
+
+	Vec2 const GetCircumcenter(int triangleIndex) const;
+	void GetTrianglePolys(std::vector<DelaunayConvexPoly2D>& trianglePolys) const;
+
+	// The Voronoi cell of every point clipped to bounds, one per point in the same order. Cells of hull points are unbounded
+	// before clipping. Points left out of the triangulation, or whose cell is entirely outside bounds, get an empty ConvexPoly2D.
+	// Cells are independent, they are built on the JobSystem when there is one
+	void GetVoronoiCells(AABB2 const& bounds, std::vector<ConvexPoly2D>& voronoiCells) const;
+	ConvexPoly2D const GetVoronoiCell(int pointIndex, AABB2 const& bounds) const;
+
+private:
+	void Clear();
+	bool FindSeedTriangle(int& outSeedA, int& outSeedB, int& outSeedC) const;
+	void TriangulateCollinear();
+	int AddTriangle(int pointA, int pointB, int pointC, int halfEdgeA, int halfEdgeB, int halfEdgeC);
+	void LinkHalfEdges(int halfEdgeA, int halfEdgeB);
+	int Legalize(int halfEdge);
+	int GetHullHashKey(double x, double y) const;
+	bool IsOrientedClockwise(int pointA, int pointB, int pointC) const;
+	void BuildIncomingHalfEdges();
+	// circumcenters holds x, y per triangle, or is null to compute them on the way
+	bool GetVoronoiCellPoints(int pointIndex, AABB2 const& bounds, double const* circumcenters, std::vector<Vec2>& ccwPoints) const;
+
+private:
+	std::vector<Vec2> m_points;
+	std::vector<int> m_triangles;
+	std::vector<int> m_halfEdges;
+	std::vector<int> m_hull;
+	std::vector<int> m_incomingHalfEdges;
+
+	// Sweep state, only used while triangulating
+	std::vector<double> m_coords; // x, y interleaved
+	std::vector<int> m_hullPrev;
+	std::vector<int> m_hullNext;
+	std::vector<int> m_hullTriangles; // Half edge inside the triangulation along the hull edge starting at the point
+	std::vector<int> m_hullHash;
+	std::vector<int> m_legalizeStack;
+	int m_hullStart = 0;
+	double m_centerX = 0.0;
+	double m_centerY = 0.0;
+};
@@ -0,0 +1,136 @@
+#include "Engine/Math/DiscContactSolver2D.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include <intrin.h>
+
+DiscContactSolver2D::DiscContactSolver2D(SpatialHashGrid2DConfig const& gridConfig) :
+	m_grid(gridConfig)
+{
+}
+
+int DiscContactSolver2D::PushDiscsApart(Vec2* discCenters, float const* discRadii, int discCount)
+{
+	FindAndColorPairs(discCenters, discRadii, discCount);
+
+	ResolveColoredPairs([&](DiscPair2D const& pair) {
+		PushDiscsOutOfEachOther2D(discCenters[pair.m_discA], discRadii[pair.m_discA], discCenters[pair.m_discB], discRadii[pair.m_discB]);
+	});
+
+	return (int)m_pairs.size();
+}
+
+int DiscContactSolver2D::BounceDiscs(Vec2* discCenters, Vec2* discVelocities, float const* discRadii, int discCount, float combinedElasticity)
+{
+	FindAndColorPairs(discCenters, discRadii, discCount);
+
+	ResolveColoredPairs([&](DiscPair2D const& pair) {
+		BounceDiscOffEachOther2D(discCenters[pair.m_discA], discVelocities[pair.m_discA], discRadii[pair.m_discA],
+			discCenters[pair.m_discB], discVelocities[pair.m_discB], discRadii[pair.m_discB], combinedElasticity);
+	});
+
+	return (int)m_pairs.size();
+}
+
+void DiscContactSolver2D::FindAndColorPairs(Vec2 const* discCenters, float const* discRadii, int discCount)
+{
+	m_grid.Build(discCenters, discRadii, discCount);
+
+	// Pair finding only reads the grid, slices of it run as separate jobs into their own vectors
+	int sliceCount = 1;
+	if (g_theJobSystem && (discCount > DISC_CONTACT_SOLVER_MIN_DISCS_PER_SLICE)) {
+		sliceCount = g_theJobSystem->GetNumThreads() * 4;
+		int maxSliceCount = discCount / DISC_CONTACT_SOLVER_MIN_DISCS_PER_SLICE;
+		if (sliceCount > maxSliceCount) {
+			sliceCount = maxSliceCount;
+		}
+	}
+
+	if (sliceCount <= 1) {
+		m_grid.FindOverlappingPairs(m_pairs);
+	}
+	else {
+		if ((int)m_slicePairs.size() < sliceCount) {
+			m_slicePairs.resize(sliceCount);
+		}
+
+		g_theJobSystem->ParallelFor(sliceCount, 1, [&](int beginSlice, int endSlice) {
+			for (int sliceIndex = beginSlice; sliceIndex < endSlice; sliceIndex++) {
+				m_grid.FindOverlappingPairsInSlice(sliceIndex, sliceCount, m_slicePairs[sliceIndex]);
+			}
+		});
+
+		m_pairs.clear();
+		for (int sliceIndex = 0; sliceIndex < sliceCount; sliceIndex++) {
+			m_pairs.insert(m_pairs.end(), m_slicePairs[sliceIndex].begin(), m_slicePairs[sliceIndex].end());
+		}
+	}
+
+	// Greedy edge coloring: each pair takes the lowest color neither disc uses yet
+	m_discColorMasks.assign(discCount, 0);
+	m_pairColors.resize(m_pairs.size());
+	int colorCounts[DISC_CONTACT_SOLVER_MAX_COLORS + 1] = {};
+	m_colorCount = 0;
+
+	for (size_t pairIndex = 0; pairIndex < m_pairs.size(); pairIndex++) {
+		DiscPair2D const& pair = m_pairs[pairIndex];
+		uint64_t usedColors = m_discColorMasks[pair.m_discA] | m_discColorMasks[pair.m_discB];
+
+		unsigned long color = DISC_CONTACT_SOLVER_MAX_COLORS;
+		if (_BitScanForward64(&color, ~usedColors)) {
+			uint64_t colorBit = 1ull << color;
+			m_discColorMasks[pair.m_discA] |= colorBit;
+			m_discColorMasks[pair.m_discB] |= colorBit;
+		}
+		else {
+			color = DISC_CONTACT_SOLVER_MAX_COLORS;
+		}
+
+		m_pairColors[pairIndex] = (uint8_t)color;
+		colorCounts[color]++;
+		if ((int)color + 1 > m_colorCount) {
+			m_colorCount = (int)color + 1;
+		}
+	}
+
+	// Counting sort by color, so each color is one contiguous range
+	m_colorStarts[0] = 0;
+	for (int color = 0; color <= DISC_CONTACT_SOLVER_MAX_COLORS; color++) {
+		m_colorStarts[color + 1] = m_colorStarts[color] + colorCounts[color];
+	}
+
+	int writeCursors[DISC_CONTACT_SOLVER_MAX_COLORS + 1];
+	for (int color = 0; color <= DISC_CONTACT_SOLVER_MAX_COLORS; color++) {
+		writeCursors[color] = m_colorStarts[color];
+	}
+
+	m_coloredPairs.resize(m_pairs.size());
+	for (size_t pairIndex = 0; pairIndex < m_pairs.size(); pairIndex++) {
+		m_coloredPairs[writeCursors[m_pairColors[pairIndex]]++] = m_pairs[pairIndex];
+	}
+}
+
+template <typename T_Resolve>
+void DiscContactSolver2D::ResolveColoredPairs(T_Resolve const& resolvePair) const
+{
+	for (int color = 0; color < m_colorCount; color++) {
+		int colorStart = m_colorStarts[color];
+		int pairCount = m_colorStarts[color + 1] - colorStart;
+		if (pairCount == 0) continue;
+
+		auto resolveRange = [&](int beginIndex, int endIndex) {
+			for (int pairIndex = beginIndex; pairIndex < endIndex; pairIndex++) {
+				resolvePair(m_coloredPairs[colorStart + pairIndex]);
+			}
+		};
+
+		// The overflow batch may repeat discs, so it never leaves the calling thread
+		bool isOverflow = (color == DISC_CONTACT_SOLVER_MAX_COLORS);
+		if (g_theJobSystem && !isOverflow && (pairCount > DISC_CONTACT_SOLVER_MIN_PAIRS_PER_JOB)) {
+			g_theJobSystem->ParallelFor(pairCount, DISC_CONTACT_SOLVER_MIN_PAIRS_PER_JOB, resolveRange);
+		}
+		else {
+			resolveRange(0, pairCount);
+		}
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "Engine/Math/SpatialHashGrid2D.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <cstdint>
+#include <vector>
+
+constexpr int DISC_CONTACT_SOLVER_MAX_COLORS = 64; // Pairs that do not fit in any color go to one extra batch solved on the calling thread
+constexpr int DISC_CONTACT_SOLVER_MIN_PAIRS_PER_JOB = 1024;
+constexpr int DISC_CONTACT_SOLVER_MIN_DISCS_PER_SLICE = 2048; // Smallest share of the pair search handed to one job
+
+/// <summary>
+/// Broadphase plus resolution for large disc sets, built on SpatialHashGrid2D and the pairwise PushDiscsOutOfEachOther2D and
+/// BounceDiscOffEachOther2D. Overlapping pairs are greedily colored so no disc shows up twice within a color, then each color is
+/// split across the JobSystem. Colors run one after the other, so the result matches a serial pass over the pairs in color order.
+/// Scratch buffers are members and reused, keep one solver alive across frames
+/// </summary>
+class DiscContactSolver2D {
+public:
+	DiscContactSolver2D(SpatialHashGrid2DConfig const& gridConfig = SpatialHashGrid2DConfig());
+
+	// Both rebuild the grid from the current centers. Return how many overlapping pairs were found
+	int PushDiscsApart(Vec2* discCenters, float const* discRadii, int discCount);
+	int BounceDiscs(Vec2* discCenters, Vec2* discVelocities, float const* discRadii, int discCount, float combinedElasticity = 1.0f);
+
+	SpatialHashGrid2D const& GetGrid() const { return m_grid; }
+	std::vector<DiscPair2D> const& GetPairs() const { return m_pairs; }
+	int GetColorCount() const { return m_colorCount; }
+
+private:
+	void FindAndColorPairs(Vec2 const* discCenters, float const* discRadii, int discCount);
+
+	template <typename T_Resolve>
+	void ResolveColoredPairs(T_Resolve const& resolvePair) const;
+
+private:
+	SpatialHashGrid2D m_grid;
+	std::vector<DiscPair2D> m_pairs;
+	std::vector<std::vector<DiscPair2D>> m_slicePairs;
+	std::vector<uint64_t> m_discColorMasks; // Bit c set when the disc is already in a pair of color c
+	std::vector<uint8_t> m_pairColors;
+	std::vector<DiscPair2D> m_coloredPairs; // m_pairs sorted by color
+	int m_colorStarts[DISC_CONTACT_SOLVER_MAX_COLORS + 2] = {};
+	int m_colorCount = 0;
+};
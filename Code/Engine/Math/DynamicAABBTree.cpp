@@ -0,0 +1,499 @@
+#include "Engine/Math/DynamicAABBTree.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cstdlib>
+
+//-----------------------------------------------------------------------------------------------
+AABB2 GetBoundsUnion(AABB2 const& boundsA, AABB2 const& boundsB)
+{
+	return AABB2((std::min)(boundsA.m_mins.x, boundsB.m_mins.x), (std::min)(boundsA.m_mins.y, boundsB.m_mins.y),
+		(std::max)(boundsA.m_maxs.x, boundsB.m_maxs.x), (std::max)(boundsA.m_maxs.y, boundsB.m_maxs.y));
+}
+
+AABB3 GetBoundsUnion(AABB3 const& boundsA, AABB3 const& boundsB)
+{
+	return AABB3((std::min)(boundsA.m_mins.x, boundsB.m_mins.x), (std::min)(boundsA.m_mins.y, boundsB.m_mins.y), (std::min)(boundsA.m_mins.z, boundsB.m_mins.z),
+		(std::max)(boundsA.m_maxs.x, boundsB.m_maxs.x), (std::max)(boundsA.m_maxs.y, boundsB.m_maxs.y), (std::max)(boundsA.m_maxs.z, boundsB.m_maxs.z));
+}
+
+float GetBoundsSurfaceCost(AABB2 const& bounds)
+{
+	// Perimeter: proportional to the chance of a random line crossing the box
+	float width = bounds.m_maxs.x - bounds.m_mins.x;
+	float height = bounds.m_maxs.y - bounds.m_mins.y;
+	return 2.0f * (width + height);
+}
+
+float GetBoundsSurfaceCost(AABB3 const& bounds)
+{
+	float width = bounds.m_maxs.x - bounds.m_mins.x;
+	float depth = bounds.m_maxs.y - bounds.m_mins.y;
+	float height = bounds.m_maxs.z - bounds.m_mins.z;
+	return 2.0f * ((width * depth) + (width * height) + (depth * height));
+}
+
+bool DoesBoundsContain(AABB2 const& outerBounds, AABB2 const& innerBounds)
+{
+	return (outerBounds.m_mins.x <= innerBounds.m_mins.x) && (outerBounds.m_mins.y <= innerBounds.m_mins.y) &&
+		(innerBounds.m_maxs.x <= outerBounds.m_maxs.x) && (innerBounds.m_maxs.y <= outerBounds.m_maxs.y);
+}
+
+bool DoesBoundsContain(AABB3 const& outerBounds, AABB3 const& innerBounds)
+{
+	return (outerBounds.m_mins.x <= innerBounds.m_mins.x) && (outerBounds.m_mins.y <= innerBounds.m_mins.y) && (outerBounds.m_mins.z <= innerBounds.m_mins.z) &&
+		(innerBounds.m_maxs.x <= outerBounds.m_maxs.x) && (innerBounds.m_maxs.y <= outerBounds.m_maxs.y) && (innerBounds.m_maxs.z <= outerBounds.m_maxs.z);
+}
+
+AABB2 GetFattenedBounds(AABB2 const& bounds, float margin, Vec2 const& displacement)
+{
+	AABB2 fatBounds(bounds.m_mins.x - margin, bounds.m_mins.y - margin, bounds.m_maxs.x + margin, bounds.m_maxs.y + margin);
+
+	// Only stretch towards where the object is going
+	if (displacement.x < 0.0f) fatBounds.m_mins.x += displacement.x; else fatBounds.m_maxs.x += displacement.x;
+	if (displacement.y < 0.0f) fatBounds.m_mins.y += displacement.y; else fatBounds.m_maxs.y += displacement.y;
+	return fatBounds;
+}
+
+AABB3 GetFattenedBounds(AABB3 const& bounds, float margin, Vec3 const& displacement)
+{
+	AABB3 fatBounds(bounds.m_mins.x - margin, bounds.m_mins.y - margin, bounds.m_mins.z - margin, bounds.m_maxs.x + margin, bounds.m_maxs.y + margin, bounds.m_maxs.z + margin);
+
+	if (displacement.x < 0.0f) fatBounds.m_mins.x += displacement.x; else fatBounds.m_maxs.x += displacement.x;
+	if (displacement.y < 0.0f) fatBounds.m_mins.y += displacement.y; else fatBounds.m_maxs.y += displacement.y;
+	if (displacement.z < 0.0f) fatBounds.m_mins.z += displacement.z; else fatBounds.m_maxs.z += displacement.z;
+	return fatBounds;
+}
+
+Vec2 GetRayInverseForward(Vec2 const& rayForward)
+{
+	return Vec2((rayForward.x != 0.0f) ? 1.0f / rayForward.x : FLT_MAX, (rayForward.y != 0.0f) ? 1.0f / rayForward.y : FLT_MAX);
+}
+
+Vec3 GetRayInverseForward(Vec3 const& rayForward)
+{
+	return Vec3((rayForward.x != 0.0f) ? 1.0f / rayForward.x : FLT_MAX, (rayForward.y != 0.0f) ? 1.0f / rayForward.y : FLT_MAX, (rayForward.z != 0.0f) ? 1.0f / rayForward.z : FLT_MAX);
+}
+
+namespace {
+	// Children heights may differ this much before a rotation restores the balance. A little slack leaves the surface area
+	// rotations room to work, exact AVL balance raised the area ratio of random trees by half
+	constexpr int MAX_HEIGHT_DIFFERENCE = 3;
+
+	// Swapping child X of a node with grandchild Y, whose sibling Z stays: the refit parent holds X and Z, the node holds Y and that parent
+	bool IsSwapBalanced(int childHeight, int grandChildHeight, int keptHeight)
+	{
+		int refitHeight = 1 + (std::max)(childHeight, keptHeight);
+		return (std::abs(childHeight - keptHeight) <= MAX_HEIGHT_DIFFERENCE) && (std::abs(grandChildHeight - refitHeight) <= MAX_HEIGHT_DIFFERENCE);
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+template <typename T_Bounds, typename T_Vec>
+DynamicAABBTree<T_Bounds, T_Vec>::DynamicAABBTree(DynamicAABBTreeConfig const& config) :
+	m_config(config)
+{
+}
+
+template <typename T_Bounds, typename T_Vec>
+DynamicAABBTree<T_Bounds, T_Vec>::~DynamicAABBTree()
+{
+}
+
+template <typename T_Bounds, typename T_Vec>
+int DynamicAABBTree<T_Bounds, T_Vec>::AllocateNode()
+{
+	if (m_freeList == AABB_TREE_NULL_NODE) {
+		m_nodes.emplace_back();
+		m_nodes.back().m_height = 0;
+		return (int)m_nodes.size() - 1;
+	}
+
+	int nodeIndex = m_freeList;
+	Node& node = m_nodes[nodeIndex];
+	m_freeList = node.m_parentOrNext;
+
+	node = Node();
+	node.m_height = 0;
+	return nodeIndex;
+}
+
+template <typename T_Bounds, typename T_Vec>
+void DynamicAABBTree<T_Bounds, T_Vec>::FreeNode(int nodeIndex)
+{
+	Node& node = m_nodes[nodeIndex];
+	node.m_parentOrNext = m_freeList;
+	node.m_childA = AABB_TREE_NULL_NODE;
+	node.m_childB = AABB_TREE_NULL_NODE;
+	node.m_userData = nullptr;
+	node.m_height = -1;
+	node.m_moved = false;
+	m_freeList = nodeIndex;
+}
+
+template <typename T_Bounds, typename T_Vec>
+int DynamicAABBTree<T_Bounds, T_Vec>::CreateProxy(T_Bounds const& tightBounds, void* userData)
+{
+	int proxyId = AllocateNode();
+	Node& proxyNode = m_nodes[proxyId];
+	proxyNode.m_bounds = GetFattenedBounds(tightBounds, m_config.m_fatMargin, T_Vec());
+	proxyNode.m_userData = userData;
+	proxyNode.m_moved = true;
+
+	InsertLeaf(proxyId);
+	m_movedProxies.push_back(proxyId);
+	m_proxyCount++;
+	return proxyId;
+}
+
+template <typename T_Bounds, typename T_Vec>
+void DynamicAABBTree<T_Bounds, T_Vec>::DestroyProxy(int proxyId)
+{
+	GUARANTEE_OR_DIE(m_nodes[proxyId].IsLeaf() && (m_nodes[proxyId].m_height == 0), "DESTROYING AN INVALID AABB TREE PROXY");
+
+	RemoveLeaf(proxyId);
+	FreeNode(proxyId);
+	m_proxyCount--;
+}
+
+template <typename T_Bounds, typename T_Vec>
+bool DynamicAABBTree<T_Bounds, T_Vec>::MoveProxy(int proxyId, T_Bounds const& tightBounds, T_Vec const& displacement)
+{
+	T_Bounds const& treeBounds = m_nodes[proxyId].m_bounds;
+	T_Bounds fatBounds = GetFattenedBounds(tightBounds, m_config.m_fatMargin, displacement * m_config.m_displacementMultiplier);
+
+	if (DoesBoundsContain(treeBounds, tightBounds)) {
+		// Still inside, unless the fat bounds became much larger than needed (e.g. after a fast move that stopped)
+		T_Bounds largestAcceptedBounds = GetFattenedBounds(fatBounds, 4.0f * m_config.m_fatMargin, T_Vec());
+		if (DoesBoundsContain(largestAcceptedBounds, treeBounds)) return false;
+	}
+
+	RemoveLeaf(proxyId);
+	m_nodes[proxyId].m_bounds = fatBounds;
+	InsertLeaf(proxyId);
+
+	if (!m_nodes[proxyId].m_moved) {
+		m_nodes[proxyId].m_moved = true;
+		m_movedProxies.push_back(proxyId);
+	}
+	return true;
+}
+
+template <typename T_Bounds, typename T_Vec>
+void DynamicAABBTree<T_Bounds, T_Vec>::Clear()
+{
+	m_nodes.clear();
+	m_movedProxies.clear();
+	m_root = AABB_TREE_NULL_NODE;
+	m_freeList = AABB_TREE_NULL_NODE;
+	m_proxyCount = 0;
+}
+
+template <typename T_Bounds, typename T_Vec>
+void DynamicAABBTree<T_Bounds, T_Vec>::InsertLeaf(int leafIndex)
+{
+	if (m_root == AABB_TREE_NULL_NODE) {
+		m_root = leafIndex;
+		m_nodes[m_root].m_parentOrNext = AABB_TREE_NULL_NODE;
+		return;
+	}
+
+	// Find the best sibling by surface area heuristic. The cost of making a node the sibling is the area of the new parent,
+	// plus the area increase inherited by every ancestor
+	T_Bounds leafBounds = m_nodes[leafIndex].m_bounds;
+	int siblingIndex = m_root;
+	while (!m_nodes[siblingIndex].IsLeaf()) {
+		Node const& node = m_nodes[siblingIndex];
+
+		float nodeCost = GetBoundsSurfaceCost(node.m_bounds);
+		float combinedCost = GetBoundsSurfaceCost(GetBoundsUnion(node.m_bounds, leafBounds));
+
+		float newParentCost = 2.0f * combinedCost;
+		float inheritanceCost = 2.0f * (combinedCost - nodeCost);
+
+		auto getDescendCost = [&](int childIndex) {
+			Node const& child = m_nodes[childIndex];
+			float unionCost = GetBoundsSurfaceCost(GetBoundsUnion(leafBounds, child.m_bounds));
+			if (child.IsLeaf()) return unionCost + inheritanceCost;
+			return (unionCost - GetBoundsSurfaceCost(child.m_bounds)) + inheritanceCost;
+		};
+
+		float costA = getDescendCost(node.m_childA);
+		float costB = getDescendCost(node.m_childB);
+
+		if ((newParentCost < costA) && (newParentCost < costB)) break;
+		siblingIndex = (costA < costB) ? node.m_childA : node.m_childB;
+	}
+
+	// Sibling and leaf become children of a new parent. AllocateNode may grow m_nodes, so no references are kept across it
+	int oldParentIndex = m_nodes[siblingIndex].m_parentOrNext;
+	int newParentIndex = AllocateNode();
+
+	Node& newParent = m_nodes[newParentIndex];
+	newParent.m_parentOrNext = oldParentIndex;
+	newParent.m_bounds = GetBoundsUnion(leafBounds, m_nodes[siblingIndex].m_bounds);
+	newParent.m_height = m_nodes[siblingIndex].m_height + 1;
+	newParent.m_childA = siblingIndex;
+	newParent.m_childB = leafIndex;
+
+	if (oldParentIndex != AABB_TREE_NULL_NODE) {
+		Node& oldParent = m_nodes[oldParentIndex];
+		if (oldParent.m_childA == siblingIndex) {
+			oldParent.m_childA = newParentIndex;
+		}
+		else {
+			oldParent.m_childB = newParentIndex;
+		}
+	}
+	else {
+		m_root = newParentIndex;
+	}
+
+	m_nodes[siblingIndex].m_parentOrNext = newParentIndex;
+	m_nodes[leafIndex].m_parentOrNext = newParentIndex;
+
+	// Walk back up refitting bounds, balancing heights first, then rotating where it lowers the surface cost
+	int nodeIndex = m_nodes[leafIndex].m_parentOrNext;
+	while (nodeIndex != AABB_TREE_NULL_NODE) {
+		nodeIndex = BalanceNode(nodeIndex);
+		RefitNode(nodeIndex);
+		RotateNodes(nodeIndex);
+		nodeIndex = m_nodes[nodeIndex].m_parentOrNext;
+	}
+}
+
+template <typename T_Bounds, typename T_Vec>
+void DynamicAABBTree<T_Bounds, T_Vec>::RemoveLeaf(int leafIndex)
+{
+	if (leafIndex == m_root) {
+		m_root = AABB_TREE_NULL_NODE;
+		return;
+	}
+
+	int parentIndex = m_nodes[leafIndex].m_parentOrNext;
+	int grandParentIndex = m_nodes[parentIndex].m_parentOrNext;
+	int siblingIndex = (m_nodes[parentIndex].m_childA == leafIndex) ? m_nodes[parentIndex].m_childB : m_nodes[parentIndex].m_childA;
+
+	if (grandParentIndex == AABB_TREE_NULL_NODE) {
+		m_root = siblingIndex;
+		m_nodes[siblingIndex].m_parentOrNext = AABB_TREE_NULL_NODE;
+		FreeNode(parentIndex);
+		return;
+	}
+
+	// The sibling takes the parent's place
+	Node& grandParent = m_nodes[grandParentIndex];
+	if (grandParent.m_childA == parentIndex) {
+		grandParent.m_childA = siblingIndex;
+	}
+	else {
+		grandParent.m_childB = siblingIndex;
+	}
+	m_nodes[siblingIndex].m_parentOrNext = grandParentIndex;
+	FreeNode(parentIndex);
+
+	int nodeIndex = grandParentIndex;
+	while (nodeIndex != AABB_TREE_NULL_NODE) {
+		nodeIndex = BalanceNode(nodeIndex);
+		RefitNode(nodeIndex);
+		nodeIndex = m_nodes[nodeIndex].m_parentOrNext;
+	}
+}
+
+template <typename T_Bounds, typename T_Vec>
+void DynamicAABBTree<T_Bounds, T_Vec>::RefitNode(int nodeIndex)
+{
+	Node& node = m_nodes[nodeIndex];
+	Node const& childA = m_nodes[node.m_childA];
+	Node const& childB = m_nodes[node.m_childB];
+	node.m_bounds = GetBoundsUnion(childA.m_bounds, childB.m_bounds);
+	node.m_height = 1 + (std::max)(childA.m_height, childB.m_height);
+}
+
+template <typename T_Bounds, typename T_Vec>
+int DynamicAABBTree<T_Bounds, T_Vec>::BalanceNode(int nodeIndexA)
+{
+	// If one child of A is more than MAX_HEIGHT_DIFFERENCE levels taller, that child is rotated up to take A's place and A takes its shorter child.
+	// Without this, inserting nested or sorted bounds builds a list. Returns the index of the node now at A's place
+	// A has children B and C. The taller one (T) has children, its taller child stays under T and the other moves under A
+	Node& nodeA = m_nodes[nodeIndexA];
+	if (nodeA.IsLeaf() || (nodeA.m_height < 2)) return nodeIndexA;
+
+	int indexB = nodeA.m_childA;
+	int indexC = nodeA.m_childB;
+	int balance = m_nodes[indexC].m_height - m_nodes[indexB].m_height;
+	if ((balance >= -MAX_HEIGHT_DIFFERENCE) && (balance <= MAX_HEIGHT_DIFFERENCE)) return nodeIndexA;
+
+	bool isChildATaller = balance < 0;
+	int tallIndex = (isChildATaller) ? indexB : indexC;
+	int shortIndex = (isChildATaller) ? indexC : indexB;
+	Node& tallNode = m_nodes[tallIndex];
+
+	bool isGrandChildATaller = m_nodes[tallNode.m_childA].m_height > m_nodes[tallNode.m_childB].m_height;
+	int keptIndex = (isGrandChildATaller) ? tallNode.m_childA : tallNode.m_childB;
+	int movedIndex = (isGrandChildATaller) ? tallNode.m_childB : tallNode.m_childA;
+
+	// The tall child takes A's place under A's parent
+	int parentIndex = nodeA.m_parentOrNext;
+	tallNode.m_parentOrNext = parentIndex;
+	if (parentIndex != AABB_TREE_NULL_NODE) {
+		Node& parent = m_nodes[parentIndex];
+		if (parent.m_childA == nodeIndexA) {
+			parent.m_childA = tallIndex;
+		}
+		else {
+			parent.m_childB = tallIndex;
+		}
+	}
+	else {
+		m_root = tallIndex;
+	}
+
+	// A keeps its short child and takes the moved grandchild, the tall node keeps its taller child and takes A
+	nodeA.m_childA = shortIndex;
+	nodeA.m_childB = movedIndex;
+	nodeA.m_parentOrNext = tallIndex;
+	m_nodes[movedIndex].m_parentOrNext = nodeIndexA;
+
+	tallNode.m_childA = nodeIndexA;
+	tallNode.m_childB = keptIndex;
+
+	RefitNode(nodeIndexA);
+	RefitNode(tallIndex);
+	return tallIndex;
+}
+
+template <typename T_Bounds, typename T_Vec>
+void DynamicAABBTree<T_Bounds, T_Vec>::RotateNodes(int nodeIndexA)
+{
+	// Tries swapping a child of A with a grandchild on the other side, keeps the swap that shrinks the surface cost the most.
+	// A's own bounds never change (same leaves below it), only the child that receives the swapped node is refit
+	// A has children B and C, B has children D and E, C has children F and G. Swaps that would unbalance A or the refit child are skipped
+	Node& nodeA = m_nodes[nodeIndexA];
+	if (nodeA.m_height < 2) return;
+
+	int indexB = nodeA.m_childA;
+	int indexC = nodeA.m_childB;
+	Node& nodeB = m_nodes[indexB];
+	Node& nodeC = m_nodes[indexC];
+
+	enum class Rotation { NONE, B_F, B_G, C_D, C_E };
+	Rotation bestRotation = Rotation::NONE;
+	float bestCostDelta = 0.0f;
+
+	if (!nodeC.IsLeaf()) {
+		float costC = GetBoundsSurfaceCost(nodeC.m_bounds);
+		Node const& nodeF = m_nodes[nodeC.m_childA];
+		Node const& nodeG = m_nodes[nodeC.m_childB];
+
+		float costDeltaBF = GetBoundsSurfaceCost(GetBoundsUnion(nodeB.m_bounds, nodeG.m_bounds)) - costC;
+		float costDeltaBG = GetBoundsSurfaceCost(GetBoundsUnion(nodeB.m_bounds, nodeF.m_bounds)) - costC;
+		bool isBalancedBF = IsSwapBalanced(nodeB.m_height, nodeF.m_height, nodeG.m_height);
+		bool isBalancedBG = IsSwapBalanced(nodeB.m_height, nodeG.m_height, nodeF.m_height);
+		if (isBalancedBF && (costDeltaBF < bestCostDelta)) { bestCostDelta = costDeltaBF; bestRotation = Rotation::B_F; }
+		if (isBalancedBG && (costDeltaBG < bestCostDelta)) { bestCostDelta = costDeltaBG; bestRotation = Rotation::B_G; }
+	}
+
+	if (!nodeB.IsLeaf()) {
+		float costB = GetBoundsSurfaceCost(nodeB.m_bounds);
+		Node const& nodeD = m_nodes[nodeB.m_childA];
+		Node const& nodeE = m_nodes[nodeB.m_childB];
+
+		float costDeltaCD = GetBoundsSurfaceCost(GetBoundsUnion(nodeC.m_bounds, nodeE.m_bounds)) - costB;
+		float costDeltaCE = GetBoundsSurfaceCost(GetBoundsUnion(nodeC.m_bounds, nodeD.m_bounds)) - costB;
+		bool isBalancedCD = IsSwapBalanced(nodeC.m_height, nodeD.m_height, nodeE.m_height);
+		bool isBalancedCE = IsSwapBalanced(nodeC.m_height, nodeE.m_height, nodeD.m_height);
+		if (isBalancedCD && (costDeltaCD < bestCostDelta)) { bestCostDelta = costDeltaCD; bestRotation = Rotation::C_D; }
+		if (isBalancedCE && (costDeltaCE < bestCostDelta)) { bestCostDelta = costDeltaCE; bestRotation = Rotation::C_E; }
+	}
+
+	if (bestRotation == Rotation::NONE) return;
+
+	// Swap the child of A (childIndex) with the grandchild (grandChildIndex) under the other child (parentIndex)
+	auto swapNodes = [&](int childIndex, int parentIndex, bool isGrandChildA, bool isChildA) {
+		Node& parent = m_nodes[parentIndex];
+		int grandChildIndex = (isGrandChildA) ? parent.m_childA : parent.m_childB;
+		int keptIndex = (isGrandChildA) ? parent.m_childB : parent.m_childA;
+
+		if (isChildA) {
+			nodeA.m_childA = grandChildIndex;
+		}
+		else {
+			nodeA.m_childB = grandChildIndex;
+		}
+		m_nodes[grandChildIndex].m_parentOrNext = nodeIndexA;
+
+		if (isGrandChildA) {
+			parent.m_childA = childIndex;
+		}
+		else {
+			parent.m_childB = childIndex;
+		}
+		m_nodes[childIndex].m_parentOrNext = parentIndex;
+
+		Node const& child = m_nodes[childIndex];
+		Node const& kept = m_nodes[keptIndex];
+		parent.m_bounds = GetBoundsUnion(child.m_bounds, kept.m_bounds);
+		parent.m_height = 1 + (std::max)(child.m_height, kept.m_height);
+	};
+
+	switch (bestRotation) {
+	case Rotation::B_F: swapNodes(indexB, indexC, true, true); break;
+	case Rotation::B_G: swapNodes(indexB, indexC, false, true); break;
+	case Rotation::C_D: swapNodes(indexC, indexB, true, false); break;
+	case Rotation::C_E: swapNodes(indexC, indexB, false, false); break;
+	default: break;
+	}
+
+	nodeA.m_height = 1 + (std::max)(m_nodes[nodeA.m_childA].m_height, m_nodes[nodeA.m_childB].m_height);
+}
+
+template <typename T_Bounds, typename T_Vec>
+void DynamicAABBTree<T_Bounds, T_Vec>::FindNewPairs(std::vector<DynamicAABBTreePair>& outPairs)
+{
+	outPairs.clear();
+
+	for (int movedProxyId : m_movedProxies) {
+		Node const& movedNode = m_nodes[movedProxyId];
+		if (!movedNode.m_moved || (movedNode.m_height != 0)) continue;
+
+		QueryOverlaps(movedNode.m_bounds, [&](int otherProxyId) {
+			if (otherProxyId == movedProxyId) return true;
+
+			// Both moved: only the lower id reports the pair
+			if (m_nodes[otherProxyId].m_moved && (otherProxyId < movedProxyId)) return true;
+
+			DynamicAABBTreePair newPair;
+			newPair.m_proxyIdA = (std::min)(movedProxyId, otherProxyId);
+			newPair.m_proxyIdB = (std::max)(movedProxyId, otherProxyId);
+			outPairs.push_back(newPair);
+			return true;
+			});
+	}
+
+	for (int movedProxyId : m_movedProxies) {
+		m_nodes[movedProxyId].m_moved = false;
+	}
+	m_movedProxies.clear();
+
+	std::sort(outPairs.begin(), outPairs.end());
+	outPairs.erase(std::unique(outPairs.begin(), outPairs.end()), outPairs.end());
+}
+
+template <typename T_Bounds, typename T_Vec>
+float DynamicAABBTree<T_Bounds, T_Vec>::GetAreaRatio() const
+{
+	if (m_root == AABB_TREE_NULL_NODE) return 0.0f;
+
+	float rootCost = GetBoundsSurfaceCost(m_nodes[m_root].m_bounds);
+	float totalCost = 0.0f;
+	for (Node const& node : m_nodes) {
+		if (node.m_height < 0) continue;
+		totalCost += GetBoundsSurfaceCost(node.m_bounds);
+	}
+
+	return (rootCost > 0.0f) ? totalCost / rootCost : 0.0f;
+}
+
+template class DynamicAABBTree<AABB2, Vec2>;
+template class DynamicAABBTree<AABB3, Vec3>;
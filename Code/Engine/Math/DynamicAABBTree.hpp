@@ -0,0 +1,402 @@
+#pragma once
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include <vector>
+
+/*
+	DYNAMIC AABB TREE (broadphase)
+	Leaves hold fattened bounds of the objects, so an object moving a little does not touch the tree.
+	Insertion walks down choosing the cheapest sibling by surface area heuristic (perimeter in 2D, surface area in 3D),
+	then on the way back up AVL style rotations keep the height logarithmic (within a small slack), and swaps of children with grandchildren
+	are kept whenever they lower the surface cost without unbalancing the node.
+	Queries only report candidates whose fat bounds pass, the narrow phase is up to the callback
+	(DoAABB3sOverlap, RaycastVsDisc, GetNearestPointOnSphere...)
+*/
+
+constexpr int AABB_TREE_NULL_NODE = -1;
+constexpr int AABB_TREE_STACK_SIZE = 256; // Query stack kept on the frame, deeper traversals spill to the heap
+
+//-----------------------------------------------------------------------------------------------
+// Bounds operations the tree is built on, one overload per dimension
+AABB2 GetBoundsUnion(AABB2 const& boundsA, AABB2 const& boundsB);
+AABB3 GetBoundsUnion(AABB3 const& boundsA, AABB3 const& boundsB);
+float GetBoundsSurfaceCost(AABB2 const& bounds);
+float GetBoundsSurfaceCost(AABB3 const& bounds);
+bool DoesBoundsContain(AABB2 const& outerBounds, AABB2 const& innerBounds);
+bool DoesBoundsContain(AABB3 const& outerBounds, AABB3 const& innerBounds);
+AABB2 GetFattenedBounds(AABB2 const& bounds, float margin, Vec2 const& displacement);
+AABB3 GetFattenedBounds(AABB3 const& bounds, float margin, Vec3 const& displacement);
+Vec2 GetRayInverseForward(Vec2 const& rayForward);
+Vec3 GetRayInverseForward(Vec3 const& rayForward);
+
+// Called for every visited node, so they are inline
+inline bool DoBoundsOverlap(AABB2 const& boundsA, AABB2 const& boundsB)
+{
+	return (boundsA.m_mins.x <= boundsB.m_maxs.x) && (boundsB.m_mins.x <= boundsA.m_maxs.x) &&
+		(boundsA.m_mins.y <= boundsB.m_maxs.y) && (boundsB.m_mins.y <= boundsA.m_maxs.y);
+}
+
+inline bool DoBoundsOverlap(AABB3 const& boundsA, AABB3 const& boundsB)
+{
+	return (boundsA.m_mins.x <= boundsB.m_maxs.x) && (boundsB.m_mins.x <= boundsA.m_maxs.x) &&
+		(boundsA.m_mins.y <= boundsB.m_maxs.y) && (boundsB.m_mins.y <= boundsA.m_maxs.y) &&
+		(boundsA.m_mins.z <= boundsB.m_maxs.z) && (boundsB.m_mins.z <= boundsA.m_maxs.z);
+}
+
+inline float GetAxisDistanceToRange(float value, float rangeMin, float rangeMax)
+{
+	if (value < rangeMin) return rangeMin - value;
+	if (value > rangeMax) return value - rangeMax;
+	return 0.0f;
+}
+
+inline float GetDistanceSquaredToBounds(Vec2 const& point, AABB2 const& bounds)
+{
+	float distanceX = GetAxisDistanceToRange(point.x, bounds.m_mins.x, bounds.m_maxs.x);
+	float distanceY = GetAxisDistanceToRange(point.y, bounds.m_mins.y, bounds.m_maxs.y);
+	return (distanceX * distanceX) + (distanceY * distanceY);
+}
+
+inline float GetDistanceSquaredToBounds(Vec3 const& point, AABB3 const& bounds)
+{
+	float distanceX = GetAxisDistanceToRange(point.x, bounds.m_mins.x, bounds.m_maxs.x);
+	float distanceY = GetAxisDistanceToRange(point.y, bounds.m_mins.y, bounds.m_maxs.y);
+	float distanceZ = GetAxisDistanceToRange(point.z, bounds.m_mins.z, bounds.m_maxs.z);
+	return (distanceX * distanceX) + (distanceY * distanceY) + (distanceZ * distanceZ);
+}
+
+// Clips [entry, exit] against one slab. Axis aligned rays get an infinite inverse, which the comparisons handle
+inline void ClipRayToSlab(float rayStart, float rayInverseForward, float slabMin, float slabMax, float& entryDistance, float& exitDistance)
+{
+	float distanceToMin = (slabMin - rayStart) * rayInverseForward;
+	float distanceToMax = (slabMax - rayStart) * rayInverseForward;
+	float slabEntry = (distanceToMin < distanceToMax) ? distanceToMin : distanceToMax;
+	float slabExit = (distanceToMin < distanceToMax) ? distanceToMax : distanceToMin;
+	entryDistance = (slabEntry > entryDistance) ? slabEntry : entryDistance;
+	exitDistance = (slabExit < exitDistance) ? slabExit : exitDistance;
+}
+
+// Slab test against [0, maxDistance]. Rays starting inside the bounds report an entry distance of 0
+inline bool DoesRayHitBounds(Vec2 const& rayStart, Vec2 const& rayInverseForward, float maxDistance, AABB2 const& bounds, float& outEntryDistance)
+{
+	float entryDistance = 0.0f;
+	float exitDistance = maxDistance;
+	ClipRayToSlab(rayStart.x, rayInverseForward.x, bounds.m_mins.x, bounds.m_maxs.x, entryDistance, exitDistance);
+	ClipRayToSlab(rayStart.y, rayInverseForward.y, bounds.m_mins.y, bounds.m_maxs.y, entryDistance, exitDistance);
+	outEntryDistance = entryDistance;
+	return entryDistance <= exitDistance;
+}
+
+inline bool DoesRayHitBounds(Vec3 const& rayStart, Vec3 const& rayInverseForward, float maxDistance, AABB3 const& bounds, float& outEntryDistance)
+{
+	float entryDistance = 0.0f;
+	float exitDistance = maxDistance;
+	ClipRayToSlab(rayStart.x, rayInverseForward.x, bounds.m_mins.x, bounds.m_maxs.x, entryDistance, exitDistance);
+	ClipRayToSlab(rayStart.y, rayInverseForward.y, bounds.m_mins.y, bounds.m_maxs.y, entryDistance, exitDistance);
+	ClipRayToSlab(rayStart.z, rayInverseForward.z, bounds.m_mins.z, bounds.m_maxs.z, entryDistance, exitDistance);
+	outEntryDistance = entryDistance;
+	return entryDistance <= exitDistance;
+}
+
+//-----------------------------------------------------------------------------------------------
+// Traversal stack of the queries. Lives on the stack frame and only allocates if a traversal needs more than AABB_TREE_STACK_SIZE
+class DynamicAABBTreeNodeStack {
+public:
+	DynamicAABBTreeNodeStack() = default;
+	DynamicAABBTreeNodeStack(DynamicAABBTreeNodeStack const& copyFrom) = delete;
+	DynamicAABBTreeNodeStack& operator=(DynamicAABBTreeNodeStack const& copyFrom) = delete;
+
+	void Push(int nodeIndex)
+	{
+		if (m_count == m_capacity) Grow();
+		m_nodes[m_count++] = nodeIndex;
+	}
+	int Pop() { return m_nodes[--m_count]; }
+	bool IsEmpty() const { return m_count == 0; }
+
+private:
+	void Grow()
+	{
+		if (m_nodes == m_localNodes) {
+			m_heapNodes.assign(m_localNodes, m_localNodes + m_count);
+		}
+		m_capacity *= 2;
+		m_heapNodes.resize(m_capacity);
+		m_nodes = m_heapNodes.data();
+	}
+
+private:
+	int m_localNodes[AABB_TREE_STACK_SIZE];
+	std::vector<int> m_heapNodes;
+	int* m_nodes = m_localNodes;
+	int m_count = 0;
+	int m_capacity = AABB_TREE_STACK_SIZE;
+};
+
+//-----------------------------------------------------------------------------------------------
+template <typename T_Vec>
+struct DynamicAABBTreeRay {
+	T_Vec m_start;
+	T_Vec m_forward; // Normalized
+	float m_maxDistance = 0.0f;
+};
+
+struct DynamicAABBTreeHit {
+	int m_proxyId = AABB_TREE_NULL_NODE;
+	float m_distance = 0.0f;
+	bool DidHit() const { return m_proxyId != AABB_TREE_NULL_NODE; }
+};
+
+struct DynamicAABBTreeOverlap {
+	int m_queryIndex = 0;
+	int m_proxyId = AABB_TREE_NULL_NODE;
+};
+
+struct DynamicAABBTreePair {
+	int m_proxyIdA = AABB_TREE_NULL_NODE; // Always the lower id
+	int m_proxyIdB = AABB_TREE_NULL_NODE;
+
+	bool operator<(DynamicAABBTreePair const& other) const { return (m_proxyIdA < other.m_proxyIdA) || ((m_proxyIdA == other.m_proxyIdA) && (m_proxyIdB < other.m_proxyIdB)); }
+	bool operator==(DynamicAABBTreePair const& other) const { return (m_proxyIdA == other.m_proxyIdA) && (m_proxyIdB == other.m_proxyIdB); }
+};
+
+struct DynamicAABBTreeConfig {
+	float m_fatMargin = 0.1f; // Added on every side of the tight bounds
+	float m_displacementMultiplier = 4.0f; // Fat bounds are stretched along the displacement to predict motion
+};
+
+template <typename T_Bounds>
+struct DynamicAABBTreeNode {
+	T_Bounds m_bounds; // Fat bounds for leaves, union of the children otherwise
+	void* m_userData = nullptr;
+	int m_parentOrNext = AABB_TREE_NULL_NODE; // Next free node while in the free list
+	int m_childA = AABB_TREE_NULL_NODE;
+	int m_childB = AABB_TREE_NULL_NODE;
+	int m_height = -1; // 0 for leaves, -1 for free nodes
+	bool m_moved = false;
+
+	bool IsLeaf() const { return m_childA == AABB_TREE_NULL_NODE; }
+};
+
+//-----------------------------------------------------------------------------------------------
+template <typename T_Bounds, typename T_Vec>
+class DynamicAABBTree {
+public:
+	typedef DynamicAABBTreeNode<T_Bounds> Node;
+	typedef DynamicAABBTreeRay<T_Vec> Ray;
+
+	DynamicAABBTree(DynamicAABBTreeConfig const& config = DynamicAABBTreeConfig());
+	~DynamicAABBTree();
+
+	// Proxies are node indices, stable until destroyed
+	int CreateProxy(T_Bounds const& tightBounds, void* userData);
+	void DestroyProxy(int proxyId);
+	// Returns true if the proxy had to be reinserted. displacement is the expected motion until the next move
+	bool MoveProxy(int proxyId, T_Bounds const& tightBounds, T_Vec const& displacement);
+	void Clear();
+
+	void* GetUserData(int proxyId) const { return m_nodes[proxyId].m_userData; }
+	T_Bounds const& GetFatBounds(int proxyId) const { return m_nodes[proxyId].m_bounds; }
+	int GetProxyCount() const { return m_proxyCount; }
+	int GetHeight() const { return (m_root == AABB_TREE_NULL_NODE) ? 0 : m_nodes[m_root].m_height; }
+	float GetAreaRatio() const; // Sum of every node cost over the root cost, lower is a better tree
+
+	// Pairs of overlapping fat bounds where at least one proxy was created or reinserted since the last call. Sorted and unique
+	void FindNewPairs(std::vector<DynamicAABBTreePair>& outPairs);
+
+	// T_Callback: bool(int proxyId), return false to stop the query
+	template <typename T_Callback>
+	void QueryOverlaps(T_Bounds const& queryBounds, T_Callback&& callback) const;
+
+	// T_Callback: float(int proxyId, float maxDistance), returns the narrow phase hit distance, or a negative value on a miss.
+	// The ray is clipped to the closest hit so far, so farther candidates are culled
+	template <typename T_Callback>
+	DynamicAABBTreeHit Raycast(Ray const& ray, T_Callback&& callback) const;
+
+	// T_Callback: float(int proxyId), returns the exact distance from the point to the proxy object (negative to ignore it)
+	template <typename T_Callback>
+	DynamicAABBTreeHit FindNearest(T_Vec const& point, float maxDistance, T_Callback&& callback) const;
+
+	// Batched versions. Callbacks get the query index first. Results are written to flat arrays, no allocation per query
+	template <typename T_Callback>
+	void QueryOverlapsBatch(T_Bounds const* queryBounds, int queryCount, T_Callback&& narrowPhase, std::vector<DynamicAABBTreeOverlap>& outOverlaps) const;
+	template <typename T_Callback>
+	void RaycastBatch(Ray const* rays, int rayCount, T_Callback&& narrowPhase, DynamicAABBTreeHit* outHits) const;
+	template <typename T_Callback>
+	void FindNearestBatch(T_Vec const* points, int pointCount, float maxDistance, T_Callback&& narrowPhase, DynamicAABBTreeHit* outHits) const;
+
+private:
+	int AllocateNode();
+	void FreeNode(int nodeIndex);
+	void InsertLeaf(int leafIndex);
+	void RemoveLeaf(int leafIndex);
+	void RefitNode(int nodeIndex);
+	int BalanceNode(int nodeIndex);
+	void RotateNodes(int nodeIndex);
+
+private:
+	DynamicAABBTreeConfig m_config;
+	std::vector<Node> m_nodes;
+	std::vector<int> m_movedProxies;
+	int m_root = AABB_TREE_NULL_NODE;
+	int m_freeList = AABB_TREE_NULL_NODE;
+	int m_proxyCount = 0;
+};
+
+typedef DynamicAABBTree<AABB2, Vec2> DynamicAABBTree2D;
+typedef DynamicAABBTree<AABB3, Vec3> DynamicAABBTree3D;
+
+//-----------------------------------------------------------------------------------------------
+// Queries are templated on the callback so the narrow phase inlines. Tree maintenance lives in DynamicAABBTree.cpp
+template <typename T_Bounds, typename T_Vec>
+template <typename T_Callback>
+void DynamicAABBTree<T_Bounds, T_Vec>::QueryOverlaps(T_Bounds const& queryBounds, T_Callback&& callback) const
+{
+	if (m_root == AABB_TREE_NULL_NODE) return;
+
+	DynamicAABBTreeNodeStack nodeStack;
+	nodeStack.Push(m_root);
+
+	while (!nodeStack.IsEmpty()) {
+		Node const& node = m_nodes[nodeStack.Pop()];
+		if (!DoBoundsOverlap(node.m_bounds, queryBounds)) continue;
+
+		if (node.IsLeaf()) {
+			int proxyId = (int)(&node - m_nodes.data());
+			if (!callback(proxyId)) return;
+		}
+		else {
+			nodeStack.Push(node.m_childA);
+			nodeStack.Push(node.m_childB);
+		}
+	}
+}
+
+template <typename T_Bounds, typename T_Vec>
+template <typename T_Callback>
+DynamicAABBTreeHit DynamicAABBTree<T_Bounds, T_Vec>::Raycast(Ray const& ray, T_Callback&& callback) const
+{
+	DynamicAABBTreeHit closestHit;
+	if (m_root == AABB_TREE_NULL_NODE) return closestHit;
+
+	T_Vec rayInverseForward = GetRayInverseForward(ray.m_forward);
+	float maxDistance = ray.m_maxDistance;
+
+	DynamicAABBTreeNodeStack nodeStack;
+	nodeStack.Push(m_root);
+
+	while (!nodeStack.IsEmpty()) {
+		int nodeIndex = nodeStack.Pop();
+		Node const& node = m_nodes[nodeIndex];
+
+		float entryDistance = 0.0f;
+		if (!DoesRayHitBounds(ray.m_start, rayInverseForward, maxDistance, node.m_bounds, entryDistance)) continue;
+
+		if (node.IsLeaf()) {
+			float hitDistance = callback(nodeIndex, maxDistance);
+			if ((hitDistance >= 0.0f) && (hitDistance <= maxDistance)) {
+				maxDistance = hitDistance;
+				closestHit.m_proxyId = nodeIndex;
+				closestHit.m_distance = hitDistance;
+			}
+			continue;
+		}
+
+		// Visit the nearer child first, it is the most likely to clip the ray
+		float entryA = 0.0f;
+		float entryB = 0.0f;
+		bool hitsA = DoesRayHitBounds(ray.m_start, rayInverseForward, maxDistance, m_nodes[node.m_childA].m_bounds, entryA);
+		bool hitsB = DoesRayHitBounds(ray.m_start, rayInverseForward, maxDistance, m_nodes[node.m_childB].m_bounds, entryB);
+
+		if (hitsA && hitsB) {
+			bool isANearer = entryA <= entryB;
+			nodeStack.Push((isANearer) ? node.m_childB : node.m_childA);
+			nodeStack.Push((isANearer) ? node.m_childA : node.m_childB);
+		}
+		else if (hitsA) {
+			nodeStack.Push(node.m_childA);
+		}
+		else if (hitsB) {
+			nodeStack.Push(node.m_childB);
+		}
+	}
+
+	return closestHit;
+}
+
+template <typename T_Bounds, typename T_Vec>
+template <typename T_Callback>
+DynamicAABBTreeHit DynamicAABBTree<T_Bounds, T_Vec>::FindNearest(T_Vec const& point, float maxDistance, T_Callback&& callback) const
+{
+	DynamicAABBTreeHit nearestHit;
+	if (m_root == AABB_TREE_NULL_NODE) return nearestHit;
+
+	float maxDistanceSquared = maxDistance * maxDistance;
+
+	DynamicAABBTreeNodeStack nodeStack;
+	nodeStack.Push(m_root);
+
+	while (!nodeStack.IsEmpty()) {
+		int nodeIndex = nodeStack.Pop();
+		Node const& node = m_nodes[nodeIndex];
+
+		if (GetDistanceSquaredToBounds(point, node.m_bounds) > maxDistanceSquared) continue;
+
+		if (node.IsLeaf()) {
+			float distance = callback(nodeIndex);
+			if ((distance >= 0.0f) && ((distance * distance) <= maxDistanceSquared)) {
+				maxDistanceSquared = distance * distance;
+				nearestHit.m_proxyId = nodeIndex;
+				nearestHit.m_distance = distance;
+			}
+			continue;
+		}
+
+		float distanceSquaredA = GetDistanceSquaredToBounds(point, m_nodes[node.m_childA].m_bounds);
+		float distanceSquaredB = GetDistanceSquaredToBounds(point, m_nodes[node.m_childB].m_bounds);
+
+		bool isANearer = distanceSquaredA <= distanceSquaredB;
+		nodeStack.Push((isANearer) ? node.m_childB : node.m_childA);
+		nodeStack.Push((isANearer) ? node.m_childA : node.m_childB);
+	}
+
+	return nearestHit;
+}
+
+template <typename T_Bounds, typename T_Vec>
+template <typename T_Callback>
+void DynamicAABBTree<T_Bounds, T_Vec>::QueryOverlapsBatch(T_Bounds const* queryBounds, int queryCount, T_Callback&& narrowPhase, std::vector<DynamicAABBTreeOverlap>& outOverlaps) const
+{
+	for (int queryIndex = 0; queryIndex < queryCount; queryIndex++) {
+		QueryOverlaps(queryBounds[queryIndex], [&](int proxyId) {
+			if (narrowPhase(queryIndex, proxyId)) {
+				outOverlaps.push_back(DynamicAABBTreeOverlap{ queryIndex, proxyId });
+			}
+			return true;
+			});
+	}
+}
+
+template <typename T_Bounds, typename T_Vec>
+template <typename T_Callback>
+void DynamicAABBTree<T_Bounds, T_Vec>::RaycastBatch(Ray const* rays, int rayCount, T_Callback&& narrowPhase, DynamicAABBTreeHit* outHits) const
+{
+	for (int rayIndex = 0; rayIndex < rayCount; rayIndex++) {
+		outHits[rayIndex] = Raycast(rays[rayIndex], [&](int proxyId, float maxDistance) {
+			return narrowPhase(rayIndex, proxyId, maxDistance);
+			});
+	}
+}
+
+template <typename T_Bounds, typename T_Vec>
+template <typename T_Callback>
+void DynamicAABBTree<T_Bounds, T_Vec>::FindNearestBatch(T_Vec const* points, int pointCount, float maxDistance, T_Callback&& narrowPhase, DynamicAABBTreeHit* outHits) const
+{
+	for (int pointIndex = 0; pointIndex < pointCount; pointIndex++) {
+		outHits[pointIndex] = FindNearest(points[pointIndex], maxDistance, [&](int proxyId) {
+			return narrowPhase(pointIndex, proxyId);
+			});
+	}
+}
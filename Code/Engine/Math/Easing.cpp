@@ -92,3 +92,18 @@ float CustomEasingFunction(float tZeroToOne)
 	return  fabsf(thing) + (thing * 0.1f);
 }
 
+float ApplyEasing(EasingType easingType, float tZeroToOne)
+{
+	switch (easingType) {
+	case EasingType::STEP: return (tZeroToOne >= 1.0f) ? 1.0f : 0.0f;
+	case EasingType::LINEAR: return tZeroToOne;
+	case EasingType::SMOOTH_START_2: return SmoothStart2(tZeroToOne);
+	case EasingType::SMOOTH_START_3: return SmoothStart3(tZeroToOne);
+	case EasingType::SMOOTH_STOP_2: return SmoothStop2(tZeroToOne);
+	case EasingType::SMOOTH_STOP_3: return SmoothStop3(tZeroToOne);
+	case EasingType::SMOOTH_STEP_3: return SmoothStep3(tZeroToOne);
+	case EasingType::SMOOTH_STEP_5: return SmoothStep5(tZeroToOne);
+	case EasingType::HESITATE_3: return Hesitate3(tZeroToOne);
+	default: return tZeroToOne;
+	}
+}
@@ -1,5 +1,19 @@
 #pragma once
 
+// Easing picked by value, for data driven curves such as keyframes
+enum class EasingType : unsigned char {
+	STEP, // Holds the start value until the end
+	LINEAR,
+	SMOOTH_START_2,
+	SMOOTH_START_3,
+	SMOOTH_STOP_2,
+	SMOOTH_STOP_3,
+	SMOOTH_STEP_3,
+	SMOOTH_STEP_5,
+	HESITATE_3,
+	COUNT
+};
+
 float SmoothStart2(float tZeroToOne);
 float SmoothStart3(float tZeroToOne);
 float SmoothStart4(float tZeroToOne);
@@ -17,4 +31,6 @@ float SmoothStep5(float tZeroToOne);
 float Hesitate3(float tZeroToOne);
 float Hesitate5(float tZeroToOne);
 
-float CustomEasingFunction(float tZeroToOne);
\ No newline at end of file
+float CustomEasingFunction(float tZeroToOne);
+
+float ApplyEasing(EasingType easingType, float tZeroToOne);
@@ -0,0 +1,312 @@
+#include "Engine/Math/GeometricPredicates.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include <cmath>
+
+namespace {
+	// An expansion is a sum of doubles, sorted by increasing magnitude and not overlapping, whose exact value is the sum of its
+	// components. Its sign is the sign of the last (largest) component. Zero components are dropped as they are produced
+	constexpr double HALF_EPSILON = 1.1102230246251565e-16; // 2^-53
+	constexpr double SPLITTER = 134217729.0; // 2^27 + 1, splits a double into two 26 bit halves
+	constexpr double ORIENT_ERROR_BOUND = (3.0 + (16.0 * HALF_EPSILON)) * HALF_EPSILON;
+	constexpr double IN_CIRCLE_ERROR_BOUND = (10.0 + (96.0 * HALF_EPSILON)) * HALF_EPSILON;
+	constexpr int MAX_PRODUCT_FACTOR_LENGTH = 16;
+
+	inline void FastTwoSum(double a, double b, double& sum, double& error)
+	{
+		sum = a + b;
+		error = b - (sum - a);
+	}
+
+	inline void TwoSum(double a, double b, double& sum, double& error)
+	{
+		sum = a + b;
+		double bVirtual = sum - a;
+		double aVirtual = sum - bVirtual;
+		error = (a - aVirtual) + (b - bVirtual);
+	}
+
+	// Returns the length, 1 when the difference is exact in double, which is the common case with float inputs
+	inline int TwoDiff(double a, double b, double* outExpansion)
+	{
+		double diff = a - b;
+		double bVirtual = a - diff;
+		double aVirtual = diff + bVirtual;
+		double error = (a - aVirtual) + (bVirtual - b);
+		if (error == 0.0) {
+			outExpansion[0] = diff;
+			return 1;
+		}
+		outExpansion[0] = error;
+		outExpansion[1] = diff;
+		return 2;
+	}
+
+	inline void Split(double a, double& high, double& low)
+	{
+		double c = SPLITTER * a;
+		high = c - (c - a);
+		low = a - high;
+	}
+
+	inline void TwoProductPresplit(double a, double b, double bHigh, double bLow, double& product, double& error)
+	{
+		product = a * b;
+		double aHigh = 0.0;
+		double aLow = 0.0;
+		Split(a, aHigh, aLow);
+		double err1 = product - (aHigh * bHigh);
+		double err2 = err1 - (aLow * bHigh);
+		double err3 = err2 - (aHigh * bLow);
+		error = (aLow * bLow) - err3;
+	}
+
+	// Zero eliminating merge of two expansions, outExpansion holds up to lengthE + lengthF components
+	int FastExpansionSum(int lengthE, double const* e, int lengthF, double const* f, double* outExpansion)
+	{
+		int indexE = 0;
+		int indexF = 0;
+		int outLength = 0;
+		double nowE = e[0];
+		double nowF = f[0];
+		double sum = 0.0;
+		double newSum = 0.0;
+		double error = 0.0;
+
+		auto advanceE = [&]() { indexE++; nowE = (indexE < lengthE) ? e[indexE] : 0.0; };
+		auto advanceF = [&]() { indexF++; nowF = (indexF < lengthF) ? f[indexF] : 0.0; };
+
+		if ((nowF > nowE) == (nowF > -nowE)) {
+			sum = nowE;
+			advanceE();
+		}
+		else {
+			sum = nowF;
+			advanceF();
+		}
+
+		if ((indexE < lengthE) && (indexF < lengthF)) {
+			if ((nowF > nowE) == (nowF > -nowE)) {
+				FastTwoSum(nowE, sum, newSum, error);
+				advanceE();
+			}
+			else {
+				FastTwoSum(nowF, sum, newSum, error);
+				advanceF();
+			}
+			sum = newSum;
+			if (error != 0.0) outExpansion[outLength++] = error;
+
+			while ((indexE < lengthE) && (indexF < lengthF)) {
+				if ((nowF > nowE) == (nowF > -nowE)) {
+					TwoSum(sum, nowE, newSum, error);
+					advanceE();
+				}
+				else {
+					TwoSum(sum, nowF, newSum, error);
+					advanceF();
+				}
+				sum = newSum;
+				if (error != 0.0) outExpansion[outLength++] = error;
+			}
+		}
+
+		while (indexE < lengthE) {
+			TwoSum(sum, nowE, newSum, error);
+			advanceE();
+			sum = newSum;
+			if (error != 0.0) outExpansion[outLength++] = error;
+		}
+
+		while (indexF < lengthF) {
+			TwoSum(sum, nowF, newSum, error);
+			advanceF();
+			sum = newSum;
+			if (error != 0.0) outExpansion[outLength++] = error;
+		}
+
+		if ((sum != 0.0) || (outLength == 0)) {
+			outExpansion[outLength++] = sum;
+		}
+		return outLength;
+	}
+
+	// Zero eliminating product of an expansion and a double, outExpansion holds up to 2 * lengthE components
+	int ScaleExpansion(int lengthE, double const* e, double b, double* outExpansion)
+	{
+		double bHigh = 0.0;
+		double bLow = 0.0;
+		Split(b, bHigh, bLow);
+
+		double accumulated = 0.0;
+		double error = 0.0;
+		int outLength = 0;
+		TwoProductPresplit(e[0], b, bHigh, bLow, accumulated, error);
+		if (error != 0.0) outExpansion[outLength++] = error;
+
+		for (int indexE = 1; indexE < lengthE; indexE++) {
+			double product = 0.0;
+			double productError = 0.0;
+			TwoProductPresplit(e[indexE], b, bHigh, bLow, product, productError);
+
+			double sum = 0.0;
+			TwoSum(accumulated, productError, sum, error);
+			if (error != 0.0) outExpansion[outLength++] = error;
+
+			FastTwoSum(product, sum, accumulated, error);
+			if (error != 0.0) outExpansion[outLength++] = error;
+		}
+
+		if ((accumulated != 0.0) || (outLength == 0)) {
+			outExpansion[outLength++] = accumulated;
+		}
+		return outLength;
+	}
+
+	// outExpansion and scratch each hold up to 2 * lengthE * lengthF components
+	int MultiplyExpansions(int lengthE, double const* e, int lengthF, double const* f, double* outExpansion, double* scratch)
+	{
+		ASSERT_OR_DIE(lengthE <= MAX_PRODUCT_FACTOR_LENGTH, "Expansion factor is longer than the predicates ever produce");
+
+		double scaled[MAX_PRODUCT_FACTOR_LENGTH * 2];
+		int outLength = ScaleExpansion(lengthE, e, f[0], outExpansion);
+		for (int indexF = 1; indexF < lengthF; indexF++) {
+			int scaledLength = ScaleExpansion(lengthE, e, f[indexF], scaled);
+			int sumLength = FastExpansionSum(outLength, outExpansion, scaledLength, scaled, scratch);
+			for (int index = 0; index < sumLength; index++) {
+				outExpansion[index] = scratch[index];
+			}
+			outLength = sumLength;
+		}
+		return outLength;
+	}
+
+	void NegateExpansion(int length, double* expansion)
+	{
+		for (int index = 0; index < length; index++) {
+			expansion[index] = -expansion[index];
+		}
+	}
+
+	// An expansion of up to two components, as the differences of the inputs are
+	struct ShortExpansion {
+		double m_components[2] = {};
+		int m_length = 0;
+	};
+
+	ShortExpansion GetDifference(double a, double b)
+	{
+		ShortExpansion difference;
+		difference.m_length = TwoDiff(a, b, difference.m_components);
+		return difference;
+	}
+
+	// Exactly a * d - b * c, up to 16 components
+	int TwoByTwoDeterminant(ShortExpansion const& a, ShortExpansion const& d, ShortExpansion const& b, ShortExpansion const& c, double* outExpansion)
+	{
+		double scratch[8];
+		double left[8];
+		double right[8];
+		int leftLength = MultiplyExpansions(a.m_length, a.m_components, d.m_length, d.m_components, left, scratch);
+		int rightLength = MultiplyExpansions(b.m_length, b.m_components, c.m_length, c.m_components, right, scratch);
+		NegateExpansion(rightLength, right);
+		return FastExpansionSum(leftLength, left, rightLength, right, outExpansion);
+	}
+
+	double Orient2DExact(double ax, double ay, double bx, double by, double cx, double cy)
+	{
+		double determinant[16];
+		int length = TwoByTwoDeterminant(GetDifference(ax, cx), GetDifference(by, cy), GetDifference(ay, cy), GetDifference(bx, cx), determinant);
+		return determinant[length - 1];
+	}
+
+	// lift * (x1 * y2 - x2 * y1) for one row of the in circle determinant, up to 512 components
+	int InCircleTerm(ShortExpansion const& liftX, ShortExpansion const& liftY, ShortExpansion const& x1, ShortExpansion const& y2, ShortExpansion const& x2, ShortExpansion const& y1, double* outExpansion)
+	{
+		double scratch[512];
+		double squareX[8];
+		double squareY[8];
+		double lift[16];
+		double minor[16];
+		int squareXLength = MultiplyExpansions(liftX.m_length, liftX.m_components, liftX.m_length, liftX.m_components, squareX, scratch);
+		int squareYLength = MultiplyExpansions(liftY.m_length, liftY.m_components, liftY.m_length, liftY.m_components, squareY, scratch);
+		int liftLength = FastExpansionSum(squareXLength, squareX, squareYLength, squareY, lift);
+		int minorLength = TwoByTwoDeterminant(x1, y2, x2, y1, minor);
+		return MultiplyExpansions(liftLength, lift, minorLength, minor, outExpansion, scratch);
+	}
+
+	double InCircle2DExact(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy)
+	{
+		ShortExpansion adx = GetDifference(ax, dx);
+		ShortExpansion ady = GetDifference(ay, dy);
+		ShortExpansion bdx = GetDifference(bx, dx);
+		ShortExpansion bdy = GetDifference(by, dy);
+		ShortExpansion cdx = GetDifference(cx, dx);
+		ShortExpansion cdy = GetDifference(cy, dy);
+
+		double termA[512];
+		double termB[512];
+		double termC[512];
+		int lengthA = InCircleTerm(adx, ady, bdx, cdy, cdx, bdy, termA);
+		int lengthB = InCircleTerm(bdx, bdy, cdx, ady, adx, cdy, termB);
+		int lengthC = InCircleTerm(cdx, cdy, adx, bdy, bdx, ady, termC);
+
+		double sumAB[1024];
+		double determinant[1536];
+		int lengthAB = FastExpansionSum(lengthA, termA, lengthB, termB, sumAB);
+		int length = FastExpansionSum(lengthAB, sumAB, lengthC, termC, determinant);
+		return determinant[length - 1];
+	}
+}
+
+double Orient2D(double ax, double ay, double bx, double by, double cx, double cy)
+{
+	double detLeft = (ax - cx) * (by - cy);
+	double detRight = (ay - cy) * (bx - cx);
+	double determinant = detLeft - detRight;
+
+	double errorBound = ORIENT_ERROR_BOUND * (fabs(detLeft) + fabs(detRight));
+	if ((determinant > errorBound) || (-determinant > errorBound)) {
+		return determinant;
+	}
+	return Orient2DExact(ax, ay, bx, by, cx, cy);
+}
+
+double Orient2D(Vec2 const& pointA, Vec2 const& pointB, Vec2 const& pointC)
+{
+	return Orient2D(pointA.x, pointA.y, pointB.x, pointB.y, pointC.x, pointC.y);
+}
+
+double InCircle2D(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy)
+{
+	double adx = ax - dx;
+	double ady = ay - dy;
+	double bdx = bx - dx;
+	double bdy = by - dy;
+	double cdx = cx - dx;
+	double cdy = cy - dy;
+
+	double bdxcdy = bdx * cdy;
+	double cdxbdy = cdx * bdy;
+	double cdxady = cdx * ady;
+	double adxcdy = adx * cdy;
+	double adxbdy = adx * bdy;
+	double bdxady = bdx * ady;
+
+	double aLift = (adx * adx) + (ady * ady);
+	double bLift = (bdx * bdx) + (bdy * bdy);
+	double cLift = (cdx * cdx) + (cdy * cdy);
+
+	double determinant = (aLift * (bdxcdy - cdxbdy)) + (bLift * (cdxady - adxcdy)) + (cLift * (adxbdy - bdxady));
+	double permanent = ((fabs(bdxcdy) + fabs(cdxbdy)) * aLift) + ((fabs(cdxady) + fabs(adxcdy)) * bLift) + ((fabs(adxbdy) + fabs(bdxady)) * cLift);
+
+	double errorBound = IN_CIRCLE_ERROR_BOUND * permanent;
+	if ((determinant > errorBound) || (-determinant > errorBound)) {
+		return determinant;
+	}
+	return InCircle2DExact(ax, ay, bx, by, cx, cy, dx, dy);
+}
+
+double InCircle2D(Vec2 const& pointA, Vec2 const& pointB, Vec2 const& pointC, Vec2 const& pointD)
+{
+	return InCircle2D(pointA.x, pointA.y, pointB.x, pointB.y, pointC.x, pointC.y, pointD.x, pointD.y);
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+
+// Shewchuk's adaptive predicates: a double precision estimate with an error bound, and when its sign is in doubt the determinant
+// is recomputed exactly with floating point expansions. The sign of the result is always exact for double inputs, the magnitude
+// is only an estimate. Float inputs are promoted to double without loss
+
+// > 0 when a, b and c wind counterclockwise, < 0 when clockwise, 0 when they are collinear
+double Orient2D(double ax, double ay, double bx, double by, double cx, double cy);
+double Orient2D(Vec2 const& pointA, Vec2 const& pointB, Vec2 const& pointC);
+
+// > 0 when d is inside the circle through a, b and c, which must wind counterclockwise. < 0 outside, 0 on the circle
+double InCircle2D(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy);
+double InCircle2D(Vec2 const& pointA, Vec2 const& pointB, Vec2 const& pointC, Vec2 const& pointD);
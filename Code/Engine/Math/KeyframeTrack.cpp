@@ -0,0 +1,152 @@
+#include "Engine/Math/KeyframeTrack.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include <algorithm>
+
+namespace {
+	float InterpolateKeyValues(float startValue, float endValue, float fraction)
+	{
+		return Interpolate(startValue, endValue, fraction);
+	}
+
+	Vec3 const InterpolateKeyValues(Vec3 const& startValue, Vec3 const& endValue, float fraction)
+	{
+		return Vec3::InterpolateVec3(fraction, startValue, endValue);
+	}
+
+	Rgba8 const InterpolateKeyValues(Rgba8 const& startValue, Rgba8 const& endValue, float fraction)
+	{
+		return Rgba8::InterpolateColors(startValue, endValue, fraction);
+	}
+
+	// time must be strictly between the first and last key. Segments of zero length never contain a time
+	int FindSegment(float const* times, int keyCount, float time, int segmentHint)
+	{
+		int lastSegment = keyCount - 2;
+		segmentHint = (segmentHint < 0) ? 0 : ((segmentHint > lastSegment) ? lastSegment : segmentHint);
+		if ((times[segmentHint] <= time) && (time < times[segmentHint + 1])) return segmentHint;
+		if ((segmentHint < lastSegment) && (times[segmentHint + 1] <= time) && (time < times[segmentHint + 2])) return segmentHint + 1;
+
+		return (int)(std::upper_bound(times, times + keyCount, time) - times) - 1;
+	}
+
+	template <typename T_Value>
+	T_Value const SampleKeys(float const* times, T_Value const* values, EasingType const* easings, int keyCount, float time, int& segmentHint)
+	{
+		if (keyCount == 0) return T_Value();
+		if ((keyCount == 1) || (time <= times[0])) {
+			segmentHint = 0;
+			return values[0];
+		}
+		if (time >= times[keyCount - 1]) {
+			segmentHint = keyCount - 2;
+			return values[keyCount - 1];
+		}
+
+		int segment = FindSegment(times, keyCount, time, segmentHint);
+		segmentHint = segment;
+
+		float fraction = (time - times[segment]) / (times[segment + 1] - times[segment]);
+		return InterpolateKeyValues(values[segment], values[segment + 1], ApplyEasing(easings[segment], fraction));
+	}
+}
+
+template <typename T_Value>
+void KeyframeTrack<T_Value>::AddKey(float time, T_Value const& value, EasingType easingToNextKey)
+{
+	size_t keyIndex = std::upper_bound(m_times.begin(), m_times.end(), time) - m_times.begin();
+	m_times.insert(m_times.begin() + keyIndex, time);
+	m_values.insert(m_values.begin() + keyIndex, value);
+	m_easings.insert(m_easings.begin() + keyIndex, easingToNextKey);
+}
+
+template <typename T_Value>
+void KeyframeTrack<T_Value>::Clear()
+{
+	m_times.clear();
+	m_values.clear();
+	m_easings.clear();
+}
+
+template <typename T_Value>
+T_Value const KeyframeTrack<T_Value>::Evaluate(float time) const
+{
+	int segmentHint = 0;
+	return Evaluate(time, segmentHint);
+}
+
+template <typename T_Value>
+T_Value const KeyframeTrack<T_Value>::Evaluate(float time, int& segmentHint) const
+{
+	return SampleKeys(m_times.data(), m_values.data(), m_easings.data(), GetKeyCount(), time, segmentHint);
+}
+
+template <typename T_Value>
+int KeyframeTrackBatch<T_Value>::AddTrack(KeyframeTrack<T_Value> const& track)
+{
+	m_trackFirstKeys.push_back((int)m_keyTimes.size());
+	m_trackKeyCounts.push_back(track.GetKeyCount());
+	m_cachedSegments.push_back(0);
+
+	m_keyTimes.insert(m_keyTimes.end(), track.GetTimes().begin(), track.GetTimes().end());
+	m_keyValues.insert(m_keyValues.end(), track.GetValues().begin(), track.GetValues().end());
+	m_keyEasings.insert(m_keyEasings.end(), track.GetEasings().begin(), track.GetEasings().end());
+
+	return (int)m_trackFirstKeys.size() - 1;
+}
+
+template <typename T_Value>
+void KeyframeTrackBatch<T_Value>::Clear()
+{
+	m_trackFirstKeys.clear();
+	m_trackKeyCounts.clear();
+	m_cachedSegments.clear();
+	m_keyTimes.clear();
+	m_keyValues.clear();
+	m_keyEasings.clear();
+}
+
+template <typename T_Value>
+void KeyframeTrackBatch<T_Value>::Sample(float time, T_Value* outValues)
+{
+	int trackCount = GetTrackCount();
+	if (trackCount == 0) return;
+
+	int const* firstKeys = m_trackFirstKeys.data();
+	int const* keyCounts = m_trackKeyCounts.data();
+	int* cachedSegments = m_cachedSegments.data();
+	float const* keyTimes = m_keyTimes.data();
+	T_Value const* keyValues = m_keyValues.data();
+	EasingType const* keyEasings = m_keyEasings.data();
+
+	auto sampleTracks = [&](int beginIndex, int endIndex) {
+		for (int trackIndex = beginIndex; trackIndex < endIndex; trackIndex++) {
+			int firstKey = firstKeys[trackIndex];
+			outValues[trackIndex] = SampleKeys(keyTimes + firstKey, keyValues + firstKey, keyEasings + firstKey, keyCounts[trackIndex], time, cachedSegments[trackIndex]);
+		}
+	};
+
+	if (g_theJobSystem) {
+		g_theJobSystem->ParallelFor(trackCount, KEYFRAME_BATCH_MIN_TRACKS_PER_JOB, sampleTracks);
+	}
+	else {
+		sampleTracks(0, trackCount);
+	}
+}
+
+template <typename T_Value>
+void KeyframeTrackBatch<T_Value>::Sample(float time, std::vector<T_Value>& outValues)
+{
+	outValues.resize(m_trackFirstKeys.size());
+	Sample(time, outValues.data());
+}
+
+template class KeyframeTrack<float>;
+template class KeyframeTrack<Vec3>;
+template class KeyframeTrack<Rgba8>;
+template class KeyframeTrackBatch<float>;
+template class KeyframeTrackBatch<Vec3>;
+template class KeyframeTrackBatch<Rgba8>;
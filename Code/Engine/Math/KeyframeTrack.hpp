@@ -0,0 +1,67 @@
+#pragma once
+#include "Engine/Math/Easing.hpp"
+#include <vector>
+
+constexpr int KEYFRAME_BATCH_MIN_TRACKS_PER_JOB = 1024;
+
+/// <summary>
+/// Keys of one animated property, sorted by time and stored as separate time, value and easing arrays so the search only
+/// touches times. The easing of a key shapes the way to the next key. Sampling before the first key or after the last one
+/// holds the end value. Instantiated for float, Vec3 and Rgba8
+/// </summary>
+template <typename T_Value>
+class KeyframeTrack {
+public:
+	KeyframeTrack() = default;
+
+	// Keys can come in any order, a key at the same time as another one goes after it
+	void AddKey(float time, T_Value const& value, EasingType easingToNextKey = EasingType::LINEAR);
+	void Clear();
+
+	int GetKeyCount() const { return (int)m_times.size(); }
+	float GetStartTime() const { return m_times.empty() ? 0.0f : m_times.front(); }
+	float GetEndTime() const { return m_times.empty() ? 0.0f : m_times.back(); }
+	std::vector<float> const& GetTimes() const { return m_times; }
+	std::vector<T_Value> const& GetValues() const { return m_values; }
+	std::vector<EasingType> const& GetEasings() const { return m_easings; }
+
+	// Binary search for the segment
+	T_Value const Evaluate(float time) const;
+	// Tries the segment in segmentHint and the one after it before searching, then stores the segment used back into it.
+	// Playing forward keeps hitting the first check
+	T_Value const Evaluate(float time, int& segmentHint) const;
+
+private:
+	std::vector<float> m_times;
+	std::vector<T_Value> m_values;
+	std::vector<EasingType> m_easings;
+};
+
+/// <summary>
+/// Keys of many tracks pooled in the same arrays, with the last segment of every track cached. Sample goes over every track
+/// in order for a single time value, so animating thousands of entities is one linear pass instead of a search per entity.
+/// Batches bigger than KEYFRAME_BATCH_MIN_TRACKS_PER_JOB are split across the JobSystem
+/// </summary>
+template <typename T_Value>
+class KeyframeTrackBatch {
+public:
+	KeyframeTrackBatch() = default;
+
+	// Copies the keys, returns the index of the track in the sampled values
+	int AddTrack(KeyframeTrack<T_Value> const& track);
+	void Clear();
+	int GetTrackCount() const { return (int)m_trackFirstKeys.size(); }
+
+	// outValues needs room for GetTrackCount values
+	void Sample(float time, T_Value* outValues);
+	void Sample(float time, std::vector<T_Value>& outValues);
+
+private:
+	std::vector<int> m_trackFirstKeys;
+	std::vector<int> m_trackKeyCounts;
+	std::vector<int> m_cachedSegments;
+
+	std::vector<float> m_keyTimes;
+	std::vector<T_Value> m_keyValues;
+	std::vector<EasingType> m_keyEasings;
+};
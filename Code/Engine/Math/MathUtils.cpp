@@ -10,6 +10,7 @@
 #include "Engine/Math/OBB2.hpp"
 #include "Engine/Math/Capsule2.hpp"
 #include "Engine/Math/LineSegment2.hpp"
+#include "Engine/Math/ConvexCollision2D.hpp"
 #include "Engine/Math/RaycastUtils.hpp"
 #include "Engine/Math/FloatRange.hpp"
 #include "Engine/Math/RandomNumberGenerator.hpp"
@@ -447,9 +448,7 @@ bool IsPointInsideCapsule2D(Vec2 const& refPoint, Capsule2 const& capsule)
 
 bool IsPointInsideConvexPoly2D(Vec2 const& refPoint, ConvexPoly2D const& convexPoly, float tolerance)
 {
-	ConvexHull2D asConvexHull = convexPoly.GetConvexHull();
-
-	return IsPointInsideConvexHull2D(refPoint, asConvexHull, tolerance);
+	return IsPointInsideConvexHull2D(refPoint, convexPoly.GetConvexHull(), tolerance);
 }
 
 bool IsPointInsideConvexHull2D(Vec2 const& refPoint, ConvexHull2D const& convexHull, float tolerance)
@@ -499,42 +498,14 @@ bool DoAABB2sOverlap(AABB2 const& aBounds, AABB2 const& bBounds)
 
 bool DoConvexPolygons2DOverlap(DelaunayConvexPoly2D const& polyA, DelaunayConvexPoly2D const& polyB)
 {
-	std::vector<ConvexPoly2DEdge> polyAEdges = polyA.GetEdges();
-	std::vector<ConvexPoly2DEdge> polyBEdges = polyB.GetEdges();
-
-	for (int polyAIndex = 0; polyAIndex < polyAEdges.size(); polyAIndex++) {
-		ConvexPoly2DEdge const& edgeA = polyAEdges[polyAIndex];
-		Vec2 dispEdge = edgeA.m_pointTwo - edgeA.m_pointOne;
-		Vec2 iBasis = (dispEdge).GetNormalized();
-
-		Vec2 edgeNormal = iBasis.GetRotated90Degrees();
-
-		Vec2 const& origin = edgeA.m_pointOne;
-
-		FloatRange polyAProj = polyA.ProjectOntoAxis(edgeNormal, origin);
-		FloatRange polyBProj = polyB.ProjectOntoAxis(edgeNormal, origin);
-
-		if (!polyAProj.IsOverlappingWith(polyBProj)) return false;
-	}
-
-	for (int polyBIndex = 0; polyBIndex < polyBEdges.size(); polyBIndex++) {
-		ConvexPoly2DEdge const& edgeB = polyBEdges[polyBIndex];
-		Vec2 dispEdge = edgeB.m_pointTwo - edgeB.m_pointOne;
-		Vec2 iBasis = (dispEdge).GetNormalized();
-
-		Vec2 edgeNormal = iBasis.GetRotated90Degrees();
-		Vec2 const& origin = edgeB.m_pointOne;
-
-		FloatRange polyAProj = polyA.ProjectOntoAxis(edgeNormal, origin
-		);
-		FloatRange polyBProj = polyB.ProjectOntoAxis(edgeNormal, origin
-		);
-
-		if (!polyAProj.IsOverlappingWith(polyBProj)) return false;
-	}
-
+	ConvexContact2D contact;
+	return GetConvexPolygons2DContact(polyA, polyB, contact);
+}
 
-	return true;
+bool DoConvexPolygons2DOverlap(ConvexPoly2D const& polyA, ConvexPoly2D const& polyB)
+{
+	ConvexContact2D contact;
+	return GetConvexPolygons2DContact(polyA, polyB, contact);
 }
 
 bool DoAABB3sOverlap(AABB3 const& aBounds, AABB3 const& bBounds)
@@ -947,145 +918,26 @@ bool PushDiscOutOfAABB2D(Vec2& mobileDiscCenter, float discRadius, AABB2 const&
 	return PushDiscOutOfPoint2D(mobileDiscCenter, discRadius, nearestPointToDisc);
 }
 
-// This functions DOES NOT DEAL COLLISIONS PERFECTLY. It is a good enough approximation, at the time of writing this 06/22
+// SAT over the cached edge planes, each polygon moves half the penetration depth
 bool PushConvexPolysOutOfEachOther(DelaunayConvexPoly2D& convexPolyA, DelaunayConvexPoly2D& convexPolyB)
 {
-	std::vector<ConvexPoly2DEdge> polyAEdges = convexPolyA.GetEdges();
-	std::vector<ConvexPoly2DEdge> polyBEdges = convexPolyB.GetEdges();
-
-	float shortestOvelap = FLT_MAX;
-	Vec2 shortestOverlapNormal = Vec2::ZERO;
-	bool edgeIsFromA = true;
-
-	// This is the same SAT algorithm
-	for (int polyAIndex = 0; polyAIndex < polyAEdges.size(); polyAIndex++) {
-		ConvexPoly2DEdge const& edgeA = polyAEdges[polyAIndex];
-		Vec2 dispEdge = edgeA.m_pointTwo - edgeA.m_pointOne;
-		Vec2 iBasis = (dispEdge).GetNormalized();
+	ConvexContact2D contact;
+	if (!GetConvexPolygons2DContact(convexPolyA, convexPolyB, contact)) return false;
 
-		Vec2 edgeNormal = iBasis.GetRotated90Degrees();
-
-		Vec2 const& origin = edgeA.m_pointOne;
-
-		FloatRange polyAProj = convexPolyA.ProjectOntoAxis(edgeNormal, origin);
-		FloatRange polyBProj = convexPolyB.ProjectOntoAxis(edgeNormal, origin);
-
-		if (!polyAProj.IsOverlappingWith(polyBProj)) {
-			return false;
-		}
-		else {
-			float overlapDist1 = fabsf(polyBProj.m_max - polyAProj.m_min);
-			float overlapDist2 = fabsf(polyAProj.m_max - polyAProj.m_max);
-
-			float minOverlap = 0.0f;
-			if ((overlapDist1 > 0.0f) && (overlapDist2 > 0.0f)) {
-				minOverlap = (overlapDist1 < overlapDist2) ? overlapDist1 : overlapDist2;
-			}
-			else {
-				minOverlap = (overlapDist1 > 0.0f) ? overlapDist1 : overlapDist2;
-			}
-
-			if ((minOverlap < shortestOvelap) && (minOverlap > 0.0f)) {
-				shortestOvelap = minOverlap;
-				shortestOverlapNormal = edgeNormal;
-			}
-
-		}
-	}
-
-	for (int polyBIndex = 0; polyBIndex < polyBEdges.size(); polyBIndex++) {
-		ConvexPoly2DEdge const& edgeB = polyBEdges[polyBIndex];
-		Vec2 dispEdge = edgeB.m_pointTwo - edgeB.m_pointOne;
-		Vec2 iBasis = (dispEdge).GetNormalized();
-
-		Vec2 edgeNormal = iBasis.GetRotated90Degrees();
-		Vec2 const& origin = edgeB.m_pointOne;
-
-		FloatRange polyAProj = convexPolyA.ProjectOntoAxis(edgeNormal, origin);
-		FloatRange polyBProj = convexPolyB.ProjectOntoAxis(edgeNormal, origin);
-
-		if (!polyAProj.IsOverlappingWith(polyBProj)) {
-			return false;
-		}
-		else {
-			float overlapDist1 = fabsf(polyBProj.m_max - polyAProj.m_min);
-			float overlapDist2 = fabsf(polyAProj.m_max - polyBProj.m_min);
-
-			float minOverlap = 0.0f;
-			if ((overlapDist1 > 0.0f) && (overlapDist2 > 0.0f)) {
-				minOverlap = (overlapDist1 < overlapDist2) ? overlapDist1 : overlapDist2;
-			}
-			else {
-				minOverlap = (overlapDist1 > 0.0f) ? overlapDist1 : overlapDist2;
-			}
-
-			if ((minOverlap < shortestOvelap) && (minOverlap > 0.0f)) {
-				edgeIsFromA = false;
-				shortestOvelap = minOverlap;
-				shortestOverlapNormal = edgeNormal;
-			}
-
-		}
-	}
-
-	Vec2 dirToPushA = (edgeIsFromA) ? -shortestOverlapNormal : shortestOverlapNormal;
-	Vec2 dirToPushB = -dirToPushA;
-
-
-	convexPolyA.Translate(dirToPushA * (shortestOvelap * 0.5f));
-	convexPolyB.Translate(dirToPushB * (shortestOvelap * 0.5f));
+	convexPolyA.Translate(contact.m_normal * (-contact.m_depth * 0.5f));
+	convexPolyB.Translate(contact.m_normal * (contact.m_depth * 0.5f));
 
 	return true;
 }
 
 bool PushConvexPolyOutOfOtherPoly(DelaunayConvexPoly2D const& fixedPolyA, DelaunayConvexPoly2D& convexPolyB)
 {
+	ConvexContact2D contact;
+	if (!GetConvexPolygons2DContact(fixedPolyA, convexPolyB, contact)) return false;
 
-	std::vector<ConvexPoly2DEdge> polyAEdges = fixedPolyA.GetEdges();
-
-	float shortestOvelap = FLT_MAX;
-	Vec2 shortestOverlapNormal = Vec2::ZERO;
-
-	for (int polyAIndex = 0; polyAIndex < polyAEdges.size(); polyAIndex++) {
-		ConvexPoly2DEdge const& edgeA = polyAEdges[polyAIndex];
-		Vec2 dispEdge = edgeA.m_pointTwo - edgeA.m_pointOne;
-		Vec2 iBasis = (dispEdge).GetNormalized();
-
-		Vec2 edgeNormal = iBasis.GetRotated90Degrees();
-
-		Vec2 const& origin = edgeA.m_pointOne;
+	convexPolyB.Translate(contact.m_normal * contact.m_depth);
 
-		FloatRange polyAProj = fixedPolyA.ProjectOntoAxis(edgeNormal, origin);
-		FloatRange polyBProj = convexPolyB.ProjectOntoAxis(edgeNormal, origin);
-
-		if (!polyAProj.IsOverlappingWith(polyBProj)) {
-			return false;
-		}
-		else {
-			float overlapDist1 = fabsf(polyBProj.m_max - polyAProj.m_min);
-			float overlapDist2 = fabsf(polyAProj.m_max - polyBProj.m_min);
-
-			float minOverlap = 0.0f;
-			if ((overlapDist1 > 0.0f) && (overlapDist2 > 0.0f)) {
-				minOverlap = (overlapDist1 < overlapDist2) ? overlapDist1 : overlapDist2;
-			}
-			else {
-				minOverlap = (overlapDist1 > 0.0f) ? overlapDist1 : overlapDist2;
-			}
-
-			if ((minOverlap < shortestOvelap) && (minOverlap > 0.0f)) {
-				shortestOvelap = minOverlap;
-				shortestOverlapNormal = edgeNormal;
-			}
-
-		}
-	}
-
-	Vec2 dirToPushB = shortestOverlapNormal;
-
-	convexPolyB.Translate(dirToPushB * (shortestOvelap));
-
-	return false;
+	return true;
 }
 
 bool PushAABB3OutOfPoint(AABB3& mobileAABB3, Vec3 const& fixedPoint)
@@ -74,6 +74,7 @@ bool DoDiscAndAABB2Overlap(Vec2 const& center, float radius, AABB2 const& bounds
 bool DoSpheresOverlap(const Vec3& centerA, float radiusA, const Vec3& centerB, float radiusB);
 bool DoAABB2sOverlap(AABB2 const& aBounds, AABB2 const& bBounds);
 bool DoConvexPolygons2DOverlap(DelaunayConvexPoly2D const& polyA, DelaunayConvexPoly2D const& polyB);
+bool DoConvexPolygons2DOverlap(ConvexPoly2D const& polyA, ConvexPoly2D const& polyB);
 
 bool DoAABB3sOverlap(AABB3 const& aBounds, AABB3 const& bBounds);
 bool DoZCylindersOverlap(Vec2 const& aXYCenter, float aCylinderRadius, FloatRange const& aZRange, Vec2 const& bXYCenter, float bCylinderRadius, FloatRange const& bZRange);
@@ -0,0 +1,574 @@
+#include "Engine/Math/NoiseField.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Math/Easing.hpp"
+#include "Engine/Math/SIMDUtils.hpp"
+#include "ThirdParty/Squirrel/SmoothNoise.hpp"
+#include <math.h>
+#include <string.h>
+
+namespace {
+	// Same constants as SmoothNoise.cpp and RawNoise.hpp, the fills must repeat their arithmetic operation for operation
+	constexpr float NOISE_OCTAVE_OFFSET = 0.636764989593174f;
+	constexpr int NOISE_PRIME_Y = 198491317;
+	constexpr int NOISE_PRIME_Z = 6542989;
+	constexpr double NOISE_ONE_OVER_MAX_UINT = (1.0 / (double)0xFFFFFFFF);
+	constexpr float NOISE_PERLIN_2D_NORMALIZER = (1.f / 0.662578106f);
+	constexpr float NOISE_PERLIN_3D_NORMALIZER = (1.f / 0.793856621f);
+	constexpr float NOISE_GRADIENT_2D_LONG = 0.923879533f;
+	constexpr float NOISE_GRADIENT_2D_SHORT = 0.382683432f;
+	constexpr float NOISE_GRADIENT_3D = 0.57735026918962576450914878050196f;
+
+	// Integer lanes to go with the float lanes. AVX without AVX2 has no 8 wide integer math, so the fills stay 4 wide there.
+	// The 4 wide path only uses SSE2, like SimdFloat4, so it runs on any x64 CPU
+#if defined(__AVX2__)
+	using NoiseFloats = SimdFloat8;
+
+	struct NoiseInts {
+		__m256i m_value;
+	};
+
+	inline NoiseInts BroadcastInts(int value) { return { _mm256_set1_epi32(value) }; }
+	inline NoiseInts GetLaneIndexes() { return { _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7) }; }
+	inline NoiseInts operator+(NoiseInts a, NoiseInts b) { return { _mm256_add_epi32(a.m_value, b.m_value) }; }
+	inline NoiseInts operator*(NoiseInts a, NoiseInts b) { return { _mm256_mullo_epi32(a.m_value, b.m_value) }; }
+	inline NoiseInts operator^(NoiseInts a, NoiseInts b) { return { _mm256_xor_si256(a.m_value, b.m_value) }; }
+	inline NoiseInts operator&(NoiseInts a, NoiseInts b) { return { _mm256_and_si256(a.m_value, b.m_value) }; }
+	template <int BITS> NoiseInts ShiftRight(NoiseInts a) { return { _mm256_srli_epi32(a.m_value, BITS) }; }
+	template <int BITS> NoiseInts ShiftLeft(NoiseInts a) { return { _mm256_slli_epi32(a.m_value, BITS) }; }
+	inline NoiseFloats GetZeroMask(NoiseInts a) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a.m_value, _mm256_setzero_si256())); }
+	inline NoiseFloats FlipSigns(NoiseFloats values, NoiseInts signBits) { return _mm256_xor_ps(values.m_value, _mm256_castsi256_ps(signBits.m_value)); }
+	inline NoiseFloats Floor(NoiseFloats values) { return _mm256_floor_ps(values.m_value); }
+	inline NoiseFloats ConvertToFloats(NoiseInts values) { return _mm256_cvtepi32_ps(values.m_value); }
+	inline NoiseInts TruncateToInts(NoiseFloats values) { return { _mm256_cvttps_epi32(values.m_value) }; }
+	inline NoiseFloats CastToFloats(NoiseInts values) { return _mm256_castsi256_ps(values.m_value); }
+	inline NoiseInts CastToInts(NoiseFloats values) { return { _mm256_castps_si256(values.m_value) }; }
+	inline void StoreInts(int* outValues, NoiseInts values) { _mm256_storeu_si256((__m256i*)outValues, values.m_value); }
+	inline NoiseInts GatherInts(int const* values, NoiseInts indexes) { return { _mm256_i32gather_epi32(values, indexes.m_value, 4) }; }
+
+	// Get*dNoiseZeroToOne scale in double precision, so the lanes do too
+	inline NoiseFloats GetZeroToOne(NoiseInts noise)
+	{
+		__m256i signedNoise = _mm256_xor_si256(noise.m_value, _mm256_set1_epi32((int)0x80000000));
+		__m256d uintOffset = _mm256_set1_pd(2147483648.0);
+		__m256d scale = _mm256_set1_pd(NOISE_ONE_OVER_MAX_UINT);
+		__m256d lowValues = _mm256_mul_pd(_mm256_add_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(signedNoise)), uintOffset), scale);
+		__m256d highValues = _mm256_mul_pd(_mm256_add_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(signedNoise, 1)), uintOffset), scale);
+		return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(lowValues)), _mm256_cvtpd_ps(highValues), 1);
+	}
+#else
+	using NoiseFloats = SimdFloat4;
+
+	struct NoiseInts {
+		__m128i m_value;
+	};
+
+	inline NoiseInts BroadcastInts(int value) { return { _mm_set1_epi32(value) }; }
+	inline NoiseInts GetLaneIndexes() { return { _mm_setr_epi32(0, 1, 2, 3) }; }
+	inline NoiseInts operator+(NoiseInts a, NoiseInts b) { return { _mm_add_epi32(a.m_value, b.m_value) }; }
+	inline NoiseInts operator*(NoiseInts a, NoiseInts b)
+	{
+		// No 32 bit multiply before SSE4.1: the even and odd lanes go through the 64 bit one and their low halves are put back together
+		__m128i evenProducts = _mm_mul_epu32(a.m_value, b.m_value);
+		__m128i oddProducts = _mm_mul_epu32(_mm_srli_epi64(a.m_value, 32), _mm_srli_epi64(b.m_value, 32));
+		return { _mm_unpacklo_epi32(_mm_shuffle_epi32(evenProducts, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(oddProducts, _MM_SHUFFLE(0, 0, 2, 0))) };
+	}
+	inline NoiseInts operator^(NoiseInts a, NoiseInts b) { return { _mm_xor_si128(a.m_value, b.m_value) }; }
+	inline NoiseInts operator&(NoiseInts a, NoiseInts b) { return { _mm_and_si128(a.m_value, b.m_value) }; }
+	template <int BITS> NoiseInts ShiftRight(NoiseInts a) { return { _mm_srli_epi32(a.m_value, BITS) }; }
+	template <int BITS> NoiseInts ShiftLeft(NoiseInts a) { return { _mm_slli_epi32(a.m_value, BITS) }; }
+	inline NoiseFloats GetZeroMask(NoiseInts a) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a.m_value, _mm_setzero_si128())); }
+	inline NoiseFloats FlipSigns(NoiseFloats values, NoiseInts signBits) { return _mm_xor_ps(values.m_value, _mm_castsi128_ps(signBits.m_value)); }
+	inline NoiseFloats Floor(NoiseFloats values)
+	{
+		// Truncating rounds negative fractions up, those take one off. Whole values, anything past 2^23 and NaN are kept as
+		// they are, which also keeps -0 and the lanes the int conversion can't hold, the same as floorf
+		NoiseFloats truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(values.m_value));
+		NoiseFloats floored = truncated - ((truncated > values) & NoiseFloats::Broadcast(1.0f));
+		NoiseFloats isKept = NoiseFloats(_mm_cmpeq_ps(truncated.m_value, values.m_value)) | NoiseFloats(_mm_cmpnlt_ps(SimdAbs(values).m_value, _mm_set1_ps(8388608.0f)));
+		return SimdSelect(isKept, values, floored);
+	}
+	inline NoiseFloats ConvertToFloats(NoiseInts values) { return _mm_cvtepi32_ps(values.m_value); }
+	inline NoiseInts TruncateToInts(NoiseFloats values) { return { _mm_cvttps_epi32(values.m_value) }; }
+	inline NoiseFloats CastToFloats(NoiseInts values) { return _mm_castsi128_ps(values.m_value); }
+	inline NoiseInts CastToInts(NoiseFloats values) { return { _mm_castps_si128(values.m_value) }; }
+	inline void StoreInts(int* outValues, NoiseInts values) { _mm_storeu_si128((__m128i*)outValues, values.m_value); }
+
+	inline NoiseInts GatherInts(int const* values, NoiseInts indexes)
+	{
+		return { _mm_setr_epi32(values[_mm_cvtsi128_si32(indexes.m_value)], values[_mm_cvtsi128_si32(_mm_shuffle_epi32(indexes.m_value, 1))],
+			values[_mm_cvtsi128_si32(_mm_shuffle_epi32(indexes.m_value, 2))], values[_mm_cvtsi128_si32(_mm_shuffle_epi32(indexes.m_value, 3))]) };
+	}
+
+	inline NoiseFloats GetZeroToOne(NoiseInts noise)
+	{
+		__m128i signedNoise = _mm_xor_si128(noise.m_value, _mm_set1_epi32((int)0x80000000));
+		__m128d uintOffset = _mm_set1_pd(2147483648.0);
+		__m128d scale = _mm_set1_pd(NOISE_ONE_OVER_MAX_UINT);
+		__m128d lowValues = _mm_mul_pd(_mm_add_pd(_mm_cvtepi32_pd(signedNoise), uintOffset), scale);
+		__m128d highValues = _mm_mul_pd(_mm_add_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(signedNoise, 0x0E)), uintOffset), scale);
+		return _mm_movelh_ps(_mm_cvtpd_ps(lowValues), _mm_cvtpd_ps(highValues));
+	}
+#endif
+
+	constexpr int NOISE_LANES = NoiseFloats::LANES;
+
+	NoiseInts SquirrelNoise5Lanes(NoiseInts position, unsigned int seed)
+	{
+		NoiseInts mangledBits = position * BroadcastInts((int)0xd2a80a3f);
+		mangledBits = mangledBits + BroadcastInts((int)seed);
+		mangledBits = mangledBits ^ ShiftRight<9>(mangledBits);
+		mangledBits = mangledBits + BroadcastInts((int)0xa884f197);
+		mangledBits = mangledBits ^ ShiftRight<11>(mangledBits);
+		mangledBits = mangledBits * BroadcastInts((int)0x6C736F4B);
+		mangledBits = mangledBits ^ ShiftRight<13>(mangledBits);
+		mangledBits = mangledBits + BroadcastInts((int)0xB79F3ABB);
+		mangledBits = mangledBits ^ ShiftRight<15>(mangledBits);
+		mangledBits = mangledBits * BroadcastInts((int)0x1b56c4f5);
+		mangledBits = mangledBits ^ ShiftRight<17>(mangledBits);
+		return mangledBits;
+	}
+
+	NoiseFloats SmoothStep3Lanes(NoiseFloats t)
+	{
+		// Interpolate(SmoothStart2(t), SmoothStop2(t), t), the way Easing.cpp computes it
+		NoiseFloats one = NoiseFloats::Broadcast(1.0f);
+		NoiseFloats start = t * t;
+		NoiseFloats oneMinusT = one - t;
+		NoiseFloats stop = one - (oneMinusT * oneMinusT);
+		return start + (t * (stop - start));
+	}
+
+	// Everything of an octave that only depends on the row, i.e. on y and z
+	struct NoiseRowOctave {
+		float m_amplitude = 0.0f;
+		unsigned int m_seed = 0;
+		float m_displacementY = 0.0f; // From the south cell border
+		float m_displacementFromMaxY = 0.0f;
+		float m_displacementZ = 0.0f;
+		float m_displacementFromMaxZ = 0.0f;
+		float m_weightNorth = 0.0f;
+		float m_weightAbove = 0.0f;
+		int m_rowHashes[4] = {}; // South below, north below, south above, north above
+
+		// Corners of the row's cells, when they are fewer than the samples: the hash (Perlin) or value bits (fractal) of
+		// corner x in row hash r sits at [(r * m_cornerCacheStride) + x - m_cornerCacheFirstX]. Null means hash per sample
+		int const* m_cornerCache = nullptr;
+		int m_cornerCacheFirstX = 0;
+		int m_cornerCacheStride = 0;
+	};
+
+	void SetupRowOctaves(NoiseFieldConfig const& config, float positionY, float positionZ, bool is3D, NoiseRowOctave* outOctaves)
+	{
+		float invScale = (1.f / config.m_scale);
+		float currentY = positionY * invScale;
+		float currentZ = positionZ * invScale;
+		float currentAmplitude = 1.f;
+		unsigned int seed = config.m_seed;
+
+		for (unsigned int octaveNum = 0; octaveNum < config.m_numOctaves; octaveNum++) {
+			NoiseRowOctave& octave = outOctaves[octaveNum];
+			float cellMinY = floorf(currentY);
+			float cellMinZ = floorf(currentZ);
+			int indexSouthY = (int)cellMinY;
+			int indexBelowZ = (int)cellMinZ;
+
+			octave.m_amplitude = currentAmplitude;
+			octave.m_seed = seed;
+			octave.m_displacementY = currentY - cellMinY;
+			octave.m_displacementFromMaxY = currentY - (cellMinY + 1.f);
+			octave.m_displacementZ = currentZ - cellMinZ;
+			octave.m_displacementFromMaxZ = currentZ - (cellMinZ + 1.f);
+			octave.m_weightNorth = SmoothStep3(octave.m_displacementY);
+			octave.m_weightAbove = SmoothStep3(octave.m_displacementZ);
+
+			// Unsigned, the hashes wrap the same as RawNoise's int math does in practice
+			unsigned int hashSouth = (unsigned int)NOISE_PRIME_Y * (unsigned int)indexSouthY;
+			unsigned int hashNorth = (unsigned int)NOISE_PRIME_Y * (unsigned int)(indexSouthY + 1);
+			unsigned int hashBelow = (is3D) ? (unsigned int)NOISE_PRIME_Z * (unsigned int)indexBelowZ : 0;
+			unsigned int hashAbove = (is3D) ? (unsigned int)NOISE_PRIME_Z * (unsigned int)(indexBelowZ + 1) : 0;
+			octave.m_rowHashes[0] = (int)(hashSouth + hashBelow);
+			octave.m_rowHashes[1] = (int)(hashNorth + hashBelow);
+			octave.m_rowHashes[2] = (int)(hashSouth + hashAbove);
+			octave.m_rowHashes[3] = (int)(hashNorth + hashAbove);
+
+			currentAmplitude *= config.m_octavePersistence;
+			currentY *= config.m_octaveScale;
+			currentY += NOISE_OCTAVE_OFFSET;
+			currentZ *= config.m_octaveScale;
+			currentZ += NOISE_OCTAVE_OFFSET;
+			++seed;
+		}
+	}
+
+	float GetTotalAmplitude(NoiseFieldConfig const& config)
+	{
+		float totalAmplitude = 0.f;
+		float currentAmplitude = 1.f;
+		for (unsigned int octaveNum = 0; octaveNum < config.m_numOctaves; octaveNum++) {
+			totalAmplitude += currentAmplitude;
+			currentAmplitude *= config.m_octavePersistence;
+		}
+		return totalAmplitude;
+	}
+
+	NoiseInts GetCornerNoise(NoiseInts indexX, NoiseRowOctave const& octave, int rowHashIndex)
+	{
+		if (octave.m_cornerCache) {
+			return GatherInts(octave.m_cornerCache + (rowHashIndex * octave.m_cornerCacheStride), indexX + BroadcastInts(-octave.m_cornerCacheFirstX));
+		}
+		return SquirrelNoise5Lanes(indexX + BroadcastInts(octave.m_rowHashes[rowHashIndex]), octave.m_seed);
+	}
+
+	NoiseFloats GetCornerValue(NoiseInts indexX, NoiseRowOctave const& octave, int rowHashIndex)
+	{
+		if (octave.m_cornerCache) {
+			return CastToFloats(GatherInts(octave.m_cornerCache + (rowHashIndex * octave.m_cornerCacheStride), indexX + BroadcastInts(-octave.m_cornerCacheFirstX)));
+		}
+		return GetZeroToOne(SquirrelNoise5Lanes(indexX + BroadcastInts(octave.m_rowHashes[rowHashIndex]), octave.m_seed));
+	}
+
+	void GetGradients2D(NoiseInts noise, NoiseFloats& outGradientX, NoiseFloats& outGradientY)
+	{
+		// Decodes SmoothNoise's table of 8 directions at 22.5 + 45 * i degrees: x is the long component for i in { 0, 3, 4, 7 },
+		// x is negative for i in [2, 5] and y for i in [4, 7]
+		NoiseInts gradientIndex = noise & BroadcastInts(7);
+		NoiseFloats isLongX = GetZeroMask((gradientIndex + BroadcastInts(1)) & BroadcastInts(2));
+		NoiseFloats longComponent = NoiseFloats::Broadcast(NOISE_GRADIENT_2D_LONG);
+		NoiseFloats shortComponent = NoiseFloats::Broadcast(NOISE_GRADIENT_2D_SHORT);
+		outGradientX = FlipSigns(SimdSelect(isLongX, longComponent, shortComponent), ShiftLeft<29>((gradientIndex + BroadcastInts(2)) & BroadcastInts(4)));
+		outGradientY = FlipSigns(SimdSelect(isLongX, shortComponent, longComponent), ShiftLeft<29>(gradientIndex & BroadcastInts(4)));
+	}
+
+	NoiseFloats GetPerlinDot2D(NoiseInts indexX, NoiseRowOctave const& octave, int rowHashIndex, NoiseFloats displacementX, float displacementY)
+	{
+		NoiseFloats gradientX;
+		NoiseFloats gradientY;
+		GetGradients2D(GetCornerNoise(indexX, octave, rowHashIndex), gradientX, gradientY);
+		return (gradientX * displacementX) + (gradientY * NoiseFloats::Broadcast(displacementY));
+	}
+
+	NoiseFloats GetPerlinDot3D(NoiseInts indexX, NoiseRowOctave const& octave, int rowHashIndex, NoiseFloats displacementX, float displacementY, float displacementZ)
+	{
+		// SmoothNoise's 3D gradients point at cube corners, index bits 0, 1 and 2 negate x, y and z
+		NoiseInts gradientIndex = GetCornerNoise(indexX, octave, rowHashIndex) & BroadcastInts(7);
+		NoiseFloats component = NoiseFloats::Broadcast(NOISE_GRADIENT_3D);
+		NoiseFloats gradientX = FlipSigns(component, ShiftLeft<31>(gradientIndex & BroadcastInts(1)));
+		NoiseFloats gradientY = FlipSigns(component, ShiftLeft<30>(gradientIndex & BroadcastInts(2)));
+		NoiseFloats gradientZ = FlipSigns(component, ShiftLeft<29>(gradientIndex & BroadcastInts(4)));
+		return (gradientX * displacementX) + (gradientY * NoiseFloats::Broadcast(displacementY)) + (gradientZ * NoiseFloats::Broadcast(displacementZ));
+	}
+
+	NoiseFloats Blend(NoiseFloats weightA, NoiseFloats valueA, NoiseFloats weightB, NoiseFloats valueB)
+	{
+		return (weightA * valueA) + (weightB * valueB);
+	}
+
+	// The octave kernels mirror Compute2d/3dFractalNoise and Compute2d/3dPerlinNoise, with x in lanes and y, z from the row
+	NoiseFloats ComputeFractalOctave2D(NoiseFloats currentX, NoiseRowOctave const& octave)
+	{
+		NoiseFloats one = NoiseFloats::Broadcast(1.f);
+		NoiseFloats cellMinX = Floor(currentX);
+		NoiseInts indexWestX = TruncateToInts(cellMinX);
+		NoiseInts indexEastX = indexWestX + BroadcastInts(1);
+
+		NoiseFloats valueSouthWest = GetCornerValue(indexWestX, octave, 0);
+		NoiseFloats valueSouthEast = GetCornerValue(indexEastX, octave, 0);
+		NoiseFloats valueNorthWest = GetCornerValue(indexWestX, octave, 1);
+		NoiseFloats valueNorthEast = GetCornerValue(indexEastX, octave, 1);
+
+		NoiseFloats weightEast = SmoothStep3Lanes(currentX - cellMinX);
+		NoiseFloats weightWest = one - weightEast;
+		NoiseFloats weightNorth = NoiseFloats::Broadcast(octave.m_weightNorth);
+		NoiseFloats weightSouth = NoiseFloats::Broadcast(1.f - octave.m_weightNorth);
+
+		NoiseFloats blendSouth = Blend(weightEast, valueSouthEast, weightWest, valueSouthWest);
+		NoiseFloats blendNorth = Blend(weightEast, valueNorthEast, weightWest, valueNorthWest);
+		NoiseFloats blendTotal = Blend(weightSouth, blendSouth, weightNorth, blendNorth);
+		return NoiseFloats::Broadcast(2.f) * (blendTotal - NoiseFloats::Broadcast(0.5f));
+	}
+
+	NoiseFloats ComputePerlinOctave2D(NoiseFloats currentX, NoiseRowOctave const& octave)
+	{
+		NoiseFloats one = NoiseFloats::Broadcast(1.f);
+		NoiseFloats cellMinX = Floor(currentX);
+		NoiseFloats cellMaxX = cellMinX + one;
+		NoiseInts indexWestX = TruncateToInts(cellMinX);
+		NoiseInts indexEastX = indexWestX + BroadcastInts(1);
+		NoiseFloats displacementFromWest = currentX - cellMinX;
+		NoiseFloats displacementFromEast = currentX - cellMaxX;
+
+		NoiseFloats dotSouthWest = GetPerlinDot2D(indexWestX, octave, 0, displacementFromWest, octave.m_displacementY);
+		NoiseFloats dotSouthEast = GetPerlinDot2D(indexEastX, octave, 0, displacementFromEast, octave.m_displacementY);
+		NoiseFloats dotNorthWest = GetPerlinDot2D(indexWestX, octave, 1, displacementFromWest, octave.m_displacementFromMaxY);
+		NoiseFloats dotNorthEast = GetPerlinDot2D(indexEastX, octave, 1, displacementFromEast, octave.m_displacementFromMaxY);
+
+		NoiseFloats weightEast = SmoothStep3Lanes(displacementFromWest);
+		NoiseFloats weightWest = one - weightEast;
+		NoiseFloats weightNorth = NoiseFloats::Broadcast(octave.m_weightNorth);
+		NoiseFloats weightSouth = NoiseFloats::Broadcast(1.f - octave.m_weightNorth);
+
+		NoiseFloats blendSouth = Blend(weightEast, dotSouthEast, weightWest, dotSouthWest);
+		NoiseFloats blendNorth = Blend(weightEast, dotNorthEast, weightWest, dotNorthWest);
+		NoiseFloats blendTotal = Blend(weightSouth, blendSouth, weightNorth, blendNorth);
+		return blendTotal * NoiseFloats::Broadcast(NOISE_PERLIN_2D_NORMALIZER);
+	}
+
+	NoiseFloats ComputeFractalOctave3D(NoiseFloats currentX, NoiseRowOctave const& octave)
+	{
+		NoiseFloats one = NoiseFloats::Broadcast(1.f);
+		NoiseFloats cellMinX = Floor(currentX);
+		NoiseInts indexWestX = TruncateToInts(cellMinX);
+		NoiseInts indexEastX = indexWestX + BroadcastInts(1);
+
+		NoiseFloats belowSouthWest = GetCornerValue(indexWestX, octave, 0);
+		NoiseFloats belowSouthEast = GetCornerValue(indexEastX, octave, 0);
+		NoiseFloats belowNorthWest = GetCornerValue(indexWestX, octave, 1);
+		NoiseFloats belowNorthEast = GetCornerValue(indexEastX, octave, 1);
+		NoiseFloats aboveSouthWest = GetCornerValue(indexWestX, octave, 2);
+		NoiseFloats aboveSouthEast = GetCornerValue(indexEastX, octave, 2);
+		NoiseFloats aboveNorthWest = GetCornerValue(indexWestX, octave, 3);
+		NoiseFloats aboveNorthEast = GetCornerValue(indexEastX, octave, 3);
+
+		NoiseFloats weightEast = SmoothStep3Lanes(currentX - cellMinX);
+		NoiseFloats weightWest = one - weightEast;
+		NoiseFloats weightNorth = NoiseFloats::Broadcast(octave.m_weightNorth);
+		NoiseFloats weightSouth = NoiseFloats::Broadcast(1.f - octave.m_weightNorth);
+		NoiseFloats weightAbove = NoiseFloats::Broadcast(octave.m_weightAbove);
+		NoiseFloats weightBelow = NoiseFloats::Broadcast(1.f - octave.m_weightAbove);
+
+		NoiseFloats blendBelowSouth = Blend(weightEast, belowSouthEast, weightWest, belowSouthWest);
+		NoiseFloats blendBelowNorth = Blend(weightEast, belowNorthEast, weightWest, belowNorthWest);
+		NoiseFloats blendAboveSouth = Blend(weightEast, aboveSouthEast, weightWest, aboveSouthWest);
+		NoiseFloats blendAboveNorth = Blend(weightEast, aboveNorthEast, weightWest, aboveNorthWest);
+		NoiseFloats blendBelow = Blend(weightSouth, blendBelowSouth, weightNorth, blendBelowNorth);
+		NoiseFloats blendAbove = Blend(weightSouth, blendAboveSouth, weightNorth, blendAboveNorth);
+		NoiseFloats blendTotal = Blend(weightBelow, blendBelow, weightAbove, blendAbove);
+		return NoiseFloats::Broadcast(2.f) * (blendTotal - NoiseFloats::Broadcast(0.5f));
+	}
+
+	NoiseFloats ComputePerlinOctave3D(NoiseFloats currentX, NoiseRowOctave const& octave)
+	{
+		NoiseFloats one = NoiseFloats::Broadcast(1.f);
+		NoiseFloats cellMinX = Floor(currentX);
+		NoiseFloats cellMaxX = cellMinX + one;
+		NoiseInts indexWestX = TruncateToInts(cellMinX);
+		NoiseInts indexEastX = indexWestX + BroadcastInts(1);
+		NoiseFloats displacementFromWest = currentX - cellMinX;
+		NoiseFloats displacementFromEast = currentX - cellMaxX;
+		float displacementSouth = octave.m_displacementY;
+		float displacementNorth = octave.m_displacementFromMaxY;
+		float displacementBelow = octave.m_displacementZ;
+		float displacementAbove = octave.m_displacementFromMaxZ;
+
+		NoiseFloats dotBelowSW = GetPerlinDot3D(indexWestX, octave, 0, displacementFromWest, displacementSouth, displacementBelow);
+		NoiseFloats dotBelowSE = GetPerlinDot3D(indexEastX, octave, 0, displacementFromEast, displacementSouth, displacementBelow);
+		NoiseFloats dotBelowNW = GetPerlinDot3D(indexWestX, octave, 1, displacementFromWest, displacementNorth, displacementBelow);
+		NoiseFloats dotBelowNE = GetPerlinDot3D(indexEastX, octave, 1, displacementFromEast, displacementNorth, displacementBelow);
+		NoiseFloats dotAboveSW = GetPerlinDot3D(indexWestX, octave, 2, displacementFromWest, displacementSouth, displacementAbove);
+		NoiseFloats dotAboveSE = GetPerlinDot3D(indexEastX, octave, 2, displacementFromEast, displacementSouth, displacementAbove);
+		NoiseFloats dotAboveNW = GetPerlinDot3D(indexWestX, octave, 3, displacementFromWest, displacementNorth, displacementAbove);
+		NoiseFloats dotAboveNE = GetPerlinDot3D(indexEastX, octave, 3, displacementFromEast, displacementNorth, displacementAbove);
+
+		NoiseFloats weightEast = SmoothStep3Lanes(displacementFromWest);
+		NoiseFloats weightWest = one - weightEast;
+		NoiseFloats weightNorth = NoiseFloats::Broadcast(octave.m_weightNorth);
+		NoiseFloats weightSouth = NoiseFloats::Broadcast(1.f - octave.m_weightNorth);
+		NoiseFloats weightAbove = NoiseFloats::Broadcast(octave.m_weightAbove);
+		NoiseFloats weightBelow = NoiseFloats::Broadcast(1.f - octave.m_weightAbove);
+
+		NoiseFloats blendBelowSouth = Blend(weightEast, dotBelowSE, weightWest, dotBelowSW);
+		NoiseFloats blendBelowNorth = Blend(weightEast, dotBelowNE, weightWest, dotBelowNW);
+		NoiseFloats blendAboveSouth = Blend(weightEast, dotAboveSE, weightWest, dotAboveSW);
+		NoiseFloats blendAboveNorth = Blend(weightEast, dotAboveNE, weightWest, dotAboveNW);
+		NoiseFloats blendBelow = Blend(weightSouth, blendBelowSouth, weightNorth, blendBelowNorth);
+		NoiseFloats blendAbove = Blend(weightSouth, blendAboveSouth, weightNorth, blendAboveNorth);
+		NoiseFloats blendTotal = Blend(weightBelow, blendBelow, weightAbove, blendAbove);
+		return blendTotal * NoiseFloats::Broadcast(NOISE_PERLIN_3D_NORMALIZER);
+	}
+
+	float GetOctaveCellMinX(NoiseFieldConfig const& config, float originX, int coordX, unsigned int octaveNum)
+	{
+		float currentX = (originX + ((float)coordX * config.m_sampleSpacing)) * (1.f / config.m_scale);
+		for (unsigned int octaveIndex = 0; octaveIndex < octaveNum; octaveIndex++) {
+			currentX *= config.m_octaveScale;
+			currentX += NOISE_OCTAVE_OFFSET;
+		}
+		return floorf(currentX);
+	}
+
+	// Each cell corner along a row is shared by every sample in the cells next to it, usually many. Corners are hashed once into the
+	// cache instead, for the octaves where the row has fewer corners than samples
+	void FillRowCornerCache(NoiseFieldConfig const& config, float originX, int sampleCount, int rowHashCount, bool cachesValues,
+		NoiseRowOctave* rowOctaves, std::vector<int>& cornerCache)
+	{
+		// The last SIMD block runs past the row, its lanes need corners too
+		int paddedSampleCount = ((sampleCount + NOISE_LANES - 1) / NOISE_LANES) * NOISE_LANES;
+
+		int cacheSize = 0;
+		for (unsigned int octaveNum = 0; octaveNum < config.m_numOctaves; octaveNum++) {
+			NoiseRowOctave& octave = rowOctaves[octaveNum];
+			octave.m_cornerCache = nullptr;
+
+			// Sample positions are monotonic along the row, so its ends bound the cells, whichever way the spacing points
+			float firstCellMinX = GetOctaveCellMinX(config, originX, 0, octaveNum);
+			float lastCellMinX = GetOctaveCellMinX(config, originX, paddedSampleCount - 1, octaveNum);
+			float lowestCellMinX = (firstCellMinX < lastCellMinX) ? firstCellMinX : lastCellMinX;
+			float cornerCount = fabsf(lastCellMinX - firstCellMinX) + 2.0f;
+			if (cornerCount > (float)sampleCount) continue;
+
+			octave.m_cornerCacheFirstX = (int)lowestCellMinX;
+			octave.m_cornerCacheStride = (((int)cornerCount + NOISE_LANES - 1) / NOISE_LANES) * NOISE_LANES;
+			cacheSize += octave.m_cornerCacheStride * rowHashCount;
+		}
+
+		if ((int)cornerCache.size() < cacheSize) {
+			cornerCache.resize(cacheSize);
+		}
+
+		int* nextCache = cornerCache.data();
+		for (unsigned int octaveNum = 0; octaveNum < config.m_numOctaves; octaveNum++) {
+			NoiseRowOctave& octave = rowOctaves[octaveNum];
+			if (octave.m_cornerCacheStride == 0) continue;
+
+			for (int rowHashIndex = 0; rowHashIndex < rowHashCount; rowHashIndex++) {
+				int* rowCache = nextCache + (rowHashIndex * octave.m_cornerCacheStride);
+				for (int cornerIndex = 0; cornerIndex < octave.m_cornerCacheStride; cornerIndex += NOISE_LANES) {
+					NoiseInts indexX = GetLaneIndexes() + BroadcastInts(octave.m_cornerCacheFirstX + cornerIndex);
+					NoiseInts noise = SquirrelNoise5Lanes(indexX + BroadcastInts(octave.m_rowHashes[rowHashIndex]), octave.m_seed);
+					StoreInts(rowCache + cornerIndex, (cachesValues) ? CastToInts(GetZeroToOne(noise)) : noise);
+				}
+			}
+
+			octave.m_cornerCache = nextCache;
+			nextCache += octave.m_cornerCacheStride * rowHashCount;
+		}
+	}
+
+	// Rows are numbered y fastest then z. A 2D field is a 3D field of depth one whose hashes leave z out
+	template <typename T_OctaveKernel>
+	void FillNoiseRows(NoiseFieldConfig const& config, Vec3 const& origin, IntVec3 const& dimensions, bool is3D, bool isPerlin, float* outValues,
+		int beginRow, int endRow, T_OctaveKernel const& computeOctave)
+	{
+		std::vector<NoiseRowOctave> rowOctaves(config.m_numOctaves);
+		std::vector<int> cornerCache;
+		float invScale = (1.f / config.m_scale);
+		float totalAmplitude = GetTotalAmplitude(config);
+		bool renormalize = config.m_renormalize && (totalAmplitude > 0.f);
+		NoiseFloats spacing = NoiseFloats::Broadcast(config.m_sampleSpacing);
+		NoiseFloats originX = NoiseFloats::Broadcast(origin.x);
+
+		for (int rowIndex = beginRow; rowIndex < endRow; rowIndex++) {
+			int coordY = rowIndex % dimensions.y;
+			int coordZ = rowIndex / dimensions.y;
+			float positionY = origin.y + ((float)coordY * config.m_sampleSpacing);
+			float positionZ = origin.z + ((float)coordZ * config.m_sampleSpacing);
+			SetupRowOctaves(config, positionY, positionZ, is3D, rowOctaves.data());
+			FillRowCornerCache(config, origin.x, dimensions.x, (is3D) ? 4 : 2, !isPerlin, rowOctaves.data(), cornerCache);
+
+			float* rowValues = outValues + ((size_t)rowIndex * dimensions.x);
+			for (int coordX = 0; coordX < dimensions.x; coordX += NOISE_LANES) {
+				NoiseFloats positionX = originX + (ConvertToFloats(GetLaneIndexes() + BroadcastInts(coordX)) * spacing);
+				NoiseFloats currentX = positionX * NoiseFloats::Broadcast(invScale);
+				NoiseFloats totalNoise = NoiseFloats::Zero();
+
+				for (unsigned int octaveNum = 0; octaveNum < config.m_numOctaves; octaveNum++) {
+					NoiseRowOctave const& octave = rowOctaves[octaveNum];
+					totalNoise = totalNoise + (computeOctave(currentX, octave) * NoiseFloats::Broadcast(octave.m_amplitude));
+					currentX = currentX * NoiseFloats::Broadcast(config.m_octaveScale);
+					currentX = currentX + NoiseFloats::Broadcast(NOISE_OCTAVE_OFFSET);
+				}
+
+				if (renormalize) {
+					totalNoise = totalNoise / NoiseFloats::Broadcast(totalAmplitude);
+					totalNoise = (totalNoise * NoiseFloats::Broadcast(0.5f)) + NoiseFloats::Broadcast(0.5f);
+					totalNoise = SmoothStep3Lanes(totalNoise);
+					totalNoise = (totalNoise * NoiseFloats::Broadcast(2.0f)) - NoiseFloats::Broadcast(1.f);
+				}
+
+				if (coordX + NOISE_LANES <= dimensions.x) {
+					totalNoise.Store(rowValues + coordX);
+				}
+				else {
+					float laneValues[NOISE_LANES];
+					totalNoise.Store(laneValues);
+					memcpy(rowValues + coordX, laneValues, (dimensions.x - coordX) * sizeof(float));
+				}
+			}
+		}
+	}
+
+	void FillNoiseField(NoiseFieldConfig const& config, Vec3 const& origin, IntVec3 const& dimensions, float* outValues, bool is3D)
+	{
+		if ((dimensions.x <= 0) || (dimensions.y <= 0) || (dimensions.z <= 0)) return;
+
+		int rowCount = dimensions.y * dimensions.z;
+		auto fillRows = [&](int beginRow, int endRow) {
+			bool isPerlin = (config.m_type == NoiseFieldType::PERLIN);
+			if (is3D) {
+				if (isPerlin) FillNoiseRows(config, origin, dimensions, is3D, isPerlin, outValues, beginRow, endRow, ComputePerlinOctave3D);
+				else FillNoiseRows(config, origin, dimensions, is3D, isPerlin, outValues, beginRow, endRow, ComputeFractalOctave3D);
+			}
+			else {
+				if (isPerlin) FillNoiseRows(config, origin, dimensions, is3D, isPerlin, outValues, beginRow, endRow, ComputePerlinOctave2D);
+				else FillNoiseRows(config, origin, dimensions, is3D, isPerlin, outValues, beginRow, endRow, ComputeFractalOctave2D);
+			}
+		};
+
+		if (g_theJobSystem) {
+			g_theJobSystem->ParallelFor(rowCount, NOISE_FIELD_MIN_ROWS_PER_JOB, fillRows);
+		}
+		else {
+			fillRows(0, rowCount);
+		}
+	}
+}
+
+Vec2 GetNoiseFieldSamplePosition2D(NoiseFieldConfig const& config, Vec2 const& origin, IntVec2 const& coords)
+{
+	return Vec2(origin.x + ((float)coords.x * config.m_sampleSpacing), origin.y + ((float)coords.y * config.m_sampleSpacing));
+}
+
+Vec3 GetNoiseFieldSamplePosition3D(NoiseFieldConfig const& config, Vec3 const& origin, IntVec3 const& coords)
+{
+	return Vec3(origin.x + ((float)coords.x * config.m_sampleSpacing), origin.y + ((float)coords.y * config.m_sampleSpacing),
+		origin.z + ((float)coords.z * config.m_sampleSpacing));
+}
+
+float ComputeNoiseFieldSample2D(NoiseFieldConfig const& config, Vec2 const& position)
+{
+	if (config.m_type == NoiseFieldType::PERLIN) {
+		return Compute2dPerlinNoise(position.x, position.y, config.m_scale, config.m_numOctaves, config.m_octavePersistence, config.m_octaveScale, config.m_renormalize, config.m_seed);
+	}
+	return Compute2dFractalNoise(position.x, position.y, config.m_scale, config.m_numOctaves, config.m_octavePersistence, config.m_octaveScale, config.m_renormalize, config.m_seed);
+}
+
+float ComputeNoiseFieldSample3D(NoiseFieldConfig const& config, Vec3 const& position)
+{
+	if (config.m_type == NoiseFieldType::PERLIN) {
+		return Compute3dPerlinNoise(position.x, position.y, position.z, config.m_scale, config.m_numOctaves, config.m_octavePersistence, config.m_octaveScale, config.m_renormalize, config.m_seed);
+	}
+	return Compute3dFractalNoise(position.x, position.y, position.z, config.m_scale, config.m_numOctaves, config.m_octavePersistence, config.m_octaveScale, config.m_renormalize, config.m_seed);
+}
+
+void FillNoiseField2D(NoiseFieldConfig const& config, Vec2 const& origin, IntVec2 const& dimensions, float* outValues)
+{
+	FillNoiseField(config, Vec3(origin.x, origin.y, 0.0f), IntVec3(dimensions.x, dimensions.y, 1), outValues, false);
+}
+
+void FillNoiseField2D(NoiseFieldConfig const& config, Vec2 const& origin, IntVec2 const& dimensions, std::vector<float>& outValues)
+{
+	outValues.resize((size_t)dimensions.x * dimensions.y);
+	FillNoiseField2D(config, origin, dimensions, outValues.data());
+}
+
+void FillNoiseField3D(NoiseFieldConfig const& config, Vec3 const& origin, IntVec3 const& dimensions, float* outValues)
+{
+	FillNoiseField(config, origin, dimensions, outValues, true);
+}
+
+void FillNoiseField3D(NoiseFieldConfig const& config, Vec3 const& origin, IntVec3 const& dimensions, std::vector<float>& outValues)
+{
+	outValues.resize((size_t)dimensions.x * dimensions.y * dimensions.z);
+	FillNoiseField3D(config, origin, dimensions, outValues.data());
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/IntVec3.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include <vector>
+
+constexpr int NOISE_FIELD_MIN_ROWS_PER_JOB = 8;
+
+enum class NoiseFieldType {
+	FRACTAL,
+	PERLIN,
+};
+
+/// <summary>
+/// Parameters of SquirrelNoise's Compute2d/3dFractalNoise and Compute2d/3dPerlinNoise, plus how far apart the samples of a grid are
+/// </summary>
+struct NoiseFieldConfig {
+	NoiseFieldType m_type = NoiseFieldType::PERLIN;
+	float m_scale = 1.0f;
+	unsigned int m_numOctaves = 1;
+	float m_octavePersistence = 0.5f;
+	float m_octaveScale = 2.0f;
+	bool m_renormalize = true;
+	unsigned int m_seed = 0;
+	float m_sampleSpacing = 1.0f;
+};
+
+// Sample coords of a field sit at origin + ((float)coords * sampleSpacing) per axis, computed in that order. These call the
+// SquirrelNoise function the config names, the fills below return exactly the same bits for every sample
+Vec2 GetNoiseFieldSamplePosition2D(NoiseFieldConfig const& config, Vec2 const& origin, IntVec2 const& coords);
+Vec3 GetNoiseFieldSamplePosition3D(NoiseFieldConfig const& config, Vec3 const& origin, IntVec3 const& coords);
+float ComputeNoiseFieldSample2D(NoiseFieldConfig const& config, Vec2 const& position);
+float ComputeNoiseFieldSample3D(NoiseFieldConfig const& config, Vec3 const& position);
+
+// Whole grid fills, x fastest then y then z. Octave setup and everything depending only on y and z is computed once per row,
+// 8 samples along x (4 without AVX2) are hashed and blended at once, and rows are spread over the JobSystem when there is one
+void FillNoiseField2D(NoiseFieldConfig const& config, Vec2 const& origin, IntVec2 const& dimensions, float* outValues);
+void FillNoiseField2D(NoiseFieldConfig const& config, Vec2 const& origin, IntVec2 const& dimensions, std::vector<float>& outValues);
+void FillNoiseField3D(NoiseFieldConfig const& config, Vec3 const& origin, IntVec3 const& dimensions, float* outValues);
+void FillNoiseField3D(NoiseFieldConfig const& config, Vec3 const& origin, IntVec3 const& dimensions, std::vector<float>& outValues);
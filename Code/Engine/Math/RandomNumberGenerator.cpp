@@ -1,22 +1,200 @@
 #include "Engine/Math/RandomNumberGenerator.hpp"
 #include "Engine/Math/FloatRange.hpp"
 #include "Engine/Math/IntRange.hpp"
-#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <immintrin.h>
+
+namespace {
+	constexpr uint64_t RNG_JUMP_128[4] = { 0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull, 0xa9582618e03fc9aaull, 0x39abdc4529b1661cull };
+	constexpr uint64_t RNG_JUMP_192[4] = { 0x76e15d3efefdcbbfull, 0xc5004e441c522fb3ull, 0x77710069854ee241ull, 0x39109bb02acbe635ull };
+	constexpr float RNG_UNIT_FLOAT_SCALE = 1.0f / 16777215.0f; // Top 24 bits to [0, 1], both ends included
+
+	uint64_t RotateLeft(uint64_t value, int bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	uint64_t SplitMix64(uint64_t& sequence)
+	{
+		uint64_t value = (sequence += 0x9e3779b97f4a7c15ull);
+		value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+		value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+		return value ^ (value >> 31);
+	}
+
+	uint64_t NextXoshiro256PlusPlus(uint64_t* state)
+	{
+		uint64_t result = RotateLeft(state[0] + state[3], 23) + state[0];
+		uint64_t shifted = state[1] << 17;
+
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= shifted;
+		state[3] = RotateLeft(state[3], 45);
+
+		return result;
+	}
+
+	// Lemire: the high half of value * range is uniform in [0, range) once the few low halves that would bias it are rejected
+	template <typename T_NextUInt32>
+	uint32_t GetBoundedUInt32(uint32_t value, uint32_t range, T_NextUInt32 const& getNextValue)
+	{
+		uint64_t product = (uint64_t)value * range;
+		if ((uint32_t)product < range) {
+			uint32_t threshold = (0u - range) % range;
+			while ((uint32_t)product < threshold) {
+				product = (uint64_t)getNextValue() * range;
+			}
+		}
+		return (uint32_t)(product >> 32);
+	}
+
+	// One xoshiro256++ step for every lane at once, the lanes are the columns of laneStates
+#if defined(__AVX2__)
+	void GenerateLanes(uint64_t (&laneStates)[4][RNG_BATCH_LANES], uint32_t* outValues, int stepCount)
+	{
+		__m256i state0 = _mm256_loadu_si256((__m256i const*)laneStates[0]);
+		__m256i state1 = _mm256_loadu_si256((__m256i const*)laneStates[1]);
+		__m256i state2 = _mm256_loadu_si256((__m256i const*)laneStates[2]);
+		__m256i state3 = _mm256_loadu_si256((__m256i const*)laneStates[3]);
+
+		for (int stepIndex = 0; stepIndex < stepCount; stepIndex++) {
+			__m256i sum = _mm256_add_epi64(state0, state3);
+			__m256i result = _mm256_add_epi64(_mm256_or_si256(_mm256_slli_epi64(sum, 23), _mm256_srli_epi64(sum, 41)), state0);
+			_mm256_storeu_si256((__m256i*)(outValues + (stepIndex * RNG_BATCH_LANES * 2)), result);
+
+			__m256i shifted = _mm256_slli_epi64(state1, 17);
+			state2 = _mm256_xor_si256(state2, state0);
+			state3 = _mm256_xor_si256(state3, state1);
+			state1 = _mm256_xor_si256(state1, state2);
+			state0 = _mm256_xor_si256(state0, state3);
+			state2 = _mm256_xor_si256(state2, shifted);
+			state3 = _mm256_or_si256(_mm256_slli_epi64(state3, 45), _mm256_srli_epi64(state3, 19));
+		}
+
+		_mm256_storeu_si256((__m256i*)laneStates[0], state0);
+		_mm256_storeu_si256((__m256i*)laneStates[1], state1);
+		_mm256_storeu_si256((__m256i*)laneStates[2], state2);
+		_mm256_storeu_si256((__m256i*)laneStates[3], state3);
+	}
+#else
+	// SSE2 only has room for two 64 bit lanes, so the four lanes go as two pairs
+	void GenerateLanes(uint64_t (&laneStates)[4][RNG_BATCH_LANES], uint32_t* outValues, int stepCount)
+	{
+		for (int pairIndex = 0; pairIndex < RNG_BATCH_LANES; pairIndex += 2) {
+			__m128i state0 = _mm_loadu_si128((__m128i const*)&laneStates[0][pairIndex]);
+			__m128i state1 = _mm_loadu_si128((__m128i const*)&laneStates[1][pairIndex]);
+			__m128i state2 = _mm_loadu_si128((__m128i const*)&laneStates[2][pairIndex]);
+			__m128i state3 = _mm_loadu_si128((__m128i const*)&laneStates[3][pairIndex]);
+
+			for (int stepIndex = 0; stepIndex < stepCount; stepIndex++) {
+				__m128i sum = _mm_add_epi64(state0, state3);
+				__m128i result = _mm_add_epi64(_mm_or_si128(_mm_slli_epi64(sum, 23), _mm_srli_epi64(sum, 41)), state0);
+				_mm_storeu_si128((__m128i*)(outValues + (stepIndex * RNG_BATCH_LANES * 2) + (pairIndex * 2)), result);
+
+				__m128i shifted = _mm_slli_epi64(state1, 17);
+				state2 = _mm_xor_si128(state2, state0);
+				state3 = _mm_xor_si128(state3, state1);
+				state1 = _mm_xor_si128(state1, state2);
+				state0 = _mm_xor_si128(state0, state3);
+				state2 = _mm_xor_si128(state2, shifted);
+				state3 = _mm_or_si128(_mm_slli_epi64(state3, 45), _mm_srli_epi64(state3, 19));
+			}
+
+			_mm_storeu_si128((__m128i*)&laneStates[0][pairIndex], state0);
+			_mm_storeu_si128((__m128i*)&laneStates[1][pairIndex], state1);
+			_mm_storeu_si128((__m128i*)&laneStates[2][pairIndex], state2);
+			_mm_storeu_si128((__m128i*)&laneStates[3][pairIndex], state3);
+		}
+	}
+#endif
+
+	// In place, the bits of each value become a float in [minValue, minValue + range]
+	void ConvertUInt32sToFloats(uint32_t* values, int count, float minValue, float range)
+	{
+		float scale = range * RNG_UNIT_FLOAT_SCALE;
+		int valueIndex = 0;
+#if defined(__AVX2__)
+		__m256 scales = _mm256_set1_ps(scale);
+		__m256 minValues = _mm256_set1_ps(minValue);
+		for (; valueIndex + 8 <= count; valueIndex += 8) {
+			__m256i bits = _mm256_srli_epi32(_mm256_loadu_si256((__m256i const*)(values + valueIndex)), 8);
+			__m256 floats = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(bits), scales), minValues);
+			_mm256_storeu_ps((float*)(values + valueIndex), floats);
+		}
+#else
+		__m128 scales = _mm_set1_ps(scale);
+		__m128 minValues = _mm_set1_ps(minValue);
+		for (; valueIndex + 4 <= count; valueIndex += 4) {
+			__m128i bits = _mm_srli_epi32(_mm_loadu_si128((__m128i const*)(values + valueIndex)), 8);
+			__m128 floats = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(bits), scales), minValues);
+			_mm_storeu_ps((float*)(values + valueIndex), floats);
+		}
+#endif
+		for (; valueIndex < count; valueIndex++) {
+			float value = ((float)(values[valueIndex] >> 8) * scale) + minValue;
+			memcpy(&values[valueIndex], &value, sizeof(float));
+		}
+	}
+}
+
+RandomNumberGenerator::RandomNumberGenerator()
+{
+	// Each default generator takes the next seed of a process wide sequence, started from the clock
+	static std::atomic<uint64_t> s_defaultSeedSequence = (uint64_t)std::chrono::high_resolution_clock::now().time_since_epoch().count();
+	uint64_t sequence = s_defaultSeedSequence.fetch_add(1);
+	SetSeed(SplitMix64(sequence));
+}
+
+RandomNumberGenerator::RandomNumberGenerator(uint64_t seed)
+{
+	SetSeed(seed);
+}
+
+void RandomNumberGenerator::SetSeed(uint64_t seed)
+{
+	m_seed = seed;
+
+	// SplitMix64 spreads any seed, including 0, over the whole state
+	uint64_t sequence = seed;
+	for (int stateIndex = 0; stateIndex < 4; stateIndex++) {
+		m_state[stateIndex] = SplitMix64(sequence);
+	}
+	m_areLanesSeeded = false;
+}
+
+uint64_t RandomNumberGenerator::GetRandomUInt64()
+{
+	return NextXoshiro256PlusPlus(m_state);
+}
+
+uint32_t RandomNumberGenerator::GetRandomUInt32LessThan(uint32_t maxNotInclusive)
+{
+	if (maxNotInclusive == 0) return 0;
+	return GetBoundedUInt32(GetRandomUInt32(), maxNotInclusive, [&]() { return GetRandomUInt32(); });
+}
 
 int RandomNumberGenerator::GetRandomIntLessThan(int maxNotInclusive)
 {
-	return rand() % maxNotInclusive;
+	if (maxNotInclusive <= 0) return 0;
+	return (int)GetRandomUInt32LessThan((uint32_t)maxNotInclusive);
 }
 
 int RandomNumberGenerator::GetRandomIntInRange(int minInclusive, int maxInclusive)
 {
-	int range = 1 + maxInclusive - minInclusive;
-	return (rand() % range) + minInclusive;
+	// Computed unsigned so the full int range does not overflow, a range of 2^32 wraps to 0
+	uint32_t range = (uint32_t)maxInclusive - (uint32_t)minInclusive + 1u;
+	if (range == 0) return (int)GetRandomUInt32();
+	return (int)((uint32_t)minInclusive + GetRandomUInt32LessThan(range));
 }
 
 float RandomNumberGenerator::GetRandomFloatZeroUpToOne()
 {
-	return static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+	return (float)(GetRandomUInt64() >> 40) * RNG_UNIT_FLOAT_SCALE;
 }
 
 float RandomNumberGenerator::GetRandomFloatInRange(float minInclusive, float maxInclusive)
@@ -35,3 +213,102 @@ int RandomNumberGenerator::GetRandomIntInRange(IntRange const& range)
 	return GetRandomIntInRange(range.m_min, range.m_max);
 }
 
+void RandomNumberGenerator::ApplyJumpPolynomial(uint64_t* state, uint64_t const* polynomial) const
+{
+	uint64_t jumpedState[4] = {};
+	for (int wordIndex = 0; wordIndex < 4; wordIndex++) {
+		for (int bitIndex = 0; bitIndex < 64; bitIndex++) {
+			if (polynomial[wordIndex] & (1ull << bitIndex)) {
+				for (int stateIndex = 0; stateIndex < 4; stateIndex++) {
+					jumpedState[stateIndex] ^= state[stateIndex];
+				}
+			}
+			NextXoshiro256PlusPlus(state);
+		}
+	}
+	memcpy(state, jumpedState, sizeof(jumpedState));
+}
+
+void RandomNumberGenerator::Jump()
+{
+	ApplyJumpPolynomial(m_state, RNG_JUMP_192);
+	m_areLanesSeeded = false; // The lanes belonged to the block that was left
+}
+
+RandomNumberGenerator RandomNumberGenerator::Split()
+{
+	// The child keeps this block and any lanes already in use, this generator moves to a fresh block
+	RandomNumberGenerator child = *this;
+	Jump();
+	return child;
+}
+
+void RandomNumberGenerator::SeedBatchLanes()
+{
+	uint64_t laneState[4];
+	memcpy(laneState, m_state, sizeof(laneState));
+
+	for (int laneIndex = 0; laneIndex < RNG_BATCH_LANES; laneIndex++) {
+		ApplyJumpPolynomial(laneState, RNG_JUMP_128);
+		for (int stateIndex = 0; stateIndex < 4; stateIndex++) {
+			m_laneStates[stateIndex][laneIndex] = laneState[stateIndex];
+		}
+	}
+	m_areLanesSeeded = true;
+}
+
+void RandomNumberGenerator::FillRandomUInt32s(uint32_t* outValues, int count)
+{
+	if (count <= 0) return;
+	if (!m_areLanesSeeded) {
+		SeedBatchLanes();
+	}
+
+	// Each step gives two 32 bit values per lane
+	constexpr int VALUES_PER_STEP = RNG_BATCH_LANES * 2;
+	int fullStepCount = count / VALUES_PER_STEP;
+	GenerateLanes(m_laneStates, outValues, fullStepCount);
+
+	int remainingCount = count - (fullStepCount * VALUES_PER_STEP);
+	if (remainingCount > 0) {
+		uint32_t lastStepValues[VALUES_PER_STEP];
+		GenerateLanes(m_laneStates, lastStepValues, 1);
+		memcpy(outValues + (fullStepCount * VALUES_PER_STEP), lastStepValues, remainingCount * sizeof(uint32_t));
+	}
+}
+
+void RandomNumberGenerator::FillRandomFloatsZeroUpToOne(float* outValues, int count)
+{
+	FillRandomFloatsInRange(outValues, count, 0.0f, 1.0f);
+}
+
+void RandomNumberGenerator::FillRandomFloatsInRange(float* outValues, int count, float minInclusive, float maxInclusive)
+{
+	// Generated as bits straight into the output, then converted in place
+	uint32_t* valueBits = reinterpret_cast<uint32_t*>(outValues);
+	FillRandomUInt32s(valueBits, count);
+	ConvertUInt32sToFloats(valueBits, count, minInclusive, maxInclusive - minInclusive);
+}
+
+void RandomNumberGenerator::FillRandomIntsInRange(int* outValues, int count, int minInclusive, int maxInclusive)
+{
+	uint32_t* valueBits = reinterpret_cast<uint32_t*>(outValues);
+	FillRandomUInt32s(valueBits, count);
+
+	uint32_t range = (uint32_t)maxInclusive - (uint32_t)minInclusive + 1u;
+	if (range == 0) return;
+
+	// Rejections are rare, their replacements come from the first lane so the single draw stream stays untouched
+	auto getNextLaneValue = [&]() {
+		uint64_t laneState[4] = { m_laneStates[0][0], m_laneStates[1][0], m_laneStates[2][0], m_laneStates[3][0] };
+		uint32_t value = (uint32_t)(NextXoshiro256PlusPlus(laneState) >> 32);
+		for (int stateIndex = 0; stateIndex < 4; stateIndex++) {
+			m_laneStates[stateIndex][0] = laneState[stateIndex];
+		}
+		return value;
+	};
+
+	for (int valueIndex = 0; valueIndex < count; valueIndex++) {
+		valueBits[valueIndex] = (uint32_t)minInclusive + GetBoundedUInt32(valueBits[valueIndex], range, getNextLaneValue);
+	}
+}
@@ -1,14 +1,56 @@
 #pragma once
+#include <cstdint>
 
 struct FloatRange;
 struct IntRange;
 
+constexpr int RNG_BATCH_LANES = 4; // Independent streams the batch fills interleave, as many as a 256 bit register holds
+
+/// <summary>
+/// xoshiro256++ with per instance state, so generators are independent and reproducible from their seed. Not thread safe,
+/// give every job its own generator through Split(). Default constructed generators get a seed unique to the process run.
+/// Layout of the 2^256 sequence: Jump()/Split() move in steps of 2^192 draws, the batch fill lanes sit 2^128 apart inside
+/// the current block, so none of the streams ever overlap
+/// </summary>
 class RandomNumberGenerator {
 public:
+	RandomNumberGenerator();
+	explicit RandomNumberGenerator(uint64_t seed);
+
+	void SetSeed(uint64_t seed);
+	uint64_t GetSeed() const { return m_seed; }
+
 	int GetRandomIntLessThan(int maxNotInclusive);
 	int GetRandomIntInRange(int minInclusive, int maxInclusive);
 	float GetRandomFloatZeroUpToOne();
 	float GetRandomFloatInRange(float minInclusive, float maxInclusive);
 	float GetRandomFloatInRange(FloatRange const& range);
 	int GetRandomIntInRange(IntRange const& range);
+
+	uint64_t GetRandomUInt64();
+	uint32_t GetRandomUInt32() { return (uint32_t)(GetRandomUInt64() >> 32); }
+	uint32_t GetRandomUInt32LessThan(uint32_t maxNotInclusive); // Lemire's multiply and reject, unbiased
+
+	// Skips 2^192 draws
+	void Jump();
+	// Returns a generator continuing this stream and jumps this one ahead, for handing streams to jobs. The same seed and the
+	// same sequence of splits give the same streams, so parallel work stays deterministic
+	RandomNumberGenerator Split();
+
+	// Batch fills, RNG_BATCH_LANES streams generated side by side with SIMD. Deterministic for a given seed, but a different
+	// sequence from the single draw functions, which they do not advance
+	void FillRandomUInt32s(uint32_t* outValues, int count);
+	void FillRandomFloatsZeroUpToOne(float* outValues, int count);
+	void FillRandomFloatsInRange(float* outValues, int count, float minInclusive, float maxInclusive);
+	void FillRandomIntsInRange(int* outValues, int count, int minInclusive, int maxInclusive);
+
+private:
+	void ApplyJumpPolynomial(uint64_t* state, uint64_t const* polynomial) const;
+	void SeedBatchLanes();
+
+private:
+	uint64_t m_seed = 0;
+	uint64_t m_state[4] = {};
+	uint64_t m_laneStates[4][RNG_BATCH_LANES] = {}; // [state word][lane], so each word loads straight into a register
+	bool m_areLanesSeeded = false;
 };
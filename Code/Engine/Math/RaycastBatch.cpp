@@ -0,0 +1,661 @@
+#include "Engine/Math/RaycastBatch.hpp"
+#include "Engine/Math/SIMDUtils.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/JobSystem.hpp"
+
+namespace {
+	constexpr float RAYCAST_BATCH_PARALLEL_EPSILON = 1e-12f; // Below this the ray is parallel to the cylinder axis
+
+	template <typename F>
+	struct RayPack3D {
+		F m_startX, m_startY, m_startZ;
+		F m_forwardX, m_forwardY, m_forwardZ;
+		F m_maxDistance;
+	};
+
+	template <typename F>
+	struct RayPack2D {
+		F m_startX, m_startY;
+		F m_forwardX, m_forwardY;
+		F m_maxDistance;
+	};
+
+	template <typename F>
+	struct HitPack3D {
+		F m_hitMask;
+		F m_impactDist;
+		F m_normalX, m_normalY, m_normalZ;
+	};
+
+	template <typename F>
+	struct HitPack2D {
+		F m_hitMask;
+		F m_impactDist;
+		F m_normalX, m_normalY;
+	};
+
+	template <typename F>
+	F GetLaneIndices()
+	{
+		alignas(32) float laneIndices[F::LANES];
+		for (int lane = 0; lane < F::LANES; lane++) {
+			laneIndices[lane] = (float)lane;
+		}
+		return F::Load(laneIndices);
+	}
+
+	// Loads lanes [index, index + LANES). Past the end of the array lanes get padValue
+	template <typename F>
+	F LoadPack(std::vector<float> const& values, int index, float padValue)
+	{
+		int count = (int)values.size();
+		if (index + F::LANES <= count) return F::Load(values.data() + index);
+
+		alignas(32) float paddedValues[F::LANES];
+		for (int lane = 0; lane < F::LANES; lane++) {
+			paddedValues[lane] = (index + lane < count) ? values[index + lane] : padValue;
+		}
+		return F::Load(paddedValues);
+	}
+
+	// Padded rays get a negative max distance, every kernel requires 0 <= impactDist <= maxDistance so they never hit
+	template <typename F>
+	RayPack3D<F> LoadRayPack(RaycastBatch3D const& rays, int rayIndex)
+	{
+		RayPack3D<F> ray;
+		ray.m_startX = LoadPack<F>(rays.m_startX, rayIndex, 0.0f);
+		ray.m_startY = LoadPack<F>(rays.m_startY, rayIndex, 0.0f);
+		ray.m_startZ = LoadPack<F>(rays.m_startZ, rayIndex, 0.0f);
+		ray.m_forwardX = LoadPack<F>(rays.m_forwardX, rayIndex, 1.0f);
+		ray.m_forwardY = LoadPack<F>(rays.m_forwardY, rayIndex, 0.0f);
+		ray.m_forwardZ = LoadPack<F>(rays.m_forwardZ, rayIndex, 0.0f);
+		ray.m_maxDistance = LoadPack<F>(rays.m_maxDistance, rayIndex, -1.0f);
+		return ray;
+	}
+
+	template <typename F>
+	RayPack2D<F> LoadRayPack(RaycastBatch2D const& rays, int rayIndex)
+	{
+		RayPack2D<F> ray;
+		ray.m_startX = LoadPack<F>(rays.m_startX, rayIndex, 0.0f);
+		ray.m_startY = LoadPack<F>(rays.m_startY, rayIndex, 0.0f);
+		ray.m_forwardX = LoadPack<F>(rays.m_forwardX, rayIndex, 1.0f);
+		ray.m_forwardY = LoadPack<F>(rays.m_forwardY, rayIndex, 0.0f);
+		ray.m_maxDistance = LoadPack<F>(rays.m_maxDistance, rayIndex, -1.0f);
+		return ray;
+	}
+
+	template <typename F>
+	RayPack3D<F> BroadcastRay(Vec3 const& rayStart, Vec3 const& rayForward, float maxDistance)
+	{
+		RayPack3D<F> ray;
+		ray.m_startX = F::Broadcast(rayStart.x);
+		ray.m_startY = F::Broadcast(rayStart.y);
+		ray.m_startZ = F::Broadcast(rayStart.z);
+		ray.m_forwardX = F::Broadcast(rayForward.x);
+		ray.m_forwardY = F::Broadcast(rayForward.y);
+		ray.m_forwardZ = F::Broadcast(rayForward.z);
+		ray.m_maxDistance = F::Broadcast(maxDistance);
+		return ray;
+	}
+
+	template <typename F>
+	RayPack2D<F> BroadcastRay(Vec2 const& rayStart, Vec2 const& rayForward, float maxDistance)
+	{
+		RayPack2D<F> ray;
+		ray.m_startX = F::Broadcast(rayStart.x);
+		ray.m_startY = F::Broadcast(rayStart.y);
+		ray.m_forwardX = F::Broadcast(rayForward.x);
+		ray.m_forwardY = F::Broadcast(rayForward.y);
+		ray.m_maxDistance = F::Broadcast(maxDistance);
+		return ray;
+	}
+
+	//-----------------------------------------------------------------------------------------------
+	// Shape packs, either one shape broadcast to every lane or one shape per lane
+	template <typename F>
+	struct SpherePack {
+		F m_centerX, m_centerY, m_centerZ, m_radius;
+
+		SpherePack(Vec3 const& center, float radius) :
+			m_centerX(F::Broadcast(center.x)), m_centerY(F::Broadcast(center.y)), m_centerZ(F::Broadcast(center.z)), m_radius(F::Broadcast(radius)) {}
+
+		SpherePack(RaycastSphereSet const& spheres, int shapeIndex) :
+			m_centerX(LoadPack<F>(spheres.m_centerX, shapeIndex, 0.0f)), m_centerY(LoadPack<F>(spheres.m_centerY, shapeIndex, 0.0f)),
+			m_centerZ(LoadPack<F>(spheres.m_centerZ, shapeIndex, 0.0f)), m_radius(LoadPack<F>(spheres.m_radius, shapeIndex, 0.0f)) {}
+	};
+
+	template <typename F>
+	struct Box3DPack {
+		F m_minX, m_minY, m_minZ, m_maxX, m_maxY, m_maxZ;
+
+		Box3DPack(AABB3 const& box) :
+			m_minX(F::Broadcast(box.m_mins.x)), m_minY(F::Broadcast(box.m_mins.y)), m_minZ(F::Broadcast(box.m_mins.z)),
+			m_maxX(F::Broadcast(box.m_maxs.x)), m_maxY(F::Broadcast(box.m_maxs.y)), m_maxZ(F::Broadcast(box.m_maxs.z)) {}
+
+		Box3DPack(RaycastBox3DSet const& boxes, int shapeIndex) :
+			m_minX(LoadPack<F>(boxes.m_minX, shapeIndex, 0.0f)), m_minY(LoadPack<F>(boxes.m_minY, shapeIndex, 0.0f)), m_minZ(LoadPack<F>(boxes.m_minZ, shapeIndex, 0.0f)),
+			m_maxX(LoadPack<F>(boxes.m_maxX, shapeIndex, 0.0f)), m_maxY(LoadPack<F>(boxes.m_maxY, shapeIndex, 0.0f)), m_maxZ(LoadPack<F>(boxes.m_maxZ, shapeIndex, 0.0f)) {}
+	};
+
+	template <typename F>
+	struct ZCylinderPack {
+		F m_centerX, m_centerY, m_minZ, m_maxZ, m_radius;
+
+		ZCylinderPack(Vec3 const& cylinderBase, float cylinderRadius, float cylinderHeight) :
+			m_centerX(F::Broadcast(cylinderBase.x)), m_centerY(F::Broadcast(cylinderBase.y)),
+			m_minZ(F::Broadcast(cylinderBase.z)), m_maxZ(F::Broadcast(cylinderBase.z + cylinderHeight)), m_radius(F::Broadcast(cylinderRadius)) {}
+
+		ZCylinderPack(RaycastZCylinderSet const& cylinders, int shapeIndex) :
+			m_centerX(LoadPack<F>(cylinders.m_centerX, shapeIndex, 0.0f)), m_centerY(LoadPack<F>(cylinders.m_centerY, shapeIndex, 0.0f)),
+			m_minZ(LoadPack<F>(cylinders.m_minZ, shapeIndex, 0.0f)), m_maxZ(LoadPack<F>(cylinders.m_maxZ, shapeIndex, 0.0f)), m_radius(LoadPack<F>(cylinders.m_radius, shapeIndex, 0.0f)) {}
+	};
+
+	template <typename F>
+	struct DiscPack {
+		F m_centerX, m_centerY, m_radius;
+
+		DiscPack(Vec2 const& center, float radius) :
+			m_centerX(F::Broadcast(center.x)), m_centerY(F::Broadcast(center.y)), m_radius(F::Broadcast(radius)) {}
+
+		DiscPack(RaycastDiscSet const& discs, int shapeIndex) :
+			m_centerX(LoadPack<F>(discs.m_centerX, shapeIndex, 0.0f)), m_centerY(LoadPack<F>(discs.m_centerY, shapeIndex, 0.0f)), m_radius(LoadPack<F>(discs.m_radius, shapeIndex, 0.0f)) {}
+	};
+
+	//-----------------------------------------------------------------------------------------------
+	// Kernels. Every lane is one (ray, shape) pair, misses are only masked out, never branched on
+	template <typename F>
+	void IntersectSphere(RayPack3D<F> const& ray, SpherePack<F> const& sphere, HitPack3D<F>& outHit)
+	{
+		F relStartX = ray.m_startX - sphere.m_centerX;
+		F relStartY = ray.m_startY - sphere.m_centerY;
+		F relStartZ = ray.m_startZ - sphere.m_centerZ;
+
+		F b = (relStartX * ray.m_forwardX) + (relStartY * ray.m_forwardY) + (relStartZ * ray.m_forwardZ);
+		F c = (relStartX * relStartX) + (relStartY * relStartY) + (relStartZ * relStartZ) - (sphere.m_radius * sphere.m_radius);
+		F discriminant = (b * b) - c;
+
+		F zero = F::Zero();
+		F isStartInside = c <= zero;
+		F impactDist = SimdSelect(isStartInside, zero, -b - SimdSqrt(SimdMax(discriminant, zero)));
+
+		outHit.m_hitMask = (discriminant >= zero) & (impactDist >= zero) & (impactDist <= ray.m_maxDistance);
+		outHit.m_impactDist = impactDist;
+
+		F inverseRadius = F::Broadcast(1.0f) / sphere.m_radius;
+		outHit.m_normalX = SimdSelect(isStartInside, -ray.m_forwardX, (relStartX + (ray.m_forwardX * impactDist)) * inverseRadius);
+		outHit.m_normalY = SimdSelect(isStartInside, -ray.m_forwardY, (relStartY + (ray.m_forwardY * impactDist)) * inverseRadius);
+		outHit.m_normalZ = SimdSelect(isStartInside, -ray.m_forwardZ, (relStartZ + (ray.m_forwardZ * impactDist)) * inverseRadius);
+	}
+
+	template <typename F>
+	void IntersectBox3D(RayPack3D<F> const& ray, Box3DPack<F> const& box, HitPack3D<F>& outHit)
+	{
+		// Slabs. A zero forward component gives +-inf, which min/max handle
+		F one = F::Broadcast(1.0f);
+		F inverseForwardX = one / ray.m_forwardX;
+		F inverseForwardY = one / ray.m_forwardY;
+		F inverseForwardZ = one / ray.m_forwardZ;
+
+		F minXDist = (box.m_minX - ray.m_startX) * inverseForwardX;
+		F maxXDist = (box.m_maxX - ray.m_startX) * inverseForwardX;
+		F minYDist = (box.m_minY - ray.m_startY) * inverseForwardY;
+		F maxYDist = (box.m_maxY - ray.m_startY) * inverseForwardY;
+		F minZDist = (box.m_minZ - ray.m_startZ) * inverseForwardZ;
+		F maxZDist = (box.m_maxZ - ray.m_startZ) * inverseForwardZ;
+
+		F entryX = SimdMin(minXDist, maxXDist);
+		F entryY = SimdMin(minYDist, maxYDist);
+		F entryZ = SimdMin(minZDist, maxZDist);
+		F entryDist = SimdMax(SimdMax(entryX, entryY), entryZ);
+		F exitDist = SimdMin(SimdMin(SimdMax(minXDist, maxXDist), SimdMax(minYDist, maxYDist)), SimdMax(minZDist, maxZDist));
+
+		F zero = F::Zero();
+		F isStartInside = entryDist < zero;
+		F impactDist = SimdMax(entryDist, zero);
+
+		outHit.m_hitMask = (entryDist <= exitDist) & (exitDist >= zero) & (impactDist <= ray.m_maxDistance);
+		outHit.m_impactDist = impactDist;
+
+		// Entry face is the slab entered last. Ties resolve x, then y, then z
+		F isEntryX = entryX >= entryDist;
+		F isEntryY = AndNot(isEntryX, entryY >= entryDist);
+		F isEntryZ = AndNot(isEntryX | isEntryY, F::AllBits());
+		F negativeOne = F::Broadcast(-1.0f);
+
+		outHit.m_normalX = SimdSelect(isStartInside, -ray.m_forwardX, isEntryX & SimdSelect(ray.m_forwardX < zero, one, negativeOne));
+		outHit.m_normalY = SimdSelect(isStartInside, -ray.m_forwardY, isEntryY & SimdSelect(ray.m_forwardY < zero, one, negativeOne));
+		outHit.m_normalZ = SimdSelect(isStartInside, -ray.m_forwardZ, isEntryZ & SimdSelect(ray.m_forwardZ < zero, one, negativeOne));
+	}
+
+	template <typename F>
+	void IntersectZCylinder(RayPack3D<F> const& ray, ZCylinderPack<F> const& cylinder, HitPack3D<F>& outHit)
+	{
+		F zero = F::Zero();
+		F relStartX = ray.m_startX - cylinder.m_centerX;
+		F relStartY = ray.m_startY - cylinder.m_centerY;
+		F radiusSquared = cylinder.m_radius * cylinder.m_radius;
+
+		// Side: circle in XY, the z at the hit must be within the caps
+		F a = (ray.m_forwardX * ray.m_forwardX) + (ray.m_forwardY * ray.m_forwardY);
+		F b = (relStartX * ray.m_forwardX) + (relStartY * ray.m_forwardY);
+		F c = (relStartX * relStartX) + (relStartY * relStartY) - radiusSquared;
+		F discriminant = (b * b) - (a * c);
+
+		F isMovingInXY = a > F::Broadcast(RAYCAST_BATCH_PARALLEL_EPSILON);
+		F sideDist = (-b - SimdSqrt(SimdMax(discriminant, zero))) / SimdSelect(isMovingInXY, a, F::Broadcast(1.0f));
+		F sideZ = ray.m_startZ + (ray.m_forwardZ * sideDist);
+		F isSideHit = isMovingInXY & (discriminant >= zero) & (sideDist >= zero) & (sideZ >= cylinder.m_minZ) & (sideZ <= cylinder.m_maxZ);
+
+		// Caps: only the one facing the ray start can be entered
+		F isAbove = ray.m_startZ > cylinder.m_maxZ;
+		F isBelow = ray.m_startZ < cylinder.m_minZ;
+		F capZ = SimdSelect(isAbove, cylinder.m_maxZ, cylinder.m_minZ);
+		F capDist = (capZ - ray.m_startZ) / ray.m_forwardZ;
+		F capX = relStartX + (ray.m_forwardX * capDist);
+		F capY = relStartY + (ray.m_forwardY * capDist);
+		F isFacingCap = (isAbove & (ray.m_forwardZ < zero)) | (isBelow & (ray.m_forwardZ > zero));
+		F isCapHit = isFacingCap & (((capX * capX) + (capY * capY)) <= radiusSquared);
+
+		F isStartInside = (c <= zero) & AndNot(isAbove | isBelow, F::AllBits());
+		F maxDist = ray.m_maxDistance;
+		F farAway = F::Broadcast(3.4e38f);
+		F impactDist = SimdMin(SimdSelect(isSideHit, sideDist, farAway), SimdSelect(isCapHit, capDist, farAway));
+		impactDist = SimdSelect(isStartInside, zero, impactDist);
+
+		outHit.m_hitMask = (isStartInside | isSideHit | isCapHit) & (impactDist <= maxDist);
+		outHit.m_impactDist = impactDist;
+
+		F isSideNearest = isSideHit & (sideDist <= impactDist);
+		F inverseRadius = F::Broadcast(1.0f) / cylinder.m_radius;
+		F capNormalZ = SimdSelect(isAbove, F::Broadcast(1.0f), F::Broadcast(-1.0f));
+
+		outHit.m_normalX = SimdSelect(isStartInside, -ray.m_forwardX, isSideNearest & ((relStartX + (ray.m_forwardX * impactDist)) * inverseRadius));
+		outHit.m_normalY = SimdSelect(isStartInside, -ray.m_forwardY, isSideNearest & ((relStartY + (ray.m_forwardY * impactDist)) * inverseRadius));
+		outHit.m_normalZ = SimdSelect(isStartInside, -ray.m_forwardZ, AndNot(isSideNearest, capNormalZ));
+	}
+
+	template <typename F>
+	void IntersectDisc(RayPack2D<F> const& ray, DiscPack<F> const& disc, HitPack2D<F>& outHit)
+	{
+		F relStartX = ray.m_startX - disc.m_centerX;
+		F relStartY = ray.m_startY - disc.m_centerY;
+
+		F b = (relStartX * ray.m_forwardX) + (relStartY * ray.m_forwardY);
+		F c = (relStartX * relStartX) + (relStartY * relStartY) - (disc.m_radius * disc.m_radius);
+		F discriminant = (b * b) - c;
+
+		F zero = F::Zero();
+		F isStartInside = c <= zero;
+		F impactDist = SimdSelect(isStartInside, zero, -b - SimdSqrt(SimdMax(discriminant, zero)));
+
+		outHit.m_hitMask = (discriminant >= zero) & (impactDist >= zero) & (impactDist <= ray.m_maxDistance);
+		outHit.m_impactDist = impactDist;
+
+		F inverseRadius = F::Broadcast(1.0f) / disc.m_radius;
+		outHit.m_normalX = SimdSelect(isStartInside, -ray.m_forwardX, (relStartX + (ray.m_forwardX * impactDist)) * inverseRadius);
+		outHit.m_normalY = SimdSelect(isStartInside, -ray.m_forwardY, (relStartY + (ray.m_forwardY * impactDist)) * inverseRadius);
+	}
+
+	//-----------------------------------------------------------------------------------------------
+	// Drivers shared by every shape type
+	template <typename F>
+	struct HitLanes3D {
+		alignas(32) float m_impactDist[F::LANES];
+		alignas(32) float m_normalX[F::LANES];
+		alignas(32) float m_normalY[F::LANES];
+		alignas(32) float m_normalZ[F::LANES];
+
+		void Store(HitPack3D<F> const& hit)
+		{
+			hit.m_impactDist.Store(m_impactDist);
+			hit.m_normalX.Store(m_normalX);
+			hit.m_normalY.Store(m_normalY);
+			hit.m_normalZ.Store(m_normalZ);
+		}
+
+		RaycastBatchHit3D GetHit(int lane, int rayIndex, int shapeIndex) const
+		{
+			RaycastBatchHit3D batchHit;
+			batchHit.m_impactNormal = Vec3(m_normalX[lane], m_normalY[lane], m_normalZ[lane]);
+			batchHit.m_impactDist = m_impactDist[lane];
+			batchHit.m_rayIndex = rayIndex;
+			batchHit.m_shapeIndex = shapeIndex;
+			return batchHit;
+		}
+	};
+
+	template <typename F>
+	struct HitLanes2D {
+		alignas(32) float m_impactDist[F::LANES];
+		alignas(32) float m_normalX[F::LANES];
+		alignas(32) float m_normalY[F::LANES];
+
+		void Store(HitPack2D<F> const& hit)
+		{
+			hit.m_impactDist.Store(m_impactDist);
+			hit.m_normalX.Store(m_normalX);
+			hit.m_normalY.Store(m_normalY);
+		}
+
+		RaycastBatchHit2D GetHit(int lane, int rayIndex, int shapeIndex) const
+		{
+			RaycastBatchHit2D batchHit;
+			batchHit.m_impactNormal = Vec2(m_normalX[lane], m_normalY[lane]);
+			batchHit.m_impactDist = m_impactDist[lane];
+			batchHit.m_rayIndex = rayIndex;
+			batchHit.m_shapeIndex = shapeIndex;
+			return batchHit;
+		}
+	};
+
+	template <int DIMENSIONS> struct BatchTypes;
+	template <> struct BatchTypes<3> {
+		using Rays = RaycastBatch3D;
+		using Hit = RaycastBatchHit3D;
+		template <typename F> using HitPack = HitPack3D<F>;
+		template <typename F> using HitLanes = HitLanes3D<F>;
+	};
+	template <> struct BatchTypes<2> {
+		using Rays = RaycastBatch2D;
+		using Hit = RaycastBatchHit2D;
+		template <typename F> using HitPack = HitPack2D<F>;
+		template <typename F> using HitLanes = HitLanes2D<F>;
+	};
+
+	// LANES rays vs the same shape per step, lanes that hit are appended in ray order
+	template <int DIMENSIONS, typename T_ShapePack, typename T_Kernel>
+	int RaysVsShape(typename BatchTypes<DIMENSIONS>::Rays const& rays, T_ShapePack const& shape, T_Kernel const& kernel, int shapeIndex, std::vector<typename BatchTypes<DIMENSIONS>::Hit>& outHits)
+	{
+		using Types = BatchTypes<DIMENSIONS>;
+		typename Types::template HitPack<SimdFloatN> hit;
+		typename Types::template HitLanes<SimdFloatN> hitLanes;
+
+		size_t hitCountBefore = outHits.size();
+		int rayCount = rays.GetCount();
+		for (int rayIndex = 0; rayIndex < rayCount; rayIndex += SIMD_WIDTH) {
+			kernel(LoadRayPack<SimdFloatN>(rays, rayIndex), shape, hit);
+
+			int hitBits = GetMaskBits(hit.m_hitMask);
+			if (hitBits == 0) continue;
+
+			hitLanes.Store(hit);
+			for (int lane = 0; lane < SIMD_WIDTH; lane++) {
+				if ((hitBits & (1 << lane)) != 0) {
+					outHits.push_back(hitLanes.GetHit(lane, rayIndex + lane, shapeIndex));
+				}
+			}
+		}
+
+		return (int)(outHits.size() - hitCountBefore);
+	}
+
+	// One ray vs LANES shapes per step. Lanes past the set or farther than the nearest hit so far are masked out
+	template <int DIMENSIONS, typename T_ShapeSet, typename T_RayPack, typename T_LoadShape, typename T_Kernel>
+	bool RayVsShapeSet(T_RayPack const& ray, T_ShapeSet const& shapes, int rayIndex, T_LoadShape const& loadShape, T_Kernel const& kernel, typename BatchTypes<DIMENSIONS>::Hit& outNearestHit)
+	{
+		using Types = BatchTypes<DIMENSIONS>;
+		typename Types::template HitPack<SimdFloatN> hit;
+		typename Types::template HitLanes<SimdFloatN> hitLanes;
+
+		SimdFloatN laneIndices = GetLaneIndices<SimdFloatN>();
+		SimdFloatN nearestDist = ray.m_maxDistance;
+		bool didHit = false;
+
+		int shapeCount = shapes.GetCount();
+		for (int shapeIndex = 0; shapeIndex < shapeCount; shapeIndex += SIMD_WIDTH) {
+			kernel(ray, loadShape(shapes, shapeIndex), hit);
+
+			SimdFloatN isValidLane = laneIndices < SimdFloatN::Broadcast((float)(shapeCount - shapeIndex));
+			int hitBits = GetMaskBits(hit.m_hitMask & isValidLane & (hit.m_impactDist <= nearestDist));
+			if (hitBits == 0) continue;
+
+			hitLanes.Store(hit);
+			for (int lane = 0; lane < SIMD_WIDTH; lane++) {
+				if ((hitBits & (1 << lane)) == 0) continue;
+				if (didHit && (hitLanes.m_impactDist[lane] >= outNearestHit.m_impactDist)) continue;
+
+				outNearestHit = hitLanes.GetHit(lane, rayIndex, shapeIndex + lane);
+				didHit = true;
+			}
+			nearestDist = SimdFloatN::Broadcast(outNearestHit.m_impactDist);
+		}
+
+		return didHit;
+	}
+
+	template <int DIMENSIONS, typename T_ShapeSet, typename T_LoadShape, typename T_Kernel>
+	void RaysVsShapeSet(typename BatchTypes<DIMENSIONS>::Rays const& rays, T_ShapeSet const& shapes, T_LoadShape const& loadShape, T_Kernel const& kernel, std::vector<typename BatchTypes<DIMENSIONS>::Hit>& outNearestHits)
+	{
+		using Types = BatchTypes<DIMENSIONS>;
+		int rayCount = rays.GetCount();
+		outNearestHits.resize(rayCount);
+
+		auto castRays = [&](int beginIndex, int endIndex) {
+			for (int rayIndex = beginIndex; rayIndex < endIndex; rayIndex++) {
+				typename Types::Hit& nearestHit = outNearestHits[rayIndex];
+				nearestHit = typename Types::Hit();
+				nearestHit.m_rayIndex = rayIndex;
+
+				auto ray = BroadcastRay<SimdFloatN>(rays.GetRayStart(rayIndex), rays.GetRayForward(rayIndex), rays.m_maxDistance[rayIndex]);
+				RayVsShapeSet<DIMENSIONS>(ray, shapes, rayIndex, loadShape, kernel, nearestHit);
+			}
+		};
+
+		if (g_theJobSystem) {
+			g_theJobSystem->ParallelFor(rayCount, RAYCAST_BATCH_MIN_RAYS_PER_JOB, castRays);
+		}
+		else {
+			castRays(0, rayCount);
+		}
+	}
+
+	auto const SPHERE_KERNEL = [](auto const& ray, auto const& shape, auto& hit) { IntersectSphere(ray, shape, hit); };
+	auto const BOX3D_KERNEL = [](auto const& ray, auto const& shape, auto& hit) { IntersectBox3D(ray, shape, hit); };
+	auto const ZCYLINDER_KERNEL = [](auto const& ray, auto const& shape, auto& hit) { IntersectZCylinder(ray, shape, hit); };
+	auto const DISC_KERNEL = [](auto const& ray, auto const& shape, auto& hit) { IntersectDisc(ray, shape, hit); };
+
+	auto const LOAD_SPHERES = [](RaycastSphereSet const& spheres, int shapeIndex) { return SpherePack<SimdFloatN>(spheres, shapeIndex); };
+	auto const LOAD_BOXES = [](RaycastBox3DSet const& boxes, int shapeIndex) { return Box3DPack<SimdFloatN>(boxes, shapeIndex); };
+	auto const LOAD_ZCYLINDERS = [](RaycastZCylinderSet const& cylinders, int shapeIndex) { return ZCylinderPack<SimdFloatN>(cylinders, shapeIndex); };
+	auto const LOAD_DISCS = [](RaycastDiscSet const& discs, int shapeIndex) { return DiscPack<SimdFloatN>(discs, shapeIndex); };
+}
+
+//-----------------------------------------------------------------------------------------------
+void RaycastBatch3D::AddRay(Vec3 const& rayStart, Vec3 const& rayForward, float maxDistance)
+{
+	m_startX.push_back(rayStart.x);
+	m_startY.push_back(rayStart.y);
+	m_startZ.push_back(rayStart.z);
+	m_forwardX.push_back(rayForward.x);
+	m_forwardY.push_back(rayForward.y);
+	m_forwardZ.push_back(rayForward.z);
+	m_maxDistance.push_back(maxDistance);
+}
+
+void RaycastBatch3D::Reserve(int rayCount)
+{
+	m_startX.reserve(rayCount);
+	m_startY.reserve(rayCount);
+	m_startZ.reserve(rayCount);
+	m_forwardX.reserve(rayCount);
+	m_forwardY.reserve(rayCount);
+	m_forwardZ.reserve(rayCount);
+	m_maxDistance.reserve(rayCount);
+}
+
+void RaycastBatch3D::Clear()
+{
+	m_startX.clear();
+	m_startY.clear();
+	m_startZ.clear();
+	m_forwardX.clear();
+	m_forwardY.clear();
+	m_forwardZ.clear();
+	m_maxDistance.clear();
+}
+
+void RaycastBatch2D::AddRay(Vec2 const& rayStart, Vec2 const& rayForward, float maxDistance)
+{
+	m_startX.push_back(rayStart.x);
+	m_startY.push_back(rayStart.y);
+	m_forwardX.push_back(rayForward.x);
+	m_forwardY.push_back(rayForward.y);
+	m_maxDistance.push_back(maxDistance);
+}
+
+void RaycastBatch2D::Reserve(int rayCount)
+{
+	m_startX.reserve(rayCount);
+	m_startY.reserve(rayCount);
+	m_forwardX.reserve(rayCount);
+	m_forwardY.reserve(rayCount);
+	m_maxDistance.reserve(rayCount);
+}
+
+void RaycastBatch2D::Clear()
+{
+	m_startX.clear();
+	m_startY.clear();
+	m_forwardX.clear();
+	m_forwardY.clear();
+	m_maxDistance.clear();
+}
+
+int RaycastSphereSet::AddSphere(Vec3 const& center, float radius)
+{
+	m_centerX.push_back(center.x);
+	m_centerY.push_back(center.y);
+	m_centerZ.push_back(center.z);
+	m_radius.push_back(radius);
+	return GetCount() - 1;
+}
+
+void RaycastSphereSet::Clear()
+{
+	m_centerX.clear();
+	m_centerY.clear();
+	m_centerZ.clear();
+	m_radius.clear();
+}
+
+int RaycastBox3DSet::AddBox(AABB3 const& box)
+{
+	m_minX.push_back(box.m_mins.x);
+	m_minY.push_back(box.m_mins.y);
+	m_minZ.push_back(box.m_mins.z);
+	m_maxX.push_back(box.m_maxs.x);
+	m_maxY.push_back(box.m_maxs.y);
+	m_maxZ.push_back(box.m_maxs.z);
+	return GetCount() - 1;
+}
+
+void RaycastBox3DSet::Clear()
+{
+	m_minX.clear();
+	m_minY.clear();
+	m_minZ.clear();
+	m_maxX.clear();
+	m_maxY.clear();
+	m_maxZ.clear();
+}
+
+int RaycastZCylinderSet::AddZCylinder(Vec3 const& cylinderBase, float cylinderRadius, float cylinderHeight)
+{
+	m_centerX.push_back(cylinderBase.x);
+	m_centerY.push_back(cylinderBase.y);
+	m_minZ.push_back(cylinderBase.z);
+	m_maxZ.push_back(cylinderBase.z + cylinderHeight);
+	m_radius.push_back(cylinderRadius);
+	return GetCount() - 1;
+}
+
+void RaycastZCylinderSet::Clear()
+{
+	m_centerX.clear();
+	m_centerY.clear();
+	m_minZ.clear();
+	m_maxZ.clear();
+	m_radius.clear();
+}
+
+int RaycastDiscSet::AddDisc(Vec2 const& discCenter, float discRadius)
+{
+	m_centerX.push_back(discCenter.x);
+	m_centerY.push_back(discCenter.y);
+	m_radius.push_back(discRadius);
+	return GetCount() - 1;
+}
+
+void RaycastDiscSet::Clear()
+{
+	m_centerX.clear();
+	m_centerY.clear();
+	m_radius.clear();
+}
+
+//-----------------------------------------------------------------------------------------------
+int RaycastBatchVsSphere(RaycastBatch3D const& rays, Vec3 const& sphereCenter, float sphereRadius, std::vector<RaycastBatchHit3D>& outHits, int shapeIndex)
+{
+	return RaysVsShape<3>(rays, SpherePack<SimdFloatN>(sphereCenter, sphereRadius), SPHERE_KERNEL, shapeIndex, outHits);
+}
+
+int RaycastBatchVsBox3D(RaycastBatch3D const& rays, AABB3 const& box, std::vector<RaycastBatchHit3D>& outHits, int shapeIndex)
+{
+	return RaysVsShape<3>(rays, Box3DPack<SimdFloatN>(box), BOX3D_KERNEL, shapeIndex, outHits);
+}
+
+int RaycastBatchVsZCylinder(RaycastBatch3D const& rays, Vec3 const& cylinderBase, float cylinderRadius, float cylinderHeight, std::vector<RaycastBatchHit3D>& outHits, int shapeIndex)
+{
+	return RaysVsShape<3>(rays, ZCylinderPack<SimdFloatN>(cylinderBase, cylinderRadius, cylinderHeight), ZCYLINDER_KERNEL, shapeIndex, outHits);
+}
+
+int RaycastBatchVsDisc(RaycastBatch2D const& rays, Vec2 const& discCenter, float discRadius, std::vector<RaycastBatchHit2D>& outHits, int shapeIndex)
+{
+	return RaysVsShape<2>(rays, DiscPack<SimdFloatN>(discCenter, discRadius), DISC_KERNEL, shapeIndex, outHits);
+}
+
+bool RaycastVsSphereSet(Vec3 const& rayStart, Vec3 const& rayForward, float maxDistance, RaycastSphereSet const& spheres, RaycastBatchHit3D& outNearestHit)
+{
+	outNearestHit = RaycastBatchHit3D();
+	return RayVsShapeSet<3>(BroadcastRay<SimdFloatN>(rayStart, rayForward, maxDistance), spheres, 0, LOAD_SPHERES, SPHERE_KERNEL, outNearestHit);
+}
+
+bool RaycastVsBox3DSet(Vec3 const& rayStart, Vec3 const& rayForward, float maxDistance, RaycastBox3DSet const& boxes, RaycastBatchHit3D& outNearestHit)
+{
+	outNearestHit = RaycastBatchHit3D();
+	return RayVsShapeSet<3>(BroadcastRay<SimdFloatN>(rayStart, rayForward, maxDistance), boxes, 0, LOAD_BOXES, BOX3D_KERNEL, outNearestHit);
+}
+
+bool RaycastVsZCylinderSet(Vec3 const& rayStart, Vec3 const& rayForward, float maxDistance, RaycastZCylinderSet const& cylinders, RaycastBatchHit3D& outNearestHit)
+{
+	outNearestHit = RaycastBatchHit3D();
+	return RayVsShapeSet<3>(BroadcastRay<SimdFloatN>(rayStart, rayForward, maxDistance), cylinders, 0, LOAD_ZCYLINDERS, ZCYLINDER_KERNEL, outNearestHit);
+}
+
+bool RaycastVsDiscSet(Vec2 const& rayStart, Vec2 const& rayForward, float maxDistance, RaycastDiscSet const& discs, RaycastBatchHit2D& outNearestHit)
+{
+	outNearestHit = RaycastBatchHit2D();
+	return RayVsShapeSet<2>(BroadcastRay<SimdFloatN>(rayStart, rayForward, maxDistance), discs, 0, LOAD_DISCS, DISC_KERNEL, outNearestHit);
+}
+
+void RaycastBatchVsSphereSet(RaycastBatch3D const& rays, RaycastSphereSet const& spheres, std::vector<RaycastBatchHit3D>& outNearestHits)
+{
+	RaysVsShapeSet<3>(rays, spheres, LOAD_SPHERES, SPHERE_KERNEL, outNearestHits);
+}
+
+void RaycastBatchVsBox3DSet(RaycastBatch3D const& rays, RaycastBox3DSet const& boxes, std::vector<RaycastBatchHit3D>& outNearestHits)
+{
+	RaysVsShapeSet<3>(rays, boxes, LOAD_BOXES, BOX3D_KERNEL, outNearestHits);
+}
+
+void RaycastBatchVsZCylinderSet(RaycastBatch3D const& rays, RaycastZCylinderSet const& cylinders, std::vector<RaycastBatchHit3D>& outNearestHits)
+{
+	RaysVsShapeSet<3>(rays, cylinders, LOAD_ZCYLINDERS, ZCYLINDER_KERNEL, outNearestHits);
+}
+
+void RaycastBatchVsDiscSet(RaycastBatch2D const& rays, RaycastDiscSet const& discs, std::vector<RaycastBatchHit2D>& outNearestHits)
+{
+	RaysVsShapeSet<2>(rays, discs, LOAD_DISCS, DISC_KERNEL, outNearestHits);
+}
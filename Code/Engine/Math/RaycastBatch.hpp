@@ -0,0 +1,126 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include <vector>
+
+struct AABB3;
+
+constexpr int RAYCAST_BATCH_MIN_RAYS_PER_JOB = 256;
+
+/// <summary>
+/// Structure of arrays ray set, so SIMD lanes load consecutive rays. Forward vectors are expected normalized,
+/// same as the single raycast functions in RaycastUtils
+/// </summary>
+struct RaycastBatch3D {
+	std::vector<float> m_startX;
+	std::vector<float> m_startY;
+	std::vector<float> m_startZ;
+	std::vector<float> m_forwardX;
+	std::vector<float> m_forwardY;
+	std::vector<float> m_forwardZ;
+	std::vector<float> m_maxDistance;
+
+	void AddRay(Vec3 const& rayStart, Vec3 const& rayForward, float maxDistance);
+	void Reserve(int rayCount);
+	void Clear();
+	int GetCount() const { return (int)m_startX.size(); }
+	Vec3 GetRayStart(int rayIndex) const { return Vec3(m_startX[rayIndex], m_startY[rayIndex], m_startZ[rayIndex]); }
+	Vec3 GetRayForward(int rayIndex) const { return Vec3(m_forwardX[rayIndex], m_forwardY[rayIndex], m_forwardZ[rayIndex]); }
+};
+
+struct RaycastBatch2D {
+	std::vector<float> m_startX;
+	std::vector<float> m_startY;
+	std::vector<float> m_forwardX;
+	std::vector<float> m_forwardY;
+	std::vector<float> m_maxDistance;
+
+	void AddRay(Vec2 const& rayStart, Vec2 const& rayForward, float maxDistance);
+	void Reserve(int rayCount);
+	void Clear();
+	int GetCount() const { return (int)m_startX.size(); }
+	Vec2 GetRayStart(int rayIndex) const { return Vec2(m_startX[rayIndex], m_startY[rayIndex]); }
+	Vec2 GetRayForward(int rayIndex) const { return Vec2(m_forwardX[rayIndex], m_forwardY[rayIndex]); }
+};
+
+// Compact hit records, the impact position is rayStart + rayForward * m_impactDist.
+// Rays starting inside a shape hit at distance 0 with the normal facing back along the ray
+struct RaycastBatchHit3D {
+	Vec3 m_impactNormal = Vec3::ZERO;
+	float m_impactDist = 0.0f;
+	int m_rayIndex = -1;
+	int m_shapeIndex = -1; // -1 in nearest hit outputs means the ray hit nothing
+};
+
+struct RaycastBatchHit2D {
+	Vec2 m_impactNormal = Vec2::ZERO;
+	float m_impactDist = 0.0f;
+	int m_rayIndex = -1;
+	int m_shapeIndex = -1;
+};
+
+// Shape sets, also structure of arrays. The index a shape is added at is the m_shapeIndex reported on hits
+struct RaycastSphereSet {
+	std::vector<float> m_centerX;
+	std::vector<float> m_centerY;
+	std::vector<float> m_centerZ;
+	std::vector<float> m_radius;
+
+	int AddSphere(Vec3 const& center, float radius);
+	void Clear();
+	int GetCount() const { return (int)m_centerX.size(); }
+};
+
+struct RaycastBox3DSet {
+	std::vector<float> m_minX;
+	std::vector<float> m_minY;
+	std::vector<float> m_minZ;
+	std::vector<float> m_maxX;
+	std::vector<float> m_maxY;
+	std::vector<float> m_maxZ;
+
+	int AddBox(AABB3 const& box);
+	void Clear();
+	int GetCount() const { return (int)m_minX.size(); }
+};
+
+struct RaycastZCylinderSet {
+	std::vector<float> m_centerX;
+	std::vector<float> m_centerY;
+	std::vector<float> m_minZ;
+	std::vector<float> m_maxZ;
+	std::vector<float> m_radius;
+
+	int AddZCylinder(Vec3 const& cylinderBase, float cylinderRadius, float cylinderHeight);
+	void Clear();
+	int GetCount() const { return (int)m_centerX.size(); }
+};
+
+struct RaycastDiscSet {
+	std::vector<float> m_centerX;
+	std::vector<float> m_centerY;
+	std::vector<float> m_radius;
+
+	int AddDisc(Vec2 const& discCenter, float discRadius);
+	void Clear();
+	int GetCount() const { return (int)m_centerX.size(); }
+};
+
+// Many rays vs one shape, SIMD_WIDTH rays per step. Appends one hit per ray that impacts, returns how many were appended
+int RaycastBatchVsSphere(RaycastBatch3D const& rays, Vec3 const& sphereCenter, float sphereRadius, std::vector<RaycastBatchHit3D>& outHits, int shapeIndex = 0);
+int RaycastBatchVsBox3D(RaycastBatch3D const& rays, AABB3 const& box, std::vector<RaycastBatchHit3D>& outHits, int shapeIndex = 0);
+int RaycastBatchVsZCylinder(RaycastBatch3D const& rays, Vec3 const& cylinderBase, float cylinderRadius, float cylinderHeight, std::vector<RaycastBatchHit3D>& outHits, int shapeIndex = 0);
+int RaycastBatchVsDisc(RaycastBatch2D const& rays, Vec2 const& discCenter, float discRadius, std::vector<RaycastBatchHit2D>& outHits, int shapeIndex = 0);
+
+// One ray vs many shapes, SIMD_WIDTH shapes per step. Only the nearest hit is kept
+bool RaycastVsSphereSet(Vec3 const& rayStart, Vec3 const& rayForward, float maxDistance, RaycastSphereSet const& spheres, RaycastBatchHit3D& outNearestHit);
+bool RaycastVsBox3DSet(Vec3 const& rayStart, Vec3 const& rayForward, float maxDistance, RaycastBox3DSet const& boxes, RaycastBatchHit3D& outNearestHit);
+bool RaycastVsZCylinderSet(Vec3 const& rayStart, Vec3 const& rayForward, float maxDistance, RaycastZCylinderSet const& cylinders, RaycastBatchHit3D& outNearestHit);
+bool RaycastVsDiscSet(Vec2 const& rayStart, Vec2 const& rayForward, float maxDistance, RaycastDiscSet const& discs, RaycastBatchHit2D& outNearestHit);
+
+// Every ray vs every shape, nearest hit per ray. outNearestHits is resized to the ray count and indexed by ray.
+// Batches bigger than RAYCAST_BATCH_MIN_RAYS_PER_JOB are split across the JobSystem
+void RaycastBatchVsSphereSet(RaycastBatch3D const& rays, RaycastSphereSet const& spheres, std::vector<RaycastBatchHit3D>& outNearestHits);
+void RaycastBatchVsBox3DSet(RaycastBatch3D const& rays, RaycastBox3DSet const& boxes, std::vector<RaycastBatchHit3D>& outNearestHits);
+void RaycastBatchVsZCylinderSet(RaycastBatch3D const& rays, RaycastZCylinderSet const& cylinders, std::vector<RaycastBatchHit3D>& outNearestHits);
+void RaycastBatchVsDiscSet(RaycastBatch2D const& rays, RaycastDiscSet const& discs, std::vector<RaycastBatchHit2D>& outNearestHits);
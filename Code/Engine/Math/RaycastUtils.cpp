@@ -361,8 +361,6 @@ RaycastResult2D RaycastVsConvexHull2D(Vec2 const& rayStart, Vec2 const& rayForwa
 	defaultResult.m_forwardNormal = rayForward;
 	defaultResult.m_maxDistance = maxDistance;
 
-	std::vector<RaycastResult2D> hitPlanesResults;
-
 	bool isRayStartInside = IsPointInsideConvexHull2D(rayStart, convexPolyAsHull, tolerance);
 	if (isRayStartInside) {
 		defaultResult.m_didImpact = true;
@@ -372,26 +370,47 @@ RaycastResult2D RaycastVsConvexHull2D(Vec2 const& rayStart, Vec2 const& rayForwa
 
 		return defaultResult;
 	}
-	float maxHitDistance = FLT_MIN;
-	RaycastResult2D lastexit;
+
+	// Clip the ray against every plane: planes it enters push the entry distance forward, planes it leaves pull the exit back
+	float entryDist = 0.0f;
+	float exitDist = FLT_MAX;
+	Plane2D const* entryPlane = nullptr;
 
 	for (Plane2D const& plane : convexPolyAsHull.m_planes) {
-		if(DotProduct2D(plane.m_planeNormal, rayForward) > 0) continue;
-		RaycastResult2D raycastVsPlane = RaycastVsPlane(rayStart, rayForward, maxDistance, plane);
-		if (raycastVsPlane.m_didImpact) {
-			if (raycastVsPlane.m_impactDist > maxHitDistance) {
-				lastexit = raycastVsPlane;
-				maxHitDistance = raycastVsPlane.m_impactDist;
+		float startAltitude = DotProduct2D(rayStart, plane.m_planeNormal) - plane.m_distToPlane;
+		float forwardInPlaneDir = DotProduct2D(rayForward, plane.m_planeNormal);
+
+		if (forwardInPlaneDir == 0.0f) {
+			if (startAltitude > tolerance) return defaultResult; // Parallel and outside
+			continue;
+		}
+
+		float planeDist = -startAltitude / forwardInPlaneDir;
+		if (forwardInPlaneDir < 0.0f) {
+			if (planeDist > entryDist) {
+				entryDist = planeDist;
+				entryPlane = &plane;
 			}
 		}
+		else if (planeDist < exitDist) {
+			exitDist = planeDist;
+		}
 	}
 
-	if (IsPointInsideConvexHull2D(lastexit.m_impactPos, convexPolyAsHull, tolerance)) {
-		return lastexit;
-	}
+	if (!entryPlane || (entryDist > maxDistance)) return defaultResult;
 
+	// Grazing rays clip to an empty range by a hair, those still hit when the entry point is within tolerance
+	Vec2 impactPos = rayStart + rayForward * entryDist;
+	if ((entryDist > exitDist) && !IsPointInsideConvexHull2D(impactPos, convexPolyAsHull, tolerance)) return defaultResult;
 
-	return defaultResult;
+	RaycastResult2D raycastResult = defaultResult;
+	raycastResult.m_didImpact = true;
+	raycastResult.m_impactDist = entryDist;
+	raycastResult.m_impactPos = impactPos;
+	raycastResult.m_impactNormal = entryPlane->m_planeNormal;
+	raycastResult.m_impactFraction = entryDist / maxDistance;
+
+	return raycastResult;
 }
 
 
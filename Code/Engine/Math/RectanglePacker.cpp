@@ -0,0 +1,125 @@
+#include "Engine/Math/RectanglePacker.hpp"
+#include <climits>
+
+namespace {
+	bool DoRectsOverlap(PackedRect const& rectA, PackedRect const& rectB)
+	{
+		return (rectA.m_mins.x < rectB.m_mins.x + rectB.m_size.x) && (rectB.m_mins.x < rectA.m_mins.x + rectA.m_size.x)
+			&& (rectA.m_mins.y < rectB.m_mins.y + rectB.m_size.y) && (rectB.m_mins.y < rectA.m_mins.y + rectA.m_size.y);
+	}
+
+	bool IsRectInside(PackedRect const& inner, PackedRect const& outer)
+	{
+		return (inner.m_mins.x >= outer.m_mins.x) && (inner.m_mins.y >= outer.m_mins.y)
+			&& (inner.m_mins.x + inner.m_size.x <= outer.m_mins.x + outer.m_size.x) && (inner.m_mins.y + inner.m_size.y <= outer.m_mins.y + outer.m_size.y);
+	}
+}
+
+RectanglePacker::RectanglePacker(IntVec2 const& binSize)
+{
+	Reset(binSize);
+}
+
+void RectanglePacker::Reset(IntVec2 const& binSize)
+{
+	m_binSize = binSize;
+	m_usedArea = 0;
+	m_freeRects.clear();
+	if ((binSize.x > 0) && (binSize.y > 0)) {
+		m_freeRects.push_back(PackedRect{ IntVec2::ZERO, binSize });
+	}
+}
+
+bool RectanglePacker::Insert(IntVec2 const& size, IntVec2& outMins)
+{
+	if ((size.x <= 0) || (size.y <= 0)) return false;
+
+	int bestFreeRect = -1;
+	int bestShortSide = INT_MAX;
+	int bestLongSide = INT_MAX;
+	for (int freeIndex = 0; freeIndex < (int)m_freeRects.size(); freeIndex++) {
+		PackedRect const& freeRect = m_freeRects[freeIndex];
+		if ((freeRect.m_size.x < size.x) || (freeRect.m_size.y < size.y)) continue;
+
+		int leftoverX = freeRect.m_size.x - size.x;
+		int leftoverY = freeRect.m_size.y - size.y;
+		int shortSide = (leftoverX < leftoverY) ? leftoverX : leftoverY;
+		int longSide = (leftoverX < leftoverY) ? leftoverY : leftoverX;
+		if ((shortSide < bestShortSide) || ((shortSide == bestShortSide) && (longSide < bestLongSide))) {
+			bestFreeRect = freeIndex;
+			bestShortSide = shortSide;
+			bestLongSide = longSide;
+		}
+	}
+	if (bestFreeRect < 0) return false;
+
+	PackedRect usedRect{ m_freeRects[bestFreeRect].m_mins, size };
+	SplitFreeRects(usedRect);
+
+	m_usedArea += (long long)size.x * size.y;
+	outMins = usedRect.m_mins;
+	return true;
+}
+
+float RectanglePacker::GetOccupancy() const
+{
+	long long binArea = (long long)m_binSize.x * m_binSize.y;
+	return (binArea > 0) ? (float)m_usedArea / (float)binArea : 0.0f;
+}
+
+// Every free rectangle the used one overlaps is replaced by the up to 4 maximal strips around it. Untouched free rectangles
+// already contain none of each other, and can't be inside a new strip since the strip is inside the rectangle it came from,
+// so only the new strips need pruning
+void RectanglePacker::SplitFreeRects(PackedRect const& usedRect)
+{
+	m_splitRects.clear();
+	int untouchedCount = 0;
+	int usedMaxX = usedRect.m_mins.x + usedRect.m_size.x;
+	int usedMaxY = usedRect.m_mins.y + usedRect.m_size.y;
+	for (int freeIndex = 0; freeIndex < (int)m_freeRects.size(); freeIndex++) {
+		PackedRect const& freeRect = m_freeRects[freeIndex];
+		if (!DoRectsOverlap(freeRect, usedRect)) {
+			m_freeRects[untouchedCount++] = freeRect;
+			continue;
+		}
+
+		int freeMaxX = freeRect.m_mins.x + freeRect.m_size.x;
+		int freeMaxY = freeRect.m_mins.y + freeRect.m_size.y;
+		if (usedRect.m_mins.x > freeRect.m_mins.x) {
+			m_splitRects.push_back(PackedRect{ freeRect.m_mins, IntVec2(usedRect.m_mins.x - freeRect.m_mins.x, freeRect.m_size.y) });
+		}
+		if (usedMaxX < freeMaxX) {
+			m_splitRects.push_back(PackedRect{ IntVec2(usedMaxX, freeRect.m_mins.y), IntVec2(freeMaxX - usedMaxX, freeRect.m_size.y) });
+		}
+		if (usedRect.m_mins.y > freeRect.m_mins.y) {
+			m_splitRects.push_back(PackedRect{ freeRect.m_mins, IntVec2(freeRect.m_size.x, usedRect.m_mins.y - freeRect.m_mins.y) });
+		}
+		if (usedMaxY < freeMaxY) {
+			m_splitRects.push_back(PackedRect{ IntVec2(freeRect.m_mins.x, usedMaxY), IntVec2(freeRect.m_size.x, freeMaxY - usedMaxY) });
+		}
+	}
+	m_freeRects.resize(untouchedCount);
+	PruneSplitRects();
+}
+
+void RectanglePacker::PruneSplitRects()
+{
+	int untouchedCount = (int)m_freeRects.size();
+	for (int splitIndex = 0; splitIndex < (int)m_splitRects.size(); splitIndex++) {
+		PackedRect const& splitRect = m_splitRects[splitIndex];
+		bool isContained = false;
+		for (int freeIndex = 0; (freeIndex < untouchedCount) && !isContained; freeIndex++) {
+			isContained = IsRectInside(splitRect, m_freeRects[freeIndex]);
+		}
+		// Among the strips, equal ones are kept once: only the first copy survives
+		for (int otherIndex = 0; (otherIndex < (int)m_splitRects.size()) && !isContained; otherIndex++) {
+			if (otherIndex == splitIndex) continue;
+			PackedRect const& otherRect = m_splitRects[otherIndex];
+			bool isEqual = (otherRect.m_mins == splitRect.m_mins) && (otherRect.m_size == splitRect.m_size);
+			isContained = isEqual ? (otherIndex < splitIndex) : IsRectInside(splitRect, otherRect);
+		}
+		if (!isContained) {
+			m_freeRects.push_back(splitRect);
+		}
+	}
+}
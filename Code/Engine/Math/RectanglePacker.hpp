@@ -0,0 +1,36 @@
+#pragma once
+#include "Engine/Math/IntVec2.hpp"
+#include <vector>
+
+struct PackedRect {
+	IntVec2 m_mins = IntVec2::ZERO;
+	IntVec2 m_size = IntVec2::ZERO;
+};
+
+/// <summary>
+/// MaxRects bin packer. Keeps every maximal free rectangle left in the bin (they overlap), puts each new rectangle in the
+/// free one it fits tightest by its shorter leftover side, then splits the free rectangles it touches and drops the ones
+/// another contains. Rectangles are never rotated, so texel content can be copied in as is
+/// </summary>
+class RectanglePacker {
+public:
+	RectanglePacker() = default;
+	explicit RectanglePacker(IntVec2 const& binSize);
+
+	void Reset(IntVec2 const& binSize);
+	// False, and nothing changes, when there is no room left for the size
+	bool Insert(IntVec2 const& size, IntVec2& outMins);
+
+	IntVec2 GetBinSize() const { return m_binSize; }
+	float GetOccupancy() const; // Used area over bin area
+
+private:
+	void SplitFreeRects(PackedRect const& usedRect);
+	void PruneSplitRects();
+
+private:
+	IntVec2 m_binSize = IntVec2::ZERO;
+	long long m_usedArea = 0;
+	std::vector<PackedRect> m_freeRects;
+	std::vector<PackedRect> m_splitRects; // New strips of the last split, keeps its memory
+};
@@ -0,0 +1,83 @@
+#pragma once
+#include <immintrin.h>
+
+// x64 always has SSE2, so SimdFloat4 is the baseline. Building with /arch:AVX (or AVX2) also enables the 8 wide pack
+// and makes it the default SimdFloatN. Masks are floats with all bits set per true lane, as the compare intrinsics return them
+#if defined(__AVX__)
+#define ENGINE_SIMD_AVX
+#endif
+
+struct SimdFloat4 {
+	static constexpr int LANES = 4;
+	__m128 m_value;
+
+	SimdFloat4() = default;
+	SimdFloat4(__m128 value) : m_value(value) {}
+
+	static SimdFloat4 Broadcast(float value) { return _mm_set1_ps(value); }
+	static SimdFloat4 Load(float const* values) { return _mm_loadu_ps(values); }
+	static SimdFloat4 Zero() { return _mm_setzero_ps(); }
+	static SimdFloat4 AllBits() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+	void Store(float* outValues) const { _mm_storeu_ps(outValues, m_value); }
+};
+
+inline SimdFloat4 operator+(SimdFloat4 a, SimdFloat4 b) { return _mm_add_ps(a.m_value, b.m_value); }
+inline SimdFloat4 operator-(SimdFloat4 a, SimdFloat4 b) { return _mm_sub_ps(a.m_value, b.m_value); }
+inline SimdFloat4 operator*(SimdFloat4 a, SimdFloat4 b) { return _mm_mul_ps(a.m_value, b.m_value); }
+inline SimdFloat4 operator/(SimdFloat4 a, SimdFloat4 b) { return _mm_div_ps(a.m_value, b.m_value); }
+inline SimdFloat4 operator-(SimdFloat4 a) { return _mm_xor_ps(a.m_value, _mm_set1_ps(-0.0f)); }
+inline SimdFloat4 operator<(SimdFloat4 a, SimdFloat4 b) { return _mm_cmplt_ps(a.m_value, b.m_value); }
+inline SimdFloat4 operator<=(SimdFloat4 a, SimdFloat4 b) { return _mm_cmple_ps(a.m_value, b.m_value); }
+inline SimdFloat4 operator>(SimdFloat4 a, SimdFloat4 b) { return _mm_cmpgt_ps(a.m_value, b.m_value); }
+inline SimdFloat4 operator>=(SimdFloat4 a, SimdFloat4 b) { return _mm_cmpge_ps(a.m_value, b.m_value); }
+inline SimdFloat4 operator&(SimdFloat4 a, SimdFloat4 b) { return _mm_and_ps(a.m_value, b.m_value); }
+inline SimdFloat4 operator|(SimdFloat4 a, SimdFloat4 b) { return _mm_or_ps(a.m_value, b.m_value); }
+inline SimdFloat4 AndNot(SimdFloat4 mask, SimdFloat4 a) { return _mm_andnot_ps(mask.m_value, a.m_value); } // a & ~mask
+inline SimdFloat4 SimdMin(SimdFloat4 a, SimdFloat4 b) { return _mm_min_ps(a.m_value, b.m_value); }
+inline SimdFloat4 SimdMax(SimdFloat4 a, SimdFloat4 b) { return _mm_max_ps(a.m_value, b.m_value); }
+inline SimdFloat4 SimdSqrt(SimdFloat4 a) { return _mm_sqrt_ps(a.m_value); }
+inline SimdFloat4 SimdAbs(SimdFloat4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.m_value); }
+// SSE2 has no blend, done with bit ops so it runs on any x64 CPU
+inline SimdFloat4 SimdSelect(SimdFloat4 mask, SimdFloat4 ifTrue, SimdFloat4 ifFalse) { return _mm_or_ps(_mm_and_ps(mask.m_value, ifTrue.m_value), _mm_andnot_ps(mask.m_value, ifFalse.m_value)); }
+inline int GetMaskBits(SimdFloat4 mask) { return _mm_movemask_ps(mask.m_value); }
+
+#if defined(ENGINE_SIMD_AVX)
+struct SimdFloat8 {
+	static constexpr int LANES = 8;
+	__m256 m_value;
+
+	SimdFloat8() = default;
+	SimdFloat8(__m256 value) : m_value(value) {}
+
+	static SimdFloat8 Broadcast(float value) { return _mm256_set1_ps(value); }
+	static SimdFloat8 Load(float const* values) { return _mm256_loadu_ps(values); }
+	static SimdFloat8 Zero() { return _mm256_setzero_ps(); }
+	static SimdFloat8 AllBits() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+	void Store(float* outValues) const { _mm256_storeu_ps(outValues, m_value); }
+};
+
+inline SimdFloat8 operator+(SimdFloat8 a, SimdFloat8 b) { return _mm256_add_ps(a.m_value, b.m_value); }
+inline SimdFloat8 operator-(SimdFloat8 a, SimdFloat8 b) { return _mm256_sub_ps(a.m_value, b.m_value); }
+inline SimdFloat8 operator*(SimdFloat8 a, SimdFloat8 b) { return _mm256_mul_ps(a.m_value, b.m_value); }
+inline SimdFloat8 operator/(SimdFloat8 a, SimdFloat8 b) { return _mm256_div_ps(a.m_value, b.m_value); }
+inline SimdFloat8 operator-(SimdFloat8 a) { return _mm256_xor_ps(a.m_value, _mm256_set1_ps(-0.0f)); }
+inline SimdFloat8 operator<(SimdFloat8 a, SimdFloat8 b) { return _mm256_cmp_ps(a.m_value, b.m_value, _CMP_LT_OQ); }
+inline SimdFloat8 operator<=(SimdFloat8 a, SimdFloat8 b) { return _mm256_cmp_ps(a.m_value, b.m_value, _CMP_LE_OQ); }
+inline SimdFloat8 operator>(SimdFloat8 a, SimdFloat8 b) { return _mm256_cmp_ps(a.m_value, b.m_value, _CMP_GT_OQ); }
+inline SimdFloat8 operator>=(SimdFloat8 a, SimdFloat8 b) { return _mm256_cmp_ps(a.m_value, b.m_value, _CMP_GE_OQ); }
+inline SimdFloat8 operator&(SimdFloat8 a, SimdFloat8 b) { return _mm256_and_ps(a.m_value, b.m_value); }
+inline SimdFloat8 operator|(SimdFloat8 a, SimdFloat8 b) { return _mm256_or_ps(a.m_value, b.m_value); }
+inline SimdFloat8 AndNot(SimdFloat8 mask, SimdFloat8 a) { return _mm256_andnot_ps(mask.m_value, a.m_value); }
+inline SimdFloat8 SimdMin(SimdFloat8 a, SimdFloat8 b) { return _mm256_min_ps(a.m_value, b.m_value); }
+inline SimdFloat8 SimdMax(SimdFloat8 a, SimdFloat8 b) { return _mm256_max_ps(a.m_value, b.m_value); }
+inline SimdFloat8 SimdSqrt(SimdFloat8 a) { return _mm256_sqrt_ps(a.m_value); }
+inline SimdFloat8 SimdAbs(SimdFloat8 a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.m_value); }
+inline SimdFloat8 SimdSelect(SimdFloat8 mask, SimdFloat8 ifTrue, SimdFloat8 ifFalse) { return _mm256_blendv_ps(ifFalse.m_value, ifTrue.m_value, mask.m_value); }
+inline int GetMaskBits(SimdFloat8 mask) { return _mm256_movemask_ps(mask.m_value); }
+
+using SimdFloatN = SimdFloat8;
+#else
+using SimdFloatN = SimdFloat4;
+#endif
+
+constexpr int SIMD_WIDTH = SimdFloatN::LANES;
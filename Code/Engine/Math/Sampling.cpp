@@ -1,12 +1,44 @@
 #include "Engine/Math/Sampling.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/JobSystem.hpp"
 #include "Engine/Math/MathUtils.hpp"
-#include "Engine/Math/RandomNumberGenerator.hpp"
+
+namespace {
+	// Rejection sampling in the unit square and cube, cheaper than the sines and cosines of random angles
+	Vec2 GetRandomDirection2D(RandomNumberGenerator& rng)
+	{
+		for (;;) {
+			Vec2 point(rng.GetRandomFloatInRange(-1.0f, 1.0f), rng.GetRandomFloatInRange(-1.0f, 1.0f));
+			float lengthSquared = (point.x * point.x) + (point.y * point.y);
+			if ((lengthSquared > 0.0001f) && (lengthSquared <= 1.0f)) return point * (1.0f / sqrtf(lengthSquared));
+		}
+	}
+
+	Vec3 GetRandomDirection3D(RandomNumberGenerator& rng)
+	{
+		for (;;) {
+			Vec3 point(rng.GetRandomFloatInRange(-1.0f, 1.0f), rng.GetRandomFloatInRange(-1.0f, 1.0f), rng.GetRandomFloatInRange(-1.0f, 1.0f));
+			float lengthSquared = (point.x * point.x) + (point.y * point.y) + (point.z * point.z);
+			if ((lengthSquared > 0.0001f) && (lengthSquared <= 1.0f)) return point * (1.0f / sqrtf(lengthSquared));
+		}
+	}
+}
 
 PoissonDisc2D::PoissonDisc2D(Vec2 const& spaceSize, float radius) :
+	PoissonDisc2D(spaceSize, radius, radius, nullptr)
+{
+}
+
+PoissonDisc2D::PoissonDisc2D(Vec2 const& spaceSize, float minRadius, float maxRadius, PoissonDiscRadiusFunction const& radiusFunction) :
 	m_spaceSize(spaceSize),
-	m_radius(radius)
+	m_radius(minRadius),
+	m_maxRadius((maxRadius > minRadius) ? maxRadius : minRadius),
+	m_radiusFunction(radiusFunction)
 {
-	m_cellSize = radius / sqrtf(2.0f);
+	// A cell's diagonal is the smallest radius, so no two points share a cell
+	m_cellSize = m_radius / sqrtf(2.0f);
+	m_neighborCellRange = (int)ceilf(m_maxRadius / m_cellSize);
+
 	int gridWidth = int(ceilf(spaceSize.x / m_cellSize)) + 1;
 	int gridHeight = int(ceilf(spaceSize.y / m_cellSize)) + 1;
 
@@ -15,84 +47,203 @@ PoissonDisc2D::PoissonDisc2D(Vec2 const& spaceSize, float radius) :
 
 void PoissonDisc2D::GetSamplingPoints(std::vector<Vec2>& samplePoints, int triesFindingSample /*= 32*/)
 {
-	int totalCells = m_gridSize.x * m_gridSize.y;
+	// One tile covering the whole grid is plain Bridson
+	SetupTiles((m_gridSize.x > m_gridSize.y) ? m_gridSize.x : m_gridSize.y);
+	SampleTile(0, m_rng, triesFindingSample);
+	CollectSamplingPoints(samplePoints);
+}
+
+void PoissonDisc2D::GetSamplingPointsTiled(std::vector<Vec2>& samplePoints, float tileSize /*= 0.0f*/, int triesFindingSample /*= 32*/)
+{
+	// Tiles must be wider than the cells a tile reads past its border, so tiles sampled in the same pass never read each other
+	int borderCells = (int)ceilf((2.0f * m_maxRadius) / m_cellSize) + 1;
+	int minTileCells = ((borderCells > m_neighborCellRange) ? borderCells : m_neighborCellRange) + 1;
+	int tileCellCount = (tileSize > 0.0f) ? (int)ceilf(tileSize / m_cellSize) : POISSON_DISC_DEFAULT_TILE_CELLS;
+	SetupTiles((tileCellCount > minTileCells) ? tileCellCount : minTileCells);
+
+	// Streams are handed out in tile order before any tile runs, so the result does not depend on scheduling
+	int tileCount = (int)m_tiles.size();
+	std::vector<RandomNumberGenerator> tileRngs;
+	tileRngs.reserve(tileCount);
+	for (int tileIndex = 0; tileIndex < tileCount; tileIndex++) {
+		tileRngs.push_back(m_rng.Split());
+	}
 
-	samplePoints.reserve(totalCells);
+	// Tiles of the same pass have a tile of another pass between them in x and in y
+	std::vector<int> passTiles;
+	passTiles.reserve(tileCount);
+	for (int passIndex = 0; passIndex < 4; passIndex++) {
+		passTiles.clear();
+		for (int tileY = (passIndex >> 1); tileY < m_tileCounts.y; tileY += 2) {
+			for (int tileX = (passIndex & 1); tileX < m_tileCounts.x; tileX += 2) {
+				passTiles.push_back((tileY * m_tileCounts.x) + tileX);
+			}
+		}
+
+		auto sampleTiles = [&](int beginIndex, int endIndex) {
+			for (int passTileIndex = beginIndex; passTileIndex < endIndex; passTileIndex++) {
+				int tileIndex = passTiles[passTileIndex];
+				SampleTile(tileIndex, tileRngs[tileIndex], triesFindingSample);
+			}
+		};
+
+		if (g_theJobSystem) {
+			g_theJobSystem->ParallelFor((int)passTiles.size(), 1, sampleTiles);
+		}
+		else {
+			sampleTiles(0, (int)passTiles.size());
+		}
+	}
 
-	m_grid.clear();
-	m_grid.reserve(totalCells);
+	CollectSamplingPoints(samplePoints);
+}
 
-	for (int fillIndex = 0; fillIndex < (totalCells); fillIndex++) {
-		m_grid.push_back(Vec2(-1.0f, -1.0f));
+void PoissonDisc2D::SetupTiles(int tileCellCount)
+{
+	m_tileCellCount = tileCellCount;
+	m_tileCounts = IntVec2((m_gridSize.x + tileCellCount - 1) / tileCellCount, (m_gridSize.y + tileCellCount - 1) / tileCellCount);
+
+	m_tiles.clear();
+	m_tiles.resize((size_t)m_tileCounts.x * m_tileCounts.y);
+	for (int tileY = 0; tileY < m_tileCounts.y; tileY++) {
+		for (int tileX = 0; tileX < m_tileCounts.x; tileX++) {
+			Tile& tile = m_tiles[(tileY * m_tileCounts.x) + tileX];
+			tile.m_minCell = IntVec2(tileX * tileCellCount, tileY * tileCellCount);
+			tile.m_maxCell = IntVec2(tile.m_minCell.x + tileCellCount, tile.m_minCell.y + tileCellCount);
+			if (tile.m_maxCell.x > m_gridSize.x) tile.m_maxCell.x = m_gridSize.x;
+			if (tile.m_maxCell.y > m_gridSize.y) tile.m_maxCell.y = m_gridSize.y;
+		}
 	}
 
-	RandomNumberGenerator randGen;
+	size_t cellCount = (size_t)m_gridSize.x * m_gridSize.y;
+	m_grid.assign(cellCount, -1);
+	m_cellPoints.resize(cellCount);
+	m_cellRadii.resize((m_radiusFunction) ? cellCount : 0);
+}
 
-	float startX = randGen.GetRandomFloatInRange(0.0f, m_spaceSize.x);
-	float startY = randGen.GetRandomFloatInRange(0.0f, m_spaceSize.y);
+void PoissonDisc2D::SampleTile(int tileIndex, RandomNumberGenerator& rng, int triesFindingSample)
+{
+	Tile& tile = m_tiles[tileIndex];
+	std::vector<ActivePoint> activePoints;
+
+	// Points of finished neighbour tiles that could place candidates in this tile start out active. Only candidates inside the
+	// tile are kept, so the neighbours stay untouched
+	int borderCells = (int)ceilf((2.0f * m_maxRadius) / m_cellSize) + 1;
+	int minX = (tile.m_minCell.x - borderCells > 0) ? tile.m_minCell.x - borderCells : 0;
+	int minY = (tile.m_minCell.y - borderCells > 0) ? tile.m_minCell.y - borderCells : 0;
+	int maxX = (tile.m_maxCell.x + borderCells < m_gridSize.x) ? tile.m_maxCell.x + borderCells : m_gridSize.x;
+	int maxY = (tile.m_maxCell.y + borderCells < m_gridSize.y) ? tile.m_maxCell.y + borderCells : m_gridSize.y;
+	for (int y = minY; y < maxY; y++) {
+		for (int x = minX; x < maxX; x++) {
+			bool isInTile = (x >= tile.m_minCell.x) && (x < tile.m_maxCell.x) && (y >= tile.m_minCell.y) && (y < tile.m_maxCell.y);
+			int cellIndex = GetIndexFromCoords(x, y);
+			if (isInTile || (m_grid[cellIndex] < 0)) continue;
+
+			activePoints.push_back(ActivePoint{ m_cellPoints[cellIndex], (m_radiusFunction) ? m_cellRadii[cellIndex] : m_radius });
+		}
+	}
 
-	Vec2 startingPoint = Vec2(startX, startY);
-	InsertPointInGrid(startingPoint);
-	samplePoints.push_back(startingPoint);
+	auto tryAddPoint = [&](Vec2 const& point) {
+		if (IsOutOfSpace(point)) return false;
 
-	std::vector<Vec2> activePoints;
-	activePoints.push_back(startingPoint);
-	float diameter = 2.0f * m_radius;
+		IntVec2 coords = GetGridCoords(point);
+		if ((coords.x < tile.m_minCell.x) || (coords.x >= tile.m_maxCell.x) || (coords.y < tile.m_minCell.y) || (coords.y >= tile.m_maxCell.y)) return false;
 
-	while (activePoints.size() > 0) {
-		int randInd = randGen.GetRandomIntInRange(0, int(activePoints.size() - 1));
-		Vec2 const& point = activePoints[randInd];
+		float pointRadius = GetRadiusAt(point);
+		if (!IsPointValid(point, pointRadius)) return false;
 
-		bool foundCandidate = false;
+		int cellIndex = GetIndexFromCoords(coords.x, coords.y);
+		m_grid[cellIndex] = (int)tile.m_points.size();
+		m_cellPoints[cellIndex] = point;
+		tile.m_points.push_back(point);
+		if (m_radiusFunction) {
+			m_cellRadii[cellIndex] = pointRadius;
+		}
+		activePoints.push_back(ActivePoint{ point, pointRadius });
+		return true;
+	};
 
-		for (int tryInd = 0; (tryInd < triesFindingSample) && !foundCandidate; tryInd++) {
-			float randAngle = randGen.GetRandomFloatZeroUpToOne() * 360.0f;
-			float randRadius = randGen.GetRandomFloatInRange(m_radius, diameter);
+	if (activePoints.empty()) {
+		Vec2 tileMins = Vec2((float)tile.m_minCell.x, (float)tile.m_minCell.y) * m_cellSize;
+		Vec2 tileMaxs = Vec2((float)tile.m_maxCell.x, (float)tile.m_maxCell.y) * m_cellSize;
+		if (tileMaxs.x > m_spaceSize.x) tileMaxs.x = m_spaceSize.x;
+		if (tileMaxs.y > m_spaceSize.y) tileMaxs.y = m_spaceSize.y;
 
-			Vec2 candidatePoint = point + Vec2::MakeFromPolarDegrees(randAngle, randRadius);
-			if (IsPointValid(candidatePoint)) {
-				foundCandidate = true;
-				activePoints.push_back(candidatePoint);
-				InsertPointInGrid(candidatePoint);
-				samplePoints.push_back(candidatePoint);
+		for (int tryInd = 0; tryInd < triesFindingSample; tryInd++) {
+			Vec2 startingPoint(rng.GetRandomFloatInRange(tileMins.x, tileMaxs.x), rng.GetRandomFloatInRange(tileMins.y, tileMaxs.y));
+			if (tryAddPoint(startingPoint)) break;
+		}
+	}
 
-			}
+	while (!activePoints.empty()) {
+		int activeIndex = rng.GetRandomIntLessThan((int)activePoints.size());
+		ActivePoint point = activePoints[activeIndex];
 
+		bool foundCandidate = false;
+		for (int tryInd = 0; (tryInd < triesFindingSample) && !foundCandidate; tryInd++) {
+			float randRadius = rng.GetRandomFloatInRange(point.m_radius, 2.0f * point.m_radius);
+			foundCandidate = tryAddPoint(point.m_position + (GetRandomDirection2D(rng) * randRadius));
 		}
 
+		// Swap with the last, the order of active points does not matter
 		if (!foundCandidate) {
-			activePoints.erase(activePoints.begin() + randInd);
+			activePoints[activeIndex] = activePoints.back();
+			activePoints.pop_back();
 		}
 	}
-
 }
 
-bool PoissonDisc2D::IsPointValid(Vec2 const& point) const
+void PoissonDisc2D::CollectSamplingPoints(std::vector<Vec2>& samplePoints) const
 {
-	// Point is out of bounds
-	if (IsOutOfGrid(point)) return false;
-
-	IntVec2 pointCoords = GetGridCoords(point);
-
-	// Algorithm suggests checking 2Rs away
-	for (int y = pointCoords.y - 2; y < (pointCoords.y + 2); y++) {
-		for (int x = pointCoords.x - 2; x < (pointCoords.x + 2); x++) {
-			if (IsOutOfGrid(x, y)) continue;
+	size_t pointCount = 0;
+	for (Tile const& tile : m_tiles) {
+		pointCount += tile.m_points.size();
+	}
 
-			int gridIndex = GetIndexFromCoords(x, y);
-			Vec2 const& gridPoint = m_grid[gridIndex];
+	samplePoints.clear();
+	samplePoints.reserve(pointCount);
+	for (Tile const& tile : m_tiles) {
+		samplePoints.insert(samplePoints.end(), tile.m_points.begin(), tile.m_points.end());
+	}
+}
 
-			if (gridPoint == Vec2(-1.0f, -1.0f)) continue;
+float PoissonDisc2D::GetRadiusAt(Vec2 const& point) const
+{
+	if (!m_radiusFunction) return m_radius;
 
-			float distToGridPoint = GetDistance2D(gridPoint, point);
+	float radius = m_radiusFunction(point);
+	if (radius < m_radius) return m_radius;
+	if (radius > m_maxRadius) return m_maxRadius;
+	return radius;
+}
 
-			if (distToGridPoint < m_radius) return false;
+bool PoissonDisc2D::IsPointValid(Vec2 const& point, float radius) const
+{
+	IntVec2 pointCoords = GetGridCoords(point);
+	if (m_grid[GetIndexFromCoords(pointCoords.x, pointCoords.y)] >= 0) return false;
+
+	// The largest radius reaches m_neighborCellRange cells away, 2 with a single radius
+	int minX = (pointCoords.x - m_neighborCellRange > 0) ? pointCoords.x - m_neighborCellRange : 0;
+	int minY = (pointCoords.y - m_neighborCellRange > 0) ? pointCoords.y - m_neighborCellRange : 0;
+	int maxX = (pointCoords.x + m_neighborCellRange < m_gridSize.x - 1) ? pointCoords.x + m_neighborCellRange : m_gridSize.x - 1;
+	int maxY = (pointCoords.y + m_neighborCellRange < m_gridSize.y - 1) ? pointCoords.y + m_neighborCellRange : m_gridSize.y - 1;
+	for (int y = minY; y <= maxY; y++) {
+		for (int cellIndex = GetIndexFromCoords(minX, y); cellIndex <= GetIndexFromCoords(maxX, y); cellIndex++) {
+			if (m_grid[cellIndex] < 0) continue;
+
+			float minDistance = radius;
+			if (m_radiusFunction && (m_cellRadii[cellIndex] > minDistance)) {
+				minDistance = m_cellRadii[cellIndex];
+			}
 
+			Vec2 const& cellPoint = m_cellPoints[cellIndex];
+			float distX = cellPoint.x - point.x;
+			float distY = cellPoint.y - point.y;
+			if (((distX * distX) + (distY * distY)) < (minDistance * minDistance)) return false;
 		}
 	}
 
 	return true;
-
 }
 
 IntVec2 PoissonDisc2D::GetGridCoords(Vec2 const& point) const
@@ -101,50 +252,94 @@ IntVec2 PoissonDisc2D::GetGridCoords(Vec2 const& point) const
 	int y = (int)floorf(point.y / m_cellSize);
 
 	return IntVec2(x, y);
-
 }
 
-bool PoissonDisc2D::IsOutOfGrid(Vec2 const& point) const
+bool PoissonDisc2D::IsOutOfSpace(Vec2 const& point) const
 {
-	if ((point.x < 0) || (point.x >= (float)m_spaceSize.x) || (point.y < 0) || (point.y >= (float)m_spaceSize.y))
-		return true;
-
-	return false;
+	return (point.x < 0.0f) || (point.x >= m_spaceSize.x) || (point.y < 0.0f) || (point.y >= m_spaceSize.y);
 }
 
-bool PoissonDisc2D::IsOutOfGrid(IntVec2 const& coords) const
+int PoissonDisc2D::GetIndexFromCoords(int x, int y) const
 {
-	if ((coords.x < 0) || (coords.x >= m_spaceSize.x) || (coords.y < 0) || (coords.y >= m_spaceSize.y))
-		return true;
+	return (y * m_gridSize.x) + x;
+}
+
 
-	return false;
+PoissonDisc3D::PoissonDisc3D(Vec3 const& spaceSize, float radius) :
+	m_spaceSize(spaceSize),
+	m_radius(radius)
+{
+	m_cellSize = radius / sqrtf(3.0f);
+	m_gridSize = IntVec3(int(ceilf(spaceSize.x / m_cellSize)) + 1, int(ceilf(spaceSize.y / m_cellSize)) + 1, int(ceilf(spaceSize.z / m_cellSize)) + 1);
 }
 
-bool PoissonDisc2D::IsOutOfGrid(int x, int y) const
+void PoissonDisc3D::GetSamplingPoints(std::vector<Vec3>& samplePoints, int triesFindingSample /*= 32*/)
 {
-	if ((x < 0) || (x >= m_spaceSize.x) || (y < 0) || (y >= m_spaceSize.y))
+	samplePoints.clear();
+	m_grid.assign((size_t)m_gridSize.x * m_gridSize.y * m_gridSize.z, -1);
+
+	auto tryAddPoint = [&](Vec3 const& point, std::vector<int>& activePoints) {
+		if (IsOutOfSpace(point) || !IsPointValid(point, samplePoints)) return false;
+
+		IntVec3 coords = GetGridCoords(point);
+		m_grid[GetIndexFromCoords(coords.x, coords.y, coords.z)] = (int)samplePoints.size();
+		activePoints.push_back((int)samplePoints.size());
+		samplePoints.push_back(point);
 		return true;
+	};
 
-	return false;
-}
+	std::vector<int> activePoints;
+	for (int tryInd = 0; (tryInd < triesFindingSample) && activePoints.empty(); tryInd++) {
+		Vec3 startingPoint(m_rng.GetRandomFloatInRange(0.0f, m_spaceSize.x), m_rng.GetRandomFloatInRange(0.0f, m_spaceSize.y), m_rng.GetRandomFloatInRange(0.0f, m_spaceSize.z));
+		tryAddPoint(startingPoint, activePoints);
+	}
 
+	while (!activePoints.empty()) {
+		int activeIndex = m_rng.GetRandomIntLessThan((int)activePoints.size());
+		Vec3 point = samplePoints[activePoints[activeIndex]];
 
-int PoissonDisc2D::GetIndexFromCoords(IntVec2 const& coords) const
-{
-	return (coords.y * m_gridSize.x) + coords.x;
-}
+		bool foundCandidate = false;
+		for (int tryInd = 0; (tryInd < triesFindingSample) && !foundCandidate; tryInd++) {
+			float randRadius = m_rng.GetRandomFloatInRange(m_radius, 2.0f * m_radius);
+			foundCandidate = tryAddPoint(point + (GetRandomDirection3D(m_rng) * randRadius), activePoints);
+		}
 
+		if (!foundCandidate) {
+			activePoints[activeIndex] = activePoints.back();
+			activePoints.pop_back();
+		}
+	}
+}
 
-int PoissonDisc2D::GetIndexFromCoords(int x, int y) const
+bool PoissonDisc3D::IsPointValid(Vec3 const& point, std::vector<Vec3> const& samplePoints) const
 {
-	return (y * m_gridSize.x) + x;
+	IntVec3 pointCoords = GetGridCoords(point);
+	if (m_grid[GetIndexFromCoords(pointCoords.x, pointCoords.y, pointCoords.z)] >= 0) return false;
+
+	// The cell diagonal is the radius, so points closer than it sit at most 2 cells away
+	float radiusSquared = m_radius * m_radius;
+	for (int z = pointCoords.z - 2; z <= (pointCoords.z + 2); z++) {
+		if ((z < 0) || (z >= m_gridSize.z)) continue;
+		for (int y = pointCoords.y - 2; y <= (pointCoords.y + 2); y++) {
+			if ((y < 0) || (y >= m_gridSize.y)) continue;
+			for (int x = pointCoords.x - 2; x <= (pointCoords.x + 2); x++) {
+				if ((x < 0) || (x >= m_gridSize.x)) continue;
+
+				int pointIndex = m_grid[GetIndexFromCoords(x, y, z)];
+				if ((pointIndex >= 0) && (GetDistanceSquared3D(samplePoints[pointIndex], point) < radiusSquared)) return false;
+			}
+		}
+	}
+
+	return true;
 }
 
-void PoissonDisc2D::InsertPointInGrid(Vec2 const& point)
+IntVec3 PoissonDisc3D::GetGridCoords(Vec3 const& point) const
 {
-	IntVec2 const& coords = GetGridCoords(point);
-	int index = GetIndexFromCoords(coords);
-
-	m_grid[index] = point;
+	return IntVec3((int)floorf(point.x / m_cellSize), (int)floorf(point.y / m_cellSize), (int)floorf(point.z / m_cellSize));
 }
 
+bool PoissonDisc3D::IsOutOfSpace(Vec3 const& point) const
+{
+	return (point.x < 0.0f) || (point.x >= m_spaceSize.x) || (point.y < 0.0f) || (point.y >= m_spaceSize.y) || (point.z < 0.0f) || (point.z >= m_spaceSize.z);
+}
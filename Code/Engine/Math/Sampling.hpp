@@ -1,27 +1,96 @@
 #pragma once
 #include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.hpp"
 #include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/IntVec3.hpp"
+#include "Engine/Math/RandomNumberGenerator.hpp"
+#include <functional>
 #include <vector>
 
+constexpr int POISSON_DISC_DEFAULT_TRIES = 32;
+constexpr int POISSON_DISC_DEFAULT_TILE_CELLS = 64; // Tile side in grid cells when GetSamplingPointsTiled is given no tile size
 
+// Minimum distance around a point, for density driven sampling. Must stay within the sampler's [minRadius, maxRadius] and be safe
+// to call from several threads at once
+using PoissonDiscRadiusFunction = std::function<float(Vec2 const& point)>;
+
+/// <summary>
+/// Bridson's Poisson disc sampling over [0, spaceSize). Accepted points are tracked in a grid of point indexes with one point
+/// at most per cell. With a radius function, two points keep the larger of their two radii apart
+/// </summary>
 class PoissonDisc2D {
 public:
 	PoissonDisc2D(Vec2 const& spaceSize, float radius);
-	void GetSamplingPoints(std::vector<Vec2>& samplePoints, int triesFindingSample = 32);
+	PoissonDisc2D(Vec2 const& spaceSize, float minRadius, float maxRadius, PoissonDiscRadiusFunction const& radiusFunction);
+
+	void SetSeed(uint64_t seed) { m_rng.SetSeed(seed); }
+
+	void GetSamplingPoints(std::vector<Vec2>& samplePoints, int triesFindingSample = POISSON_DISC_DEFAULT_TRIES);
+	// Splits the space into square tiles and samples them on the JobSystem in four passes, so that tiles sampled at the same time
+	// never touch. A tile grows from the points of finished neighbour tiles near its border, so the tiles join without seams.
+	// Deterministic for a given seed, whatever the number of threads
+	void GetSamplingPointsTiled(std::vector<Vec2>& samplePoints, float tileSize = 0.0f, int triesFindingSample = POISSON_DISC_DEFAULT_TRIES);
+
 private:
-	bool IsPointValid(Vec2 const& point) const;
+	struct ActivePoint {
+		Vec2 m_position;
+		float m_radius = 0.0f;
+	};
+
+	struct Tile {
+		IntVec2 m_minCell = IntVec2::ZERO;
+		IntVec2 m_maxCell = IntVec2::ZERO; // Exclusive
+		std::vector<Vec2> m_points;
+	};
+
+	void SetupTiles(int tileCellCount);
+	void SampleTile(int tileIndex, RandomNumberGenerator& rng, int triesFindingSample);
+	void CollectSamplingPoints(std::vector<Vec2>& samplePoints) const;
+	float GetRadiusAt(Vec2 const& point) const;
+	bool IsPointValid(Vec2 const& point, float radius) const;
 	IntVec2 GetGridCoords(Vec2 const& point) const;
-	bool IsOutOfGrid(Vec2 const& point) const;
-	bool IsOutOfGrid(IntVec2 const& point) const;
-	bool IsOutOfGrid(int x, int y) const;
-	int GetIndexFromCoords(IntVec2 const& coords) const;
+	bool IsOutOfSpace(Vec2 const& point) const;
 	int GetIndexFromCoords(int x, int y) const;
-	void InsertPointInGrid(Vec2 const& point);
 
 private:
-	IntVec2 m_gridSize = Vec2::ZERO;
+	IntVec2 m_gridSize = IntVec2::ZERO;
 	Vec2 m_spaceSize = Vec2::ZERO;
+	float m_radius = 0.0f; // Smallest radius, sets the cell size
+	float m_maxRadius = 0.0f;
+	float m_cellSize = 0.0f;
+	int m_neighborCellRange = 2; // Cells around a candidate that can hold points closer than the largest radius
+	PoissonDiscRadiusFunction m_radiusFunction;
+	RandomNumberGenerator m_rng;
+
+	int m_tileCellCount = 0;
+	IntVec2 m_tileCounts = IntVec2::ZERO;
+	std::vector<Tile> m_tiles;
+	std::vector<int> m_grid; // Index of the cell's point within the tile owning the cell, -1 when empty
+	std::vector<Vec2> m_cellPoints; // Copy of the cell's point, so neighbour checks stay in the grid
+	std::vector<float> m_cellRadii; // Only with a radius function
+};
+
+/// <summary>
+/// Bridson's Poisson disc sampling over the box [0, spaceSize)
+/// </summary>
+class PoissonDisc3D {
+public:
+	PoissonDisc3D(Vec3 const& spaceSize, float radius);
+
+	void SetSeed(uint64_t seed) { m_rng.SetSeed(seed); }
+	void GetSamplingPoints(std::vector<Vec3>& samplePoints, int triesFindingSample = POISSON_DISC_DEFAULT_TRIES);
+
+private:
+	bool IsPointValid(Vec3 const& point, std::vector<Vec3> const& samplePoints) const;
+	IntVec3 GetGridCoords(Vec3 const& point) const;
+	bool IsOutOfSpace(Vec3 const& point) const;
+	int GetIndexFromCoords(int x, int y, int z) const { return (((z * m_gridSize.y) + y) * m_gridSize.x) + x; }
+
+private:
+	IntVec3 m_gridSize = IntVec3::ZERO;
+	Vec3 m_spaceSize = Vec3::ZERO;
 	float m_radius = 0.0f;
 	float m_cellSize = 0.0f;
-	std::vector<Vec2> m_grid;
-};
\ No newline at end of file
+	RandomNumberGenerator m_rng;
+	std::vector<int> m_grid; // Index into the sample points, -1 when empty
+};
@@ -0,0 +1,188 @@
+#include "Engine/Math/SpatialHashGrid2D.hpp"
+
+SpatialHashGrid2D::SpatialHashGrid2D(SpatialHashGrid2DConfig const& config) :
+	m_config(config)
+{
+}
+
+void SpatialHashGrid2D::Build(std::vector<Vec2> const& positions, std::vector<float> const& radii)
+{
+	Build(positions.data(), radii.empty() ? nullptr : radii.data(), (int)positions.size());
+}
+
+void SpatialHashGrid2D::Build(Vec2 const* positions, float const* radii, int itemCount)
+{
+	m_maxRadius = 0.0f;
+	if (radii) {
+		for (int itemIndex = 0; itemIndex < itemCount; itemIndex++) {
+			if (radii[itemIndex] > m_maxRadius) {
+				m_maxRadius = radii[itemIndex];
+			}
+		}
+	}
+
+	m_cellSize = m_config.m_cellSize;
+	if (m_cellSize <= 0.0f) {
+		m_cellSize = (m_maxRadius > 0.0f) ? 2.0f * m_maxRadius : 1.0f;
+	}
+	m_inverseCellSize = 1.0f / m_cellSize;
+
+	// About one bucket per item. Twice as many measured no faster, the extra table size costs what the fewer collisions save
+	int minBucketCount = (m_config.m_minBucketCount > itemCount) ? m_config.m_minBucketCount : itemCount;
+	int powerOfTwoBuckets = 2;
+	while (powerOfTwoBuckets < minBucketCount) {
+		powerOfTwoBuckets <<= 1;
+	}
+	m_bucketMask = (uint32_t)powerOfTwoBuckets - 1;
+
+	// Counting sort: count per bucket, prefix sum into starts, then scatter
+	m_bucketStarts.assign(powerOfTwoBuckets + 1, 0);
+	m_itemBuckets.resize(itemCount);
+	for (int itemIndex = 0; itemIndex < itemCount; itemIndex++) {
+		Vec2 const& position = positions[itemIndex];
+		uint32_t bucket = GetBucketIndex(GetCellCoord(position.x), GetCellCoord(position.y));
+		m_itemBuckets[itemIndex] = bucket;
+		m_bucketStarts[bucket + 1]++;
+	}
+
+	for (int bucket = 0; bucket < powerOfTwoBuckets; bucket++) {
+		m_bucketStarts[bucket + 1] += m_bucketStarts[bucket];
+	}
+
+	m_sortedItemIndexes.resize(itemCount);
+	m_sortedPositions.resize(itemCount);
+	m_sortedRadii.resize(itemCount);
+	for (int itemIndex = 0; itemIndex < itemCount; itemIndex++) {
+		// Bucket starts double as write cursors, shifted back into place below
+		int sortedIndex = m_bucketStarts[m_itemBuckets[itemIndex]]++;
+		m_sortedItemIndexes[sortedIndex] = itemIndex;
+		m_sortedPositions[sortedIndex] = positions[itemIndex];
+		m_sortedRadii[sortedIndex] = (radii) ? radii[itemIndex] : 0.0f;
+	}
+
+	for (int bucket = powerOfTwoBuckets; bucket > 0; bucket--) {
+		m_bucketStarts[bucket] = m_bucketStarts[bucket - 1];
+	}
+	m_bucketStarts[0] = 0;
+}
+
+void SpatialHashGrid2D::Clear()
+{
+	m_bucketStarts.clear();
+	m_itemBuckets.clear();
+	m_sortedItemIndexes.clear();
+	m_sortedPositions.clear();
+	m_sortedRadii.clear();
+	m_maxRadius = 0.0f;
+}
+
+int SpatialHashGrid2D::GetItemRangesInRange(int minCellX, int minCellY, int maxCellX, int maxCellY, SpatialHashGrid2DRange* outRanges) const
+{
+	int64_t rowCount = (int64_t)maxCellY - minCellY + 1;
+	int64_t rowWidth = (int64_t)maxCellX - minCellX + 1;
+	int64_t bucketCount = (int64_t)m_bucketMask + 1;
+	if ((rowCount > SPATIAL_HASH_GRID_MAX_QUERY_ROWS) || (rowWidth >= bucketCount)) return -1;
+
+	int rangeCount = 0;
+	auto addRange = [&](int beginBucket, int endBucket) {
+		SpatialHashGrid2DRange range = { m_bucketStarts[beginBucket], m_bucketStarts[endBucket] };
+		if (range.m_begin == range.m_end) return;
+
+		// Insertion sort by begin, there are only a handful of ranges
+		int insertIndex = rangeCount++;
+		while ((insertIndex > 0) && (outRanges[insertIndex - 1].m_begin > range.m_begin)) {
+			outRanges[insertIndex] = outRanges[insertIndex - 1];
+			insertIndex--;
+		}
+		outRanges[insertIndex] = range;
+	};
+
+	for (int cellY = minCellY; cellY <= maxCellY; cellY++) {
+		int beginBucket = (int)GetBucketIndex(minCellX, cellY);
+		int64_t endBucket = beginBucket + rowWidth;
+		if (endBucket <= bucketCount) {
+			addRange(beginBucket, (int)endBucket);
+		}
+		else {
+			addRange(beginBucket, (int)bucketCount);
+			addRange(0, (int)(endBucket - bucketCount));
+		}
+	}
+
+	// Rows hashed onto overlapping buckets would otherwise report the same items twice
+	int mergedCount = 0;
+	for (int rangeIndex = 0; rangeIndex < rangeCount; rangeIndex++) {
+		if ((mergedCount > 0) && (outRanges[rangeIndex].m_begin <= outRanges[mergedCount - 1].m_end)) {
+			if (outRanges[rangeIndex].m_end > outRanges[mergedCount - 1].m_end) {
+				outRanges[mergedCount - 1].m_end = outRanges[rangeIndex].m_end;
+			}
+		}
+		else {
+			outRanges[mergedCount++] = outRanges[rangeIndex];
+		}
+	}
+
+	return mergedCount;
+}
+
+int SpatialHashGrid2D::QueryDisc(Vec2 const& center, float radius, std::vector<int>& outItemIndexes) const
+{
+	outItemIndexes.clear();
+	QueryDisc(center, radius, [&](int itemIndex) {
+		outItemIndexes.push_back(itemIndex);
+		return true;
+	});
+	return (int)outItemIndexes.size();
+}
+
+int SpatialHashGrid2D::FindOverlappingPairs(std::vector<DiscPair2D>& outPairs) const
+{
+	return FindOverlappingPairsInSlice(0, 1, outPairs);
+}
+
+int SpatialHashGrid2D::FindOverlappingPairsInSlice(int sliceIndex, int sliceCount, std::vector<DiscPair2D>& outPairs) const
+{
+	outPairs.clear();
+
+	int itemCount = (int)m_sortedItemIndexes.size();
+	int sliceBegin = (int)(((int64_t)itemCount * sliceIndex) / sliceCount);
+	int sliceEnd = (int)(((int64_t)itemCount * (sliceIndex + 1)) / sliceCount);
+	SpatialHashGrid2DRange ranges[SPATIAL_HASH_GRID_MAX_QUERY_RANGES];
+
+	// Both discs of an overlapping pair find each other, so each item only tests items after it in sorted order.
+	// Walking in sorted order also means consecutive items query memory that was just touched
+	for (int sortedIndex = sliceBegin; sortedIndex < sliceEnd; sortedIndex++) {
+		Vec2 const& position = m_sortedPositions[sortedIndex];
+		float radius = m_sortedRadii[sortedIndex];
+
+		float searchRadius = radius + m_maxRadius;
+		int rangeCount = GetItemRangesInRange(GetCellCoord(position.x - searchRadius), GetCellCoord(position.y - searchRadius),
+			GetCellCoord(position.x + searchRadius), GetCellCoord(position.y + searchRadius), ranges);
+		if (rangeCount < 0) {
+			ranges[0] = SpatialHashGrid2DRange{ 0, itemCount };
+			rangeCount = 1;
+		}
+
+		for (int rangeIndex = 0; rangeIndex < rangeCount; rangeIndex++) {
+			int beginIndex = (ranges[rangeIndex].m_begin > sortedIndex) ? ranges[rangeIndex].m_begin : sortedIndex + 1;
+			for (int otherSortedIndex = beginIndex; otherSortedIndex < ranges[rangeIndex].m_end; otherSortedIndex++) {
+				Vec2 const& otherPosition = m_sortedPositions[otherSortedIndex];
+				float radiusSum = radius + m_sortedRadii[otherSortedIndex];
+				float distX = otherPosition.x - position.x;
+				float distY = otherPosition.y - position.y;
+				if (((distX * distX) + (distY * distY)) >= (radiusSum * radiusSum)) continue;
+
+				int itemIndex = m_sortedItemIndexes[sortedIndex];
+				int otherItemIndex = m_sortedItemIndexes[otherSortedIndex];
+				if (itemIndex < otherItemIndex) {
+					outPairs.push_back(DiscPair2D{ itemIndex, otherItemIndex });
+				}
+				else {
+					outPairs.push_back(DiscPair2D{ otherItemIndex, itemIndex });
+				}
+			}
+		}
+	}
+
+	return (int)outPairs.size();
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+struct DiscPair2D {
+	int m_discA = -1; // Always the lower index
+	int m_discB = -1;
+};
+
+struct SpatialHashGrid2DRange {
+	int m_begin = 0;
+	int m_end = 0;
+};
+
+constexpr int SPATIAL_HASH_GRID_MAX_QUERY_ROWS = 32; // Queries spanning more cell rows than this fall back to scanning every item
+constexpr int SPATIAL_HASH_GRID_MAX_QUERY_RANGES = SPATIAL_HASH_GRID_MAX_QUERY_ROWS * 2; // A row wrapping around the bucket table splits in two
+
+struct SpatialHashGrid2DConfig {
+	float m_cellSize = 0.0f; // <= 0 picks twice the largest radius, so most queries only touch the 3x3 cells around them
+	int m_minBucketCount = 64;
+};
+
+/// <summary>
+/// Loose uniform grid hashed into a fixed bucket table, for discs and points. Every item lives in the bucket of the cell holding its
+/// center; queries widen their search by the largest radius instead. Build() is a counting sort, so after it items sit contiguous
+/// per bucket with their positions and radii copied alongside (structure of arrays). Only the row is hashed, cells along a row
+/// map to consecutive buckets, so a query reads one contiguous run of items per row instead of one per cell.
+/// Built from scratch every frame, nothing is updated incrementally
+/// </summary>
+class SpatialHashGrid2D {
+public:
+	SpatialHashGrid2D(SpatialHashGrid2DConfig const& config = SpatialHashGrid2DConfig());
+
+	// radii may be null for points. Steady state is allocation free once the buffers reached their peak size
+	void Build(Vec2 const* positions, float const* radii, int itemCount);
+	void Build(std::vector<Vec2> const& positions, std::vector<float> const& radii);
+	void Clear();
+
+	// callback(itemIndex) for every item whose disc overlaps the query disc. Returning false stops the query.
+	// Touching discs do not overlap, same as DoDiscsOverlap and FindOverlappingPairs
+	template <typename T_Callback>
+	void QueryDisc(Vec2 const& center, float radius, T_Callback const& callback) const;
+	int QueryDisc(Vec2 const& center, float radius, std::vector<int>& outItemIndexes) const;
+
+	// Every overlapping pair once, lower index first. outPairs is cleared, not shrunk
+	int FindOverlappingPairs(std::vector<DiscPair2D>& outPairs) const;
+	// Only the pairs found from one of sliceCount equal slices of the items. The union over all slices is FindOverlappingPairs,
+	// with no pair in two slices, so slices can run on separate jobs into separate vectors
+	int FindOverlappingPairsInSlice(int sliceIndex, int sliceCount, std::vector<DiscPair2D>& outPairs) const;
+
+	int GetItemCount() const { return (int)m_sortedItemIndexes.size(); }
+	float GetCellSize() const { return m_cellSize; }
+	float GetMaxRadius() const { return m_maxRadius; }
+
+private:
+	int GetCellCoord(float position) const { return (int)floorf(position * m_inverseCellSize); }
+	uint32_t GetBucketIndex(int cellX, int cellY) const { return ((uint32_t)cellX + ((uint32_t)cellY * 2654435761u)) & m_bucketMask; }
+
+	// Sorted item ranges covering the cells in range. Rows can hash onto overlapping buckets, overlapping ranges are merged
+	// so no item is visited twice. Returns how many, or -1 if the range is too large and everything should be scanned
+	int GetItemRangesInRange(int minCellX, int minCellY, int maxCellX, int maxCellY, SpatialHashGrid2DRange* outRanges) const;
+
+private:
+	SpatialHashGrid2DConfig m_config;
+	float m_cellSize = 1.0f;
+	float m_inverseCellSize = 1.0f;
+	float m_maxRadius = 0.0f;
+	uint32_t m_bucketMask = 0;
+
+	std::vector<int> m_bucketStarts; // Bucket b owns sorted items [m_bucketStarts[b], m_bucketStarts[b + 1])
+	std::vector<uint32_t> m_itemBuckets;
+	std::vector<int> m_sortedItemIndexes;
+	std::vector<Vec2> m_sortedPositions;
+	std::vector<float> m_sortedRadii;
+};
+
+template <typename T_Callback>
+void SpatialHashGrid2D::QueryDisc(Vec2 const& center, float radius, T_Callback const& callback) const
+{
+	if (m_sortedItemIndexes.empty()) return;
+
+	float searchRadius = radius + m_maxRadius;
+	SpatialHashGrid2DRange ranges[SPATIAL_HASH_GRID_MAX_QUERY_RANGES];
+	int rangeCount = GetItemRangesInRange(GetCellCoord(center.x - searchRadius), GetCellCoord(center.y - searchRadius),
+		GetCellCoord(center.x + searchRadius), GetCellCoord(center.y + searchRadius), ranges);
+
+	auto visitRange = [&](int startIndex, int endIndex) {
+		for (int sortedIndex = startIndex; sortedIndex < endIndex; sortedIndex++) {
+			Vec2 const& position = m_sortedPositions[sortedIndex];
+			float radiusSum = radius + m_sortedRadii[sortedIndex];
+			float distX = position.x - center.x;
+			float distY = position.y - center.y;
+			if (((distX * distX) + (distY * distY)) >= (radiusSum * radiusSum)) continue;
+
+			if (!callback(m_sortedItemIndexes[sortedIndex])) return false;
+		}
+		return true;
+	};
+
+	if (rangeCount < 0) {
+		visitRange(0, (int)m_sortedItemIndexes.size());
+		return;
+	}
+
+	for (int rangeIndex = 0; rangeIndex < rangeCount; rangeIndex++) {
+		if (!visitRange(ranges[rangeIndex].m_begin, ranges[rangeIndex].m_end)) return;
+	}
+}
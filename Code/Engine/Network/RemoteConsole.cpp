@@ -4,6 +4,8 @@
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Network/TCPServer.hpp"
 #include "Engine/Network/NetworkCommon.hpp"
+#include "Engine/Core/Metrics.hpp"
+#include "Engine/Core/Time.hpp"
 
 RemoteConsole* currentRemoteConsole = nullptr;
 
@@ -12,7 +14,8 @@ std::vector<std::string> RemoteConsole::s_invalidRCCmds = { "rckick", "rcleave",
 
 RemoteConsole::RemoteConsole(RemoteConsoleConfig const& config) :
 	m_config(config),
-	m_devConsole(config.m_console)
+	m_devConsole(config.m_console),
+	m_metricsStreamIntervalSeconds(config.m_metricsStreamIntervalSeconds)
 {
 	currentRemoteConsole = this;
 
@@ -30,6 +33,7 @@ void RemoteConsole::Startup()
 	SubscribeEventCallbackFunction("RCKick", RCKick);
 	SubscribeEventCallbackFunction("RCLeave", RCLeave);
 	SubscribeEventCallbackFunction("RCBan", RCBan);
+	SubscribeEventCallbackFunction("RCMetrics", RCMetrics);
 
 
 
@@ -54,6 +58,7 @@ void RemoteConsole::Shutdown()
 	UnsubscribeEventCallbackFunction("RCKick", RCKick);
 	UnsubscribeEventCallbackFunction("RCLeave", RCLeave);
 	UnsubscribeEventCallbackFunction("RCBan", RCBan);
+	UnsubscribeEventCallbackFunction("RCMetrics", RCMetrics);
 
 }
 
@@ -123,6 +128,13 @@ void RemoteConsole::Update()
 		}
 	}
 
+	if ((m_metricsStreamIntervalSeconds > 0.0) && !m_connections.empty()) {
+		double currentTime = GetCurrentTimeSeconds();
+		if ((currentTime - m_lastMetricsStreamTime) >= m_metricsStreamIntervalSeconds) {
+			SendMetricsSnapshot();
+			m_lastMetricsStreamTime = currentTime;
+		}
+	}
 }
 
 void RemoteConsole::Render(Renderer const& renderer)
@@ -271,6 +283,18 @@ void RemoteConsole::SendEcho(std::string const& echo)
 	}
 }
 
+void RemoteConsole::SendMetricsSnapshot()
+{
+	if (!g_theMetrics) return;
+
+	// One echo per metric keeps every message well under the 16 bit payload size, receivers print them as console lines
+	Strings snapshotLines = g_theMetrics->BuildSnapshotLines();
+	SendEcho(Stringf("[Metrics %.3f] %d metrics", GetCurrentTimeSeconds(), (int)snapshotLines.size()));
+	for (std::string const& snapshotLine : snapshotLines) {
+		SendEcho("[Metrics] " + snapshotLine);
+	}
+}
+
 void RemoteConsole::KillConnection(NetworkAddress const& netAddress)
 {
 
@@ -519,6 +543,24 @@ bool RemoteConsole::RCBan(EventArgs& args)
 	return false;
 }
 
+bool RemoteConsole::RCMetrics(EventArgs& args)
+{
+	if (!currentRemoteConsole) return true;
+
+	double streamInterval = args.GetValue("interval", 1.0);
+	currentRemoteConsole->m_metricsStreamIntervalSeconds = (streamInterval > 0.0) ? streamInterval : 0.0;
+	currentRemoteConsole->m_lastMetricsStreamTime = 0.0;
+
+	if (currentRemoteConsole->m_metricsStreamIntervalSeconds > 0.0) {
+		currentRemoteConsole->m_devConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, Stringf("Streaming metrics every %.2f seconds", streamInterval));
+	}
+	else {
+		currentRemoteConsole->m_devConsole->AddLine(DevConsole::INFO_MAJOR_COLOR, "Metrics streaming stopped");
+	}
+
+	return true;
+}
+
 void RemoteConsole::ClearConnections()
 {
 	for (int connInd = 0; connInd < m_connections.size(); connInd++) {
@@ -23,6 +23,7 @@ struct RDCPayload{
 
 struct RemoteConsoleConfig {
 	DevConsole* m_console = nullptr;
+	double m_metricsStreamIntervalSeconds = 0.0; // 0 disables metrics streaming
 };
 enum class RemoteConsoleState {
 	DISCONNECTED,
@@ -49,6 +50,7 @@ public:
 	void SendCommand(std::string const& cmd);
 	void SendEcho(int connIndex, std::string const& echo);
 	void SendEcho(std::string const& echo);
+	void SendMetricsSnapshot();
 
 	void KillConnection(NetworkAddress const& netAddress);
 	void KillConnection(int connIndex);
@@ -65,6 +67,7 @@ public:
 	static bool RCKick(EventArgs& args);
 	static bool RCLeave(EventArgs& args);
 	static bool RCBan(EventArgs& args);
+	static bool RCMetrics(EventArgs& args);
 
 public:
 	DevConsole* m_devConsole = nullptr;
@@ -80,6 +83,9 @@ private:
 
 	bool m_initialHostAttempt = false;
 
+	double m_metricsStreamIntervalSeconds = 0.0;
+	double m_lastMetricsStreamTime = 0.0;
+
 	RemoteConsoleState m_state = RemoteConsoleState::DISCONNECTED;
 	std::vector<NetworkAddress> m_blacklistAddresses;
 	static std::vector<std::string> s_invalidRCCmds;
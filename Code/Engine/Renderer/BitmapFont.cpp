@@ -1,7 +1,6 @@
 #include "Engine/Renderer/BitmapFont.hpp"
 #include "Engine/Math/AABB2.hpp"
-#include "Engine/Math/OBB2.hpp"
-#include "Engine/Core/VertexUtils.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
 #include "Engine/Core/StringUtils.hpp"
 
 BitmapFont::BitmapFont(char const* fontFilePathNameWithNoExtension, Texture& fontTexture):
@@ -10,38 +9,51 @@ BitmapFont::BitmapFont(char const* fontFilePathNameWithNoExtension, Texture& fon
 {
 }
 
+BitmapFont::BitmapFont(char const* fontFilePathNameWithNoExtension, Texture& fontTexture, std::vector<AABB2> const& glyphUVs):
+	m_fontFilePathNameWithNoExtension(fontFilePathNameWithNoExtension),
+	m_fontGlyphsSpriteSheet(fontTexture, glyphUVs)
+{
+}
+
 Texture const& BitmapFont::GetTexture() const
 {
 	return m_fontGlyphsSpriteSheet.GetTexture();
 }
 
-void BitmapFont::AddVertsForText2D(std::vector<Vertex_PCU>& vertexArray, Vec2 const& textMins, float cellHeight, std::string const& text, Rgba8 const& tint, float cellAspect, int maxGlyphsToDraw)
+void BitmapFont::AddVertsForText2D(std::vector<Vertex_PCU>& vertexArray, Vec2 const& textMins, float cellHeight, std::string const& text, Rgba8 const& tint, float cellAspect, int maxGlyphsToDraw) const
 {
-	Vec2 letterPosition = textMins;
-	letterPosition.x += cellAspect * cellHeight * 0.5f;
-	letterPosition.y += cellHeight * 0.5f;
-	for (int charIndex = 0, glyphsDrawn = 0; charIndex < text.size(); charIndex++, glyphsDrawn++) {
-		if (glyphsDrawn >= maxGlyphsToDraw) return;
-		int const& letter = text[charIndex];
-		AABB2 letterUVs = m_fontGlyphsSpriteSheet.GetSpriteUVs(letter);
-
-		OBB2 letterOBB2;
-		letterOBB2.m_center = letterPosition;
-		letterOBB2.m_halfDimensions = Vec2(cellAspect * cellHeight * 0.5f, cellHeight * 0.5f);
-
-		AddVertsForOBB2D(vertexArray, letterOBB2, tint, letterUVs);
-		letterPosition.x += cellAspect * cellHeight;
-	}
-
+	int glyphCount = (maxGlyphsToDraw < (int)text.size()) ? maxGlyphsToDraw : (int)text.size();
+	AddGlyphQuads(vertexArray, nullptr, textMins, cellHeight, text.data(), glyphCount, tint, cellAspect);
 }
 
 void BitmapFont::AddVertsForTextInBox2D(std::vector<Vertex_PCU>& vertexArray, AABB2 const& box, float cellHeight, std::string const& text, Rgba8 const& tint,
-										float cellAspect, Vec2 const& alignment, TextBoxMode mode, int maxGlyphsToDraw)
+										float cellAspect, Vec2 const& alignment, TextBoxMode mode, int maxGlyphsToDraw) const
 {
-	Strings textSplitByNewline = SplitStringOnDelimiter(text, '\n');
+	AddGlyphQuadsInBox2D(vertexArray, nullptr, box, cellHeight, text, tint, cellAspect, alignment, mode, maxGlyphsToDraw);
+}
 
-	float textHeight = textSplitByNewline.size() * cellHeight;
-	float biggestTextWidth = GetBiggestTextWidth(textSplitByNewline, cellHeight, cellAspect);
+void BitmapFont::AddIndexedVertsForTextInBox2D(std::vector<Vertex_PCU>& vertexArray, std::vector<unsigned int>& indexArray, AABB2 const& box, float cellHeight,
+											   std::string const& text, Rgba8 const& tint, float cellAspect, Vec2 const& alignment, TextBoxMode mode, int maxGlyphsToDraw) const
+{
+	AddGlyphQuadsInBox2D(vertexArray, &indexArray, box, cellHeight, text, tint, cellAspect, alignment, mode, maxGlyphsToDraw);
+}
+
+void BitmapFont::AddGlyphQuadsInBox2D(std::vector<Vertex_PCU>& vertexArray, std::vector<unsigned int>* indexArray, AABB2 const& box, float cellHeight,
+									  std::string const& text, Rgba8 const& tint, float cellAspect, Vec2 const& alignment, TextBoxMode mode, int maxGlyphsToDraw) const
+{
+	int lineCount = 1;
+	int longestLineLength = 0;
+	for (int charIndex = 0, lineStart = 0; charIndex <= (int)text.size(); charIndex++) {
+		if ((charIndex == (int)text.size()) || (text[charIndex] == '\n')) {
+			int lineLength = charIndex - lineStart;
+			longestLineLength = (lineLength > longestLineLength) ? lineLength : longestLineLength;
+			lineCount += (charIndex < (int)text.size()) ? 1 : 0;
+			lineStart = charIndex + 1;
+		}
+	}
+
+	float textHeight = (float)lineCount * cellHeight;
+	float biggestTextWidth = (float)longestLineLength * cellHeight * cellAspect;
 
 	Vec2 const boxDimensions = box.GetDimensions();
 	float recommendedYScale = boxDimensions.y / textHeight;
@@ -60,31 +72,92 @@ void BitmapFont::AddVertsForTextInBox2D(std::vector<Vertex_PCU>& vertexArray, AA
 		usedCellHeight *= smallestScale;
 	}
 
-	AABB2 allTextABB2(Vec2::ZERO, Vec2(usedTextWidth, usedTextHeight));
-	box.AlignABB2WithinBounds(allTextABB2, alignment);
-
+	float allTextMinX = box.m_mins.x + (boxDimensions.x - usedTextWidth) * alignment.x;
 	float textGroupMinY = (boxDimensions.y - (usedTextHeight)) * alignment.y;
-	for (int subTextIndex = 0, glyphsDrawn = 0; subTextIndex < (int)textSplitByNewline.size(); subTextIndex++) {
+	for (int lineIndex = 0, lineStart = 0, glyphsDrawn = 0; lineIndex < lineCount; lineIndex++) {
 		int remainingGlyphs = maxGlyphsToDraw - glyphsDrawn;
 		if (remainingGlyphs <= 0) {
 			return;
 		}
 
-		std::string const& textToDraw = textSplitByNewline[subTextIndex];
-		float lineTextWidth = GetTextWidth(usedCellHeight, textToDraw, cellAspect);
-		AABB2 textLineABB2(Vec2::ZERO, Vec2(lineTextWidth, textHeight));
-		allTextABB2.AlignABB2WithinBounds(textLineABB2, alignment);
-
-		float textLineYPos = textGroupMinY + (usedCellHeight * float((textSplitByNewline.size() - subTextIndex - 1)));
+		int lineEnd = lineStart;
+		while ((lineEnd < (int)text.size()) && (text[lineEnd] != '\n')) {
+			lineEnd++;
+		}
+		int lineLength = lineEnd - lineStart;
 
-		textLineABB2.m_mins.y = box.m_mins.y + textLineYPos;
+		float lineTextWidth = (float)lineLength * usedCellHeight * cellAspect;
+		Vec2 lineMins;
+		lineMins.x = allTextMinX + (usedTextWidth - lineTextWidth) * alignment.x;
+		lineMins.y = box.m_mins.y + textGroupMinY + (usedCellHeight * float(lineCount - lineIndex - 1));
 
-		AddVertsForText2D(vertexArray, textLineABB2.m_mins, usedCellHeight, textToDraw, tint, cellAspect, remainingGlyphs);
+		int glyphCount = (remainingGlyphs < lineLength) ? remainingGlyphs : lineLength;
+		AddGlyphQuads(vertexArray, indexArray, lineMins, usedCellHeight, text.data() + lineStart, glyphCount, tint, cellAspect);
 
-		glyphsDrawn += (int)textToDraw.size();
+		glyphsDrawn += lineLength;
+		lineStart = lineEnd + 1;
+	}
+}
 
+// Arrays grow once per line and every vertex is written in place. Glyphs are read as unsigned char so the upper half of the
+// 16x16 sheet is reachable
+void BitmapFont::AddGlyphQuads(std::vector<Vertex_PCU>& vertexArray, std::vector<unsigned int>* indexArray, Vec2 const& textMins, float cellHeight,
+							   char const* glyphs, int glyphCount, Rgba8 const& tint, float cellAspect) const
+{
+	if (glyphCount <= 0) return;
+
+	int vertsPerGlyph = indexArray ? 4 : 6;
+	size_t firstVertex = vertexArray.size();
+	vertexArray.resize(firstVertex + (size_t)glyphCount * vertsPerGlyph);
+	Vertex_PCU* vertex = vertexArray.data() + firstVertex;
+
+	unsigned int* index = nullptr;
+	if (indexArray) {
+		size_t firstIndex = indexArray->size();
+		indexArray->resize(firstIndex + (size_t)glyphCount * 6);
+		index = indexArray->data() + firstIndex;
 	}
 
+	float cellWidth = cellAspect * cellHeight;
+	float minY = textMins.y;
+	float maxY = textMins.y + cellHeight;
+	for (int glyphIndex = 0; glyphIndex < glyphCount; glyphIndex++) {
+		Vec2 uvMins;
+		Vec2 uvMaxs;
+		m_fontGlyphsSpriteSheet.GetSpriteUVs(uvMins, uvMaxs, (unsigned char)glyphs[glyphIndex]);
+
+		float minX = textMins.x + cellWidth * (float)glyphIndex;
+		float maxX = minX + cellWidth;
+		Vertex_PCU bottomLeft(Vec3(minX, minY, 0.0f), tint, uvMins);
+		Vertex_PCU bottomRight(Vec3(maxX, minY, 0.0f), tint, Vec2(uvMaxs.x, uvMins.y));
+		Vertex_PCU topRight(Vec3(maxX, maxY, 0.0f), tint, uvMaxs);
+		Vertex_PCU topLeft(Vec3(minX, maxY, 0.0f), tint, Vec2(uvMins.x, uvMaxs.y));
+
+		if (index) {
+			unsigned int baseVertex = (unsigned int)(firstVertex + (size_t)glyphIndex * 4);
+			vertex[0] = bottomLeft;
+			vertex[1] = bottomRight;
+			vertex[2] = topRight;
+			vertex[3] = topLeft;
+			index[0] = baseVertex;
+			index[1] = baseVertex + 1;
+			index[2] = baseVertex + 2;
+			index[3] = baseVertex;
+			index[4] = baseVertex + 2;
+			index[5] = baseVertex + 3;
+			vertex += 4;
+			index += 6;
+		}
+		else {
+			vertex[0] = bottomLeft;
+			vertex[1] = bottomRight;
+			vertex[2] = topRight;
+			vertex[3] = bottomLeft;
+			vertex[4] = topRight;
+			vertex[5] = topLeft;
+			vertex += 6;
+		}
+	}
 }
 
 float BitmapFont::GetTextWidth(float cellHeight, std::string const& text, float cellAspect) const
@@ -18,21 +18,32 @@ class BitmapFont {
 
 private:
 	BitmapFont(char const* fontFilePathNameWithNoExtension, Texture& fontTexture);
+	BitmapFont(char const* fontFilePathNameWithNoExtension, Texture& fontTexture, std::vector<AABB2> const& glyphUVs);
 public:
 	Texture const& GetTexture() const;
 
+	// Glyph cells are axis aligned, so quads are written straight from the cell corners: 6 vertexes per glyph as two triangles
 	void AddVertsForText2D(std::vector<Vertex_PCU>& vertexArray, Vec2 const& textMins,
-		float cellHeight, std::string const& text, Rgba8 const& tint = Rgba8::WHITE, float cellAspect = CELL_ASPECT, int maxGlyphsToDraw = ARBITRARILY_LARGE_INT_VALUE);
+		float cellHeight, std::string const& text, Rgba8 const& tint = Rgba8::WHITE, float cellAspect = CELL_ASPECT, int maxGlyphsToDraw = ARBITRARILY_LARGE_INT_VALUE) const;
 
 	void AddVertsForTextInBox2D(std::vector<Vertex_PCU>& vertexArray, AABB2 const& box, float cellHeight, std::string const& text,
 		Rgba8 const& tint = Rgba8::WHITE, float cellAspect = 1.0f, Vec2 const& alignment = Vec2(0.5f, 0.5f), TextBoxMode mode = TextBoxMode::SHRINK_TO_FIT,
-		int maxGlyphsToDraw = ARBITRARILY_LARGE_INT_VALUE);
+		int maxGlyphsToDraw = ARBITRARILY_LARGE_INT_VALUE) const;
+	// Same layout, 4 vertexes and 6 indexes per glyph. Indexes already point past the vertexes that were in vertexArray
+	void AddIndexedVertsForTextInBox2D(std::vector<Vertex_PCU>& vertexArray, std::vector<unsigned int>& indexArray, AABB2 const& box, float cellHeight,
+		std::string const& text, Rgba8 const& tint = Rgba8::WHITE, float cellAspect = 1.0f, Vec2 const& alignment = Vec2(0.5f, 0.5f),
+		TextBoxMode mode = TextBoxMode::SHRINK_TO_FIT, int maxGlyphsToDraw = ARBITRARILY_LARGE_INT_VALUE) const;
 
 	float GetTextWidth(float cellHeight, std::string const& text, float cellAspect = CELL_ASPECT) const;
 
 protected:
 	float GetGlyphAspect(int glyphUnicode) const;
 	float GetBiggestTextWidth(Strings const& stringsVector, float cellHeight, float cellAspect) const;
+	// Lines are found in place instead of split into strings. Indexed when indexArray is not null
+	void AddGlyphQuadsInBox2D(std::vector<Vertex_PCU>& vertexArray, std::vector<unsigned int>* indexArray, AABB2 const& box, float cellHeight,
+		std::string const& text, Rgba8 const& tint, float cellAspect, Vec2 const& alignment, TextBoxMode mode, int maxGlyphsToDraw) const;
+	void AddGlyphQuads(std::vector<Vertex_PCU>& vertexArray, std::vector<unsigned int>* indexArray, Vec2 const& textMins, float cellHeight,
+		char const* glyphs, int glyphCount, Rgba8 const& tint, float cellAspect) const;
 
 protected:
 	std::string m_fontFilePathNameWithNoExtension;
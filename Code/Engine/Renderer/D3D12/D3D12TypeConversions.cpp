@@ -11,6 +11,9 @@ DXGI_FORMAT LocalToD3D12(TextureFormat textureFormat)
 	case TextureFormat::R32G32_FLOAT: return DXGI_FORMAT_R32G32_FLOAT;
 	case TextureFormat::R24G8_TYPELESS: return DXGI_FORMAT_R24G8_TYPELESS;
 	case TextureFormat::R32_FLOAT: return DXGI_FORMAT_R32_FLOAT;
+	case TextureFormat::BC1_UNORM: return DXGI_FORMAT_BC1_UNORM;
+	case TextureFormat::BC3_UNORM: return DXGI_FORMAT_BC3_UNORM;
+	case TextureFormat::BC7_UNORM: return DXGI_FORMAT_BC7_UNORM;
 	default: ERROR_AND_DIE("Unsupported format");
 	}
 }
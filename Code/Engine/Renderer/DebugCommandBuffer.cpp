@@ -0,0 +1,79 @@
+#include "Engine/Renderer/DebugCommandBuffer.hpp"
+#include <mutex>
+
+namespace {
+	// Only taken when a thread sends its first debug command and when the buffers are merged
+	std::mutex s_commandBuffersMutex;
+	std::vector<DebugCommandBuffer*> s_commandBuffers;
+
+	thread_local DebugCommandBuffer* t_commandBuffer = nullptr;
+}
+
+DebugCommandBuffer* GetThreadDebugCommandBuffer()
+{
+	if (t_commandBuffer) return t_commandBuffer;
+
+	std::lock_guard<std::mutex> buffersLock(s_commandBuffersMutex);
+	t_commandBuffer = new DebugCommandBuffer();
+	s_commandBuffers.push_back(t_commandBuffer);
+	return t_commandBuffer;
+}
+
+void GetAllDebugCommandBuffers(std::vector<DebugCommandBuffer*>& outBuffers)
+{
+	std::lock_guard<std::mutex> buffersLock(s_commandBuffersMutex);
+	outBuffers = s_commandBuffers;
+}
+
+DebugCommandBuffer::DebugCommandBuffer()
+{
+	m_writeBlock = new DebugCommandBlock();
+	m_readBlock = m_writeBlock;
+}
+
+DebugCommandBuffer::~DebugCommandBuffer()
+{
+	while (m_readBlock) {
+		DebugCommandBlock* nextBlock = m_readBlock->m_next.load(std::memory_order_relaxed);
+		delete m_readBlock;
+		m_readBlock = nextBlock;
+	}
+	m_writeBlock = nullptr;
+}
+
+void DebugCommandBuffer::Push(DebugRenderCommand const& newCommand)
+{
+	int count = m_writeBlock->m_count.load(std::memory_order_relaxed);
+	if (count == DEBUG_COMMANDS_PER_BLOCK) {
+		// Linking the new block is the last time the producer touches the full one
+		DebugCommandBlock* newBlock = new DebugCommandBlock();
+		m_writeBlock->m_next.store(newBlock, std::memory_order_release);
+		m_writeBlock = newBlock;
+		count = 0;
+	}
+
+	m_writeBlock->m_commands[count] = newCommand;
+	m_writeBlock->m_count.store(count + 1, std::memory_order_release);
+}
+
+size_t DebugCommandBuffer::Drain(std::function<void(DebugRenderCommand const& command)> const& commandFunction)
+{
+	size_t drainedCount = 0;
+	while (true) {
+		int count = m_readBlock->m_count.load(std::memory_order_acquire);
+		for (int commandIndex = m_readIndex; commandIndex < count; commandIndex++) {
+			commandFunction(m_readBlock->m_commands[commandIndex]);
+		}
+		drainedCount += count - m_readIndex;
+		m_readIndex = count;
+		if (count < DEBUG_COMMANDS_PER_BLOCK) break;
+
+		DebugCommandBlock* nextBlock = m_readBlock->m_next.load(std::memory_order_acquire);
+		if (!nextBlock) break;
+
+		delete m_readBlock;
+		m_readBlock = nextBlock;
+		m_readIndex = 0;
+	}
+	return drainedCount;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Renderer/DebugRendererSystem.hpp"
+#include <atomic>
+#include <functional>
+#include <vector>
+
+struct DebugShape;
+
+constexpr int DEBUG_COMMANDS_PER_BLOCK = 256;
+
+// Unit meshes the debug primitives are copied from. Cylinders and arrows go from the origin to +Z with radius 1, boxes span 0 to 1
+enum class DebugUnitMeshType {
+	SPHERE,
+	WIRE_SPHERE,
+	CYLINDER,
+	ARROW,
+	BOX,
+	NUM_DEBUG_UNIT_MESH_TYPES
+};
+
+struct DebugUnitMeshKey {
+	DebugUnitMeshType m_type = DebugUnitMeshType::SPHERE;
+	int m_stacks = 0;
+	int m_slices = 0;
+};
+
+enum class DebugCommandType {
+	INSTANCE,
+	WIRE_INSTANCE,
+	SHAPE,
+	BILLBOARD
+};
+
+// Instances carry their mesh as a key, the mesh is found or built when the command is merged, on the thread that renders
+struct DebugRenderCommand {
+	Mat44 m_transform;
+	Rgba8 m_startColor;
+	Rgba8 m_endColor;
+	float m_startTime = 0.0f;
+	float m_duration = 0.0f;
+	DebugUnitMeshKey m_meshKey;
+	DebugCommandType m_type = DebugCommandType::INSTANCE;
+	DebugRenderMode m_mode = DebugRenderMode::USEDEPTH;
+	DebugShape* m_shape = nullptr; // Text shapes and billboards, owned by the command until it is merged
+};
+
+/// <summary>
+/// Append only list of debug commands with a single producer (owning thread) and a single consumer (the thread that renders).
+/// Commands go in blocks linked as they fill, the producer only publishes its block count, so neither side ever waits.
+/// A block is freed by the consumer once it is read and the producer has moved on to the next one
+/// </summary>
+class DebugCommandBuffer {
+public:
+	DebugCommandBuffer();
+	~DebugCommandBuffer();
+
+	void Push(DebugRenderCommand const& newCommand);
+	// Hands every command published so far to the function, in the order they were pushed. Returns how many there were
+	size_t Drain(std::function<void(DebugRenderCommand const& command)> const& commandFunction);
+
+private:
+	struct DebugCommandBlock {
+		DebugRenderCommand m_commands[DEBUG_COMMANDS_PER_BLOCK];
+		std::atomic<int> m_count = 0;
+		std::atomic<DebugCommandBlock*> m_next = nullptr;
+	};
+
+	alignas(64) DebugCommandBlock* m_writeBlock = nullptr;
+	alignas(64) DebugCommandBlock* m_readBlock = nullptr;
+	int m_readIndex = 0;
+};
+
+// Buffer of the calling thread, made on its first debug command. Buffers are never freed, like the profiler ones
+DebugCommandBuffer* GetThreadDebugCommandBuffer();
+void GetAllDebugCommandBuffers(std::vector<DebugCommandBuffer*>& outBuffers);
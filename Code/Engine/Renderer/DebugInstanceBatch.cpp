@@ -0,0 +1,181 @@
+#include "Engine/Renderer/DebugInstanceBatch.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Math/SIMDUtils.hpp"
+#include <cfloat>
+
+void DebugInstanceBatch::AddInstance(int meshIndex, Mat44 const& transform, Rgba8 const& startColor, Rgba8 const& endColor, float startTime, float duration)
+{
+	m_meshIndexes.push_back(meshIndex);
+	m_transforms.push_back(transform);
+	m_startColors.push_back(startColor);
+	m_endColors.push_back(endColor);
+	m_startTimes.push_back(startTime);
+	m_durations.push_back(duration);
+	m_isExpansionStale = true;
+}
+
+// Survivors are packed down in order. While nothing has expired yet, whole groups of 4 are skipped without moving anything
+void DebugInstanceBatch::RemoveExpired(float currentTime)
+{
+	int instanceCount = GetInstanceCount();
+	float const* startTimes = m_startTimes.data();
+	float const* durations = m_durations.data();
+
+	int keptCount = 0;
+	int instanceIndex = 0;
+	SimdFloat4 now = SimdFloat4::Broadcast(currentTime);
+	for (; instanceIndex + SimdFloat4::LANES <= instanceCount; instanceIndex += SimdFloat4::LANES) {
+		SimdFloat4 elapsed = now - SimdFloat4::Load(startTimes + instanceIndex);
+		int expiredBits = GetMaskBits(elapsed >= SimdFloat4::Load(durations + instanceIndex));
+		if ((expiredBits == 0) && (keptCount == instanceIndex)) {
+			keptCount += SimdFloat4::LANES;
+			continue;
+		}
+
+		for (int lane = 0; lane < SimdFloat4::LANES; lane++) {
+			if ((expiredBits & (1 << lane)) == 0) {
+				MoveInstance(instanceIndex + lane, keptCount++);
+			}
+		}
+	}
+	for (; instanceIndex < instanceCount; instanceIndex++) {
+		if (currentTime - startTimes[instanceIndex] < durations[instanceIndex]) {
+			MoveInstance(instanceIndex, keptCount++);
+		}
+	}
+
+	if (keptCount == instanceCount) return;
+	m_isExpansionStale = true;
+	m_meshIndexes.resize(keptCount);
+	m_transforms.resize(keptCount);
+	m_startColors.resize(keptCount);
+	m_endColors.resize(keptCount);
+	m_startTimes.resize(keptCount);
+	m_durations.resize(keptCount);
+}
+
+void DebugInstanceBatch::Clear()
+{
+	m_meshIndexes.clear();
+	m_transforms.clear();
+	m_startColors.clear();
+	m_endColors.clear();
+	m_startTimes.clear();
+	m_durations.clear();
+	m_isExpansionStale = true;
+}
+
+int DebugInstanceBatch::UpdateVertexes(std::vector<std::vector<Vertex_PCU>> const& unitMeshes, float currentTime) const
+{
+	if (m_isExpansionStale) {
+		ExpandInstances(unitMeshes, currentTime);
+		m_isExpansionStale = false;
+	}
+	else if (!m_fadingInstances.empty()) {
+		TintFadingInstances(unitMeshes, currentTime);
+	}
+	return (int)m_vertexes.size();
+}
+
+void DebugInstanceBatch::MoveInstance(int fromIndex, int toIndex)
+{
+	if (fromIndex == toIndex) return;
+	m_meshIndexes[toIndex] = m_meshIndexes[fromIndex];
+	m_transforms[toIndex] = m_transforms[fromIndex];
+	m_startColors[toIndex] = m_startColors[fromIndex];
+	m_endColors[toIndex] = m_endColors[fromIndex];
+	m_startTimes[toIndex] = m_startTimes[fromIndex];
+	m_durations[toIndex] = m_durations[fromIndex];
+}
+
+void DebugInstanceBatch::ExpandInstances(std::vector<std::vector<Vertex_PCU>> const& unitMeshes, float currentTime) const
+{
+	int instanceCount = GetInstanceCount();
+	m_firstVertexes.resize(instanceCount);
+	m_fadingInstances.clear();
+	size_t vertexCount = 0;
+	for (int instanceIndex = 0; instanceIndex < instanceCount; instanceIndex++) {
+		m_firstVertexes[instanceIndex] = vertexCount;
+		vertexCount += unitMeshes[m_meshIndexes[instanceIndex]].size();
+		if (IsFading(instanceIndex)) {
+			m_fadingInstances.push_back(instanceIndex);
+		}
+	}
+	m_vertexes.resize(vertexCount);
+
+	Vertex_PCU* vertexes = m_vertexes.data();
+	auto expandInstances = [&](int beginIndex, int endIndex) {
+		for (int instanceIndex = beginIndex; instanceIndex < endIndex; instanceIndex++) {
+			Rgba8 color = GetColorAtTime(instanceIndex, currentTime);
+
+			// Copied out of the matrix so the vertex stores can't make the compiler reload it
+			Mat44 const& transform = m_transforms[instanceIndex];
+			float const ix = transform.m_values[Mat44::Ix], iy = transform.m_values[Mat44::Iy], iz = transform.m_values[Mat44::Iz];
+			float const jx = transform.m_values[Mat44::Jx], jy = transform.m_values[Mat44::Jy], jz = transform.m_values[Mat44::Jz];
+			float const kx = transform.m_values[Mat44::Kx], ky = transform.m_values[Mat44::Ky], kz = transform.m_values[Mat44::Kz];
+			float const tx = transform.m_values[Mat44::Tx], ty = transform.m_values[Mat44::Ty], tz = transform.m_values[Mat44::Tz];
+
+			std::vector<Vertex_PCU> const& unitMesh = unitMeshes[m_meshIndexes[instanceIndex]];
+			Vertex_PCU* outVertex = vertexes + m_firstVertexes[instanceIndex];
+			for (Vertex_PCU const& unitVertex : unitMesh) {
+				float const x = unitVertex.m_position.x;
+				float const y = unitVertex.m_position.y;
+				float const z = unitVertex.m_position.z;
+				outVertex->m_position.x = ix * x + jx * y + kx * z + tx;
+				outVertex->m_position.y = iy * x + jy * y + ky * z + ty;
+				outVertex->m_position.z = iz * x + jz * y + kz * z + tz;
+				outVertex->m_color = color;
+				outVertex->m_uvTexCoords = unitVertex.m_uvTexCoords;
+				outVertex++;
+			}
+		}
+	};
+
+	if (g_theJobSystem && (instanceCount > DEBUG_INSTANCE_MIN_INSTANCES_PER_JOB)) {
+		g_theJobSystem->ParallelFor(instanceCount, DEBUG_INSTANCE_MIN_INSTANCES_PER_JOB, expandInstances);
+	}
+	else {
+		expandInstances(0, instanceCount);
+	}
+}
+
+// Positions don't change between expansions, only the colors of the instances that fade
+void DebugInstanceBatch::TintFadingInstances(std::vector<std::vector<Vertex_PCU>> const& unitMeshes, float currentTime) const
+{
+	Vertex_PCU* vertexes = m_vertexes.data();
+	auto tintInstances = [&](int beginIndex, int endIndex) {
+		for (int fadingIndex = beginIndex; fadingIndex < endIndex; fadingIndex++) {
+			int instanceIndex = m_fadingInstances[fadingIndex];
+			Rgba8 color = GetColorAtTime(instanceIndex, currentTime);
+			Vertex_PCU* firstVertex = vertexes + m_firstVertexes[instanceIndex];
+			Vertex_PCU* endVertex = firstVertex + unitMeshes[m_meshIndexes[instanceIndex]].size();
+			for (Vertex_PCU* vertex = firstVertex; vertex < endVertex; vertex++) {
+				vertex->m_color = color;
+			}
+		}
+	};
+
+	int fadingCount = (int)m_fadingInstances.size();
+	if (g_theJobSystem && (fadingCount > DEBUG_INSTANCE_MIN_INSTANCES_PER_JOB)) {
+		g_theJobSystem->ParallelFor(fadingCount, DEBUG_INSTANCE_MIN_INSTANCES_PER_JOB, tintInstances);
+	}
+	else {
+		tintInstances(0, fadingCount);
+	}
+}
+
+// A duration of FLT_MAX never gets past its start color, and a zero duration shape is gone after one frame
+bool DebugInstanceBatch::IsFading(int instanceIndex) const
+{
+	float duration = m_durations[instanceIndex];
+	return (duration > 0.0f) && (duration < FLT_MAX) && !(m_startColors[instanceIndex] == m_endColors[instanceIndex]);
+}
+
+// Same fade as Stopwatch::GetElapsedFraction, a zero duration shape keeps its start color
+Rgba8 DebugInstanceBatch::GetColorAtTime(int instanceIndex, float currentTime) const
+{
+	float duration = m_durations[instanceIndex];
+	float elapsedFraction = (duration > 0.0f) ? (currentTime - m_startTimes[instanceIndex]) / duration : 0.0f;
+	return Rgba8::InterpolateColors(m_startColors[instanceIndex], m_endColors[instanceIndex], elapsedFraction);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include <vector>
+
+constexpr int DEBUG_INSTANCE_MIN_INSTANCES_PER_JOB = 256;
+
+/// <summary>
+/// Debug primitives drawn as copies of shared unit meshes: each instance only keeps the mesh it uses, its transform, its
+/// start and end colors and its lifetime, every field in its own array. UpdateVertexes moves and tints the unit mesh of every
+/// instance into a single vertex array the batch keeps, so a whole render mode is one draw no matter how many primitives it has.
+/// Lifetimes are in seconds of the debug clock, the expiry sweep compares 4 instances per instruction
+/// </summary>
+class DebugInstanceBatch {
+public:
+	// Unit meshes are white, the instance color becomes the vertex color. A duration of FLT_MAX never expires
+	void AddInstance(int meshIndex, Mat44 const& transform, Rgba8 const& startColor, Rgba8 const& endColor, float startTime, float duration);
+	void RemoveExpired(float currentTime);
+	void Clear();
+
+	int GetInstanceCount() const { return (int)m_meshIndexes.size(); }
+	// Returns how many vertexes the batch's stream has. The stream is only expanded again after instances were added or
+	// removed, otherwise just the colors of fading instances are rewritten. Large batches are expanded across the JobSystem
+	int UpdateVertexes(std::vector<std::vector<Vertex_PCU>> const& unitMeshes, float currentTime) const;
+	Vertex_PCU const* GetVertexes() const { return m_vertexes.data(); }
+
+private:
+	void MoveInstance(int fromIndex, int toIndex);
+	void ExpandInstances(std::vector<std::vector<Vertex_PCU>> const& unitMeshes, float currentTime) const;
+	void TintFadingInstances(std::vector<std::vector<Vertex_PCU>> const& unitMeshes, float currentTime) const;
+	bool IsFading(int instanceIndex) const;
+	Rgba8 GetColorAtTime(int instanceIndex, float currentTime) const;
+
+private:
+	std::vector<int> m_meshIndexes;
+	std::vector<Mat44> m_transforms;
+	std::vector<Rgba8> m_startColors;
+	std::vector<Rgba8> m_endColors;
+	std::vector<float> m_startTimes;
+	std::vector<float> m_durations;
+
+	// Cached expansion, rebuilt by UpdateVertexes once m_isExpansionStale is set
+	mutable std::vector<Vertex_PCU> m_vertexes;
+	mutable std::vector<size_t> m_firstVertexes; // First vertex of each instance in m_vertexes
+	mutable std::vector<int> m_fadingInstances; // Instances whose color changes with time, tinted again every update
+	mutable bool m_isExpansionStale = false;
+};
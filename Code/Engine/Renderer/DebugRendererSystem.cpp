@@ -1,12 +1,19 @@
 #include "Engine/Renderer/DebugRendererSystem.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Core/VertexUtils.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/MathUtils.hpp"
 #include "Engine/Renderer/DebugShape.hpp"
 #include "Engine/Core/Clock.hpp"
 #include "Engine/Renderer/Billboard.hpp"
 #include "Engine/Renderer/BitmapFont.hpp"
+#include "Engine/Renderer/TextLayoutCache.hpp"
+#include "Engine/Renderer/DebugInstanceBatch.hpp"
+#include "Engine/Renderer/DebugCommandBuffer.hpp"
 #include <vector>
 
+// DebugAdd* calls from any thread only go in the calling thread's command buffer. Everything below is owned by the thread
+// that renders: the buffers are merged into it when the frame begins and before each pass, so it needs no locks
 class DebugRenderSystem {
 public:
 	DebugRenderSystem(DebugRenderConfig debugSystemConfig);
@@ -15,15 +22,18 @@ public:
 	void Shutdown();
 	void Clear();
 	void CheckAllShapes();
+	void MergeCommandBuffers();
 
 	void RenderWorldShapes(Camera const& camera) const;
 	void RenderScreenShapes(Camera const& camera) const;
-	void AddShape(DebugShape* newShape);
-	void AddWireShape(DebugShape* newShape);
-	void AddBillboard(DebugShape* newShape);
 	void SetRenderModes(DebugRenderMode renderMode) const;
 	BitmapFont* GetBitmapFont() const;
 
+	// Safe from any thread
+	void SubmitInstance(DebugRenderMode mode, DebugUnitMeshKey const& meshKey, Mat44 const& transform, Rgba8 startColor, Rgba8 endColor, float duration, bool isWire = false);
+	void SubmitShape(DebugShape* newShape, bool isBillboard = false);
+	float GetInstanceTime() const;
+
 	Clock const& GetClock() const { return m_clock; }
 	void SetTimeDilation(double timeDilation) { m_clock.SetTimeDilation(timeDilation); }
 public:
@@ -31,31 +41,37 @@ public:
 	Clock m_clock;
 
 private:
+	void AddShape(DebugShape* newShape);
+	void AddBillboard(DebugShape* newShape);
+	int GetOrCreateUnitMesh(DebugUnitMeshKey const& meshKey);
+	// Wire instances are all drawn with the depth material, like the wireframe shapes were
+	void AddInstance(DebugRenderMode mode, int meshIndex, Mat44 const& transform, Rgba8 startColor, Rgba8 endColor, float startTime, float duration, bool isWire);
+
 	void RenderWireframeShapes(Renderer* renderer) const;
 	void RenderBillboardShapes(Renderer* renderer, Camera const& camera) const;
 	void RenderDebugShapes(Renderer* renderer) const;
+	void RenderInstances(Renderer* renderer, DebugInstanceBatch const& instances) const;
 	void RenderTextDebugShapes(Renderer* renderer) const;
 	void RenderFreeScreenText(Renderer* renderer) const;
 	void RenderTextMessages(Renderer* renderer, Camera const& camera) const;
 private:
-	mutable std::mutex m_debugShapesMutex[(int)DebugRenderMode::NUM_DEBUG_RENDER_MODES];
-	std::vector<DebugShape*> m_debugShapes[(int)DebugRenderMode::NUM_DEBUG_RENDER_MODES];
+	DebugInstanceBatch m_instanceBatches[(int)DebugRenderMode::NUM_DEBUG_RENDER_MODES];
+	DebugInstanceBatch m_wireInstances;
 
-	mutable std::mutex m_debugTextShapesMutex[(int)DebugRenderMode::NUM_DEBUG_RENDER_MODES];
-	std::vector<DebugShape*> m_debugTextShapes[(int)DebugRenderMode::NUM_DEBUG_RENDER_MODES];
+	std::vector<DebugUnitMeshKey> m_unitMeshKeys;
+	std::vector<std::vector<Vertex_PCU>> m_unitMeshes;
+	double m_instanceTimeOrigin = 0.0; // Instance times are float seconds since Startup, so they keep their precision
 
-	mutable std::mutex m_wireFrameShapesMutex;
-	std::vector<DebugShape*> m_wireframeShapes;
+	std::vector<DebugCommandBuffer*> m_commandBuffers; // Scratch for merging, keeps its memory
 
-	mutable std::mutex m_billboardsMutex;
+	std::vector<DebugShape*> m_debugTextShapes[(int)DebugRenderMode::NUM_DEBUG_RENDER_MODES];
 	std::vector<DebugShape*> m_billboards;
-
-	mutable std::mutex m_screenTextShapesMutex[(int)ScrenTextType::NUM_SCREEN_TEXT_TYPES];
 	std::vector<DebugShape*> m_screnTextShapes[(int)ScrenTextType::NUM_SCREEN_TEXT_TYPES];
 
 	DebugRenderConfig m_config;
 
 	Material* m_materials[(int)DebugRenderMode::NUM_DEBUG_RENDER_MODES] = {};
+	mutable TextLayoutCache m_textLayoutCache; // Screen messages keep their layout while they stay on screen, only their fading color changes
 };
 
 
@@ -73,55 +89,21 @@ DebugRenderSystem::~DebugRenderSystem()
 void DebugRenderSystem::Startup()
 {
 	int reserveSize = 100;
+	m_instanceTimeOrigin = m_clock.GetTotalTime();
 
 	for (int debugRenderTypeIndex = 0; debugRenderTypeIndex < (int)DebugRenderMode::NUM_DEBUG_RENDER_MODES; debugRenderTypeIndex++) {
-		std::mutex& listMutex = m_debugShapesMutex[debugRenderTypeIndex];
-
-		listMutex.lock();
-
-		std::vector<DebugShape*>& debugShapeList = m_debugShapes[debugRenderTypeIndex];
-		debugShapeList.reserve(reserveSize);
-
-		listMutex.unlock();
+		m_debugTextShapes[debugRenderTypeIndex].reserve(reserveSize);
 	}
 
-	for (int debugRenderTypeIndex = 0; debugRenderTypeIndex < (int)DebugRenderMode::NUM_DEBUG_RENDER_MODES; debugRenderTypeIndex++) {
-		std::mutex& listMutex = m_debugTextShapesMutex[debugRenderTypeIndex];
-
-		listMutex.lock();
-
-		std::vector<DebugShape*>& debugShapeList = m_debugTextShapes[debugRenderTypeIndex];
-		debugShapeList.reserve(reserveSize);
-
-		listMutex.unlock();
-	}
-
-
-	m_wireFrameShapesMutex.lock();
-
-	m_wireframeShapes.reserve(reserveSize);
-
-	m_wireFrameShapesMutex.unlock();
-
-
-	m_billboardsMutex.lock();
-
 	m_billboards.reserve(reserveSize);
-
 	m_billboards.clear();
 
-	m_billboardsMutex.unlock();
-
 	for (int screenShapeType = 0; screenShapeType < (int)ScrenTextType::NUM_SCREEN_TEXT_TYPES; screenShapeType++) {
-		std::mutex& listMutex = m_screenTextShapesMutex[screenShapeType];
-		listMutex.lock();
-
-		std::vector<DebugShape*>& debugShapeList = m_screnTextShapes[screenShapeType];
-		debugShapeList.reserve(reserveSize);
-
-		listMutex.unlock();
+		m_screnTextShapes[screenShapeType].reserve(reserveSize);
 	}
 
+	// Buffers outlive the system, commands left from a previous one are dropped
+	Clear();
 
 	std::string enginePath = ENGINE_MAT_DIR;
 	m_materials[(int)DebugRenderMode::ALWAYS] = m_config.m_renderer->CreateOrGetMaterial(enginePath + "DebugAlwaysMaterial");
@@ -136,30 +118,17 @@ void DebugRenderSystem::Shutdown()
 
 void DebugRenderSystem::Clear()
 {
+	// Commands not merged yet go too
+	GetAllDebugCommandBuffers(m_commandBuffers);
+	for (DebugCommandBuffer* commandBuffer : m_commandBuffers) {
+		commandBuffer->Drain([](DebugRenderCommand const& command) { delete command.m_shape; });
+	}
 
 	for (int debugRenderTypeIndex = 0; debugRenderTypeIndex < (int)DebugRenderMode::NUM_DEBUG_RENDER_MODES; debugRenderTypeIndex++) {
-		std::mutex& listMutex = m_debugShapesMutex[debugRenderTypeIndex];
-
-		listMutex.lock();
-
-		std::vector<DebugShape*>& debugShapeList = m_debugShapes[debugRenderTypeIndex];
-		for (int shapeIndex = 0; shapeIndex < debugShapeList.size(); shapeIndex++) {
-			DebugShape*& shape = debugShapeList[shapeIndex];
-			if (shape) {
-				delete shape;
-				shape = nullptr;
-			}
-		}
-		debugShapeList.clear();
-
-		listMutex.unlock();
+		m_instanceBatches[debugRenderTypeIndex].Clear();
 	}
 
 	for (int debugRenderTypeIndex = 0; debugRenderTypeIndex < (int)DebugRenderMode::NUM_DEBUG_RENDER_MODES; debugRenderTypeIndex++) {
-		std::mutex& listMutex = m_debugTextShapesMutex[debugRenderTypeIndex];
-
-		listMutex.lock();
-
 		std::vector<DebugShape*>& debugShapeList = m_debugTextShapes[debugRenderTypeIndex];
 		for (int shapeIndex = 0; shapeIndex < debugShapeList.size(); shapeIndex++) {
 			DebugShape*& shape = debugShapeList[shapeIndex];
@@ -169,27 +138,9 @@ void DebugRenderSystem::Clear()
 			}
 		}
 		debugShapeList.clear();
-
-		listMutex.unlock();
 	}
 
-
-	m_wireFrameShapesMutex.lock();
-
-	for (int shapeIndex = 0; shapeIndex < m_wireframeShapes.size(); shapeIndex++) {
-
-		DebugShape*& shape = m_wireframeShapes[shapeIndex];
-		if (shape) {
-			delete shape;
-			shape = nullptr;
-		}
-	}
-	m_wireframeShapes.clear();
-
-	m_wireFrameShapesMutex.unlock();
-
-
-	m_billboardsMutex.lock();
+	m_wireInstances.Clear();
 
 	for (int shapeIndex = 0; shapeIndex < m_billboards.size(); shapeIndex++) {
 		DebugShape*& shape = m_billboards[shapeIndex];
@@ -200,12 +151,7 @@ void DebugRenderSystem::Clear()
 	}
 	m_billboards.clear();
 
-	m_billboardsMutex.unlock();
-
 	for (int screenShapeType = 0; screenShapeType < (int)ScrenTextType::NUM_SCREEN_TEXT_TYPES; screenShapeType++) {
-		std::mutex& listMutex = m_screenTextShapesMutex[screenShapeType];
-		listMutex.lock();
-
 		std::vector<DebugShape*>& debugShapeList = m_screnTextShapes[screenShapeType];
 		for (int shapeIndex = 0; shapeIndex < debugShapeList.size(); shapeIndex++) {
 			DebugShape*& shape = debugShapeList[shapeIndex];
@@ -215,39 +161,20 @@ void DebugRenderSystem::Clear()
 			}
 		}
 		debugShapeList.clear();
-
-		listMutex.unlock();
 	}
 
 }
 
 void DebugRenderSystem::CheckAllShapes()
 {
+	m_textLayoutCache.AdvanceFrame();
 
+	float instanceTime = GetInstanceTime();
 	for (int debugRenderTypeIndex = 0; debugRenderTypeIndex < (int)DebugRenderMode::NUM_DEBUG_RENDER_MODES; debugRenderTypeIndex++) {
-		std::mutex& listMutex = m_debugShapesMutex[debugRenderTypeIndex];
-
-		std::vector<DebugShape*>& debugShapeList = m_debugShapes[debugRenderTypeIndex];
-
-		listMutex.lock();
-		for (int shapeIndex = 0; shapeIndex < debugShapeList.size(); shapeIndex++) {
-			DebugShape*& shape = debugShapeList[shapeIndex];
-			if (shape) {
-				if (shape->CanShapeBeDeleted()) {
-					delete shape;
-					shape = nullptr;
-				}
-			}
-		}
-		listMutex.unlock();
-
+		m_instanceBatches[debugRenderTypeIndex].RemoveExpired(instanceTime);
 	}
 
 	for (int debugRenderTypeIndex = 0; debugRenderTypeIndex < (int)DebugRenderMode::NUM_DEBUG_RENDER_MODES; debugRenderTypeIndex++) {
-
-		std::mutex& listMutex = m_debugTextShapesMutex[debugRenderTypeIndex];
-
-		listMutex.lock();
 		std::vector<DebugShape*>& debugShapeList = m_debugTextShapes[debugRenderTypeIndex];
 
 		for (int shapeIndex = 0; shapeIndex < debugShapeList.size(); shapeIndex++) {
@@ -259,25 +186,9 @@ void DebugRenderSystem::CheckAllShapes()
 				}
 			}
 		}
-
-		listMutex.unlock();
 	}
 
-	m_wireFrameShapesMutex.lock();
-
-	for (int shapeIndex = 0; shapeIndex < m_wireframeShapes.size(); shapeIndex++) {
-		DebugShape*& shape = m_wireframeShapes[shapeIndex];
-		if (shape) {
-			if (shape->CanShapeBeDeleted()) {
-				delete shape;
-				shape = nullptr;
-			}
-		}
-	}
-
-	m_wireFrameShapesMutex.unlock();
-
-	m_billboardsMutex.lock();
+	m_wireInstances.RemoveExpired(instanceTime);
 
 	for (int shapeIndex = 0; shapeIndex < m_billboards.size(); shapeIndex++) {
 		DebugShape*& shape = m_billboards[shapeIndex];
@@ -289,13 +200,7 @@ void DebugRenderSystem::CheckAllShapes()
 		}
 	}
 
-	m_billboardsMutex.unlock();
-
 	for (int screenTextTypeIndex = 0; screenTextTypeIndex < (int)ScrenTextType::NUM_SCREEN_TEXT_TYPES; screenTextTypeIndex++) {
-
-		std::mutex& listMutex = m_screenTextShapesMutex[screenTextTypeIndex];
-		listMutex.lock();
-
 		std::vector<DebugShape*>& debugShapeList = m_screnTextShapes[screenTextTypeIndex];
 		for (int shapeIndex = 0; shapeIndex < debugShapeList.size(); shapeIndex++) {
 			DebugShape*& shape = debugShapeList[shapeIndex];
@@ -306,12 +211,35 @@ void DebugRenderSystem::CheckAllShapes()
 				}
 			}
 		}
-
-		listMutex.unlock();
 	}
 
 }
 
+// Commands of a thread stay in the order it sent them, threads are merged one after the other
+void DebugRenderSystem::MergeCommandBuffers()
+{
+	auto mergeCommand = [this](DebugRenderCommand const& command) {
+		switch (command.m_type)
+		{
+		case DebugCommandType::INSTANCE:
+		case DebugCommandType::WIRE_INSTANCE:
+			AddInstance(command.m_mode, GetOrCreateUnitMesh(command.m_meshKey), command.m_transform, command.m_startColor, command.m_endColor, command.m_startTime, command.m_duration, command.m_type == DebugCommandType::WIRE_INSTANCE);
+			break;
+		case DebugCommandType::SHAPE:
+			AddShape(command.m_shape);
+			break;
+		case DebugCommandType::BILLBOARD:
+			AddBillboard(command.m_shape);
+			break;
+		}
+	};
+
+	GetAllDebugCommandBuffers(m_commandBuffers);
+	for (DebugCommandBuffer* commandBuffer : m_commandBuffers) {
+		commandBuffer->Drain(mergeCommand);
+	}
+}
+
 void DebugRenderSystem::RenderWorldShapes(Camera const& camera) const
 {
 	if (!m_isVisible) return;
@@ -333,21 +261,7 @@ void DebugRenderSystem::RenderWorldShapes(Camera const& camera) const
 void DebugRenderSystem::RenderWireframeShapes(Renderer* renderer) const
 {
 	SetRenderModes(DebugRenderMode::USEDEPTH);
-
-	m_wireFrameShapesMutex.lock();
-
-	//#TODO DX12 FIXTHIS
-
-	for (int shapeIndex = 0; shapeIndex < m_wireframeShapes.size(); shapeIndex++) {
-		DebugShape* const shape = m_wireframeShapes[shapeIndex];
-		if (shape) {
-			renderer->SetModelMatrix(shape->GetModelMatrix());
-			renderer->SetModelColor(shape->GetModelColor());
-			shape->Render(renderer);
-		}
-	}
-
-	m_wireFrameShapesMutex.unlock();
+	RenderInstances(renderer, m_wireInstances);
 }
 
 void DebugRenderSystem::RenderBillboardShapes(Renderer* renderer, Camera const& camera) const
@@ -359,8 +273,6 @@ void DebugRenderSystem::RenderBillboardShapes(Renderer* renderer, Camera const&
 
 	renderer->BindTexture(&font->GetTexture());
 
-	m_billboardsMutex.lock();
-
 	for (int shapeIndex = 0; shapeIndex < m_billboards.size(); shapeIndex++) {
 		DebugShape* const shape = m_billboards[shapeIndex];
 		if (!shape) continue;
@@ -371,41 +283,34 @@ void DebugRenderSystem::RenderBillboardShapes(Renderer* renderer, Camera const&
 		shape->Render(renderer);
 	}
 
-	m_billboardsMutex.unlock();
-
 }
 
 void DebugRenderSystem::RenderDebugShapes(Renderer* renderer) const
 {
 	for (int debugRenderTypeIndex = 0; debugRenderTypeIndex < (int)DebugRenderMode::NUM_DEBUG_RENDER_MODES; debugRenderTypeIndex++) {
 
-		std::mutex& listMutex = m_debugShapesMutex[debugRenderTypeIndex];
-
-		listMutex.lock();
-
-		std::vector<DebugShape*>const& debugShapeList = m_debugShapes[debugRenderTypeIndex];
 		SetRenderModes((DebugRenderMode)debugRenderTypeIndex);
+		RenderInstances(renderer, m_instanceBatches[debugRenderTypeIndex]);
+	}
+}
 
-		for (int shapeIndex = 0; shapeIndex < (int)debugShapeList.size(); shapeIndex++) {
-			DebugShape* const shape = debugShapeList[shapeIndex];
-			if (shape) {
-				renderer->SetModelMatrix(shape->GetModelMatrix());
-				renderer->SetModelColor(shape->GetModelColor());
-				shape->Render(renderer);
-			}
-		}
+// The whole batch is one vertex stream already in world space with its colors baked in, drawn once. The batch keeps the
+// stream between frames, so persistent shapes are not transformed again
+void DebugRenderSystem::RenderInstances(Renderer* renderer, DebugInstanceBatch const& instances) const
+{
+	int vertexCount = instances.UpdateVertexes(m_unitMeshes, GetInstanceTime());
+	if (vertexCount == 0) return;
 
-		listMutex.unlock();
-	}
+	renderer->SetModelMatrix(Mat44());
+	renderer->SetModelColor(Rgba8::WHITE);
+	renderer->BindTexture(nullptr);
+	renderer->DrawVertexArray((unsigned int)vertexCount, instances.GetVertexes());
 }
 
 void DebugRenderSystem::RenderTextDebugShapes(Renderer* renderer) const
 {
 	for (int debugRenderTypeIndex = 0; debugRenderTypeIndex < (int)DebugRenderMode::NUM_DEBUG_RENDER_MODES; debugRenderTypeIndex++) {
 
-		std::mutex& listMutex = m_debugTextShapesMutex[debugRenderTypeIndex];
-		listMutex.lock();
-
 		std::vector<DebugShape*>const& debugShapeList = m_debugTextShapes[debugRenderTypeIndex];
 		SetRenderModes((DebugRenderMode)debugRenderTypeIndex);
 		//#TODO DX12 FIXTHIS
@@ -418,8 +323,6 @@ void DebugRenderSystem::RenderTextDebugShapes(Renderer* renderer) const
 				shape->Render(renderer);
 			}
 		}
-
-		listMutex.unlock();
 	}
 }
 
@@ -444,10 +347,6 @@ void DebugRenderSystem::RenderScreenShapes(Camera const& camera) const
 
 void DebugRenderSystem::RenderFreeScreenText(Renderer* renderer) const
 {
-	std::mutex& listMutex = m_screenTextShapesMutex[(int)ScrenTextType::FreeText];
-	listMutex.lock();
-
-
 	std::vector<DebugShape*>const& debugShapeList = m_screnTextShapes[(int)ScrenTextType::FreeText];
 	for (int shapeIndex = 0; shapeIndex < debugShapeList.size(); shapeIndex++) {
 		DebugShape const* shape = debugShapeList[shapeIndex];
@@ -458,8 +357,6 @@ void DebugRenderSystem::RenderFreeScreenText(Renderer* renderer) const
 			shape->Render(renderer);
 		}
 	}
-
-	listMutex.unlock();
 }
 
 void DebugRenderSystem::RenderTextMessages(Renderer* renderer, Camera const& camera) const
@@ -473,9 +370,6 @@ void DebugRenderSystem::RenderTextMessages(Renderer* renderer, Camera const& cam
 	float minGroupTextHeight = bounds.m_maxs.y;
 	float maxLinesShown = 21.5f;
 
-	std::mutex& listMutex = m_screenTextShapesMutex[(int)ScrenTextType::ScreenMessage];
-	listMutex.lock();
-
 	std::vector<DebugShape*> const& textShapes = m_screnTextShapes[(int)ScrenTextType::ScreenMessage];
 
 	std::vector<Vertex_PCU> textVerts;
@@ -495,11 +389,10 @@ void DebugRenderSystem::RenderTextMessages(Renderer* renderer, Camera const& cam
 
 		lineAABB2.m_mins.y = minGroupTextHeight - ((renderLineIndex) * (cellHeight * 2.0f));
 		Rgba8 textColor = Rgba8::InterpolateColors(shape->m_startColor, shape->m_endColor, shape->m_stopwach.GetElapsedFraction());
-		font->AddVertsForTextInBox2D(textVerts, lineAABB2, cellHeight, shape->m_text, textColor);
+		m_textLayoutCache.AddVertsForTextInBox2D(textVerts, *font, lineAABB2, cellHeight, shape->m_text, textColor);
 		renderLineIndex++;
 	}
 
-	listMutex.unlock();
 	//#TODO DX12 FIXTHIS
 
 	renderer->BindTexture(&font->GetTexture());
@@ -524,71 +417,99 @@ void DebugRenderSystem::AddShape(DebugShape* newShape)
 	}
 
 
-	std::mutex& debugShapeListMutex = m_debugShapesMutex[(int)newShape->m_debugRenderMode];
-	debugShapeListMutex.lock();																// lock
-
-	std::vector<DebugShape*>& debugShapeList = m_debugShapes[(int)newShape->m_debugRenderMode];
-
-	std::mutex& textDebugMutex = m_debugTextShapesMutex[(int)newShape->m_debugRenderMode];
-	textDebugMutex.lock();																	// lock
-
-	std::vector<DebugShape*>& textDebugShapeList = m_debugTextShapes[(int)newShape->m_debugRenderMode];
-
-	std::vector<DebugShape*>& usedDebugShapeList = (newShape->m_isWorldText) ? textDebugShapeList : debugShapeList;
-
-
-	std::mutex& screenTextMutex = m_screenTextShapesMutex[(int)newShape->m_screenTextType];
-	screenTextMutex.lock();																	// lock
-
-	std::vector<DebugShape*>& screnTextShapeList = m_screnTextShapes[(int)newShape->m_screenTextType];
-
-	std::vector<DebugShape*>& usedShapeList = (newShape->m_isWorldShape) ? usedDebugShapeList : screnTextShapeList;
+	// Only text is still kept as shapes, every other primitive is an instance
+	std::vector<DebugShape*>& usedShapeList = (newShape->m_isWorldShape) ? m_debugTextShapes[(int)newShape->m_debugRenderMode] : m_screnTextShapes[(int)newShape->m_screenTextType];
 
 	for (int shapeIndex = 0; shapeIndex < (int)usedShapeList.size(); shapeIndex++) {
 		DebugShape*& shape = usedShapeList[shapeIndex];
 		if (!shape) {
 			shape = newShape;
-
-			debugShapeListMutex.unlock();
-			textDebugMutex.unlock();
-			screenTextMutex.unlock();
-
-
 			return;
 		}
 	}
 	usedShapeList.push_back(newShape);
-
-
-	debugShapeListMutex.unlock();
-	textDebugMutex.unlock();
-	screenTextMutex.unlock();
 }
 
-void DebugRenderSystem::AddWireShape(DebugShape* newShape)
+int DebugRenderSystem::GetOrCreateUnitMesh(DebugUnitMeshKey const& meshKey)
 {
-	if (newShape->m_stopwach.m_duration == -1.0f) {
-		newShape->m_stopwach.m_duration = FLT_MAX;
+	for (int meshIndex = 0; meshIndex < (int)m_unitMeshKeys.size(); meshIndex++) {
+		DebugUnitMeshKey const& key = m_unitMeshKeys[meshIndex];
+		if ((key.m_type == meshKey.m_type) && (key.m_stacks == meshKey.m_stacks) && (key.m_slices == meshKey.m_slices)) return meshIndex;
 	}
 
-	m_wireFrameShapesMutex.lock();
+	int stacks = meshKey.m_stacks;
+	int slices = meshKey.m_slices;
 
-	for (int shapeIndex = 0; shapeIndex < m_wireframeShapes.size(); shapeIndex++) {
-		DebugShape*& shape = m_wireframeShapes[shapeIndex];
-		if (!shape) {
-			shape = newShape;
-			m_wireFrameShapesMutex.unlock();
-			return;
-		}
+	std::vector<Vertex_PCU> unitVerts;
+	switch (meshKey.m_type)
+	{
+	case DebugUnitMeshType::SPHERE:
+		AddVertsForSphere(unitVerts, 1.0f, stacks, slices);
+		break;
+	case DebugUnitMeshType::WIRE_SPHERE:
+		AddVertsForWireSphere(unitVerts, 1.0f, stacks, slices);
+		break;
+	case DebugUnitMeshType::CYLINDER:
+		AddVertsForCylinder(unitVerts, Vec3::ZERO, Vec3(0.0f, 0.0f, 1.0f), 1.0f, slices);
+		break;
+	case DebugUnitMeshType::ARROW:
+		AddVertsForArrow3D(unitVerts, Vec3::ZERO, Vec3(0.0f, 0.0f, 1.0f), 1.0f, slices);
+		break;
+	case DebugUnitMeshType::BOX:
+		AddVertsForAABB3D(unitVerts, AABB3(Vec3::ZERO, Vec3(1.0f, 1.0f, 1.0f)));
+		break;
+	default:
+		break;
 	}
-	m_wireframeShapes.push_back(newShape);
-	m_wireFrameShapesMutex.unlock();
 
-	if (newShape->m_debugRenderMode == DebugRenderMode::XRAY) {
-		DebugShape* solidShape = new DebugShape(*newShape);
-		solidShape->m_debugRenderMode = DebugRenderMode::USEDEPTH;
-		AddWireShape(solidShape);
+	m_unitMeshKeys.push_back(meshKey);
+	m_unitMeshes.push_back(std::move(unitVerts));
+	return (int)m_unitMeshes.size() - 1;
+}
+
+void DebugRenderSystem::AddInstance(DebugRenderMode mode, int meshIndex, Mat44 const& transform, Rgba8 startColor, Rgba8 endColor, float startTime, float duration, bool isWire)
+{
+	if (isWire) {
+		m_wireInstances.AddInstance(meshIndex, transform, startColor, endColor, startTime, duration);
+		return;
+	}
+
+	// X-ray draws the shape solid where it is visible and faded where it is hidden
+	if (mode == DebugRenderMode::XRAY) {
+		m_instanceBatches[(int)DebugRenderMode::USEDEPTH].AddInstance(meshIndex, transform, startColor, endColor, startTime, duration);
+		startColor.a = 120;
+		endColor.a = 120;
 	}
+
+	m_instanceBatches[(int)mode].AddInstance(meshIndex, transform, startColor, endColor, startTime, duration);
+}
+
+// The start time is taken here, so a command merged a frame later still fades from when it was sent
+void DebugRenderSystem::SubmitInstance(DebugRenderMode mode, DebugUnitMeshKey const& meshKey, Mat44 const& transform, Rgba8 startColor, Rgba8 endColor, float duration, bool isWire)
+{
+	DebugRenderCommand newCommand;
+	newCommand.m_type = (isWire) ? DebugCommandType::WIRE_INSTANCE : DebugCommandType::INSTANCE;
+	newCommand.m_mode = mode;
+	newCommand.m_meshKey = meshKey;
+	newCommand.m_transform = transform;
+	newCommand.m_startColor = startColor;
+	newCommand.m_endColor = endColor;
+	newCommand.m_startTime = GetInstanceTime();
+	newCommand.m_duration = (duration == -1.0f) ? FLT_MAX : duration;
+	GetThreadDebugCommandBuffer()->Push(newCommand);
+}
+
+void DebugRenderSystem::SubmitShape(DebugShape* newShape, bool isBillboard)
+{
+	DebugRenderCommand newCommand;
+	newCommand.m_type = (isBillboard) ? DebugCommandType::BILLBOARD : DebugCommandType::SHAPE;
+	newCommand.m_shape = newShape;
+	GetThreadDebugCommandBuffer()->Push(newCommand);
+}
+
+float DebugRenderSystem::GetInstanceTime() const
+{
+	return (float)(m_clock.GetTotalTime() - m_instanceTimeOrigin);
 }
 
 void DebugRenderSystem::AddBillboard(DebugShape* newShape)
@@ -597,19 +518,14 @@ void DebugRenderSystem::AddBillboard(DebugShape* newShape)
 		newShape->m_stopwach.m_duration = FLT_MAX;
 	}
 
-	m_billboardsMutex.lock();
-
 	for (int shapeIndex = 0; shapeIndex < m_billboards.size(); shapeIndex++) {
 		DebugShape*& shape = m_billboards[shapeIndex];
 		if (!shape) {
 			shape = newShape;
-			m_billboardsMutex.unlock();
 			return;
 		}
 	}
 	m_billboards.push_back(newShape);
-
-	m_billboardsMutex.unlock();
 }
 
 void DebugRenderSystem::SetRenderModes(DebugRenderMode renderMode) const
@@ -683,15 +599,19 @@ Clock const& DebugRenderGetClock()
 
 void DebugRenderBeginFrame()
 {
+	debugRenderSystem->MergeCommandBuffers();
 }
 
+// Merging again here lets what was sent during the frame draw in that frame, like it did when every call took a lock
 void DebugRenderWorld(const Camera& camera)
 {
+	debugRenderSystem->MergeCommandBuffers();
 	debugRenderSystem->RenderWorldShapes(camera);
 }
 
 void DebugRenderScreen(const Camera& camera)
 {
+	debugRenderSystem->MergeCommandBuffers();
 	debugRenderSystem->RenderScreenShapes(camera);
 }
 
@@ -700,74 +620,77 @@ void DebugRenderEndFrame()
 	debugRenderSystem->CheckAllShapes();
 }
 
+namespace {
+	// Same frame AddVertsForCylinder builds around a segment, so a unit mesh lands where the per shape mesh used to be
+	Mat44 GetSegmentTransform(Vec3 const& start, Vec3 const& end, float radius)
+	{
+		Vec3 segment = end - start;
+		Vec3 kBasis = segment.GetNormalized();
+		Vec3 worldIBasis = Vec3(1.0f, 0.0f, 0.0f);
+		Vec3 worldJBasis = Vec3(0.0f, 1.0f, 0.0f);
+
+		Vec3 jBasis = (fabsf(DotProduct3D(kBasis, worldIBasis)) < 1) ? CrossProduct3D(kBasis, worldIBasis).GetNormalized() : CrossProduct3D(kBasis, worldJBasis).GetNormalized();
+		Vec3 iBasis = CrossProduct3D(jBasis, kBasis).GetNormalized();
+		return Mat44(iBasis * radius, jBasis * radius, segment, start);
+	}
+
+	Mat44 GetScaleTranslationTransform(Vec3 const& scale, Vec3 const& translation)
+	{
+		return Mat44(Vec3(scale.x, 0.0f, 0.0f), Vec3(0.0f, scale.y, 0.0f), Vec3(0.0f, 0.0f, scale.z), translation);
+	}
+
+	// What the shader did with a vertex color under a model color
+	Rgba8 MultiplyColors(Rgba8 const& colorA, Rgba8 const& colorB)
+	{
+		return Rgba8((unsigned char)((colorA.r * colorB.r) / 255), (unsigned char)((colorA.g * colorB.g) / 255), (unsigned char)((colorA.b * colorB.b) / 255), (unsigned char)((colorA.a * colorB.a) / 255));
+	}
+}
+
 void DebugAddWorldPoint(const Vec3& pos, float radius, float duration, const Rgba8& startColor, const Rgba8& endColor, DebugRenderMode mode, int stacks, int slices)
 {
-	Mat44 modelMatrix;
-	modelMatrix.AppendTranslation3D(pos);
-
-	DebugShape* newShape = new DebugShape(modelMatrix, mode, duration, debugRenderSystem->GetClock(), startColor, endColor);
-	AddVertsForSphere(newShape->m_verts, radius, stacks, slices);
-	debugRenderSystem->AddShape(newShape);
+	DebugUnitMeshKey meshKey{ DebugUnitMeshType::SPHERE, stacks, slices };
+	debugRenderSystem->SubmitInstance(mode, meshKey, GetScaleTranslationTransform(Vec3(radius, radius, radius), pos), startColor, endColor, duration);
 }
 
 void DebugAddWorldLine(const Vec3& start, const Vec3& end, float radius, float duration, const Rgba8& startColor, const Rgba8& endColor, DebugRenderMode mode)
 {
-	Mat44 modelMatrix;
-	DebugShape* newShape = new DebugShape(modelMatrix, mode, duration, debugRenderSystem->GetClock(), startColor, endColor);
-	AddVertsForCylinder(newShape->m_verts, start, end, radius);
-	debugRenderSystem->AddShape(newShape);
+	DebugUnitMeshKey meshKey{ DebugUnitMeshType::CYLINDER, 0, 16 };
+	debugRenderSystem->SubmitInstance(mode, meshKey, GetSegmentTransform(start, end, radius), startColor, endColor, duration);
 }
 
 void DebugAddWorldWireCylinder(const Vec3& base, const Vec3& top, float radius, float duration, const Rgba8& startColor, const Rgba8& endColor, DebugRenderMode mode)
 {
-	Mat44 modelMatrix;
-
-	DebugShape* newShape = new DebugShape(modelMatrix, mode, duration, debugRenderSystem->GetClock(), startColor, endColor);
-	AddVertsForCylinder(newShape->m_verts, base, top, radius);
-	debugRenderSystem->AddWireShape(newShape);
+	DebugUnitMeshKey meshKey{ DebugUnitMeshType::CYLINDER, 0, 16 };
+	debugRenderSystem->SubmitInstance(mode, meshKey, GetSegmentTransform(base, top, radius), startColor, endColor, duration, true);
 }
 
 void DebugAddWorldWireSphere(const Vec3& center, float radius, float duration, const Rgba8& startColor, const Rgba8& endColor, DebugRenderMode mode, int stacks, int slices)
 {
-	Mat44 modelMatrix;
-	modelMatrix.AppendTranslation3D(center);
-
-	DebugShape* newShape = new DebugShape(modelMatrix, mode, duration, debugRenderSystem->GetClock(), startColor, endColor);
-	AddVertsForWireSphere(newShape->m_verts, radius, stacks, slices);
-	debugRenderSystem->AddWireShape(newShape);
+	DebugUnitMeshKey meshKey{ DebugUnitMeshType::WIRE_SPHERE, stacks, slices };
+	debugRenderSystem->SubmitInstance(mode, meshKey, GetScaleTranslationTransform(Vec3(radius, radius, radius), center), startColor, endColor, duration, true);
 }
 
 void DebugAddWorldArrow(const Vec3& start, const Vec3& end, float radius, float duration, const Rgba8& baseColor, const Rgba8& startColor, const Rgba8& endColor, DebugRenderMode mode)
 {
-	Mat44 modelMatrix;
-
-	DebugShape* newShape = new DebugShape(modelMatrix, mode, duration, debugRenderSystem->GetClock(), startColor, endColor);
-	AddVertsForArrow3D(newShape->m_verts, start, end, radius, 16, baseColor);
-	debugRenderSystem->AddShape(newShape);
+	DebugUnitMeshKey meshKey{ DebugUnitMeshType::ARROW, 0, 16 };
+	debugRenderSystem->SubmitInstance(mode, meshKey, GetSegmentTransform(start, end, radius), MultiplyColors(baseColor, startColor), MultiplyColors(baseColor, endColor), duration);
 }
 
 void DebugAddWorldBox(const AABB3& bounds, float duration, const Rgba8& startColor, const Rgba8& endColor, DebugRenderMode mode)
 {
-	Mat44 modelMatrix;
-
-	DebugShape* newShape = new DebugShape(modelMatrix, mode, duration, debugRenderSystem->GetClock(), startColor, endColor);
-	AddVertsForAABB3D(newShape->m_verts, bounds);
-	debugRenderSystem->AddShape(newShape);
+	DebugUnitMeshKey meshKey{ DebugUnitMeshType::BOX, 0, 0 };
+	debugRenderSystem->SubmitInstance(mode, meshKey, GetScaleTranslationTransform(bounds.GetDimensions(), bounds.m_mins), startColor, endColor, duration);
 }
 
 void DebugAddWorldBasis(const Mat44& basis, float duration, const Rgba8& startColor, const Rgba8& endColor, DebugRenderMode mode)
 {
-	Mat44 modelMatrix;
-	modelMatrix.AppendTranslation3D(basis.GetTranslation3D());
-
-	DebugShape* newShape = new DebugShape(modelMatrix, mode, duration, debugRenderSystem->GetClock(), startColor, endColor);
+	DebugUnitMeshKey meshKey{ DebugUnitMeshType::ARROW, 0, 16 };
 	float basisRadius = 0.075f;
+	Vec3 origin = basis.GetTranslation3D();
 
-	AddVertsForArrow3D(newShape->m_verts, Vec3::ZERO, basis.GetIBasis3D(), basisRadius, 16, Rgba8::RED);
-	AddVertsForArrow3D(newShape->m_verts, Vec3::ZERO, basis.GetJBasis3D(), basisRadius, 16, Rgba8::GREEN);
-	AddVertsForArrow3D(newShape->m_verts, Vec3::ZERO, basis.GetKBasis3D(), basisRadius, 16, Rgba8::BLUE);
-	debugRenderSystem->AddShape(newShape);
-
+	debugRenderSystem->SubmitInstance(mode, meshKey, GetSegmentTransform(origin, origin + basis.GetIBasis3D(), basisRadius), MultiplyColors(Rgba8::RED, startColor), MultiplyColors(Rgba8::RED, endColor), duration);
+	debugRenderSystem->SubmitInstance(mode, meshKey, GetSegmentTransform(origin, origin + basis.GetJBasis3D(), basisRadius), MultiplyColors(Rgba8::GREEN, startColor), MultiplyColors(Rgba8::GREEN, endColor), duration);
+	debugRenderSystem->SubmitInstance(mode, meshKey, GetSegmentTransform(origin, origin + basis.GetKBasis3D(), basisRadius), MultiplyColors(Rgba8::BLUE, startColor), MultiplyColors(Rgba8::BLUE, endColor), duration);
 }
 
 void DebugAddWorldText(const std::string& text, const Mat44& transform, float textHeight, const Vec2& alignment, float duration, const Rgba8& startColor, const Rgba8& endColor, DebugRenderMode mode)
@@ -779,7 +702,7 @@ void DebugAddWorldText(const std::string& text, const Mat44& transform, float te
 	DebugShape* newShape = new DebugShape(transform, mode, duration, debugRenderSystem->GetClock(), startColor, endColor, &font->GetTexture());
 	newShape->m_isWorldText = true;
 	font->AddVertsForTextInBox2D(newShape->m_verts, textBox, textHeight, text, Rgba8::WHITE, 1.0f, alignment);
-	debugRenderSystem->AddShape(newShape);
+	debugRenderSystem->SubmitShape(newShape);
 }
 
 void DebugAddWorldBillboardText(const std::string& text, const Vec3& origin, float textHeight, const Vec2& alignment, float duration, const Rgba8& startColor, const Rgba8& endColor, DebugRenderMode mode)
@@ -793,7 +716,7 @@ void DebugAddWorldBillboardText(const std::string& text, const Vec3& origin, flo
 
 	DebugShape* newShape = new DebugShape(modelMatrix, mode, duration, debugRenderSystem->GetClock(), startColor, endColor, &font->GetTexture());
 	font->AddVertsForTextInBox2D(newShape->m_verts, textBox, textHeight, text, Rgba8::WHITE, 1.0f, alignment);
-	debugRenderSystem->AddBillboard(newShape);
+	debugRenderSystem->SubmitShape(newShape, true);
 
 }
 
@@ -807,7 +730,7 @@ void DebugAddScreenText(const std::string& text, const Vec2& position, float dur
 	DebugShape* newShape = new DebugShape(text, ScrenTextType::FreeText, duration, debugRenderSystem->GetClock(), startColor, endColor, &font->GetTexture());
 	newShape->m_isWorldShape = false;
 	font->AddVertsForTextInBox2D(newShape->m_verts, textBox, size, text, Rgba8::WHITE, 1.0f, alignment);
-	debugRenderSystem->AddShape(newShape);
+	debugRenderSystem->SubmitShape(newShape);
 }
 
 void DebugAddMessage(const std::string& text, float duration, const Rgba8& startColor, const Rgba8& endColor)
@@ -817,7 +740,7 @@ void DebugAddMessage(const std::string& text, float duration, const Rgba8& start
 
 	DebugShape* newShape = new DebugShape(text, ScrenTextType::ScreenMessage, duration, debugRenderSystem->GetClock(), startColor, endColor, &font->GetTexture());
 	newShape->m_isWorldShape = false;
-	debugRenderSystem->AddShape(newShape);
+	debugRenderSystem->SubmitShape(newShape);
 }
 
 
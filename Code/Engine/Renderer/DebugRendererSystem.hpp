@@ -106,7 +106,7 @@ void DebugRenderWorld(const Camera& camera);
 void DebugRenderScreen(const Camera& camera);
 void DebugRenderEndFrame();
 
-// Geometry
+// Geometry. Safe to call from any thread without locking, the calls are merged when the frame begins and before each pass
 void DebugAddWorldPoint(const Vec3& pos, float radius, float duration, const Rgba8& startColor, const Rgba8& endColor, DebugRenderMode mode, int stacks = 16, int slices = 32);
 void DebugAddWorldLine(const Vec3& start, const Vec3& end, float radius, float duration, const Rgba8& startColor, const Rgba8& endColor, DebugRenderMode mode);
 void DebugAddWorldWireCylinder(const Vec3& base, const Vec3& top, float radius, float duration, const Rgba8& startColor, const Rgba8& endColor, DebugRenderMode mode);
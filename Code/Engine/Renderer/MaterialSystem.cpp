@@ -89,7 +89,7 @@ Material* MaterialSystem::GetMaterialForPathOrName(std::filesystem::path const&
 Material* MaterialSystem::CreateMaterial(std::string const& materialXMLFile)
 {
 	XMLDoc materialDoc;
-	XMLError loadStatus = materialDoc.LoadFile(materialXMLFile.c_str());
+	XMLError loadStatus = LoadXmlDocumentFromFile(materialDoc, materialXMLFile);
 	GUARANTEE_OR_DIE(loadStatus == tinyxml2::XML_SUCCESS, Stringf("COULD NOT LOAD MATERIAL XML FILE %s", materialXMLFile.c_str()));
 
 	XMLElement const* firstElem = materialDoc.FirstChildElement("Material");
@@ -4,9 +4,18 @@
 #include "Engine/Renderer/IndexBuffer.hpp"
 #include "Engine/Core/StringUtils.hpp"
 #include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/VirtualFileSystem.hpp"
 #include "Engine/Core/Rgba8.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 
+bool ReadModelFileToString(std::string& outString, std::filesystem::path const& filePath) {
+	VirtualFile modelFile;
+	if (!OpenVirtualFile(modelFile, filePath.string())) return false;
+
+	outString.assign(modelFile.GetStringView());
+	return true;
+}
+
 int LoadPlyModelInfoFromHeader(Strings const& source, int& uvIndexStart, int& amountOfverts, int& amountOfindices) {
 	bool foundUv = false;
 	int UVStart = 0;
@@ -57,7 +66,7 @@ int LoadPlyModelInfoFromHeader(Strings const& source, int& uvIndexStart, int& am
 
 void LoadPlyModel(std::filesystem::path filePath, Rgba8 const& color, std::vector<Vertex_PCU>& verts, std::vector<unsigned int>& indices) {
 	std::string modelInfo = "";
-	FileReadToString(modelInfo, filePath.string());
+	ReadModelFileToString(modelInfo, filePath);
 
 	Strings modelSplitByNewline = SplitStringOnDelimiter(modelInfo, '\n');
 
@@ -118,7 +127,7 @@ void LoadPlyModel(std::filesystem::path filePath, Rgba8 const& color, std::vecto
 void LoadPlyModel(std::filesystem::path filePath, Rgba8 const& color, std::vector<Vertex_PNCU>& verts, std::vector<unsigned int>& indices)
 {
 	std::string modelInfo = "";
-	FileReadToString(modelInfo, filePath.string());
+	ReadModelFileToString(modelInfo, filePath);
 
 	Strings modelSplitByNewline = SplitStringOnDelimiter(modelInfo, '\n');
 
@@ -199,7 +208,7 @@ void MeshBuilder::ImportFromObj(std::filesystem::path filePath)
 {
 	PROFILE_LOG_SCOPE(Mesh_Importing);
 	std::string modelInfo;
-	FileReadToString(modelInfo, filePath.string());
+	ReadModelFileToString(modelInfo, filePath);
 
 	std::vector<Vec3> vertexPositions;
 	std::vector<Vec3> vertexNormals;
@@ -398,36 +407,35 @@ bool MeshBuilder::ReadFromFile(std::filesystem::path filePath) {
 	else filePath += ".bime";
 
 	PROFILE_LOG_SCOPE(Read_from_binary);
-	FILE* file = nullptr;
-	fopen_s(&file, filePath.string().c_str(), "rb");
+	VirtualFile file;
 
-	if (file) {
+	if (!OpenVirtualFile(file, filePath.string())) return false;
 
-		size_t vertAmount = 0;
-		size_t indexAmount = 0;
+	size_t headerSize = sizeof(size_t) * 2;
+	if (file.GetSize() < headerSize) return false;
 
-		fread_s(&vertAmount, sizeof(size_t), sizeof(size_t), 1, file);
-		fread_s(&indexAmount, sizeof(size_t), sizeof(size_t), 1, file);
+	uint8_t const* fileData = file.GetData();
+	size_t vertAmount = 0;
+	size_t indexAmount = 0;
 
-		m_vertexes.clear();
-		m_indexes.clear();
+	memcpy(&vertAmount, fileData, sizeof(size_t));
+	memcpy(&indexAmount, fileData + sizeof(size_t), sizeof(size_t));
 
-		m_vertexes.resize(vertAmount);
-		m_indexes.resize(indexAmount);
+	size_t bufferSize = sizeof(Vertex_PNCU) * vertAmount;
+	size_t indexBufferSize = sizeof(unsigned int) * indexAmount;
 
-		size_t bufferSize = sizeof(Vertex_PNCU) * m_vertexes.size();
-		size_t indexBufferSize = sizeof(unsigned int) * m_indexes.size();
+	if (file.GetSize() < (headerSize + bufferSize + indexBufferSize)) {
+		ERROR_RECOVERABLE(Stringf("BINARY MESH FILE IS TRUNCATED: %s", filePath.string().c_str()));
+		return false;
+	}
 
-		fread_s(m_vertexes.data(), bufferSize, sizeof(Vertex_PNCU), m_vertexes.size(), file);
-		fread_s(m_indexes.data(), indexBufferSize, sizeof(unsigned int), m_indexes.size(), file);
+	m_vertexes.resize(vertAmount);
+	m_indexes.resize(indexAmount);
 
-		fclose(file);
+	memcpy(m_vertexes.data(), fileData + headerSize, bufferSize);
+	memcpy(m_indexes.data(), fileData + headerSize + bufferSize, indexBufferSize);
 
-		m_vertexCount = (unsigned int)m_vertexes.size();
-	}
-	else {
-		return false;
-	}
+	m_vertexCount = (unsigned int)m_vertexes.size();
 
 	return true;
 }
@@ -0,0 +1,166 @@
+#include "Engine/Renderer/RenderQueue.hpp"
+
+namespace {
+	constexpr int TEXTURE_SHIFT = 0;
+	constexpr int MATERIAL_SHIFT = TEXTURE_SHIFT + RENDER_QUEUE_TEXTURE_BITS;
+	constexpr int TARGET_SHIFT = MATERIAL_SHIFT + RENDER_QUEUE_MATERIAL_BITS;
+	constexpr int GROUP_SHIFT = TARGET_SHIFT + RENDER_QUEUE_TARGET_BITS;
+	constexpr uint64_t MAX_GROUP = (1ull << RENDER_QUEUE_GROUP_BITS) - 1;
+
+	constexpr int RADIX_BITS = 8;
+	constexpr int RADIX_BUCKET_COUNT = 1 << RADIX_BITS;
+}
+
+void RenderQueue::Clear()
+{
+	m_drawStates.clear();
+	m_sortKeys.clear();
+	m_sortedDrawIndexes.clear();
+	m_currentGroup = 0;
+	m_isGroupOrderDependent = false;
+
+	m_targetPairs.clear();
+	m_materialIds.clear();
+	m_textureIds.clear();
+}
+
+void RenderQueue::BeginPass()
+{
+	m_currentGroup++;
+	m_isGroupOrderDependent = false;
+}
+
+int RenderQueue::AddDraw(RenderQueueDrawState const& drawState, Texture const* firstTexture, bool isOrderDependent)
+{
+	// An order dependent draw is a group of its own, the draws after it start a new one
+	if (isOrderDependent || m_isGroupOrderDependent) {
+		m_currentGroup++;
+	}
+	m_isGroupOrderDependent = isOrderDependent;
+
+	uint64_t sortKey = 0;
+	sortKey |= ((m_currentGroup < MAX_GROUP) ? m_currentGroup : MAX_GROUP) << GROUP_SHIFT;
+	sortKey |= GetOrCreateTargetId(drawState.m_renderTarget, drawState.m_depthTarget) << TARGET_SHIFT;
+	sortKey |= GetOrCreateId(m_materialIds, drawState.m_material, RENDER_QUEUE_MATERIAL_BITS) << MATERIAL_SHIFT;
+	sortKey |= GetOrCreateId(m_textureIds, firstTexture, RENDER_QUEUE_TEXTURE_BITS) << TEXTURE_SHIFT;
+
+	int drawIndex = (int)m_drawStates.size();
+	m_drawStates.push_back(drawState);
+	m_sortKeys.push_back(sortKey);
+	m_sortedDrawIndexes.push_back(drawIndex);
+	return drawIndex;
+}
+
+// LSD radix sort of the keys, 8 bits a pass. Passes where every key has the same digit are skipped, which is most of the
+// high group bits and every field a frame doesn't vary
+void RenderQueue::Sort()
+{
+	int drawCount = GetDrawCount();
+	for (int drawIndex = 0; drawIndex < drawCount; drawIndex++) {
+		m_sortedDrawIndexes[drawIndex] = drawIndex;
+	}
+	// Past the group range later draws would share a group and could cross an order dependent one, submission order is safe
+	if (m_currentGroup >= MAX_GROUP) return;
+
+	m_sortingKeys = m_sortKeys;
+	m_scratchKeys.resize(drawCount);
+	m_scratchIndexes.resize(drawCount);
+
+	uint64_t* keys = m_sortingKeys.data();
+	int* indexes = m_sortedDrawIndexes.data();
+	uint64_t* scratchKeys = m_scratchKeys.data();
+	int* scratchIndexes = m_scratchIndexes.data();
+
+	for (int shift = 0; shift < 64; shift += RADIX_BITS) {
+		int bucketCounts[RADIX_BUCKET_COUNT] = {};
+		for (int keyIndex = 0; keyIndex < drawCount; keyIndex++) {
+			bucketCounts[(keys[keyIndex] >> shift) & (RADIX_BUCKET_COUNT - 1)]++;
+		}
+		if ((drawCount == 0) || (bucketCounts[(keys[0] >> shift) & (RADIX_BUCKET_COUNT - 1)] == drawCount)) continue;
+
+		int bucketStarts[RADIX_BUCKET_COUNT];
+		int runningStart = 0;
+		for (int bucket = 0; bucket < RADIX_BUCKET_COUNT; bucket++) {
+			bucketStarts[bucket] = runningStart;
+			runningStart += bucketCounts[bucket];
+		}
+
+		for (int keyIndex = 0; keyIndex < drawCount; keyIndex++) {
+			int& bucketStart = bucketStarts[(keys[keyIndex] >> shift) & (RADIX_BUCKET_COUNT - 1)];
+			scratchKeys[bucketStart] = keys[keyIndex];
+			scratchIndexes[bucketStart] = indexes[keyIndex];
+			bucketStart++;
+		}
+
+		for (int keyIndex = 0; keyIndex < drawCount; keyIndex++) {
+			keys[keyIndex] = scratchKeys[keyIndex];
+			indexes[keyIndex] = scratchIndexes[keyIndex];
+		}
+	}
+}
+
+RenderQueueStats RenderQueue::Replay(RenderQueueBackend& backend) const
+{
+	RenderQueueStats stats;
+	if (m_drawStates.empty()) return stats;
+
+	backend.BindSharedState();
+
+	// Non indexed draws don't use the index buffer, so the last one bound stays valid across them
+	RenderQueueDrawState const* previousState = nullptr;
+	IndexBuffer* boundIndexBuffer = nullptr;
+	for (int drawIndex : m_sortedDrawIndexes) {
+		RenderQueueDrawState const& drawState = m_drawStates[drawIndex];
+		bool isFirstDraw = (previousState == nullptr);
+
+		if (isFirstDraw || (drawState.m_renderTarget != previousState->m_renderTarget) || (drawState.m_depthTarget != previousState->m_depthTarget)) {
+			backend.BindRenderTargets(drawState.m_renderTarget, drawState.m_depthTarget);
+			stats.m_renderTargetChanges++;
+		}
+		if (isFirstDraw || (drawState.m_material != previousState->m_material)) {
+			backend.BindPipeline(drawState.m_material);
+			stats.m_pipelineChanges++;
+		}
+		if (isFirstDraw || (drawState.m_cbvHandleStart != previousState->m_cbvHandleStart) || (drawState.m_srvHandleStart != previousState->m_srvHandleStart)) {
+			backend.BindDescriptorTables(drawState.m_cbvHandleStart, drawState.m_srvHandleStart);
+			stats.m_descriptorTableChanges++;
+		}
+		if (isFirstDraw || (drawState.m_vertexBuffer != previousState->m_vertexBuffer)) {
+			backend.BindVertexBuffer(drawState.m_vertexBuffer);
+			stats.m_vertexBufferChanges++;
+		}
+		if (drawState.m_indexBuffer && (drawState.m_indexBuffer != boundIndexBuffer)) {
+			backend.BindIndexBuffer(drawState.m_indexBuffer);
+			boundIndexBuffer = drawState.m_indexBuffer;
+			stats.m_indexBufferChanges++;
+		}
+
+		backend.Draw(drawIndex);
+		stats.m_drawCount++;
+		previousState = &drawState;
+	}
+	return stats;
+}
+
+uint64_t RenderQueue::GetOrCreateId(std::unordered_map<void const*, uint64_t>& ids, void const* pointer, int bitCount)
+{
+	auto idIter = ids.find(pointer);
+	if (idIter != ids.end()) return idIter->second;
+
+	uint64_t maxId = (1ull << bitCount) - 1;
+	uint64_t newId = (ids.size() < maxId) ? (uint64_t)ids.size() : maxId;
+	ids[pointer] = newId;
+	return newId;
+}
+
+uint64_t RenderQueue::GetOrCreateTargetId(Texture* renderTarget, Texture* depthTarget)
+{
+	for (int targetIndex = 0; targetIndex < (int)m_targetPairs.size(); targetIndex++) {
+		if ((m_targetPairs[targetIndex].first == renderTarget) && (m_targetPairs[targetIndex].second == depthTarget)) return (uint64_t)targetIndex;
+	}
+
+	uint64_t maxId = (1ull << RENDER_QUEUE_TARGET_BITS) - 1;
+	if (m_targetPairs.size() >= maxId) return maxId;
+	m_targetPairs.emplace_back(renderTarget, depthTarget);
+	return (uint64_t)m_targetPairs.size() - 1;
+}
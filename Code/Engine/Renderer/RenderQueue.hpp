@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class Material;
+class Texture;
+class VertexBuffer;
+class IndexBuffer;
+
+// Sort key, high bits first: order group, target pair, material, first texture. Ids past a field's range share its last value
+constexpr int RENDER_QUEUE_GROUP_BITS = 24;
+constexpr int RENDER_QUEUE_TARGET_BITS = 8;
+constexpr int RENDER_QUEUE_MATERIAL_BITS = 16;
+constexpr int RENDER_QUEUE_TEXTURE_BITS = 16;
+
+// Everything replay binds for a draw. Descriptor table starts are per draw, the rest is often shared by neighbours
+struct RenderQueueDrawState {
+	Texture* m_renderTarget = nullptr;
+	Texture* m_depthTarget = nullptr;
+	Material* m_material = nullptr;
+	VertexBuffer* m_vertexBuffer = nullptr;
+	IndexBuffer* m_indexBuffer = nullptr; // Null for non indexed draws
+	unsigned int m_cbvHandleStart = 0;
+	unsigned int m_srvHandleStart = 0;
+};
+
+struct RenderQueueStats {
+	int m_drawCount = 0;
+	int m_renderTargetChanges = 0;
+	int m_pipelineChanges = 0;
+	int m_descriptorTableChanges = 0;
+	int m_vertexBufferChanges = 0;
+	int m_indexBufferChanges = 0;
+};
+
+/// <summary>
+/// What replay drives. The renderer implements it over its command list, RenderQueueRecordingBackend only counts,
+/// so sorting and state diffing can be checked without a GPU
+/// </summary>
+class RenderQueueBackend {
+public:
+	virtual ~RenderQueueBackend() = default;
+
+	// Root signature, descriptor heaps, viewport, scissor and topology are the same for every draw of a replay
+	virtual void BindSharedState() = 0;
+	virtual void BindRenderTargets(Texture* renderTarget, Texture* depthTarget) = 0;
+	virtual void BindPipeline(Material* material) = 0;
+	virtual void BindDescriptorTables(unsigned int cbvHandleStart, unsigned int srvHandleStart) = 0;
+	virtual void BindVertexBuffer(VertexBuffer* vertexBuffer) = 0;
+	virtual void BindIndexBuffer(IndexBuffer* indexBuffer) = 0;
+	virtual void Draw(int drawIndex) = 0;
+};
+
+class RenderQueueRecordingBackend : public RenderQueueBackend {
+public:
+	virtual void BindSharedState() override { m_sharedStateBinds++; }
+	virtual void BindRenderTargets(Texture*, Texture*) override { m_stats.m_renderTargetChanges++; }
+	virtual void BindPipeline(Material*) override { m_stats.m_pipelineChanges++; }
+	virtual void BindDescriptorTables(unsigned int, unsigned int) override { m_stats.m_descriptorTableChanges++; }
+	virtual void BindVertexBuffer(VertexBuffer*) override { m_stats.m_vertexBufferChanges++; }
+	virtual void BindIndexBuffer(IndexBuffer*) override { m_stats.m_indexBufferChanges++; }
+	virtual void Draw(int drawIndex) override { m_stats.m_drawCount++; m_drawOrder.push_back(drawIndex); }
+
+public:
+	int m_sharedStateBinds = 0;
+	RenderQueueStats m_stats;
+	std::vector<int> m_drawOrder;
+};
+
+/// <summary>
+/// Orders a frame of draws to share state, then replays them binding only what changed since the previous draw.
+/// Draws are grouped: a new group starts with every pass and around every order dependent draw (blended, or not writing
+/// depth with an ordered depth test). Draws only move within their group, so anything whose result depends on what was
+/// drawn before it keeps its place. Keys are radix sorted, which is stable, so equal keys keep their submission order
+/// </summary>
+class RenderQueue {
+public:
+	void Clear();
+	void BeginPass();
+	// Returns the index replay hands back to Draw
+	int AddDraw(RenderQueueDrawState const& drawState, Texture const* firstTexture, bool isOrderDependent);
+	void Sort();
+	RenderQueueStats Replay(RenderQueueBackend& backend) const;
+
+	int GetDrawCount() const { return (int)m_drawStates.size(); }
+	uint64_t GetSortKey(int drawIndex) const { return m_sortKeys[drawIndex]; }
+	int GetSortedDrawIndex(int sortedIndex) const { return m_sortedDrawIndexes[sortedIndex]; }
+
+private:
+	uint64_t GetOrCreateId(std::unordered_map<void const*, uint64_t>& ids, void const* pointer, int bitCount);
+	uint64_t GetOrCreateTargetId(Texture* renderTarget, Texture* depthTarget);
+
+private:
+	std::vector<RenderQueueDrawState> m_drawStates;
+	std::vector<uint64_t> m_sortKeys;
+	std::vector<int> m_sortedDrawIndexes;
+	uint64_t m_currentGroup = 0;
+	bool m_isGroupOrderDependent = false;
+
+	// Dense per frame ids, in the order things are first seen
+	std::vector<std::pair<Texture*, Texture*>> m_targetPairs; // Few per frame, the index is the id
+	std::unordered_map<void const*, uint64_t> m_materialIds;
+	std::unordered_map<void const*, uint64_t> m_textureIds;
+
+	// Radix sort scratch, keeps its memory
+	std::vector<uint64_t> m_scratchKeys;
+	std::vector<int> m_scratchIndexes;
+	std::vector<uint64_t> m_sortingKeys;
+};
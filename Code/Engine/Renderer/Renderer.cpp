@@ -8,12 +8,15 @@
 #include "Engine/Renderer/Texture.hpp"
 #include "Engine/Renderer/BitmapFont.hpp"
 #include "Engine/Core/Image.hpp"
+#include "Engine/Core/CompressedImage.hpp"
+#include "Engine/Core/TextureAtlas.hpp"
 #include "Engine/Renderer/D3D12/Resource.hpp"
 #include "Engine/Renderer/GraphicsCommon.hpp"
 #include "Engine/Renderer/D3D12/D3D12TypeConversions.hpp"
 #include "Engine/Window/Window.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/VirtualFileSystem.hpp"
 #include "Engine/Core/Vertex_PCU.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Math/Vec4.hpp"
@@ -21,6 +24,7 @@
 #include <dxgidebug.h>
 #include <d3dx12.h> // Notice the X. These are the helper structures not the DX12 header
 #include <regex>
+#include <unordered_set>
 
 #pragma message("ENGINE_DIR == " ENGINE_DIR)
 
@@ -762,13 +766,17 @@ bool Renderer::CompileShaderToByteCode(std::vector<unsigned char>& outByteCode,
 	//	L"-Qstrip_reflect",          // Strip reflection into a separate blob. 
 	//};
 
+	// Source is read through the VFS so it can come from an archive, DXC only sees the bytes. Includes still go through the
+	// default handler, relative to the source path
+	VirtualFile sourceFile;
+	if (!OpenVirtualFile(sourceFile, loadInfo.m_shaderSrc)) {
+		ERROR_AND_DIE(Stringf("COULD NOT READ SHADER SOURCE FILE: %s", sourceName));
+	}
+
 	DxcBuffer bufferSource = {};
-	ComPtr<IDxcBlobEncoding> pSource = nullptr;
-	pUtils->LoadFile(wSrc.c_str(), nullptr, &pSource);
-	bufferSource.Ptr = pSource->GetBufferPointer();
-	bufferSource.Size = pSource->GetBufferSize();
-	BOOL encodingKnown = TRUE;
-	pSource->GetEncoding(&encodingKnown, &bufferSource.Encoding); // Assume BOM says UTF8 or UTF16 or this is ANSI text.
+	bufferSource.Ptr = sourceFile.GetData();
+	bufferSource.Size = sourceFile.GetSize();
+	bufferSource.Encoding = DXC_CP_ACP; // Assume BOM says UTF8 or UTF16 or this is ANSI text.
 
 	ComPtr<IDxcResult> pResults;
 	auto stringCompilerArgs = compilerArgs->GetArguments();
@@ -819,8 +827,31 @@ void Renderer::LoadEngineShaderBinaries()
 	std::regex vertexRegex(".*_v.cso");
 	std::regex pixelRegex(".*_p.cso");
 
-	for (auto const& binEntry : std::filesystem::directory_iterator(binariesPath)) {
-		std::filesystem::path binaryPath = binEntry.path();
+	// Listed and opened through the VFS, so the binaries can ship in an archive mounted over the engine materials directory
+	Strings binaryPaths;
+	ListVirtualFiles(binaryPaths, binariesPath);
+
+	// All binaries are read in parallel (archive entries may need decompressing), then collected in listing order
+	int binaryCount = (int)binaryPaths.size();
+	std::vector<std::vector<uint8_t>> binaryDatas(binaryCount);
+	auto readBinaries = [&](int beginIndex, int endIndex) {
+		for (int binaryIndex = beginIndex; binaryIndex < endIndex; binaryIndex++) {
+			VirtualFile binaryFile;
+			if (OpenVirtualFile(binaryFile, binaryPaths[binaryIndex])) {
+				binaryDatas[binaryIndex].assign(binaryFile.GetSpan().begin(), binaryFile.GetSpan().end());
+			}
+		}
+	};
+
+	if (g_theJobSystem) {
+		g_theJobSystem->ParallelFor(binaryCount, 1, readBinaries);
+	}
+	else {
+		readBinaries(0, binaryCount);
+	}
+
+	for (int binaryIndex = 0; binaryIndex < binaryCount; binaryIndex++) {
+		std::filesystem::path binaryPath = binaryPaths[binaryIndex];
 		ShaderByteCode* newByteCode = new ShaderByteCode();
 		bool isVertex = std::regex_match(binaryPath.string(), vertexRegex);
 		bool isPixel = std::regex_match(binaryPath.string(), pixelRegex);
@@ -831,7 +862,7 @@ void Renderer::LoadEngineShaderBinaries()
 
 		newByteCode->m_shaderType = shaderType;
 		newByteCode->m_src = binaryPath.string();
-		FileReadToBuffer(newByteCode->m_byteCode, binaryPath.string().c_str());
+		newByteCode->m_byteCode = std::move(binaryDatas[binaryIndex]);
 		newByteCode->m_shaderName = binaryPath.filename().replace_extension("").string();
 
 		m_shaderByteCodes.push_back(newByteCode);
@@ -1259,93 +1290,120 @@ void Renderer::SetDebugName(ID3D12Object* object, char const* name)
 #endif
 }
 
-void Renderer::DrawImmediateCtx(ImmediateContext& ctx)
-{
-	Texture* currentRt = ctx.m_renderTargets[0];
-	Resource* currentRtResc = currentRt->GetResource();
-	currentRtResc->TransitionTo(D3D12_RESOURCE_STATE_RENDER_TARGET, m_commandList.Get());
-
-	Texture* depthTarget = ctx.m_depthTarget;
-	Resource* depthTargetRsc = depthTarget->GetResource();
-	depthTargetRsc->TransitionTo(D3D12_RESOURCE_STATE_DEPTH_WRITE, m_commandList.Get());
-
-	SetMaterialPSO(ctx.m_material);
-	for (auto& [slot, texture] : ctx.m_boundTextures) {
-		CopyTextureToHeap(texture, ctx.m_srvHandleStart, slot);
+/// <summary>
+/// Replays immediate contexts on the command list. RenderQueue only calls the binds whose state changed since the previous
+/// draw, descriptors are still copied for every draw since each one has its own range of the heap
+/// </summary>
+class ImmediateContextBackend : public RenderQueueBackend {
+public:
+	ImmediateContextBackend(Renderer& renderer) :
+		m_renderer(renderer)
+	{
 	}
 
-	CopyCBufferToHeap(ctx.m_cameraCBO, ctx.m_cbvHandleStart, g_cameraBufferSlot);
-	CopyCBufferToHeap(ctx.m_modelCBO, ctx.m_cbvHandleStart, g_modelBufferSlot);
+	virtual void BindSharedState() override
+	{
+		DescriptorHeap* srvUAVCBVHeap = m_renderer.GetGPUDescriptorHeap(DescriptorHeapType::SRV_UAV_CBV);
+		DescriptorHeap* samplerHeap = m_renderer.GetGPUDescriptorHeap(DescriptorHeapType::SAMPLER);
+		ID3D12DescriptorHeap* allDescriptorHeaps[] = {
+			srvUAVCBVHeap->GetHeap(),
+			samplerHeap->GetHeap()
+		};
 
-	for (auto& [slot, cbuffer] : ctx.m_boundCBuffers) {
-		CopyCBufferToHeap(cbuffer, ctx.m_cbvHandleStart, slot);
-	}
+		UINT numHeaps = sizeof(allDescriptorHeaps) / sizeof(ID3D12DescriptorHeap*);
+		ID3D12GraphicsCommandList2* commandList = m_renderer.m_commandList.Get();
+		commandList->SetGraphicsRootSignature(m_renderer.m_rootSignature.Get());
+		commandList->SetDescriptorHeaps(numHeaps, allDescriptorHeaps);
 
-	DescriptorHeap* srvUAVCBVHeap = GetGPUDescriptorHeap(DescriptorHeapType::SRV_UAV_CBV);
-	DescriptorHeap* samplerHeap = GetGPUDescriptorHeap(DescriptorHeapType::SAMPLER);
-	ID3D12DescriptorHeap* allDescriptorHeaps[] = {
-		srvUAVCBVHeap->GetHeap(),
-		samplerHeap->GetHeap()
-	};
+		commandList->SetGraphicsRootDescriptorTable(2, srvUAVCBVHeap->GetGPUHandleAtOffset(UAV_HANDLE_START));
+		commandList->SetGraphicsRootDescriptorTable(3, samplerHeap->GetGPUHandleForHeapStart());
 
-	UINT numHeaps = sizeof(allDescriptorHeaps) / sizeof(ID3D12DescriptorHeap*);
-	m_commandList->SetGraphicsRootSignature(m_rootSignature.Get());
-	m_commandList->SetDescriptorHeaps(numHeaps, allDescriptorHeaps);
+		commandList->RSSetViewports(1, &m_renderer.m_viewport);
+		commandList->RSSetScissorRects(1, &m_renderer.m_scissorRect);
+		commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	}
 
+	virtual void BindRenderTargets(Texture* renderTarget, Texture* depthTarget) override
+	{
+		D3D12_CPU_DESCRIPTOR_HANDLE currentRTVHandle = renderTarget->GetOrCreateView(RESOURCE_BIND_RENDER_TARGET_BIT)->GetHandle();
+		D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle = depthTarget->GetOrCreateView(RESOURCE_BIND_DEPTH_STENCIL_BIT)->GetHandle();
+		m_renderer.m_commandList->OMSetRenderTargets(1, &currentRTVHandle, FALSE, &dsvHandle);
+	}
 
-	m_commandList->SetGraphicsRootDescriptorTable(0, srvUAVCBVHeap->GetGPUHandleAtOffset(ctx.m_cbvHandleStart));
-	m_commandList->SetGraphicsRootDescriptorTable(1, srvUAVCBVHeap->GetGPUHandleAtOffset(ctx.m_srvHandleStart));
-	m_commandList->SetGraphicsRootDescriptorTable(2, srvUAVCBVHeap->GetGPUHandleAtOffset(UAV_HANDLE_START));
-	m_commandList->SetGraphicsRootDescriptorTable(3, samplerHeap->GetGPUHandleForHeapStart());
+	virtual void BindPipeline(Material* material) override
+	{
+		m_renderer.SetMaterialPSO(material);
+	}
 
-	//for (int heapIndex = 0; heapIndex < allDescriptorHeaps.size(); heapIndex++) {
-	//	ID3D12DescriptorHeap* currentDescriptorHeap = allDescriptorHeaps[heapIndex];
-	//	m_commandList->SetGraphicsRootDescriptorTable(heapIndex, currentDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
-	//}
+	virtual void BindDescriptorTables(unsigned int cbvHandleStart, unsigned int srvHandleStart) override
+	{
+		DescriptorHeap* srvUAVCBVHeap = m_renderer.GetGPUDescriptorHeap(DescriptorHeapType::SRV_UAV_CBV);
+		m_renderer.m_commandList->SetGraphicsRootDescriptorTable(0, srvUAVCBVHeap->GetGPUHandleAtOffset(cbvHandleStart));
+		m_renderer.m_commandList->SetGraphicsRootDescriptorTable(1, srvUAVCBVHeap->GetGPUHandleAtOffset(srvHandleStart));
+	}
 
-	m_commandList->RSSetViewports(1, &m_viewport);
-	m_commandList->RSSetScissorRects(1, &m_scissorRect);
+	virtual void BindVertexBuffer(VertexBuffer* vertexBuffer) override
+	{
+		D3D12_VERTEX_BUFFER_VIEW D3DbufferView = {};
+		BufferView vBufferView = vertexBuffer->GetBufferView();
+		D3DbufferView.BufferLocation = vBufferView.m_bufferLocation;
+		D3DbufferView.StrideInBytes = (UINT)vBufferView.m_strideInBytes;
+		D3DbufferView.SizeInBytes = (UINT)vBufferView.m_sizeInBytes;
+		m_renderer.m_commandList->IASetVertexBuffers(0, 1, &D3DbufferView);
+	}
 
-	// Later, each texture has its handle
-	//ResourceView* rtv =  m_defaultRenderTarget->GetOrCreateView(RESOURCE_BIND_RENDER_TARGET_BIT);
-	D3D12_CPU_DESCRIPTOR_HANDLE currentRTVHandle = currentRt->GetOrCreateView(RESOURCE_BIND_RENDER_TARGET_BIT)->GetHandle();
-	ResourceView* dsvView = ctx.m_depthTarget->GetOrCreateView(RESOURCE_BIND_DEPTH_STENCIL_BIT);
-	D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle = dsvView->GetHandle();
+	virtual void BindIndexBuffer(IndexBuffer* indexBuffer) override
+	{
+		D3D12_INDEX_BUFFER_VIEW D3DindexedBufferView = {};
+		BufferView iBufferView = indexBuffer->GetBufferView();
+		D3DindexedBufferView.BufferLocation = iBufferView.m_bufferLocation;
+		D3DindexedBufferView.Format = DXGI_FORMAT_R32_UINT;
+		D3DindexedBufferView.SizeInBytes = (UINT)iBufferView.m_sizeInBytes;
+		m_renderer.m_commandList->IASetIndexBuffer(&D3DindexedBufferView);
+	}
 
-	//CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(rtvDescriptorHeap->GetCPUDescriptorHandleForHeapStart(), m_currentBackBuffer, m_RTVdescriptorSize);
-	m_commandList->OMSetRenderTargets(1, &currentRTVHandle, FALSE, &dsvHandle);
-	m_commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	virtual void Draw(int drawIndex) override
+	{
+		ImmediateContext& ctx = m_renderer.m_immediateCtxs[drawIndex];
+		ID3D12GraphicsCommandList2* commandList = m_renderer.m_commandList.Get();
 
-	VertexBuffer* usedBuffer = (ctx.m_immediateVBO) ? *ctx.m_immediateVBO : m_immediateVBO;
-	IndexBuffer* usedIndexedBuffer = nullptr;
+		// Transitions only record a barrier when the state differs, sampling a target in a later pass moves it out of render target
+		ctx.m_renderTargets[0]->GetResource()->TransitionTo(D3D12_RESOURCE_STATE_RENDER_TARGET, commandList);
+		ctx.m_depthTarget->GetResource()->TransitionTo(D3D12_RESOURCE_STATE_DEPTH_WRITE, commandList);
 
+		for (auto& [slot, texture] : ctx.m_boundTextures) {
+			m_renderer.CopyTextureToHeap(texture, ctx.m_srvHandleStart, slot);
+		}
 
+		m_renderer.CopyCBufferToHeap(ctx.m_cameraCBO, ctx.m_cbvHandleStart, g_cameraBufferSlot);
+		m_renderer.CopyCBufferToHeap(ctx.m_modelCBO, ctx.m_cbvHandleStart, g_modelBufferSlot);
 
+		for (auto& [slot, cbuffer] : ctx.m_boundCBuffers) {
+			m_renderer.CopyCBufferToHeap(cbuffer, ctx.m_cbvHandleStart, slot);
+		}
 
-	D3D12_VERTEX_BUFFER_VIEW D3DbufferView = {};
-	BufferView vBufferView = usedBuffer->GetBufferView();
-	// Initialize the vertex buffer view.
-	D3DbufferView.BufferLocation = vBufferView.m_bufferLocation;
-	D3DbufferView.StrideInBytes = (UINT)vBufferView.m_strideInBytes;
-	D3DbufferView.SizeInBytes = (UINT)vBufferView.m_sizeInBytes;
+		if (ctx.m_isIndexedDraw) {
+			commandList->DrawIndexedInstanced((UINT)ctx.m_indexCount, 1, (UINT)ctx.m_indexStart, (INT)ctx.m_vertexStart, 0);
+		}
+		else {
+			commandList->DrawInstanced((UINT)ctx.m_vertexCount, 1, (UINT)ctx.m_vertexStart, 0);
+		}
+	}
 
-	m_commandList->IASetVertexBuffers(0, 1, &D3DbufferView);
+private:
+	Renderer& m_renderer;
+};
 
-	if (ctx.m_isIndexedDraw) {
-		usedIndexedBuffer = (ctx.m_immediateIBO) ? *ctx.m_immediateIBO : m_immediateIBO;
-		D3D12_INDEX_BUFFER_VIEW D3DindexedBufferView = {};
-		BufferView iBufferView = usedIndexedBuffer->GetBufferView();
-		D3DindexedBufferView.BufferLocation = iBufferView.m_bufferLocation;
-		D3DindexedBufferView.Format = DXGI_FORMAT_R32_UINT;
-		D3DindexedBufferView.SizeInBytes = (UINT)iBufferView.m_sizeInBytes;
+// Only opaque draws that write depth with an ordered test give the same image in any order, ties in depth aside
+bool Renderer::IsOrderDependent(Material const* material) const
+{
+	if (!material) return true;
 
-		m_commandList->IASetIndexBuffer(&D3DindexedBufferView);
-		m_commandList->DrawIndexedInstanced((UINT)ctx.m_indexCount, 1, (UINT)ctx.m_indexStart, (INT)ctx.m_vertexStart, 0);
-	}
-	else {
-		m_commandList->DrawInstanced((UINT)ctx.m_vertexCount, 1, (UINT)ctx.m_vertexStart, 0);
-	}
+	MaterialConfig const& config = material->m_config;
+	if ((config.m_blendMode != BlendMode::OPAQUE) || !config.m_depthEnable) return true;
 
+	DepthFunc depthFunc = config.m_depthFunc;
+	return (depthFunc != DepthFunc::LESS) && (depthFunc != DepthFunc::LESSEQUAL) && (depthFunc != DepthFunc::GREATER) && (depthFunc != DepthFunc::GREATEREQUAL);
 }
 
 ComPtr<ID3D12GraphicsCommandList2> Renderer::GetBufferCommandList()
@@ -1353,7 +1411,7 @@ ComPtr<ID3D12GraphicsCommandList2> Renderer::GetBufferCommandList()
 	return m_ResourcesCommandList;
 }
 
-Texture* Renderer::CreateOrGetTextureFromFile(char const* imageFilePath)
+Texture* Renderer::CreateOrGetTextureFromFile(char const* imageFilePath, bool generateMipChain)
 {
 	Texture* existingTexture = GetTextureForFileName(imageFilePath);
 	if (existingTexture)
@@ -1362,10 +1420,71 @@ Texture* Renderer::CreateOrGetTextureFromFile(char const* imageFilePath)
 	}
 
 	// Never seen this texture before!  Let's load it.
-	Texture* newTexture = CreateTextureFromFile(imageFilePath);
+	Texture* newTexture = CreateTextureFromFile(imageFilePath, generateMipChain);
 	return newTexture;
 }
 
+void Renderer::CreateOrGetTexturesFromFiles(std::vector<std::string> const& imageFilePaths, std::vector<Texture*>& outTextures, bool generateMipChain)
+{
+	outTextures.resize(imageFilePaths.size());
+	std::vector<std::string> pathsToLoad;
+	std::unordered_set<std::string> queuedPaths; // A path listed twice is still decoded and uploaded once
+	for (int pathIndex = 0; pathIndex < (int)imageFilePaths.size(); pathIndex++) {
+		outTextures[pathIndex] = GetTextureForFileName(imageFilePaths[pathIndex].c_str());
+		if (!outTextures[pathIndex] && queuedPaths.insert(imageFilePaths[pathIndex]).second) {
+			pathsToLoad.push_back(imageFilePaths[pathIndex]);
+		}
+	}
+	if (pathsToLoad.empty()) return;
+
+	// Decoding is the slow part and touches no D3D12 state, uploads stay on this thread
+	std::vector<Image> loadedImages;
+	Image::LoadImages(pathsToLoad, loadedImages, generateMipChain);
+	for (Image const& loadedImage : loadedImages) {
+		CreateTextureFromImage(loadedImage);
+	}
+
+	for (int pathIndex = 0; pathIndex < (int)imageFilePaths.size(); pathIndex++) {
+		if (!outTextures[pathIndex]) {
+			outTextures[pathIndex] = GetTextureForFileName(imageFilePaths[pathIndex].c_str());
+		}
+	}
+}
+
+Texture* Renderer::CreateOrGetCompressedTextureFromFile(char const* imageFilePath, BlockCompressionFormat format, bool generateMipChain)
+{
+	Texture* existingTexture = GetTextureForFileName(imageFilePath);
+	if (existingTexture) {
+		return existingTexture;
+	}
+
+	// D3D12 wants the top level of a BC texture in whole blocks. Checked from the header, so nothing is cooked or cached that can't be used
+	IntVec2 dimensions = IntVec2::ZERO;
+	if (!CompressedImage::ReadSourceDimensions(imageFilePath, dimensions)) {
+		return nullptr;
+	}
+	if (((dimensions.x % BLOCK_COMPRESSION_BLOCK_SIZE) != 0) || ((dimensions.y % BLOCK_COMPRESSION_BLOCK_SIZE) != 0)) {
+		DebuggerPrintf(Stringf("\"%s\" is %dx%d, not a multiple of 4. Loading it uncompressed\n", imageFilePath, dimensions.x, dimensions.y).c_str());
+		return CreateTextureFromFile(imageFilePath, generateMipChain);
+	}
+
+	CompressedImage compressedImage;
+	if (!CompressedImage::CreateOrLoadCached(imageFilePath, format, generateMipChain, m_config.m_textureCacheDirectory, compressedImage)) {
+		return nullptr;
+	}
+
+	return CreateTextureFromCompressedImage(compressedImage, imageFilePath);
+}
+
+void Renderer::CreateTexturesForAtlas(TextureAtlasBuilder const& atlas, char const* atlasName, std::vector<Texture*>& outPageTextures)
+{
+	outPageTextures.resize(atlas.GetPageCount());
+	for (int pageIndex = 0; pageIndex < atlas.GetPageCount(); pageIndex++) {
+		std::string pageName = Stringf("%s_Page%d", atlasName, pageIndex);
+		outPageTextures[pageIndex] = CreateTextureFromImage(atlas.GetPage(pageIndex), pageName.c_str());
+	}
+}
+
 void Renderer::DrawVertexArray(std::vector<Vertex_PCU> const& vertexes)
 {
 	DrawVertexArray((unsigned int)vertexes.size(), vertexes.data());
@@ -1593,7 +1712,7 @@ Texture* Renderer::CreateTexture(TextureCreateInfo& creationInfo)
 		D3D12_RESOURCE_DESC textureDesc = {};
 		textureDesc.Width = (UINT64)creationInfo.m_dimensions.x;
 		textureDesc.Height = (UINT64)creationInfo.m_dimensions.y;
-		textureDesc.MipLevels = 1;
+		textureDesc.MipLevels = (UINT16)creationInfo.m_mipLevels;
 		textureDesc.DepthOrArraySize = 1;
 		textureDesc.Format = LocalToD3D12(creationInfo.m_format);
 		textureDesc.Flags = LocalToD3D12(creationInfo.m_bindFlags);
@@ -1636,7 +1755,8 @@ Texture* Renderer::CreateTexture(TextureCreateInfo& creationInfo)
 
 		if (creationInfo.m_initialData) {
 			ID3D12Resource* textureUploadHeap;
-			UINT64  const uploadBufferSize = GetRequiredIntermediateSize(handle->m_resource, 0, 1);
+			UINT const mipLevels = (UINT)creationInfo.m_mipLevels;
+			UINT64  const uploadBufferSize = GetRequiredIntermediateSize(handle->m_resource, 0, mipLevels);
 			CD3DX12_RESOURCE_DESC uploadHeapDesc = CD3DX12_RESOURCE_DESC::Buffer(uploadBufferSize);
 			CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_UPLOAD);
 
@@ -1651,11 +1771,25 @@ Texture* Renderer::CreateTexture(TextureCreateInfo& creationInfo)
 			ThrowIfFailed(createUploadHeap, "FAILED TO CREATE TEXTURE UPLOAD HEAP");
 			SetDebugName(textureUploadHeap, "UplHeap");
 
-			D3D12_SUBRESOURCE_DATA imageData = {};
-			imageData.pData = creationInfo.m_initialData;
-			imageData.RowPitch = creationInfo.m_stride * creationInfo.m_dimensions.x;
-			imageData.SlicePitch = creationInfo.m_stride * creationInfo.m_dimensions.y * creationInfo.m_dimensions.x;
-			UpdateSubresources(m_commandList.Get(), handle->m_resource, textureUploadHeap, 0, 0, 1, &imageData);
+			// Mip levels follow each other in the initial data, each one tightly packed
+			std::vector<D3D12_SUBRESOURCE_DATA> imageData(mipLevels);
+			unsigned char const* mipData = static_cast<unsigned char const*>(creationInfo.m_initialData);
+			for (UINT mipLevel = 0; mipLevel < mipLevels; mipLevel++) {
+				int mipWidth = creationInfo.m_dimensions.x >> mipLevel;
+				int mipHeight = creationInfo.m_dimensions.y >> mipLevel;
+				mipWidth = (mipWidth > 1) ? mipWidth : 1;
+				mipHeight = (mipHeight > 1) ? mipHeight : 1;
+				if (IsBlockCompressedFormat(creationInfo.m_format)) {
+					// Rows of 4x4 blocks, mips smaller than a block still take a whole one
+					mipWidth = (mipWidth + BLOCK_COMPRESSION_BLOCK_SIZE - 1) / BLOCK_COMPRESSION_BLOCK_SIZE;
+					mipHeight = (mipHeight + BLOCK_COMPRESSION_BLOCK_SIZE - 1) / BLOCK_COMPRESSION_BLOCK_SIZE;
+				}
+				imageData[mipLevel].pData = mipData;
+				imageData[mipLevel].RowPitch = creationInfo.m_stride * mipWidth;
+				imageData[mipLevel].SlicePitch = creationInfo.m_stride * mipWidth * mipHeight;
+				mipData += imageData[mipLevel].SlicePitch;
+			}
+			UpdateSubresources(m_commandList.Get(), handle->m_resource, textureUploadHeap, 0, 0, mipLevels, imageData.data());
 			handle->TransitionTo(D3D12_RESOURCE_STATE_COMMON, m_commandList.Get());
 
 			m_frameUploadHeaps.push_back(textureUploadHeap);
@@ -1701,22 +1835,26 @@ Texture* Renderer::GetTextureForFileName(char const* imageFilePath)
 	return textureToGet;
 }
 
-Texture* Renderer::CreateTextureFromFile(char const* imageFilePath)
+Texture* Renderer::CreateTextureFromFile(char const* imageFilePath, bool generateMipChain)
 {
 	Image loadedImage(imageFilePath);
+	if (generateMipChain) {
+		loadedImage.GenerateMipChain();
+	}
 	Texture* newTexture = CreateTextureFromImage(loadedImage);
 
 	return newTexture;
 }
 
-Texture* Renderer::CreateTextureFromImage(Image const& image)
+Texture* Renderer::CreateTextureFromImage(Image const& image, char const* name)
 {
 	TextureCreateInfo ci{};
 	ci.m_owner = this;
-	ci.m_name = image.GetImageFilePath();
+	ci.m_name = name ? name : image.GetImageFilePath();
 	ci.m_dimensions = image.GetDimensions();
 	ci.m_initialData = image.GetRawData();
 	ci.m_stride = sizeof(Rgba8);
+	ci.m_mipLevels = image.GetMipCount();
 
 
 	Texture* newTexture = CreateTexture(ci);
@@ -1727,6 +1865,27 @@ Texture* Renderer::CreateTextureFromImage(Image const& image)
 	return newTexture;
 }
 
+Texture* Renderer::CreateTextureFromCompressedImage(CompressedImage const& compressedImage, char const* name)
+{
+	TextureCreateInfo ci{};
+	ci.m_owner = this;
+	ci.m_name = name;
+	ci.m_dimensions = compressedImage.GetDimensions();
+	ci.m_initialData = const_cast<unsigned char*>(compressedImage.GetMipBlocks(0));
+	ci.m_stride = (size_t)GetBlockCompressionBlockBytes(compressedImage.GetFormat());
+	ci.m_mipLevels = compressedImage.GetMipCount();
+	switch (compressedImage.GetFormat()) {
+	case BlockCompressionFormat::BC1: ci.m_format = TextureFormat::BC1_UNORM; break;
+	case BlockCompressionFormat::BC3: ci.m_format = TextureFormat::BC3_UNORM; break;
+	default: ci.m_format = TextureFormat::BC7_UNORM; break;
+	}
+
+	Texture* newTexture = CreateTexture(ci);
+	SetDebugName(newTexture->GetResource()->m_resource, newTexture->m_name.c_str());
+
+	return newTexture;
+}
+
 ResourceView* Renderer::CreateShaderResourceView(ResourceViewInfo const& viewInfo) const
 {
 	DescriptorHeap* srvDescriptorHeap = GetDescriptorHeap(DescriptorHeapType::SRV_UAV_CBV);
@@ -2088,6 +2247,24 @@ ResourceView* Renderer::CreateResourceView(ResourceViewInfo const& resourceViewI
 	return nullptr;
 }
 
+BitmapFont* Renderer::CreateBitmapFontFromAtlas(std::filesystem::path bitmapPath, Texture& atlasPageTexture, std::vector<AABB2> const& glyphUVs)
+{
+	BitmapFont* newBitmapFont = new BitmapFont(bitmapPath.string().c_str(), atlasPageTexture, glyphUVs);
+
+	// Takes the place of a font already loaded from the same path. Loaded fonts are never freed, so whoever got the old one
+	// (usually the dev console, created before any atlas) keeps drawing with it
+	for (int loadedFontIndex = 0; loadedFontIndex < m_loadedFonts.size(); loadedFontIndex++) {
+		BitmapFont*& bitmapFont = m_loadedFonts[loadedFontIndex];
+		if (bitmapFont->m_fontFilePathNameWithNoExtension == newBitmapFont->m_fontFilePathNameWithNoExtension) {
+			bitmapFont = newBitmapFont;
+			return newBitmapFont;
+		}
+	}
+
+	m_loadedFonts.push_back(newBitmapFont);
+	return newBitmapFont;
+}
+
 BitmapFont* Renderer::CreateOrGetBitmapFont(std::filesystem::path bitmapPath)
 {
 	for (int loadedFontIndex = 0; loadedFontIndex < m_loadedFonts.size(); loadedFontIndex++) {
@@ -2248,11 +2425,37 @@ void Renderer::DrawAllImmediateContexts()
 	m_immediateDiffuseVBO->GuaranteeBufferSize(vertexesDiffuseSize);
 	m_immediateDiffuseVBO->CopyCPUToGPU(m_immediateDiffuseVertexes.data(), vertexesDiffuseSize);
 
+	// Each camera pass gets its own camera buffer, draws never move from one pass to another
+	m_renderQueue.Clear();
+	ConstantBuffer* passCameraCBO = nullptr;
 	for (unsigned int ctxIndex = 0; ctxIndex < m_immediateCtxs.size(); ctxIndex++) {
-	//for (ImmediateContext& ctx : m_immediateCtxs) {
-		ImmediateContext& ctx = m_immediateCtxs[ctxIndex];
-		DrawImmediateCtx(ctx);
+		ImmediateContext const& ctx = m_immediateCtxs[ctxIndex];
+		if ((ctxIndex == 0) || (ctx.m_cameraCBO != passCameraCBO)) {
+			m_renderQueue.BeginPass();
+			passCameraCBO = ctx.m_cameraCBO;
+		}
+
+		RenderQueueDrawState drawState;
+		drawState.m_renderTarget = ctx.m_renderTargets[0];
+		drawState.m_depthTarget = ctx.m_depthTarget;
+		drawState.m_material = ctx.m_material;
+		drawState.m_vertexBuffer = (ctx.m_immediateVBO) ? *ctx.m_immediateVBO : m_immediateVBO;
+		if (ctx.m_isIndexedDraw) {
+			drawState.m_indexBuffer = (ctx.m_immediateIBO) ? *ctx.m_immediateIBO : m_immediateIBO;
+		}
+		drawState.m_cbvHandleStart = ctx.m_cbvHandleStart;
+		drawState.m_srvHandleStart = ctx.m_srvHandleStart;
+
+		Texture const* firstTexture = (ctx.m_boundTextures.empty()) ? nullptr : ctx.m_boundTextures.begin()->second;
+		m_renderQueue.AddDraw(drawState, firstTexture, IsOrderDependent(ctx.m_material));
 	}
+
+	if (m_config.m_sortImmediateDraws) {
+		m_renderQueue.Sort();
+	}
+
+	ImmediateContextBackend immediateBackend(*this);
+	m_renderQueue.Replay(immediateBackend);
 }
 
 void Renderer::ClearAllImmediateContexts()
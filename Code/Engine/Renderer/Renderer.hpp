@@ -5,7 +5,9 @@
 #include "Engine/Renderer/ResourceView.hpp"
 #include "Engine/Renderer/GraphicsCommon.hpp"
 #include "Engine/Renderer/MaterialSystem.hpp"
+#include "Engine/Renderer/RenderQueue.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/BlockCompression.hpp"
 #include "Game/EngineBuildPreferences.hpp"
 #include <filesystem>
 #include <cstdint>
@@ -39,9 +41,12 @@ class VertexBuffer;
 class IndexBuffer;
 struct Rgba8;
 struct Vertex_PCU;
+struct AABB2;
 class Texture;
 struct TextureCreateInfo;
 class Image;
+class CompressedImage;
+class TextureAtlasBuilder;
 class Camera;
 class ConstantBuffer;
 class BitmapFont;
@@ -51,6 +56,9 @@ extern MaterialSystem* g_theMaterialSystem;
 struct RendererConfig {
 	Window* m_window = nullptr;
 	unsigned int m_backBuffersCount = 2;
+	std::string m_textureCacheDirectory = "Data/Cache/Textures";
+	// Immediate draws that don't depend on order are grouped by target, material and texture at the end of the frame
+	bool m_sortImmediateDraws = true;
 };
 
 struct ModelConstants {
@@ -140,6 +148,7 @@ class Renderer {
 	friend class Texture;
 	friend class DescriptorHeap;
 	friend class MaterialSystem;
+	friend class ImmediateContextBackend;
 public:
 	Renderer(RendererConfig const& config);
 	~Renderer();
@@ -154,7 +163,14 @@ public:
 	void ClearScreen(Rgba8 const& color);
 	void ClearDepth(float clearDepth = 1.0f);
 	Material* CreateOrGetMaterial(std::filesystem::path materialPathNoExt);
-	Texture* CreateOrGetTextureFromFile(char const* imageFilePath);
+	Texture* CreateOrGetTextureFromFile(char const* imageFilePath, bool generateMipChain = false);
+	// Files not loaded yet are decoded (and mipmapped) in parallel on the JobSystem, then uploaded. One texture per path, in order
+	void CreateOrGetTexturesFromFiles(std::vector<std::string> const& imageFilePaths, std::vector<Texture*>& outTextures, bool generateMipChain = false);
+	// Block compressed on the CPU the first time, then loaded from the cooked copy in m_textureCacheDirectory while the
+	// source file stays the same. Sizes that are not multiples of 4 fall back to an uncompressed texture
+	Texture* CreateOrGetCompressedTextureFromFile(char const* imageFilePath, BlockCompressionFormat format, bool generateMipChain = false);
+	// One texture per atlas page, named "<atlasName>_Page<index>"
+	void CreateTexturesForAtlas(TextureAtlasBuilder const& atlas, char const* atlasName, std::vector<Texture*>& outPageTextures);
 
 	// Unlit vertex array
 	void DrawVertexArray(unsigned int numVertexes, const Vertex_PCU* vertexes);
@@ -176,6 +192,9 @@ public:
 	DescriptorHeap* GetGPUDescriptorHeap(DescriptorHeapType descriptorHeapType) const;
 	ResourceView* CreateResourceView(ResourceViewInfo const& resourceViewInfo, DescriptorHeap* descriptorHeap = nullptr) const;
 	BitmapFont* CreateOrGetBitmapFont(std::filesystem::path bitmapPath);
+	// Font glyphs packed in a texture atlas, see TextureAtlasBuilder::AddSpriteGrid. Registered under bitmapPath, replacing a font
+	// already loaded from that path, so later CreateOrGetBitmapFont calls get this one. Fonts handed out before keep their texture
+	BitmapFont* CreateBitmapFontFromAtlas(std::filesystem::path bitmapPath, Texture& atlasPageTexture, std::vector<AABB2> const& glyphUVs);
 	Material* GetMaterialForName(char const* materialName);
 	Material* GetMaterialForPath(std::filesystem::path const& materialPath);
 	Material* GetDefaultMaterial() const;
@@ -264,8 +283,9 @@ private:
 	Texture* CreateTexture(TextureCreateInfo& creationInfo);
 	void DestroyTexture(Texture* textureToDestroy);
 	Texture* GetTextureForFileName(char const* imageFilePath);
-	Texture* CreateTextureFromFile(char const* imageFilePath);
-	Texture* CreateTextureFromImage(Image const& image);
+	Texture* CreateTextureFromFile(char const* imageFilePath, bool generateMipChain = false);
+	Texture* CreateTextureFromImage(Image const& image, char const* name = nullptr); // Named after the image file by default
+	Texture* CreateTextureFromCompressedImage(CompressedImage const& compressedImage, char const* name);
 	ResourceView* CreateShaderResourceView(ResourceViewInfo const& viewInfo) const;
 	ResourceView* CreateRenderTargetView(ResourceViewInfo const& viewInfo) const;
 	ResourceView* CreateDepthStencilView(ResourceViewInfo const& viewInfo) const;
@@ -292,7 +312,7 @@ private:
 	void DrawEffect(FxContext& ctx);
 	void DrawAllImmediateContexts();
 	void ClearAllImmediateContexts();
-	void DrawImmediateCtx(ImmediateContext& ctx);
+	bool IsOrderDependent(Material const* material) const;
 	ComPtr<ID3D12GraphicsCommandList2> GetBufferCommandList();
 private:
 	RendererConfig m_config = {};
@@ -322,6 +342,7 @@ private:
 	std::vector<DescriptorHeap*> m_defaultGPUDescriptorHeaps;
 
 	std::vector<ImmediateContext> m_immediateCtxs;
+	RenderQueue m_renderQueue;
 	std::vector<FxContext> m_effectsCtxs;
 	std::vector<ConstantBuffer> m_cameraCBOArray;
 	std::vector<ConstantBuffer> m_modelCBOArray;
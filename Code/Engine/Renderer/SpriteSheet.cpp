@@ -70,6 +70,15 @@ SpriteSheet::SpriteSheet(Texture const& texture, IntVec2 const& simpleGridLayout
 	}
 }
 
+SpriteSheet::SpriteSheet(Texture const& texture, std::vector<AABB2> const& spriteUVs) :
+	m_texture(texture)
+{
+	m_spriteDefs.reserve(spriteUVs.size());
+	for (int spriteIndex = 0; spriteIndex < (int)spriteUVs.size(); spriteIndex++) {
+		m_spriteDefs.emplace_back(*this, spriteIndex, spriteUVs[spriteIndex].m_mins, spriteUVs[spriteIndex].m_maxs);
+	}
+}
+
 Texture const& SpriteSheet::GetTexture() const
 {
 	return m_texture;
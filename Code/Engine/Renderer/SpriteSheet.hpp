@@ -28,6 +28,8 @@ class SpriteSheet {
 	friend class SpriteAnimGroupDefinition;
 public:
 	explicit SpriteSheet(Texture const& texture, IntVec2 const& simpleGridLayout);
+	// Sprites anywhere on the texture, e.g. a TextureAtlasGroup on its atlas page. Sprite i uses spriteUVs[i]
+	explicit SpriteSheet(Texture const& texture, std::vector<AABB2> const& spriteUVs);
 
 	Texture const& GetTexture()const;
 	int GetNumSprites() const;
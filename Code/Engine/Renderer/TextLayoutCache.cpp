@@ -0,0 +1,116 @@
+#include "Engine/Renderer/TextLayoutCache.hpp"
+
+namespace {
+	constexpr uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325ull;
+	constexpr uint64_t FNV_PRIME = 0x100000001B3ull;
+
+	uint64_t HashBytes(uint64_t hash, void const* bytes, size_t byteCount)
+	{
+		unsigned char const* byteValues = static_cast<unsigned char const*>(bytes);
+		for (size_t byteIndex = 0; byteIndex < byteCount; byteIndex++) {
+			hash = (hash ^ byteValues[byteIndex]) * FNV_PRIME;
+		}
+		return hash;
+	}
+}
+
+TextLayoutCache::TextLayoutCache(int maxIdleFrames):
+	m_maxIdleFrames(maxIdleFrames)
+{
+}
+
+void TextLayoutCache::AddVertsForTextInBox2D(std::vector<Vertex_PCU>& vertexArray, BitmapFont const& font, AABB2 const& box, float cellHeight, std::string const& text,
+											 Rgba8 const& tint, float cellAspect, Vec2 const& alignment, TextBoxMode mode, int maxGlyphsToDraw)
+{
+	TextLayoutEntry const& entry = FindOrBuildEntry(font, box, cellHeight, text, tint, cellAspect, alignment, mode, maxGlyphsToDraw, false);
+	vertexArray.insert(vertexArray.end(), entry.m_vertexes.begin(), entry.m_vertexes.end());
+}
+
+void TextLayoutCache::AddIndexedVertsForTextInBox2D(std::vector<Vertex_PCU>& vertexArray, std::vector<unsigned int>& indexArray, BitmapFont const& font, AABB2 const& box,
+													float cellHeight, std::string const& text, Rgba8 const& tint, float cellAspect, Vec2 const& alignment, TextBoxMode mode, int maxGlyphsToDraw)
+{
+	TextLayoutEntry const& entry = FindOrBuildEntry(font, box, cellHeight, text, tint, cellAspect, alignment, mode, maxGlyphsToDraw, true);
+
+	unsigned int baseVertex = (unsigned int)vertexArray.size();
+	vertexArray.insert(vertexArray.end(), entry.m_vertexes.begin(), entry.m_vertexes.end());
+
+	size_t firstIndex = indexArray.size();
+	indexArray.resize(firstIndex + entry.m_indexes.size());
+	unsigned int* index = indexArray.data() + firstIndex;
+	for (size_t cachedIndex = 0; cachedIndex < entry.m_indexes.size(); cachedIndex++) {
+		index[cachedIndex] = entry.m_indexes[cachedIndex] + baseVertex;
+	}
+}
+
+void TextLayoutCache::AdvanceFrame()
+{
+	m_frameNumber++;
+	for (auto entryIter = m_entries.begin(); entryIter != m_entries.end();) {
+		if (m_frameNumber - entryIter->second.m_lastUsedFrame > m_maxIdleFrames) {
+			entryIter = m_entries.erase(entryIter);
+		}
+		else {
+			++entryIter;
+		}
+	}
+}
+
+void TextLayoutCache::Clear()
+{
+	m_entries.clear();
+	m_hitCount = 0;
+	m_missCount = 0;
+}
+
+TextLayoutCache::TextLayoutEntry& TextLayoutCache::FindOrBuildEntry(BitmapFont const& font, AABB2 const& box, float cellHeight, std::string const& text, Rgba8 const& tint,
+																	float cellAspect, Vec2 const& alignment, TextBoxMode mode, int maxGlyphsToDraw, bool isIndexed)
+{
+	BitmapFont const* fontPtr = &font;
+	uint64_t key = HashBytes(FNV_OFFSET_BASIS, text.data(), text.size());
+	key = HashBytes(key, &fontPtr, sizeof(fontPtr));
+	key = HashBytes(key, &box, sizeof(box));
+	key = HashBytes(key, &cellHeight, sizeof(cellHeight));
+	key = HashBytes(key, &cellAspect, sizeof(cellAspect));
+	key = HashBytes(key, &alignment, sizeof(alignment));
+	key = HashBytes(key, &mode, sizeof(mode));
+	key = HashBytes(key, &maxGlyphsToDraw, sizeof(maxGlyphsToDraw));
+	key = HashBytes(key, &isIndexed, sizeof(isIndexed));
+
+	TextLayoutEntry& entry = m_entries[key];
+	entry.m_lastUsedFrame = m_frameNumber;
+
+	bool isSameLayout = (entry.m_font == fontPtr) && (entry.m_text == text) && (entry.m_box.m_mins == box.m_mins) && (entry.m_box.m_maxs == box.m_maxs)
+		&& (entry.m_cellHeight == cellHeight) && (entry.m_cellAspect == cellAspect) && (entry.m_alignment == alignment) && (entry.m_mode == mode)
+		&& (entry.m_maxGlyphsToDraw == maxGlyphsToDraw) && (entry.m_isIndexed == isIndexed);
+	if (isSameLayout) {
+		m_hitCount++;
+		if (!(entry.m_tint == tint)) {
+			for (Vertex_PCU& vertex : entry.m_vertexes) {
+				vertex.m_color = tint;
+			}
+			entry.m_tint = tint;
+		}
+		return entry;
+	}
+
+	m_missCount++;
+	entry.m_text = text;
+	entry.m_font = fontPtr;
+	entry.m_box = box;
+	entry.m_cellHeight = cellHeight;
+	entry.m_cellAspect = cellAspect;
+	entry.m_alignment = alignment;
+	entry.m_mode = mode;
+	entry.m_maxGlyphsToDraw = maxGlyphsToDraw;
+	entry.m_isIndexed = isIndexed;
+	entry.m_tint = tint;
+	entry.m_vertexes.clear();
+	entry.m_indexes.clear();
+	if (isIndexed) {
+		font.AddIndexedVertsForTextInBox2D(entry.m_vertexes, entry.m_indexes, box, cellHeight, text, tint, cellAspect, alignment, mode, maxGlyphsToDraw);
+	}
+	else {
+		font.AddVertsForTextInBox2D(entry.m_vertexes, box, cellHeight, text, tint, cellAspect, alignment, mode, maxGlyphsToDraw);
+	}
+	return entry;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "Engine/Renderer/BitmapFont.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Math/AABB2.hpp"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+constexpr int TEXT_LAYOUT_CACHE_DEFAULT_MAX_IDLE_FRAMES = 60;
+
+/// <summary>
+/// Keeps the glyph quads of text laid out in a box, keyed by a hash of the text, font, box, cell size, alignment and mode.
+/// Text that is drawn the same way every frame is laid out once and after that only copied into the caller's vertex array.
+/// The tint is not part of the key: a new tint rewrites the cached vertex colors in place, so fading text still hits.
+/// Entries not used for maxIdleFrames calls to AdvanceFrame are dropped. Not thread safe, one cache per rendering system
+/// </summary>
+class TextLayoutCache {
+public:
+	explicit TextLayoutCache(int maxIdleFrames = TEXT_LAYOUT_CACHE_DEFAULT_MAX_IDLE_FRAMES);
+
+	void AddVertsForTextInBox2D(std::vector<Vertex_PCU>& vertexArray, BitmapFont const& font, AABB2 const& box, float cellHeight, std::string const& text,
+		Rgba8 const& tint = Rgba8::WHITE, float cellAspect = 1.0f, Vec2 const& alignment = Vec2(0.5f, 0.5f), TextBoxMode mode = TextBoxMode::SHRINK_TO_FIT,
+		int maxGlyphsToDraw = ARBITRARILY_LARGE_INT_VALUE);
+	void AddIndexedVertsForTextInBox2D(std::vector<Vertex_PCU>& vertexArray, std::vector<unsigned int>& indexArray, BitmapFont const& font, AABB2 const& box,
+		float cellHeight, std::string const& text, Rgba8 const& tint = Rgba8::WHITE, float cellAspect = 1.0f, Vec2 const& alignment = Vec2(0.5f, 0.5f),
+		TextBoxMode mode = TextBoxMode::SHRINK_TO_FIT, int maxGlyphsToDraw = ARBITRARILY_LARGE_INT_VALUE);
+
+	// Call once per rendered frame, after the text of that frame was added
+	void AdvanceFrame();
+	void Clear();
+
+	int GetEntryCount() const { return (int)m_entries.size(); }
+	int GetHitCount() const { return m_hitCount; }
+	int GetMissCount() const { return m_missCount; }
+
+private:
+	struct TextLayoutEntry {
+		// Full key, compared on every hit so a hash collision rebuilds instead of drawing the wrong text
+		std::string m_text;
+		BitmapFont const* m_font = nullptr;
+		AABB2 m_box;
+		float m_cellHeight = 0.0f;
+		float m_cellAspect = 0.0f;
+		Vec2 m_alignment;
+		TextBoxMode m_mode = TextBoxMode::SHRINK_TO_FIT;
+		int m_maxGlyphsToDraw = 0;
+		bool m_isIndexed = false;
+
+		Rgba8 m_tint;
+		std::vector<Vertex_PCU> m_vertexes;
+		std::vector<unsigned int> m_indexes; // Relative to the first cached vertex
+		int m_lastUsedFrame = 0;
+	};
+
+	TextLayoutEntry& FindOrBuildEntry(BitmapFont const& font, AABB2 const& box, float cellHeight, std::string const& text, Rgba8 const& tint,
+		float cellAspect, Vec2 const& alignment, TextBoxMode mode, int maxGlyphsToDraw, bool isIndexed);
+
+private:
+	std::unordered_map<uint64_t, TextLayoutEntry> m_entries;
+	int m_maxIdleFrames = TEXT_LAYOUT_CACHE_DEFAULT_MAX_IDLE_FRAMES;
+	int m_frameNumber = 0;
+	int m_hitCount = 0;
+	int m_missCount = 0;
+};
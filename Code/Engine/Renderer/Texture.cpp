@@ -40,7 +40,7 @@ ResourceView* Texture::CreateShaderResourceView()
 	srvDesc->Shader4ComponentMapping = D3D12_ENCODE_SHADER_4_COMPONENT_MAPPING(0, 1, 2, 3);
 	srvDesc->Format = LocalToColourD3D12(m_creationInfo.m_format);
 	srvDesc->ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-	srvDesc->Texture2D.MipLevels = 1;
+	srvDesc->Texture2D.MipLevels = (UINT)m_creationInfo.m_mipLevels;
 
 	ResourceViewInfo viewInfo = {};
 	viewInfo.m_srvDesc = srvDesc;
@@ -138,3 +138,8 @@ Rgba8 const Texture::GetClearColour() const
 {
 	return m_creationInfo.m_clearColour;
 }
+
+bool IsBlockCompressedFormat(TextureFormat textureFormat)
+{
+	return (textureFormat == TextureFormat::BC1_UNORM) || (textureFormat == TextureFormat::BC3_UNORM) || (textureFormat == TextureFormat::BC7_UNORM);
+}
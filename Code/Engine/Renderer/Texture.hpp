@@ -15,21 +15,27 @@ enum class TextureFormat : int {
 		R32G32_FLOAT,
 		D24_UNORM_S8_UINT,
 		R24G8_TYPELESS,
-		R32_FLOAT
+		R32_FLOAT,
+		BC1_UNORM,
+		BC3_UNORM,
+		BC7_UNORM
 };
 
+bool IsBlockCompressedFormat(TextureFormat textureFormat);
+
 
 struct TextureCreateInfo {
 	std::string m_name = "Unnamed Texture";
 	Renderer* m_owner = nullptr;
 	IntVec2 m_dimensions = IntVec2::ZERO;
-	size_t m_stride = 0;
+	size_t m_stride = 0; // Bytes per texel, or per 4x4 block for the BC formats
 	ResourceBindFlag m_bindFlags = RESOURCE_BIND_NONE;
 	TextureFormat m_format = TextureFormat::R8G8B8A8_UNORM;
 	TextureFormat m_clearFormat = TextureFormat::R8G8B8A8_UNORM;
 	bool m_isMultiSample = false;
 	Resource* m_handle = nullptr;
-	void* m_initialData = nullptr;
+	void* m_initialData = nullptr; // Every mip level one after the other when m_mipLevels > 1
+	int m_mipLevels = 1;
 	Rgba8 m_clearColour = Rgba8();
 };
 